@@ -66,3 +66,13 @@ function(add_e2etest_directory test_directory)
         add_subdirectory(${test_directory})
     endif()
 endfunction()
+
+function(linkBenchmark whatExecutableIsBuilding)
+    include_directories(${BENCHMARK_INC_FOLDER})
+    target_link_libraries(${whatExecutableIsBuilding} benchmark)
+
+    #the benchmark library counts the allocations that come through these wrappers
+    if(LINUX)
+        set_target_properties(${whatExecutableIsBuilding} PROPERTIES LINK_FLAGS "-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free")
+    endif()
+endfunction(linkBenchmark)
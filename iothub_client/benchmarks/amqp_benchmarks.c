@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_uamqp_c/message.h"
+#include "iothub_message.h"
+#include "uamqp_messaging.h"
+#include "iothub_client_benchmarks.h"
+
+static int message_setup(void** context)
+{
+    *context = benchmark_create_message();
+    return (*context == NULL ? __LINE__ : 0);
+}
+
+static void message_teardown(void* context)
+{
+    IoTHubMessage_Destroy((IOTHUB_MESSAGE_HANDLE)context);
+}
+
+static int create_from_iothub_message_run_once(void* context)
+{
+    int result;
+    MESSAGE_HANDLE uamqp_message = NULL;
+
+    if (message_create_from_iothub_message((IOTHUB_MESSAGE_HANDLE)context, &uamqp_message) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        message_destroy(uamqp_message);
+        result = 0;
+    }
+
+    return result;
+}
+
+static int encoding_from_iothub_message_run_once(void* context)
+{
+    int result;
+    BINARY_DATA encoded_message;
+
+    if (message_create_uamqp_encoding_from_iothub_message((IOTHUB_MESSAGE_HANDLE)context, &encoded_message) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        free((void*)encoded_message.bytes);
+        result = 0;
+    }
+
+    return result;
+}
+
+static const BENCHMARK amqp_benchmarks[] =
+{
+    { "uamqp_message_create_from_iothub_message", message_setup, create_from_iothub_message_run_once, message_teardown, 0 },
+    { "uamqp_encoding_from_iothub_message", message_setup, encoding_from_iothub_message_run_once, message_teardown, 0 }
+};
+
+const BENCHMARK* amqp_benchmarks_get(size_t* count)
+{
+    *count = sizeof(amqp_benchmarks) / sizeof(amqp_benchmarks[0]);
+    return amqp_benchmarks;
+}
@@ -0,0 +1,337 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_uamqp_c/link.h"
+#include "azure_uamqp_c/message_sender.h"
+#include "azure_uamqp_c/message_receiver.h"
+#include "iothub_client_private.h"
+#include "iothubtransport_amqp_telemetry_messenger.h"
+#include "iothub_client_benchmarks.h"
+
+#define BENCHMARK_MESSAGE_POOL_SIZE 16
+/*bounds the number of do_work calls the messenger gets to open its message sender*/
+#define MAX_START_DO_WORK_COUNT 10
+/*events sent per operation, which is also the number of completions the stub link holds*/
+#define MESSENGER_EVENT_COUNT 16
+
+/*
+ * This file replaces the uAMQP link, message sender and message receiver at link time (as amqp_reconnect_benchmarks.c does for the
+ * amqp_connection and amqp_device layers), so the telemetry messenger is measured without a connection.
+ * The message sender opens as soon as it is asked to, and the stub link settles every message it was given when
+ * stub_link_settle_all is called, as the connection does on its do_work.
+ */
+typedef struct STUB_LINK_DELIVERY_TAG
+{
+    ON_MESSAGE_SEND_COMPLETE on_message_send_complete;
+    void* callback_context;
+} STUB_LINK_DELIVERY;
+
+static STUB_LINK_DELIVERY stub_link_deliveries[MESSENGER_EVENT_COUNT];
+static size_t stub_link_delivery_count;
+
+static char stub_iothub_host_fqdn[] = "benchmark-hub.azure-devices.net";
+
+/*stands in for the session, the links, the message sender and the message receiver; the messenger only passes them back to this file*/
+static int stub_link_endpoint;
+
+static void stub_link_settle_all(void)
+{
+    size_t delivery_count = stub_link_delivery_count;
+    size_t i;
+
+    stub_link_delivery_count = 0;
+
+    for (i = 0; i < delivery_count; i++)
+    {
+        stub_link_deliveries[i].on_message_send_complete(stub_link_deliveries[i].callback_context, MESSAGE_SEND_OK);
+    }
+}
+
+LINK_HANDLE link_create(SESSION_HANDLE session, const char* name, role role, AMQP_VALUE source, AMQP_VALUE target)
+{
+    (void)session;
+    (void)name;
+    (void)role;
+    (void)source;
+    (void)target;
+    return (LINK_HANDLE)&stub_link_endpoint;
+}
+
+void link_destroy(LINK_HANDLE link)
+{
+    (void)link;
+}
+
+int link_set_max_message_size(LINK_HANDLE link, uint64_t max_message_size)
+{
+    (void)link;
+    (void)max_message_size;
+    return 0;
+}
+
+int link_set_attach_properties(LINK_HANDLE link, fields attach_properties)
+{
+    (void)link;
+    (void)attach_properties;
+    return 0;
+}
+
+int link_set_rcv_settle_mode(LINK_HANDLE link, receiver_settle_mode rcv_settle_mode)
+{
+    (void)link;
+    (void)rcv_settle_mode;
+    return 0;
+}
+
+static ON_MESSAGE_SENDER_STATE_CHANGED stub_message_sender_on_state_changed;
+static void* stub_message_sender_context;
+
+MESSAGE_SENDER_HANDLE messagesender_create(LINK_HANDLE link, ON_MESSAGE_SENDER_STATE_CHANGED on_message_sender_state_changed, void* context)
+{
+    (void)link;
+    stub_message_sender_on_state_changed = on_message_sender_state_changed;
+    stub_message_sender_context = context;
+    return (MESSAGE_SENDER_HANDLE)&stub_link_endpoint;
+}
+
+void messagesender_destroy(MESSAGE_SENDER_HANDLE message_sender)
+{
+    (void)message_sender;
+    stub_message_sender_on_state_changed = NULL;
+    stub_message_sender_context = NULL;
+}
+
+int messagesender_open(MESSAGE_SENDER_HANDLE message_sender)
+{
+    (void)message_sender;
+    stub_message_sender_on_state_changed(stub_message_sender_context, MESSAGE_SENDER_STATE_OPEN, MESSAGE_SENDER_STATE_IDLE);
+    return 0;
+}
+
+int messagesender_send(MESSAGE_SENDER_HANDLE message_sender, MESSAGE_HANDLE message, ON_MESSAGE_SEND_COMPLETE on_message_send_complete, void* callback_context)
+{
+    int result;
+    (void)message_sender;
+    (void)message;
+
+    if (stub_link_delivery_count == MESSENGER_EVENT_COUNT)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        stub_link_deliveries[stub_link_delivery_count].on_message_send_complete = on_message_send_complete;
+        stub_link_deliveries[stub_link_delivery_count].callback_context = callback_context;
+        stub_link_delivery_count++;
+        result = 0;
+    }
+
+    return result;
+}
+
+/*the benchmarks never subscribe for messages, so the message receiver is never created*/
+MESSAGE_RECEIVER_HANDLE messagereceiver_create(LINK_HANDLE link, ON_MESSAGE_RECEIVER_STATE_CHANGED on_message_receiver_state_changed, void* context)
+{
+    (void)link;
+    (void)on_message_receiver_state_changed;
+    (void)context;
+    return NULL;
+}
+
+void messagereceiver_destroy(MESSAGE_RECEIVER_HANDLE message_receiver)
+{
+    (void)message_receiver;
+}
+
+int messagereceiver_open(MESSAGE_RECEIVER_HANDLE message_receiver, ON_MESSAGE_RECEIVED on_message_received, void* callback_context)
+{
+    (void)message_receiver;
+    (void)on_message_received;
+    (void)callback_context;
+    return __FAILURE__;
+}
+
+int messagereceiver_close(MESSAGE_RECEIVER_HANDLE message_receiver)
+{
+    (void)message_receiver;
+    return __FAILURE__;
+}
+
+int messagereceiver_get_link_name(MESSAGE_RECEIVER_HANDLE message_receiver, const char** link_name)
+{
+    (void)message_receiver;
+    (void)link_name;
+    return __FAILURE__;
+}
+
+int messagereceiver_get_received_message_id(MESSAGE_RECEIVER_HANDLE message_receiver, delivery_number* message_id)
+{
+    (void)message_receiver;
+    (void)message_id;
+    return __FAILURE__;
+}
+
+int messagereceiver_send_message_disposition(MESSAGE_RECEIVER_HANDLE message_receiver, const char* link_name, delivery_number message_number, AMQP_VALUE delivery_state)
+{
+    (void)message_receiver;
+    (void)link_name;
+    (void)message_number;
+    (void)delivery_state;
+    return __FAILURE__;
+}
+
+/*A started telemetry messenger and the events it sends; each event carries the benchmark message*/
+typedef struct BENCHMARK_MESSENGER_TAG
+{
+    TELEMETRY_MESSENGER_HANDLE messenger_handle;
+    TELEMETRY_MESSENGER_STATE state;
+    IOTHUB_MESSAGE_HANDLE message;
+    IOTHUB_MESSAGE_LIST events[MESSENGER_EVENT_COUNT];
+    size_t confirmed_count;
+    size_t failed_count;
+} BENCHMARK_MESSENGER;
+
+static void on_messenger_state_changed(void* context, TELEMETRY_MESSENGER_STATE previous_state, TELEMETRY_MESSENGER_STATE new_state)
+{
+    (void)previous_state;
+    ((BENCHMARK_MESSENGER*)context)->state = new_state;
+}
+
+static void on_event_send_complete(IOTHUB_MESSAGE_LIST* iothub_message_list, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT messenger_event_send_complete_result, void* context)
+{
+    BENCHMARK_MESSENGER* benchmark_messenger = (BENCHMARK_MESSENGER*)context;
+    (void)iothub_message_list;
+
+    if (messenger_event_send_complete_result == TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_OK)
+    {
+        benchmark_messenger->confirmed_count++;
+    }
+    else
+    {
+        benchmark_messenger->failed_count++;
+    }
+}
+
+static void benchmark_messenger_destroy(BENCHMARK_MESSENGER* benchmark_messenger)
+{
+    if (benchmark_messenger->messenger_handle != NULL)
+    {
+        (void)telemetry_messenger_stop(benchmark_messenger->messenger_handle);
+        telemetry_messenger_destroy(benchmark_messenger->messenger_handle);
+    }
+
+    if (benchmark_messenger->message != NULL)
+    {
+        IoTHubMessage_Destroy(benchmark_messenger->message);
+    }
+
+    free(benchmark_messenger);
+}
+
+static BENCHMARK_MESSENGER* benchmark_messenger_create(size_t message_pool_size)
+{
+    BENCHMARK_MESSENGER* result;
+
+    if ((result = (BENCHMARK_MESSENGER*)calloc(1, sizeof(BENCHMARK_MESSENGER))) != NULL)
+    {
+        TELEMETRY_MESSENGER_CONFIG config;
+        size_t i;
+
+        config.device_id = "benchmark_device";
+        config.iothub_host_fqdn = stub_iothub_host_fqdn;
+        config.on_state_changed_callback = on_messenger_state_changed;
+        config.on_state_changed_context = result;
+
+        if ((result->message = benchmark_create_message()) == NULL ||
+            (result->messenger_handle = telemetry_messenger_create(&config, "benchmark")) == NULL ||
+            (message_pool_size != 0 && telemetry_messenger_set_option(result->messenger_handle, MESSENGER_OPTION_MESSAGE_POOL_SIZE, &message_pool_size) != 0) ||
+            telemetry_messenger_start(result->messenger_handle, (SESSION_HANDLE)&stub_link_endpoint) != 0)
+        {
+            benchmark_messenger_destroy(result);
+            result = NULL;
+        }
+        else
+        {
+            for (i = 0; i < MAX_START_DO_WORK_COUNT && result->state != TELEMETRY_MESSENGER_STATE_STARTED; i++)
+            {
+                telemetry_messenger_do_work(result->messenger_handle);
+            }
+
+            if (result->state != TELEMETRY_MESSENGER_STATE_STARTED)
+            {
+                benchmark_messenger_destroy(result);
+                result = NULL;
+            }
+            else
+            {
+                for (i = 0; i < MESSENGER_EVENT_COUNT; i++)
+                {
+                    result->events[i].messageHandle = result->message;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static int send_event_setup(void** context)
+{
+    *context = benchmark_messenger_create(0);
+    return (*context == NULL ? __LINE__ : 0);
+}
+
+static int send_event_pooled_setup(void** context)
+{
+    *context = benchmark_messenger_create(BENCHMARK_MESSAGE_POOL_SIZE);
+    return (*context == NULL ? __LINE__ : 0);
+}
+
+/*queues MESSENGER_EVENT_COUNT events, lets the messenger send them and settles them all*/
+static int send_event_run_once(void* context)
+{
+    int result = 0;
+    BENCHMARK_MESSENGER* benchmark_messenger = (BENCHMARK_MESSENGER*)context;
+    size_t expected_count = benchmark_messenger->confirmed_count + MESSENGER_EVENT_COUNT;
+    size_t i;
+
+    for (i = 0; i < MESSENGER_EVENT_COUNT; i++)
+    {
+        if (telemetry_messenger_send_async(benchmark_messenger->messenger_handle, &benchmark_messenger->events[i], on_event_send_complete, benchmark_messenger) != 0)
+        {
+            result = __LINE__;
+            break;
+        }
+    }
+
+    telemetry_messenger_do_work(benchmark_messenger->messenger_handle);
+    stub_link_settle_all();
+
+    if (result == 0 &&
+        (benchmark_messenger->failed_count != 0 || benchmark_messenger->confirmed_count != expected_count))
+    {
+        result = __LINE__;
+    }
+
+    return result;
+}
+
+static void send_event_teardown(void* context)
+{
+    benchmark_messenger_destroy((BENCHMARK_MESSENGER*)context);
+}
+
+static const BENCHMARK amqp_messenger_benchmarks[] =
+{
+    { "amqp_messenger_send_16_events_do_work", send_event_setup, send_event_run_once, send_event_teardown, 0 },
+    { "amqp_messenger_send_16_events_do_work_pooled", send_event_pooled_setup, send_event_run_once, send_event_teardown, 0 }
+};
+
+const BENCHMARK* amqp_messenger_benchmarks_get(size_t* count)
+{
+    *count = sizeof(amqp_messenger_benchmarks) / sizeof(amqp_messenger_benchmarks[0]);
+    return amqp_messenger_benchmarks;
+}
@@ -0,0 +1,587 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/optionhandler.h"
+#include "azure_c_shared_utility/tickcounter.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/doublylinkedlist.h"
+#include "iothub_client_ll.h"
+#include "iothub_client_options.h"
+#include "iothub_client_private.h"
+#include "iothub_transport_ll.h"
+#include "iothubtransportamqp.h"
+#include "iothubtransport_amqp_common.h"
+#include "iothubtransport_amqp_connection.h"
+#include "iothubtransport_amqp_device.h"
+#include "iothub_client_benchmarks.h"
+
+#define RECONNECT_DEVICE_COUNT 1000
+#define RECONNECT_DEVICE_STARTS_PER_SECOND 500
+/*the stub hub authenticates one device start at a time, and each takes this long*/
+#define STUB_HUB_DEVICE_START_MS 1
+/*the application sleeps this long between two DoWork calls*/
+#define DO_WORK_INTERVAL_MS 1
+/*bounds a reconnection that never completes*/
+#define MAX_RECONNECT_TIME_MS 120000
+#define RECONNECT_MAX_ITERATIONS 3
+
+/*
+ * This file replaces the amqp_connection and amqp_device layers of the AMQP transport at link time (as http_benchmarks.c does for HTTPAPI).
+ * The connection opens on its first amqp_connection_do_work; a device start completes once the stub hub has served it.
+ */
+DEFINE_ENUM_STRINGS(AMQP_CONNECTION_STATE, AMQP_CONNECTION_STATE_VALUES);
+
+typedef struct AMQP_CONNECTION_INSTANCE
+{
+    AMQP_CONNECTION_STATE state;
+    ON_AMQP_CONNECTION_STATE_CHANGED on_state_changed_callback;
+    const void* on_state_changed_context;
+} AMQP_CONNECTION_INSTANCE;
+
+typedef struct DEVICE_INSTANCE
+{
+    DEVICE_STATE state;
+    ON_DEVICE_STATE_CHANGED on_state_changed_callback;
+    void* on_state_changed_context;
+    tickcounter_ms_t start_complete_time;
+} DEVICE_INSTANCE;
+
+static TICK_COUNTER_HANDLE stub_hub_tick_counter;
+static tickcounter_ms_t stub_hub_free_time;
+static AMQP_CONNECTION_INSTANCE* stub_hub_connection;
+static size_t stub_hub_started_device_count;
+
+/*stands in for both the session and the cbs instance; the transport only passes them on to device_start_async*/
+static int stub_hub_link_endpoint;
+
+static tickcounter_ms_t get_stub_hub_time(void)
+{
+    tickcounter_ms_t current_ms;
+
+    if (tickcounter_get_current_ms(stub_hub_tick_counter, &current_ms) != 0)
+    {
+        current_ms = 0;
+    }
+
+    return current_ms;
+}
+
+static void set_amqp_connection_state(AMQP_CONNECTION_INSTANCE* connection, AMQP_CONNECTION_STATE new_state)
+{
+    AMQP_CONNECTION_STATE previous_state = connection->state;
+
+    connection->state = new_state;
+    connection->on_state_changed_callback(connection->on_state_changed_context, previous_state, new_state);
+}
+
+AMQP_CONNECTION_HANDLE amqp_connection_create(AMQP_CONNECTION_CONFIG* config)
+{
+    AMQP_CONNECTION_INSTANCE* result;
+
+    if ((result = (AMQP_CONNECTION_INSTANCE*)malloc(sizeof(AMQP_CONNECTION_INSTANCE))) != NULL)
+    {
+        result->state = AMQP_CONNECTION_STATE_CLOSED;
+        result->on_state_changed_callback = config->on_state_changed_callback;
+        result->on_state_changed_context = config->on_state_changed_context;
+        stub_hub_connection = result;
+    }
+
+    return result;
+}
+
+void amqp_connection_destroy(AMQP_CONNECTION_HANDLE conn_handle)
+{
+    if (conn_handle == stub_hub_connection)
+    {
+        stub_hub_connection = NULL;
+    }
+
+    free(conn_handle);
+}
+
+void amqp_connection_do_work(AMQP_CONNECTION_HANDLE conn_handle)
+{
+    if (conn_handle->state == AMQP_CONNECTION_STATE_CLOSED)
+    {
+        set_amqp_connection_state(conn_handle, AMQP_CONNECTION_STATE_OPENED);
+    }
+}
+
+int amqp_connection_get_session_handle(AMQP_CONNECTION_HANDLE conn_handle, SESSION_HANDLE* session_handle)
+{
+    (void)conn_handle;
+    *session_handle = (SESSION_HANDLE)&stub_hub_link_endpoint;
+    return 0;
+}
+
+int amqp_connection_get_cbs_handle(AMQP_CONNECTION_HANDLE conn_handle, CBS_HANDLE* cbs_handle)
+{
+    (void)conn_handle;
+    *cbs_handle = (CBS_HANDLE)&stub_hub_link_endpoint;
+    return 0;
+}
+
+int amqp_connection_set_logging(AMQP_CONNECTION_HANDLE conn_handle, bool is_trace_on)
+{
+    (void)conn_handle;
+    (void)is_trace_on;
+    return 0;
+}
+
+static void set_device_state(DEVICE_INSTANCE* device, DEVICE_STATE new_state)
+{
+    DEVICE_STATE previous_state = device->state;
+
+    if (new_state == DEVICE_STATE_STARTED)
+    {
+        stub_hub_started_device_count++;
+    }
+    else if (previous_state == DEVICE_STATE_STARTED)
+    {
+        stub_hub_started_device_count--;
+    }
+
+    device->state = new_state;
+    device->on_state_changed_callback(device->on_state_changed_context, previous_state, new_state);
+}
+
+DEVICE_HANDLE device_create(DEVICE_CONFIG* config)
+{
+    DEVICE_INSTANCE* result;
+
+    if ((result = (DEVICE_INSTANCE*)malloc(sizeof(DEVICE_INSTANCE))) != NULL)
+    {
+        result->state = DEVICE_STATE_STOPPED;
+        result->on_state_changed_callback = config->on_state_changed_callback;
+        result->on_state_changed_context = config->on_state_changed_context;
+        result->start_complete_time = 0;
+    }
+
+    return result;
+}
+
+void device_destroy(DEVICE_HANDLE handle)
+{
+    if (handle->state == DEVICE_STATE_STARTED)
+    {
+        stub_hub_started_device_count--;
+    }
+
+    free(handle);
+}
+
+int device_start_async(DEVICE_HANDLE handle, SESSION_HANDLE session_handle, CBS_HANDLE cbs_handle)
+{
+    int result;
+    (void)session_handle;
+    (void)cbs_handle;
+
+    if (handle->state != DEVICE_STATE_STOPPED)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        tickcounter_ms_t current_time = get_stub_hub_time();
+
+        /*the starts queue up at the hub, which is what makes a reconnection storm slow*/
+        if (stub_hub_free_time < current_time)
+        {
+            stub_hub_free_time = current_time;
+        }
+        stub_hub_free_time += STUB_HUB_DEVICE_START_MS;
+        handle->start_complete_time = stub_hub_free_time;
+
+        set_device_state(handle, DEVICE_STATE_STARTING);
+        result = 0;
+    }
+
+    return result;
+}
+
+int device_stop(DEVICE_HANDLE handle)
+{
+    if (handle->state != DEVICE_STATE_STOPPED)
+    {
+        set_device_state(handle, DEVICE_STATE_STOPPED);
+    }
+
+    return 0;
+}
+
+void device_do_work(DEVICE_HANDLE handle)
+{
+    if (handle->state == DEVICE_STATE_STARTING && get_stub_hub_time() >= handle->start_complete_time)
+    {
+        set_device_state(handle, DEVICE_STATE_STARTED);
+    }
+}
+
+int device_send_event_async(DEVICE_HANDLE handle, IOTHUB_MESSAGE_LIST* message, ON_DEVICE_D2C_EVENT_SEND_COMPLETE on_device_d2c_event_send_complete_callback, void* context)
+{
+    (void)handle;
+    on_device_d2c_event_send_complete_callback(message, D2C_EVENT_SEND_COMPLETE_RESULT_OK, context);
+    return 0;
+}
+
+int device_get_send_status(DEVICE_HANDLE handle, DEVICE_SEND_STATUS* send_status)
+{
+    (void)handle;
+    *send_status = DEVICE_SEND_STATUS_IDLE;
+    return 0;
+}
+
+int device_get_sas_token_refresh_count(DEVICE_HANDLE handle, uint64_t* sas_token_refresh_count)
+{
+    (void)handle;
+    *sas_token_refresh_count = 0;
+    return 0;
+}
+
+int device_subscribe_message(DEVICE_HANDLE handle, ON_DEVICE_C2D_MESSAGE_RECEIVED on_message_received_callback, void* context)
+{
+    (void)handle;
+    (void)on_message_received_callback;
+    (void)context;
+    return 0;
+}
+
+int device_unsubscribe_message(DEVICE_HANDLE handle)
+{
+    (void)handle;
+    return 0;
+}
+
+int device_send_message_disposition(DEVICE_HANDLE device_handle, DEVICE_MESSAGE_DISPOSITION_INFO* disposition_info, DEVICE_MESSAGE_DISPOSITION_RESULT disposition_result)
+{
+    (void)device_handle;
+    (void)disposition_info;
+    (void)disposition_result;
+    return 0;
+}
+
+int device_set_retry_policy(DEVICE_HANDLE handle, IOTHUB_CLIENT_RETRY_POLICY policy, size_t retry_timeout_limit_in_seconds)
+{
+    (void)handle;
+    (void)policy;
+    (void)retry_timeout_limit_in_seconds;
+    return 0;
+}
+
+int device_set_option(DEVICE_HANDLE handle, const char* name, void* value)
+{
+    (void)handle;
+    (void)name;
+    (void)value;
+    return 0;
+}
+
+OPTIONHANDLER_HANDLE device_retrieve_options(DEVICE_HANDLE handle)
+{
+    (void)handle;
+    return NULL;
+}
+
+/*the amqp_connection stub never opens the io, so it only has to exist*/
+static void* unopened_io_clone_option(const char* name, const void* value)
+{
+    (void)name;
+    (void)value;
+    return NULL;
+}
+
+static void unopened_io_destroy_option(const char* name, const void* value)
+{
+    (void)name;
+    (void)value;
+}
+
+static int unopened_io_setoption(CONCRETE_IO_HANDLE concrete_io, const char* optionName, const void* value)
+{
+    (void)concrete_io;
+    (void)optionName;
+    (void)value;
+    return 0;
+}
+
+static OPTIONHANDLER_HANDLE unopened_io_retrieveoptions(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+    return OptionHandler_Create(unopened_io_clone_option, unopened_io_destroy_option, unopened_io_setoption);
+}
+
+static CONCRETE_IO_HANDLE unopened_io_create(void* io_create_parameters)
+{
+    (void)io_create_parameters;
+    return (CONCRETE_IO_HANDLE)&stub_hub_link_endpoint;
+}
+
+static void unopened_io_destroy(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+}
+
+static int unopened_io_open(CONCRETE_IO_HANDLE concrete_io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    (void)concrete_io;
+    (void)on_io_open_complete;
+    (void)on_io_open_complete_context;
+    (void)on_bytes_received;
+    (void)on_bytes_received_context;
+    (void)on_io_error;
+    (void)on_io_error_context;
+    return __FAILURE__;
+}
+
+static int unopened_io_close(CONCRETE_IO_HANDLE concrete_io, ON_IO_CLOSE_COMPLETE on_io_close_complete, void* callback_context)
+{
+    (void)concrete_io;
+    (void)on_io_close_complete;
+    (void)callback_context;
+    return 0;
+}
+
+static int unopened_io_send(CONCRETE_IO_HANDLE concrete_io, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    (void)concrete_io;
+    (void)buffer;
+    (void)size;
+    (void)on_send_complete;
+    (void)callback_context;
+    return __FAILURE__;
+}
+
+static void unopened_io_dowork(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+}
+
+static const IO_INTERFACE_DESCRIPTION unopened_io_interface_description =
+{
+    unopened_io_retrieveoptions,
+    unopened_io_create,
+    unopened_io_destroy,
+    unopened_io_open,
+    unopened_io_close,
+    unopened_io_send,
+    unopened_io_dowork,
+    unopened_io_setoption
+};
+
+static XIO_HANDLE get_unopened_io(const char* target_fqdn, const AMQP_TRANSPORT_PROXY_OPTIONS* amqp_transport_proxy_options)
+{
+    (void)target_fqdn;
+    (void)amqp_transport_proxy_options;
+    return xio_create(&unopened_io_interface_description, NULL);
+}
+
+static TRANSPORT_PROVIDER stub_hub_amqp_transport;
+
+static TRANSPORT_LL_HANDLE StubHubAmqp_Create(const IOTHUBTRANSPORT_CONFIG* config)
+{
+    return IoTHubTransport_AMQP_Common_Create(config, get_unopened_io);
+}
+
+/*the AMQP transport as shipped, except that it never opens a real io*/
+static const TRANSPORT_PROVIDER* StubHubAmqp_Protocol(void)
+{
+    stub_hub_amqp_transport = *AMQP_Protocol();
+    stub_hub_amqp_transport.IoTHubTransport_Create = StubHubAmqp_Create;
+    return &stub_hub_amqp_transport;
+}
+
+/*RECONNECT_DEVICE_COUNT devices multiplexed on one AMQP transport*/
+typedef struct RECONNECT_BENCHMARK_TAG
+{
+    /*the transport only uses the client to read its options and report connection status changes*/
+    IOTHUB_CLIENT_LL_HANDLE client_handle;
+    TRANSPORT_LL_HANDLE transport_handle;
+    DLIST_ENTRY waiting_to_send[RECONNECT_DEVICE_COUNT];
+    IOTHUB_DEVICE_HANDLE device_handles[RECONNECT_DEVICE_COUNT];
+} RECONNECT_BENCHMARK;
+
+/*calls DoWork until the connection is open and every device is started again*/
+static int wait_for_all_devices_started(RECONNECT_BENCHMARK* reconnect_benchmark)
+{
+    int result;
+    tickcounter_ms_t deadline = get_stub_hub_time() + MAX_RECONNECT_TIME_MS;
+
+    for (;;)
+    {
+        IoTHubTransport_AMQP_Common_DoWork(reconnect_benchmark->transport_handle, reconnect_benchmark->client_handle);
+
+        if (stub_hub_connection != NULL &&
+            stub_hub_connection->state == AMQP_CONNECTION_STATE_OPENED &&
+            stub_hub_started_device_count == RECONNECT_DEVICE_COUNT)
+        {
+            result = 0;
+            break;
+        }
+        else if (get_stub_hub_time() > deadline)
+        {
+            (void)fprintf(stderr, "only %lu of %lu devices started within %lu ms\r\n",
+                (unsigned long)stub_hub_started_device_count, (unsigned long)RECONNECT_DEVICE_COUNT, (unsigned long)MAX_RECONNECT_TIME_MS);
+            result = __LINE__;
+            break;
+        }
+
+        ThreadAPI_Sleep(DO_WORK_INTERVAL_MS);
+    }
+
+    return result;
+}
+
+static void reconnect_teardown(void* context)
+{
+    RECONNECT_BENCHMARK* reconnect_benchmark = (RECONNECT_BENCHMARK*)context;
+    size_t i;
+
+    for (i = 0; i < RECONNECT_DEVICE_COUNT; i++)
+    {
+        if (reconnect_benchmark->device_handles[i] != NULL)
+        {
+            IoTHubTransport_AMQP_Common_Unregister(reconnect_benchmark->device_handles[i]);
+        }
+    }
+
+    if (reconnect_benchmark->transport_handle != NULL)
+    {
+        IoTHubTransport_AMQP_Common_Destroy(reconnect_benchmark->transport_handle);
+    }
+
+    if (reconnect_benchmark->client_handle != NULL)
+    {
+        IoTHubClient_LL_Destroy(reconnect_benchmark->client_handle);
+    }
+
+    if (stub_hub_tick_counter != NULL)
+    {
+        tickcounter_destroy(stub_hub_tick_counter);
+        stub_hub_tick_counter = NULL;
+    }
+
+    free(reconnect_benchmark);
+}
+
+static int register_devices(RECONNECT_BENCHMARK* reconnect_benchmark)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < RECONNECT_DEVICE_COUNT; i++)
+    {
+        char device_id[32];
+        IOTHUB_DEVICE_CONFIG device_config;
+
+        (void)sprintf(device_id, "benchmark-device-%lu", (unsigned long)i);
+        device_config.deviceId = device_id;
+        device_config.deviceKey = "AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=";
+        device_config.deviceSasToken = NULL;
+        device_config.authorization_module = NULL;
+
+        DList_InitializeListHead(&reconnect_benchmark->waiting_to_send[i]);
+
+        if ((reconnect_benchmark->device_handles[i] = IoTHubTransport_AMQP_Common_Register(reconnect_benchmark->transport_handle, &device_config, reconnect_benchmark->client_handle, &reconnect_benchmark->waiting_to_send[i])) == NULL)
+        {
+            result = __LINE__;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static int reconnect_setup_with_device_starts_per_second(void** context, size_t device_starts_per_second)
+{
+    int result;
+    RECONNECT_BENCHMARK* reconnect_benchmark;
+
+    if ((reconnect_benchmark = (RECONNECT_BENCHMARK*)malloc(sizeof(RECONNECT_BENCHMARK))) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        IOTHUB_CLIENT_CONFIG client_config;
+        IOTHUBTRANSPORT_CONFIG transport_config;
+        DLIST_ENTRY transport_waiting_to_send;
+
+        memset(reconnect_benchmark, 0, sizeof(RECONNECT_BENCHMARK));
+        stub_hub_free_time = 0;
+        stub_hub_started_device_count = 0;
+
+        memset(&client_config, 0, sizeof(IOTHUB_CLIENT_CONFIG));
+        client_config.protocol = StubHubAmqp_Protocol;
+        client_config.iotHubName = "benchmark-hub";
+        client_config.iotHubSuffix = "azure-devices.net";
+
+        DList_InitializeListHead(&transport_waiting_to_send);
+        transport_config.upperConfig = &client_config;
+        transport_config.waitingToSend = &transport_waiting_to_send;
+        transport_config.auth_module_handle = NULL;
+
+        if ((stub_hub_tick_counter = tickcounter_create()) == NULL ||
+            (reconnect_benchmark->client_handle = IoTHubClient_LL_CreateFromConnectionString(BENCHMARK_CONNECTION_STRING, StubHubAmqp_Protocol)) == NULL ||
+            (reconnect_benchmark->transport_handle = IoTHubTransport_AMQP_Common_Create(&transport_config, get_unopened_io)) == NULL ||
+            IoTHubTransport_AMQP_Common_SetRetryPolicy(reconnect_benchmark->transport_handle, IOTHUB_CLIENT_RETRY_IMMEDIATE, 0) != 0 ||
+            IoTHubTransport_AMQP_Common_SetOption(reconnect_benchmark->transport_handle, OPTION_DEVICE_STARTS_PER_SECOND, &device_starts_per_second) != IOTHUB_CLIENT_OK ||
+            register_devices(reconnect_benchmark) != 0 ||
+            wait_for_all_devices_started(reconnect_benchmark) != 0)
+        {
+            reconnect_teardown(reconnect_benchmark);
+            result = __LINE__;
+        }
+        else
+        {
+            *context = reconnect_benchmark;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int reconnect_setup(void** context)
+{
+    return reconnect_setup_with_device_starts_per_second(context, 0);
+}
+
+static int reconnect_limited_setup(void** context)
+{
+    return reconnect_setup_with_device_starts_per_second(context, RECONNECT_DEVICE_STARTS_PER_SECOND);
+}
+
+/*drops the connection of RECONNECT_DEVICE_COUNT started devices and measures the time until all of them are started again*/
+static int reconnect_run_once(void* context)
+{
+    int result;
+
+    if (stub_hub_connection == NULL || stub_hub_connection->state != AMQP_CONNECTION_STATE_OPENED)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        set_amqp_connection_state(stub_hub_connection, AMQP_CONNECTION_STATE_ERROR);
+        result = wait_for_all_devices_started((RECONNECT_BENCHMARK*)context);
+    }
+
+    return result;
+}
+
+static const BENCHMARK amqp_reconnect_benchmarks[] =
+{
+    { "amqp_reconnect_1000_devices", reconnect_setup, reconnect_run_once, reconnect_teardown, RECONNECT_MAX_ITERATIONS },
+    { "amqp_reconnect_1000_devices_500_starts_per_second", reconnect_limited_setup, reconnect_run_once, reconnect_teardown, RECONNECT_MAX_ITERATIONS }
+};
+
+const BENCHMARK* amqp_reconnect_benchmarks_get(size_t* count)
+{
+    *count = sizeof(amqp_reconnect_benchmarks) / sizeof(amqp_reconnect_benchmarks[0]);
+    return amqp_reconnect_benchmarks;
+}
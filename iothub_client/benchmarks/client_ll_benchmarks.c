@@ -0,0 +1,227 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/doublylinkedlist.h"
+#include "azure_c_shared_utility/strings.h"
+#include "iothub_client_ll.h"
+#include "iothub_client_options.h"
+#include "iothub_client_private.h"
+#include "iothub_transport_ll.h"
+#include "iothub_client_benchmarks.h"
+
+#define BENCHMARK_MESSAGE_POOL_SIZE 16
+
+/*A transport that completes every queued event on DoWork, so that the IoTHubClient_LL cost is measured alone*/
+typedef struct IN_PROCESS_TRANSPORT_TAG
+{
+    STRING_HANDLE hostname;
+    PDLIST_ENTRY waitingToSend;
+} IN_PROCESS_TRANSPORT;
+
+static TRANSPORT_LL_HANDLE InProcessTransport_Create(const IOTHUBTRANSPORT_CONFIG* config)
+{
+    IN_PROCESS_TRANSPORT* result;
+
+    if ((result = (IN_PROCESS_TRANSPORT*)malloc(sizeof(IN_PROCESS_TRANSPORT))) != NULL)
+    {
+        result->waitingToSend = config->waitingToSend;
+
+        if ((result->hostname = STRING_construct_sprintf("%s.%s", config->upperConfig->iotHubName, config->upperConfig->iotHubSuffix)) == NULL)
+        {
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+static void InProcessTransport_Destroy(TRANSPORT_LL_HANDLE handle)
+{
+    IN_PROCESS_TRANSPORT* transport = (IN_PROCESS_TRANSPORT*)handle;
+    STRING_delete(transport->hostname);
+    free(transport);
+}
+
+static IOTHUB_DEVICE_HANDLE InProcessTransport_Register(TRANSPORT_LL_HANDLE handle, const IOTHUB_DEVICE_CONFIG* device, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, PDLIST_ENTRY waitingToSend)
+{
+    IN_PROCESS_TRANSPORT* transport = (IN_PROCESS_TRANSPORT*)handle;
+    (void)device;
+    (void)iotHubClientHandle;
+    transport->waitingToSend = waitingToSend;
+    return handle;
+}
+
+static void InProcessTransport_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
+{
+    (void)deviceHandle;
+}
+
+static void InProcessTransport_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
+{
+    IN_PROCESS_TRANSPORT* transport = (IN_PROCESS_TRANSPORT*)handle;
+
+    if (!DList_IsListEmpty(transport->waitingToSend))
+    {
+        DLIST_ENTRY completed;
+        DList_InitializeListHead(&completed);
+
+        while (!DList_IsListEmpty(transport->waitingToSend))
+        {
+            PDLIST_ENTRY oldest = DList_RemoveHeadList(transport->waitingToSend);
+            containingRecord(oldest, IOTHUB_MESSAGE_LIST, entry)->inWaitingToSend = false;
+            DList_InsertTailList(&completed, oldest);
+        }
+
+        IoTHubClient_LL_SendComplete(iotHubClientHandle, &completed, IOTHUB_CLIENT_CONFIRMATION_OK);
+    }
+}
+
+static STRING_HANDLE InProcessTransport_GetHostname(TRANSPORT_LL_HANDLE handle)
+{
+    return ((IN_PROCESS_TRANSPORT*)handle)->hostname;
+}
+
+static IOTHUB_CLIENT_RESULT InProcessTransport_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
+{
+    (void)handle;
+    (void)option;
+    (void)value;
+    return IOTHUB_CLIENT_INVALID_ARG;
+}
+
+static int InProcessTransport_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_RETRY_POLICY retryPolicy, size_t retryTimeoutLimitInSeconds)
+{
+    (void)handle;
+    (void)retryPolicy;
+    (void)retryTimeoutLimitInSeconds;
+    return 0;
+}
+
+static IOTHUB_CLIENT_RESULT InProcessTransport_GetSendStatus(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATUS* iotHubClientStatus)
+{
+    (void)handle;
+    *iotHubClientStatus = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    return IOTHUB_CLIENT_OK;
+}
+
+static int InProcessTransport_Subscribe(IOTHUB_DEVICE_HANDLE handle)
+{
+    (void)handle;
+    return __FAILURE__;
+}
+
+static void InProcessTransport_Unsubscribe(IOTHUB_DEVICE_HANDLE handle)
+{
+    (void)handle;
+}
+
+static int InProcessTransport_DeviceMethod_Response(IOTHUB_DEVICE_HANDLE handle, METHOD_HANDLE methodId, const unsigned char* response, size_t response_size, int status_response)
+{
+    (void)handle;
+    (void)methodId;
+    (void)response;
+    (void)response_size;
+    (void)status_response;
+    return __FAILURE__;
+}
+
+static IOTHUB_CLIENT_RESULT InProcessTransport_SendMessageDisposition(MESSAGE_CALLBACK_INFO* message_data, IOTHUBMESSAGE_DISPOSITION_RESULT disposition)
+{
+    (void)message_data;
+    (void)disposition;
+    return IOTHUB_CLIENT_ERROR;
+}
+
+static IOTHUB_PROCESS_ITEM_RESULT InProcessTransport_ProcessItem(TRANSPORT_LL_HANDLE handle, IOTHUB_IDENTITY_TYPE item_type, IOTHUB_IDENTITY_INFO* iothub_item)
+{
+    (void)handle;
+    (void)item_type;
+    (void)iothub_item;
+    return IOTHUB_PROCESS_ERROR;
+}
+
+static TRANSPORT_PROVIDER in_process_transport =
+{
+    InProcessTransport_SendMessageDisposition,      /*pfIotHubTransport_SendMessageDisposition IoTHubTransport_SendMessageDisposition;*/
+    InProcessTransport_Subscribe,                   /*pfIoTHubTransport_Subscribe_DeviceMethod IoTHubTransport_Subscribe_DeviceMethod;*/
+    InProcessTransport_Unsubscribe,                 /*pfIoTHubTransport_Unsubscribe_DeviceMethod IoTHubTransport_Unsubscribe_DeviceMethod;*/
+    InProcessTransport_DeviceMethod_Response,       /*pfIoTHubTransport_DeviceMethod_Response IoTHubTransport_DeviceMethod_Response;*/
+    InProcessTransport_Subscribe,                   /*pfIoTHubTransport_Subscribe_DeviceTwin IoTHubTransport_Subscribe_DeviceTwin;*/
+    InProcessTransport_Unsubscribe,                 /*pfIoTHubTransport_Unsubscribe_DeviceTwin IoTHubTransport_Unsubscribe_DeviceTwin;*/
+    InProcessTransport_ProcessItem,                 /*pfIoTHubTransport_ProcessItem IoTHubTransport_ProcessItem;*/
+    InProcessTransport_GetHostname,                 /*pfIoTHubTransport_GetHostname IoTHubTransport_GetHostname;*/
+    InProcessTransport_SetOption,                   /*pfIoTHubTransport_SetOption IoTHubTransport_SetOption;*/
+    InProcessTransport_Create,                      /*pfIoTHubTransport_Create IoTHubTransport_Create;*/
+    InProcessTransport_Destroy,                     /*pfIoTHubTransport_Destroy IoTHubTransport_Destroy;*/
+    InProcessTransport_Register,                    /*pfIotHubTransport_Register IoTHubTransport_Register;*/
+    InProcessTransport_Unregister,                  /*pfIotHubTransport_Unregister IoTHubTransport_Unegister;*/
+    InProcessTransport_Subscribe,                   /*pfIoTHubTransport_Subscribe IoTHubTransport_Subscribe;*/
+    InProcessTransport_Unsubscribe,                 /*pfIoTHubTransport_Unsubscribe IoTHubTransport_Unsubscribe;*/
+    InProcessTransport_DoWork,                      /*pfIoTHubTransport_DoWork IoTHubTransport_DoWork;*/
+    InProcessTransport_SetRetryPolicy,              /*pfIoTHubTransport_DoWork IoTHubTransport_SetRetryPolicy;*/
+    InProcessTransport_GetSendStatus                /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+};
+
+static const TRANSPORT_PROVIDER* InProcess_Protocol(void)
+{
+    return &in_process_transport;
+}
+
+static int send_event_setup(void** context)
+{
+    *context = benchmark_client_create(InProcess_Protocol);
+    return (*context == NULL ? __LINE__ : 0);
+}
+
+static int send_event_pooled_setup(void** context)
+{
+    int result;
+    BENCHMARK_CLIENT* benchmark_client;
+
+    if ((benchmark_client = benchmark_client_create(InProcess_Protocol)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        size_t pool_size = BENCHMARK_MESSAGE_POOL_SIZE;
+
+        if (IoTHubClient_LL_SetOption(benchmark_client->client_handle, OPTION_MESSAGE_POOL_SIZE, &pool_size) != IOTHUB_CLIENT_OK)
+        {
+            benchmark_client_destroy(benchmark_client);
+            result = __LINE__;
+        }
+        else
+        {
+            *context = benchmark_client;
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static int send_event_run_once(void* context)
+{
+    return benchmark_client_send((BENCHMARK_CLIENT*)context, 1);
+}
+
+static void send_event_teardown(void* context)
+{
+    benchmark_client_destroy((BENCHMARK_CLIENT*)context);
+}
+
+static const BENCHMARK client_ll_benchmarks[] =
+{
+    { "client_ll_send_event_do_work", send_event_setup, send_event_run_once, send_event_teardown, 0 },
+    { "client_ll_send_event_do_work_pooled", send_event_pooled_setup, send_event_run_once, send_event_teardown, 0 }
+};
+
+const BENCHMARK* client_ll_benchmarks_get(size_t* count)
+{
+    *count = sizeof(client_ll_benchmarks) / sizeof(client_ll_benchmarks[0]);
+    return client_ll_benchmarks;
+}
@@ -0,0 +1,183 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "iothub_client_device_index.h"
+#include "iothub_client_benchmarks.h"
+
+#define INDEXED_DEVICE_COUNT 10000
+#define ADD_FIND_REMOVE_MAX_ITERATIONS 100
+
+/*the device ids a multiplexing transport would index, and the device instances they stand for*/
+typedef struct INDEXED_DEVICES_TAG
+{
+    DEVICE_INDEX_HANDLE device_index;
+    char device_ids[INDEXED_DEVICE_COUNT][32];
+    size_t next_lookup;
+} INDEXED_DEVICES;
+
+static void* get_indexed_device(size_t index)
+{
+    return (void*)(uintptr_t)(0x10000 + index * 16);
+}
+
+static int indexed_devices_setup(void** context)
+{
+    int result;
+    INDEXED_DEVICES* indexed_devices;
+
+    if ((indexed_devices = (INDEXED_DEVICES*)malloc(sizeof(INDEXED_DEVICES))) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < INDEXED_DEVICE_COUNT; i++)
+        {
+            (void)sprintf(indexed_devices->device_ids[i], "benchmark-device-%lu", (unsigned long)i);
+        }
+
+        indexed_devices->device_index = NULL;
+        indexed_devices->next_lookup = 0;
+        *context = indexed_devices;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int add_all_devices(INDEXED_DEVICES* indexed_devices)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < INDEXED_DEVICE_COUNT; i++)
+    {
+        if (device_index_add(indexed_devices->device_index, indexed_devices->device_ids[i], get_indexed_device(i)) != 0)
+        {
+            result = __LINE__;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static int populated_index_setup(void** context)
+{
+    int result;
+
+    if (indexed_devices_setup(context) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        INDEXED_DEVICES* indexed_devices = (INDEXED_DEVICES*)*context;
+
+        if ((indexed_devices->device_index = device_index_create()) == NULL ||
+            add_all_devices(indexed_devices) != 0)
+        {
+            if (indexed_devices->device_index != NULL)
+            {
+                device_index_destroy(indexed_devices->device_index);
+            }
+            free(indexed_devices);
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+static void indexed_devices_teardown(void* context)
+{
+    INDEXED_DEVICES* indexed_devices = (INDEXED_DEVICES*)context;
+
+    if (indexed_devices->device_index != NULL)
+    {
+        device_index_destroy(indexed_devices->device_index);
+    }
+
+    free(indexed_devices);
+}
+
+/*what registering, looking up once and unregistering every device of a gateway costs*/
+static int add_find_remove_run_once(void* context)
+{
+    int result;
+    INDEXED_DEVICES* indexed_devices = (INDEXED_DEVICES*)context;
+
+    if ((indexed_devices->device_index = device_index_create()) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        size_t i;
+
+        result = add_all_devices(indexed_devices);
+
+        for (i = 0; result == 0 && i < INDEXED_DEVICE_COUNT; i++)
+        {
+            if (device_index_find_by_id(indexed_devices->device_index, indexed_devices->device_ids[i]) != get_indexed_device(i) ||
+                !device_index_contains(indexed_devices->device_index, get_indexed_device(i)))
+            {
+                result = __LINE__;
+            }
+        }
+
+        for (i = 0; result == 0 && i < INDEXED_DEVICE_COUNT; i++)
+        {
+            if (device_index_remove(indexed_devices->device_index, get_indexed_device(i)) != 0)
+            {
+                result = __LINE__;
+            }
+        }
+
+        device_index_destroy(indexed_devices->device_index);
+        indexed_devices->device_index = NULL;
+    }
+
+    return result;
+}
+
+/*the lookup a transport does for every message of a device*/
+static int find_by_id_run_once(void* context)
+{
+    int result;
+    INDEXED_DEVICES* indexed_devices = (INDEXED_DEVICES*)context;
+    size_t i = indexed_devices->next_lookup;
+
+    if (device_index_find_by_id(indexed_devices->device_index, indexed_devices->device_ids[i]) != get_indexed_device(i))
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        indexed_devices->next_lookup = (i + 1) % INDEXED_DEVICE_COUNT;
+        result = 0;
+    }
+
+    return result;
+}
+
+static const BENCHMARK device_index_benchmarks[] =
+{
+    { "device_index_add_find_remove_10000_devices", indexed_devices_setup, add_find_remove_run_once, indexed_devices_teardown, ADD_FIND_REMOVE_MAX_ITERATIONS },
+    { "device_index_find_by_id_10000_devices", populated_index_setup, find_by_id_run_once, indexed_devices_teardown, 0 }
+};
+
+const BENCHMARK* device_index_benchmarks_get(size_t* count)
+{
+    *count = sizeof(device_index_benchmarks) / sizeof(device_index_benchmarks[0]);
+    return device_index_benchmarks;
+}
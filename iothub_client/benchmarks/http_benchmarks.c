@@ -0,0 +1,224 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include "azure_c_shared_utility/httpapi.h"
+#include "azure_c_shared_utility/threadapi.h"
+#include "iothub_client_ll.h"
+#include "iothub_client_options.h"
+#include "iothubtransporthttp.h"
+#include "iothub_client_benchmarks.h"
+#ifndef DONT_USE_UPLOADTOBLOB
+#include "blob.h"
+#endif
+
+#define BENCHMARK_BATCH_SIZE 16
+
+/*
+ * The benchmarks executable provides the HTTPAPI platform layer itself, in place of the one built into the shared utility
+ * library: every request completes in-process with "204 No Content", which is what the IoT hub answers to an event POST
+ * and to a C2D GET with no message waiting.
+ * Requests to BENCHMARK_STORAGE_HOST are answered with "201 Created" after sleeping for a round trip plus the time the
+ * content would take on the wire, so that the blob upload benchmarks measure how well the network waits overlap.
+ */
+#define BENCHMARK_STORAGE_HOST "benchmark.blob.core.windows.net"
+#define BENCHMARK_STORAGE_ROUND_TRIP_MS 20
+#define BENCHMARK_STORAGE_MS_PER_MB 10
+
+static int in_process_connection;
+static int storage_connection;
+
+HTTPAPI_RESULT HTTPAPI_Init(void)
+{
+    return HTTPAPI_OK;
+}
+
+void HTTPAPI_Deinit(void)
+{
+}
+
+HTTP_HANDLE HTTPAPI_CreateConnection(const char* hostName)
+{
+    return (HTTP_HANDLE)((hostName != NULL && strcmp(hostName, BENCHMARK_STORAGE_HOST) == 0) ? &storage_connection : &in_process_connection);
+}
+
+void HTTPAPI_CloseConnection(HTTP_HANDLE handle)
+{
+    (void)handle;
+}
+
+HTTPAPI_RESULT HTTPAPI_ExecuteRequest(HTTP_HANDLE handle, HTTPAPI_REQUEST_TYPE requestType, const char* relativePath,
+    HTTP_HEADERS_HANDLE httpHeadersHandle, const unsigned char* content,
+    size_t contentLength, unsigned int* statusCode,
+    HTTP_HEADERS_HANDLE responseHeadersHandle, BUFFER_HANDLE responseContent)
+{
+    (void)requestType;
+    (void)relativePath;
+    (void)httpHeadersHandle;
+    (void)content;
+    (void)responseHeadersHandle;
+    (void)responseContent;
+
+    if (handle == (HTTP_HANDLE)&storage_connection)
+    {
+        ThreadAPI_Sleep((unsigned int)(BENCHMARK_STORAGE_ROUND_TRIP_MS + (contentLength * BENCHMARK_STORAGE_MS_PER_MB) / (1024 * 1024)));
+    }
+
+    if (statusCode != NULL)
+    {
+        *statusCode = (handle == (HTTP_HANDLE)&storage_connection) ? 201 : 204;
+    }
+
+    return HTTPAPI_OK;
+}
+
+HTTPAPI_RESULT HTTPAPI_SetOption(HTTP_HANDLE handle, const char* optionName, const void* value)
+{
+    (void)handle;
+    (void)optionName;
+    (void)value;
+    return HTTPAPI_OK;
+}
+
+HTTPAPI_RESULT HTTPAPI_CloneOption(const char* optionName, const void* value, const void** savedValue)
+{
+    (void)optionName;
+    (void)value;
+    (void)savedValue;
+    return HTTPAPI_INVALID_ARG;
+}
+
+static int send_events_setup(void** context, bool batching)
+{
+    int result;
+    BENCHMARK_CLIENT* benchmark_client;
+
+    if ((benchmark_client = benchmark_client_create(HTTP_Protocol)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else if (IoTHubClient_LL_SetOption(benchmark_client->client_handle, OPTION_BATCHING, &batching) != IOTHUB_CLIENT_OK)
+    {
+        benchmark_client_destroy(benchmark_client);
+        result = __LINE__;
+    }
+    else
+    {
+        *context = benchmark_client;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int send_events_batched_setup(void** context)
+{
+    return send_events_setup(context, true);
+}
+
+static int send_events_unbatched_setup(void** context)
+{
+    return send_events_setup(context, false);
+}
+
+static int send_events_run_once(void* context)
+{
+    return benchmark_client_send((BENCHMARK_CLIENT*)context, BENCHMARK_BATCH_SIZE);
+}
+
+static void send_events_teardown(void* context)
+{
+    benchmark_client_destroy((BENCHMARK_CLIENT*)context);
+}
+
+#ifndef DONT_USE_UPLOADTOBLOB
+#define BENCHMARK_BLOB_SIZE (64 * 1024 * 1024)
+#define BENCHMARK_BLOB_ITERATIONS 5
+
+typedef struct BLOB_UPLOAD_CONTEXT_TAG
+{
+    unsigned char* source;
+    size_t concurrency;
+} BLOB_UPLOAD_CONTEXT;
+
+static int blob_upload_setup(void** context, size_t concurrency)
+{
+    int result;
+    BLOB_UPLOAD_CONTEXT* blob_upload;
+
+    if ((blob_upload = (BLOB_UPLOAD_CONTEXT*)malloc(sizeof(BLOB_UPLOAD_CONTEXT))) == NULL)
+    {
+        result = __LINE__;
+    }
+    else if ((blob_upload->source = (unsigned char*)malloc(BENCHMARK_BLOB_SIZE)) == NULL)
+    {
+        free(blob_upload);
+        result = __LINE__;
+    }
+    else
+    {
+        (void)memset(blob_upload->source, 'b', BENCHMARK_BLOB_SIZE);
+        blob_upload->concurrency = concurrency;
+        *context = blob_upload;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int blob_upload_concurrency_1_setup(void** context)
+{
+    return blob_upload_setup(context, 1);
+}
+
+static int blob_upload_concurrency_2_setup(void** context)
+{
+    return blob_upload_setup(context, 2);
+}
+
+static int blob_upload_concurrency_4_setup(void** context)
+{
+    return blob_upload_setup(context, 4);
+}
+
+static int blob_upload_concurrency_8_setup(void** context)
+{
+    return blob_upload_setup(context, 8);
+}
+
+static int blob_upload_run_once(void* context)
+{
+    BLOB_UPLOAD_CONTEXT* blob_upload = (BLOB_UPLOAD_CONTEXT*)context;
+    unsigned int httpStatus;
+
+    return (Blob_UploadBlocksFromSasUri("https://" BENCHMARK_STORAGE_HOST "/container/blob?sv=2016-05-31&sig=benchmark", blob_upload->source, BENCHMARK_BLOB_SIZE,
+        BLOB_BLOCK_SIZE_MAX, blob_upload->concurrency, &httpStatus, NULL, NULL) == BLOB_OK && httpStatus == 201) ? 0 : __LINE__;
+}
+
+static void blob_upload_teardown(void* context)
+{
+    BLOB_UPLOAD_CONTEXT* blob_upload = (BLOB_UPLOAD_CONTEXT*)context;
+    free(blob_upload->source);
+    free(blob_upload);
+}
+#endif
+
+static const BENCHMARK http_benchmarks[] =
+{
+    { "http_send_16_events_do_work", send_events_unbatched_setup, send_events_run_once, send_events_teardown, 0 },
+    { "http_send_16_events_do_work_batched", send_events_batched_setup, send_events_run_once, send_events_teardown, 0 },
+#ifndef DONT_USE_UPLOADTOBLOB
+    { "http_blob_upload_64MB_concurrency_1", blob_upload_concurrency_1_setup, blob_upload_run_once, blob_upload_teardown, BENCHMARK_BLOB_ITERATIONS },
+    { "http_blob_upload_64MB_concurrency_2", blob_upload_concurrency_2_setup, blob_upload_run_once, blob_upload_teardown, BENCHMARK_BLOB_ITERATIONS },
+    { "http_blob_upload_64MB_concurrency_4", blob_upload_concurrency_4_setup, blob_upload_run_once, blob_upload_teardown, BENCHMARK_BLOB_ITERATIONS },
+    { "http_blob_upload_64MB_concurrency_8", blob_upload_concurrency_8_setup, blob_upload_run_once, blob_upload_teardown, BENCHMARK_BLOB_ITERATIONS },
+#endif
+};
+
+const BENCHMARK* http_benchmarks_get(size_t* count)
+{
+    *count = sizeof(http_benchmarks) / sizeof(http_benchmarks[0]);
+    return http_benchmarks;
+}
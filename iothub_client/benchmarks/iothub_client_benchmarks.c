@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "azure_c_shared_utility/map.h"
+#include "iothub_client_benchmarks.h"
+
+/*transports with an in-process io need a few DoWork calls to connect; this only bounds a broken one*/
+#define MAX_DO_WORK_CALLS_PER_SEND 1000
+
+const unsigned char BENCHMARK_PAYLOAD[] = "{\"deviceId\":\"benchmark-device\",\"temperature\":21.5,\"humidity\":60.25}";
+const size_t BENCHMARK_PAYLOAD_SIZE = sizeof(BENCHMARK_PAYLOAD) - 1;
+
+const char* BENCHMARK_CONNECTION_STRING = "HostName=benchmark-hub.azure-devices.net;DeviceId=benchmark-device;SharedAccessKey=AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA=";
+
+IOTHUB_MESSAGE_HANDLE benchmark_create_message(void)
+{
+    IOTHUB_MESSAGE_HANDLE result;
+
+    if ((result = IoTHubMessage_CreateFromByteArray(BENCHMARK_PAYLOAD, BENCHMARK_PAYLOAD_SIZE)) != NULL)
+    {
+        MAP_HANDLE properties = IoTHubMessage_Properties(result);
+
+        if (IoTHubMessage_SetMessageId(result, "3c1b6e0a-6c5f-4f0e-9d8b-5b1c2a7e4f10") != IOTHUB_MESSAGE_OK ||
+            IoTHubMessage_SetCorrelationId(result, "benchmark-correlation") != IOTHUB_MESSAGE_OK ||
+            properties == NULL ||
+            Map_AddOrUpdate(properties, "temperatureAlert", "false") != MAP_OK ||
+            Map_AddOrUpdate(properties, "sensor", "bme280 rev 2") != MAP_OK)
+        {
+            IoTHubMessage_Destroy(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+static void on_send_confirmation(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* userContextCallback)
+{
+    BENCHMARK_CLIENT* benchmark_client = (BENCHMARK_CLIENT*)userContextCallback;
+
+    if (result == IOTHUB_CLIENT_CONFIRMATION_OK)
+    {
+        benchmark_client->confirmed_count++;
+    }
+    else
+    {
+        benchmark_client->failed_count++;
+    }
+}
+
+BENCHMARK_CLIENT* benchmark_client_create(IOTHUB_CLIENT_TRANSPORT_PROVIDER protocol)
+{
+    BENCHMARK_CLIENT* result;
+
+    if ((result = (BENCHMARK_CLIENT*)malloc(sizeof(BENCHMARK_CLIENT))) != NULL)
+    {
+        result->confirmed_count = 0;
+        result->failed_count = 0;
+
+        if ((result->message = benchmark_create_message()) == NULL)
+        {
+            free(result);
+            result = NULL;
+        }
+        else if ((result->client_handle = IoTHubClient_LL_CreateFromConnectionString(BENCHMARK_CONNECTION_STRING, protocol)) == NULL)
+        {
+            IoTHubMessage_Destroy(result->message);
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+int benchmark_client_send(BENCHMARK_CLIENT* benchmark_client, size_t message_count)
+{
+    int result = 0;
+    size_t expected_count = benchmark_client->confirmed_count + message_count;
+    size_t i;
+
+    for (i = 0; i < message_count; i++)
+    {
+        if (IoTHubClient_LL_SendEventAsync(benchmark_client->client_handle, benchmark_client->message, on_send_confirmation, benchmark_client) != IOTHUB_CLIENT_OK)
+        {
+            result = __LINE__;
+            break;
+        }
+    }
+
+    if (result == 0)
+    {
+        for (i = 0; i < MAX_DO_WORK_CALLS_PER_SEND && benchmark_client->confirmed_count < expected_count && benchmark_client->failed_count == 0; i++)
+        {
+            IoTHubClient_LL_DoWork(benchmark_client->client_handle);
+        }
+
+        if (benchmark_client->confirmed_count != expected_count)
+        {
+            result = __LINE__;
+        }
+    }
+
+    return result;
+}
+
+void benchmark_client_destroy(BENCHMARK_CLIENT* benchmark_client)
+{
+    IoTHubClient_LL_Destroy(benchmark_client->client_handle);
+    IoTHubMessage_Destroy(benchmark_client->message);
+    free(benchmark_client);
+}
@@ -0,0 +1,60 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_BENCHMARKS_H
+#define IOTHUB_CLIENT_BENCHMARKS_H
+
+#include <stddef.h>
+#include "benchmark.h"
+#include "iothub_message.h"
+#include "iothub_client_ll.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* JSON telemetry payload sent by all benchmarks */
+extern const unsigned char BENCHMARK_PAYLOAD[];
+extern const size_t BENCHMARK_PAYLOAD_SIZE;
+
+/* Creates the message used by all benchmarks: a small JSON payload with a message id, a correlation id and two application properties. */
+extern IOTHUB_MESSAGE_HANDLE benchmark_create_message(void);
+
+/* Connection string of the device used by the benchmarks that go through IoTHubClient_LL. Nothing is ever sent to this hub. */
+extern const char* BENCHMARK_CONNECTION_STRING;
+
+/* An IoTHubClient_LL instance for BENCHMARK_CONNECTION_STRING and the message it sends. */
+typedef struct BENCHMARK_CLIENT_TAG
+{
+    IOTHUB_CLIENT_LL_HANDLE client_handle;
+    IOTHUB_MESSAGE_HANDLE message;
+    size_t confirmed_count;
+    size_t failed_count;
+} BENCHMARK_CLIENT;
+
+extern BENCHMARK_CLIENT* benchmark_client_create(IOTHUB_CLIENT_TRANSPORT_PROVIDER protocol);
+/* Queues `message_count` copies of the benchmark message and calls IoTHubClient_LL_DoWork until all of them are confirmed. */
+extern int benchmark_client_send(BENCHMARK_CLIENT* benchmark_client, size_t message_count);
+extern void benchmark_client_destroy(BENCHMARK_CLIENT* benchmark_client);
+
+extern const BENCHMARK* message_benchmarks_get(size_t* count);
+extern const BENCHMARK* client_ll_benchmarks_get(size_t* count);
+extern const BENCHMARK* device_index_benchmarks_get(size_t* count);
+#ifdef BENCHMARK_MQTT
+extern const BENCHMARK* mqtt_benchmarks_get(size_t* count);
+#endif
+#ifdef BENCHMARK_AMQP
+extern const BENCHMARK* amqp_benchmarks_get(size_t* count);
+extern const BENCHMARK* amqp_messenger_benchmarks_get(size_t* count);
+extern const BENCHMARK* amqp_reconnect_benchmarks_get(size_t* count);
+#endif
+#ifdef IOTHUB_CLIENT_BENCHMARKS_HTTP
+extern const BENCHMARK* http_benchmarks_get(size_t* count);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IOTHUB_CLIENT_BENCHMARKS_H */
@@ -0,0 +1,33 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "iothub_client_benchmarks.h"
+
+static const BENCHMARK_GROUP_GET benchmark_groups[] =
+{
+    message_benchmarks_get,
+    client_ll_benchmarks_get,
+    device_index_benchmarks_get,
+#ifdef BENCHMARK_MQTT
+    mqtt_benchmarks_get,
+#endif
+#ifdef BENCHMARK_AMQP
+    amqp_benchmarks_get,
+    amqp_messenger_benchmarks_get,
+    amqp_reconnect_benchmarks_get,
+#endif
+#ifdef BENCHMARK_HTTP
+    http_benchmarks_get,
+#endif
+};
+
+/*
+ * usage: iothub_client_benchmarks [iterations [name_filter]]
+ *
+ * Prints one JSON object per line (see readme.md) for each benchmark whose name contains name_filter.
+ * Returns non-zero if any benchmark failed.
+ */
+int main(int argc, char** argv)
+{
+    return benchmark_main(argc, argv, benchmark_groups, sizeof(benchmark_groups) / sizeof(benchmark_groups[0]));
+}
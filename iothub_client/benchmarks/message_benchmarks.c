@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include "iothub_message.h"
+#include "iothub_client_benchmarks.h"
+
+static int create_from_byte_array_run_once(void* context)
+{
+    int result;
+    IOTHUB_MESSAGE_HANDLE message;
+    (void)context;
+
+    if ((message = IoTHubMessage_CreateFromByteArray(BENCHMARK_PAYLOAD, BENCHMARK_PAYLOAD_SIZE)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        IoTHubMessage_Destroy(message);
+        result = 0;
+    }
+
+    return result;
+}
+
+static int create_from_byte_array_no_copy_run_once(void* context)
+{
+    int result;
+    IOTHUB_MESSAGE_HANDLE message;
+    (void)context;
+
+    if ((message = IoTHubMessage_CreateFromByteArrayNoCopy(BENCHMARK_PAYLOAD, BENCHMARK_PAYLOAD_SIZE, NULL, NULL)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        IoTHubMessage_Destroy(message);
+        result = 0;
+    }
+
+    return result;
+}
+
+static int create_with_properties_run_once(void* context)
+{
+    int result;
+    IOTHUB_MESSAGE_HANDLE message;
+    (void)context;
+
+    if ((message = benchmark_create_message()) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        IoTHubMessage_Destroy(message);
+        result = 0;
+    }
+
+    return result;
+}
+
+static int clone_setup(void** context)
+{
+    *context = benchmark_create_message();
+    return (*context == NULL ? __LINE__ : 0);
+}
+
+static int clone_run_once(void* context)
+{
+    int result;
+    IOTHUB_MESSAGE_HANDLE clone;
+
+    if ((clone = IoTHubMessage_Clone((IOTHUB_MESSAGE_HANDLE)context)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        IoTHubMessage_Destroy(clone);
+        result = 0;
+    }
+
+    return result;
+}
+
+static void clone_teardown(void* context)
+{
+    IoTHubMessage_Destroy((IOTHUB_MESSAGE_HANDLE)context);
+}
+
+static const BENCHMARK message_benchmarks[] =
+{
+    { "iothubmessage_create_from_byte_array", NULL, create_from_byte_array_run_once, NULL, 0 },
+    { "iothubmessage_create_from_byte_array_no_copy", NULL, create_from_byte_array_no_copy_run_once, NULL, 0 },
+    { "iothubmessage_create_with_properties", NULL, create_with_properties_run_once, NULL, 0 },
+    { "iothubmessage_clone", clone_setup, clone_run_once, clone_teardown, 0 }
+};
+
+const BENCHMARK* message_benchmarks_get(size_t* count)
+{
+    *count = sizeof(message_benchmarks) / sizeof(message_benchmarks[0]);
+    return message_benchmarks;
+}
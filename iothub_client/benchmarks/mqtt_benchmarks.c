@@ -0,0 +1,353 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <string.h>
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xio.h"
+#include "azure_c_shared_utility/optionhandler.h"
+#include "iothub_client_ll.h"
+#include "iothub_client_options.h"
+#include "iothub_transport_ll.h"
+#include "iothubtransportmqtt.h"
+#include "iothubtransport_mqtt_common.h"
+#include "iothub_client_benchmarks.h"
+
+#define MQTT_CONNECT        0x10
+#define MQTT_PUBLISH        0x30
+#define MQTT_PINGREQ        0xC0
+#define MQTT_PACKET_TYPE(first_byte)   ((first_byte) & 0xF0)
+#define MQTT_PUBLISH_QOS(first_byte)   (((first_byte) >> 1) & 0x03)
+
+#define MAX_PENDING_RESPONSE_BYTES 1024
+#define BENCHMARK_BATCH_SIZE 16
+
+/*An io that plays the IoT hub side of MQTT in-process: it accepts the CONNECT and acknowledges every QoS 1 PUBLISH*/
+typedef enum IN_PROCESS_IO_STATE_TAG
+{
+    IN_PROCESS_IO_STATE_CLOSED,
+    IN_PROCESS_IO_STATE_OPENING,
+    IN_PROCESS_IO_STATE_OPEN
+} IN_PROCESS_IO_STATE;
+
+typedef struct IN_PROCESS_IO_TAG
+{
+    IN_PROCESS_IO_STATE state;
+    ON_IO_OPEN_COMPLETE on_io_open_complete;
+    void* on_io_open_complete_context;
+    ON_BYTES_RECEIVED on_bytes_received;
+    void* on_bytes_received_context;
+    unsigned char pending_response[MAX_PENDING_RESPONSE_BYTES];
+    size_t pending_response_size;
+} IN_PROCESS_IO;
+
+static void* in_process_io_clone_option(const char* name, const void* value)
+{
+    (void)name;
+    (void)value;
+    return NULL;
+}
+
+static void in_process_io_destroy_option(const char* name, const void* value)
+{
+    (void)name;
+    (void)value;
+}
+
+static int in_process_io_setoption(CONCRETE_IO_HANDLE concrete_io, const char* optionName, const void* value)
+{
+    (void)concrete_io;
+    (void)optionName;
+    (void)value;
+    return 0;
+}
+
+static OPTIONHANDLER_HANDLE in_process_io_retrieveoptions(CONCRETE_IO_HANDLE concrete_io)
+{
+    (void)concrete_io;
+    return OptionHandler_Create(in_process_io_clone_option, in_process_io_destroy_option, in_process_io_setoption);
+}
+
+static CONCRETE_IO_HANDLE in_process_io_create(void* io_create_parameters)
+{
+    IN_PROCESS_IO* result;
+    (void)io_create_parameters;
+
+    if ((result = (IN_PROCESS_IO*)malloc(sizeof(IN_PROCESS_IO))) != NULL)
+    {
+        memset(result, 0, sizeof(IN_PROCESS_IO));
+        result->state = IN_PROCESS_IO_STATE_CLOSED;
+    }
+
+    return result;
+}
+
+static void in_process_io_destroy(CONCRETE_IO_HANDLE concrete_io)
+{
+    free(concrete_io);
+}
+
+static int in_process_io_open(CONCRETE_IO_HANDLE concrete_io, ON_IO_OPEN_COMPLETE on_io_open_complete, void* on_io_open_complete_context, ON_BYTES_RECEIVED on_bytes_received, void* on_bytes_received_context, ON_IO_ERROR on_io_error, void* on_io_error_context)
+{
+    IN_PROCESS_IO* io = (IN_PROCESS_IO*)concrete_io;
+    (void)on_io_error;
+    (void)on_io_error_context;
+
+    io->on_io_open_complete = on_io_open_complete;
+    io->on_io_open_complete_context = on_io_open_complete_context;
+    io->on_bytes_received = on_bytes_received;
+    io->on_bytes_received_context = on_bytes_received_context;
+    io->pending_response_size = 0;
+    /*like a real io, the open completes on the next dowork*/
+    io->state = IN_PROCESS_IO_STATE_OPENING;
+
+    return 0;
+}
+
+static int in_process_io_close(CONCRETE_IO_HANDLE concrete_io, ON_IO_CLOSE_COMPLETE on_io_close_complete, void* callback_context)
+{
+    IN_PROCESS_IO* io = (IN_PROCESS_IO*)concrete_io;
+
+    io->state = IN_PROCESS_IO_STATE_CLOSED;
+    io->pending_response_size = 0;
+
+    if (on_io_close_complete != NULL)
+    {
+        on_io_close_complete(callback_context);
+    }
+
+    return 0;
+}
+
+static int queue_response(IN_PROCESS_IO* io, const unsigned char* response, size_t size)
+{
+    int result;
+
+    if (io->pending_response_size + size > MAX_PENDING_RESPONSE_BYTES)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        (void)memcpy(io->pending_response + io->pending_response_size, response, size);
+        io->pending_response_size += size;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int acknowledge_publish(IN_PROCESS_IO* io, const unsigned char* packet, size_t size)
+{
+    int result;
+    size_t position = 1;
+
+    /*skip the variable length "remaining length" field*/
+    while (position < size && (packet[position] & 0x80) != 0)
+    {
+        position++;
+    }
+    position++;
+
+    if (position + 2 > size)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        /*the packet id follows the topic name*/
+        position += 2 + (((size_t)packet[position] << 8) | packet[position + 1]);
+
+        if (position + 2 > size)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            unsigned char puback[4];
+            puback[0] = 0x40;
+            puback[1] = 0x02;
+            puback[2] = packet[position];
+            puback[3] = packet[position + 1];
+            result = queue_response(io, puback, sizeof(puback));
+        }
+    }
+
+    return result;
+}
+
+static int in_process_io_send(CONCRETE_IO_HANDLE concrete_io, const void* buffer, size_t size, ON_SEND_COMPLETE on_send_complete, void* callback_context)
+{
+    static const unsigned char CONNACK[] = { 0x20, 0x02, 0x00, 0x00 };
+    static const unsigned char PINGRESP[] = { 0xD0, 0x00 };
+    IN_PROCESS_IO* io = (IN_PROCESS_IO*)concrete_io;
+    const unsigned char* packet = (const unsigned char*)buffer;
+    int result;
+
+    if (io->state != IN_PROCESS_IO_STATE_OPEN || size == 0)
+    {
+        result = __FAILURE__;
+    }
+    else
+    {
+        switch (MQTT_PACKET_TYPE(packet[0]))
+        {
+        case MQTT_CONNECT:
+            result = queue_response(io, CONNACK, sizeof(CONNACK));
+            break;
+        case MQTT_PUBLISH:
+            result = (MQTT_PUBLISH_QOS(packet[0]) == 0 ? 0 : acknowledge_publish(io, packet, size));
+            break;
+        case MQTT_PINGREQ:
+            result = queue_response(io, PINGRESP, sizeof(PINGRESP));
+            break;
+        default:
+            result = 0;
+            break;
+        }
+
+        if (result == 0 && on_send_complete != NULL)
+        {
+            on_send_complete(callback_context, IO_SEND_OK);
+        }
+    }
+
+    return result;
+}
+
+static void in_process_io_dowork(CONCRETE_IO_HANDLE concrete_io)
+{
+    IN_PROCESS_IO* io = (IN_PROCESS_IO*)concrete_io;
+
+    if (io->state == IN_PROCESS_IO_STATE_OPENING)
+    {
+        io->state = IN_PROCESS_IO_STATE_OPEN;
+        io->on_io_open_complete(io->on_io_open_complete_context, IO_OPEN_OK);
+    }
+    else if (io->state == IN_PROCESS_IO_STATE_OPEN && io->pending_response_size > 0)
+    {
+        /*the receive callback can send (and so queue more responses)*/
+        unsigned char received[MAX_PENDING_RESPONSE_BYTES];
+        size_t received_size = io->pending_response_size;
+
+        (void)memcpy(received, io->pending_response, received_size);
+        io->pending_response_size = 0;
+        io->on_bytes_received(io->on_bytes_received_context, received, received_size);
+    }
+}
+
+static const IO_INTERFACE_DESCRIPTION in_process_io_interface_description =
+{
+    in_process_io_retrieveoptions,
+    in_process_io_create,
+    in_process_io_destroy,
+    in_process_io_open,
+    in_process_io_close,
+    in_process_io_send,
+    in_process_io_dowork,
+    in_process_io_setoption
+};
+
+static XIO_HANDLE get_in_process_io(const char* fully_qualified_name, const MQTT_TRANSPORT_PROXY_OPTIONS* mqtt_transport_proxy_options)
+{
+    (void)fully_qualified_name;
+    (void)mqtt_transport_proxy_options;
+    return xio_create(&in_process_io_interface_description, NULL);
+}
+
+static TRANSPORT_PROVIDER in_process_mqtt_transport;
+
+static TRANSPORT_LL_HANDLE InProcessMqtt_Create(const IOTHUBTRANSPORT_CONFIG* config)
+{
+    return IoTHubTransport_MQTT_Common_Create(config, get_in_process_io);
+}
+
+/*the MQTT transport as shipped, except that it runs over the in-process io*/
+static const TRANSPORT_PROVIDER* InProcessMqtt_Protocol(void)
+{
+    in_process_mqtt_transport = *MQTT_Protocol();
+    in_process_mqtt_transport.IoTHubTransport_Create = InProcessMqtt_Create;
+    return &in_process_mqtt_transport;
+}
+
+static int connect_client(BENCHMARK_CLIENT* benchmark_client)
+{
+    /*the first message also drives the CONNECT/CONNACK exchange*/
+    return benchmark_client_send(benchmark_client, 1);
+}
+
+static int send_event_setup(void** context)
+{
+    int result;
+    BENCHMARK_CLIENT* benchmark_client;
+
+    if ((benchmark_client = benchmark_client_create(InProcessMqtt_Protocol)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else if (connect_client(benchmark_client) != 0)
+    {
+        benchmark_client_destroy(benchmark_client);
+        result = __LINE__;
+    }
+    else
+    {
+        *context = benchmark_client;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int send_event_batched_setup(void** context)
+{
+    int result;
+    BENCHMARK_CLIENT* benchmark_client;
+    size_t batch_size = BENCHMARK_BATCH_SIZE;
+
+    if ((benchmark_client = benchmark_client_create(InProcessMqtt_Protocol)) == NULL)
+    {
+        result = __LINE__;
+    }
+    else if (IoTHubClient_LL_SetOption(benchmark_client->client_handle, OPTION_MQTT_BATCH_MAX_SIZE, &batch_size) != IOTHUB_CLIENT_OK ||
+        connect_client(benchmark_client) != 0)
+    {
+        benchmark_client_destroy(benchmark_client);
+        result = __LINE__;
+    }
+    else
+    {
+        *context = benchmark_client;
+        result = 0;
+    }
+
+    return result;
+}
+
+static int send_event_run_once(void* context)
+{
+    return benchmark_client_send((BENCHMARK_CLIENT*)context, 1);
+}
+
+static int send_event_batch_run_once(void* context)
+{
+    return benchmark_client_send((BENCHMARK_CLIENT*)context, BENCHMARK_BATCH_SIZE);
+}
+
+static void send_event_teardown(void* context)
+{
+    benchmark_client_destroy((BENCHMARK_CLIENT*)context);
+}
+
+static const BENCHMARK mqtt_benchmarks[] =
+{
+    { "mqtt_send_event_do_work", send_event_setup, send_event_run_once, send_event_teardown, 0 },
+    { "mqtt_send_16_events_do_work", send_event_setup, send_event_batch_run_once, send_event_teardown, 0 },
+    { "mqtt_send_16_events_do_work_batched", send_event_batched_setup, send_event_batch_run_once, send_event_teardown, 0 }
+};
+
+const BENCHMARK* mqtt_benchmarks_get(size_t* count)
+{
+    *count = sizeof(mqtt_benchmarks) / sizeof(mqtt_benchmarks[0]);
+    return mqtt_benchmarks;
+}
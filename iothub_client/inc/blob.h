@@ -15,6 +15,7 @@
 
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "iothub_client_ll.h"
 
 #ifdef __cplusplus
 #include <cstddef>
@@ -35,6 +36,9 @@ extern "C"
 
 DEFINE_ENUM(BLOB_RESULT, BLOB_RESULT_VALUES)
 
+/*the largest block of a block blob, also the block size used by Blob_UploadFromSasUri*/
+#define BLOB_BLOCK_SIZE_MAX (4*1024*1024)
+
 /**
 * @brief	Synchronously uploads a byte array to blob storage
 *
@@ -49,6 +53,53 @@ DEFINE_ENUM(BLOB_RESULT, BLOB_RESULT_VALUES)
 */
 MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadFromSasUri,const char*, SASURI, const unsigned char*, source, size_t, size, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates)
 
+/**
+* @brief	Synchronously uploads to blob storage the blocks produced by a callback
+*
+* @param	SASURI	        The URI to use to upload data
+* @param	getDataCallback	A callback called with FILE_UPLOAD_OK to get the next block (at most 4MB); it sets the size to 0 when there is no more data
+* @param	context		    Any data provided by the user to serve as context on getDataCallback
+* @param    httpStatus      A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param    httpResponse    A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param    certificates    A null terminated string containing CA certificates to be used
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadMultipleBlocksFromSasUri, const char*, SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, getDataCallback, void*, context, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates)
+
+/**
+* @brief	Synchronously uploads a byte array to blob storage as blocks, several of them at the same time
+*
+* @param	SASURI	        The URI to use to upload data
+* @param	source		    A pointer to the byte array to be uploaded (can be NULL, but then size needs to be zero)
+* @param	size		    The size of the data to be uploaded (can be 0)
+* @param	blockSize	    The size of every block but the last one (at most BLOB_BLOCK_SIZE_MAX)
+* @param	concurrency	    The number of blocks uploaded at the same time, each on its own connection (1 uploads from the calling thread only)
+* @param    httpStatus      A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param    httpResponse    A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param    certificates    A null terminated string containing CA certificates to be used
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_UploadBlocksFromSasUri, const char*, SASURI, const unsigned char*, source, size_t, size, size_t, blockSize, size_t, concurrency, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates)
+
+/**
+* @brief	Same as Blob_UploadBlocksFromSasUri, but skips the blocks that a previous call with the same SASURI, source and blockSize has already uploaded
+*
+* @param	SASURI	        The URI to use to upload data
+* @param	source		    A pointer to the byte array to be uploaded (can be NULL, but then size needs to be zero)
+* @param	size		    The size of the data to be uploaded (can be 0)
+* @param	blockSize	    The size of every block but the last one (at most BLOB_BLOCK_SIZE_MAX)
+* @param	concurrency	    The number of blocks uploaded at the same time, each on its own connection (1 uploads from the calling thread only)
+* @param	uploadedBlocks	One entry per block, 0 for the blocks still to upload. The entry of every block that gets uploaded is set to 1, also when the call fails
+* @param    httpStatus      A pointer to an out argument receiving the HTTP status (available only when the return value is BLOB_OK)
+* @param    httpResponse    A BUFFER_HANDLE that receives the HTTP response from the server (available only when the return value is BLOB_OK)
+* @param    certificates    A null terminated string containing CA certificates to be used
+*
+* @return	A @c BLOB_RESULT. BLOB_OK means the blob has been uploaded successfully. Any other value indicates an error
+*/
+MOCKABLE_FUNCTION(, BLOB_RESULT, Blob_ResumeUploadBlocksFromSasUri, const char*, SASURI, const unsigned char*, source, size_t, size, size_t, blockSize, size_t, concurrency, unsigned char*, uploadedBlocks, unsigned int*, httpStatus, BUFFER_HANDLE, httpResponse, const char*, certificates)
+
 #ifdef __cplusplus
 }
 #endif
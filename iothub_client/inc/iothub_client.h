@@ -32,11 +32,6 @@ extern "C"
 {
 #endif
 
-#define IOTHUB_CLIENT_FILE_UPLOAD_RESULT_VALUES \
-    FILE_UPLOAD_OK, \
-    FILE_UPLOAD_ERROR
-
-    DEFINE_ENUM(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, IOTHUB_CLIENT_FILE_UPLOAD_RESULT_VALUES)
     typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_CALLBACK)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, void* userContextCallback);
 
     /**
@@ -112,6 +107,13 @@ extern "C"
     *			@b NOTE: The application behavior is undefined if the user calls
     *			the ::IoTHubClient_Destroy function from within any callback.
     *
+    *			Unless the connection is shared with other devices, the message is
+    *			only copied and queued here and is handed to the lower layer by the
+    *			worker thread. Invalid arguments are still reported by the return
+    *			value, but a failure to queue the message in the lower layer is
+    *			reported by calling @p eventConfirmationCallback with
+    *			@c IOTHUB_CLIENT_CONFIRMATION_ERROR.
+    *
     * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
     */
     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_SendEventAsync, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, IOTHUB_MESSAGE_HANDLE, eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK, eventConfirmationCallback, void*, userContextCallback);
@@ -130,6 +132,18 @@ extern "C"
     */
     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_GetSendStatus, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_STATUS*, iotHubClientStatus);
 
+    /**
+    * @brief	This function returns in the out parameter @p statistics the
+    * 			counters kept about sending events, connections and the work
+    * 			done by the client. See ::IoTHubClient_LL_GetStatistics.
+    *
+    * @param	iotHubClientHandle		The handle created by a call to the create function.
+    * @param	statistics				Out parameter receiving a snapshot of the counters.
+    *
+    * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+    MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_GetStatistics, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_STATISTICS*, statistics);
+
     /**
     * @brief	Sets up the message callback to be invoked when IoT Hub issues a
     * 			message to the device. This is a blocking call.
@@ -340,6 +354,21 @@ extern "C"
     * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
     */
     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_UploadToBlobAsync, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, const char*, destinationFileName, const unsigned char*, source, size_t, size, IOTHUB_CLIENT_FILE_UPLOAD_CALLBACK, iotHubClientFileUploadCallback, void*, context);
+
+    /**
+    * @brief	IoTHubClient_UploadMultipleBlocksToBlobAsync uploads to a file in Azure Blob Storage the data produced,
+    *           one block at a time, by a callback. The upload runs on its own thread.
+    *           Unlike IoTHubClient_UploadToBlobAsync, it is never resumed (see IoTHubClient_LL_UploadMultipleBlocksToBlob).
+    *
+    * @param	iotHubClientHandle	                The handle created by a call to the IoTHubClient_Create function.
+    * @param	destinationFileName	                The name of the file to be created in Azure Blob Storage.
+    * @param	getDataCallback                     A callback called from the upload thread to get the next block of the file,
+    *                                              and a last time with the result of the upload (see IoTHubClient_LL_UploadMultipleBlocksToBlob).
+    * @param    context                             A user-provided context to be passed to the callback.
+    *
+    * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+    MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_UploadMultipleBlocksToBlobAsync, IOTHUB_CLIENT_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, getDataCallback, void*, context);
 #endif
 #ifdef __cplusplus
 }
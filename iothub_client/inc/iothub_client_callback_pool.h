@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_CALLBACK_POOL
+#define IOTHUB_CLIENT_CALLBACK_POOL
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct CALLBACK_POOL_INSTANCE_TAG;
+typedef struct CALLBACK_POOL_INSTANCE_TAG* CALLBACK_POOL_HANDLE;
+
+typedef void(*CALLBACK_POOL_WORK)(void* context);
+
+MOCKABLE_FUNCTION(, CALLBACK_POOL_HANDLE, callback_pool_create, size_t, thread_count);
+MOCKABLE_FUNCTION(, int, callback_pool_post, CALLBACK_POOL_HANDLE, pool, CALLBACK_POOL_WORK, work, void*, context, bool, ordered);
+MOCKABLE_FUNCTION(, void, callback_pool_shutdown, CALLBACK_POOL_HANDLE, pool);
+MOCKABLE_FUNCTION(, void, callback_pool_destroy, CALLBACK_POOL_HANDLE, pool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_CLIENT_CALLBACK_POOL
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_DEVICE_INDEX
+#define IOTHUB_CLIENT_DEVICE_INDEX
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct DEVICE_INDEX_INSTANCE_TAG;
+typedef struct DEVICE_INDEX_INSTANCE_TAG* DEVICE_INDEX_HANDLE;
+
+MOCKABLE_FUNCTION(, DEVICE_INDEX_HANDLE, device_index_create);
+MOCKABLE_FUNCTION(, int, device_index_add, DEVICE_INDEX_HANDLE, device_index, const char*, device_id, void*, device);
+MOCKABLE_FUNCTION(, int, device_index_remove, DEVICE_INDEX_HANDLE, device_index, void*, device);
+MOCKABLE_FUNCTION(, void*, device_index_find_by_id, DEVICE_INDEX_HANDLE, device_index, const char*, device_id);
+MOCKABLE_FUNCTION(, bool, device_index_contains, DEVICE_INDEX_HANDLE, device_index, void*, device);
+MOCKABLE_FUNCTION(, void, device_index_destroy, DEVICE_INDEX_HANDLE, device_index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_CLIENT_DEVICE_INDEX
@@ -58,6 +58,9 @@ typedef struct IOTHUBTRANSPORT_CONFIG_TAG IOTHUBTRANSPORT_CONFIG;
 
 typedef struct IOTHUB_CLIENT_LL_HANDLE_DATA_TAG* IOTHUB_CLIENT_LL_HANDLE;
 
+struct IOTHUB_CLIENT_STATISTICS_TAG;
+typedef struct IOTHUB_CLIENT_STATISTICS_TAG IOTHUB_CLIENT_STATISTICS;
+
 #define IOTHUB_CLIENT_STATUS_VALUES       \
     IOTHUB_CLIENT_SEND_STATUS_IDLE,       \
     IOTHUB_CLIENT_SEND_STATUS_BUSY
@@ -162,6 +165,12 @@ extern "C"
 
     DEFINE_ENUM(DEVICE_TWIN_UPDATE_STATE, DEVICE_TWIN_UPDATE_STATE_VALUES);
 
+#define IOTHUB_CLIENT_FILE_UPLOAD_RESULT_VALUES \
+    FILE_UPLOAD_OK, \
+    FILE_UPLOAD_ERROR
+
+    DEFINE_ENUM(IOTHUB_CLIENT_FILE_UPLOAD_RESULT, IOTHUB_CLIENT_FILE_UPLOAD_RESULT_VALUES);
+
     typedef void(*IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK)(IOTHUB_CLIENT_CONFIRMATION_RESULT result, void* userContextCallback);
     typedef void(*IOTHUB_CLIENT_CONNECTION_STATUS_CALLBACK)(IOTHUB_CLIENT_CONNECTION_STATUS result, IOTHUB_CLIENT_CONNECTION_STATUS_REASON reason, void* userContextCallback);
     typedef IOTHUBMESSAGE_DISPOSITION_RESULT (*IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC)(IOTHUB_MESSAGE_HANDLE message, void* userContextCallback);
@@ -171,6 +180,18 @@ extern "C"
     typedef void(*IOTHUB_CLIENT_REPORTED_STATE_CALLBACK)(int status_code, void* userContextCallback);
     typedef int(*IOTHUB_CLIENT_DEVICE_METHOD_CALLBACK_ASYNC)(const char* method_name, const unsigned char* payload, size_t size, unsigned char** response, size_t* response_size, void* userContextCallback);
     typedef int(*IOTHUB_CLIENT_INBOUND_DEVICE_METHOD_CALLBACK)(const char* method_name, const unsigned char* payload, size_t size, METHOD_HANDLE method_id, void* userContextCallback);
+    typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK)(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context);
+    typedef void(*IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_CALLBACK)(const char* checkpoint, void* context);
+
+    /** @brief	The value of the option @c blob_upload_checkpoint_hook. */
+    typedef struct IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_HOOK_TAG
+    {
+        /** @brief Called with the saved upload (a JSON string, to be given back in the option @c blob_upload_checkpoint)
+        *   every time it changes and with NULL once it is discarded. It runs on the thread doing the upload
+        *   and must not call into the client. */
+        IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_CALLBACK callback;
+        void* context;
+    } IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_HOOK;
 
     /** @brief	This struct captures IoTHub client configuration. */
     typedef struct IOTHUB_CLIENT_CONFIG_TAG
@@ -233,6 +254,65 @@ extern "C"
         IOTHUB_AUTHORIZATION_HANDLE auth_module_handle;
     };
 
+/** @brief	Number of buckets in the latency histograms of ::IOTHUB_CLIENT_STATISTICS. */
+#define IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT 10
+
+/** @brief	Inclusive upper bounds, in milliseconds, of all but the last histogram bucket;
+*			the last bucket counts everything above 10 seconds. */
+#define IOTHUB_CLIENT_STATISTICS_BUCKET_BOUNDS_MS { 1, 5, 10, 50, 100, 500, 1000, 5000, 10000 }
+
+    /** @brief	Counters returned by ::IoTHubClient_LL_GetStatistics. All counters start at 0
+    *			when the client is created and are never reset. */
+    struct IOTHUB_CLIENT_STATISTICS_TAG
+    {
+        /** @brief	Events accepted by ::IoTHubClient_LL_SendEventAsync. */
+        uint64_t messagesQueued;
+
+        /** @brief	Events handed by the transport to the protocol, a batch counting each event it carries. */
+        uint64_t messagesSent;
+
+        /** @brief	Events confirmed with IOTHUB_CLIENT_CONFIRMATION_OK. */
+        uint64_t messagesAcknowledged;
+
+        /** @brief	Events confirmed with IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT. */
+        uint64_t messagesTimedOut;
+
+        /** @brief	Events confirmed with any other result. */
+        uint64_t messagesFailed;
+
+        /** @brief	Events currently queued and not yet taken by the transport. */
+        size_t waitingToSendCount;
+
+        /** @brief	Events currently taken by the transport and not yet confirmed. */
+        size_t waitingForAckCount;
+
+        /** @brief	Event payload bytes sent and message payload bytes received by the transport. */
+        uint64_t bytesSent;
+        uint64_t bytesReceived;
+
+        /** @brief	Connections re-established by the transport after the first one. */
+        uint64_t reconnectCount;
+
+        /** @brief	SAS tokens renewed by the transport before they expired (the HTTP transport does not report them). */
+        uint64_t sasTokenRefreshCount;
+
+        /** @brief	Time from ::IoTHubClient_LL_SendEventAsync to the acknowledgement (MQTT PUBACK,
+        *			AMQP settlement or HTTP response) of each event confirmed with IOTHUB_CLIENT_CONFIRMATION_OK,
+        *			bucketed by IOTHUB_CLIENT_STATISTICS_BUCKET_BOUNDS_MS. */
+        uint64_t ackLatencyHistogram[IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT];
+
+        /** @brief	Duration of each ::IoTHubClient_LL_DoWork call, bucketed by IOTHUB_CLIENT_STATISTICS_BUCKET_BOUNDS_MS. */
+        uint64_t doWorkCount;
+        uint64_t doWorkDurationHistogram[IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT];
+        uint64_t doWorkDurationMaxMs;
+
+        /** @brief	Upper bound of the histogram bucket holding the 50th, 90th and 99th percentile of the
+        *			::IoTHubClient_LL_DoWork durations (doWorkDurationMaxMs for the last bucket). */
+        uint64_t doWorkDurationP50Ms;
+        uint64_t doWorkDurationP90Ms;
+        uint64_t doWorkDurationP99Ms;
+    };
+
 
     /**
     * @brief	Creates a IoT Hub client for communication with an existing
@@ -404,6 +484,35 @@ extern "C"
     */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_GetLastMessageReceiveTime, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, time_t*, lastMessageReceiveTime);
 
+    /**
+    * @brief	This function returns in the out parameter @p msUntilNextTimeout
+    * 			how many milliseconds are left until the earliest pending message
+    * 			reaches the timeout set through the "messageTimeout" option.
+    * 			Applications driving ::IoTHubClient_LL_DoWork can use it to
+    * 			sleep until the next timeout has to be processed.
+    *
+    * @param	iotHubClientHandle				The handle created by a call to the create function.
+    * @param	msUntilNextTimeout  			Out parameter containing the number of milliseconds
+    * 											until the next message timeout, 0 if it is already due.
+    *
+    * @return	IOTHUB_CLIENT_OK upon success, IOTHUB_CLIENT_INDEFINITE_TIME if no pending
+    * 			message has a timeout or an error code upon failure.
+    */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_GetNextMessageTimeout, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, uint64_t*, msUntilNextTimeout);
+
+    /**
+    * @brief	This function returns in the out parameter @p statistics the
+    * 			counters the client and its transport keep about sending events,
+    * 			connections and ::IoTHubClient_LL_DoWork. Keeping the counters
+    * 			costs a few increments per event, so they are always on.
+    *
+    * @param	iotHubClientHandle	The handle created by a call to the create function.
+    * @param	statistics			Out parameter receiving a snapshot of the counters.
+    *
+    * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_GetStatistics, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, IOTHUB_CLIENT_STATISTICS*, statistics);
+
     /**
     * @brief	This function is meant to be called by the user when work
     * 			(sending/receiving) can be done by the IoTHubClient.
@@ -547,6 +656,26 @@ extern "C"
     */
      MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadToBlob, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, const unsigned char*, source, size_t, size);
 
+    /**
+    * @brief	This API uploads to Azure Storage the content produced by @p getDataCallback, one block at a time,
+    *           under the blob name devicename/@pdestinationFileName. Only one block is held in memory at a time,
+    *           so the content does not need to fit in memory.
+    *           These uploads are not resumable: the option @c blob_upload_resumable does not apply to them and any
+    *           saved upload is discarded, so a failed upload has to be started over with the first block.
+    *
+    * @param	iotHubClientHandle	    The handle created by a call to the create function.
+    * @param	destinationFileName     name of the file.
+    * @param	getDataCallback         A callback called with FILE_UPLOAD_OK to get the next block of the file: it sets
+    *                                  @c *data and @c *size to the block (at most 4MB), which has to stay valid until the
+    *                                  next call, or @c *size to 0 when there is no more data. Once the upload has finished
+    *                                  the callback is called one last time with FILE_UPLOAD_OK or FILE_UPLOAD_ERROR and
+    *                                  @c NULL @p data and @p size.
+    * @param	context                 User specified context that will be provided to the callback. This can be @c NULL.
+    *
+    * @return	IOTHUB_CLIENT_OK upon success or an error code upon failure.
+    */
+     MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, IoTHubClient_LL_UploadMultipleBlocksToBlob, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle, const char*, destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, getDataCallback, void*, context);
+
 #endif /*DONT_USE_UPLOADTOBLOB*/
 
 #ifdef __cplusplus
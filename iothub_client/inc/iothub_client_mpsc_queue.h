@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef IOTHUB_CLIENT_MPSC_QUEUE
+#define IOTHUB_CLIENT_MPSC_QUEUE
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/umock_c_prod.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct MPSC_QUEUE_INSTANCE_TAG;
+typedef struct MPSC_QUEUE_INSTANCE_TAG* MPSC_QUEUE_HANDLE;
+
+typedef void(*MPSC_QUEUE_ON_ITEM)(void* context, void* item);
+
+MOCKABLE_FUNCTION(, MPSC_QUEUE_HANDLE, mpsc_queue_create);
+MOCKABLE_FUNCTION(, int, mpsc_queue_push, MPSC_QUEUE_HANDLE, queue, void*, item, bool*, was_empty);
+MOCKABLE_FUNCTION(, size_t, mpsc_queue_drain, MPSC_QUEUE_HANDLE, queue, MPSC_QUEUE_ON_ITEM, on_item, void*, context);
+MOCKABLE_FUNCTION(, void, mpsc_queue_destroy, MPSC_QUEUE_HANDLE, queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // IOTHUB_CLIENT_MPSC_QUEUE
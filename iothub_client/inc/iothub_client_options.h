@@ -28,14 +28,54 @@ extern "C"
     static const char* OPTION_SAS_TOKEN_LIFETIME = "sas_token_lifetime";
     static const char* OPTION_SAS_TOKEN_REFRESH_TIME = "sas_token_refresh_time";
     static const char* OPTION_CBS_REQUEST_TIMEOUT = "cbs_request_timeout";
+    /* AMQP only: number (size_t) of registered devices allowed to start (authenticate and attach their links) per second, devices with events waiting go first and the rest in random order, 0 (default) means no limit */
+    static const char* OPTION_DEVICE_STARTS_PER_SECOND = "device_starts_per_second";
 
     static const char* OPTION_MIN_POLLING_TIME = "MinimumPollingTime";
     static const char* OPTION_BATCHING = "Batching";
+    /* HTTP only: longest time (unsigned int, seconds) between 2 GETs of one device; when larger than MinimumPollingTime, the time doubles after every GET that finds no message and drops back to MinimumPollingTime when a message arrives, 0 (default) keeps polling every MinimumPollingTime */
+    static const char* OPTION_MAX_POLLING_TIME = "MaximumPollingTime";
+    /* HTTP only: number (size_t) of GETs one DoWork issues across all the registered devices, the next DoWork carries on with the following device, 0 (default) means no limit */
+    static const char* OPTION_MAX_POLLS_PER_DO_WORK = "MaximumPollsPerDoWork";
+    /* HTTP only: number (size_t) of devices whose events are sent, and whose C2D GETs are issued, at the same time, each on its own connection and pooled thread, 1 (default) does them one device after the other; the options that go to the HTTP layer (e.g. TrustedCerts) can be set before or after it */
+    static const char* OPTION_EVENT_SEND_CONCURRENCY = "EventSendConcurrency";
 
     static const char* OPTION_MESSAGE_TIMEOUT = "messageTimeout";
     static const char* OPTION_PRODUCT_INFO = "product_info";
     static const char* OPTION_C2D_KEEP_ALIVE_FREQ_SECS = "c2d_keep_alive_freq_secs";
 
+    /* number (size_t) of released per-message list entries each client and transport keeps for reuse instead of freeing them, 0 (default) disables pooling */
+    static const char* OPTION_MESSAGE_POOL_SIZE = "message_pool_size";
+
+    /* MQTT only: number (size_t) of telemetry PUBLISHes allowed to wait for their PUBACK at the same time, 0 (default) means no limit */
+    static const char* OPTION_MAX_INFLIGHT_MESSAGES = "max_inflight_messages";
+
+    /* MQTT only: largest payload (size_t, bytes) of one PUBLISH carrying several telemetry messages as an application/vnd.microsoft.iothub.json array, 0 (default) disables batching; */
+    /* a batch keeps the body and the application properties only, so a message with a messageId or a correlationId is always published alone */
+    static const char* OPTION_MQTT_BATCH_MAX_SIZE = "mqtt_batch_max_size";
+    /* MQTT only: longest time (size_t, milliseconds) a queued telemetry message waits for a batch to fill up */
+    static const char* OPTION_MQTT_BATCH_LINGER_MS = "mqtt_batch_linger_ms";
+
+    /* upload to blob only: number (size_t) of blocks uploaded at the same time, each on its own connection, 1 (default) uploads the blob from the calling thread */
+    static const char* OPTION_BLOB_UPLOAD_CONCURRENCY = "blob_upload_concurrency";
+    /* upload to blob only: size (size_t, bytes) of the blocks a blob is uploaded in, at most 4MB (default) */
+    static const char* OPTION_BLOB_UPLOAD_BLOCK_SIZE = "blob_upload_block_size";
+    /* upload to blob only: when true (bool), a blob upload that fails on the network is resumed by the next upload of the same file name, size and block size; blocks already uploaded are skipped only if their CRC-32 still matches the content.
+       Only IoTHubClient_LL_UploadToBlob uploads are resumable; IoTHubClient_LL_UploadMultipleBlocksToBlob cannot skip or re-read blocks of its callback and always starts over */
+    static const char* OPTION_BLOB_UPLOAD_RESUMABLE = "blob_upload_resumable";
+    /* upload to blob only: IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_HOOK* told about every change of the saved upload, so that it can be persisted; the saved upload contains the blob SAS URI */
+    static const char* OPTION_BLOB_UPLOAD_CHECKPOINT_HOOK = "blob_upload_checkpoint_hook";
+    /* upload to blob only: saved upload (const char*, as given to the checkpoint hook) to resume after a restart */
+    static const char* OPTION_BLOB_UPLOAD_CHECKPOINT = "blob_upload_checkpoint";
+
+    /* convenience layer only: longest time (unsigned int, milliseconds, 100 by default) the worker thread sleeps between two DoWork calls when it is not signaled and has no event in flight.
+       Sending wakes the worker thread, but incoming cloud-to-device messages, method calls and twin updates are only read by the next DoWork,
+       so an idle client can take up to this long to deliver them (the worker thread used to poll every 1 ms); set it to 1 to get that latency back at the cost of a busier idle thread */
+    static const char* OPTION_DO_WORK_FREQUENCY_IN_MS = "do_work_freq_ms";
+
+    /* convenience layer only: number of threads (size_t) running the user callbacks instead of the worker thread, can be set once; 0 keeps them on the worker thread */
+    static const char* OPTION_CALLBACK_THREAD_COUNT = "callback_thread_count";
+
 #ifdef __cplusplus
 }
 #endif
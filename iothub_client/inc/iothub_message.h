@@ -44,6 +44,11 @@ DEFINE_ENUM(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUES);
 
 typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG* IOTHUB_MESSAGE_HANDLE;
 
+/** @brief  Function invoked once the SDK no longer references a buffer
+  *         passed to @c IoTHubMessage_CreateFromByteArrayNoCopy.
+  */
+typedef void(*IOTHUB_MESSAGE_RELEASE_CALLBACK)(const unsigned char* byteArray, void* releaseContext);
+
 /**
  * @brief   Creates a new IoT hub message from a byte array. The type of the
  *          message will be set to @c IOTHUBMESSAGE_BYTEARRAY.
@@ -56,6 +61,26 @@ typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG* IOTHUB_MESSAGE_HANDLE;
  */
 MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_HANDLE, IoTHubMessage_CreateFromByteArray, const unsigned char*, byteArray, size_t, size);
 
+/**
+ * @brief   Creates a new IoT hub message that references @p byteArray instead
+ *          of copying it. The type of the message will be set to
+ *          @c IOTHUBMESSAGE_BYTEARRAY. Clones of the message (including the
+ *          one made by @c IoTHubClient_LL_SendEventAsync) share the same
+ *          buffer, which must remain valid and unmodified until
+ *          @p releaseCallback is invoked.
+ *
+ * @param   byteArray       The byte array holding the message payload.
+ * @param   size            The size of the byte array.
+ * @param   releaseCallback Invoked once the message and all of its clones
+ *                          have been destroyed. Can be @c NULL.
+ * @param   releaseContext  User specified context passed to @p releaseCallback.
+ *
+ * @return  A valid @c IOTHUB_MESSAGE_HANDLE if the message was successfully
+ *          created or @c NULL in case an error occurs, in which case
+ *          @p releaseCallback is not invoked.
+ */
+MOCKABLE_FUNCTION(, IOTHUB_MESSAGE_HANDLE, IoTHubMessage_CreateFromByteArrayNoCopy, const unsigned char*, byteArray, size_t, size, IOTHUB_MESSAGE_RELEASE_CALLBACK, releaseCallback, void*, releaseContext);
+
 /**
  * @brief   Creates a new IoT hub message from a null terminated string.  The
  *          type of the message will be set to @c IOTHUBMESSAGE_STRING.
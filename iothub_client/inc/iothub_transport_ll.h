@@ -69,6 +69,7 @@ extern "C"
     typedef int(*pfIoTHubTransport_Subscribe_DeviceMethod)(IOTHUB_DEVICE_HANDLE handle);
     typedef void(*pfIoTHubTransport_Unsubscribe_DeviceMethod)(IOTHUB_DEVICE_HANDLE handle);
     typedef int(*pfIoTHubTransport_DeviceMethod_Response)(IOTHUB_DEVICE_HANDLE handle, METHOD_HANDLE methodId, const unsigned char* response, size_t response_size, int status_response);
+    typedef IOTHUB_CLIENT_RESULT(*pfIoTHubTransport_GetStatistics)(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics);
 
 #define TRANSPORT_PROVIDER_FIELDS                                                   \
 pfIotHubTransport_SendMessageDisposition IoTHubTransport_SendMessageDisposition;  \
@@ -88,7 +89,8 @@ pfIoTHubTransport_Subscribe IoTHubTransport_Subscribe;
 pfIoTHubTransport_Unsubscribe IoTHubTransport_Unsubscribe;                          \
 pfIoTHubTransport_DoWork IoTHubTransport_DoWork;                                    \
 pfIoTHubTransport_SetRetryPolicy IoTHubTransport_SetRetryPolicy;                    \
-pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus  /*there's an intentional missing ; on this line*/
+pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;                     \
+pfIoTHubTransport_GetStatistics IoTHubTransport_GetStatistics  /*optional, can be NULL; there's an intentional missing ; on this line*/
 
     struct TRANSPORT_PROVIDER_TAG
     {
@@ -63,6 +63,7 @@ extern "C"
     MOCKABLE_FUNCTION(, void, authentication_destroy, AUTHENTICATION_HANDLE, authentication_handle);
     MOCKABLE_FUNCTION(, int, authentication_set_option, AUTHENTICATION_HANDLE, authentication_handle, const char*, name, void*, value);
     MOCKABLE_FUNCTION(, OPTIONHANDLER_HANDLE, authentication_retrieve_options, AUTHENTICATION_HANDLE, authentication_handle);
+    MOCKABLE_FUNCTION(, int, authentication_get_sas_token_refresh_count, AUTHENTICATION_HANDLE, authentication_handle, uint64_t*, sas_token_refresh_count);
 
 #ifdef __cplusplus
 }
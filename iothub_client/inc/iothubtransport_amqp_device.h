@@ -4,6 +4,7 @@
 #ifndef IOTHUBTRANSPORTAMQP_AMQP_DEVICE_H
 #define IOTHUBTRANSPORTAMQP_AMQP_DEVICE_H
 
+#include <stdint.h>
 #include "azure_c_shared_utility/umock_c_prod.h"
 #include "azure_c_shared_utility/optionhandler.h"
 #include "azure_uamqp_c/session.h"
@@ -20,6 +21,8 @@ extern "C"
 // @brief    name of option to apply the instance obtained using device_retrieve_options
 static const char* DEVICE_OPTION_SAVED_OPTIONS = "saved_device_options";
 static const char* DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS = "event_send_timeout_secs";
+static const char* DEVICE_OPTION_EVENT_SEND_BATCHING = "event_send_batching";
+static const char* DEVICE_OPTION_MESSAGE_POOL_SIZE = "message_pool_size";
 static const char* DEVICE_OPTION_CBS_REQUEST_TIMEOUT_SECS = "cbs_request_timeout_secs";
 static const char* DEVICE_OPTION_SAS_TOKEN_REFRESH_TIME_SECS = "sas_token_refresh_time_secs";
 static const char* DEVICE_OPTION_SAS_TOKEN_LIFETIME_SECS = "sas_token_lifetime_secs";
@@ -98,6 +101,7 @@ MOCKABLE_FUNCTION(, int, device_stop, DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, void, device_do_work, DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, int, device_send_event_async, DEVICE_HANDLE, handle, IOTHUB_MESSAGE_LIST*, message, ON_DEVICE_D2C_EVENT_SEND_COMPLETE, on_device_d2c_event_send_complete_callback, void*, context);
 MOCKABLE_FUNCTION(, int, device_get_send_status, DEVICE_HANDLE, handle, DEVICE_SEND_STATUS*, send_status);
+MOCKABLE_FUNCTION(, int, device_get_sas_token_refresh_count, DEVICE_HANDLE, handle, uint64_t*, sas_token_refresh_count);
 MOCKABLE_FUNCTION(, int, device_subscribe_message, DEVICE_HANDLE, handle, ON_DEVICE_C2D_MESSAGE_RECEIVED, on_message_received_callback, void*, context);
 MOCKABLE_FUNCTION(, int, device_unsubscribe_message, DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, int, device_send_message_disposition, DEVICE_HANDLE, device_handle, DEVICE_MESSAGE_DISPOSITION_INFO*, disposition_info, DEVICE_MESSAGE_DISPOSITION_RESULT, disposition_result);
@@ -16,6 +16,8 @@ extern "C"
 
 
 static const char* MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS = "telemetry_event_send_timeout_secs";
+static const char* MESSENGER_OPTION_EVENT_SEND_BATCHING = "telemetry_event_send_batching";
+static const char* MESSENGER_OPTION_MESSAGE_POOL_SIZE = "telemetry_message_pool_size";
 static const char* MESSENGER_OPTION_SAVED_OPTIONS = "saved_telemetry_messenger_options";
 
 typedef struct TELEMETRY_MESSENGER_INSTANCE* TELEMETRY_MESSENGER_HANDLE;
@@ -9,10 +9,227 @@
 #include "azure_c_shared_utility/httpapiex.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/base64.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/threadapi.h"
 
 /*a block has 4MB*/
 #define BLOCK_SIZE (4*1024*1024)
 
+/*a block blob can have at most 50000 blocks*/
+#define MAX_BLOCK_COUNT 50000
+
+/*the XML body of Put Block List is "build as we go" between these two*/
+#define BLOCK_LIST_BEGIN "<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"
+#define BLOCK_LIST_END "</BlockList>"
+
+static BLOB_RESULT CreateHttpApiExFromSasUri(const char* SASURI, const char* certificates, HTTPAPIEX_HANDLE* httpApiExHandle, const char** relativePath)
+{
+    BLOB_RESULT result;
+    /*Codes_SRS_BLOB_09_003: [ Blob_UploadMultipleBlocksFromSasUri shall copy from SASURI the hostname, the hostname being found between "://" and the next "/". ]*/
+    const char* hostnameBegin = strstr(SASURI, "://");
+    const char* hostnameEnd = (hostnameBegin == NULL) ? NULL : strchr(hostnameBegin + 3, '/');
+    if (hostnameEnd == NULL)
+    {
+        /*Codes_SRS_BLOB_09_004: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+        LogError("hostname cannot be determined");
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        size_t hostnameSize;
+        char* hostname;
+
+        hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
+        hostnameSize = hostnameEnd - hostnameBegin;
+        if ((hostname = (char*)malloc(hostnameSize + 1)) == NULL) /*+1 because of '\0' at the end*/
+        {
+            /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("oom - out of memory");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            (void)memcpy(hostname, hostnameBegin, hostnameSize);
+            hostname[hostnameSize] = '\0';
+
+            /*Codes_SRS_BLOB_09_005: [ Blob_UploadMultipleBlocksFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
+            if ((*httpApiExHandle = HTTPAPIEX_Create(hostname)) == NULL)
+            {
+                /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                LogError("unable to create a HTTPAPIEX_HANDLE");
+                result = BLOB_ERROR;
+            }
+            /*Codes_SRS_BLOB_09_006: [ If certificates is non-NULL then Blob_UploadMultipleBlocksFromSasUri shall pass certificates to HTTPAPI_EX_HANDLE by calling HTTPAPIEX_SetOption with the option name "TrustedCerts". ]*/
+            else if ((certificates != NULL) && (HTTPAPIEX_SetOption(*httpApiExHandle, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
+            {
+                /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                LogError("failure in setting trusted certificates");
+                HTTPAPIEX_Destroy(*httpApiExHandle);
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                /*the relative path begins in the SasUri where the hostname ends*/
+                *relativePath = hostnameEnd;
+                result = BLOB_OK;
+            }
+            free(hostname);
+        }
+    }
+    return result;
+}
+
+/*returns the BASE64 encoded block ID of a block, the same for a block whichever way the blob is uploaded*/
+static STRING_HANDLE CreateBlockIdString(unsigned int blockID)
+{
+    STRING_HANDLE result;
+    char temp[11]; /*this will contain 000000... 049999, sized for any unsigned int*/
+
+    if (sprintf(temp, "%6u", blockID) != 6) /*produces 000000... 049999*/
+    {
+        LogError("failed to sprintf");
+        result = NULL;
+    }
+    else if ((result = Base64_Encode_Bytes((const unsigned char*)temp, 6)) == NULL)
+    {
+        LogError("unable to Base64_Encode_Bytes");
+    }
+    return result;
+}
+
+static int AddBlockToBlockList(STRING_HANDLE blockIDList, STRING_HANDLE blockIdString)
+{
+    int result;
+    if (!(
+        (STRING_concat(blockIDList, "<Latest>") == 0) &&
+        (STRING_concat_with_STRING(blockIDList, blockIdString) == 0) &&
+        (STRING_concat(blockIDList, "</Latest>") == 0)
+        ))
+    {
+        LogError("unable to STRING_concat");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+static BLOB_RESULT UploadBlock(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, BUFFER_HANDLE requestContent, const unsigned char* data, size_t size, unsigned int blockID, STRING_HANDLE blockIDList, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+
+    /*Codes_SRS_BLOB_09_011: [ For every block Blob_UploadMultipleBlocksFromSasUri shall construct a BASE64 encoded string from the block ID, add it to the XML block list, construct a new relativePath from base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId", copy the block in the request BUFFER_HANDLE and call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
+    STRING_HANDLE blockIdString = CreateBlockIdString(blockID);
+    if (blockIdString == NULL)
+    {
+        /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+        LogError("unable to create the block ID of block %u", blockID);
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        STRING_HANDLE newRelativePath;
+        /*blocks uploaded in parallel are added to the list only once all of them are uploaded*/
+        if ((blockIDList != NULL) && (AddBlockToBlockList(blockIDList, blockIdString) != 0))
+        {
+            /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("unable to add block %u to the block list", blockID);
+            result = BLOB_ERROR;
+        }
+        else if ((newRelativePath = STRING_construct(relativePath)) == NULL)
+        {
+            /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("unable to STRING_construct");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            if (!(
+                (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
+                (STRING_concat_with_STRING(newRelativePath, blockIdString) == 0)
+                ))
+            {
+                /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                LogError("unable to STRING concatenate");
+                result = BLOB_ERROR;
+            }
+            else if (BUFFER_build(requestContent, data, size) != 0)
+            {
+                /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                LogError("unable to BUFFER_build");
+                result = BLOB_ERROR;
+            }
+            else if (HTTPAPIEX_ExecuteRequest(httpApiExHandle, HTTPAPI_REQUEST_PUT, STRING_c_str(newRelativePath), NULL, requestContent, httpStatus, NULL, httpResponse) != HTTPAPIEX_OK)
+            {
+                /*Codes_SRS_BLOB_09_012: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                LogError("unable to HTTPAPIEX_ExecuteRequest");
+                result = BLOB_HTTP_ERROR;
+            }
+            else
+            {
+                result = BLOB_OK;
+            }
+            STRING_delete(newRelativePath);
+        }
+        STRING_delete(blockIdString);
+    }
+    return result;
+}
+
+static BLOB_RESULT PutBlockList(HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, BUFFER_HANDLE requestContent, STRING_HANDLE blockIDList, unsigned int* httpStatus, BUFFER_HANDLE httpResponse)
+{
+    BLOB_RESULT result;
+    STRING_HANDLE newRelativePath;
+
+    /*Codes_SRS_BLOB_09_014: [ Blob_UploadMultipleBlocksFromSasUri shall complete the XML block list, construct a new relativePath from base relativePath + "&comp=blocklist" and call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus, httpResponse and the XML block list as content. ]*/
+    if (STRING_concat(blockIDList, BLOCK_LIST_END) != 0)
+    {
+        /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+        LogError("failed to STRING_concat");
+        result = BLOB_ERROR;
+    }
+    else if ((newRelativePath = STRING_construct(relativePath)) == NULL)
+    {
+        /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+        LogError("failed to STRING_construct");
+        result = BLOB_ERROR;
+    }
+    else
+    {
+        const char* s;
+        if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
+        {
+            /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("failed to STRING_concat");
+            result = BLOB_ERROR;
+        }
+        else if (
+            ((s = STRING_c_str(blockIDList)) == NULL) ||
+            (BUFFER_build(requestContent, (const unsigned char*)s, strlen(s)) != 0)
+            )
+        {
+            /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("failed to BUFFER_build");
+            result = BLOB_ERROR;
+        }
+        else if (HTTPAPIEX_ExecuteRequest(httpApiExHandle, HTTPAPI_REQUEST_PUT, STRING_c_str(newRelativePath), NULL, requestContent, httpStatus, NULL, httpResponse) != HTTPAPIEX_OK)
+        {
+            /*Codes_SRS_BLOB_09_015: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+            LogError("unable to HTTPAPIEX_ExecuteRequest");
+            result = BLOB_HTTP_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_BLOB_09_017: [ Otherwise, Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+            result = BLOB_OK;
+        }
+        STRING_delete(newRelativePath);
+    }
+    return result;
+}
+
 BLOB_RESULT Blob_UploadFromSasUri(const char* SASURI, const unsigned char* source, size_t size, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates)
 {
     BLOB_RESULT result;
@@ -24,6 +241,9 @@ BLOB_RESULT Blob_UploadFromSasUri(const char* SASURI, const unsigned char* sourc
     }
     else
     {
+        HTTPAPIEX_HANDLE httpApiExHandle = NULL;
+        const char* relativePath = NULL;
+
         /*Codes_SRS_BLOB_02_002: [ If source is NULL and size is not zero then Blob_UploadFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
         if (
             (size > 0) &&
@@ -42,332 +262,579 @@ BLOB_RESULT Blob_UploadFromSasUri(const char* SASURI, const unsigned char* sourc
             result = BLOB_INVALID_ARG;
         }
 #endif
+        /*Codes_SRS_BLOB_02_017: [ Blob_UploadFromSasUri shall copy from SASURI the hostname to a new const char* ]*/
+        /*Codes_SRS_BLOB_02_004: [ Blob_UploadFromSasUri shall copy from SASURI the hostname to a new const char*. ]*/
+        /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+        /*Codes_SRS_BLOB_02_006: [ Blob_UploadFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
+        /*Codes_SRS_BLOB_02_018: [ Blob_UploadFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
+        /*Codes_SRS_BLOB_02_035: [ If certificates is non-NULL then Blob_UploadFromSasUri shall pass certificates to HTTPAPI_EX_HANDLE by calling HTTPAPIEX_SetOption with the option name "TrustedCerts". ]*/
+        /*Codes_SRS_BLOB_02_037: [ If certificates is non-NULL then Blob_UploadFromSasUri shall pass certificates to HTTPAPI_EX_HANDLE by calling HTTPAPIEX_SetOption with the option name "TrustedCerts". ]*/
+        /*Codes_SRS_BLOB_02_008: [ Blob_UploadFromSasUri shall compute the relative path of the request from the SASURI parameter. ]*/
+        /*Codes_SRS_BLOB_02_019: [ Blob_UploadFromSasUri shall compute the base relative path of the request from the SASURI parameter. ]*/
+        else if ((result = CreateHttpApiExFromSasUri(SASURI, certificates, &httpApiExHandle, &relativePath)) != BLOB_OK)
+        {
+            /*Codes_SRS_BLOB_02_016: [ If the hostname copy cannot be made then then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
+            /*Codes_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
+            /*Codes_SRS_BLOB_02_036: [ If HTTPAPIEX_SetOption fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
+            /*Codes_SRS_BLOB_02_038: [ If HTTPAPIEX_SetOption fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("unable to create the HTTPAPIEX_HANDLE from the SAS URI");
+        }
         else
         {
-            /*Codes_SRS_BLOB_02_017: [ Blob_UploadFromSasUri shall copy from SASURI the hostname to a new const char* ]*/
-            /*Codes_SRS_BLOB_02_004: [ Blob_UploadFromSasUri shall copy from SASURI the hostname to a new const char*. ]*/
-            /*to find the hostname, the following logic is applied:*/
-            /*the hostname starts at the first character after "://"*/
-            /*the hostname ends at the first character before the next "/" after "://"*/
-            const char* hostnameBegin = strstr(SASURI, "://");
-            if (hostnameBegin == NULL)
+            if (size < 64 * 1024 * 1024) /*code path for sizes <64MB*/
             {
-                /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-                LogError("hostname cannot be determined");
-                result = BLOB_INVALID_ARG;
-            }
-            else
-            {
-                hostnameBegin += 3; /*have to skip 3 characters which are "://"*/
-                const char* hostnameEnd = strchr(hostnameBegin, '/');
-                if (hostnameEnd == NULL)
+                /*Codes_SRS_BLOB_02_010: [ Blob_UploadFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
+                BUFFER_HANDLE requestBuffer = BUFFER_create(source, size);
+                if (requestBuffer == NULL)
                 {
-                    /*Codes_SRS_BLOB_02_005: [ If the hostname cannot be determined, then Blob_UploadFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
-                    LogError("hostname cannot be determined");
-                    result = BLOB_INVALID_ARG;
+                    /*Codes_SRS_BLOB_02_011: [ If any of the previous steps related to building the HTTPAPI_EX_ExecuteRequest parameters fails, then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
+                    LogError("unable to BUFFER_create");
+                    result = BLOB_ERROR;
                 }
                 else
                 {
-                    size_t hostnameSize = hostnameEnd - hostnameBegin;
-                    char* hostname = (char*)malloc(hostnameSize + 1); /*+1 because of '\0' at the end*/
-                    if (hostname == NULL)
+                    /*Codes_SRS_BLOB_02_009: [ Blob_UploadFromSasUri shall create an HTTP_HEADERS_HANDLE for the request HTTP headers carrying the following headers: ]*/
+                    HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc();
+                    if (requestHttpHeaders == NULL)
                     {
-                        /*Codes_SRS_BLOB_02_016: [ If the hostname copy cannot be made then then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                        LogError("oom - out of memory");
+                        /*Codes_SRS_BLOB_02_011: [ If any of the previous steps related to building the HTTPAPI_EX_ExecuteRequest parameters fails, then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
+                        LogError("unable to HTTPHeaders_Alloc");
                         result = BLOB_ERROR;
                     }
                     else
                     {
-                        HTTPAPIEX_HANDLE httpApiExHandle;
-                        (void)memcpy(hostname, hostnameBegin, hostnameSize);
-                        hostname[hostnameSize] = '\0';
-
-                        /*Codes_SRS_BLOB_02_006: [ Blob_UploadFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
-                        /*Codes_SRS_BLOB_02_018: [ Blob_UploadFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
-                        httpApiExHandle = HTTPAPIEX_Create(hostname);
-                        if (httpApiExHandle == NULL)
+                        if (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "x-ms-blob-type", "BlockBlob") != HTTP_HEADERS_OK)
                         {
-                            /*Codes_SRS_BLOB_02_007: [ If HTTPAPIEX_Create fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
-                            LogError("unable to create a HTTPAPIEX_HANDLE");
+                            /*Codes_SRS_BLOB_02_011: [ If any of the previous steps related to building the HTTPAPI_EX_ExecuteRequest parameters fails, then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
+                            LogError("unable to HTTPHeaders_AddHeaderNameValuePair");
                             result = BLOB_ERROR;
                         }
                         else
                         {
-                            if ((certificates != NULL)&& (HTTPAPIEX_SetOption(httpApiExHandle, "TrustedCerts", certificates) == HTTPAPIEX_ERROR))
+                            /*Codes_SRS_BLOB_02_012: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest passing the parameters previously build, httpStatus and httpResponse ]*/
+                            if (HTTPAPIEX_ExecuteRequest(httpApiExHandle, HTTPAPI_REQUEST_PUT, relativePath, requestHttpHeaders, requestBuffer, httpStatus, NULL, httpResponse) != HTTPAPIEX_OK)
                             {
-                                LogError("failure in setting trusted certificates");
-                                result = BLOB_ERROR;
+                                /*Codes_SRS_BLOB_02_013: [ If HTTPAPIEX_ExecuteRequest fails, then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                                LogError("failed to HTTPAPIEX_ExecuteRequest");
+                                result = BLOB_HTTP_ERROR;
                             }
                             else
                             {
+                                /*Codes_SRS_BLOB_02_015: [ Otherwise, HTTPAPIEX_ExecuteRequest shall succeed and return BLOB_OK. ]*/
+                                result = BLOB_OK;
+                            }
+                        }
+                        HTTPHeaders_Free(requestHttpHeaders);
+                    }
+                    BUFFER_delete(requestBuffer);
+                }
+            }
+            else /*code path for size >= 64MB*/
+            {
+                /*Codes_SRS_BLOB_02_023: [ Blob_UploadFromSasUri shall copy every block in a single request BUFFER_HANDLE that is reused for all the blocks and for the block list. ]*/
+                BUFFER_HANDLE requestContent = BUFFER_new();
+                if (requestContent == NULL)
+                {
+                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
+                    LogError("unable to BUFFER_new");
+                    result = BLOB_ERROR;
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_02_028: [ Blob_UploadFromSasUri shall construct an XML string with the following content: ]*/
+                    STRING_HANDLE blockIDList = STRING_construct(BLOCK_LIST_BEGIN);
+                    if (blockIDList == NULL)
+                    {
+                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
+                        LogError("failed to STRING_construct");
+                        result = BLOB_ERROR;
+                    }
+                    else
+                    {
+                        size_t toUpload = size;
+                        unsigned int blockID = 0;
+                        int isDone = 0; /*set when the block list has been put or a block was refused*/
 
-                                /*Codes_SRS_BLOB_02_008: [ Blob_UploadFromSasUri shall compute the relative path of the request from the SASURI parameter. ]*/
-                                /*Codes_SRS_BLOB_02_019: [ Blob_UploadFromSasUri shall compute the base relative path of the request from the SASURI parameter. ]*/
-                                const char* relativePath = hostnameEnd; /*this is where the relative path begins in the SasUri*/
+                        /*Codes_SRS_BLOB_02_021: [ For every block of 4MB the following operations shall happen: ]*/
+                        while ((result == BLOB_OK) && !isDone)
+                        {
+                            size_t thisBlockSize = (toUpload > BLOCK_SIZE) ? BLOCK_SIZE : toUpload;
 
-                                if (size < 64 * 1024 * 1024) /*code path for sizes <64MB*/
-                                {
-                                    /*Codes_SRS_BLOB_02_010: [ Blob_UploadFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
-                                    BUFFER_HANDLE requestBuffer = BUFFER_create(source, size);
-                                    if (requestBuffer == NULL)
-                                    {
-                                        /*Codes_SRS_BLOB_02_011: [ If any of the previous steps related to building the HTTPAPI_EX_ExecuteRequest parameters fails, then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
-                                        LogError("unable to BUFFER_create");
-                                        result = BLOB_ERROR;
-                                    }
-                                    else
-                                    {
-                                        /*Codes_SRS_BLOB_02_009: [ Blob_UploadFromSasUri shall create an HTTP_HEADERS_HANDLE for the request HTTP headers carrying the following headers: ]*/
-                                        HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc();
-                                        if (requestHttpHeaders == NULL)
-                                        {
-                                            /*Codes_SRS_BLOB_02_011: [ If any of the previous steps related to building the HTTPAPI_EX_ExecuteRequest parameters fails, then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
-                                            LogError("unable to HTTPHeaders_Alloc");
-                                            result = BLOB_ERROR;
-                                        }
-                                        else
-                                        {
-                                            if (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "x-ms-blob-type", "BlockBlob") != HTTP_HEADERS_OK)
-                                            {
-                                                /*Codes_SRS_BLOB_02_011: [ If any of the previous steps related to building the HTTPAPI_EX_ExecuteRequest parameters fails, then Blob_UploadFromSasUri shall fail and return BLOB_ERROR. ]*/
-                                                LogError("unable to HTTPHeaders_AddHeaderNameValuePair");
-                                                result = BLOB_ERROR;
-                                            }
-                                            else
-                                            {
-                                                /*Codes_SRS_BLOB_02_012: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest passing the parameters previously build, httpStatus and httpResponse ]*/
-                                                if (HTTPAPIEX_ExecuteRequest(httpApiExHandle, HTTPAPI_REQUEST_PUT, relativePath, requestHttpHeaders, requestBuffer, httpStatus, NULL, httpResponse) != HTTPAPIEX_OK)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_013: [ If HTTPAPIEX_ExecuteRequest fails, then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                                    LogError("failed to HTTPAPIEX_ExecuteRequest");
-                                                    result = BLOB_HTTP_ERROR;
-                                                }
-                                                else
-                                                {
-                                                    /*Codes_SRS_BLOB_02_015: [ Otherwise, HTTPAPIEX_ExecuteRequest shall succeed and return BLOB_OK. ]*/
-                                                    result = BLOB_OK;
-                                                }
-                                            }
-                                            HTTPHeaders_Free(requestHttpHeaders);
-                                        }
-                                        BUFFER_delete(requestBuffer);
-                                    }
-                                }
-                                else /*code path for size >= 64MB*/
+                            /*Codes_SRS_BLOB_02_020: [ Blob_UploadFromSasUri shall construct a BASE64 encoded string from the block ID (000000... 049999) ]*/
+                            /*Codes_SRS_BLOB_02_022: [ Blob_UploadFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
+                            /*Codes_SRS_BLOB_02_024: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
+                            if ((result = UploadBlock(httpApiExHandle, relativePath, requestContent, source + (size - toUpload), thisBlockSize, blockID, blockIDList, httpStatus, httpResponse)) != BLOB_OK)
+                            {
+                                /*Codes_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                                LogError("unable to upload block %u", blockID);
+                            }
+                            else if (*httpStatus >= 300)
+                            {
+                                /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadFromSasUri shall succeed and return BLOB_OK. ]*/
+                                LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
+                                isDone = 1;
+                            }
+                            else
+                            {
+                                /*Codes_SRS_BLOB_02_027: [ Otherwise Blob_UploadFromSasUri shall continue execution. ]*/
+                                blockID++;
+                                toUpload -= thisBlockSize;
+                                if (toUpload == 0)
                                 {
-                                    size_t toUpload = size;
-                                    /*Codes_SRS_BLOB_02_028: [ Blob_UploadFromSasUri shall construct an XML string with the following content: ]*/
-                                    STRING_HANDLE xml = STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"); /*the XML "build as we go"*/
-                                    if (xml == NULL)
-                                    {
-                                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                        LogError("failed to STRING_construct");
-                                        result = BLOB_HTTP_ERROR;
-                                    }
-                                    else
-                                    {
-                                        /*Codes_SRS_BLOB_02_021: [ For every block of 4MB the following operations shall happen: ]*/
-                                        unsigned int blockID = 0;
-                                        result = BLOB_ERROR;
-
-                                        int isError = 0; /*used to cleanly exit the loop*/
-                                        do
-                                        {
-                                            /*setting this block size*/
-                                            size_t thisBlockSize = (toUpload > BLOCK_SIZE) ? BLOCK_SIZE : toUpload;
-                                            /*Codes_SRS_BLOB_02_020: [ Blob_UploadFromSasUri shall construct a BASE64 encoded string from the block ID (000000... 0499999) ]*/
-                                            char temp[7]; /*this will contain 000000... 049999*/
-                                            if (sprintf(temp, "%6u", (unsigned int)blockID) != 6) /*produces 000000... 049999*/
-                                            {
-                                                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                LogError("failed to sprintf");
-                                                result = BLOB_ERROR;
-                                                isError = 1;
-                                            }
-                                            else
-                                            {
-                                                STRING_HANDLE blockIdString = Base64_Encode_Bytes((const unsigned char*)temp, 6);
-                                                if (blockIdString == NULL)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                    LogError("unable to Base64_Encode_Bytes");
-                                                    result = BLOB_ERROR;
-                                                    isError = 1;
-                                                }
-                                                else
-                                                {
-                                                    /*add the blockId base64 encoded to the XML*/
-                                                    if (!(
-                                                        (STRING_concat(xml, "<Latest>") == 0) &&
-                                                        (STRING_concat_with_STRING(xml, blockIdString) == 0) &&
-                                                        (STRING_concat(xml, "</Latest>") == 0)
-                                                        ))
-                                                    {
-                                                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                        LogError("unable to STRING_concat");
-                                                        result = BLOB_ERROR;
-                                                        isError = 1;
-                                                    }
-                                                    else
-                                                    {
-                                                        /*Codes_SRS_BLOB_02_022: [ Blob_UploadFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
-                                                        STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-                                                        if (newRelativePath == NULL)
-                                                        {
-                                                            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                            LogError("unable to STRING_construct");
-                                                            result = BLOB_ERROR;
-                                                            isError = 1;
-                                                        }
-                                                        else
-                                                        {
-                                                            if (!(
-                                                                (STRING_concat(newRelativePath, "&comp=block&blockid=") == 0) &&
-                                                                (STRING_concat_with_STRING(newRelativePath, blockIdString) == 0)
-                                                                ))
-                                                            {
-                                                                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                                LogError("unable to STRING concatenate");
-                                                                result = BLOB_ERROR;
-                                                                isError = 1;
-                                                            }
-                                                            else
-                                                            {
-                                                                /*Codes_SRS_BLOB_02_023: [ Blob_UploadFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
-                                                                BUFFER_HANDLE requestContent = BUFFER_create(source + (size - toUpload), thisBlockSize);
-                                                                if (requestContent == NULL)
-                                                                {
-                                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                                    LogError("unable to BUFFER_create");
-                                                                    result = BLOB_ERROR;
-                                                                    isError = 1;
-                                                                }
-                                                                else
-                                                                {
-                                                                    /*Codes_SRS_BLOB_02_024: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
-                                                                    if (HTTPAPIEX_ExecuteRequest(
-                                                                        httpApiExHandle,
-                                                                        HTTPAPI_REQUEST_PUT,
-                                                                        STRING_c_str(newRelativePath),
-                                                                        NULL,
-                                                                        requestContent,
-                                                                        httpStatus,
-                                                                        NULL,
-                                                                        httpResponse) != HTTPAPIEX_OK
-                                                                        )
-                                                                    {
-                                                                        /*Codes_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                                                        LogError("unable to HTTPAPIEX_ExecuteRequest");
-                                                                        result = BLOB_HTTP_ERROR;
-                                                                        isError = 1;
-                                                                    }
-                                                                    else if (*httpStatus >= 300)
-                                                                    {
-                                                                        /*Codes_SRS_BLOB_02_026: [ Otherwise, if HTTP response code is >=300 then Blob_UploadFromSasUri shall succeed and return BLOB_OK. ]*/
-                                                                        LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
-                                                                        result = BLOB_OK;
-                                                                        isError = 1;
-                                                                    }
-                                                                    else
-                                                                    {
-                                                                        /*Codes_SRS_BLOB_02_027: [ Otherwise Blob_UploadFromSasUri shall continue execution. ]*/
-                                                                    }
-                                                                    BUFFER_delete(requestContent);
-                                                                }
-                                                            }
-                                                            STRING_delete(newRelativePath);
-                                                        }
-                                                    }
-                                                    STRING_delete(blockIdString);
-                                                }
-                                            }
-
-                                            blockID++;
-                                            toUpload -= thisBlockSize;
-                                        } while ((toUpload > 0) && !isError);
-
-                                        if (isError)
-                                        {
-                                            /*do nothing, it will be reported "as is"*/
-                                        }
-                                        else
-                                        {
-                                            /*complete the XML*/
-                                            if (STRING_concat(xml, "</BlockList>") != 0)
-                                            {
-                                                /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                LogError("failed to STRING_concat");
-                                                result = BLOB_ERROR;
-                                            }
-                                            else
-                                            {
-                                                /*Codes_SRS_BLOB_02_029: [Blob_UploadFromSasUri shall construct a new relativePath from following string : base relativePath + "&comp=blocklist"]*/
-                                                STRING_HANDLE newRelativePath = STRING_construct(relativePath);
-                                                if (newRelativePath == NULL)
-                                                {
-                                                    /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                    LogError("failed to STRING_construct");
-                                                    result = BLOB_ERROR;
-                                                }
-                                                else
-                                                {
-                                                    if (STRING_concat(newRelativePath, "&comp=blocklist") != 0)
-                                                    {
-                                                        /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                        LogError("failed to STRING_concat");
-                                                        result = BLOB_ERROR;
-                                                    }
-                                                    else
-                                                    {
-                                                        /*Codes_SRS_BLOB_02_030: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus and httpResponse and the XML string as content. ]*/
-                                                        const char* s = STRING_c_str(xml);
-                                                        BUFFER_HANDLE xmlAsBuffer = BUFFER_create((const unsigned char*)s, strlen(s));
-                                                        if (xmlAsBuffer == NULL)
-                                                        {
-                                                            /*Codes_SRS_BLOB_02_033: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadFromSasUri shall fail and return BLOB_ERROR ]*/
-                                                            LogError("failed to BUFFER_create");
-                                                            result = BLOB_ERROR;
-                                                        }
-                                                        else
-                                                        {
-                                                            if (HTTPAPIEX_ExecuteRequest(
-                                                                httpApiExHandle,
-                                                                HTTPAPI_REQUEST_PUT,
-                                                                STRING_c_str(newRelativePath),
-                                                                NULL,
-                                                                xmlAsBuffer,
-                                                                httpStatus,
-                                                                NULL,
-                                                                httpResponse
-                                                            ) != HTTPAPIEX_OK)
-                                                            {
-                                                                /*Codes_SRS_BLOB_02_031: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
-                                                                LogError("unable to HTTPAPIEX_ExecuteRequest");
-                                                                result = BLOB_HTTP_ERROR;
-                                                            }
-                                                            else
-                                                            {
-                                                                /*Codes_SRS_BLOB_02_032: [ Otherwise, Blob_UploadFromSasUri shall succeed and return BLOB_OK. ]*/
-                                                                result = BLOB_OK;
-                                                            }
-                                                            BUFFER_delete(xmlAsBuffer);
-                                                        }
-                                                    }
-                                                    STRING_delete(newRelativePath);
-                                                }
-                                            }
-                                        }
-                                        STRING_delete(xml);
-                                    }
+                                    /*Codes_SRS_BLOB_02_029: [ Blob_UploadFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=blocklist" ]*/
+                                    /*Codes_SRS_BLOB_02_030: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus and httpResponse and the XML string as content. ]*/
+                                    /*Codes_SRS_BLOB_02_031: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+                                    /*Codes_SRS_BLOB_02_032: [ Otherwise, Blob_UploadFromSasUri shall succeed and return BLOB_OK. ]*/
+                                    result = PutBlockList(httpApiExHandle, relativePath, requestContent, blockIDList, httpStatus, httpResponse);
+                                    isDone = 1;
                                 }
                             }
-                            HTTPAPIEX_Destroy(httpApiExHandle);
                         }
-                        free(hostname);
+                        STRING_delete(blockIDList);
+                    }
+                    BUFFER_delete(requestContent);
+                }
+            }
+            HTTPAPIEX_Destroy(httpApiExHandle);
+        }
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadMultipleBlocksFromSasUri(const char* SASURI, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, void* context, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates)
+{
+    BLOB_RESULT result;
+    HTTPAPIEX_HANDLE httpApiExHandle = NULL;
+    const char* relativePath = NULL;
+
+    /*Codes_SRS_BLOB_09_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    /*Codes_SRS_BLOB_09_002: [ If getDataCallback is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if ((SASURI == NULL) || (getDataCallback == NULL))
+    {
+        LogError("invalid argument detected SASURI=%p getDataCallback=%p", SASURI, getDataCallback);
+        result = BLOB_INVALID_ARG;
+    }
+    else if ((result = CreateHttpApiExFromSasUri(SASURI, certificates, &httpApiExHandle, &relativePath)) != BLOB_OK)
+    {
+        LogError("unable to create the HTTPAPIEX_HANDLE from the SAS URI");
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_007: [ Blob_UploadMultipleBlocksFromSasUri shall create a single BUFFER_HANDLE that is reused as content of every request. ]*/
+        BUFFER_HANDLE requestContent = BUFFER_new();
+        if (requestContent == NULL)
+        {
+            /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("unable to BUFFER_new");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            /*the XML "build as we go"*/
+            STRING_HANDLE blockIDList = STRING_construct(BLOCK_LIST_BEGIN);
+            if (blockIDList == NULL)
+            {
+                /*Codes_SRS_BLOB_09_016: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                LogError("failed to STRING_construct");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                unsigned int blockID = 0;
+                int isDone = 0; /*set when all the blocks have been uploaded*/
+
+                while ((result == BLOB_OK) && !isDone)
+                {
+                    const unsigned char* data = NULL;
+                    size_t size = 0;
+
+                    /*Codes_SRS_BLOB_09_008: [ Blob_UploadMultipleBlocksFromSasUri shall get the next block by calling getDataCallback with FILE_UPLOAD_OK, the addresses of a data pointer and of a size, and context. ]*/
+                    getDataCallback(FILE_UPLOAD_OK, &data, &size, context);
+
+                    if ((data == NULL) || (size == 0))
+                    {
+                        /*Codes_SRS_BLOB_09_009: [ When getDataCallback returns a NULL data or a size of 0, Blob_UploadMultipleBlocksFromSasUri shall stop getting blocks and put the block list. ]*/
+                        result = PutBlockList(httpApiExHandle, relativePath, requestContent, blockIDList, httpStatus, httpResponse);
+                        isDone = 1;
+                    }
+                    else if (size > BLOCK_SIZE)
+                    {
+                        /*Codes_SRS_BLOB_09_010: [ If getDataCallback returns a block bigger than 4MB or more than 50000 blocks then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+                        LogError("block size too big (%zu)", size);
+                        result = BLOB_INVALID_ARG;
+                    }
+                    else if (blockID >= MAX_BLOCK_COUNT)
+                    {
+                        /*Codes_SRS_BLOB_09_010: [ If getDataCallback returns a block bigger than 4MB or more than 50000 blocks then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+                        LogError("too many blocks");
+                        result = BLOB_INVALID_ARG;
+                    }
+                    else if ((result = UploadBlock(httpApiExHandle, relativePath, requestContent, data, size, blockID, blockIDList, httpStatus, httpResponse)) != BLOB_OK)
+                    {
+                        LogError("unable to upload block %u", blockID);
+                    }
+                    else if (*httpStatus >= 300)
+                    {
+                        /*Codes_SRS_BLOB_09_013: [ If the HTTP response code of a block is >=300 then Blob_UploadMultipleBlocksFromSasUri shall stop and return BLOB_OK. ]*/
+                        LogError("HTTP status from storage does not indicate success (%d)", (int)*httpStatus);
+                        isDone = 1;
+                    }
+                    else
+                    {
+                        blockID++;
+                    }
+                }
+                STRING_delete(blockIDList);
+            }
+            BUFFER_delete(requestContent);
+        }
+        HTTPAPIEX_Destroy(httpApiExHandle);
+    }
+    return result;
+}
+
+/*state shared by the threads of Blob_UploadBlocksFromSasUri, the fields below lock are guarded by it*/
+typedef struct PARALLEL_UPLOAD_TAG
+{
+    const char* SASURI;
+    const char* certificates;
+    const unsigned char* source;
+    size_t size;
+    size_t blockSize;
+    unsigned int blockCount;
+    unsigned char* uploadedBlocks; /*NULL or one entry per block, not 0 when the block is already in the storage*/
+    LOCK_HANDLE lock;
+    unsigned int nextBlockID;
+    int isDone; /*set by the first block that fails or gets a HTTP status >= 300*/
+    BLOB_RESULT result;
+    unsigned int* httpStatus;
+    BUFFER_HANDLE httpResponse;
+} PARALLEL_UPLOAD;
+
+static void StopParallelUpload(PARALLEL_UPLOAD* upload, BLOB_RESULT result, unsigned int httpStatus, BUFFER_HANDLE httpResponse)
+{
+    if (Lock(upload->lock) != LOCK_OK)
+    {
+        LogError("unable to Lock");
+    }
+    else
+    {
+        /*only the first failure is reported, the other blocks are not looked at anymore*/
+        if (!upload->isDone)
+        {
+            upload->isDone = 1;
+            upload->result = result;
+            *upload->httpStatus = httpStatus;
+            if ((httpResponse != NULL) &&
+                (upload->httpResponse != NULL) &&
+                (BUFFER_build(upload->httpResponse, BUFFER_u_char(httpResponse), BUFFER_length(httpResponse)) != 0))
+            {
+                LogError("unable to copy the HTTP response");
+            }
+        }
+        (void)Unlock(upload->lock);
+    }
+}
+
+static void UploadParallelBlocks(PARALLEL_UPLOAD* upload, HTTPAPIEX_HANDLE httpApiExHandle, const char* relativePath, BUFFER_HANDLE requestContent, BUFFER_HANDLE httpResponse)
+{
+    int isDone = 0;
+
+    while (!isDone)
+    {
+        unsigned int blockID = 0;
+
+        /*Codes_SRS_BLOB_09_024: [ Every connection shall take the next block ID that has not been taken yet until all the blocks are uploaded or the upload is stopped. ]*/
+        if (Lock(upload->lock) != LOCK_OK)
+        {
+            LogError("unable to Lock");
+            isDone = 1;
+        }
+        else
+        {
+            /*Codes_SRS_BLOB_09_032: [ Blob_ResumeUploadBlocksFromSasUri shall not upload again the blocks whose uploadedBlocks entry is not 0. ]*/
+            while ((upload->uploadedBlocks != NULL) && (upload->nextBlockID < upload->blockCount) && (upload->uploadedBlocks[upload->nextBlockID] != 0))
+            {
+                upload->nextBlockID++;
+            }
+
+            if (upload->isDone || (upload->nextBlockID == upload->blockCount))
+            {
+                isDone = 1;
+            }
+            else
+            {
+                blockID = upload->nextBlockID++;
+            }
+            (void)Unlock(upload->lock);
+        }
+
+        if (!isDone)
+        {
+            BLOB_RESULT result;
+            unsigned int httpStatus = 0;
+            size_t offset = (size_t)blockID * upload->blockSize;
+            size_t thisBlockSize = (upload->size - offset > upload->blockSize) ? upload->blockSize : upload->size - offset;
+
+            /*Codes_SRS_BLOB_09_025: [ For every block Blob_UploadBlocksFromSasUri shall construct a new relativePath from base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId", copy the block in the connection's request BUFFER_HANDLE and call HTTPAPIEX_ExecuteRequest with a PUT operation. ]*/
+            if ((result = UploadBlock(httpApiExHandle, relativePath, requestContent, upload->source + offset, thisBlockSize, blockID, NULL, &httpStatus, httpResponse)) != BLOB_OK)
+            {
+                /*Codes_SRS_BLOB_09_026: [ If uploading a block fails then Blob_UploadBlocksFromSasUri shall stop all the connections and return the failure (BLOB_HTTP_ERROR when HTTPAPIEX_ExecuteRequest fails, BLOB_ERROR otherwise). ]*/
+                LogError("unable to upload block %u", blockID);
+                StopParallelUpload(upload, result, httpStatus, NULL);
+                isDone = 1;
+            }
+            else if (httpStatus >= 300)
+            {
+                /*Codes_SRS_BLOB_09_027: [ If the HTTP response code of a block is >=300 then Blob_UploadBlocksFromSasUri shall stop all the connections and return BLOB_OK with that HTTP status and HTTP response. ]*/
+                LogError("HTTP status from storage does not indicate success (%d)", (int)httpStatus);
+                StopParallelUpload(upload, BLOB_OK, httpStatus, httpResponse);
+                isDone = 1;
+            }
+            else
+            {
+                /*Codes_SRS_BLOB_09_033: [ Blob_ResumeUploadBlocksFromSasUri shall set to 1 the uploadedBlocks entry of every block that has been uploaded with a HTTP status < 300, even when the upload fails later. ]*/
+                if (upload->uploadedBlocks != NULL)
+                {
+                    upload->uploadedBlocks[blockID] = 1; /*every block is written by only one thread*/
+                }
+            }
+        }
+    }
+}
+
+static int UploadParallelBlocksThread(void* arg)
+{
+    PARALLEL_UPLOAD* upload = (PARALLEL_UPLOAD*)arg;
+    HTTPAPIEX_HANDLE httpApiExHandle = NULL;
+    const char* relativePath = NULL;
+    BLOB_RESULT result;
+
+    /*Codes_SRS_BLOB_09_023: [ Every other thread shall create its own HTTPAPIEX_HANDLE (passing certificates, if any, as "TrustedCerts"), request BUFFER_HANDLE and response BUFFER_HANDLE. ]*/
+    if ((result = CreateHttpApiExFromSasUri(upload->SASURI, upload->certificates, &httpApiExHandle, &relativePath)) != BLOB_OK)
+    {
+        LogError("unable to create the HTTPAPIEX_HANDLE from the SAS URI");
+        StopParallelUpload(upload, result, 0, NULL);
+    }
+    else
+    {
+        BUFFER_HANDLE requestContent;
+        BUFFER_HANDLE httpResponse;
+
+        if ((requestContent = BUFFER_new()) == NULL)
+        {
+            LogError("unable to BUFFER_new");
+            StopParallelUpload(upload, BLOB_ERROR, 0, NULL);
+        }
+        else
+        {
+            if ((httpResponse = BUFFER_new()) == NULL)
+            {
+                LogError("unable to BUFFER_new");
+                StopParallelUpload(upload, BLOB_ERROR, 0, NULL);
+            }
+            else
+            {
+                UploadParallelBlocks(upload, httpApiExHandle, relativePath, requestContent, httpResponse);
+                BUFFER_delete(httpResponse);
+            }
+            BUFFER_delete(requestContent);
+        }
+        HTTPAPIEX_Destroy(httpApiExHandle);
+    }
+
+    return 0;
+}
+
+static STRING_HANDLE CreateParallelBlockList(unsigned int blockCount)
+{
+    STRING_HANDLE result = STRING_construct(BLOCK_LIST_BEGIN);
+    if (result == NULL)
+    {
+        LogError("failed to STRING_construct");
+    }
+    else
+    {
+        unsigned int blockID;
+        for (blockID = 0; blockID < blockCount; blockID++)
+        {
+            STRING_HANDLE blockIdString = NULL;
+
+            if (((blockIdString = CreateBlockIdString(blockID)) == NULL) ||
+                (AddBlockToBlockList(result, blockIdString) != 0))
+            {
+                LogError("unable to add block %u to the block list", blockID);
+                STRING_delete(blockIdString);
+                STRING_delete(result);
+                result = NULL;
+                break;
+            }
+            STRING_delete(blockIdString);
+        }
+    }
+    return result;
+}
+
+static BLOB_RESULT UploadBlocksFromSasUri(const char* SASURI, const unsigned char* source, size_t size, size_t blockSize, size_t concurrency, unsigned char* uploadedBlocks, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates)
+{
+    BLOB_RESULT result;
+    HTTPAPIEX_HANDLE httpApiExHandle = NULL;
+    const char* relativePath = NULL;
+
+    /*Codes_SRS_BLOB_09_018: [ If SASURI or httpStatus is NULL, or source is NULL and size is not zero, then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if ((SASURI == NULL) || (httpStatus == NULL) || ((source == NULL) && (size > 0)))
+    {
+        LogError("invalid argument detected SASURI=%p source=%p size=%zu httpStatus=%p", SASURI, source, size, httpStatus);
+        result = BLOB_INVALID_ARG;
+    }
+    /*Codes_SRS_BLOB_09_019: [ If blockSize is 0 or bigger than BLOB_BLOCK_SIZE_MAX, concurrency is 0 or size needs more than 50000 blocks then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    else if ((blockSize == 0) || (blockSize > BLOB_BLOCK_SIZE_MAX) || (concurrency == 0) || ((size > 0) && ((size - 1) / blockSize >= MAX_BLOCK_COUNT)))
+    {
+        LogError("invalid argument detected blockSize=%zu concurrency=%zu size=%zu", blockSize, concurrency, size);
+        result = BLOB_INVALID_ARG;
+    }
+    /*Codes_SRS_BLOB_09_020: [ Blob_UploadBlocksFromSasUri shall create a HTTPAPIEX_HANDLE to the hostname of SASURI, passing certificates, if any, as "TrustedCerts". ]*/
+    else if ((result = CreateHttpApiExFromSasUri(SASURI, certificates, &httpApiExHandle, &relativePath)) != BLOB_OK)
+    {
+        LogError("unable to create the HTTPAPIEX_HANDLE from the SAS URI");
+    }
+    else
+    {
+        PARALLEL_UPLOAD upload;
+        BUFFER_HANDLE requestContent = NULL;
+        BUFFER_HANDLE blockResponse = NULL;
+
+        upload.SASURI = SASURI;
+        upload.certificates = certificates;
+        upload.source = source;
+        upload.size = size;
+        upload.blockSize = blockSize;
+        upload.blockCount = (unsigned int)((size + blockSize - 1) / blockSize);
+        upload.uploadedBlocks = uploadedBlocks;
+        upload.nextBlockID = 0;
+        upload.isDone = 0;
+        upload.result = BLOB_OK;
+        upload.httpStatus = httpStatus;
+        upload.httpResponse = httpResponse;
+        upload.lock = NULL;
+
+        if (
+            ((requestContent = BUFFER_new()) == NULL) ||
+            ((blockResponse = BUFFER_new()) == NULL) ||
+            ((upload.lock = Lock_Init()) == NULL)
+            )
+        {
+            /*Codes_SRS_BLOB_09_029: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+            LogError("unable to allocate the upload state");
+            result = BLOB_ERROR;
+        }
+        else
+        {
+            /*there is no point in having more connections than blocks left to upload*/
+            size_t blocksToUpload = upload.blockCount;
+            size_t connectionCount;
+            size_t threadCount;
+            THREAD_HANDLE* threads = NULL;
+            size_t startedThreads = 0;
+
+            if (uploadedBlocks != NULL)
+            {
+                unsigned int blockID;
+                for (blockID = 0; blockID < upload.blockCount; blockID++)
+                {
+                    if (uploadedBlocks[blockID] != 0)
+                    {
+                        blocksToUpload--;
+                    }
+                }
+            }
+            connectionCount = (concurrency < blocksToUpload) ? concurrency : blocksToUpload;
+            threadCount = (connectionCount > 0) ? connectionCount - 1 : 0;
+
+            if ((threadCount > 0) && ((threads = (THREAD_HANDLE*)malloc(threadCount * sizeof(THREAD_HANDLE))) == NULL))
+            {
+                /*Codes_SRS_BLOB_09_029: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                LogError("unable to malloc");
+                result = BLOB_ERROR;
+            }
+            else
+            {
+                size_t i;
+
+                /*Codes_SRS_BLOB_09_021: [ Blob_UploadBlocksFromSasUri shall start concurrency - 1 threads (at most one per block), the calling thread uploading blocks as well. ]*/
+                for (startedThreads = 0; startedThreads < threadCount; startedThreads++)
+                {
+                    if (ThreadAPI_Create(&threads[startedThreads], UploadParallelBlocksThread, &upload) != THREADAPI_OK)
+                    {
+                        /*Codes_SRS_BLOB_09_022: [ If a thread cannot be started then Blob_UploadBlocksFromSasUri shall stop the threads already started and fail with BLOB_ERROR. ]*/
+                        LogError("unable to ThreadAPI_Create");
+                        StopParallelUpload(&upload, BLOB_ERROR, 0, NULL);
+                        break;
+                    }
+                }
+
+                UploadParallelBlocks(&upload, httpApiExHandle, relativePath, requestContent, blockResponse);
+
+                for (i = 0; i < startedThreads; i++)
+                {
+                    int notUsed;
+                    if (ThreadAPI_Join(threads[i], &notUsed) != THREADAPI_OK)
+                    {
+                        LogError("unable to ThreadAPI_Join");
+                    }
+                }
+                free(threads);
+
+                if (upload.isDone)
+                {
+                    /*a block failed or was refused, the block list is not committed*/
+                    result = upload.result;
+                }
+                else
+                {
+                    /*Codes_SRS_BLOB_09_028: [ Once all the blocks are uploaded, Blob_UploadBlocksFromSasUri shall put the XML block list with the block IDs in order, passing httpStatus and httpResponse, and return BLOB_HTTP_ERROR if HTTPAPIEX_ExecuteRequest fails, BLOB_OK otherwise. ]*/
+                    STRING_HANDLE blockIDList = CreateParallelBlockList(upload.blockCount);
+                    if (blockIDList == NULL)
+                    {
+                        /*Codes_SRS_BLOB_09_029: [ If any previous operation that doesn't have an explicit failure description fails then Blob_UploadBlocksFromSasUri shall fail and return BLOB_ERROR. ]*/
+                        LogError("unable to build the block list");
+                        result = BLOB_ERROR;
+                    }
+                    else
+                    {
+                        result = PutBlockList(httpApiExHandle, relativePath, requestContent, blockIDList, httpStatus, httpResponse);
+                        STRING_delete(blockIDList);
                     }
                 }
             }
+            Lock_Deinit(upload.lock);
         }
+        BUFFER_delete(blockResponse);
+        BUFFER_delete(requestContent);
+        HTTPAPIEX_Destroy(httpApiExHandle);
+    }
+    return result;
+}
+
+BLOB_RESULT Blob_UploadBlocksFromSasUri(const char* SASURI, const unsigned char* source, size_t size, size_t blockSize, size_t concurrency, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates)
+{
+    return UploadBlocksFromSasUri(SASURI, source, size, blockSize, concurrency, NULL, httpStatus, httpResponse, certificates);
+}
+
+BLOB_RESULT Blob_ResumeUploadBlocksFromSasUri(const char* SASURI, const unsigned char* source, size_t size, size_t blockSize, size_t concurrency, unsigned char* uploadedBlocks, unsigned int* httpStatus, BUFFER_HANDLE httpResponse, const char* certificates)
+{
+    BLOB_RESULT result;
+
+    /*Codes_SRS_BLOB_09_030: [ If uploadedBlocks is NULL then Blob_ResumeUploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+    if (uploadedBlocks == NULL)
+    {
+        LogError("invalid argument detected uploadedBlocks=%p", uploadedBlocks);
+        result = BLOB_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_BLOB_09_031: [ Otherwise Blob_ResumeUploadBlocksFromSasUri shall behave as Blob_UploadBlocksFromSasUri. ]*/
+        result = UploadBlocksFromSasUri(SASURI, source, size, blockSize, concurrency, uploadedBlocks, httpStatus, httpResponse, certificates);
     }
     return result;
 }
@@ -7,14 +7,20 @@
 
 #include <signal.h>
 #include <stddef.h>
+#include <string.h>
+#include <limits.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "iothub_client.h"
 #include "iothub_client_ll.h"
+#include "iothub_client_options.h"
 #include "iothub_client_private.h"
+#include "iothub_client_mpsc_queue.h"
+#include "iothub_client_callback_pool.h"
 #include "iothubtransport.h"
 #include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/vector.h"
@@ -28,6 +34,15 @@ typedef struct IOTHUB_CLIENT_INSTANCE_TAG
     THREAD_HANDLE ThreadHandle;
     LOCK_HANDLE LockHandle;
     sig_atomic_t StopThread;
+    COND_HANDLE WorkerCondition; /*signaled when there is work for ScheduleWork_Thread, waited on with WorkerLock held*/
+    LOCK_HANDLE WorkerLock; /*guards WorkPending and the signal, so that a wakeup cannot slip in between the check and Condition_Wait*/
+    sig_atomic_t WorkPending;
+    unsigned int DoWorkFrequencyInMs;
+    MPSC_QUEUE_HANDLE SendQueue; /*SEND_EVENT_REQUESTs handed to ScheduleWork_Thread without taking LockHandle*/
+    CALLBACK_POOL_HANDLE CallbackPool; /*when not NULL, user callbacks run on these threads instead of the one calling IoTHubClient_LL_DoWork*/
+    LOCK_HANDLE StatisticsLock; /*guards StatisticsSnapshot, so that IoTHubClient_GetStatistics does not wait for a DoWork holding LockHandle*/
+    IOTHUB_CLIENT_STATISTICS StatisticsSnapshot;
+    sig_atomic_t HasStatisticsSnapshot;
 #ifndef DONT_USE_UPLOADTOBLOB
     SINGLYLINKEDLIST_HANDLE savedDataToBeCleaned; /*list containing UPLOADTOBLOB_SAVED_DATA*/
 #endif
@@ -53,6 +68,7 @@ typedef struct UPLOADTOBLOB_SAVED_DATA_TAG
     size_t size;
     char* destinationFileName;
     IOTHUB_CLIENT_FILE_UPLOAD_CALLBACK iotHubClientFileUploadCallback;
+    IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback; /*not NULL when the file is uploaded from blocks produced by the user*/
     void* context;
     THREAD_HANDLE uploadingThreadHandle;
     IOTHUB_CLIENT_HANDLE iotHubClientHandle;
@@ -124,6 +140,17 @@ typedef struct IOTHUB_QUEUE_CONTEXT_TAG
     void* userContextCallback;
 } IOTHUB_QUEUE_CONTEXT;
 
+typedef struct SEND_EVENT_REQUEST_TAG
+{
+    IOTHUB_MESSAGE_HANDLE message;
+    IOTHUB_QUEUE_CONTEXT* queue_context; /*NULL when no eventConfirmationCallback was given*/
+} SEND_EVENT_REQUEST;
+
+/*longest wait of an idle worker thread; the xio layer has no readiness notification, so incoming data is read by the next DoWork and can wait this long (OPTION_DO_WORK_FREQUENCY_IN_MS trades it for idle CPU)*/
+#define DEFAULT_DO_WORK_FREQUENCY_IN_MS 100
+/*wait while events are in flight, so that their acknowledgements are read as soon as they arrive*/
+#define BUSY_DO_WORK_FREQUENCY_IN_MS 1
+
 /*used by unittests only*/
 const size_t IoTHubClient_ThreadTerminationOffset = offsetof(IOTHUB_CLIENT_INSTANCE, StopThread);
 
@@ -330,6 +357,44 @@ static void iothub_ll_event_confirm_callback(IOTHUB_CLIENT_CONFIRMATION_RESULT r
     }
 }
 
+/*this function is called by ScheduleWork_Thread with LockHandle held, for each event queued by IoTHubClient_SendEventAsync*/
+static void send_queued_event(void* context, void* item)
+{
+    IOTHUB_CLIENT_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_INSTANCE*)context;
+    SEND_EVENT_REQUEST* request = (SEND_EVENT_REQUEST*)item;
+
+    /*Codes_SRS_IOTHUBCLIENT_09_024: [ Before each call to IoTHubClient_LL_DoWork the thread shall drain the send queue by calling mpsc_queue_drain, handing each event's copy over to IoTHubClient_LL_SendEventAsync_TakeOwnership in the order they were queued. ]*/
+    if (IoTHubClient_LL_SendEventAsync_TakeOwnership(iotHubClientInstance->IoTHubClientLLHandle, request->message, (request->queue_context == NULL) ? NULL : iothub_ll_event_confirm_callback, request->queue_context) != IOTHUB_CLIENT_OK)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_025: [ If IoTHubClient_LL_SendEventAsync_TakeOwnership fails for a queued event, its eventConfirmationCallback shall be invoked with IOTHUB_CLIENT_CONFIRMATION_ERROR and its copy shall be destroyed. ]*/
+        LogError("IoTHubClient_LL_SendEventAsync_TakeOwnership failed for a queued event");
+        iothub_ll_event_confirm_callback(IOTHUB_CLIENT_CONFIRMATION_ERROR, request->queue_context);
+        IoTHubMessage_Destroy(request->message);
+    }
+
+    free(request);
+}
+
+/*this function is called by IoTHubClient_Destroy, once the worker thread is gone, for each event it did not get to*/
+static void destroy_queued_event(void* context, void* item)
+{
+    IOTHUB_CLIENT_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_INSTANCE*)context;
+    SEND_EVENT_REQUEST* request = (SEND_EVENT_REQUEST*)item;
+
+    if (request->queue_context != NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_026: [ After the worker thread is joined, IoTHubClient_Destroy shall invoke the eventConfirmationCallback of each event still in the send queue with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, destroy their copies and destroy the send queue. ]*/
+        if (iotHubClientInstance->event_confirm_callback)
+        {
+            iotHubClientInstance->event_confirm_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, request->queue_context->userContextCallback);
+        }
+        free(request->queue_context);
+    }
+
+    IoTHubMessage_Destroy(request->message);
+    free(request);
+}
+
 static void iothub_ll_reported_state_callback(int status_code, void* userContextCallback)
 {
     IOTHUB_QUEUE_CONTEXT* queue_context = (IOTHUB_QUEUE_CONTEXT*)userContextCallback;
@@ -398,141 +463,237 @@ static void iothub_ll_device_twin_callback(DEVICE_TWIN_UPDATE_STATE update_state
     }
 }
 
-static void dispatch_user_callbacks(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, VECTOR_HANDLE call_backs)
+static void invoke_user_callback(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, USER_CALLBACK_INFO* queued_cb)
 {
-    size_t callbacks_length = VECTOR_size(call_backs);
-    size_t index;
-    for (index = 0; index < callbacks_length; index++)
+    switch (queued_cb->type)
     {
-        USER_CALLBACK_INFO* queued_cb = (USER_CALLBACK_INFO*)VECTOR_element(call_backs, index);
-        if (queued_cb == NULL)
+        case CALLBACK_TYPE_DEVICE_TWIN:
         {
-            LogError("VECTOR_element at index %zd is NULL.", index);
+            IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK desired_state_callback;
+
+            if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+            {
+                LogError("failed locking for invoke_user_callback");
+                desired_state_callback = NULL;
+            }
+            else
+            {
+                desired_state_callback = iotHubClientInstance->desired_state_callback;
+                (void)Unlock(iotHubClientInstance->LockHandle);
+            }
+
+            if (desired_state_callback)
+            {
+                desired_state_callback(queued_cb->iothub_callback.dev_twin_cb_info.update_state, queued_cb->iothub_callback.dev_twin_cb_info.payLoad, queued_cb->iothub_callback.dev_twin_cb_info.size, queued_cb->userContextCallback);
+            }
+
+            if (queued_cb->iothub_callback.dev_twin_cb_info.payLoad)
+            {
+                free(queued_cb->iothub_callback.dev_twin_cb_info.payLoad);
+            }
+            break;
         }
-        else
-        {
-            switch (queued_cb->type)
+        case CALLBACK_TYPE_EVENT_CONFIRM:
+            if (iotHubClientInstance->event_confirm_callback)
             {
-                case CALLBACK_TYPE_DEVICE_TWIN:
-                {
-                    IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK desired_state_callback;
+                iotHubClientInstance->event_confirm_callback(queued_cb->iothub_callback.event_confirm_cb_info.confirm_result, queued_cb->userContextCallback);
+            }
+            break;
+        case CALLBACK_TYPE_REPORTED_STATE:
+            if (iotHubClientInstance->reported_state_callback)
+            {
+                iotHubClientInstance->reported_state_callback(queued_cb->iothub_callback.reported_state_cb_info.status_code, queued_cb->userContextCallback);
+            }
+            break;
+        case CALLBACK_TYPE_CONNECTION_STATUS:
+            if (iotHubClientInstance->connection_status_callback)
+            {
+                iotHubClientInstance->connection_status_callback(queued_cb->iothub_callback.connection_status_cb_info.connection_status, queued_cb->iothub_callback.connection_status_cb_info.status_reason, queued_cb->userContextCallback);
+            }
+            break;
+        case CALLBACK_TYPE_DEVICE_METHOD:
+            if (iotHubClientInstance->device_method_callback)
+            {
+                const char* method_name = STRING_c_str(queued_cb->iothub_callback.method_cb_info.method_name);
+                const unsigned char* payload = BUFFER_u_char(queued_cb->iothub_callback.method_cb_info.payload);
+                size_t payload_len = BUFFER_length(queued_cb->iothub_callback.method_cb_info.payload);
 
-                    if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
-                    {
-                        LogError("failed locking for dispatch_user_callbacks");
-                        desired_state_callback = NULL;
-                    }
-                    else
-                    {
-                        desired_state_callback = iotHubClientInstance->desired_state_callback;
-                        (void)Unlock(iotHubClientInstance->LockHandle);
-                    }
+                unsigned char* payload_resp = NULL;
+                size_t response_size = 0;
+                int status = iotHubClientInstance->device_method_callback(method_name, payload, payload_len, &payload_resp, &response_size, queued_cb->userContextCallback);
 
-                    if (desired_state_callback)
+                if (payload_resp && (response_size > 0))
+                {
+                    IOTHUB_CLIENT_HANDLE handle = iotHubClientInstance->method_user_context->iotHubClientHandle;
+                    IOTHUB_CLIENT_RESULT result = IoTHubClient_DeviceMethodResponse(handle, queued_cb->iothub_callback.method_cb_info.method_id, (const unsigned char*)payload_resp, response_size, status);
+                    if (result != IOTHUB_CLIENT_OK)
                     {
-                        desired_state_callback(queued_cb->iothub_callback.dev_twin_cb_info.update_state, queued_cb->iothub_callback.dev_twin_cb_info.payLoad, queued_cb->iothub_callback.dev_twin_cb_info.size, queued_cb->userContextCallback);
+                        LogError("IoTHubClient_LL_DeviceMethodResponse failed");
                     }
+                }
 
-                    if (queued_cb->iothub_callback.dev_twin_cb_info.payLoad)
-                    {
-                        free(queued_cb->iothub_callback.dev_twin_cb_info.payLoad);
-                    }
-                    break;
+                BUFFER_delete(queued_cb->iothub_callback.method_cb_info.payload);
+                STRING_delete(queued_cb->iothub_callback.method_cb_info.method_name);
+                
+                if (payload_resp)
+                {
+                    free(payload_resp);
                 }
-                case CALLBACK_TYPE_EVENT_CONFIRM:
-                    if (iotHubClientInstance->event_confirm_callback)
-                    {
-                        iotHubClientInstance->event_confirm_callback(queued_cb->iothub_callback.event_confirm_cb_info.confirm_result, queued_cb->userContextCallback);
-                    }
-                    break;
-                case CALLBACK_TYPE_REPORTED_STATE:
-                    if (iotHubClientInstance->reported_state_callback)
-                    {
-                        iotHubClientInstance->reported_state_callback(queued_cb->iothub_callback.reported_state_cb_info.status_code, queued_cb->userContextCallback);
-                    }
-                    break;
-                case CALLBACK_TYPE_CONNECTION_STATUS:
-                    if (iotHubClientInstance->connection_status_callback)
-                    {
-                        iotHubClientInstance->connection_status_callback(queued_cb->iothub_callback.connection_status_cb_info.connection_status, queued_cb->iothub_callback.connection_status_cb_info.status_reason, queued_cb->userContextCallback);
-                    }
-                    break;
-                case CALLBACK_TYPE_DEVICE_METHOD:
-                    if (iotHubClientInstance->device_method_callback)
-                    {
-                        const char* method_name = STRING_c_str(queued_cb->iothub_callback.method_cb_info.method_name);
-                        const unsigned char* payload = BUFFER_u_char(queued_cb->iothub_callback.method_cb_info.payload);
-                        size_t payload_len = BUFFER_length(queued_cb->iothub_callback.method_cb_info.payload);
+            }
+            break;
+        case CALLBACK_TYPE_INBOUD_DEVICE_METHOD:
+            if (iotHubClientInstance->inbound_device_method_callback)
+            {
+                const char* method_name = STRING_c_str(queued_cb->iothub_callback.method_cb_info.method_name);
+                const unsigned char* payload = BUFFER_u_char(queued_cb->iothub_callback.method_cb_info.payload);
+                size_t payload_len = BUFFER_length(queued_cb->iothub_callback.method_cb_info.payload);
 
-                        unsigned char* payload_resp = NULL;
-                        size_t response_size = 0;
-                        int status = iotHubClientInstance->device_method_callback(method_name, payload, payload_len, &payload_resp, &response_size, queued_cb->userContextCallback);
+                iotHubClientInstance->inbound_device_method_callback(method_name, payload, payload_len, queued_cb->iothub_callback.method_cb_info.method_id, queued_cb->userContextCallback);
 
-                        if (payload_resp && (response_size > 0))
-                        {
-                            IOTHUB_CLIENT_HANDLE handle = iotHubClientInstance->method_user_context->iotHubClientHandle;
-                            IOTHUB_CLIENT_RESULT result = IoTHubClient_DeviceMethodResponse(handle, queued_cb->iothub_callback.method_cb_info.method_id, (const unsigned char*)payload_resp, response_size, status);
-                            if (result != IOTHUB_CLIENT_OK)
-                            {
-                                LogError("IoTHubClient_LL_DeviceMethodResponse failed");
-                            }
-                        }
+                BUFFER_delete(queued_cb->iothub_callback.method_cb_info.payload);
+                STRING_delete(queued_cb->iothub_callback.method_cb_info.method_name);
+            }
+            break;
+        case CALLBACK_TYPE_MESSAGE:
+            if (iotHubClientInstance->message_callback)
+            {
+                IOTHUBMESSAGE_DISPOSITION_RESULT disposition = iotHubClientInstance->message_callback(queued_cb->iothub_callback.message_cb_info->messageHandle, queued_cb->userContextCallback);
+                IOTHUB_CLIENT_HANDLE handle = iotHubClientInstance->message_user_context->iotHubClientHandle;
 
-                        BUFFER_delete(queued_cb->iothub_callback.method_cb_info.payload);
-                        STRING_delete(queued_cb->iothub_callback.method_cb_info.method_name);
-                        
-                        if (payload_resp)
-                        {
-                            free(payload_resp);
-                        }
-                    }
-                    break;
-                case CALLBACK_TYPE_INBOUD_DEVICE_METHOD:
-                    if (iotHubClientInstance->inbound_device_method_callback)
+                if (Lock(handle->LockHandle) == LOCK_OK)
+                {
+                    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendMessageDisposition(handle->IoTHubClientLLHandle, queued_cb->iothub_callback.message_cb_info, disposition);
+                    (void)Unlock(handle->LockHandle);
+                    if (result != IOTHUB_CLIENT_OK)
                     {
-                        const char* method_name = STRING_c_str(queued_cb->iothub_callback.method_cb_info.method_name);
-                        const unsigned char* payload = BUFFER_u_char(queued_cb->iothub_callback.method_cb_info.payload);
-                        size_t payload_len = BUFFER_length(queued_cb->iothub_callback.method_cb_info.payload);
+                        LogError("IoTHubClient_LL_SendMessageDisposition failed");
+                    }
+                }
+                else
+                {
+                    LogError("Lock failed");
+                }
+            }
+            break;
+        default:
+            LogError("Invalid callback type '%s'", ENUM_TO_STRING(USER_CALLBACK_TYPE, queued_cb->type));
+            break;
+    }
+}
 
-                        iotHubClientInstance->inbound_device_method_callback(method_name, payload, payload_len, queued_cb->iothub_callback.method_cb_info.method_id, queued_cb->userContextCallback);
+typedef struct POOLED_USER_CALLBACK_TAG
+{
+    IOTHUB_CLIENT_INSTANCE* iotHubClientInstance;
+    USER_CALLBACK_INFO callback_info;
+} POOLED_USER_CALLBACK;
 
-                        BUFFER_delete(queued_cb->iothub_callback.method_cb_info.payload);
-                        STRING_delete(queued_cb->iothub_callback.method_cb_info.method_name);
-                    }
-                    break;
-                case CALLBACK_TYPE_MESSAGE:
-                    if (iotHubClientInstance->message_callback)
-                    {
-                        IOTHUBMESSAGE_DISPOSITION_RESULT disposition = iotHubClientInstance->message_callback(queued_cb->iothub_callback.message_cb_info->messageHandle, queued_cb->userContextCallback);
-                        IOTHUB_CLIENT_HANDLE handle = iotHubClientInstance->message_user_context->iotHubClientHandle;
+/*this function runs on a thread of the callback pool*/
+static void run_pooled_user_callback(void* context)
+{
+    POOLED_USER_CALLBACK* pooled_cb = (POOLED_USER_CALLBACK*)context;
+    invoke_user_callback(pooled_cb->iotHubClientInstance, &pooled_cb->callback_info);
+    free(pooled_cb);
+}
 
-                        if (Lock(handle->LockHandle) == LOCK_OK)
-                        {
-                            IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendMessageDisposition(handle->IoTHubClientLLHandle, queued_cb->iothub_callback.message_cb_info, disposition);
-                            (void)Unlock(handle->LockHandle);
-                            if (result != IOTHUB_CLIENT_OK)
-                            {
-                                LogError("IoTHubClient_LL_SendMessageDisposition failed");
-                            }
-                        }
-                        else
-                        {
-                            LogError("Lock failed");
-                        }
-                    }
-                    break;
-                default:
-                    LogError("Invalid callback type '%s'", ENUM_TO_STRING(USER_CALLBACK_TYPE, queued_cb->type));
-                    break;
+static void dispatch_user_callbacks(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, CALLBACK_POOL_HANDLE callback_pool, VECTOR_HANDLE call_backs)
+{
+    size_t callbacks_length = VECTOR_size(call_backs);
+    size_t index;
+    for (index = 0; index < callbacks_length; index++)
+    {
+        USER_CALLBACK_INFO* queued_cb = (USER_CALLBACK_INFO*)VECTOR_element(call_backs, index);
+        if (queued_cb == NULL)
+        {
+            LogError("VECTOR_element at index %zd is NULL.", index);
+        }
+        else if (callback_pool == NULL)
+        {
+            invoke_user_callback(iotHubClientInstance, queued_cb);
+        }
+        else
+        {
+            POOLED_USER_CALLBACK* pooled_cb = (POOLED_USER_CALLBACK*)malloc(sizeof(POOLED_USER_CALLBACK));
+            if (pooled_cb == NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_09_031: [ If handing a user callback to the callback pool fails, the callback shall be invoked on the worker thread. ]*/
+                LogError("failed allocating pooled user callback, invoking it on the worker thread");
+                invoke_user_callback(iotHubClientInstance, queued_cb);
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_09_030: [ Device method callbacks shall be posted as unordered work, every other user callback as ordered work, so that confirmations, twin updates, connection status changes and messages reach the application in the order they happened. ]*/
+                bool ordered = (queued_cb->type != CALLBACK_TYPE_DEVICE_METHOD) && (queued_cb->type != CALLBACK_TYPE_INBOUD_DEVICE_METHOD);
+
+                pooled_cb->iotHubClientInstance = iotHubClientInstance;
+                pooled_cb->callback_info = *queued_cb;
+
+                /*Codes_SRS_IOTHUBCLIENT_09_029: [ If a callback pool was created, the worker thread shall hand each user callback to it by calling callback_pool_post instead of invoking the callback itself. ]*/
+                if (callback_pool_post(callback_pool, run_pooled_user_callback, pooled_cb, ordered) != 0)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_031: [ If handing a user callback to the callback pool fails, the callback shall be invoked on the worker thread. ]*/
+                    LogError("callback_pool_post failed, invoking the user callback on the worker thread");
+                    free(pooled_cb);
+                    invoke_user_callback(iotHubClientInstance, queued_cb);
+                }
             }
         }
     }
     VECTOR_destroy(call_backs);
 }
 
-static void ScheduleWork_Thread_ForMultiplexing(void* iotHubClientHandle)
+/*this function is called by the worker thread with LockHandle held, once the client or the shared transport has done its work*/
+static void refresh_statistics_snapshot(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance)
+{
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    /*Codes_SRS_IOTHUBCLIENT_09_034: [ After each DoWork the worker thread shall call IoTHubClient_LL_GetStatistics and copy its result into the statistics snapshot while holding the statistics lock. ]*/
+    if (IoTHubClient_LL_GetStatistics(iotHubClientInstance->IoTHubClientLLHandle, &statistics) != IOTHUB_CLIENT_OK)
+    {
+        LogError("IoTHubClient_LL_GetStatistics failed, keeping the previous statistics snapshot");
+    }
+    else if (Lock(iotHubClientInstance->StatisticsLock) != LOCK_OK)
+    {
+        LogError("failed locking the statistics snapshot");
+    }
+    else
+    {
+        iotHubClientInstance->StatisticsSnapshot = statistics;
+        iotHubClientInstance->HasStatisticsSnapshot = 1;
+        (void)Unlock(iotHubClientInstance->StatisticsLock);
+    }
+}
+
+/*this function is called by the worker thread with LockHandle held, it returns how long the client can wait (at most maxWaitTimeInMs) before its next DoWork*/
+static unsigned int get_wait_time_in_ms(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, unsigned int maxWaitTimeInMs)
+{
+    unsigned int result = maxWaitTimeInMs;
+    IOTHUB_CLIENT_STATUS sendStatus = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    uint64_t msUntilNextTimeout;
+
+    if ((IoTHubClient_LL_GetSendStatus(iotHubClientInstance->IoTHubClientLLHandle, &sendStatus) == IOTHUB_CLIENT_OK) &&
+        (sendStatus == IOTHUB_CLIENT_SEND_STATUS_BUSY))
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_038: [ While IoTHubClient_LL_GetSendStatus reports IOTHUB_CLIENT_SEND_STATUS_BUSY, the thread shall wait at most 1 ms before calling IoTHubClient_LL_DoWork again. ]*/
+        if (result > BUSY_DO_WORK_FREQUENCY_IN_MS)
+        {
+            result = BUSY_DO_WORK_FREQUENCY_IN_MS;
+        }
+    }
+    else if ((IoTHubClient_LL_GetNextMessageTimeout(iotHubClientInstance->IoTHubClientLLHandle, &msUntilNextTimeout) == IOTHUB_CLIENT_OK) &&
+        (msUntilNextTimeout < result))
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_039: [ Otherwise, if IoTHubClient_LL_GetNextMessageTimeout returns IOTHUB_CLIENT_OK, the thread shall not wait past the earliest message timeout it reports. ]*/
+        result = (unsigned int)msUntilNextTimeout;
+    }
+
+    return result;
+}
+
+static unsigned int ScheduleWork_Thread_ForMultiplexing(void* iotHubClientHandle)
 {
     IOTHUB_CLIENT_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_INSTANCE*)iotHubClientHandle;
+    /*the shared transport bounds this by its own DoWork frequency*/
+    unsigned int result = UINT_MAX;
 
 #ifndef DONT_USE_UPLOADTOBLOB
     garbageCollectorImpl(iotHubClientInstance);
@@ -540,6 +701,10 @@ static void ScheduleWork_Thread_ForMultiplexing(void* iotHubClientHandle)
     if (Lock(iotHubClientInstance->LockHandle) == LOCK_OK)
     {
         VECTOR_HANDLE call_backs = VECTOR_move(iotHubClientInstance->saved_user_callback_list);
+        CALLBACK_POOL_HANDLE callback_pool = iotHubClientInstance->CallbackPool;
+        refresh_statistics_snapshot(iotHubClientInstance);
+        /*Codes_SRS_IOTHUBCLIENT_09_040: [ If the transport connection is shared, the client shall return to the transport's worker thread how long it can wait before its next DoWork, computed as for an unshared connection. ]*/
+        result = get_wait_time_in_ms(iotHubClientInstance, UINT_MAX);
         (void)Unlock(iotHubClientInstance->LockHandle);
 
         if (call_backs == NULL)
@@ -548,13 +713,76 @@ static void ScheduleWork_Thread_ForMultiplexing(void* iotHubClientHandle)
         }
         else
         {
-            dispatch_user_callbacks(iotHubClientInstance, call_backs);
+            dispatch_user_callbacks(iotHubClientInstance, callback_pool, call_backs);
         }
     }
     else
     {
         LogError("failed locking for ScheduleWork_Thread_ForMultiplexing");
     }
+
+    return result;
+}
+
+/*this function is called with LockHandle held after work has been queued in the LL layer, or without it after an event has been queued in SendQueue*/
+static void wake_worker_thread(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance)
+{
+    if (iotHubClientInstance->TransportHandle != NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_002: [ If the transport connection is shared, the worker thread shall be woken up by calling IoTHubTransport_WakeWorkerThread. ]*/
+        IoTHubTransport_WakeWorkerThread(iotHubClientInstance->TransportHandle);
+    }
+    else if (iotHubClientInstance->WorkerCondition != NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_042: [ The worker thread shall be signaled while holding the worker lock, after setting the flag it checks under that lock before waiting. ]*/
+        if (Lock(iotHubClientInstance->WorkerLock) != LOCK_OK)
+        {
+            LogError("failed locking the worker lock, worker thread will pick up the work on its next period");
+        }
+        else
+        {
+            iotHubClientInstance->WorkPending = 1;
+            /*Codes_SRS_IOTHUBCLIENT_09_001: [ After work has been queued in the IoTHubClient_LL layer, the worker thread shall be woken up by calling Condition_Post. ]*/
+            if (Condition_Post(iotHubClientInstance->WorkerCondition) != COND_OK)
+            {
+                LogError("Condition_Post failed, worker thread will pick up the work on its next period");
+            }
+            (void)Unlock(iotHubClientInstance->WorkerLock);
+        }
+    }
+}
+
+static void wait_for_work(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance)
+{
+    unsigned int waitTimeInMs;
+
+    if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+    {
+        LogError("failed locking for wait_for_work");
+        waitTimeInMs = iotHubClientInstance->DoWorkFrequencyInMs;
+    }
+    else
+    {
+        waitTimeInMs = get_wait_time_in_ms(iotHubClientInstance, iotHubClientInstance->DoWorkFrequencyInMs);
+        (void)Unlock(iotHubClientInstance->LockHandle);
+    }
+
+    if (Lock(iotHubClientInstance->WorkerLock) != LOCK_OK)
+    {
+        LogError("failed locking the worker lock for wait_for_work");
+        ThreadAPI_Sleep(waitTimeInMs);
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_003: [ If no work was signaled since the last call to IoTHubClient_LL_DoWork, the thread shall wait on the worker condition for at most the DoWork frequency. ]*/
+        /*Codes_SRS_IOTHUBCLIENT_09_042: [ The worker thread shall be signaled while holding the worker lock, after setting the flag it checks under that lock before waiting. ]*/
+        /*a message timing out now is handled by the next DoWork without waiting (Condition_Wait treats 0 as forever)*/
+        if ((iotHubClientInstance->StopThread == 0) && (iotHubClientInstance->WorkPending == 0) && (waitTimeInMs > 0))
+        {
+            (void)Condition_Wait(iotHubClientInstance->WorkerCondition, iotHubClientInstance->WorkerLock, (int)waitTimeInMs);
+        }
+        (void)Unlock(iotHubClientInstance->WorkerLock);
+    }
 }
 
 static int ScheduleWork_Thread(void* threadArgument)
@@ -573,14 +801,22 @@ static int ScheduleWork_Thread(void* threadArgument)
             }
             else
             {
-                /* Codes_SRS_IOTHUBCLIENT_01_037: [The thread created by IoTHubClient_SendEvent or IoTHubClient_SetMessageCallback shall call IoTHubClient_LL_DoWork every 1 ms.] */
+                /*whatever was signaled so far is going to be picked up by this DoWork, a signal arriving after this is seen by wait_for_work*/
+                iotHubClientInstance->WorkPending = 0;
+
+                /*Codes_SRS_IOTHUBCLIENT_09_024: [ Before each call to IoTHubClient_LL_DoWork the thread shall drain the send queue by calling mpsc_queue_drain, handing each event's copy over to IoTHubClient_LL_SendEventAsync_TakeOwnership in the order they were queued. ]*/
+                (void)mpsc_queue_drain(iotHubClientInstance->SendQueue, send_queued_event, iotHubClientInstance);
+
+                /* Codes_SRS_IOTHUBCLIENT_01_037: [The thread created by IoTHubClient_SendEvent or IoTHubClient_SetMessageCallback shall call IoTHubClient_LL_DoWork at least once every DoWork frequency (100 ms by default).] */
                 /* Codes_SRS_IOTHUBCLIENT_01_039: [All calls to IoTHubClient_LL_DoWork shall be protected by the lock created in IotHubClient_Create.] */
                 IoTHubClient_LL_DoWork(iotHubClientInstance->IoTHubClientLLHandle);
+                refresh_statistics_snapshot(iotHubClientInstance);
 
 #ifndef DONT_USE_UPLOADTOBLOB
                 garbageCollectorImpl(iotHubClientInstance);
 #endif
                 VECTOR_HANDLE call_backs = VECTOR_move(iotHubClientInstance->saved_user_callback_list);
+                CALLBACK_POOL_HANDLE callback_pool = iotHubClientInstance->CallbackPool;
                 (void)Unlock(iotHubClientInstance->LockHandle);
                 if (call_backs == NULL)
                 {
@@ -588,7 +824,7 @@ static int ScheduleWork_Thread(void* threadArgument)
                 }
                 else
                 {
-                    dispatch_user_callbacks(iotHubClientInstance, call_backs);
+                    dispatch_user_callbacks(iotHubClientInstance, callback_pool, call_backs);
                 }
             }
         }
@@ -597,7 +833,7 @@ static int ScheduleWork_Thread(void* threadArgument)
             /*Codes_SRS_IOTHUBCLIENT_01_040: [If acquiring the lock fails, IoTHubClient_LL_DoWork shall not be called.]*/
             /*no code, shall retry*/
         }
-        (void)ThreadAPI_Sleep(1);
+        wait_for_work(iotHubClientInstance);
     }
 
     return 0;
@@ -610,16 +846,48 @@ static IOTHUB_CLIENT_RESULT StartWorkerThreadIfNeeded(IOTHUB_CLIENT_INSTANCE* io
     {
         if (iotHubClientInstance->ThreadHandle == NULL)
         {
-            iotHubClientInstance->StopThread = 0;
-            if (ThreadAPI_Create(&iotHubClientInstance->ThreadHandle, ScheduleWork_Thread, iotHubClientInstance) != THREADAPI_OK)
+            /*Codes_SRS_IOTHUBCLIENT_09_004: [ Before starting the worker thread the worker condition shall be created by calling Condition_Init. ]*/
+            if ((iotHubClientInstance->WorkerCondition == NULL) &&
+                ((iotHubClientInstance->WorkerCondition = Condition_Init()) == NULL))
             {
-                LogError("ThreadAPI_Create failed");
-                iotHubClientInstance->ThreadHandle = NULL;
+                LogError("Condition_Init failed");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            /*Codes_SRS_IOTHUBCLIENT_09_041: [ Before starting the worker thread the worker lock shall be created by calling Lock_Init. ]*/
+            else if ((iotHubClientInstance->WorkerLock == NULL) &&
+                ((iotHubClientInstance->WorkerLock = Lock_Init()) == NULL))
+            {
+                LogError("Lock_Init failed for the worker lock");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            /*Codes_SRS_IOTHUBCLIENT_09_018: [ Before starting the worker thread the send queue shall be created by calling mpsc_queue_create. ]*/
+            else if ((iotHubClientInstance->SendQueue == NULL) &&
+                ((iotHubClientInstance->SendQueue = mpsc_queue_create()) == NULL))
+            {
+                LogError("mpsc_queue_create failed");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            /*Codes_SRS_IOTHUBCLIENT_09_035: [ Before starting the worker thread the statistics lock shall be created by calling Lock_Init. ]*/
+            else if ((iotHubClientInstance->StatisticsLock == NULL) &&
+                ((iotHubClientInstance->StatisticsLock = Lock_Init()) == NULL))
+            {
+                LogError("Lock_Init failed for the statistics lock");
                 result = IOTHUB_CLIENT_ERROR;
             }
             else
             {
-                result = IOTHUB_CLIENT_OK;
+                iotHubClientInstance->StopThread = 0;
+                iotHubClientInstance->WorkPending = 0;
+                if (ThreadAPI_Create(&iotHubClientInstance->ThreadHandle, ScheduleWork_Thread, iotHubClientInstance) != THREADAPI_OK)
+                {
+                    LogError("ThreadAPI_Create failed");
+                    iotHubClientInstance->ThreadHandle = NULL;
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    result = IOTHUB_CLIENT_OK;
+                }
             }
         }
         else
@@ -631,7 +899,17 @@ static IOTHUB_CLIENT_RESULT StartWorkerThreadIfNeeded(IOTHUB_CLIENT_INSTANCE* io
     {
         /*Codes_SRS_IOTHUBCLIENT_17_012: [ If the transport connection is shared, the thread shall be started by calling IoTHubTransport_StartWorkerThread. ]*/
         /*Codes_SRS_IOTHUBCLIENT_17_011: [ If the transport connection is shared, the thread shall be started by calling IoTHubTransport_StartWorkerThread*/
-        result = IoTHubTransport_StartWorkerThread(iotHubClientInstance->TransportHandle, iotHubClientInstance, ScheduleWork_Thread_ForMultiplexing);
+        /*Codes_SRS_IOTHUBCLIENT_09_035: [ Before starting the worker thread the statistics lock shall be created by calling Lock_Init. ]*/
+        if ((iotHubClientInstance->StatisticsLock == NULL) &&
+            ((iotHubClientInstance->StatisticsLock = Lock_Init()) == NULL))
+        {
+            LogError("Lock_Init failed for the statistics lock");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            result = IoTHubTransport_StartWorkerThread(iotHubClientInstance->TransportHandle, iotHubClientInstance, ScheduleWork_Thread_ForMultiplexing);
+        }
     }
     return result;
 }
@@ -768,6 +1046,14 @@ static IOTHUB_CLIENT_INSTANCE* create_iothub_instance(const IOTHUB_CLIENT_CONFIG
                 else
                 {
                     result->ThreadHandle = NULL;
+                    result->WorkerCondition = NULL;
+                    result->WorkerLock = NULL;
+                    result->WorkPending = 0;
+                    result->DoWorkFrequencyInMs = DEFAULT_DO_WORK_FREQUENCY_IN_MS;
+                    result->SendQueue = NULL;
+                    result->CallbackPool = NULL;
+                    result->StatisticsLock = NULL;
+                    result->HasStatisticsSnapshot = 0;
                     result->desired_state_callback = NULL;
                     result->event_confirm_callback = NULL;
                     result->reported_state_callback = NULL;
@@ -855,6 +1141,12 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
             okToJoin = IoTHubTransport_SignalEndWorkerThread(iotHubClientInstance->TransportHandle, iotHubClientHandle);
         }
 
+        if (iotHubClientInstance->CallbackPool != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_032: [ Before taking the serializing lock, IoTHubClient_Destroy shall call callback_pool_shutdown so that the user callbacks already handed to the pool run while the client is still alive. ]*/
+            callback_pool_shutdown(iotHubClientInstance->CallbackPool);
+        }
+
         /*Codes_SRS_IOTHUBCLIENT_02_043: [ IoTHubClient_Destroy shall lock the serializing lock and signal the worker thread (if any) to end ]*/
         if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
         {
@@ -872,6 +1164,8 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
         if (iotHubClientInstance->ThreadHandle != NULL)
         {
             iotHubClientInstance->StopThread = 1;
+            /*Codes_SRS_IOTHUBCLIENT_09_005: [ IoTHubClient_Destroy shall signal the worker condition so that the worker thread ends without waiting out its period. ]*/
+            wake_worker_thread(iotHubClientInstance);
             okToJoin = true;
         }
         else
@@ -914,6 +1208,12 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
             }
         }
 
+        if (iotHubClientInstance->CallbackPool != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_033: [ After the worker thread is joined, IoTHubClient_Destroy shall destroy the callback pool by calling callback_pool_destroy. ]*/
+            callback_pool_destroy(iotHubClientInstance->CallbackPool);
+        }
+
         vector_size = VECTOR_size(iotHubClientInstance->saved_user_callback_list);
         size_t index = 0;
         for (index = 0; index < vector_size; index++)
@@ -942,8 +1242,29 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
                 }
             }
         }
+        if (iotHubClientInstance->SendQueue != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_026: [ After the worker thread is joined, IoTHubClient_Destroy shall invoke the eventConfirmationCallback of each event still in the send queue with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, destroy their copies and destroy the send queue. ]*/
+            (void)mpsc_queue_drain(iotHubClientInstance->SendQueue, destroy_queued_event, iotHubClientInstance);
+            mpsc_queue_destroy(iotHubClientInstance->SendQueue);
+        }
         VECTOR_destroy(iotHubClientInstance->saved_user_callback_list);
 
+        if (iotHubClientInstance->WorkerCondition != NULL)
+        {
+            Condition_Deinit(iotHubClientInstance->WorkerCondition);
+        }
+
+        if (iotHubClientInstance->WorkerLock != NULL)
+        {
+            Lock_Deinit(iotHubClientInstance->WorkerLock);
+        }
+
+        if (iotHubClientInstance->StatisticsLock != NULL)
+        {
+            Lock_Deinit(iotHubClientInstance->StatisticsLock);
+        }
+
         if (iotHubClientInstance->TransportHandle == NULL)
         {
             /* Codes_SRS_IOTHUBCLIENT_01_032: [If the lock was allocated in IoTHubClient_Create, it shall be also freed..] */
@@ -969,6 +1290,88 @@ void IoTHubClient_Destroy(IOTHUB_CLIENT_HANDLE iotHubClientHandle)
     }
 }
 
+/*this function is called without LockHandle, so that application threads do not wait for the network I/O done by ScheduleWork_Thread*/
+static IOTHUB_CLIENT_RESULT queue_send_event(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
+{
+    IOTHUB_CLIENT_RESULT result;
+    SEND_EVENT_REQUEST* request;
+
+    if (eventMessageHandle == NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_020: [ If eventMessageHandle is NULL, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        LogError("NULL eventMessageHandle");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((eventConfirmationCallback == NULL) && (userContextCallback != NULL))
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_043: [ If eventConfirmationCallback is NULL and userContextCallback is not NULL, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_INVALID_ARG without queuing the event. ]*/
+        LogError("NULL eventConfirmationCallback with a non-NULL userContextCallback");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((request = (SEND_EVENT_REQUEST*)malloc(sizeof(SEND_EVENT_REQUEST))) == NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_022: [ IoTHubClient_SendEventAsync shall queue the copy by calling mpsc_queue_push; if any of these steps fail it shall free what it allocated and return IOTHUB_CLIENT_ERROR. ]*/
+        LogError("Failed allocating SEND_EVENT_REQUEST");
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        request->queue_context = NULL;
+
+        /*Codes_SRS_IOTHUBCLIENT_09_021: [ IoTHubClient_SendEventAsync shall copy the event by calling IoTHubMessage_Clone and, if eventConfirmationCallback is not NULL, allocate a IOTHUB_QUEUE_CONTEXT for it. ]*/
+        if ((request->message = IoTHubMessage_Clone(eventMessageHandle)) == NULL)
+        {
+            LogError("IoTHubMessage_Clone failed");
+            free(request);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        /* Codes_SRS_IOTHUBCLIENT_07_001: [ IoTHubClient_SendEventAsync shall allocate a IOTHUB_QUEUE_CONTEXT object to be sent to the IoTHubClient_LL_SendEventAsync function as a user context. ] */
+        else if ((eventConfirmationCallback != NULL) &&
+            ((request->queue_context = (IOTHUB_QUEUE_CONTEXT*)malloc(sizeof(IOTHUB_QUEUE_CONTEXT))) == NULL))
+        {
+            LogError("Failed allocating QUEUE_CONTEXT");
+            IoTHubMessage_Destroy(request->message);
+            free(request);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            bool was_empty;
+
+            if (request->queue_context != NULL)
+            {
+                request->queue_context->iotHubClientHandle = iotHubClientInstance;
+                request->queue_context->userContextCallback = userContextCallback;
+            }
+
+            /*Codes_SRS_IOTHUBCLIENT_09_022: [ IoTHubClient_SendEventAsync shall queue the copy by calling mpsc_queue_push; if any of these steps fail it shall free what it allocated and return IOTHUB_CLIENT_ERROR. ]*/
+            if (mpsc_queue_push(iotHubClientInstance->SendQueue, request, &was_empty) != 0)
+            {
+                LogError("mpsc_queue_push failed");
+                if (request->queue_context != NULL)
+                {
+                    free(request->queue_context);
+                }
+                IoTHubMessage_Destroy(request->message);
+                free(request);
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                /*Codes_SRS_IOTHUBCLIENT_09_023: [ If the queue was empty before the push, the worker thread shall be woken up by calling Condition_Post. ]*/
+                /*otherwise the push that found it empty signals (under the worker lock, so the signal is not lost) and the event is drained along with that one*/
+                if (was_empty)
+                {
+                    wake_worker_thread(iotHubClientInstance);
+                }
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_SendEventAsync(IOTHUB_CLIENT_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -997,8 +1400,13 @@ IOTHUB_CLIENT_RESULT IoTHubClient_SendEventAsync(IOTHUB_CLIENT_HANDLE iotHubClie
                 iotHubClientInstance->event_confirm_callback = eventConfirmationCallback;
             }
 
+            if (iotHubClientInstance->TransportHandle == NULL)
+            {
+                /*Codes_SRS_IOTHUBCLIENT_09_019: [ If the transport connection is not shared, IoTHubClient_SendEventAsync shall queue the event for the worker thread without acquiring the lock. ]*/
+                result = queue_send_event(iotHubClientInstance, eventMessageHandle, eventConfirmationCallback, userContextCallback);
+            }
             /* Codes_SRS_IOTHUBCLIENT_01_025: [IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
-            if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+            else if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
             {
                 /* Codes_SRS_IOTHUBCLIENT_01_026: [If acquiring the lock fails, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_ERROR.] */
                 result = IOTHUB_CLIENT_ERROR;
@@ -1006,32 +1414,13 @@ IOTHUB_CLIENT_RESULT IoTHubClient_SendEventAsync(IOTHUB_CLIENT_HANDLE iotHubClie
             }
             else
             {
-                if (iotHubClientInstance->created_with_transport_handle != 0 || eventConfirmationCallback == NULL)
+                /* Codes_SRS_IOTHUBCLIENT_01_012: [IoTHubClient_SendEventAsync shall call IoTHubClient_LL_SendEventAsync, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameters eventMessageHandle, eventConfirmationCallback and userContextCallback.] */
+                /* Codes_SRS_IOTHUBCLIENT_01_013: [When IoTHubClient_LL_SendEventAsync is called, IoTHubClient_SendEventAsync shall return the result of IoTHubClient_LL_SendEventAsync.] */
+                result = IoTHubClient_LL_SendEventAsync(iotHubClientInstance->IoTHubClientLLHandle, eventMessageHandle, eventConfirmationCallback, userContextCallback);
+
+                if (result == IOTHUB_CLIENT_OK)
                 {
-                    result = IoTHubClient_LL_SendEventAsync(iotHubClientInstance->IoTHubClientLLHandle, eventMessageHandle, eventConfirmationCallback, userContextCallback);
-                }
-                else
-                {
-                    /* Codes_SRS_IOTHUBCLIENT_07_001: [ IoTHubClient_SendEventAsync shall allocate a IOTHUB_QUEUE_CONTEXT object to be sent to the IoTHubClient_LL_SendEventAsync function as a user context. ] */
-                    IOTHUB_QUEUE_CONTEXT* queue_context = (IOTHUB_QUEUE_CONTEXT*)malloc(sizeof(IOTHUB_QUEUE_CONTEXT));
-                    if (queue_context == NULL)
-                    {
-                        result = IOTHUB_CLIENT_ERROR;
-                        LogError("Failed allocating QUEUE_CONTEXT");
-                    }
-                    else
-                    {
-                        queue_context->iotHubClientHandle = iotHubClientInstance;
-                        queue_context->userContextCallback = userContextCallback;
-                        /* Codes_SRS_IOTHUBCLIENT_01_012: [IoTHubClient_SendEventAsync shall call IoTHubClient_LL_SendEventAsync, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameters eventMessageHandle, eventConfirmationCallback and userContextCallback.] */
-                        /* Codes_SRS_IOTHUBCLIENT_01_013: [When IoTHubClient_LL_SendEventAsync is called, IoTHubClient_SendEventAsync shall return the result of IoTHubClient_LL_SendEventAsync.] */
-                        result = IoTHubClient_LL_SendEventAsync(iotHubClientInstance->IoTHubClientLLHandle, eventMessageHandle, iothub_ll_event_confirm_callback, queue_context);
-                        if (result != IOTHUB_CLIENT_OK)
-                        {
-                            LogError("IoTHubClient_LL_SendEventAsync failed");
-                            free(queue_context);
-                        }
-                    }
+                    wake_worker_thread(iotHubClientInstance);
                 }
 
                 /* Codes_SRS_IOTHUBCLIENT_01_025: [IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
@@ -1078,6 +1467,62 @@ IOTHUB_CLIENT_RESULT IoTHubClient_GetSendStatus(IOTHUB_CLIENT_HANDLE iotHubClien
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_GetStatistics(IOTHUB_CLIENT_HANDLE iotHubClientHandle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (iotHubClientHandle == NULL)
+    {
+        /* Codes_SRS_IOTHUBCLIENT_09_010: [If iotHubClientHandle is NULL, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG.] */
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("NULL iothubClientHandle");
+    }
+    else if (statistics == NULL)
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_037: [ If statistics is NULL, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("NULL statistics");
+    }
+    else
+    {
+        IOTHUB_CLIENT_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_INSTANCE*)iotHubClientHandle;
+
+        if (iotHubClientInstance->HasStatisticsSnapshot != 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_036: [ Once the worker thread has taken a statistics snapshot, IoTHubClient_GetStatistics shall copy the snapshot into statistics while holding the statistics lock, without taking the lock created in IoTHubClient_Create, and return IOTHUB_CLIENT_OK. ]*/
+            if (Lock(iotHubClientInstance->StatisticsLock) != LOCK_OK)
+            {
+                /* Codes_SRS_IOTHUBCLIENT_09_012: [If acquiring the lock fails, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_ERROR.] */
+                result = IOTHUB_CLIENT_ERROR;
+                LogError("Could not acquire the statistics lock");
+            }
+            else
+            {
+                *statistics = iotHubClientInstance->StatisticsSnapshot;
+                (void)Unlock(iotHubClientInstance->StatisticsLock);
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /* Codes_SRS_IOTHUBCLIENT_09_011: [IoTHubClient_GetStatistics shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+        else if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+        {
+            /* Codes_SRS_IOTHUBCLIENT_09_012: [If acquiring the lock fails, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_ERROR.] */
+            result = IOTHUB_CLIENT_ERROR;
+            LogError("Could not acquire lock");
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUBCLIENT_09_013: [IoTHubClient_GetStatistics shall call IoTHubClient_LL_GetStatistics, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameter statistics, and return its result.] */
+            result = IoTHubClient_LL_GetStatistics(iotHubClientInstance->IoTHubClientLLHandle, statistics);
+
+            /* Codes_SRS_IOTHUBCLIENT_09_011: [IoTHubClient_GetStatistics shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+            (void)Unlock(iotHubClientInstance->LockHandle);
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_SetMessageCallback(IOTHUB_CLIENT_HANDLE iotHubClientHandle, IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC messageCallback, void* userContextCallback)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1377,8 +1822,14 @@ IOTHUB_CLIENT_RESULT IoTHubClient_SetOption(IOTHUB_CLIENT_HANDLE iotHubClientHan
     {
         IOTHUB_CLIENT_INSTANCE* iotHubClientInstance = (IOTHUB_CLIENT_INSTANCE*)iotHubClientHandle;
 
+        if ((iotHubClientInstance->TransportHandle != NULL) &&
+            (strcmp(optionName, OPTION_DO_WORK_FREQUENCY_IN_MS) == 0))
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_007: [ If the transport connection is shared, IoTHubClient_SetOption shall call IoTHubTransport_SetDoWorkFrequency, which takes the transport lock itself, without taking the lock created in IoTHubClient_Create, and return its result. ]*/
+            result = IoTHubTransport_SetDoWorkFrequency(iotHubClientInstance->TransportHandle, *(const unsigned int*)value);
+        }
         /* Codes_SRS_IOTHUBCLIENT_01_041: [ IoTHubClient_SetOption shall be made thread-safe by using the lock created in IoTHubClient_Create. ]*/
-        if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
+        else if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK)
         {
             /* Codes_SRS_IOTHUBCLIENT_01_042: [ If acquiring the lock fails, IoTHubClient_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
             result = IOTHUB_CLIENT_ERROR;
@@ -1386,11 +1837,55 @@ IOTHUB_CLIENT_RESULT IoTHubClient_SetOption(IOTHUB_CLIENT_HANDLE iotHubClientHan
         }
         else
         {
-            /*Codes_SRS_IOTHUBCLIENT_02_038: [If optionName doesn't match one of the options handled by this module then IoTHubClient_SetOption shall call IoTHubClient_LL_SetOption passing the same parameters and return what IoTHubClient_LL_SetOption returns.] */
-            result = IoTHubClient_LL_SetOption(iotHubClientInstance->IoTHubClientLLHandle, optionName, value);
-            if (result != IOTHUB_CLIENT_OK)
+            if (strcmp(optionName, OPTION_DO_WORK_FREQUENCY_IN_MS) == 0)
+            {
+                unsigned int doWorkFrequencyInMs = *(const unsigned int*)value;
+                if (doWorkFrequencyInMs == 0)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_006: [ If optionName is OPTION_DO_WORK_FREQUENCY_IN_MS and the value is 0, IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+                    result = IOTHUB_CLIENT_INVALID_ARG;
+                    LogError("invalid value for %s (0)", OPTION_DO_WORK_FREQUENCY_IN_MS);
+                }
+                else
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_008: [ Otherwise IoTHubClient_SetOption shall store the longest time the worker thread waits between two calls to IoTHubClient_LL_DoWork and return IOTHUB_CLIENT_OK. ]*/
+                    iotHubClientInstance->DoWorkFrequencyInMs = doWorkFrequencyInMs;
+                    result = IOTHUB_CLIENT_OK;
+                }
+            }
+            else if (strcmp(optionName, OPTION_CALLBACK_THREAD_COUNT) == 0)
+            {
+                size_t callbackThreadCount = *(const size_t*)value;
+                if (iotHubClientInstance->CallbackPool != NULL)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_027: [ If optionName is OPTION_CALLBACK_THREAD_COUNT and a callback pool was already created, IoTHubClient_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
+                    result = IOTHUB_CLIENT_ERROR;
+                    LogError("%s can only be set once", OPTION_CALLBACK_THREAD_COUNT);
+                }
+                else if (callbackThreadCount == 0)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_028: [ If optionName is OPTION_CALLBACK_THREAD_COUNT, IoTHubClient_SetOption shall create a callback pool with that many threads by calling callback_pool_create; if the value is 0 no pool is created and IoTHubClient_SetOption shall return IOTHUB_CLIENT_OK; if callback_pool_create fails it shall return IOTHUB_CLIENT_ERROR. ]*/
+                    result = IOTHUB_CLIENT_OK;
+                }
+                else if ((iotHubClientInstance->CallbackPool = callback_pool_create(callbackThreadCount)) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_09_028: [ If optionName is OPTION_CALLBACK_THREAD_COUNT, IoTHubClient_SetOption shall create a callback pool with that many threads by calling callback_pool_create; if the value is 0 no pool is created and IoTHubClient_SetOption shall return IOTHUB_CLIENT_OK; if callback_pool_create fails it shall return IOTHUB_CLIENT_ERROR. ]*/
+                    result = IOTHUB_CLIENT_ERROR;
+                    LogError("callback_pool_create failed");
+                }
+                else
+                {
+                    result = IOTHUB_CLIENT_OK;
+                }
+            }
+            else
             {
-                LogError("IoTHubClient_LL_SetOption failed");
+                /*Codes_SRS_IOTHUBCLIENT_02_038: [If optionName doesn't match one of the options handled by this module then IoTHubClient_SetOption shall call IoTHubClient_LL_SetOption passing the same parameters and return what IoTHubClient_LL_SetOption returns.] */
+                result = IoTHubClient_LL_SetOption(iotHubClientInstance->IoTHubClientLLHandle, optionName, value);
+                if (result != IOTHUB_CLIENT_OK)
+                {
+                    LogError("IoTHubClient_LL_SetOption failed");
+                }
             }
 
             (void)Unlock(iotHubClientInstance->LockHandle);
@@ -1544,6 +2039,11 @@ IOTHUB_CLIENT_RESULT IoTHubClient_SendReportedState(IOTHUB_CLIENT_HANDLE iotHubC
                     }
                 }
 
+                if (result == IOTHUB_CLIENT_OK)
+                {
+                    wake_worker_thread(iotHubClientInstance);
+                }
+
                 (void)Unlock(iotHubClientInstance->LockHandle);
             }
         }
@@ -1761,14 +2261,25 @@ static int uploadingThread(void *data)
         IOTHUB_CLIENT_FILE_UPLOAD_RESULT upload_result;
         /*it so happens that IoTHubClient_LL_UploadToBlob is thread-safe because there's no saved state in the handle and there are no globals, so no need to protect it*/
         /*not having it protected means multiple simultaneous uploads can happen*/
-        /*Codes_SRS_IOTHUBCLIENT_02_054: [ The thread shall call IoTHubClient_LL_UploadToBlob passing the information packed in the structure. ]*/
-        if (IoTHubClient_LL_UploadToBlob(savedData->iotHubClientHandle->IoTHubClientLLHandle, savedData->destinationFileName, savedData->source, savedData->size) == IOTHUB_CLIENT_OK)
+        IOTHUB_CLIENT_RESULT uploadResult;
+        if (savedData->getDataCallback != NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_016: [ The thread shall call IoTHubClient_LL_UploadMultipleBlocksToBlob passing the information packed in the structure. ]*/
+            uploadResult = IoTHubClient_LL_UploadMultipleBlocksToBlob(savedData->iotHubClientHandle->IoTHubClientLLHandle, savedData->destinationFileName, savedData->getDataCallback, savedData->context);
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBCLIENT_02_054: [ The thread shall call IoTHubClient_LL_UploadToBlob passing the information packed in the structure. ]*/
+            uploadResult = IoTHubClient_LL_UploadToBlob(savedData->iotHubClientHandle->IoTHubClientLLHandle, savedData->destinationFileName, savedData->source, savedData->size);
+        }
+
+        if (uploadResult == IOTHUB_CLIENT_OK)
         {
             upload_result = FILE_UPLOAD_OK;
         }
         else
         {
-            LogError("unable to IoTHubClient_LL_UploadToBlob");
+            LogError("unable to upload the file");
             upload_result = FILE_UPLOAD_ERROR;
         }
         (void)Unlock(savedData->iotHubClientHandle->LockHandle);
@@ -1804,6 +2315,81 @@ static int uploadingThread(void *data)
 #endif
 
 #ifndef DONT_USE_UPLOADTOBLOB
+/*starts the thread uploading savedData; savedData is freed if the thread cannot be started*/
+static IOTHUB_CLIENT_RESULT StartUploadingThread(IOTHUB_CLIENT_INSTANCE* iotHubClientInstance, UPLOADTOBLOB_SAVED_DATA* savedData)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if ((result = StartWorkerThreadIfNeeded(iotHubClientInstance)) != IOTHUB_CLIENT_OK)
+    {
+        free(savedData->source);
+        free(savedData->destinationFileName);
+        free(savedData);
+        result = IOTHUB_CLIENT_ERROR;
+        LogError("Could not start worker thread");
+    }
+    else
+    {
+        if (Lock(iotHubClientInstance->LockHandle) != LOCK_OK) /*locking because the next statement is changing blobThreadsToBeJoined*/
+        {
+            LogError("unable to lock");
+            free(savedData->source);
+            free(savedData->destinationFileName);
+            free(savedData);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBCLIENT_02_058: [ IoTHubClient_UploadToBlobAsync shall add the structure to the list of structures that need to be cleaned once file upload finishes. ]*/
+            LIST_ITEM_HANDLE item = singlylinkedlist_add(iotHubClientInstance->savedDataToBeCleaned, savedData);
+            if (item == NULL)
+            {
+                LogError("unable to singlylinkedlist_add");
+                free(savedData->source);
+                free(savedData->destinationFileName);
+                free(savedData);
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                savedData->iotHubClientHandle = (IOTHUB_CLIENT_HANDLE)iotHubClientInstance;
+                savedData->canBeGarbageCollected = 0;
+                if ((savedData->lockGarbage = Lock_Init()) == NULL)
+                {
+                    (void)singlylinkedlist_remove(iotHubClientInstance->savedDataToBeCleaned, item);
+                    free(savedData->source);
+                    free(savedData->destinationFileName);
+                    free(savedData);
+                    result = IOTHUB_CLIENT_ERROR;
+                    LogError("unable to Lock_Init");
+                }
+                else
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_02_052: [ IoTHubClient_UploadToBlobAsync shall spawn a thread passing the structure build in SRS IOTHUBCLIENT 02 051 as thread data.]*/
+                    if (ThreadAPI_Create(&savedData->uploadingThreadHandle, uploadingThread, savedData) != THREADAPI_OK)
+                    {
+                        /*Codes_SRS_IOTHUBCLIENT_02_053: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                        LogError("unablet to ThreadAPI_Create");
+                        (void)Lock_Deinit(savedData->lockGarbage);
+                        (void)singlylinkedlist_remove(iotHubClientInstance->savedDataToBeCleaned, item);
+                        free(savedData->source);
+                        free(savedData->destinationFileName);
+                        free(savedData);
+                        result = IOTHUB_CLIENT_ERROR;
+                    }
+                    else
+                    {
+                        result = IOTHUB_CLIENT_OK;
+                    }
+                }
+            }
+
+            (void)Unlock(iotHubClientInstance->LockHandle);
+        }
+    }
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_UploadToBlobAsync(IOTHUB_CLIENT_HANDLE iotHubClientHandle, const char* destinationFileName, const unsigned char* source, size_t size, IOTHUB_CLIENT_FILE_UPLOAD_CALLBACK iotHubClientFileUploadCallback, void* context)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1880,80 +2466,63 @@ IOTHUB_CLIENT_RESULT IoTHubClient_UploadToBlobAsync(IOTHUB_CLIENT_HANDLE iotHubC
                     IOTHUB_CLIENT_INSTANCE* iotHubClientHandleData = (IOTHUB_CLIENT_INSTANCE*)iotHubClientHandle;
 
                     savedData->iotHubClientFileUploadCallback = iotHubClientFileUploadCallback;
+                    savedData->getDataCallback = NULL;
                     savedData->context = context;
                     (void)memcpy(savedData->source, source, size);
 
-                    if ((result = StartWorkerThreadIfNeeded(iotHubClientHandleData)) != IOTHUB_CLIENT_OK)
-                    {
-                        free(savedData->source);
-                        free(savedData->destinationFileName);
-                        free(savedData);
-                        result = IOTHUB_CLIENT_ERROR;
-                        LogError("Could not start worker thread");
-                    }
-                    else
-                    {
-                        if (Lock(iotHubClientHandleData->LockHandle) != LOCK_OK) /*locking because the next statement is changing blobThreadsToBeJoined*/
-                        {
-                            LogError("unable to lock");
-                            free(savedData->source);
-                            free(savedData->destinationFileName);
-                            free(savedData);
-                            result = IOTHUB_CLIENT_ERROR;
-                        }
-                        else
-                        {
-                            /*Codes_SRS_IOTHUBCLIENT_02_058: [ IoTHubClient_UploadToBlobAsync shall add the structure to the list of structures that need to be cleaned once file upload finishes. ]*/
-                            LIST_ITEM_HANDLE item = singlylinkedlist_add(iotHubClientHandleData->savedDataToBeCleaned, savedData);
-                            if (item == NULL)
-                            {
-                                LogError("unable to singlylinkedlist_add");
-                                free(savedData->source);
-                                free(savedData->destinationFileName);
-                                free(savedData);
-                                result = IOTHUB_CLIENT_ERROR;
-                            }
-                            else
-                            {
-                                savedData->iotHubClientHandle = iotHubClientHandle;
-                                savedData->canBeGarbageCollected = 0;
-                                if ((savedData->lockGarbage = Lock_Init()) == NULL)
-                                {
-                                    (void)singlylinkedlist_remove(iotHubClientHandleData->savedDataToBeCleaned, item);
-                                    free(savedData->source);
-                                    free(savedData->destinationFileName);
-                                    free(savedData);
-                                    result = IOTHUB_CLIENT_ERROR;
-                                    LogError("unable to Lock_Init");
-                                }
-                                else
-                                {
-                                    /*Codes_SRS_IOTHUBCLIENT_02_052: [ IoTHubClient_UploadToBlobAsync shall spawn a thread passing the structure build in SRS IOTHUBCLIENT 02 051 as thread data.]*/
-                                    if (ThreadAPI_Create(&savedData->uploadingThreadHandle, uploadingThread, savedData) != THREADAPI_OK)
-                                    {
-                                        /*Codes_SRS_IOTHUBCLIENT_02_053: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-                                        LogError("unablet to ThreadAPI_Create");
-                                        (void)Lock_Deinit(savedData->lockGarbage);
-                                        (void)singlylinkedlist_remove(iotHubClientHandleData->savedDataToBeCleaned, item);
-                                        free(savedData->source);
-                                        free(savedData->destinationFileName);
-                                        free(savedData);
-                                        result = IOTHUB_CLIENT_ERROR;
-                                    }
-                                    else
-                                    {
-                                        result = IOTHUB_CLIENT_OK;
-                                    }
-                                }
-                            }
-
-                            (void)Unlock(iotHubClientHandleData->LockHandle);
-                        }
-                    }
+                    result = StartUploadingThread(iotHubClientHandleData, savedData);
                 }
             }
         }
     }
     return result;
 }
+
+IOTHUB_CLIENT_RESULT IoTHubClient_UploadMultipleBlocksToBlobAsync(IOTHUB_CLIENT_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_09_014: [ If iotHubClientHandle, destinationFileName or getDataCallback are NULL then IoTHubClient_UploadMultipleBlocksToBlobAsync shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (getDataCallback == NULL)
+        )
+    {
+        LogError("invalid parameters iotHubClientHandle = %p , destinationFileName = %p, getDataCallback = %p",
+            iotHubClientHandle,
+            destinationFileName,
+            getDataCallback
+        );
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_09_015: [ IoTHubClient_UploadMultipleBlocksToBlobAsync shall copy the destinationFileName, getDataCallback and context into a structure and spawn a thread passing the structure as thread data. ]*/
+        UPLOADTOBLOB_SAVED_DATA *savedData = (UPLOADTOBLOB_SAVED_DATA *)malloc(sizeof(UPLOADTOBLOB_SAVED_DATA));
+        if (savedData == NULL)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_017: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadMultipleBlocksToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("unable to malloc - oom");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else if (mallocAndStrcpy_s((char**)&savedData->destinationFileName, destinationFileName) != 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_09_017: [ If copying to the structure or spawning the thread fails, then IoTHubClient_UploadMultipleBlocksToBlobAsync shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("unable to mallocAndStrcpy_s");
+            free(savedData);
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            savedData->source = NULL;
+            savedData->size = 0;
+            savedData->iotHubClientFileUploadCallback = NULL;
+            savedData->getDataCallback = getDataCallback;
+            savedData->context = context;
+
+            result = StartUploadingThread((IOTHUB_CLIENT_INSTANCE*)iotHubClientHandle, savedData);
+        }
+    }
+    return result;
+}
 #endif /*DONT_USE_UPLOADTOBLOB*/
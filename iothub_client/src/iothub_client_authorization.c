@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/umock_c_prod.h"
@@ -15,6 +17,12 @@
 
 #define DEFAULT_SAS_TOKEN_EXPIRY_TIME_SECS          3600
 #define INDEFINITE_TIME                             ((time_t)(-1))
+/*a rendered SAS token is reused for at most a tenth of the lifetime asked for, and never more than 10 minutes*/
+#define SAS_TOKEN_REUSE_TIME_DIVIDER                10
+#define SAS_TOKEN_MAX_REUSE_TIME_SECS               600
+/*a refresh is brought forward by at most a tenth of the refresh time, and never more than 10 minutes*/
+#define SAS_TOKEN_REFRESH_JITTER_DIVIDER            10
+#define SAS_TOKEN_MAX_REFRESH_JITTER_SECS           600
 
 typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
 {
@@ -23,6 +31,10 @@ typedef struct IOTHUB_AUTHORIZATION_DATA_TAG
     char* device_id;
     size_t token_expiry_time_sec;
     IOTHUB_CREDENTIAL_TYPE cred_type;
+    STRING_HANDLE cached_sas_token;
+    char* cached_sas_token_scope;
+    size_t cached_sas_token_expiry; /*seconds since epoch*/
+    uint32_t refresh_jitter_state; /*0 until the first IoTHubClient_Auth_Get_SasToken_Refresh_Time*/
 } IOTHUB_AUTHORIZATION_DATA;
 
 static int get_seconds_since_epoch(size_t* seconds)
@@ -124,6 +136,11 @@ void IoTHubClient_Auth_Destroy(IOTHUB_AUTHORIZATION_HANDLE handle)
         free(handle->device_key);
         free(handle->device_id);
         free(handle->device_sas_token);
+        if (handle->cached_sas_token != NULL)
+        {
+            STRING_delete(handle->cached_sas_token);
+        }
+        free(handle->cached_sas_token_scope);
         free(handle);
     }
 }
@@ -177,65 +194,109 @@ IOTHUB_CREDENTIAL_TYPE IoTHubClient_Auth_Get_Credential_Type(IOTHUB_AUTHORIZATIO
     return result;
 }
 
-char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, size_t expire_time)
+static size_t get_sas_token_reuse_time(size_t expire_time)
 {
-    char* result;
-    /* Codes_SRS_IoTHub_Authorization_07_009: [ if handle or scope are NULL, IoTHubClient_Auth_Get_SasToken shall return NULL. ] */
+    size_t result = expire_time / SAS_TOKEN_REUSE_TIME_DIVIDER;
+    if (result > SAS_TOKEN_MAX_REUSE_TIME_SECS)
+    {
+        result = SAS_TOKEN_MAX_REUSE_TIME_SECS;
+    }
+    return result;
+}
+
+static uint32_t get_next_refresh_jitter(IOTHUB_AUTHORIZATION_DATA* handle)
+{
+    uint32_t state = handle->refresh_jitter_state;
+    if (state == 0)
+    {
+        /*the handle address tells apart the devices of a process, the time the processes started together from one image*/
+        state = (uint32_t)get_time(NULL) * 2654435761u ^ (uint32_t)(uintptr_t)handle;
+        if (state == 0)
+        {
+            state = 1;
+        }
+    }
+    /*xorshift32, rand() would be shared by every handle and unseeded in most processes*/
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    handle->refresh_jitter_state = state;
+    return state;
+}
+
+const char* IoTHubClient_Auth_Get_Cached_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, size_t expire_time)
+{
+    const char* result;
+    /* Codes_SRS_IoTHub_Authorization_09_001: [ if handle or scope are NULL, IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
     if (handle == NULL)
     {
         LogError("Invalid Parameter handle: %p", handle);
         result = NULL;
     }
+    /* Codes_SRS_IoTHub_Authorization_09_002: [ If the device_sas_token is NOT NULL IoTHubClient_Auth_Get_Cached_SasToken shall return the device_sas_token. ] */
+    else if (handle->device_sas_token != NULL)
+    {
+        result = handle->device_sas_token;
+    }
+    else if (scope == NULL)
+    {
+        LogError("Invalid Parameter scope: %p", scope);
+        result = NULL;
+    }
     else
     {
-        /* Codes_SRS_IoTHub_Authorization_07_021: [If the device_sas_token is NOT NULL IoTHubClient_Auth_Get_SasToken shall return a copy of the device_sas_token. ] */
-        if (handle->device_sas_token != NULL)
-        {
-            if (mallocAndStrcpy_s(&result, handle->device_sas_token) != 0)
-            {
-                LogError("failure allocating sas token", scope);
-                result = NULL;
-            }
-        }
-        /* Codes_SRS_IoTHub_Authorization_07_009: [ if handle or scope are NULL, IoTHubClient_Auth_Get_SasToken shall return NULL. ] */
-        else if (scope == NULL)
+        size_t sec_since_epoch;
+
+        if (get_seconds_since_epoch(&sec_since_epoch) != 0)
         {
-            LogError("Invalid Parameter scope: %p", scope);
+            /* Codes_SRS_IoTHub_Authorization_09_006: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+            LogError("failure getting seconds from epoch");
             result = NULL;
         }
         else
         {
-            const char* key_name = "";
-            STRING_HANDLE sas_token;
-            size_t sec_since_epoch;
+            size_t expiry_time = sec_since_epoch + expire_time;
 
-            /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_ConnString shall construct the expiration time using the expire_time. ] */
-            if (get_seconds_since_epoch(&sec_since_epoch) != 0)
+            /* Codes_SRS_IoTHub_Authorization_09_003: [ If the cached sas token was created for the same scope and expires no sooner than the current time plus expire_time minus a tenth of expire_time (at most 10 minutes), IoTHubClient_Auth_Get_Cached_SasToken shall return it without creating a new one. ] */
+            if (handle->cached_sas_token != NULL &&
+                handle->cached_sas_token_expiry + get_sas_token_reuse_time(expire_time) >= expiry_time &&
+                strcmp(handle->cached_sas_token_scope, scope) == 0)
             {
-                /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                LogError("failure getting seconds from epoch");
-                result = NULL;
+                result = STRING_c_str(handle->cached_sas_token);
             }
-            else 
+            else
             {
-                /* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_CreateString to construct the sas token. ] */
-                size_t expiry_time = sec_since_epoch+expire_time;
-                if ( (sas_token = SASToken_CreateString(handle->device_key, scope, key_name, expiry_time)) == NULL)
+                const char* key_name = "";
+                STRING_HANDLE sas_token;
+                char* sas_token_scope;
+
+                /* Codes_SRS_IoTHub_Authorization_09_004: [ Otherwise IoTHubClient_Auth_Get_Cached_SasToken shall call SASToken_CreateString with an expiry of the current time plus expire_time, and cache the sas token with its scope and expiry. ] */
+                if ((sas_token = SASToken_CreateString(handle->device_key, scope, key_name, expiry_time)) == NULL)
                 {
-                    /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+                    /* Codes_SRS_IoTHub_Authorization_09_006: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
                     LogError("Failed creating sas_token");
                     result = NULL;
                 }
+                else if (mallocAndStrcpy_s(&sas_token_scope, scope) != 0)
+                {
+                    /* Codes_SRS_IoTHub_Authorization_09_006: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+                    LogError("Failed copying scope");
+                    STRING_delete(sas_token);
+                    result = NULL;
+                }
                 else
                 {
-                    /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
-                    if (mallocAndStrcpy_s(&result, STRING_c_str(sas_token) ) != 0)
+                    if (handle->cached_sas_token != NULL)
                     {
-                        /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
-                        LogError("Failed copying result");
-                        result = NULL;
+                        STRING_delete(handle->cached_sas_token);
                     }
-                    STRING_delete(sas_token);
+                    free(handle->cached_sas_token_scope);
+                    handle->cached_sas_token = sas_token;
+                    handle->cached_sas_token_scope = sas_token_scope;
+                    handle->cached_sas_token_expiry = expiry_time;
+
+                    /* Codes_SRS_IoTHub_Authorization_09_005: [ The sas token returned by IoTHubClient_Auth_Get_Cached_SasToken shall be owned by handle and stay valid until the next call to IoTHubClient_Auth_Get_Cached_SasToken or IoTHubClient_Auth_Destroy. ] */
+                    result = STRING_c_str(sas_token);
                 }
             }
         }
@@ -243,6 +304,54 @@ char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const c
     return result;
 }
 
+size_t IoTHubClient_Auth_Get_SasToken_Refresh_Time(IOTHUB_AUTHORIZATION_HANDLE handle, size_t refresh_time)
+{
+    size_t result;
+    if (handle == NULL)
+    {
+        /* Codes_SRS_IoTHub_Authorization_09_008: [ if handle is NULL, IoTHubClient_Auth_Get_SasToken_Refresh_Time shall return refresh_time. ] */
+        LogError("Invalid Parameter handle: %p", handle);
+        result = refresh_time;
+    }
+    else
+    {
+        size_t max_jitter = refresh_time / SAS_TOKEN_REFRESH_JITTER_DIVIDER;
+        if (max_jitter > SAS_TOKEN_MAX_REFRESH_JITTER_SECS)
+        {
+            max_jitter = SAS_TOKEN_MAX_REFRESH_JITTER_SECS;
+        }
+        /* Codes_SRS_IoTHub_Authorization_09_009: [ IoTHubClient_Auth_Get_SasToken_Refresh_Time shall return refresh_time minus a random part of a tenth of refresh_time (at most 10 minutes). ] */
+        /* Codes_SRS_IoTHub_Authorization_09_010: [ The random part shall come from a generator of the handle, seeded on the first call from get_time and the handle. ] */
+        result = refresh_time - (size_t)(get_next_refresh_jitter(handle) % (max_jitter + 1));
+    }
+    return result;
+}
+
+char* IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, size_t expire_time)
+{
+    char* result;
+    /* Codes_SRS_IoTHub_Authorization_07_009: [ if handle or scope are NULL, IoTHubClient_Auth_Get_SasToken shall return NULL. ] */
+    /* Codes_SRS_IoTHub_Authorization_07_021: [If the device_sas_token is NOT NULL IoTHubClient_Auth_Get_SasToken shall return a copy of the device_sas_token. ] */
+    /* Codes_SRS_IoTHub_Authorization_07_010: [ IoTHubClient_Auth_Get_ConnString shall construct the expiration time using the expire_time. ] */
+    /* Codes_SRS_IoTHub_Authorization_07_011: [ IoTHubClient_Auth_Get_ConnString shall call SASToken_CreateString to construct the sas token. ] */
+    /* Codes_SRS_IoTHub_Authorization_09_007: [ IoTHubClient_Auth_Get_SasToken shall get the sas token by calling IoTHubClient_Auth_Get_Cached_SasToken. ] */
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, scope, expire_time);
+    if (sas_token == NULL)
+    {
+        /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+        LogError("Failed getting the sas token");
+        result = NULL;
+    }
+    /* Codes_SRS_IoTHub_Authorization_07_012: [ On success IoTHubClient_Auth_Get_ConnString shall allocate and return the sas token in a char*. ] */
+    else if (mallocAndStrcpy_s(&result, sas_token) != 0)
+    {
+        /* Codes_SRS_IoTHub_Authorization_07_020: [ If any error is encountered IoTHubClient_Auth_Get_ConnString shall return NULL. ] */
+        LogError("Failed copying result");
+        result = NULL;
+    }
+    return result;
+}
+
 const char* IoTHubClient_Auth_Get_DeviceId(IOTHUB_AUTHORIZATION_HANDLE handle)
 {
     const char* result;
@@ -0,0 +1,369 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+#include "iothub_client_callback_pool.h"
+
+// Idle threads wake up this often even if nobody signals them, so a lost signal can only delay work, never strand it.
+#define CALLBACK_POOL_IDLE_WAIT_MS 1000
+
+typedef struct CALLBACK_POOL_ITEM_TAG
+{
+    CALLBACK_POOL_WORK work;
+    void* context;
+    struct CALLBACK_POOL_ITEM_TAG* next;
+} CALLBACK_POOL_ITEM;
+
+typedef struct CALLBACK_POOL_LIST_TAG
+{
+    CALLBACK_POOL_ITEM* head;
+    CALLBACK_POOL_ITEM* tail;
+} CALLBACK_POOL_LIST;
+
+typedef struct CALLBACK_POOL_INSTANCE_TAG
+{
+    LOCK_HANDLE lock;
+    COND_HANDLE condition;
+    THREAD_HANDLE* threads;
+    size_t thread_count;                    // Number of threads started (and to be joined).
+    CALLBACK_POOL_LIST ordered;             // Run one at a time, in the order they were posted.
+    CALLBACK_POOL_LIST unordered;           // Run by any free thread.
+    bool ordered_running;                   // A thread is running the head of the ordered work.
+    bool stopping;                          // No more work is accepted; threads exit once there is none left.
+    bool joined;
+} CALLBACK_POOL_INSTANCE;
+
+
+// ========== Helper Functions ========== //
+
+static void append_item(CALLBACK_POOL_LIST* list, CALLBACK_POOL_ITEM* item)
+{
+    item->next = NULL;
+
+    if (list->tail == NULL)
+    {
+        list->head = item;
+    }
+    else
+    {
+        list->tail->next = item;
+    }
+
+    list->tail = item;
+}
+
+static CALLBACK_POOL_ITEM* take_item(CALLBACK_POOL_LIST* list)
+{
+    CALLBACK_POOL_ITEM* result = list->head;
+
+    if (result != NULL)
+    {
+        list->head = result->next;
+
+        if (list->head == NULL)
+        {
+            list->tail = NULL;
+        }
+    }
+
+    return result;
+}
+
+static void free_items(CALLBACK_POOL_LIST* list)
+{
+    CALLBACK_POOL_ITEM* item;
+
+    while ((item = take_item(list)) != NULL)
+    {
+        free(item);
+    }
+}
+
+static int callback_pool_thread(void* argument)
+{
+    CALLBACK_POOL_INSTANCE* pool = (CALLBACK_POOL_INSTANCE*)argument;
+    bool locked;
+
+    if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the callback pool, thread is exiting");
+        locked = false;
+    }
+    else
+    {
+        locked = true;
+    }
+
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_008: [Each thread shall run posted work until the pool is shut down and no work is left]
+    while (locked)
+    {
+        CALLBACK_POOL_ITEM* item;
+        bool ordered;
+
+        // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_009: [Ordered work shall run one item at a time, in the order it was posted; unordered work shall run on any free thread]
+        if (!pool->ordered_running && (item = take_item(&pool->ordered)) != NULL)
+        {
+            ordered = true;
+            pool->ordered_running = true;
+        }
+        else if ((item = take_item(&pool->unordered)) != NULL)
+        {
+            ordered = false;
+        }
+        else if (pool->stopping)
+        {
+            break;
+        }
+        else
+        {
+            (void)Condition_Wait(pool->condition, pool->lock, CALLBACK_POOL_IDLE_WAIT_MS);
+            continue;
+        }
+
+        (void)Unlock(pool->lock);
+
+        item->work(item->context);
+        free(item);
+
+        if (Lock(pool->lock) != LOCK_OK)
+        {
+            LogError("Failed locking the callback pool, thread is exiting");
+            locked = false;
+        }
+        else if (ordered)
+        {
+            pool->ordered_running = false;
+        }
+    }
+
+    if (locked)
+    {
+        (void)Unlock(pool->lock);
+    }
+
+    return 0;
+}
+
+static void stop_threads(CALLBACK_POOL_INSTANCE* pool)
+{
+    size_t i;
+
+    if (Lock(pool->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the callback pool, stopping its threads anyway");
+        pool->stopping = true;
+    }
+    else
+    {
+        pool->stopping = true;
+        (void)Unlock(pool->lock);
+    }
+
+    // One signal per thread, each wakes up at most one idle thread.
+    for (i = 0; i < pool->thread_count; i++)
+    {
+        (void)Condition_Post(pool->condition);
+    }
+
+    for (i = 0; i < pool->thread_count; i++)
+    {
+        int res;
+
+        if (ThreadAPI_Join(pool->threads[i], &res) != THREADAPI_OK)
+        {
+            LogError("ThreadAPI_Join failed for callback pool thread %lu", (unsigned long)i);
+        }
+    }
+
+    pool->joined = true;
+}
+
+static void free_pool(CALLBACK_POOL_INSTANCE* pool)
+{
+    free_items(&pool->ordered);
+    free_items(&pool->unordered);
+
+    if (pool->threads != NULL)
+    {
+        free(pool->threads);
+    }
+
+    if (pool->condition != NULL)
+    {
+        Condition_Deinit(pool->condition);
+    }
+
+    if (pool->lock != NULL)
+    {
+        (void)Lock_Deinit(pool->lock);
+    }
+
+    free(pool);
+}
+
+
+// ========== Public API ========== //
+
+CALLBACK_POOL_HANDLE callback_pool_create(size_t thread_count)
+{
+    CALLBACK_POOL_INSTANCE* result;
+
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_001: [If `thread_count` is 0, `callback_pool_create` shall return NULL]
+    if (thread_count == 0)
+    {
+        LogError("Invalid argument (thread_count=0)");
+        result = NULL;
+    }
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_002: [`callback_pool_create` shall allocate the pool, create its lock and condition and start `thread_count` threads]
+    else if ((result = (CALLBACK_POOL_INSTANCE*)malloc(sizeof(CALLBACK_POOL_INSTANCE))) == NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+        LogError("Failed creating the callback pool (malloc failed)");
+    }
+    else
+    {
+        result->threads = NULL;
+        result->thread_count = 0;
+        result->ordered.head = result->ordered.tail = NULL;
+        result->unordered.head = result->unordered.tail = NULL;
+        result->ordered_running = false;
+        result->stopping = false;
+        result->joined = false;
+        result->condition = NULL;
+
+        if ((result->lock = Lock_Init()) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+            LogError("Failed creating the callback pool (Lock_Init failed)");
+            free_pool(result);
+            result = NULL;
+        }
+        else if ((result->condition = Condition_Init()) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+            LogError("Failed creating the callback pool (Condition_Init failed)");
+            free_pool(result);
+            result = NULL;
+        }
+        else if ((result->threads = (THREAD_HANDLE*)malloc(thread_count * sizeof(THREAD_HANDLE))) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+            LogError("Failed creating the callback pool (malloc failed for %lu threads)", (unsigned long)thread_count);
+            free_pool(result);
+            result = NULL;
+        }
+        else
+        {
+            while (result->thread_count < thread_count)
+            {
+                if (ThreadAPI_Create(&result->threads[result->thread_count], callback_pool_thread, result) != THREADAPI_OK)
+                {
+                    break;
+                }
+
+                result->thread_count++;
+            }
+
+            if (result->thread_count < thread_count)
+            {
+                // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+                LogError("Failed creating the callback pool (ThreadAPI_Create failed for thread %lu)", (unsigned long)result->thread_count);
+                stop_threads(result);
+                free_pool(result);
+                result = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+int callback_pool_post(CALLBACK_POOL_HANDLE pool, CALLBACK_POOL_WORK work, void* context, bool ordered)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_004: [If `pool` or `work` are NULL, `callback_pool_post` shall fail and return non-zero]
+    if (pool == NULL || work == NULL)
+    {
+        LogError("Invalid argument (pool=%p, work=%p)", pool, work);
+        result = __FAILURE__;
+    }
+    else
+    {
+        CALLBACK_POOL_ITEM* item;
+
+        // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_005: [`callback_pool_post` shall allocate an item holding `work` and `context`; if that fails it shall return non-zero]
+        if ((item = (CALLBACK_POOL_ITEM*)malloc(sizeof(CALLBACK_POOL_ITEM))) == NULL)
+        {
+            LogError("Failed posting work to the callback pool (malloc failed)");
+            result = __FAILURE__;
+        }
+        else if (Lock(pool->lock) != LOCK_OK)
+        {
+            LogError("Failed posting work to the callback pool (Lock failed)");
+            free(item);
+            result = __FAILURE__;
+        }
+        else
+        {
+            if (pool->stopping)
+            {
+                // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_006: [If the pool is being shut down, `callback_pool_post` shall free the item and return non-zero]
+                LogError("Failed posting work to the callback pool (pool is shut down)");
+                free(item);
+                result = __FAILURE__;
+            }
+            else
+            {
+                item->work = work;
+                item->context = context;
+
+                // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_007: [`callback_pool_post` shall queue the item as ordered or unordered work according to `ordered`, signal the pool condition and return 0]
+                append_item(ordered ? &pool->ordered : &pool->unordered, item);
+                (void)Condition_Post(pool->condition);
+                result = 0;
+            }
+
+            (void)Unlock(pool->lock);
+        }
+    }
+
+    return result;
+}
+
+void callback_pool_shutdown(CALLBACK_POOL_HANDLE pool)
+{
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_010: [If `pool` is NULL, `callback_pool_shutdown` shall return]
+    if (pool == NULL)
+    {
+        LogError("Invalid argument (pool=NULL)");
+    }
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_011: [`callback_pool_shutdown` shall stop accepting work, let the threads run all the work already posted and join them; once the pool is shut down it shall do nothing]
+    else if (!pool->joined)
+    {
+        stop_threads(pool);
+    }
+}
+
+void callback_pool_destroy(CALLBACK_POOL_HANDLE pool)
+{
+    // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_012: [If `pool` is NULL, `callback_pool_destroy` shall return]
+    if (pool != NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_013: [`callback_pool_destroy` shall shut the pool down if that was not done yet, then free its threads, condition, lock and the pool itself]
+        if (!pool->joined)
+        {
+            stop_threads(pool);
+        }
+
+        free_pool(pool);
+    }
+}
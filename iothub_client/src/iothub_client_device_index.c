@@ -0,0 +1,357 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "iothub_client_device_index.h"
+
+#define RESULT_OK                           0
+#define DEVICE_INDEX_INITIAL_BUCKET_COUNT   16
+
+// Each entry is chained twice: once in the bucket of its device id and once in the bucket of its device handle.
+typedef struct DEVICE_INDEX_ENTRY_TAG
+{
+    char* device_id;
+    size_t device_id_hash;
+    void* device;
+    struct DEVICE_INDEX_ENTRY_TAG* next_by_id;
+    struct DEVICE_INDEX_ENTRY_TAG* next_by_device;
+} DEVICE_INDEX_ENTRY;
+
+typedef struct DEVICE_INDEX_INSTANCE_TAG
+{
+    DEVICE_INDEX_ENTRY** buckets_by_id;
+    DEVICE_INDEX_ENTRY** buckets_by_device;
+    size_t bucket_count;                        // Always a power of 2, so the bucket of a hash is (hash & (bucket_count - 1)).
+    size_t entry_count;
+} DEVICE_INDEX_INSTANCE;
+
+
+// ========== Helper Functions ========== //
+
+// FNV-1a.
+static size_t hash_device_id(const char* device_id)
+{
+    size_t result = (size_t)2166136261u;
+
+    while (*device_id != '\0')
+    {
+        result ^= (unsigned char)*device_id++;
+        result *= (size_t)16777619u;
+    }
+
+    return result;
+}
+
+static size_t hash_device(void* device)
+{
+    size_t result = (size_t)((uintptr_t)device >> 3);
+
+    result ^= (result >> 16);
+    result *= (size_t)0x45d9f3bu;
+    result ^= (result >> 16);
+
+    return result;
+}
+
+static DEVICE_INDEX_ENTRY** create_buckets(size_t bucket_count)
+{
+    DEVICE_INDEX_ENTRY** result;
+
+    if ((result = (DEVICE_INDEX_ENTRY**)malloc(bucket_count * sizeof(DEVICE_INDEX_ENTRY*))) != NULL)
+    {
+        memset(result, 0, bucket_count * sizeof(DEVICE_INDEX_ENTRY*));
+    }
+
+    return result;
+}
+
+static void link_entry(DEVICE_INDEX_INSTANCE* device_index, DEVICE_INDEX_ENTRY* entry)
+{
+    size_t id_bucket = entry->device_id_hash & (device_index->bucket_count - 1);
+    size_t device_bucket = hash_device(entry->device) & (device_index->bucket_count - 1);
+
+    entry->next_by_id = device_index->buckets_by_id[id_bucket];
+    device_index->buckets_by_id[id_bucket] = entry;
+
+    entry->next_by_device = device_index->buckets_by_device[device_bucket];
+    device_index->buckets_by_device[device_bucket] = entry;
+}
+
+static int grow_buckets(DEVICE_INDEX_INSTANCE* device_index)
+{
+    int result;
+    size_t new_bucket_count = device_index->bucket_count * 2;
+    DEVICE_INDEX_ENTRY** new_buckets_by_id;
+    DEVICE_INDEX_ENTRY** new_buckets_by_device;
+
+    if ((new_buckets_by_id = create_buckets(new_bucket_count)) == NULL)
+    {
+        LogError("Failed growing the device index (malloc failed)");
+        result = __FAILURE__;
+    }
+    else if ((new_buckets_by_device = create_buckets(new_bucket_count)) == NULL)
+    {
+        LogError("Failed growing the device index (malloc failed)");
+        free(new_buckets_by_id);
+        result = __FAILURE__;
+    }
+    else
+    {
+        DEVICE_INDEX_ENTRY** old_buckets_by_id = device_index->buckets_by_id;
+        DEVICE_INDEX_ENTRY** old_buckets_by_device = device_index->buckets_by_device;
+        size_t old_bucket_count = device_index->bucket_count;
+        size_t i;
+
+        device_index->buckets_by_id = new_buckets_by_id;
+        device_index->buckets_by_device = new_buckets_by_device;
+        device_index->bucket_count = new_bucket_count;
+
+        // Every entry is in exactly one of the old id buckets, so walking them re-links each entry once.
+        for (i = 0; i < old_bucket_count; i++)
+        {
+            DEVICE_INDEX_ENTRY* entry = old_buckets_by_id[i];
+
+            while (entry != NULL)
+            {
+                DEVICE_INDEX_ENTRY* next_entry = entry->next_by_id;
+                link_entry(device_index, entry);
+                entry = next_entry;
+            }
+        }
+
+        free(old_buckets_by_id);
+        free(old_buckets_by_device);
+        result = RESULT_OK;
+    }
+
+    return result;
+}
+
+
+// ========== Public API ========== //
+
+DEVICE_INDEX_HANDLE device_index_create(void)
+{
+    DEVICE_INDEX_INSTANCE* result;
+
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_001: [`device_index_create` shall allocate memory for the index and its buckets]
+    if ((result = (DEVICE_INDEX_INSTANCE*)malloc(sizeof(DEVICE_INDEX_INSTANCE))) == NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_002: [If any allocation fails, `device_index_create` shall free what it allocated and return NULL]
+        LogError("Failed creating the device index (malloc failed)");
+    }
+    else
+    {
+        result->bucket_count = DEVICE_INDEX_INITIAL_BUCKET_COUNT;
+        result->entry_count = 0;
+        result->buckets_by_device = NULL;
+
+        if ((result->buckets_by_id = create_buckets(result->bucket_count)) == NULL ||
+            (result->buckets_by_device = create_buckets(result->bucket_count)) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_002: [If any allocation fails, `device_index_create` shall free what it allocated and return NULL]
+            LogError("Failed creating the device index buckets (malloc failed)");
+            free(result->buckets_by_id);
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+int device_index_add(DEVICE_INDEX_HANDLE device_index, const char* device_id, void* device)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_003: [If `device_index`, `device_id` or `device` are NULL, `device_index_add` shall fail and return non-zero]
+    if (device_index == NULL || device_id == NULL || device == NULL)
+    {
+        LogError("Invalid argument (device_index=%p, device_id=%p, device=%p)", device_index, device_id, device);
+        result = __FAILURE__;
+    }
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_004: [If `device_id` or `device` are already in the index, `device_index_add` shall fail and return non-zero]
+    else if (device_index_find_by_id(device_index, device_id) != NULL || device_index_contains(device_index, device))
+    {
+        LogError("Failed adding device '%s' to the index (device already indexed)", device_id);
+        result = __FAILURE__;
+    }
+    else
+    {
+        DEVICE_INDEX_ENTRY* entry;
+        size_t device_id_length = strlen(device_id);
+
+        // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_005: [`device_index_add` shall allocate an entry holding `device` and a copy of `device_id`]
+        if ((entry = (DEVICE_INDEX_ENTRY*)malloc(sizeof(DEVICE_INDEX_ENTRY))) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_006: [If any allocation fails, `device_index_add` shall fail and return non-zero]
+            LogError("Failed adding device '%s' to the index (malloc failed)", device_id);
+            result = __FAILURE__;
+        }
+        else if ((entry->device_id = (char*)malloc(device_id_length + 1)) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_006: [If any allocation fails, `device_index_add` shall fail and return non-zero]
+            LogError("Failed adding device '%s' to the index (failed copying the device id)", device_id);
+            free(entry);
+            result = __FAILURE__;
+        }
+        else
+        {
+            (void)memcpy(entry->device_id, device_id, device_id_length + 1);
+            entry->device_id_hash = hash_device_id(device_id);
+            entry->device = device;
+
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_007: [If the index would become more than 3/4 full, its buckets shall be doubled before the entry is added]
+            if ((device_index->entry_count + 1) > (device_index->bucket_count / 4) * 3 &&
+                grow_buckets(device_index) != RESULT_OK)
+            {
+                // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_008: [If growing the buckets fails, the entry shall still be added to the current buckets]
+                LogInfo("Device index kept at %lu buckets; lookups of device '%s' may be slower", (unsigned long)device_index->bucket_count, device_id);
+            }
+
+            link_entry(device_index, entry);
+            device_index->entry_count++;
+
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_009: [If no failures occur, `device_index_add` shall return 0]
+            result = RESULT_OK;
+        }
+    }
+
+    return result;
+}
+
+int device_index_remove(DEVICE_INDEX_HANDLE device_index, void* device)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_010: [If `device_index` or `device` are NULL, `device_index_remove` shall fail and return non-zero]
+    if (device_index == NULL || device == NULL)
+    {
+        LogError("Invalid argument (device_index=%p, device=%p)", device_index, device);
+        result = __FAILURE__;
+    }
+    else
+    {
+        DEVICE_INDEX_ENTRY** link = &device_index->buckets_by_device[hash_device(device) & (device_index->bucket_count - 1)];
+
+        while (*link != NULL && (*link)->device != device)
+        {
+            link = &(*link)->next_by_device;
+        }
+
+        if (*link == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_011: [If `device` is not in the index, `device_index_remove` shall fail and return non-zero]
+            LogError("Failed removing device from the index (device not indexed)");
+            result = __FAILURE__;
+        }
+        else
+        {
+            DEVICE_INDEX_ENTRY* entry = *link;
+
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_012: [`device_index_remove` shall unlink the entry of `device` from the index and free it]
+            *link = entry->next_by_device;
+
+            link = &device_index->buckets_by_id[entry->device_id_hash & (device_index->bucket_count - 1)];
+            while (*link != entry)
+            {
+                link = &(*link)->next_by_id;
+            }
+            *link = entry->next_by_id;
+
+            free(entry->device_id);
+            free(entry);
+            device_index->entry_count--;
+
+            // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_013: [If no failures occur, `device_index_remove` shall return 0]
+            result = RESULT_OK;
+        }
+    }
+
+    return result;
+}
+
+void* device_index_find_by_id(DEVICE_INDEX_HANDLE device_index, const char* device_id)
+{
+    void* result;
+
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_014: [If `device_index` or `device_id` are NULL, `device_index_find_by_id` shall return NULL]
+    if (device_index == NULL || device_id == NULL)
+    {
+        LogError("Invalid argument (device_index=%p, device_id=%p)", device_index, device_id);
+        result = NULL;
+    }
+    else
+    {
+        size_t device_id_hash = hash_device_id(device_id);
+        DEVICE_INDEX_ENTRY* entry = device_index->buckets_by_id[device_id_hash & (device_index->bucket_count - 1)];
+
+        while (entry != NULL && (entry->device_id_hash != device_id_hash || strcmp(entry->device_id, device_id) != 0))
+        {
+            entry = entry->next_by_id;
+        }
+
+        // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_015: [`device_index_find_by_id` shall return the device added with `device_id`, or NULL if there is none]
+        result = (entry == NULL ? NULL : entry->device);
+    }
+
+    return result;
+}
+
+bool device_index_contains(DEVICE_INDEX_HANDLE device_index, void* device)
+{
+    bool result;
+
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_016: [If `device_index` or `device` are NULL, `device_index_contains` shall return false]
+    if (device_index == NULL || device == NULL)
+    {
+        result = false;
+    }
+    else
+    {
+        DEVICE_INDEX_ENTRY* entry = device_index->buckets_by_device[hash_device(device) & (device_index->bucket_count - 1)];
+
+        while (entry != NULL && entry->device != device)
+        {
+            entry = entry->next_by_device;
+        }
+
+        // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_017: [`device_index_contains` shall return true if `device` is in the index, false otherwise]
+        result = (entry != NULL);
+    }
+
+    return result;
+}
+
+void device_index_destroy(DEVICE_INDEX_HANDLE device_index)
+{
+    // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_018: [If `device_index` is NULL, `device_index_destroy` shall return]
+    if (device_index != NULL)
+    {
+        size_t i;
+
+        // Codes_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_019: [`device_index_destroy` shall free all the entries, the buckets and the index itself; the indexed devices are not touched]
+        for (i = 0; i < device_index->bucket_count; i++)
+        {
+            DEVICE_INDEX_ENTRY* entry = device_index->buckets_by_id[i];
+
+            while (entry != NULL)
+            {
+                DEVICE_INDEX_ENTRY* next_entry = entry->next_by_id;
+                free(entry->device_id);
+                free(entry);
+                entry = next_entry;
+            }
+        }
+
+        free(device_index->buckets_by_id);
+        free(device_index->buckets_by_device);
+        free(device_index);
+    }
+}
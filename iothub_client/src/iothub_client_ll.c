@@ -26,6 +26,9 @@
 
 #define LOG_ERROR_RESULT LogError("result = %s", ENUM_TO_STRING(IOTHUB_CLIENT_RESULT, result));
 #define INDEFINITE_TIME ((time_t)(-1))
+#define TIMEOUT_HEAP_INITIAL_CAPACITY 8
+#define TIMEOUT_HEAP_EXPIRED ((size_t)(-1))
+#define ENQUEUE_TIME_UNKNOWN ((tickcounter_ms_t)(-1))
 
 DEFINE_ENUM_STRINGS(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_RESULT_VALUES);
 DEFINE_ENUM_STRINGS(IOTHUB_CLIENT_CONFIRMATION_RESULT, IOTHUB_CLIENT_CONFIRMATION_RESULT_VALUES);
@@ -70,6 +73,13 @@ typedef struct IOTHUB_CLIENT_LL_HANDLE_DATA_TAG
     time_t lastMessageReceiveTime;
     TICK_COUNTER_HANDLE tickCounter; /*shared tickcounter used to track message timeouts in waitingToSend list*/
     tickcounter_ms_t currentMessageTimeout;
+    IOTHUB_MESSAGE_LIST** timeoutHeap; /*min-heap on ms_timesOutAfter of the messages that have a timeout*/
+    size_t timeoutHeapCount;
+    size_t timeoutHeapCapacity;
+    IOTHUB_MESSAGE_LIST* messagePool; /*released IOTHUB_MESSAGE_LIST kept for reuse, chained through entry.Flink*/
+    size_t messagePoolCount;
+    size_t messagePoolSize;
+    IOTHUB_CLIENT_STATISTICS statistics; /*the counters kept by IOTHUBCLIENT_LL, the transport ones are filled in by IoTHubClient_LL_GetStatistics*/
     uint64_t current_device_twin_timeout;
     IOTHUB_CLIENT_DEVICE_TWIN_CALLBACK deviceTwinCallback;
     void* deviceTwinContextCallback;
@@ -91,6 +101,7 @@ static const char X509_TOKEN_ONLY_ACCEPTABLE_VALUE[] = "true";
 static const char DEVICEKEY_TOKEN[] = "SharedAccessKey";
 static const char DEVICESAS_TOKEN[] = "SharedAccessSignature";
 static const char PROTOCOL_GATEWAY_HOST[] = "GatewayHostName";
+static const tickcounter_ms_t STATISTICS_BUCKET_BOUNDS_MS[IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT - 1] = IOTHUB_CLIENT_STATISTICS_BUCKET_BOUNDS_MS;
 
 static void setTransportProtocol(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, TRANSPORT_PROVIDER* protocol)
 {
@@ -106,6 +117,7 @@ static void setTransportProtocol(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, TRANS
     handleData->IoTHubTransport_DoWork = protocol->IoTHubTransport_DoWork;
     handleData->IoTHubTransport_SetRetryPolicy = protocol->IoTHubTransport_SetRetryPolicy;
     handleData->IoTHubTransport_GetSendStatus = protocol->IoTHubTransport_GetSendStatus;
+    handleData->IoTHubTransport_GetStatistics = protocol->IoTHubTransport_GetStatistics;
     handleData->IoTHubTransport_ProcessItem = protocol->IoTHubTransport_ProcessItem;
     handleData->IoTHubTransport_Subscribe_DeviceTwin = protocol->IoTHubTransport_Subscribe_DeviceTwin;
     handleData->IoTHubTransport_Unsubscribe_DeviceTwin = protocol->IoTHubTransport_Unsubscribe_DeviceTwin;
@@ -773,6 +785,46 @@ IOTHUB_CLIENT_LL_HANDLE IoTHubClient_LL_CreateWithTransport(const IOTHUB_CLIENT_
     return result;
 }
 
+static IOTHUB_MESSAGE_LIST* allocate_message_list(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+{
+    IOTHUB_MESSAGE_LIST* result = handleData->messagePool;
+    if (result != NULL)
+    {
+        handleData->messagePool = (IOTHUB_MESSAGE_LIST*)result->entry.Flink;
+        handleData->messagePoolCount--;
+    }
+    else
+    {
+        result = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST));
+    }
+    return result;
+}
+
+static void release_message_list(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST* messageList)
+{
+    if (handleData->messagePoolCount < handleData->messagePoolSize)
+    {
+        messageList->entry.Flink = (PDLIST_ENTRY)handleData->messagePool;
+        handleData->messagePool = messageList;
+        handleData->messagePoolCount++;
+    }
+    else
+    {
+        free(messageList);
+    }
+}
+
+static void trim_message_pool(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+{
+    while (handleData->messagePoolCount > handleData->messagePoolSize)
+    {
+        IOTHUB_MESSAGE_LIST* pooled = handleData->messagePool;
+        handleData->messagePool = (IOTHUB_MESSAGE_LIST*)pooled->entry.Flink;
+        handleData->messagePoolCount--;
+        free(pooled);
+    }
+}
+
 void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 {
     /*Codes_SRS_IOTHUBCLIENT_LL_02_009: [IoTHubClient_LL_Destroy shall do nothing if parameter iotHubClientHandle is NULL.]*/
@@ -799,6 +851,8 @@ void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
             IoTHubMessage_Destroy(temp->messageHandle);
             free(temp);
         }
+        handleData->messagePoolSize = 0;
+        trim_message_pool(handleData);
 
         /* Codes_SRS_IOTHUBCLIENT_LL_07_007: [ IoTHubClient_LL_Destroy shall iterate the device twin queues and destroy any remaining items. ] */
         while ((unsend = DList_RemoveHeadList(&(handleData->iot_msg_queue))) != &(handleData->iot_msg_queue))
@@ -813,6 +867,10 @@ void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
         }
 
         /*Codes_SRS_IOTHUBCLIENT_LL_17_011: [IoTHubClient_LL_Destroy  shall free the resources allocated by IoTHubClient (if any).] */
+        if (handleData->timeoutHeap != NULL)
+        {
+            free(handleData->timeoutHeap);
+        }
         IoTHubClient_Auth_Destroy(handleData->authorization_module);
         tickcounter_destroy(handleData->tickCounter);
 #ifndef DONT_USE_UPLOADTOBLOB
@@ -823,35 +881,138 @@ void IoTHubClient_LL_Destroy(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
     }
 }
 
+static void timeout_heap_swap(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, size_t i, size_t j)
+{
+    IOTHUB_MESSAGE_LIST* temp = handleData->timeoutHeap[i];
+    handleData->timeoutHeap[i] = handleData->timeoutHeap[j];
+    handleData->timeoutHeap[j] = temp;
+    handleData->timeoutHeap[i]->timeoutHeapIndex = i;
+    handleData->timeoutHeap[j]->timeoutHeapIndex = j;
+}
+
+static void timeout_heap_sift_up(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, size_t index)
+{
+    while (index > 0)
+    {
+        size_t parent = (index - 1) / 2;
+        if (handleData->timeoutHeap[parent]->ms_timesOutAfter <= handleData->timeoutHeap[index]->ms_timesOutAfter)
+        {
+            break;
+        }
+        timeout_heap_swap(handleData, parent, index);
+        index = parent;
+    }
+}
+
+static void timeout_heap_sift_down(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, size_t index)
+{
+    for (;;)
+    {
+        size_t left = (2 * index) + 1;
+        size_t right = left + 1;
+        size_t smallest = index;
+        if ((left < handleData->timeoutHeapCount) && (handleData->timeoutHeap[left]->ms_timesOutAfter < handleData->timeoutHeap[smallest]->ms_timesOutAfter))
+        {
+            smallest = left;
+        }
+        if ((right < handleData->timeoutHeapCount) && (handleData->timeoutHeap[right]->ms_timesOutAfter < handleData->timeoutHeap[smallest]->ms_timesOutAfter))
+        {
+            smallest = right;
+        }
+        if (smallest == index)
+        {
+            break;
+        }
+        timeout_heap_swap(handleData, index, smallest);
+        index = smallest;
+    }
+}
+
+/*returns 0 on success, any other value is error*/
+static int timeout_heap_insert(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST* newEntry)
+{
+    int result;
+    if (handleData->timeoutHeapCount == handleData->timeoutHeapCapacity)
+    {
+        size_t newCapacity = (handleData->timeoutHeapCapacity == 0) ? TIMEOUT_HEAP_INITIAL_CAPACITY : (2 * handleData->timeoutHeapCapacity);
+        IOTHUB_MESSAGE_LIST** newHeap = (IOTHUB_MESSAGE_LIST**)realloc(handleData->timeoutHeap, newCapacity * sizeof(IOTHUB_MESSAGE_LIST*));
+        if (newHeap == NULL)
+        {
+            LogError("unable to grow the message timeout heap");
+            result = __FAILURE__;
+        }
+        else
+        {
+            handleData->timeoutHeap = newHeap;
+            handleData->timeoutHeapCapacity = newCapacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        newEntry->timeoutHeapIndex = handleData->timeoutHeapCount;
+        handleData->timeoutHeap[handleData->timeoutHeapCount] = newEntry;
+        handleData->timeoutHeapCount++;
+        timeout_heap_sift_up(handleData, newEntry->timeoutHeapIndex);
+    }
+    return result;
+}
+
+static void timeout_heap_remove(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST* entry)
+{
+    size_t index = entry->timeoutHeapIndex;
+    size_t last = handleData->timeoutHeapCount - 1;
+    if (index != last)
+    {
+        timeout_heap_swap(handleData, index, last);
+    }
+    handleData->timeoutHeapCount--;
+    if (index != last)
+    {
+        /*the element moved into the hole can be out of order in either direction*/
+        timeout_heap_sift_down(handleData, index);
+        timeout_heap_sift_up(handleData, index);
+    }
+}
+
 /*Codes_SRS_IOTHUBCLIENT_LL_02_044: [ Messages already delivered to IoTHubClient_LL shall not have their timeouts modified by a new call to IoTHubClient_LL_SetOption. ]*/
 /*returns 0 on success, any other value is error*/
 static int attach_ms_timesOutAfter(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, IOTHUB_MESSAGE_LIST *newEntry)
 {
     int result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_022: [ IoTHubClient_LL_SendEventAsync shall stamp the message with the current tick count, which IoTHubClient_LL_SendComplete uses to measure the acknowledgement latency. ]*/
+    if (tickcounter_get_current_ms(handleData->tickCounter, &newEntry->ms_enqueued) != 0)
+    {
+        newEntry->ms_enqueued = ENQUEUE_TIME_UNKNOWN;
+    }
+
     /*Codes_SRS_IOTHUBCLIENT_LL_02_043: [ Calling IoTHubClient_LL_SetOption with value set to "0" shall disable the timeout mechanism for all new messages. ]*/
     if (handleData->currentMessageTimeout == 0)
     {
         newEntry->ms_timesOutAfter = 0; /*do not timeout*/
         result = 0;
     }
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_039: [ "messageTimeout" - once IoTHubClient_LL_SendEventAsync is called the message shall timeout after value miliseconds. Value is a pointer to a uint64. ]*/
+    else if (newEntry->ms_enqueued == ENQUEUE_TIME_UNKNOWN)
+    {
+        result = __FAILURE__;
+        LogError("unable to get the current relative tickcount");
+    }
     else
     {
-        /*Codes_SRS_IOTHUBCLIENT_LL_02_039: [ "messageTimeout" - once IoTHubClient_LL_SendEventAsync is called the message shall timeout after value miliseconds. Value is a pointer to a uint64. ]*/
-        if (tickcounter_get_current_ms(handleData->tickCounter, &newEntry->ms_timesOutAfter) != 0)
-        {
-            result = __FAILURE__;
-            LogError("unable to get the current relative tickcount");
-        }
-        else
-        {
-            newEntry->ms_timesOutAfter += handleData->currentMessageTimeout;
-            result = 0;
-        }
+        newEntry->ms_timesOutAfter = newEntry->ms_enqueued + handleData->currentMessageTimeout;
+        result = 0;
     }
     return result;
 }
 
-IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
+/*when takeOwnership is true the record holds eventMessageHandle itself, which then belongs to the LL layer only if this succeeds*/
+static IOTHUB_CLIENT_RESULT send_event_async(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback, bool takeOwnership)
 {
     IOTHUB_CLIENT_RESULT result;
     /*Codes_SRS_IOTHUBCLIENT_LL_02_011: [IoTHubClient_LL_SendEventAsync shall fail and return IOTHUB_CLIENT_INVALID_ARG if parameter iotHubClientHandle or eventMessageHandle is NULL.]*/
@@ -867,7 +1028,9 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
     }
     else
     {
-        IOTHUB_MESSAGE_LIST *newEntry = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST));
+        IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_018: [ IoTHubClient_LL_SendEventAsync shall reuse a released record from the message pool when one is available. ]*/
+        IOTHUB_MESSAGE_LIST *newEntry = allocate_message_list(handleData);
         if (newEntry == NULL)
         {
             result = IOTHUB_CLIENT_ERROR;
@@ -875,22 +1038,34 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
         }
         else
         {
-            IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
-
             if (attach_ms_timesOutAfter(handleData, newEntry) != 0)
             {
                 result = IOTHUB_CLIENT_ERROR;
                 LOG_ERROR_RESULT;
-                free(newEntry);
+                release_message_list(handleData, newEntry);
             }
             else
             {
                 /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
-                if ((newEntry->messageHandle = IoTHubMessage_Clone(eventMessageHandle)) == NULL)
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_048: [ IoTHubClient_LL_SendEventAsync_TakeOwnership shall behave as IoTHubClient_LL_SendEventAsync, except that the new record shall hold eventMessageHandle itself instead of a clone. ]*/
+                if ((newEntry->messageHandle = (takeOwnership ? eventMessageHandle : IoTHubMessage_Clone(eventMessageHandle))) == NULL)
                 {
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_014: [If cloning and/or adding the information fails for any reason, IoTHubClient_LL_SendEventAsync shall fail and return IOTHUB_CLIENT_ERROR.] */
                     result = IOTHUB_CLIENT_ERROR;
-                    free(newEntry);
+                    release_message_list(handleData, newEntry);
+                    LOG_ERROR_RESULT;
+                }
+                /*Codes_SRS_IOTHUBCLIENT_LL_09_010: [ If the message has a timeout, IoTHubClient_LL_SendEventAsync shall index it by its timeout in a min-heap. ]*/
+                else if ((newEntry->ms_timesOutAfter != 0) && (timeout_heap_insert(handleData, newEntry) != 0))
+                {
+                    /*Codes_SRS_IOTHUBCLIENT_LL_02_014: [If cloning and/or adding the information fails for any reason, IoTHubClient_LL_SendEventAsync shall fail and return IOTHUB_CLIENT_ERROR.] */
+                    result = IOTHUB_CLIENT_ERROR;
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_049: [ If IoTHubClient_LL_SendEventAsync_TakeOwnership fails, eventMessageHandle shall still belong to the caller. ]*/
+                    if (!takeOwnership)
+                    {
+                        IoTHubMessage_Destroy(newEntry->messageHandle);
+                    }
+                    release_message_list(handleData, newEntry);
                     LOG_ERROR_RESULT;
                 }
                 else
@@ -898,7 +1073,10 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_013: [IoTHubClient_LL_SendEventAsync shall add the DLIST waitingToSend a new record cloning the information from eventMessageHandle, eventConfirmationCallback, userContextCallback.]*/
                     newEntry->callback = eventConfirmationCallback;
                     newEntry->context = userContextCallback;
+                    /*Codes_SRS_IOTHUBCLIENT_LL_09_055: [ IoTHubClient_LL_SendEventAsync shall mark the new record as linked in waitingToSend (inWaitingToSend). A transport that takes a record off waitingToSend shall clear inWaitingToSend. ]*/
+                    newEntry->inWaitingToSend = true;
                     DList_InsertTailList(&(iotHubClientHandle->waitingToSend), &(newEntry->entry));
+                    handleData->statistics.messagesQueued++;
                     /*Codes_SRS_IOTHUBCLIENT_LL_02_015: [Otherwise IoTHubClient_LL_SendEventAsync shall succeed and return IOTHUB_CLIENT_OK.] */
                     result = IOTHUB_CLIENT_OK;
                 }
@@ -908,6 +1086,16 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotH
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
+{
+    return send_event_async(iotHubClientHandle, eventMessageHandle, eventConfirmationCallback, userContextCallback, false);
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendEventAsync_TakeOwnership(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_MESSAGE_HANDLE eventMessageHandle, IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK eventConfirmationCallback, void* userContextCallback)
+{
+    return send_event_async(iotHubClientHandle, eventMessageHandle, eventConfirmationCallback, userContextCallback, true);
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetMessageCallback(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC messageCallback, void* userContextCallback)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1068,36 +1256,64 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SendMessageDisposition(IOTHUB_CLIENT_LL_HAN
     return result;
 }
 
-static void DoTimeouts(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData)
+static void record_duration(uint64_t* histogram, tickcounter_ms_t durationMs)
+{
+    size_t bucket = 0;
+    while ((bucket < IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT - 1) && (durationMs > STATISTICS_BUCKET_BOUNDS_MS[bucket]))
+    {
+        bucket++;
+    }
+    histogram[bucket]++;
+}
+
+/*returns the upper bound of the bucket holding the given percentile of the DoWork durations*/
+static uint64_t get_do_work_duration_percentile(const IOTHUB_CLIENT_STATISTICS* statistics, uint64_t percentile)
 {
-    tickcounter_ms_t nowTick;
-    if (tickcounter_get_current_ms(handleData->tickCounter, &nowTick) != 0)
+    uint64_t result;
+    if (statistics->doWorkCount == 0)
     {
-        LogError("unable to get the current ms, timeouts will not be processed");
+        result = 0;
     }
     else
     {
-        DLIST_ENTRY* currentItemInWaitingToSend = handleData->waitingToSend.Flink;
-        while (currentItemInWaitingToSend != &(handleData->waitingToSend)) /*while we are not at the end of the list*/
+        uint64_t rank = (statistics->doWorkCount * percentile + 99) / 100;
+        uint64_t counted = statistics->doWorkDurationHistogram[0];
+        size_t bucket = 0;
+        while (counted < rank)
+        {
+            bucket++;
+            counted += statistics->doWorkDurationHistogram[bucket];
+        }
+
+        result = ((bucket < IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT - 1) && (STATISTICS_BUCKET_BOUNDS_MS[bucket] < statistics->doWorkDurationMaxMs)) ?
+            STATISTICS_BUCKET_BOUNDS_MS[bucket] :
+            statistics->doWorkDurationMaxMs;
+    }
+    return result;
+}
+
+static void DoTimeouts(IOTHUB_CLIENT_LL_HANDLE_DATA* handleData, tickcounter_ms_t nowTick)
+{
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_011: [ DoTimeouts shall pop from the timeout heap every message whose timeout has passed and mark it as expired. ]*/
+    while ((handleData->timeoutHeapCount > 0) && (handleData->timeoutHeap[0]->ms_timesOutAfter < nowTick))
+    {
+        IOTHUB_MESSAGE_LIST* expired = handleData->timeoutHeap[0];
+        timeout_heap_remove(handleData, expired);
+        expired->timeoutHeapIndex = TIMEOUT_HEAP_EXPIRED;
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_012: [ IoTHubClient_LL_DoWork shall unlink every expired message that is still linked in waitingToSend directly, without walking waitingToSend. Expired messages that the transport already took off waitingToSend are completed by the transport. ]*/
+        if (expired->inWaitingToSend)
         {
-            IOTHUB_MESSAGE_LIST* fullEntry = containingRecord(currentItemInWaitingToSend, IOTHUB_MESSAGE_LIST, entry);
+            DList_RemoveEntryList(&(expired->entry));
+            expired->inWaitingToSend = false;
             /*Codes_SRS_IOTHUBCLIENT_LL_02_041: [ If more than value miliseconds have passed since the call to IoTHubClient_LL_SendEventAsync then the message callback shall be called with a status code of IOTHUB_CLIENT_CONFIRMATION_TIMEOUT. ]*/
-            if ((fullEntry->ms_timesOutAfter != 0) && (fullEntry->ms_timesOutAfter < nowTick))
+            if (expired->callback != NULL)
             {
-                PDLIST_ENTRY theNext = currentItemInWaitingToSend->Flink; /*need to save the next item, because the below operations are destructive*/
-                DList_RemoveEntryList(currentItemInWaitingToSend);
-                if (fullEntry->callback != NULL)
-                {
-                    fullEntry->callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, fullEntry->context);
-                }
-                IoTHubMessage_Destroy(fullEntry->messageHandle); /*because it has been cloned*/
-                free(fullEntry);
-                currentItemInWaitingToSend = theNext;
-            }
-            else
-            {
-                currentItemInWaitingToSend = currentItemInWaitingToSend->Flink;
+                expired->callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, expired->context);
             }
+            IoTHubMessage_Destroy(expired->messageHandle); /*because it has been cloned*/
+            release_message_list(handleData, expired);
+            handleData->statistics.messagesTimedOut++;
         }
     }
 }
@@ -1108,7 +1324,16 @@ void IoTHubClient_LL_DoWork(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
     if (iotHubClientHandle != NULL)
     {
         IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
-        DoTimeouts(handleData);
+        tickcounter_ms_t startTick = 0;
+        bool hasStartTick = (tickcounter_get_current_ms(handleData->tickCounter, &startTick) == 0);
+        if (!hasStartTick)
+        {
+            LogError("unable to get the current ms, timeouts will not be processed");
+        }
+        else
+        {
+            DoTimeouts(handleData, startTick);
+        }
 
         /*Codes_SRS_IOTHUBCLIENT_LL_07_008: [ IoTHubClient_LL_DoWork shall iterate the message queue and execute the underlying transports IoTHubTransport_ProcessItem function for each item. ] */
         DLIST_ENTRY* client_item = handleData->iot_msg_queue.Flink;
@@ -1146,6 +1371,22 @@ void IoTHubClient_LL_DoWork(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
 
         /*Codes_SRS_IOTHUBCLIENT_LL_02_021: [Otherwise, IoTHubClient_LL_DoWork shall invoke the underlaying layer's _DoWork function.]*/
         handleData->IoTHubTransport_DoWork(handleData->transportHandle, iotHubClientHandle);
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_024: [ If the tick count could be read when IoTHubClient_LL_DoWork started, IoTHubClient_LL_DoWork shall read it again once done and add its duration to the statistics. ]*/
+        if (hasStartTick)
+        {
+            tickcounter_ms_t endTick;
+            if (tickcounter_get_current_ms(handleData->tickCounter, &endTick) == 0)
+            {
+                tickcounter_ms_t duration = (endTick > startTick) ? (endTick - startTick) : 0;
+                record_duration(handleData->statistics.doWorkDurationHistogram, duration);
+                if (duration > handleData->statistics.doWorkDurationMaxMs)
+                {
+                    handleData->statistics.doWorkDurationMaxMs = duration;
+                }
+                handleData->statistics.doWorkCount++;
+            }
+        }
     }
 }
 
@@ -1186,17 +1427,43 @@ void IoTHubClient_LL_SendComplete(IOTHUB_CLIENT_LL_HANDLE handle, PDLIST_ENTRY c
     {
         /*Codes_SRS_IOTHUBCLIENT_LL_02_027: [If parameter result is IOTHUB_CLIENT_CONFIRMATION_ERROR then IoTHubClient_LL_SendComplete shall call all the non-NULL callbacks with the result parameter set to IOTHUB_CLIENT_CONFIRMATION_ERROR and the context set to the context passed originally in the SendEventAsync call.] */
         /*Codes_SRS_IOTHUBCLIENT_LL_02_025: [If parameter result is IOTHUB_CLIENT_CONFIRMATION_OK then IoTHubClient_LL_SendComplete shall call all the non-NULL callbacks with the result parameter set to IOTHUB_CLIENT_CONFIRMATION_OK and the context set to the context passed originally in the SendEventAsync call.]*/
+        IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)handle;
         PDLIST_ENTRY oldest;
+        tickcounter_ms_t nowTick = 0;
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_023: [ If result is IOTHUB_CLIENT_CONFIRMATION_OK, IoTHubClient_LL_SendComplete shall read the tick count once and add the time elapsed since IoTHubClient_LL_SendEventAsync of each completed message to the acknowledgement latency histogram. ]*/
+        bool recordLatency = (result == IOTHUB_CLIENT_CONFIRMATION_OK) && (tickcounter_get_current_ms(handleData->tickCounter, &nowTick) == 0);
         while ((oldest = DList_RemoveHeadList(completed)) != completed)
         {
             IOTHUB_MESSAGE_LIST* messageList = (IOTHUB_MESSAGE_LIST*)containingRecord(oldest, IOTHUB_MESSAGE_LIST, entry);
+            if (result == IOTHUB_CLIENT_CONFIRMATION_OK)
+            {
+                handleData->statistics.messagesAcknowledged++;
+                if (recordLatency && (messageList->ms_enqueued != ENQUEUE_TIME_UNKNOWN) && (nowTick >= messageList->ms_enqueued))
+                {
+                    record_duration(handleData->statistics.ackLatencyHistogram, nowTick - messageList->ms_enqueued);
+                }
+            }
+            else if (result == IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT)
+            {
+                handleData->statistics.messagesTimedOut++;
+            }
+            else
+            {
+                handleData->statistics.messagesFailed++;
+            }
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_013: [ IoTHubClient_LL_SendComplete shall remove every completed message that has a pending timeout from the timeout heap. ]*/
+            if ((messageList->ms_timesOutAfter != 0) && (messageList->timeoutHeapIndex != TIMEOUT_HEAP_EXPIRED))
+            {
+                timeout_heap_remove(handleData, messageList);
+            }
             /*Codes_SRS_IOTHUBCLIENT_LL_02_026: [If any callback is NULL then there shall not be a callback call.]*/
             if (messageList->callback != NULL)
             {
                 messageList->callback(result, messageList->context);
             }
             IoTHubMessage_Destroy(messageList->messageHandle);
-            free(messageList);
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_019: [ IoTHubClient_LL_SendComplete shall return each completed record to the message pool while the pool holds fewer than "message_pool_size" records, and free it otherwise. ]*/
+            release_message_list(handleData, messageList);
         }
     }
 }
@@ -1506,6 +1773,95 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetLastMessageReceiveTime(IOTHUB_CLIENT_LL_
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetNextMessageTimeout(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, uint64_t* msUntilNextTimeout)
+{
+    IOTHUB_CLIENT_RESULT result;
+    IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
+
+    /* Codes_SRS_IOTHUBCLIENT_LL_09_014: [ IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ] */
+    if (handleData == NULL || msUntilNextTimeout == NULL)
+    {
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LOG_ERROR_RESULT;
+    }
+    /* Codes_SRS_IOTHUBCLIENT_LL_09_015: [ IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_INDEFINITE_TIME - and not set msUntilNextTimeout - if no pending message has a timeout. ] */
+    else if (handleData->timeoutHeapCount == 0)
+    {
+        result = IOTHUB_CLIENT_INDEFINITE_TIME;
+    }
+    else
+    {
+        tickcounter_ms_t nowTick;
+        /* Codes_SRS_IOTHUBCLIENT_LL_09_016: [ If getting the current time fails, IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_ERROR. ] */
+        if (tickcounter_get_current_ms(handleData->tickCounter, &nowTick) != 0)
+        {
+            result = IOTHUB_CLIENT_ERROR;
+            LOG_ERROR_RESULT;
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUBCLIENT_LL_09_017: [ Otherwise IoTHubClient_LL_GetNextMessageTimeout shall set msUntilNextTimeout to the number of milliseconds until the earliest pending message timeout, or 0 if it is already due, and return IOTHUB_CLIENT_OK. ] */
+            tickcounter_ms_t nextTimeout = handleData->timeoutHeap[0]->ms_timesOutAfter;
+            *msUntilNextTimeout = (nextTimeout > nowTick) ? (uint64_t)(nextTimeout - nowTick) : 0;
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_GetStatistics(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    IOTHUB_CLIENT_RESULT result;
+    IOTHUB_CLIENT_LL_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_HANDLE_DATA*)iotHubClientHandle;
+
+    /* Codes_SRS_IOTHUBCLIENT_LL_09_025: [ IoTHubClient_LL_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ] */
+    if (handleData == NULL || statistics == NULL)
+    {
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LOG_ERROR_RESULT;
+    }
+    else
+    {
+        uint64_t completedCount = handleData->statistics.messagesAcknowledged + handleData->statistics.messagesTimedOut + handleData->statistics.messagesFailed;
+        /*every message counted by messagesQueued is counted again once, by one of the completion counters, when it leaves the client*/
+        size_t pendingCount = (handleData->statistics.messagesQueued > completedCount) ? (size_t)(handleData->statistics.messagesQueued - completedCount) : 0;
+
+        /* Codes_SRS_IOTHUBCLIENT_LL_09_026: [ IoTHubClient_LL_GetStatistics shall copy the counters kept by IoTHubClient_LL into statistics. ] */
+        *statistics = handleData->statistics;
+
+        /* Codes_SRS_IOTHUBCLIENT_LL_09_047: [ IoTHubClient_LL_GetStatistics shall set waitingForAckCount to 0 before calling IoTHubTransport_GetStatistics, so that transports that keep no message in flight between calls to DoWork report none. ] */
+        statistics->waitingForAckCount = 0;
+
+        /* Codes_SRS_IOTHUBCLIENT_LL_09_028: [ IoTHubClient_LL_GetStatistics shall set the DoWork duration percentiles to the upper bound of the histogram bucket holding them, capped by the longest DoWork duration. ] */
+        statistics->doWorkDurationP50Ms = get_do_work_duration_percentile(&handleData->statistics, 50);
+        statistics->doWorkDurationP90Ms = get_do_work_duration_percentile(&handleData->statistics, 90);
+        statistics->doWorkDurationP99Ms = get_do_work_duration_percentile(&handleData->statistics, 99);
+
+        /* Codes_SRS_IOTHUBCLIENT_LL_09_029: [ If the transport provides IoTHubTransport_GetStatistics, IoTHubClient_LL_GetStatistics shall call it to fill in the transport counters and return IOTHUB_CLIENT_ERROR if it fails. ] */
+        if ((handleData->IoTHubTransport_GetStatistics != NULL) &&
+            (handleData->IoTHubTransport_GetStatistics(handleData->deviceHandle, statistics) != IOTHUB_CLIENT_OK))
+        {
+            result = IOTHUB_CLIENT_ERROR;
+            LOG_ERROR_RESULT;
+        }
+        else
+        {
+            /* Codes_SRS_IOTHUBCLIENT_LL_09_027: [ IoTHubClient_LL_GetStatistics shall set waitingToSendCount, without walking waitingToSend, to the number of queued messages that are neither completed nor reported in waitingForAckCount by the transport. ] */
+            if (statistics->waitingForAckCount > pendingCount)
+            {
+                statistics->waitingForAckCount = pendingCount;
+            }
+            statistics->waitingToSendCount = pendingCount - statistics->waitingForAckCount;
+
+            /* Codes_SRS_IOTHUBCLIENT_LL_09_030: [ Otherwise IoTHubClient_LL_GetStatistics shall return IOTHUB_CLIENT_OK. ] */
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetOption(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* optionName, const void* value)
 {
 
@@ -1534,6 +1890,24 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_SetOption(IOTHUB_CLIENT_LL_HANDLE iotHubCli
             handleData->currentMessageTimeout = *(const tickcounter_ms_t*)value;
             result = IOTHUB_CLIENT_OK;
         }
+        else if (strcmp(optionName, OPTION_MESSAGE_POOL_SIZE) == 0)
+        {
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_020: [ "message_pool_size" - IoTHubClient_LL_SetOption shall set the number of released records kept for reuse to *value, a size_t, and free the records above that number. ]*/
+            handleData->messagePoolSize = *(const size_t*)value;
+            trim_message_pool(handleData);
+
+            /*Codes_SRS_IOTHUBCLIENT_LL_09_021: [ IoTHubClient_LL_SetOption shall pass "message_pool_size" down to the transport and return IOTHUB_CLIENT_ERROR only if the transport returns IOTHUB_CLIENT_ERROR. ]*/
+            /*transports without per-message records of their own answer IOTHUB_CLIENT_INVALID_ARG, which is fine*/
+            if (handleData->IoTHubTransport_SetOption(handleData->transportHandle, optionName, value) == IOTHUB_CLIENT_ERROR)
+            {
+                LogError("transport failed setting the message pool size");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else
+            {
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
         else if (strcmp(optionName, OPTION_PRODUCT_INFO) == 0)
         {
             /*Codes_SRS_IOTHUBCLIENT_LL_10_033: [repeat calls with "product_info" will erase the previously set product information if applicatble. ]*/
@@ -1891,4 +2265,25 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob(IOTHUB_CLIENT_LL_HANDLE iotHub
     }
     return result;
 }
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_035: [ If iotHubClientHandle, destinationFileName or getDataCallback are NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (iotHubClientHandle == NULL) ||
+        (destinationFileName == NULL) ||
+        (getDataCallback == NULL)
+        )
+    {
+        LogError("invalid parameters IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle=%p, const char* destinationFileName=%p, getDataCallback=%p", iotHubClientHandle, destinationFileName, getDataCallback);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_036: [ Otherwise IoTHubClient_LL_UploadMultipleBlocksToBlob shall call IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl and return what it returns. ]*/
+        result = IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(iotHubClientHandle->uploadToBlobHandle, destinationFileName, getDataCallback, context);
+    }
+    return result;
+}
 #endif
@@ -7,6 +7,8 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/string_tokenizer.h"
@@ -55,6 +57,18 @@ typedef struct UPLOADTOBLOB_X509_CREDENTIALS_TAG
     const char* x509privatekey;
 }UPLOADTOBLOB_X509_CREDENTIALS;
 
+/*what is needed to resume an upload that failed in step 2 without asking IoTHub for a new SAS URI*/
+typedef struct UPLOADTOBLOB_CHECKPOINT_TAG
+{
+    char* destinationFileName;
+    size_t size;
+    size_t blockSize;
+    STRING_HANDLE correlationId;
+    STRING_HANDLE sasUri;
+    unsigned char* uploadedBlocks; /*one entry per block, not 0 when the block is already in the storage*/
+    uint32_t* blockCrcs; /*one entry per block, the CRC-32 of the content the block was (or is to be) uploaded from*/
+}UPLOADTOBLOB_CHECKPOINT;
+
 typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA_TAG
 {
     STRING_HANDLE deviceId;                     /*needed for file upload*/
@@ -66,6 +80,11 @@ typedef struct IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA_TAG
         UPLOADTOBLOB_X509_CREDENTIALS x509credentials; /*assumed to be used when both deviceKey and deviceSasToken are NULL*/
     } credentials;                              /*needed for file upload*/
     char* certificates; /*if there are any certificates used*/
+    size_t blobUploadConcurrency; /*number of blocks uploaded at the same time*/
+    size_t blobUploadBlockSize; /*size of the blocks when blobUploadConcurrency is not 1*/
+    bool blobUploadResumable;
+    UPLOADTOBLOB_CHECKPOINT* checkpoint; /*only when the last upload failed in step 2 without a HTTP status, or when given by blob_upload_checkpoint*/
+    IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_HOOK checkpointHook;
 }IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA;
 
 IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const IOTHUB_CLIENT_CONFIG* config)
@@ -103,6 +122,12 @@ IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE IoTHubClient_LL_UploadToBlob_Create(const I
                 ((char*)handleData->hostname)[iotHubNameLength] = '.';
                 (void)memcpy((char*)handleData->hostname + iotHubNameLength + 1, config->iotHubSuffix, iotHubSuffixLength + 1); /*+1 will copy the \0 too*/
                 handleData->certificates = NULL;
+                handleData->blobUploadConcurrency = 1;
+                handleData->blobUploadBlockSize = BLOB_BLOCK_SIZE_MAX;
+                handleData->blobUploadResumable = false;
+                handleData->checkpoint = NULL;
+                handleData->checkpointHook.callback = NULL;
+                handleData->checkpointHook.context = NULL;
                 if ((config->deviceSasToken != NULL) && (config->deviceKey == NULL))
                 {
                     handleData->authorizationScheme = SAS_TOKEN;
@@ -735,179 +760,649 @@ static int IoTHubClient_LL_UploadToBlob_step3(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HAND
     return result;
 }
 
-IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, const unsigned char* source, size_t size)
+#define CHECKPOINT_BLOCK_LENGTH 9 /*the CRC-32 of the block as 8 hex digits, then '1' if the block is uploaded, '0' otherwise*/
+
+/*CRC-32 (IEEE 802.3) one nibble at a time, so that the table stays small*/
+static const uint32_t crc32NibbleTable[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+static uint32_t ComputeCrc32(const unsigned char* data, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+    size_t i;
+    for (i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ crc32NibbleTable[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32NibbleTable[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+static size_t GetCheckpointBlockCount(size_t size, size_t blockSize)
+{
+    return (size + blockSize - 1) / blockSize;
+}
+
+static uint32_t ComputeBlockCrc(const UPLOADTOBLOB_CHECKPOINT* checkpoint, const unsigned char* source, size_t blockIndex)
+{
+    size_t offset = blockIndex * checkpoint->blockSize;
+    size_t blockSize = (checkpoint->size - offset < checkpoint->blockSize) ? (checkpoint->size - offset) : checkpoint->blockSize;
+    return ComputeCrc32(source + offset, blockSize);
+}
+
+static void FreeCheckpoint(UPLOADTOBLOB_CHECKPOINT* checkpoint)
+{
+    free(checkpoint->destinationFileName);
+    STRING_delete(checkpoint->correlationId);
+    STRING_delete(checkpoint->sasUri);
+    free(checkpoint->uploadedBlocks);
+    free(checkpoint->blockCrcs);
+    free(checkpoint);
+}
+
+/*a checkpoint without any block uploaded, correlationId and sasUri are set by the caller*/
+static UPLOADTOBLOB_CHECKPOINT* AllocateCheckpoint(const char* destinationFileName, size_t size, size_t blockSize)
+{
+    UPLOADTOBLOB_CHECKPOINT* result = (UPLOADTOBLOB_CHECKPOINT*)malloc(sizeof(UPLOADTOBLOB_CHECKPOINT));
+    if (result == NULL)
+    {
+        LogError("unable to malloc");
+        /*return as is*/
+    }
+    else
+    {
+        size_t blockCount = GetCheckpointBlockCount(size, blockSize);
+        result->destinationFileName = NULL;
+        result->correlationId = NULL;
+        result->sasUri = NULL;
+        result->uploadedBlocks = NULL;
+        result->blockCrcs = NULL;
+        result->size = size;
+        result->blockSize = blockSize;
+
+        if (
+            (mallocAndStrcpy_s(&result->destinationFileName, destinationFileName) != 0) ||
+            ((result->uploadedBlocks = (unsigned char*)malloc(blockCount + 1)) == NULL) || /*+1 because a blob can have 0 blocks*/
+            ((result->blockCrcs = (uint32_t*)malloc((blockCount + 1) * sizeof(uint32_t))) == NULL)
+            )
+        {
+            LogError("unable to allocate the upload checkpoint");
+            FreeCheckpoint(result);
+            result = NULL;
+        }
+        else
+        {
+            (void)memset(result->uploadedBlocks, 0, blockCount + 1);
+        }
+    }
+    return result;
+}
+
+static void DestroyCheckpoint(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    if (handleData->checkpoint != NULL)
+    {
+        FreeCheckpoint(handleData->checkpoint);
+        handleData->checkpoint = NULL;
+    }
+}
+
+static char* SerializeCheckpoint(const UPLOADTOBLOB_CHECKPOINT* checkpoint)
+{
+    char* result;
+    size_t blockCount = GetCheckpointBlockCount(checkpoint->size, checkpoint->blockSize);
+    char* blocks = (char*)malloc(blockCount * CHECKPOINT_BLOCK_LENGTH + 1);
+    if (blocks == NULL)
+    {
+        LogError("unable to malloc");
+        result = NULL;
+    }
+    else
+    {
+        JSON_Value* checkpointJson;
+        size_t i;
+        blocks[0] = '\0';
+        for (i = 0; i < blockCount; i++)
+        {
+            (void)sprintf(blocks + i * CHECKPOINT_BLOCK_LENGTH, "%08lx%c", (unsigned long)checkpoint->blockCrcs[i], (checkpoint->uploadedBlocks[i] != 0) ? '1' : '0');
+        }
+
+        if ((checkpointJson = json_value_init_object()) == NULL)
+        {
+            LogError("unable to json_value_init_object");
+            result = NULL;
+        }
+        else
+        {
+            JSON_Object* checkpointObject = json_value_get_object(checkpointJson);
+            if (
+                (checkpointObject == NULL) ||
+                (json_object_set_string(checkpointObject, "destinationFileName", checkpoint->destinationFileName) != JSONSuccess) ||
+                (json_object_set_number(checkpointObject, "size", (double)checkpoint->size) != JSONSuccess) ||
+                (json_object_set_number(checkpointObject, "blockSize", (double)checkpoint->blockSize) != JSONSuccess) ||
+                (json_object_set_string(checkpointObject, "correlationId", STRING_c_str(checkpoint->correlationId)) != JSONSuccess) ||
+                (json_object_set_string(checkpointObject, "sasUri", STRING_c_str(checkpoint->sasUri)) != JSONSuccess) ||
+                (json_object_set_string(checkpointObject, "blocks", blocks) != JSONSuccess)
+                )
+            {
+                LogError("unable to build the upload checkpoint");
+                result = NULL;
+            }
+            else if ((result = json_serialize_to_string(checkpointJson)) == NULL)
+            {
+                LogError("unable to json_serialize_to_string");
+            }
+            json_value_free(checkpointJson);
+        }
+        free(blocks);
+    }
+    return result;
+}
+
+static int DeserializeCheckpointBlocks(UPLOADTOBLOB_CHECKPOINT* checkpoint, const char* blocks)
+{
+    int result = 0;
+    size_t blockCount = GetCheckpointBlockCount(checkpoint->size, checkpoint->blockSize);
+    size_t i;
+    for (i = 0; (result == 0) && (i < blockCount); i++)
+    {
+        const char* block = blocks + i * CHECKPOINT_BLOCK_LENGTH;
+        uint32_t crc = 0;
+        size_t j;
+        for (j = 0; (result == 0) && (j < CHECKPOINT_BLOCK_LENGTH - 1); j++)
+        {
+            crc <<= 4;
+            if ((block[j] >= '0') && (block[j] <= '9'))
+            {
+                crc |= (uint32_t)(block[j] - '0');
+            }
+            else if ((block[j] >= 'a') && (block[j] <= 'f'))
+            {
+                crc |= (uint32_t)(block[j] - 'a' + 10);
+            }
+            else
+            {
+                result = __FAILURE__;
+            }
+        }
+
+        if ((result == 0) && ((block[CHECKPOINT_BLOCK_LENGTH - 1] == '0') || (block[CHECKPOINT_BLOCK_LENGTH - 1] == '1')))
+        {
+            checkpoint->blockCrcs[i] = crc;
+            checkpoint->uploadedBlocks[i] = (unsigned char)(block[CHECKPOINT_BLOCK_LENGTH - 1] == '1');
+        }
+        else
+        {
+            result = __FAILURE__;
+        }
+    }
+    return result;
+}
+
+/*gives the saved upload to the application, so that it can be resumed after a restart*/
+static void ExportCheckpoint(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    if (handleData->checkpointHook.callback != NULL)
+    {
+        if (handleData->checkpoint == NULL)
+        {
+            handleData->checkpointHook.callback(NULL, handleData->checkpointHook.context);
+        }
+        else
+        {
+            char* serializedCheckpoint = SerializeCheckpoint(handleData->checkpoint);
+            if (serializedCheckpoint == NULL)
+            {
+                /*the application keeps the previous checkpoint, which only has fewer blocks uploaded*/
+                LogError("unable to export the upload checkpoint");
+            }
+            else
+            {
+                handleData->checkpointHook.callback(serializedCheckpoint, handleData->checkpointHook.context);
+                json_free_serialized_string(serializedCheckpoint);
+            }
+        }
+    }
+}
+
+/*a saved upload that is not going to be resumed, the application forgets it too*/
+static void DiscardCheckpoint(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData)
+{
+    if (handleData->checkpoint != NULL)
+    {
+        DestroyCheckpoint(handleData);
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_052: [ When the saved upload is discarded, `IoTHubClient_LL_UploadToBlob` and `IoTHubClient_LL_UploadToBlob_SetOption` shall call the callback of `blob_upload_checkpoint_hook` passing `NULL`. ]*/
+        ExportCheckpoint(handleData);
+    }
+}
+
+/*rebuilds a checkpoint exported by ExportCheckpoint, maybe by a previous run of the application*/
+static IOTHUB_CLIENT_RESULT ImportCheckpoint(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, const char* serializedCheckpoint)
+{
+    IOTHUB_CLIENT_RESULT result;
+    JSON_Value* checkpointJson = json_parse_string(serializedCheckpoint);
+    if (checkpointJson == NULL)
+    {
+        LogError("unable to json_parse_string");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        JSON_Object* checkpointObject = json_value_get_object(checkpointJson);
+        const char* destinationFileName = NULL;
+        const char* correlationId = NULL;
+        const char* sasUri = NULL;
+        const char* blocks = NULL;
+        double size = 0;
+        double blockSize = 0;
+        if (
+            (checkpointObject == NULL) ||
+            ((destinationFileName = json_object_get_string(checkpointObject, "destinationFileName")) == NULL) ||
+            ((correlationId = json_object_get_string(checkpointObject, "correlationId")) == NULL) ||
+            ((sasUri = json_object_get_string(checkpointObject, "sasUri")) == NULL) ||
+            ((blocks = json_object_get_string(checkpointObject, "blocks")) == NULL) ||
+            ((size = json_object_get_number(checkpointObject, "size")) < 0) ||
+            (size >= (double)SIZE_MAX) ||
+            ((blockSize = json_object_get_number(checkpointObject, "blockSize")) < 1) ||
+            (blockSize > BLOB_BLOCK_SIZE_MAX) ||
+            (strlen(blocks) != GetCheckpointBlockCount((size_t)size, (size_t)blockSize) * CHECKPOINT_BLOCK_LENGTH)
+            )
+        {
+            LogError("invalid upload checkpoint");
+            result = IOTHUB_CLIENT_INVALID_ARG;
+        }
+        else
+        {
+            UPLOADTOBLOB_CHECKPOINT* checkpoint = AllocateCheckpoint(destinationFileName, (size_t)size, (size_t)blockSize);
+            if (checkpoint == NULL)
+            {
+                LogError("unable to import the upload checkpoint");
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else if (
+                ((checkpoint->correlationId = STRING_construct(correlationId)) == NULL) ||
+                ((checkpoint->sasUri = STRING_construct(sasUri)) == NULL)
+                )
+            {
+                LogError("unable to import the upload checkpoint");
+                FreeCheckpoint(checkpoint);
+                result = IOTHUB_CLIENT_ERROR;
+            }
+            else if (DeserializeCheckpointBlocks(checkpoint, blocks) != 0)
+            {
+                LogError("invalid blocks in the upload checkpoint");
+                FreeCheckpoint(checkpoint);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                DestroyCheckpoint(handleData);
+                handleData->checkpoint = checkpoint;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        json_value_free(checkpointJson);
+    }
+    return result;
+}
+
+/*saves the outcome of step 1 so that a failed step 2 can be resumed by the next call*/
+static int CreateCheckpoint(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, const char* destinationFileName, const unsigned char* source, size_t size, STRING_HANDLE correlationId, STRING_HANDLE sasUri)
+{
+    int result;
+    UPLOADTOBLOB_CHECKPOINT* checkpoint = AllocateCheckpoint(destinationFileName, size, handleData->blobUploadBlockSize);
+    if (checkpoint == NULL)
+    {
+        LogError("unable to save the upload checkpoint");
+        result = __FAILURE__;
+    }
+    else if (
+        ((checkpoint->correlationId = STRING_clone(correlationId)) == NULL) ||
+        ((checkpoint->sasUri = STRING_clone(sasUri)) == NULL)
+        )
+    {
+        LogError("unable to save the upload checkpoint");
+        FreeCheckpoint(checkpoint);
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t blockCount = GetCheckpointBlockCount(size, checkpoint->blockSize);
+        size_t i;
+        for (i = 0; i < blockCount; i++)
+        {
+            checkpoint->blockCrcs[i] = ComputeBlockCrc(checkpoint, source, i);
+        }
+        handleData->checkpoint = checkpoint;
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_051: [ Every time the saved upload is created or kept with more blocks uploaded, `IoTHubClient_LL_UploadToBlob` shall call the callback of `blob_upload_checkpoint_hook` passing the saved upload as a JSON string. ]*/
+        ExportCheckpoint(handleData);
+        result = 0;
+    }
+    return result;
+}
+
+/*a block already in the storage is skipped only if source still has the same content for it, the other blocks take their CRC from source*/
+static bool CheckpointMatchesSource(UPLOADTOBLOB_CHECKPOINT* checkpoint, const unsigned char* source)
+{
+    bool result = true;
+    size_t blockCount = GetCheckpointBlockCount(checkpoint->size, checkpoint->blockSize);
+    size_t i;
+    for (i = 0; result && (i < blockCount); i++)
+    {
+        uint32_t crc = ComputeBlockCrc(checkpoint, source, i);
+        if (checkpoint->uploadedBlocks[i] == 0)
+        {
+            checkpoint->blockCrcs[i] = crc;
+        }
+        else if (checkpoint->blockCrcs[i] != crc)
+        {
+            LogInfo("block %lu has changed since it was uploaded, the upload starts over", (unsigned long)i);
+            result = false;
+        }
+    }
+    return result;
+}
+
+/*the headers that step 1 would have built for step 3, when step 1 is skipped*/
+static int ResumeFromCheckpoint(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, HTTP_HEADERS_HANDLE requestHttpHeaders, STRING_HANDLE correlationId, STRING_HANDLE sasUri)
+{
+    int result;
+    if (!(
+        (STRING_copy(correlationId, STRING_c_str(handleData->checkpoint->correlationId)) == 0) &&
+        (STRING_copy(sasUri, STRING_c_str(handleData->checkpoint->sasUri)) == 0) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Content-Type", "application/json") == HTTP_HEADERS_OK) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Accept", "application/json") == HTTP_HEADERS_OK) &&
+        (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "User-Agent", "iothubclient/" IOTHUB_SDK_VERSION) == HTTP_HEADERS_OK) &&
+        ((handleData->authorizationScheme == X509) || (HTTPHeaders_AddHeaderNameValuePair(requestHttpHeaders, "Authorization", "") == HTTP_HEADERS_OK)) &&
+        ((handleData->authorizationScheme != SAS_TOKEN) || (HTTPHeaders_ReplaceHeaderNameValuePair(requestHttpHeaders, "Authorization", STRING_c_str(handleData->credentials.sas)) == HTTP_HEADERS_OK))
+        ))
+    {
+        LogError("unable to resume the upload from the checkpoint");
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+    return result;
+}
+
+/*uploads either source/size or, when getDataCallback is not NULL, the blocks produced by getDataCallback*/
+static IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_DoUpload(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData, const char* destinationFileName, const unsigned char* source, size_t size, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, void* context)
 {
     IOTHUB_CLIENT_RESULT result;
     BUFFER_HANDLE toBeTransmitted;
     int requiredStringLength;
     char* requiredString;
 
-    /*Codes_SRS_IOTHUBCLIENT_LL_02_061: [ If handle is NULL then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
-    /*Codes_SRS_IOTHUBCLIENT_LL_02_062: [ If destinationFileName is NULL then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
-    /*Codes_SRS_IOTHUBCLIENT_LL_02_063: [ If source is NULL and size is greater than 0 then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
-    if (
-        (handle == NULL) ||
-        (destinationFileName == NULL) ||
-        ((source == NULL) && (size > 0))
-        )
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_064: [ IoTHubClient_LL_UploadToBlob shall create an HTTPAPIEX_HANDLE to the IoTHub hostname. ]*/
+    HTTPAPIEX_HANDLE iotHubHttpApiExHandle = HTTPAPIEX_Create(handleData->hostname);
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_065: [ If creating the HTTPAPIEX_HANDLE fails then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+    if (iotHubHttpApiExHandle == NULL)
     {
-        LogError("invalid argument detected handle=%p destinationFileName=%p source=%p size=%zu", handle, destinationFileName, source, size);
-        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("unable to HTTPAPIEX_Create");
+        result = IOTHUB_CLIENT_ERROR;
     }
     else
     {
-        IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA* handleData = (IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle;
+        if (
+            (handleData->authorizationScheme == X509) &&
 
-        /*Codes_SRS_IOTHUBCLIENT_LL_02_064: [ IoTHubClient_LL_UploadToBlob shall create an HTTPAPIEX_HANDLE to the IoTHub hostname. ]*/
-        HTTPAPIEX_HANDLE iotHubHttpApiExHandle = HTTPAPIEX_Create(handleData->hostname);
-
-        /*Codes_SRS_IOTHUBCLIENT_LL_02_065: [ If creating the HTTPAPIEX_HANDLE fails then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-        if (iotHubHttpApiExHandle == NULL)
+            /*transmit the x509certificate and x509privatekey*/
+            /*Codes_SRS_IOTHUBCLIENT_LL_02_106: [ - x509certificate and x509privatekey saved options shall be passed on the HTTPAPIEX_SetOption ]*/
+            (!(
+                (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_X509_CERT, handleData->credentials.x509credentials.x509certificate) == HTTPAPIEX_OK) &&
+                (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_X509_PRIVATE_KEY, handleData->credentials.x509credentials.x509privatekey) == HTTPAPIEX_OK)
+            ))
+            )
         {
-            LogError("unable to HTTPAPIEX_Create");
+            LogError("unable to HTTPAPIEX_SetOption for x509");
             result = IOTHUB_CLIENT_ERROR;
         }
         else
         {
-            if (
-                (handleData->authorizationScheme == X509) &&
-
-                /*transmit the x509certificate and x509privatekey*/
-                /*Codes_SRS_IOTHUBCLIENT_LL_02_106: [ - x509certificate and x509privatekey saved options shall be passed on the HTTPAPIEX_SetOption ]*/
-                (!(
-                    (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_X509_CERT, handleData->credentials.x509credentials.x509certificate) == HTTPAPIEX_OK) &&
-                    (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, OPTION_X509_PRIVATE_KEY, handleData->credentials.x509credentials.x509privatekey) == HTTPAPIEX_OK)
-                ))
-                )
+            /*Codes_SRS_IOTHUBCLIENT_LL_02_111: [ If certificates is non-NULL then certificates shall be passed to HTTPAPIEX_SetOption with optionName TrustedCerts. ]*/
+            if ((handleData->certificates != NULL) && (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, "TrustedCerts", handleData->certificates) != HTTPAPIEX_OK))
             {
-                LogError("unable to HTTPAPIEX_SetOption for x509");
+                LogError("unable to set TrustedCerts!");
                 result = IOTHUB_CLIENT_ERROR;
             }
             else
             {
-                /*Codes_SRS_IOTHUBCLIENT_LL_02_111: [ If certificates is non-NULL then certificates shall be passed to HTTPAPIEX_SetOption with optionName TrustedCerts. ]*/
-                if ((handleData->certificates != NULL) && (HTTPAPIEX_SetOption(iotHubHttpApiExHandle, "TrustedCerts", handleData->certificates) != HTTPAPIEX_OK))
+
+                STRING_HANDLE correlationId = STRING_new();
+                if (correlationId == NULL)
                 {
-                    LogError("unable to set TrustedCerts!");
+                    LogError("unable to STRING_new");
                     result = IOTHUB_CLIENT_ERROR;
                 }
                 else
                 {
-
-                    STRING_HANDLE correlationId = STRING_new();
-                    if (correlationId == NULL)
+                    STRING_HANDLE sasUri = STRING_new();
+                    if (sasUri == NULL)
                     {
                         LogError("unable to STRING_new");
                         result = IOTHUB_CLIENT_ERROR;
                     }
                     else
                     {
-                        STRING_HANDLE sasUri = STRING_new();
-                        if (sasUri == NULL)
+                        /*Codes_SRS_IOTHUBCLIENT_LL_02_070: [ IoTHubClient_LL_UploadToBlob shall create request HTTP headers. ]*/
+                        HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc(); /*these are build by step 1 and used by step 3 too*/
+                        if (requestHttpHeaders == NULL)
                         {
-                            LogError("unable to STRING_new");
+                            LogError("unable to HTTPHeaders_Alloc");
                             result = IOTHUB_CLIENT_ERROR;
                         }
                         else
                         {
-                            /*Codes_SRS_IOTHUBCLIENT_LL_02_070: [ IoTHubClient_LL_UploadToBlob shall create request HTTP headers. ]*/
-                            HTTP_HEADERS_HANDLE requestHttpHeaders = HTTPHeaders_Alloc(); /*these are build by step 1 and used by step 3 too*/
-                            if (requestHttpHeaders == NULL)
+                            int step1success;
+                            /*Codes_SRS_IOTHUBCLIENT_LL_09_056: [ Whatever blob_upload_resumable is, IoTHubClient_LL_UploadMultipleBlocksToBlob shall discard any saved upload, do step 1 and not save the upload. ]*/
+                            if (
+                                (handleData->checkpoint != NULL) &&
+                                handleData->blobUploadResumable &&
+                                (getDataCallback == NULL) &&
+                                (strcmp(handleData->checkpoint->destinationFileName, destinationFileName) == 0) &&
+                                (handleData->checkpoint->size == size) &&
+                                (handleData->checkpoint->blockSize == handleData->blobUploadBlockSize) &&
+                                /*Codes_SRS_IOTHUBCLIENT_LL_09_050: [ The saved upload shall be resumed only if the CRC-32 of every block of `source` it has already uploaded is the CRC-32 saved for that block. ]*/
+                                CheckpointMatchesSource(handleData->checkpoint, source)
+                                )
                             {
-                                LogError("unable to HTTPHeaders_Alloc");
-                                result = IOTHUB_CLIENT_ERROR;
+                                /*Codes_SRS_IOTHUBCLIENT_LL_09_041: [ If the previous upload of the same destinationFileName, size and blob_upload_block_size failed in step 2 without a HTTP status, IoTHubClient_LL_UploadToBlob shall skip step 1 and reuse the correlationId and SasUri of that upload. ]*/
+                                step1success = (ResumeFromCheckpoint(handleData, requestHttpHeaders, correlationId, sasUri) == 0);
                             }
                             else
                             {
+                                /*Codes_SRS_IOTHUBCLIENT_LL_09_042: [ Any other saved upload shall be discarded. ]*/
+                                DiscardCheckpoint(handleData);
+
                                 /*do step 1*/
-                                if (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) != 0)
+                                step1success = (IoTHubClient_LL_UploadToBlob_step1and2(handleData, iotHubHttpApiExHandle, requestHttpHeaders, destinationFileName, correlationId, sasUri) == 0);
+
+                                /*Codes_SRS_IOTHUBCLIENT_LL_09_043: [ If blob_upload_resumable is true, IoTHubClient_LL_UploadToBlob shall save destinationFileName, size, blob_upload_block_size, correlationId, SasUri and which blocks have been uploaded after step 1. If saving fails then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                                if (step1success && handleData->blobUploadResumable && (getDataCallback == NULL) && (CreateCheckpoint(handleData, destinationFileName, source, size, correlationId, sasUri) != 0))
+                                {
+                                    step1success = 0;
+                                }
+                            }
+
+                            if (!step1success)
+                            {
+                                LogError("error in IoTHubClient_LL_UploadToBlob_step1");
+                                result = IOTHUB_CLIENT_ERROR;
+                            }
+                            else
+                            {
+                                /*do step 2.*/
+
+                                unsigned int httpResponse;
+                                BUFFER_HANDLE responseToIoTHub = BUFFER_new();
+                                if (responseToIoTHub == NULL)
                                 {
-                                    LogError("error in IoTHubClient_LL_UploadToBlob_step1");
                                     result = IOTHUB_CLIENT_ERROR;
+                                    LogError("unable to BUFFER_new");
                                 }
                                 else
                                 {
-                                    /*do step 2.*/
-
-                                    unsigned int httpResponse;
-                                    BUFFER_HANDLE responseToIoTHub = BUFFER_new();
-                                    if (responseToIoTHub == NULL)
+                                    int step2success;
+                                    int keepCheckpoint = 0;
+                                    if (getDataCallback != NULL)
                                     {
-                                        result = IOTHUB_CLIENT_ERROR;
-                                        LogError("unable to BUFFER_new");
+                                        /*Codes_SRS_IOTHUBCLIENT_LL_09_031: [ IoTHubClient_LL_UploadMultipleBlocksToBlob shall call Blob_UploadMultipleBlocksFromSasUri passing getDataCallback and context and capture the HTTP return code and HTTP body. ]*/
+                                        step2success = (Blob_UploadMultipleBlocksFromSasUri(STRING_c_str(sasUri), getDataCallback, context, &httpResponse, responseToIoTHub, handleData->certificates) == BLOB_OK);
+                                    }
+                                    else if (handleData->checkpoint != NULL)
+                                    {
+                                        /*Codes_SRS_IOTHUBCLIENT_LL_09_044: [ If blob_upload_resumable is true then IoTHubClient_LL_UploadToBlob shall call Blob_ResumeUploadBlocksFromSasUri passing blob_upload_block_size, blob_upload_concurrency and the saved uploaded blocks and capture the HTTP return code and HTTP body. ]*/
+                                        BLOB_RESULT blobResult = Blob_ResumeUploadBlocksFromSasUri(STRING_c_str(sasUri), source, size, handleData->blobUploadBlockSize, handleData->blobUploadConcurrency, handleData->checkpoint->uploadedBlocks, &httpResponse, responseToIoTHub, handleData->certificates);
+                                        step2success = (blobResult == BLOB_OK);
+                                        keepCheckpoint = (blobResult == BLOB_HTTP_ERROR);
+                                    }
+                                    else if ((handleData->blobUploadConcurrency != 1) || (handleData->blobUploadBlockSize != BLOB_BLOCK_SIZE_MAX))
+                                    {
+                                        /*Codes_SRS_IOTHUBCLIENT_LL_09_037: [ If blob_upload_concurrency or blob_upload_block_size have been set to other values than their defaults then IoTHubClient_LL_UploadToBlob shall call Blob_UploadBlocksFromSasUri passing them and capture the HTTP return code and HTTP body. ]*/
+                                        step2success = (Blob_UploadBlocksFromSasUri(STRING_c_str(sasUri), source, size, handleData->blobUploadBlockSize, handleData->blobUploadConcurrency, &httpResponse, responseToIoTHub, handleData->certificates) == BLOB_OK);
                                     }
                                     else
                                     {
-                                        int step2success;
                                         /*Codes_SRS_IOTHUBCLIENT_LL_02_083: [ IoTHubClient_LL_UploadToBlob shall call Blob_UploadFromSasUri and capture the HTTP return code and HTTP body. ]*/
                                         step2success = (Blob_UploadFromSasUri(STRING_c_str(sasUri), source, size, &httpResponse, responseToIoTHub, handleData->certificates) == BLOB_OK);
-                                        if (!step2success)
+                                    }
+                                    if (!step2success)
+                                    {
+                                        /*Codes_SRS_IOTHUBCLIENT_LL_02_084: [ If Blob_UploadFromSasUri fails then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_ERROR. ]*/
+                                        LogError("unable to upload to the blob");
+
+                                        if (keepCheckpoint)
                                         {
-                                            /*Codes_SRS_IOTHUBCLIENT_LL_02_084: [ If Blob_UploadFromSasUri fails then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_ERROR. ]*/
-                                            LogError("unable to Blob_UploadFromSasUri");
+                                            /*Codes_SRS_IOTHUBCLIENT_LL_09_045: [ If Blob_ResumeUploadBlocksFromSasUri returns BLOB_HTTP_ERROR then IoTHubClient_LL_UploadToBlob shall keep the saved upload for the next call and shall not do step 3. ]*/
+                                            LogInfo("the upload of %s will resume from the blocks already uploaded", destinationFileName);
 
-                                            /*do step 3*/ /*try*/
-                                            /*Codes_SRS_IOTHUBCLIENT_LL_02_091: [ If step 2 fails without establishing an HTTP dialogue, then the HTTP message body shall look like: ]*/
-                                            if (BUFFER_build(responseToIoTHub, (const unsigned char*)FILE_UPLOAD_FAILED_BODY, sizeof(FILE_UPLOAD_FAILED_BODY) / sizeof(FILE_UPLOAD_FAILED_BODY[0])) == 0)
+                                            /*Codes_SRS_IOTHUBCLIENT_LL_09_051: [ Every time the saved upload is created or kept with more blocks uploaded, `IoTHubClient_LL_UploadToBlob` shall call the callback of `blob_upload_checkpoint_hook` passing the saved upload as a JSON string. ]*/
+                                            ExportCheckpoint(handleData);
+                                        }
+                                        /*do step 3*/ /*try*/
+                                        /*Codes_SRS_IOTHUBCLIENT_LL_02_091: [ If step 2 fails without establishing an HTTP dialogue, then the HTTP message body shall look like: ]*/
+                                        else if (BUFFER_build(responseToIoTHub, (const unsigned char*)FILE_UPLOAD_FAILED_BODY, sizeof(FILE_UPLOAD_FAILED_BODY) / sizeof(FILE_UPLOAD_FAILED_BODY[0])) == 0)
+                                        {
+                                            if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub) != 0)
                                             {
-                                                if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, responseToIoTHub) != 0)
-                                                {
-                                                    LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
-                                                }
+                                                LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
                                             }
+                                        }
+                                        result = IOTHUB_CLIENT_ERROR;
+                                    }
+                                    else
+                                    {
+                                        /*must make a json*/
+
+                                        requiredStringLength = snprintf(NULL, 0, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
+
+                                        requiredString = malloc(requiredStringLength + 1);
+                                        if (requiredString == 0)
+                                        {
+                                            LogError("unable to malloc");
                                             result = IOTHUB_CLIENT_ERROR;
                                         }
                                         else
                                         {
-                                            /*must make a json*/
-
-                                            requiredStringLength = snprintf(NULL, 0, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
-
-                                            requiredString = malloc(requiredStringLength + 1);
-                                            if (requiredString == 0)
+                                            /*do again snprintf*/
+                                            (void)snprintf(requiredString, requiredStringLength + 1, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
+                                            toBeTransmitted = BUFFER_create((const unsigned char*)requiredString, requiredStringLength);
+                                            if (toBeTransmitted == NULL)
                                             {
-                                                LogError("unable to malloc");
+                                                LogError("unable to BUFFER_create");
                                                 result = IOTHUB_CLIENT_ERROR;
                                             }
                                             else
                                             {
-                                                /*do again snprintf*/
-                                                (void)snprintf(requiredString, requiredStringLength + 1, "{\"isSuccess\":%s, \"statusCode\":%d, \"statusDescription\":\"%s\"}", ((httpResponse < 300) ? "true" : "false"), httpResponse, BUFFER_u_char(responseToIoTHub));
-                                                toBeTransmitted = BUFFER_create((const unsigned char*)requiredString, requiredStringLength);
-                                                if (toBeTransmitted == NULL)
+                                                if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, toBeTransmitted) != 0)
                                                 {
-                                                    LogError("unable to BUFFER_create");
+                                                    LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
                                                     result = IOTHUB_CLIENT_ERROR;
                                                 }
                                                 else
                                                 {
-                                                    if (IoTHubClient_LL_UploadToBlob_step3(handleData, correlationId, iotHubHttpApiExHandle, requestHttpHeaders, toBeTransmitted) != 0)
-                                                    {
-                                                        LogError("IoTHubClient_LL_UploadToBlob_step3 failed");
-                                                        result = IOTHUB_CLIENT_ERROR;
-                                                    }
-                                                    else
-                                                    {
-                                                        result = (httpResponse < 300) ? IOTHUB_CLIENT_OK : IOTHUB_CLIENT_ERROR;
-                                                    }
-                                                    BUFFER_delete(toBeTransmitted);
+                                                    result = (httpResponse < 300) ? IOTHUB_CLIENT_OK : IOTHUB_CLIENT_ERROR;
                                                 }
-                                                free(requiredString);
+                                                BUFFER_delete(toBeTransmitted);
                                             }
+                                            free(requiredString);
                                         }
-                                        BUFFER_delete(responseToIoTHub);
                                     }
+
+                                    /*Codes_SRS_IOTHUBCLIENT_LL_09_046: [ Otherwise, once step 2 has been done, the saved upload shall be discarded. ]*/
+                                    if (!keepCheckpoint)
+                                    {
+                                        DiscardCheckpoint(handleData);
+                                    }
+                                    BUFFER_delete(responseToIoTHub);
                                 }
-                                HTTPHeaders_Free(requestHttpHeaders);
                             }
-                            STRING_delete(sasUri);
+                            HTTPHeaders_Free(requestHttpHeaders);
                         }
-                        STRING_delete(correlationId);
+                        STRING_delete(sasUri);
                     }
+                    STRING_delete(correlationId);
                 }
             }
-            HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
         }
+        HTTPAPIEX_Destroy(iotHubHttpApiExHandle);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, const unsigned char* source, size_t size)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_061: [ If handle is NULL then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_062: [ If destinationFileName is NULL then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    /*Codes_SRS_IOTHUBCLIENT_LL_02_063: [ If source is NULL and size is greater than 0 then IoTHubClient_LL_UploadToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (destinationFileName == NULL) ||
+        ((source == NULL) && (size > 0))
+        )
+    {
+        LogError("invalid argument detected handle=%p destinationFileName=%p source=%p size=%zu", handle, destinationFileName, source, size);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        result = IoTHubClient_LL_UploadToBlob_DoUpload((IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle, destinationFileName, source, size, NULL, NULL);
+    }
+    return result;
+}
+
+IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE handle, const char* destinationFileName, IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK getDataCallback, void* context)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    /*Codes_SRS_IOTHUBCLIENT_LL_09_032: [ If handle, destinationFileName or getDataCallback are NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (
+        (handle == NULL) ||
+        (destinationFileName == NULL) ||
+        (getDataCallback == NULL)
+        )
+    {
+        LogError("invalid argument detected handle=%p destinationFileName=%p getDataCallback=%p", handle, destinationFileName, getDataCallback);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_033: [ IoTHubClient_LL_UploadMultipleBlocksToBlob shall go through the same steps as IoTHubClient_LL_UploadToBlob, pulling the blob content from getDataCallback in step 2. ]*/
+        result = IoTHubClient_LL_UploadToBlob_DoUpload((IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE_DATA*)handle, destinationFileName, NULL, 0, getDataCallback, context);
+
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_034: [ When the upload has finished, IoTHubClient_LL_UploadMultipleBlocksToBlob shall call getDataCallback with FILE_UPLOAD_OK if it succeeds and FILE_UPLOAD_ERROR otherwise, NULL data and size and context. ]*/
+        getDataCallback((result == IOTHUB_CLIENT_OK) ? FILE_UPLOAD_OK : FILE_UPLOAD_ERROR, NULL, NULL, context);
     }
     return result;
 }
@@ -951,6 +1446,7 @@ void IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE h
                 break;
             }
         }
+        DestroyCheckpoint(handleData); /*not discarded: the application may have persisted it to resume the upload after a restart*/
         free((void*)handleData->hostname);
         STRING_delete(handleData->deviceId);
         if (handleData->certificates != NULL)
@@ -1064,6 +1560,79 @@ IOTHUB_CLIENT_RESULT IoTHubClient_LL_UploadToBlob_SetOption(IOTHUB_CLIENT_LL_UPL
                 }
             }
         }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_038: [ blob_upload_concurrency - value is a pointer to a size_t, the number of blocks uploaded at the same time. If it is 0 then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        else if (strcmp(OPTION_BLOB_UPLOAD_CONCURRENCY, optionName) == 0)
+        {
+            if ((value == NULL) || (*(const size_t*)value == 0))
+            {
+                LogError("invalid value for %s", OPTION_BLOB_UPLOAD_CONCURRENCY);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->blobUploadConcurrency = *(const size_t*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_039: [ blob_upload_block_size - value is a pointer to a size_t, the size in bytes of the blocks. If it is 0 or bigger than BLOB_BLOCK_SIZE_MAX then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        else if (strcmp(OPTION_BLOB_UPLOAD_BLOCK_SIZE, optionName) == 0)
+        {
+            if ((value == NULL) || (*(const size_t*)value == 0) || (*(const size_t*)value > BLOB_BLOCK_SIZE_MAX))
+            {
+                LogError("invalid value for %s", OPTION_BLOB_UPLOAD_BLOCK_SIZE);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->blobUploadBlockSize = *(const size_t*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_040: [ blob_upload_resumable - value is a pointer to a bool. When true, a failed upload is resumed by the next IoTHubClient_LL_UploadToBlob of the same destinationFileName and size. Setting it to false discards any saved upload. If value is NULL then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+        else if (strcmp(OPTION_BLOB_UPLOAD_RESUMABLE, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("invalid value for %s", OPTION_BLOB_UPLOAD_RESUMABLE);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->blobUploadResumable = *(const bool*)value;
+                if (!handleData->blobUploadResumable)
+                {
+                    DiscardCheckpoint(handleData);
+                }
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_053: [ `blob_upload_checkpoint_hook` - `value` is a pointer to an `IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_HOOK`, which is copied. If `value` is `NULL` then `IoTHubClient_LL_UploadToBlob_SetOption` shall return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+        else if (strcmp(OPTION_BLOB_UPLOAD_CHECKPOINT_HOOK, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("invalid value for %s", OPTION_BLOB_UPLOAD_CHECKPOINT_HOOK);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                handleData->checkpointHook = *(const IOTHUB_CLIENT_FILE_UPLOAD_CHECKPOINT_HOOK*)value;
+                result = IOTHUB_CLIENT_OK;
+            }
+        }
+        /*Codes_SRS_IOTHUBCLIENT_LL_09_054: [ `blob_upload_checkpoint` - `value` is a JSON string given to the callback of `blob_upload_checkpoint_hook`. It shall replace any saved upload. If `value` is `NULL` or is not a saved upload then `IoTHubClient_LL_UploadToBlob_SetOption` shall return `IOTHUB_CLIENT_INVALID_ARG`; if it cannot be saved then `IoTHubClient_LL_UploadToBlob_SetOption` shall return `IOTHUB_CLIENT_ERROR`. ]*/
+        else if (strcmp(OPTION_BLOB_UPLOAD_CHECKPOINT, optionName) == 0)
+        {
+            if (value == NULL)
+            {
+                LogError("invalid value for %s", OPTION_BLOB_UPLOAD_CHECKPOINT);
+                result = IOTHUB_CLIENT_INVALID_ARG;
+            }
+            else
+            {
+                result = ImportCheckpoint(handleData, (const char*)value);
+            }
+        }
         else
         {
             /*Codes_SRS_IOTHUBCLIENT_LL_02_102: [ If an unknown option is presented then IoTHubClient_LL_UploadToBlob_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
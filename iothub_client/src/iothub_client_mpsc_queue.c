@@ -0,0 +1,266 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/optimize_size.h"
+#include "azure_c_shared_utility/xlogging.h"
+
+#include "iothub_client_mpsc_queue.h"
+
+// Producers only ever push onto the head, and the consumer only ever takes the whole list at once, so a single
+// compare-and-swap on the head is enough and there is no ABA problem (a node is never popped while another
+// producer may still be comparing against it).
+#if defined(_MSC_VER)
+#include <windows.h>
+#define MPSC_QUEUE_COMPARE_AND_SWAP(destination, comparand, exchange) (InterlockedCompareExchangePointer((PVOID volatile*)(destination), (PVOID)(exchange), (PVOID)(comparand)) == (PVOID)(comparand))
+#elif defined(__GNUC__)
+#define MPSC_QUEUE_COMPARE_AND_SWAP(destination, comparand, exchange) __sync_bool_compare_and_swap((destination), (comparand), (exchange))
+#else
+// No compare-and-swap available; the head is guarded by a lock of its own, still never the client lock.
+#define MPSC_QUEUE_USE_LOCK
+#include "azure_c_shared_utility/lock.h"
+#endif
+
+typedef struct MPSC_QUEUE_NODE_TAG
+{
+    void* item;
+    struct MPSC_QUEUE_NODE_TAG* next;
+} MPSC_QUEUE_NODE;
+
+typedef struct MPSC_QUEUE_INSTANCE_TAG
+{
+    MPSC_QUEUE_NODE* volatile head;             // Most recently pushed node first.
+#ifdef MPSC_QUEUE_USE_LOCK
+    LOCK_HANDLE lock;
+#endif
+} MPSC_QUEUE_INSTANCE;
+
+
+// ========== Helper Functions ========== //
+
+#ifdef MPSC_QUEUE_USE_LOCK
+static int push_node(MPSC_QUEUE_INSTANCE* queue, MPSC_QUEUE_NODE* node, bool* was_empty)
+{
+    int result;
+
+    if (Lock(queue->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the queue head");
+        result = __FAILURE__;
+    }
+    else
+    {
+        *was_empty = (queue->head == NULL);
+        node->next = queue->head;
+        queue->head = node;
+        (void)Unlock(queue->lock);
+        result = 0;
+    }
+
+    return result;
+}
+
+static MPSC_QUEUE_NODE* take_all_nodes(MPSC_QUEUE_INSTANCE* queue)
+{
+    MPSC_QUEUE_NODE* result;
+
+    if (Lock(queue->lock) != LOCK_OK)
+    {
+        LogError("Failed locking the queue head");
+        result = NULL;
+    }
+    else
+    {
+        result = queue->head;
+        queue->head = NULL;
+        (void)Unlock(queue->lock);
+    }
+
+    return result;
+}
+#else
+// Once the node is linked the consumer may detach and free it at any time, so it must not be read after the swap.
+static int push_node(MPSC_QUEUE_INSTANCE* queue, MPSC_QUEUE_NODE* node, bool* was_empty)
+{
+    MPSC_QUEUE_NODE* head;
+
+    do
+    {
+        // A stale read is fine here, the compare-and-swap only succeeds if the head is still the one that was read.
+        head = queue->head;
+        node->next = head;
+    } while (!MPSC_QUEUE_COMPARE_AND_SWAP(&queue->head, head, node));
+
+    *was_empty = (head == NULL);
+
+    return 0;
+}
+
+static MPSC_QUEUE_NODE* take_all_nodes(MPSC_QUEUE_INSTANCE* queue)
+{
+    MPSC_QUEUE_NODE* result;
+
+    do
+    {
+        result = queue->head;
+    } while (result != NULL && !MPSC_QUEUE_COMPARE_AND_SWAP(&queue->head, result, NULL));
+
+    return result;
+}
+#endif
+
+static MPSC_QUEUE_NODE* reverse_nodes(MPSC_QUEUE_NODE* node)
+{
+    MPSC_QUEUE_NODE* result = NULL;
+
+    while (node != NULL)
+    {
+        MPSC_QUEUE_NODE* next_node = node->next;
+        node->next = result;
+        result = node;
+        node = next_node;
+    }
+
+    return result;
+}
+
+
+// ========== Public API ========== //
+
+MPSC_QUEUE_HANDLE mpsc_queue_create(void)
+{
+    MPSC_QUEUE_INSTANCE* result;
+
+    // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_001: [`mpsc_queue_create` shall allocate memory for the queue and initialize it empty]
+    if ((result = (MPSC_QUEUE_INSTANCE*)malloc(sizeof(MPSC_QUEUE_INSTANCE))) == NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_002: [If any allocation fails, `mpsc_queue_create` shall free what it allocated and return NULL]
+        LogError("Failed creating the queue (malloc failed)");
+    }
+    else
+    {
+        result->head = NULL;
+
+#ifdef MPSC_QUEUE_USE_LOCK
+        if ((result->lock = Lock_Init()) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_002: [If any allocation fails, `mpsc_queue_create` shall free what it allocated and return NULL]
+            LogError("Failed creating the queue (Lock_Init failed)");
+            free(result);
+            result = NULL;
+        }
+#endif
+    }
+
+    return result;
+}
+
+int mpsc_queue_push(MPSC_QUEUE_HANDLE queue, void* item, bool* was_empty)
+{
+    int result;
+
+    // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_003: [If `queue` or `item` are NULL, `mpsc_queue_push` shall fail and return non-zero]
+    if (queue == NULL || item == NULL)
+    {
+        LogError("Invalid argument (queue=%p, item=%p)", queue, item);
+        result = __FAILURE__;
+    }
+    else
+    {
+        MPSC_QUEUE_NODE* node;
+
+        // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_004: [`mpsc_queue_push` shall allocate a node holding `item`]
+        if ((node = (MPSC_QUEUE_NODE*)malloc(sizeof(MPSC_QUEUE_NODE))) == NULL)
+        {
+            // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_005: [If allocating or linking the node fails, `mpsc_queue_push` shall free what it allocated and return non-zero]
+            LogError("Failed pushing item to the queue (malloc failed)");
+            result = __FAILURE__;
+        }
+        else
+        {
+            bool queue_was_empty;
+
+            node->item = item;
+
+            // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_006: [`mpsc_queue_push` shall link the node as the new head of the queue with an atomic compare-and-swap, retrying while other threads change the head]
+            if (push_node(queue, node, &queue_was_empty) != 0)
+            {
+                // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_005: [If allocating or linking the node fails, `mpsc_queue_push` shall free what it allocated and return non-zero]
+                LogError("Failed pushing item to the queue");
+                free(node);
+                result = __FAILURE__;
+            }
+            else
+            {
+                // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_007: [If `was_empty` is not NULL, it shall be set to true if the queue had no items before the push, false otherwise]
+                if (was_empty != NULL)
+                {
+                    *was_empty = queue_was_empty;
+                }
+
+                // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_008: [If no failures occur, `mpsc_queue_push` shall return 0]
+                result = 0;
+            }
+        }
+    }
+
+    return result;
+}
+
+size_t mpsc_queue_drain(MPSC_QUEUE_HANDLE queue, MPSC_QUEUE_ON_ITEM on_item, void* context)
+{
+    size_t result;
+
+    // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_009: [If `queue` or `on_item` are NULL, `mpsc_queue_drain` shall return 0]
+    if (queue == NULL || on_item == NULL)
+    {
+        LogError("Invalid argument (queue=%p, on_item=%p)", queue, on_item);
+        result = 0;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_010: [`mpsc_queue_drain` shall atomically detach all the nodes from the queue]
+        // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_011: [`mpsc_queue_drain` shall invoke `on_item` with `context` for each detached item, in the order they were pushed, and free its node]
+        MPSC_QUEUE_NODE* node = reverse_nodes(take_all_nodes(queue));
+
+        result = 0;
+
+        while (node != NULL)
+        {
+            MPSC_QUEUE_NODE* next_node = node->next;
+
+            on_item(context, node->item);
+            free(node);
+
+            node = next_node;
+            result++;
+        }
+    }
+
+    // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_012: [`mpsc_queue_drain` shall return the number of items passed to `on_item`]
+    return result;
+}
+
+void mpsc_queue_destroy(MPSC_QUEUE_HANDLE queue)
+{
+    // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_013: [If `queue` is NULL, `mpsc_queue_destroy` shall return]
+    if (queue != NULL)
+    {
+        // Codes_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_014: [`mpsc_queue_destroy` shall free all the remaining nodes and the queue itself; the queued items are not touched]
+        MPSC_QUEUE_NODE* node = queue->head;
+
+        while (node != NULL)
+        {
+            MPSC_QUEUE_NODE* next_node = node->next;
+            free(node);
+            node = next_node;
+        }
+
+#ifdef MPSC_QUEUE_USE_LOCK
+        (void)Lock_Deinit(queue->lock);
+#endif
+        free(queue);
+    }
+}
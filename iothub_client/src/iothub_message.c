@@ -6,6 +6,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/buffer_.h"
+#include "azure_c_shared_utility/refcount.h"
 
 #include "iothub_message.h"
 
@@ -15,6 +16,16 @@ DEFINE_ENUM_STRINGS(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_CONTENT_TYPE_VALUE
 #define LOG_IOTHUB_MESSAGE_ERROR() \
     LogError("(result = %s)", ENUM_TO_STRING(IOTHUB_MESSAGE_RESULT, result));
 
+typedef struct BORROWED_BYTE_ARRAY_TAG
+{
+    const unsigned char* buffer;
+    size_t size;
+    IOTHUB_MESSAGE_RELEASE_CALLBACK releaseCallback;
+    void* releaseContext;
+}BORROWED_BYTE_ARRAY;
+
+DEFINE_REFCOUNT_TYPE(BORROWED_BYTE_ARRAY);
+
 typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
 {
     IOTHUBMESSAGE_CONTENT_TYPE contentType;
@@ -23,6 +34,8 @@ typedef struct IOTHUB_MESSAGE_HANDLE_DATA_TAG
         BUFFER_HANDLE byteArray;
         STRING_HANDLE string;
     } value;
+    /*when not NULL the payload is owned by the caller and value.byteArray is not used*/
+    BORROWED_BYTE_ARRAY* borrowed;
     MAP_HANDLE properties;
     char* messageId;
     char* correlationId;
@@ -60,6 +73,19 @@ static int ValidateAsciiCharactersFilter(const char* mapKey, const char* mapValu
     return result;
 }
 
+static void release_borrowed_byte_array(BORROWED_BYTE_ARRAY* borrowed)
+{
+    if (DEC_REF(BORROWED_BYTE_ARRAY, borrowed) == DEC_RETURN_ZERO)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_09_007: [When the last message referencing the borrowed buffer is destroyed, IoTHubMessage_Destroy shall invoke releaseCallback (if not NULL) passing byteArray and releaseContext.] */
+        if (borrowed->releaseCallback != NULL)
+        {
+            borrowed->releaseCallback(borrowed->buffer, borrowed->releaseContext);
+        }
+        free(borrowed);
+    }
+}
+
 IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byteArray, size_t size)
 {
     IOTHUB_MESSAGE_HANDLE_DATA* result;
@@ -125,6 +151,7 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byt
                     /*Codes_SRS_IOTHUBMESSAGE_02_025: [Otherwise, IoTHubMessage_CreateFromByteArray shall return a non-NULL handle.] */
                     /*Codes_SRS_IOTHUBMESSAGE_02_026: [The type of the new message shall be IOTHUBMESSAGE_BYTEARRAY.] */
                     result->contentType = IOTHUBMESSAGE_BYTEARRAY;
+                    result->borrowed = NULL;
                     result->messageId = NULL;
                     result->correlationId = NULL;
                     /*all is fine, return result*/
@@ -135,6 +162,52 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArray(const unsigned char* byt
     return result;
 }
 
+IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromByteArrayNoCopy(const unsigned char* byteArray, size_t size, IOTHUB_MESSAGE_RELEASE_CALLBACK releaseCallback, void* releaseContext)
+{
+    IOTHUB_MESSAGE_HANDLE_DATA* result;
+    /*Codes_SRS_IOTHUBMESSAGE_09_001: [If size is NOT zero and byteArray is NULL, IoTHubMessage_CreateFromByteArrayNoCopy shall fail and return NULL.] */
+    if ((size != 0) && (byteArray == NULL))
+    {
+        LogError("Attempted to create a Hub Message from a NULL pointer!");
+        result = NULL;
+    }
+    else if ((result = (IOTHUB_MESSAGE_HANDLE_DATA*)malloc(sizeof(IOTHUB_MESSAGE_HANDLE_DATA))) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_09_005: [If there are any errors then IoTHubMessage_CreateFromByteArrayNoCopy shall return NULL and shall not invoke releaseCallback.] */
+        LogError("unable to malloc");
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_09_002: [IoTHubMessage_CreateFromByteArrayNoCopy shall not copy byteArray; it shall keep byteArray, size, releaseCallback and releaseContext in a reference counted record.] */
+    else if ((result->borrowed = REFCOUNT_TYPE_CREATE(BORROWED_BYTE_ARRAY)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_09_005: [If there are any errors then IoTHubMessage_CreateFromByteArrayNoCopy shall return NULL and shall not invoke releaseCallback.] */
+        LogError("unable to allocate the borrowed buffer record");
+        free(result);
+        result = NULL;
+    }
+    /*Codes_SRS_IOTHUBMESSAGE_09_003: [IoTHubMessage_CreateFromByteArrayNoCopy shall call Map_Create to create the message properties.] */
+    else if ((result->properties = Map_Create(ValidateAsciiCharactersFilter)) == NULL)
+    {
+        /*Codes_SRS_IOTHUBMESSAGE_09_005: [If there are any errors then IoTHubMessage_CreateFromByteArrayNoCopy shall return NULL and shall not invoke releaseCallback.] */
+        LogError("Map_Create failed");
+        free(result->borrowed);
+        free(result);
+        result = NULL;
+    }
+    else
+    {
+        result->borrowed->buffer = byteArray;
+        result->borrowed->size = size;
+        result->borrowed->releaseCallback = releaseCallback;
+        result->borrowed->releaseContext = releaseContext;
+        /*Codes_SRS_IOTHUBMESSAGE_09_004: [Otherwise IoTHubMessage_CreateFromByteArrayNoCopy shall return a non-NULL handle of type IOTHUBMESSAGE_BYTEARRAY.] */
+        result->contentType = IOTHUBMESSAGE_BYTEARRAY;
+        result->value.byteArray = NULL;
+        result->messageId = NULL;
+        result->correlationId = NULL;
+    }
+    return result;
+}
+
 IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source)
 {
     IOTHUB_MESSAGE_HANDLE_DATA* result;
@@ -176,6 +249,7 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_CreateFromString(const char* source)
                 /*Codes_SRS_IOTHUBMESSAGE_02_031: [Otherwise, IoTHubMessage_CreateFromString shall return a non-NULL handle.] */
                 /*Codes_SRS_IOTHUBMESSAGE_02_032: [The type of the new message shall be IOTHUBMESSAGE_STRING.] */
                 result->contentType = IOTHUBMESSAGE_STRING;
+                result->borrowed = NULL;
                 result->messageId = NULL;
                 result->correlationId = NULL;
             }
@@ -209,6 +283,7 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
         {
             result->messageId = NULL;
             result->correlationId = NULL;
+            result->borrowed = NULL;
             if (source->messageId != NULL && mallocAndStrcpy_s(&result->messageId, source->messageId) != 0)
             {
                 LogError("unable to Copy messageId");
@@ -226,6 +301,36 @@ IOTHUB_MESSAGE_HANDLE IoTHubMessage_Clone(IOTHUB_MESSAGE_HANDLE iotHubMessageHan
                 free(result);
                 result = NULL;
             }
+            else if ((source->contentType == IOTHUBMESSAGE_BYTEARRAY) && (source->borrowed != NULL))
+            {
+                /*Codes_SRS_IOTHUBMESSAGE_09_006: [If iotHubMessageHandle was created by IoTHubMessage_CreateFromByteArrayNoCopy, IoTHubMessage_Clone shall share the borrowed buffer with the clone by incrementing its reference count instead of copying it.] */
+                INC_REF(BORROWED_BYTE_ARRAY, source->borrowed);
+                result->borrowed = source->borrowed;
+                result->value.byteArray = NULL;
+                /*Codes_SRS_IOTHUBMESSAGE_02_005: [IoTHubMessage_Clone shall clone the properties map by using Map_Clone.] */
+                if ((result->properties = Map_Clone(source->properties)) == NULL)
+                {
+                    /*Codes_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+                    LogError("unable to Map_Clone");
+                    release_borrowed_byte_array(result->borrowed);
+                    if (result->messageId)
+                    {
+                        free(result->messageId);
+                        result->messageId = NULL;
+                    }
+                    if (result->correlationId != NULL)
+                    {
+                        free(result->correlationId);
+                        result->correlationId = NULL;
+                    }
+                    free(result);
+                    result = NULL;
+                }
+                else
+                {
+                    result->contentType = IOTHUBMESSAGE_BYTEARRAY;
+                }
+            }
             else if (source->contentType == IOTHUBMESSAGE_BYTEARRAY)
             {
                 /*Codes_SRS_IOTHUBMESSAGE_02_006: [IoTHubMessage_Clone shall clone to content by a call to BUFFER_clone] */
@@ -344,6 +449,13 @@ IOTHUB_MESSAGE_RESULT IoTHubMessage_GetByteArray(IOTHUB_MESSAGE_HANDLE iotHubMes
             result = IOTHUB_MESSAGE_INVALID_ARG;
             LogError("invalid type of message %s", ENUM_TO_STRING(IOTHUBMESSAGE_CONTENT_TYPE, handleData->contentType));
         }
+        else if (handleData->borrowed != NULL)
+        {
+            /*Codes_SRS_IOTHUBMESSAGE_09_008: [If the message borrows its payload, IoTHubMessage_GetByteArray shall return the byteArray and size given to IoTHubMessage_CreateFromByteArrayNoCopy.] */
+            *buffer = handleData->borrowed->buffer;
+            *size = handleData->borrowed->size;
+            result = IOTHUB_MESSAGE_OK;
+        }
         else
         {
             /*Codes_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using BUFFER_u_char and it shall be copied in the buffer argument.]*/
@@ -524,7 +636,14 @@ void IoTHubMessage_Destroy(IOTHUB_MESSAGE_HANDLE iotHubMessageHandle)
         IOTHUB_MESSAGE_HANDLE_DATA* handleData = iotHubMessageHandle;
         if (handleData->contentType == IOTHUBMESSAGE_BYTEARRAY)
         {
-            BUFFER_delete(handleData->value.byteArray);
+            if (handleData->borrowed != NULL)
+            {
+                release_borrowed_byte_array(handleData->borrowed);
+            }
+            else
+            {
+                BUFFER_delete(handleData->value.byteArray);
+            }
         }
         else if (handleData->contentType == IOTHUBMESSAGE_STRING)
         {
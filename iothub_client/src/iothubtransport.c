@@ -5,12 +5,14 @@
 #include "azure_c_shared_utility/gballoc.h"
 #include <signal.h>
 #include <stddef.h>
+#include <limits.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "iothubtransport.h"
 #include "iothub_client.h"
 #include "iothub_client_private.h"
 #include "azure_c_shared_utility/threadapi.h"
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/vector.h"
 
@@ -24,8 +26,14 @@ typedef struct TRANSPORT_HANDLE_DATA_TAG
     VECTOR_HANDLE clients;
     LOCK_HANDLE clientsLockHandle;
     IOTHUB_CLIENT_MULTIPLEXED_DO_WORK clientDoWork;
+    COND_HANDLE workerCondition; /* signaled when there is work for the worker thread, waited on with lockHandle held */
+    sig_atomic_t workPending;
+    unsigned int doWorkFrequencyInMs;
 } TRANSPORT_HANDLE_DATA;
 
+/*longest wait of an idle worker thread; incoming data is read by the next DoWork and can wait this long (OPTION_DO_WORK_FREQUENCY_IN_MS trades it for idle CPU)*/
+#define DEFAULT_DO_WORK_FREQUENCY_IN_MS 100
+
 /* Used for Unit test */
 const size_t IoTHubTransport_ThreadTerminationOffset = offsetof(TRANSPORT_HANDLE_DATA, stopThread);
 
@@ -116,6 +124,9 @@ TRANSPORT_HANDLE  IoTHubTransport_Create(IOTHUB_CLIENT_TRANSPORT_PROVIDER protoc
                         result->stopThread = 1;
                         result->clientDoWork = NULL;
                         result->workerThreadHandle = NULL; /* create thread when work needs to be done */
+                        result->workerCondition = NULL; /* created together with the thread */
+                        result->workPending = 0;
+                        result->doWorkFrequencyInMs = DEFAULT_DO_WORK_FREQUENCY_IN_MS;
                         result->IoTHubTransport_GetHostname = transportProtocol->IoTHubTransport_GetHostname;
                         result->IoTHubTransport_SetOption = transportProtocol->IoTHubTransport_SetOption;
                         result->IoTHubTransport_Create = transportProtocol->IoTHubTransport_Create;
@@ -127,6 +138,7 @@ TRANSPORT_HANDLE  IoTHubTransport_Create(IOTHUB_CLIENT_TRANSPORT_PROVIDER protoc
                         result->IoTHubTransport_DoWork = transportProtocol->IoTHubTransport_DoWork;
                         result->IoTHubTransport_SetRetryPolicy = transportProtocol->IoTHubTransport_SetRetryPolicy;
                         result->IoTHubTransport_GetSendStatus = transportProtocol->IoTHubTransport_GetSendStatus;
+                        result->IoTHubTransport_GetStatistics = transportProtocol->IoTHubTransport_GetStatistics;
                     }
                 }
             }
@@ -136,8 +148,11 @@ TRANSPORT_HANDLE  IoTHubTransport_Create(IOTHUB_CLIENT_TRANSPORT_PROVIDER protoc
     return result;
 }
 
-static void multiplexed_client_do_work(TRANSPORT_HANDLE_DATA* transportData)
+/* returns the shortest time the clients can wait before their next DoWork */
+static unsigned int multiplexed_client_do_work(TRANSPORT_HANDLE_DATA* transportData)
 {
+    unsigned int result = UINT_MAX;
+
     if (Lock(transportData->clientsLockHandle) != LOCK_OK)
     {
         LogError("failed to lock for multiplexed_client_do_work");
@@ -154,7 +169,11 @@ static void multiplexed_client_do_work(TRANSPORT_HANDLE_DATA* transportData)
 
             if (clientHandle != NULL)
             {
-                transportData->clientDoWork(*clientHandle);
+                unsigned int clientWaitTimeInMs = transportData->clientDoWork(*clientHandle);
+                if (clientWaitTimeInMs < result)
+                {
+                    result = clientWaitTimeInMs;
+                }
             }
         }
 
@@ -163,6 +182,33 @@ static void multiplexed_client_do_work(TRANSPORT_HANDLE_DATA* transportData)
             LogError("failed to unlock on multiplexed_client_do_work");
         }
     }
+
+    return result;
+}
+
+static void wait_for_work(TRANSPORT_HANDLE_DATA* transportData, unsigned int clientsWaitTimeInMs)
+{
+    if (Lock(transportData->lockHandle) != LOCK_OK)
+    {
+        LogError("failed to lock for wait_for_work");
+        ThreadAPI_Sleep(DEFAULT_DO_WORK_FREQUENCY_IN_MS);
+    }
+    else
+    {
+        /*Codes_SRS_IOTHUBTRANSPORT_17_029: [ The thread shall wait on the worker condition for at most the DoWork frequency (100 ms by default) before calling lower layer transport DoWork again. ]*/
+        /*Codes_SRS_IOTHUBTRANSPORT_09_001: [ If work was signaled by IoTHubTransport_WakeWorkerThread since the last DoWork, the thread shall not wait. ]*/
+        if ((transportData->stopThread == 0) && (transportData->workPending == 0))
+        {
+            /*Codes_SRS_IOTHUBTRANSPORT_09_008: [ The thread shall not wait longer than the shortest time returned by the clients' multiplexed DoWork functions, and shall not wait at all if that time is 0. ]*/
+            unsigned int waitTimeInMs = (clientsWaitTimeInMs < transportData->doWorkFrequencyInMs) ? clientsWaitTimeInMs : transportData->doWorkFrequencyInMs;
+            if (waitTimeInMs > 0)
+            {
+                (void)Condition_Wait(transportData->workerCondition, transportData->lockHandle, (int)waitTimeInMs);
+            }
+        }
+
+        (void)Unlock(transportData->lockHandle);
+    }
 }
 
 static int transport_worker_thread(void* threadArgument)
@@ -183,16 +229,15 @@ static int transport_worker_thread(void* threadArgument)
             }
             else
             {
+                /*whatever was signaled so far is going to be picked up by this DoWork*/
+                transportData->workPending = 0;
                 (transportData->IoTHubTransport_DoWork)(transportData->transportLLHandle, NULL);
 
                 (void)Unlock(transportData->lockHandle);
             }
         }
 
-        multiplexed_client_do_work(transportData);
-
-        /*Codes_SRS_IOTHUBTRANSPORT_17_029: [ The thread shall call lower layer transport DoWork every 1 ms. ]*/
-        ThreadAPI_Sleep(1);
+        wait_for_work(transportData, multiplexed_client_do_work(transportData));
     }
 
     return 0;
@@ -211,11 +256,22 @@ static IOTHUB_CLIENT_RESULT start_worker_if_needed(TRANSPORT_HANDLE_DATA * trans
     IOTHUB_CLIENT_RESULT result;
     if (transportData->workerThreadHandle == NULL)
     {
-        /*Codes_SRS_IOTHUBTRANSPORT_17_018: [ If the worker thread does not exist, IoTHubTransport_StartWorkerThread shall start the thread using ThreadAPI_Create. ]*/
-        transportData->stopThread = 0;
-        if (ThreadAPI_Create(&transportData->workerThreadHandle, transport_worker_thread, transportData) != THREADAPI_OK)
+        /*Codes_SRS_IOTHUBTRANSPORT_09_002: [ Before starting the worker thread, IoTHubTransport_StartWorkerThread shall create the worker condition by calling Condition_Init. ]*/
+        if ((transportData->workerCondition == NULL) &&
+            ((transportData->workerCondition = Condition_Init()) == NULL))
         {
-            transportData->workerThreadHandle = NULL;
+            /*Codes_SRS_IOTHUBTRANSPORT_09_003: [ If Condition_Init fails, IoTHubTransport_StartWorkerThread shall return IOTHUB_CLIENT_ERROR. ]*/
+            LogError("failed creating the worker condition");
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBTRANSPORT_17_018: [ If the worker thread does not exist, IoTHubTransport_StartWorkerThread shall start the thread using ThreadAPI_Create. ]*/
+            transportData->stopThread = 0;
+            transportData->workPending = 0;
+            if (ThreadAPI_Create(&transportData->workerThreadHandle, transport_worker_thread, transportData) != THREADAPI_OK)
+            {
+                transportData->workerThreadHandle = NULL;
+            }
         }
     }
     if (transportData->workerThreadHandle != NULL)
@@ -265,6 +321,11 @@ static void stop_worker_thread(TRANSPORT_HANDLE_DATA * transportData)
 {
     /*Codes_SRS_IOTHUBTRANSPORT_17_043: [** IoTHubTransport_SignalEndWorkerThread shall signal the worker thread to end.*/
     transportData->stopThread = 1;
+    if (transportData->workerCondition != NULL)
+    {
+        /*do not let the thread sit in its wait for the rest of the period*/
+        (void)Condition_Post(transportData->workerCondition);
+    }
 }
 
 static void wait_worker_thread(TRANSPORT_HANDLE_DATA * transportData)
@@ -350,6 +411,10 @@ void IoTHubTransport_Destroy(TRANSPORT_HANDLE transportHandle)
         (transportData->IoTHubTransport_Destroy)(transportData->transportLLHandle);
         VECTOR_destroy(transportData->clients);
         Lock_Deinit(transportData->clientsLockHandle);
+        if (transportData->workerCondition != NULL)
+        {
+            Condition_Deinit(transportData->workerCondition);
+        }
         free(transportHandle);
     }
 }
@@ -448,3 +513,50 @@ void IoTHubTransport_JoinWorkerThread(TRANSPORT_HANDLE transportHandle, IOTHUB_C
         wait_worker_thread(transportData);
     }
 }
+
+void IoTHubTransport_WakeWorkerThread(TRANSPORT_HANDLE transportHandle)
+{
+    /*Codes_SRS_IOTHUBTRANSPORT_09_004: [ If transportHandle is NULL, IoTHubTransport_WakeWorkerThread shall do nothing. ]*/
+    if (transportHandle != NULL)
+    {
+        TRANSPORT_HANDLE_DATA * transportData = (TRANSPORT_HANDLE_DATA*)transportHandle;
+        /*Codes_SRS_IOTHUBTRANSPORT_09_005: [ If the worker thread exists, IoTHubTransport_WakeWorkerThread shall mark work as pending and signal the worker condition by calling Condition_Post. ]*/
+        if (transportData->workerCondition != NULL)
+        {
+            transportData->workPending = 1;
+            if (Condition_Post(transportData->workerCondition) != COND_OK)
+            {
+                LogError("Condition_Post failed, worker thread will pick up the work on its next period");
+            }
+        }
+    }
+}
+
+IOTHUB_CLIENT_RESULT IoTHubTransport_SetDoWorkFrequency(TRANSPORT_HANDLE transportHandle, unsigned int doWorkFrequencyInMs)
+{
+    IOTHUB_CLIENT_RESULT result;
+    /*Codes_SRS_IOTHUBTRANSPORT_09_006: [ If transportHandle is NULL or doWorkFrequencyInMs is 0, IoTHubTransport_SetDoWorkFrequency shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+    if (transportHandle == NULL || doWorkFrequencyInMs == 0)
+    {
+        LogError("Invalid argument, transportHandle [%p], doWorkFrequencyInMs [%u].", transportHandle, doWorkFrequencyInMs);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        TRANSPORT_HANDLE_DATA * transportData = (TRANSPORT_HANDLE_DATA*)transportHandle;
+        /*Codes_SRS_IOTHUBTRANSPORT_09_009: [ IoTHubTransport_SetDoWorkFrequency shall take the lock created in IoTHubTransport_Create while it changes the frequency; if acquiring the lock fails it shall return IOTHUB_CLIENT_ERROR. ]*/
+        if (Lock(transportData->lockHandle) != LOCK_OK)
+        {
+            LogError("failed to lock for IoTHubTransport_SetDoWorkFrequency");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            /*Codes_SRS_IOTHUBTRANSPORT_09_007: [ IoTHubTransport_SetDoWorkFrequency shall set the longest time the worker thread waits between two calls to DoWork and return IOTHUB_CLIENT_OK. ]*/
+            transportData->doWorkFrequencyInMs = doWorkFrequencyInMs;
+            (void)Unlock(transportData->lockHandle);
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+    return result;
+}
@@ -39,6 +39,8 @@ typedef struct AUTHENTICATION_INSTANCE_TAG
     bool is_sas_token_refresh_in_progress;
 
     time_t current_sas_token_put_time;
+    size_t current_sas_token_refresh_time_secs;
+    uint64_t sas_token_refresh_count;
 
     // Auth module used to generating handle authorization
     // with either SAS Token, x509 Certs, and Device SAS Token
@@ -142,7 +144,7 @@ static int verify_sas_token_refresh_timeout(AUTHENTICATION_INSTANCE* instance, b
             result = __FAILURE__;
             LogError("Failed verifying if SAS token refresh timed out (get_time failed)");
         }
-        else if ((uint32_t)get_difftime(current_time, instance->current_sas_token_put_time) >= instance->sas_token_refresh_time_secs)
+        else if ((uint32_t)get_difftime(current_time, instance->current_sas_token_put_time) >= instance->current_sas_token_refresh_time_secs)
         {
             *is_timed_out = true;
             result = RESULT_OK;
@@ -205,7 +207,7 @@ static void on_cbs_put_token_complete_callback(void* context, CBS_OPERATION_RESU
     instance->is_sas_token_refresh_in_progress = false;
 }
 
-static int put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance, STRING_HANDLE cbs_audience, char* sas_token)
+static int put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance, STRING_HANDLE cbs_audience, const char* sas_token)
 {
     int result;
 
@@ -241,6 +243,9 @@ static int put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance, STRING_HANDLE
 
         instance->current_sas_token_put_time = current_time; // If it failed, fear not. `current_sas_token_put_time` shall be checked for INDEFINITE_TIME wherever it is used.
 
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_129: [If cbs_put_token_async() succeeds, authentication_do_work() shall set `instance->current_sas_token_refresh_time_secs` with IoTHubClient_Auth_Get_SasToken_Refresh_Time() applied to `instance->sas_token_refresh_time_secs`]
+        instance->current_sas_token_refresh_time_secs = IoTHubClient_Auth_Get_SasToken_Refresh_Time(instance->authorization_module, instance->sas_token_refresh_time_secs);
+
         result = RESULT_OK;
     }
 
@@ -250,7 +255,7 @@ static int put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance, STRING_HANDLE
 static int create_and_put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance)
 {
     int result;
-    char* sas_token;
+    const char* sas_token;
     STRING_HANDLE devices_path;
 
     if ((devices_path = create_devices_path(instance->iothub_host_fqdn, instance->device_id)) == NULL)
@@ -282,8 +287,8 @@ static int create_and_put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance)
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_070: [The SAS token expiration time shall be calculated adding `instance->sas_token_lifetime_secs` to the current number of seconds since epoch time UTC]
                 size_t sas_token_expiration_time_secs = (size_t)seconds_since_epoch + instance->sas_token_lifetime_secs;
 
-                /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using IoTHubClient_Auth_Get_SasToken, unless it has failed previously] */
-                sas_token = IoTHubClient_Auth_Get_SasToken(instance->authorization_module, STRING_c_str(devices_path), sas_token_expiration_time_secs);
+                /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall get a SAS token using IoTHubClient_Auth_Get_Cached_SasToken, unless it has failed previously] */
+                sas_token = IoTHubClient_Auth_Get_Cached_SasToken(instance->authorization_module, STRING_c_str(devices_path), sas_token_expiration_time_secs);
                 if (sas_token == NULL)
                 {
                     LogError("failure getting sas token.");
@@ -313,8 +318,8 @@ static int create_and_put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance)
             }
             else
             {
-                /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using IoTHubClient_Auth_Get_SasToken, unless it has failed previously] */
-                sas_token = IoTHubClient_Auth_Get_SasToken(instance->authorization_module, NULL, 0);
+                /* Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall get a SAS token using IoTHubClient_Auth_Get_Cached_SasToken, unless it has failed previously] */
+                sas_token = IoTHubClient_Auth_Get_Cached_SasToken(instance->authorization_module, NULL, 0);
                 if (sas_token == NULL)
                 {
                     LogError("failure getting sas Token.");
@@ -348,12 +353,17 @@ static int create_and_put_SAS_token_to_cbs(AUTHENTICATION_INSTANCE* instance)
             }
             else
             {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_130: [If cbs_put_token_async() succeeds while `instance->is_sas_token_refresh_in_progress` is TRUE, authentication_do_work() shall increment `instance->sas_token_refresh_count`]
+                if (instance->is_sas_token_refresh_in_progress)
+                {
+                    instance->sas_token_refresh_count++;
+                }
+
                 result = RESULT_OK;
             }
-            free(sas_token);
         }
 
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_081: [authentication_do_work() shall free the memory it allocated for `devices_path`, `sasTokenKeyName` and SAS token]
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_081: [authentication_do_work() shall free the memory it allocated for `devices_path` and `sasTokenKeyName`; the SAS token stays owned by the authorization module]
         STRING_delete(devices_path);
     }
     return result;
@@ -655,7 +665,7 @@ void authentication_do_work(AUTHENTICATION_HANDLE authentication_handle)
             if (IoTHubClient_Auth_Get_Credential_Type(instance->authorization_module) == IOTHUB_CREDENTIAL_TYPE_DEVICE_KEY)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_039: [If `instance->state` is AUTHENTICATION_STATE_STARTED and device keys were used, authentication_do_work() shall only verify the SAS token refresh time]
-                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs`]
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->current_sas_token_refresh_time_secs`]
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_066: [If SAS token does not need to be refreshed, authentication_do_work() shall return]
                 bool is_timed_out;
                 if (verify_sas_token_refresh_timeout(instance, &is_timed_out) == RESULT_OK && is_timed_out)
@@ -827,3 +837,23 @@ OPTIONHANDLER_HANDLE authentication_retrieve_options(AUTHENTICATION_HANDLE authe
     }
     return result;
 }
+
+int authentication_get_sas_token_refresh_count(AUTHENTICATION_HANDLE authentication_handle, uint64_t* sas_token_refresh_count)
+{
+    int result;
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [If `authentication_handle` or `sas_token_refresh_count` is NULL, authentication_get_sas_token_refresh_count shall fail and return a non-zero value]
+    if (authentication_handle == NULL || sas_token_refresh_count == NULL)
+    {
+        LogError("Failed getting the SAS token refresh count (either authentication_handle (%p) or sas_token_refresh_count (%p) is NULL)", authentication_handle, sas_token_refresh_count);
+        result = __FAILURE__;
+    }
+    else
+    {
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_132: [authentication_get_sas_token_refresh_count shall set `sas_token_refresh_count` to `instance->sas_token_refresh_count` and return 0]
+        *sas_token_refresh_count = ((AUTHENTICATION_INSTANCE*)authentication_handle)->sas_token_refresh_count;
+        result = RESULT_OK;
+    }
+
+    return result;
+}
@@ -2,6 +2,7 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <time.h>
@@ -33,6 +34,7 @@
 #include "iothubtransportamqp_methods.h"
 #endif
 #include "iothub_client_retry_control.h"
+#include "iothub_client_device_index.h"
 #include "iothubtransport_amqp_common.h"
 #include "iothubtransport_amqp_connection.h"
 #include "iothubtransport_amqp_device.h"
@@ -81,6 +83,7 @@ typedef struct AMQP_TRANSPORT_INSTANCE_TAG
     AMQP_CONNECTION_STATE amqp_connection_state;                        // Current state of the amqp_connection.
     AMQP_TRANSPORT_AUTHENTICATION_MODE preferred_authentication_mode;   // Used to avoid registered devices using different authentication modes.
     SINGLYLINKEDLIST_HANDLE registered_devices;                         // List of devices currently registered in this transport.
+    DEVICE_INDEX_HANDLE registered_devices_index;                       // Index of `registered_devices` by device id and by device handle.
     bool is_trace_on;                                                   // Turns logging on and off.
     OPTIONHANDLER_HANDLE saved_tls_options;                             // Here are the options from the xio layer if any is saved.
     AMQP_TRANSPORT_STATE state;                                         // Current state of the transport.
@@ -96,6 +99,13 @@ typedef struct AMQP_TRANSPORT_INSTANCE_TAG
     size_t option_sas_token_refresh_time_secs;                          // Device-specific option.
     size_t option_cbs_request_timeout_secs;                             // Device-specific option.
     size_t option_send_event_timeout_secs;                              // Device-specific option.
+    bool option_event_send_batching;                                    // Device-specific option.
+    size_t option_message_pool_size;                                    // Device-specific option.
+    uint64_t reconnect_count;                                           // Number of times the connection was re-established after a failure.
+    size_t device_starts_per_second;                                    // Number of registered devices allowed to start per second; 0 means no limit.
+    double device_start_tokens;                                         // Device starts left in the token bucket that enforces device_starts_per_second.
+    time_t device_start_tokens_time;                                    // Time the token bucket was last refilled; INDEFINITE_TIME if it never was.
+    uint32_t device_start_random_state;                                 // State of the generator that picks the first device admitted to start; 0 until it is seeded.
 
                                                                         // Auth module used to generating handle authorization
     IOTHUB_AUTHORIZATION_HANDLE authorization_module;                   // with either SAS Token, x509 Certs, and Device SAS Token
@@ -107,12 +117,18 @@ typedef struct AMQP_TRANSPORT_DEVICE_INSTANCE_TAG
     DEVICE_HANDLE device_handle;                                        // Logic unit that performs authentication, messaging, etc.
     IOTHUB_CLIENT_LL_HANDLE iothub_client_handle;                       // Saved reference to the IoTHub LL Client.
     AMQP_TRANSPORT_INSTANCE* transport_instance;                        // Saved reference to the transport the device is registered on.
+    LIST_ITEM_HANDLE list_item;                                         // Item of this device in `transport_instance->registered_devices`.
     PDLIST_ENTRY waiting_to_send;                                       // List of events waiting to be sent to the iot hub (i.e., haven't been processed by the transport yet).
     DEVICE_STATE device_state;                                          // Current state of the device_handle instance.
     size_t number_of_previous_failures;                                 // Number of times the device has failed in sequence; this value is reset to 0 if device succeeds to authenticate, send and/or recv messages.
     size_t number_of_send_event_complete_failures;                      // Number of times on_event_send_complete was called in row with an error.
     time_t time_of_last_state_change;                                   // Time the device_handle last changed state; used to track timeouts of device_start_async and device_stop.
     unsigned int max_state_change_timeout_secs;                         // Maximum number of seconds allowed for device_handle to complete start and stop state changes.
+    uint64_t messages_sent;                                             // Number of events handed to device_send_event_async successfully.
+    uint64_t bytes_sent;                                                // Payload bytes of the events counted in `messages_sent`.
+    uint64_t bytes_received;                                            // Payload bytes of the cloud-to-device messages received.
+    size_t messages_in_flight;                                          // Number of events taken from `waiting_to_send` whose on_event_send_complete has not run yet.
+    bool is_start_admitted;                                             // Set when the device got its turn to start (only used if device_starts_per_second is not 0).
 #ifdef WIP_C2D_METHODS_AMQP /* This feature is WIP, do not use yet */
     // the methods portion
     IOTHUBTRANSPORT_AMQP_METHODS_HANDLE methods_handle;                 // Handle to instance of module that deals with device methods for AMQP.
@@ -248,50 +264,11 @@ static void on_device_state_changed_callback(void* context, DEVICE_STATE previou
     }
 }
 
-// @brief    Auxiliary function to be used to find a device in the registered_devices list.
-// @returns  true if the device ids match, false otherwise.
-static bool find_device_by_id_callback(LIST_ITEM_HANDLE list_item, const void* match_context)
-{
-    bool result;
-
-    if (match_context == NULL)
-    {
-        result = false;
-    }
-    else
-    {
-        AMQP_TRANSPORT_DEVICE_INSTANCE* device_instance = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item);
-
-        if (device_instance == NULL || 
-            device_instance->device_id == NULL || 
-            STRING_c_str(device_instance->device_id) != match_context)
-        {
-            result = false;
-        }
-        else
-        {
-            result = true;
-        }
-    }
-
-    return result;
-}
-
-// @brief       Verifies if a device is already registered within the transport that owns the list of registered devices.
-// @remarks     Returns the correspoding LIST_ITEM_HANDLE in registered_devices, if found.
-// @returns     true if the device is already in the list, false otherwise.
-static bool is_device_registered_ex(SINGLYLINKEDLIST_HANDLE registered_devices, const char* device_id, LIST_ITEM_HANDLE *list_item)
-{
-    return ((*list_item = singlylinkedlist_find(registered_devices, find_device_by_id_callback, device_id)) != NULL ? 1 : 0);
-}
-
-// @brief       Verifies if a device is already registered within the transport that owns the list of registered devices.
-// @returns     true if the device is already in the list, false otherwise.
+// @brief       Verifies if a device is registered within the transport it references.
+// @returns     true if the device is in the index of registered devices, false otherwise.
 static bool is_device_registered(AMQP_TRANSPORT_DEVICE_INSTANCE* amqp_device_instance)
 {
-    LIST_ITEM_HANDLE list_item;
-    const char* device_id = STRING_c_str(amqp_device_instance->device_id);
-    return is_device_registered_ex(amqp_device_instance->transport_instance->registered_devices, device_id, &list_item);
+    return device_index_contains(amqp_device_instance->transport_instance->registered_devices_index, amqp_device_instance);
 }
 
 
@@ -375,12 +352,46 @@ static DEVICE_MESSAGE_DISPOSITION_RESULT get_device_disposition_result_from(IOTH
     return device_disposition_result;
 }
 
+// @brief
+//     Gets the size of the payload of a message, as uamqp_messaging puts it in the AMQP message body.
+// @returns
+//     The number of bytes of the payload, or 0 if it cannot be obtained.
+static size_t get_message_payload_size(IOTHUB_MESSAGE_HANDLE message)
+{
+    size_t result = 0;
+    IOTHUBMESSAGE_CONTENT_TYPE content_type = IoTHubMessage_GetContentType(message);
+
+    if (content_type == IOTHUBMESSAGE_BYTEARRAY)
+    {
+        const unsigned char* buffer;
+
+        if (IoTHubMessage_GetByteArray(message, &buffer, &result) != IOTHUB_MESSAGE_OK)
+        {
+            result = 0;
+        }
+    }
+    else if (content_type == IOTHUBMESSAGE_STRING)
+    {
+        const char* string = IoTHubMessage_GetString(message);
+
+        if (string != NULL)
+        {
+            result = strlen(string);
+        }
+    }
+
+    return result;
+}
+
 static DEVICE_MESSAGE_DISPOSITION_RESULT on_message_received(IOTHUB_MESSAGE_HANDLE message, DEVICE_MESSAGE_DISPOSITION_INFO* disposition_info, void* context)
 {
     AMQP_TRANSPORT_DEVICE_INSTANCE* amqp_device_instance = (AMQP_TRANSPORT_DEVICE_INSTANCE*)context;
     DEVICE_MESSAGE_DISPOSITION_RESULT device_disposition_result;
     MESSAGE_CALLBACK_INFO* message_data;
 
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_152: [The payload size of `message` shall be added to the bytes received by the device]
+    amqp_device_instance->bytes_received += get_message_payload_size(message);
+
     if ((message_data = MESSAGE_CALLBACK_INFO_Create(message, disposition_info, amqp_device_instance)) == NULL)
     {
         LogError("Failed processing message received (failed to assemble callback info)");
@@ -688,6 +699,7 @@ static int establish_amqp_connection(AMQP_TRANSPORT_INSTANCE* transport_instance
 
         if (transport_instance->state == AMQP_TRANSPORT_STATE_READY_FOR_RECONNECTION)
         {
+            transport_instance->reconnect_count++;
             update_state(transport_instance, AMQP_TRANSPORT_STATE_RECONNECTING);
         }
         else
@@ -731,6 +743,7 @@ static void prepare_device_for_connection_retry(AMQP_TRANSPORT_DEVICE_INSTANCE*
 
     registered_device->number_of_previous_failures = 0;
     registered_device->number_of_send_event_complete_failures = 0;
+    registered_device->is_start_admitted = false;
 }
 
 static void prepare_for_connection_retry(AMQP_TRANSPORT_INSTANCE* transport_instance)
@@ -820,6 +833,8 @@ static IOTHUB_MESSAGE_LIST* get_next_event_to_send(AMQP_TRANSPORT_DEVICE_INSTANC
         PDLIST_ENTRY list_entry = registered_device->waiting_to_send->Flink;
         message = containingRecord(list_entry, IOTHUB_MESSAGE_LIST, entry);
         (void)DList_RemoveEntryList(list_entry);
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_150: [Every event taken off `registered_device->wait_to_send_list` shall have its `inWaitingToSend` flag cleared]
+        message->inWaitingToSend = false;
     }
     else
     {
@@ -863,6 +878,8 @@ static IOTHUB_CLIENT_CONFIRMATION_RESULT get_iothub_client_confirmation_result_f
 static void on_event_send_complete(IOTHUB_MESSAGE_LIST* message, D2C_EVENT_SEND_RESULT result, void* context)
 {
     AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)context;
+    IOTHUB_CLIENT_CONFIRMATION_RESULT iothub_send_result;
+    DLIST_ENTRY completed;
 
     if (result != D2C_EVENT_SEND_COMPLETE_RESULT_OK && result != D2C_EVENT_SEND_COMPLETE_RESULT_DEVICE_DESTROYED)
     {
@@ -873,24 +890,23 @@ static void on_event_send_complete(IOTHUB_MESSAGE_LIST* message, D2C_EVENT_SEND_
         registered_device->number_of_send_event_complete_failures = 0;
     }
 
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_056: [If `message->callback` is not NULL, it shall invoked with the `iothub_send_result`]
-    if (message->callback != NULL)
+    if (registered_device->messages_in_flight > 0)
     {
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_050: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_OK, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_OK]
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_051: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_CANNOT_PARSE, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_ERROR]
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_052: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_ERROR]
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_053: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_TIMEOUT, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT]
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_054: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_DEVICE_DESTROYED, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY]
-        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_055: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_UNKNOWN, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_ERROR]
-        IOTHUB_CLIENT_CONFIRMATION_RESULT iothub_send_result = get_iothub_client_confirmation_result_from(result);
-
-        message->callback(iothub_send_result, message->context);
+        registered_device->messages_in_flight--;
     }
 
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_057: [`message->messageHandle` shall be destroyed using IoTHubMessage_Destroy]
-    IoTHubMessage_Destroy(message->messageHandle);
-    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_058: [`message` shall be destroyed using free]
-    free(message);
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_050: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_OK, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_OK]
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_051: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_CANNOT_PARSE, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_ERROR]
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_052: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_ERROR]
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_053: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_TIMEOUT, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT]
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_054: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_DEVICE_DESTROYED, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY]
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_055: [If result is D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_UNKNOWN, `iothub_send_result` shall be set using IOTHUB_CLIENT_CONFIRMATION_ERROR]
+    iothub_send_result = get_iothub_client_confirmation_result_from(result);
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_056: [`message` shall be completed by calling IoTHubClient_LL_SendComplete with a list holding only `message` and the `iothub_send_result`, which invokes its callback, destroys its `messageHandle` and releases it]
+    DList_InitializeListHead(&completed);
+    DList_InsertTailList(&completed, &(message->entry));
+    IoTHubClient_LL_SendComplete(registered_device->iothub_client_handle, &completed, iothub_send_result);
 }
 
 // @brief
@@ -907,6 +923,10 @@ static int send_pending_events(AMQP_TRANSPORT_DEVICE_INSTANCE* device_state)
     // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_047: [If the registered device is started, each event on `registered_device->wait_to_send_list` shall be removed from the list and sent using device_send_event_async()]
     while ((message = get_next_event_to_send(device_state)) != NULL)
     {
+        size_t payload_size = get_message_payload_size(message->messageHandle);
+
+        device_state->messages_in_flight++;
+
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_048: [device_send_event_async() shall be invoked passing `on_event_send_complete`]
         if (device_send_event_async(device_state->device_handle, message, on_event_send_complete, device_state) != RESULT_OK)
         {
@@ -917,11 +937,131 @@ static int send_pending_events(AMQP_TRANSPORT_DEVICE_INSTANCE* device_state)
             on_event_send_complete(message, D2C_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING, device_state);
             break;
         }
+
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_151: [If device_send_event_async() succeeds, the payload size of the event shall be added to the bytes sent by the device]
+        device_state->messages_sent++;
+        device_state->bytes_sent += payload_size;
     }
 
     return result;
 }
 
+static bool is_device_waiting_to_start(AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device, bool has_pending_events)
+{
+    return (registered_device != NULL &&
+        registered_device->device_state == DEVICE_STATE_STOPPED &&
+        !registered_device->is_start_admitted &&
+        ((DList_IsListEmpty(registered_device->waiting_to_send) == 0) == has_pending_events));
+}
+
+// @brief
+//     Returns the next value of the transport instance's own xorshift32 generator, seeding it from `current_time` and the instance address on first use.
+static uint32_t get_next_device_start_random(AMQP_TRANSPORT_INSTANCE* transport_instance, time_t current_time)
+{
+    uint32_t state = transport_instance->device_start_random_state;
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_148: [The random device of SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_138 shall be drawn from a generator owned by the transport instance and seeded from the current time and the instance itself]
+    if (state == 0)
+    {
+        state = ((uint32_t)current_time * 2654435761u) ^ (uint32_t)(uintptr_t)transport_instance;
+
+        if (state == 0)
+        {
+            state = 1;
+        }
+    }
+
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    transport_instance->device_start_random_state = state;
+
+    return state;
+}
+
+// @brief
+//     Admits up to `*available_starts` of the stopped devices with (or without) pending events, beginning at a random one of them.
+static void admit_device_starts(AMQP_TRANSPORT_INSTANCE* transport_instance, bool has_pending_events, time_t current_time, size_t* available_starts)
+{
+    LIST_ITEM_HANDLE list_item;
+    size_t waiting_count = 0;
+
+    for (list_item = singlylinkedlist_get_head_item(transport_instance->registered_devices); list_item != NULL; list_item = singlylinkedlist_get_next_item(list_item))
+    {
+        if (is_device_waiting_to_start((AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item), has_pending_events))
+        {
+            waiting_count++;
+        }
+    }
+
+    if (waiting_count > 0 && *available_starts > 0)
+    {
+        size_t first_admitted = (size_t)(get_next_device_start_random(transport_instance, current_time) % waiting_count);
+        size_t admitted_count = (*available_starts < waiting_count) ? *available_starts : waiting_count;
+        size_t index = 0;
+
+        for (list_item = singlylinkedlist_get_head_item(transport_instance->registered_devices); list_item != NULL; list_item = singlylinkedlist_get_next_item(list_item))
+        {
+            AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)singlylinkedlist_item_get_value(list_item);
+
+            if (is_device_waiting_to_start(registered_device, has_pending_events))
+            {
+                // the admitted devices are the `admitted_count` ones from `first_admitted` on, wrapping around the end of the list.
+                if ((index + waiting_count - first_admitted) % waiting_count < admitted_count)
+                {
+                    registered_device->is_start_admitted = true;
+                }
+                index++;
+            }
+        }
+
+        *available_starts -= admitted_count;
+    }
+}
+
+// @brief
+//     Refills the token bucket that limits the device starts and admits as many stopped devices as it allows.
+static void schedule_device_starts(AMQP_TRANSPORT_INSTANCE* transport_instance)
+{
+    time_t current_time;
+
+    if ((current_time = get_time(NULL)) == INDEFINITE_TIME)
+    {
+        LogError("Failed scheduling the device starts (get_time failed); no device will be started");
+    }
+    else
+    {
+        size_t available_starts;
+        size_t remaining_starts;
+
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_136: [If `device_starts_per_second` is not 0, a token bucket holding at most `device_starts_per_second` starts shall be refilled at `device_starts_per_second` starts per second]
+        if (transport_instance->device_start_tokens_time == INDEFINITE_TIME)
+        {
+            transport_instance->device_start_tokens = (double)transport_instance->device_starts_per_second;
+        }
+        else
+        {
+            transport_instance->device_start_tokens += get_difftime(current_time, transport_instance->device_start_tokens_time) * transport_instance->device_starts_per_second;
+
+            if (transport_instance->device_start_tokens > (double)transport_instance->device_starts_per_second)
+            {
+                transport_instance->device_start_tokens = (double)transport_instance->device_starts_per_second;
+            }
+        }
+        transport_instance->device_start_tokens_time = current_time;
+
+        available_starts = (size_t)transport_instance->device_start_tokens;
+        remaining_starts = available_starts;
+
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_137: [Stopped devices with events waiting to be sent shall be admitted to start before the other stopped devices, one start from the token bucket each]
+        admit_device_starts(transport_instance, true, current_time, &remaining_starts);
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_138: [Within each group the admitted devices shall begin at a randomly chosen device, so the same devices are not always started first]
+        admit_device_starts(transport_instance, false, current_time, &remaining_starts);
+
+        transport_instance->device_start_tokens -= (double)(available_starts - remaining_starts);
+    }
+}
+
 // @brief
 //     Auxiliary function for the public DoWork API, performing DoWork activities (authenticate, messaging) for a specific device.
 // @requires
@@ -940,8 +1080,13 @@ static int IoTHubTransport_AMQP_Common_Device_DoWork(AMQP_TRANSPORT_DEVICE_INSTA
             SESSION_HANDLE session_handle;
             CBS_HANDLE cbs_handle = NULL;
 
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_139: [If `device_starts_per_second` is not 0, a stopped device that was not admitted shall stay stopped until a later call to IoTHubTransport_AMQP_Common_DoWork]
+            if (registered_device->transport_instance->device_starts_per_second != 0 && !registered_device->is_start_admitted)
+            {
+                result = RESULT_OK;
+            }
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_039: [amqp_connection_get_session_handle() shall be invoked on `instance->connection`]
-            if (amqp_connection_get_session_handle(registered_device->transport_instance->amqp_connection, &session_handle) != RESULT_OK)
+            else if (amqp_connection_get_session_handle(registered_device->transport_instance->amqp_connection, &session_handle) != RESULT_OK)
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_040: [If amqp_connection_get_session_handle() fails, IoTHubTransport_AMQP_Common_DoWork shall fail and return]
                 LogError("Failed performing DoWork for device '%s' (failed to get the amqp_connection session_handle)", STRING_c_str(registered_device->device_id));
@@ -966,6 +1111,9 @@ static int IoTHubTransport_AMQP_Common_Device_DoWork(AMQP_TRANSPORT_DEVICE_INSTA
             {
                 result = RESULT_OK;
             }
+
+            // an admission is good for one start attempt only.
+            registered_device->is_start_admitted = false;
         }
         else if (registered_device->device_state == DEVICE_STATE_STARTING ||
                  registered_device->device_state == DEVICE_STATE_STOPPING)
@@ -1065,6 +1213,26 @@ static int replicate_device_options_to(AMQP_TRANSPORT_DEVICE_INSTANCE* dev_insta
         LogError("Failed to apply option DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
         result = __FAILURE__;
     }
+    // Batching is off by default, so the device only needs to be told when it was turned on
+    else if (dev_instance->transport_instance->option_event_send_batching &&
+        device_set_option(
+            dev_instance->device_handle,
+            DEVICE_OPTION_EVENT_SEND_BATCHING,
+            &dev_instance->transport_instance->option_event_send_batching) != RESULT_OK)
+    {
+        LogError("Failed to apply option DEVICE_OPTION_EVENT_SEND_BATCHING to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
+        result = __FAILURE__;
+    }
+    // The messenger does not pool its tasks by default, so the device only needs to be told when a pool size was set
+    else if (dev_instance->transport_instance->option_message_pool_size != 0 &&
+        device_set_option(
+            dev_instance->device_handle,
+            DEVICE_OPTION_MESSAGE_POOL_SIZE,
+            &dev_instance->transport_instance->option_message_pool_size) != RESULT_OK)
+    {
+        LogError("Failed to apply option DEVICE_OPTION_MESSAGE_POOL_SIZE to device '%s' (device_set_option failed)", STRING_c_str(dev_instance->device_id));
+        result = __FAILURE__;
+    }
     else if (auth_mode == DEVICE_AUTH_MODE_CBS)
     {
         if (device_set_option(
@@ -1126,6 +1294,14 @@ static const char* get_device_option_name_from(const char* iothubclient_option_n
     {
         device_option_name = DEVICE_OPTION_EVENT_SEND_TIMEOUT_SECS;
     }
+    else if (strcmp(OPTION_BATCHING, iothubclient_option_name) == 0)
+    {
+        device_option_name = DEVICE_OPTION_EVENT_SEND_BATCHING;
+    }
+    else if (strcmp(OPTION_MESSAGE_POOL_SIZE, iothubclient_option_name) == 0)
+    {
+        device_option_name = DEVICE_OPTION_MESSAGE_POOL_SIZE;
+    }
     else
     {
         device_option_name = NULL;
@@ -1200,6 +1376,11 @@ static void internal_destroy_instance(AMQP_TRANSPORT_INSTANCE* instance)
             singlylinkedlist_destroy(instance->registered_devices);
         }
 
+        if (instance->registered_devices_index != NULL)
+        {
+            device_index_destroy(instance->registered_devices_index);
+        }
+
         if (instance->amqp_connection != NULL)
         {
             amqp_connection_destroy(instance->amqp_connection);
@@ -1309,6 +1490,13 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
                 LogError("Failed to initialize the internal list of registered devices (singlylinkedlist_create failed)");
                 result = NULL;
             }
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_141: [`instance->registered_devices_index` shall be set using device_index_create()]
+            else if ((instance->registered_devices_index = device_index_create()) == NULL)
+            {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_142: [If device_index_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
+                LogError("Failed to initialize the internal index of registered devices (device_index_create failed)");
+                result = NULL;
+            }
             else
             {
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_010: [`get_io_transport` shall be saved on `instance->underlying_io_transport_provider`]
@@ -1318,8 +1506,13 @@ TRANSPORT_LL_HANDLE IoTHubTransport_AMQP_Common_Create(const IOTHUBTRANSPORT_CON
                 instance->option_sas_token_refresh_time_secs = DEFAULT_SAS_TOKEN_REFRESH_TIME_SECS;
                 instance->option_cbs_request_timeout_secs = DEFAULT_CBS_REQUEST_TIMEOUT_SECS;
                 instance->option_send_event_timeout_secs = DEFAULT_EVENT_SEND_TIMEOUT_SECS;
+                instance->option_event_send_batching = false;
+                instance->option_message_pool_size = 0;
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_12_002: [The connection idle timeout parameter default value shall be set to 240000 milliseconds using connection_set_idle_timeout()]
                 instance->c2d_keep_alive_freq_secs = DEFAULT_C2D_KEEP_ALIVE_FREQ_SECS;
+                instance->device_starts_per_second = 0;
+                instance->device_start_tokens_time = INDEFINITE_TIME;
+                instance->device_start_random_state = 0;
 
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_012: [If IoTHubTransport_AMQP_Common_Create succeeds it shall return a pointer to `instance`.]
                 result = (TRANSPORT_LL_HANDLE)instance;
@@ -1393,6 +1586,11 @@ void IoTHubTransport_AMQP_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_020: [If the amqp_connection is OPENED, the transport shall iterate through each registered device and perform a device-specific do_work on each]
             else if (transport_instance->amqp_connection_state == AMQP_CONNECTION_STATE_OPENED)
             {
+                if (transport_instance->device_starts_per_second != 0)
+                {
+                    schedule_device_starts(transport_instance);
+                }
+
                 while (list_item != NULL)
                 {
                     AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device;
@@ -1640,6 +1838,48 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_GetSendStatus(IOTHUB_DEVICE_HAN
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_GetStatistics(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_132: [If `handle` or `statistics` are NULL, IoTHubTransport_AMQP_Common_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG]
+    if (handle == NULL || statistics == NULL)
+    {
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("Failed retrieving the transport statistics (either handle (%p) or statistics (%p) are NULL)", handle, statistics);
+    }
+    else
+    {
+        AMQP_TRANSPORT_DEVICE_INSTANCE* amqp_device_state = (AMQP_TRANSPORT_DEVICE_INSTANCE*)handle;
+
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_134: [IoTHubTransport_AMQP_Common_GetStatistics shall set `sasTokenRefreshCount` using device_get_sas_token_refresh_count()]
+        if (device_get_sas_token_refresh_count(amqp_device_state->device_handle, &statistics->sasTokenRefreshCount) != RESULT_OK)
+        {
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_153: [If device_get_sas_token_refresh_count() fails, IoTHubTransport_AMQP_Common_GetStatistics shall return IOTHUB_CLIENT_ERROR]
+            LogError("Failed retrieving the transport statistics (device_get_sas_token_refresh_count failed)");
+            result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_133: [IoTHubTransport_AMQP_Common_GetStatistics shall set `messagesSent` to the number of events of the device sent with device_send_event_async() and `reconnectCount` to the number of reconnections of the transport]
+            statistics->messagesSent = amqp_device_state->messages_sent;
+            statistics->reconnectCount = amqp_device_state->transport_instance->reconnect_count;
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_147: [IoTHubTransport_AMQP_Common_GetStatistics shall set `waitingForAckCount` to the number of events of the device taken from `waiting_to_send` whose send has not completed yet]
+            statistics->waitingForAckCount = amqp_device_state->messages_in_flight;
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_154: [IoTHubTransport_AMQP_Common_GetStatistics shall set `bytesSent` and `bytesReceived` to the payload bytes of the events sent and the messages received by the device]
+            statistics->bytesSent = amqp_device_state->bytes_sent;
+            statistics->bytesReceived = amqp_device_state->bytes_received;
+
+            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_135: [If no failures occur, IoTHubTransport_AMQP_Common_GetStatistics shall return IOTHUB_CLIENT_OK]
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -1676,6 +1916,18 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
             is_device_specific_option = true;
             transport_instance->option_send_event_timeout_secs = *(size_t*)value;
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_131: [If `option` is `Batching`, `value` shall be a bool* that enables sending the device events in AMQP batched messages, saved and applied to each registered device]
+        else if (strcmp(OPTION_BATCHING, option) == 0)
+        {
+            is_device_specific_option = true;
+            transport_instance->option_event_send_batching = *(bool*)value;
+        }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_149: [If `option` is `message_pool_size`, `value` shall be a size_t* with the number of released event send tasks each device keeps for reuse, saved and applied to each registered device]
+        else if (strcmp(OPTION_MESSAGE_POOL_SIZE, option) == 0)
+        {
+            is_device_specific_option = true;
+            transport_instance->option_message_pool_size = *(size_t*)value;
+        }
         else if (strcmp(OPTION_C2D_KEEP_ALIVE_FREQ_SECS, option) == 0)
         {
             is_device_specific_option = false;
@@ -1715,6 +1967,13 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_AMQP_Common_SetOption(TRANSPORT_LL_HANDLE h
                 result = IOTHUB_CLIENT_OK;
             }
         }
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_140: [If `option` is `device_starts_per_second`, `value` shall be a size_t* saved as the number of registered devices allowed to start per second, 0 meaning no limit]
+        else if (strcmp(OPTION_DEVICE_STARTS_PER_SECOND, option) == 0)
+        {
+            transport_instance->device_starts_per_second = *(size_t*)value;
+            transport_instance->device_start_tokens_time = INDEFINITE_TIME;
+            result = IOTHUB_CLIENT_OK;
+        }
         else if (strcmp(OPTION_HTTP_PROXY, option) == 0)
         {
             /* Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_032: [ If `option` is `proxy_data`, `value` shall be used as an `HTTP_PROXY_OPTIONS*`. ]*/
@@ -1868,11 +2127,11 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
     }
     else
     {
-        LIST_ITEM_HANDLE list_item;
         AMQP_TRANSPORT_INSTANCE* transport_instance = (AMQP_TRANSPORT_INSTANCE*)handle;
 
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_064: [If the device is already registered, IoTHubTransport_AMQP_Common_Register shall fail and return NULL.]
-        if (is_device_registered_ex(transport_instance->registered_devices, device->deviceId, &list_item))
+        // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_143: [The device shall be looked up by id using device_index_find_by_id() on `instance->registered_devices_index`]
+        if (device_index_find_by_id(transport_instance->registered_devices_index, device->deviceId) != NULL)
         {
             LogError("IoTHubTransport_AMQP_Common_Register failed (device '%s' already registered on this transport instance)", device->deviceId);
             result = NULL;
@@ -1967,11 +2226,19 @@ IOTHUB_DEVICE_HANDLE IoTHubTransport_AMQP_Common_Register(TRANSPORT_LL_HANDLE ha
                                 LogError("Transport failed to register device '%s' (failed to replicate options)", device->deviceId);
                                 result = NULL;
                             }
+                            // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_144: [IoTHubTransport_AMQP_Common_Register shall add the `amqp_device_instance` to `instance->registered_devices_index` using device_index_add()]
+                            else if (device_index_add(transport_instance->registered_devices_index, device->deviceId, amqp_device_instance) != RESULT_OK)
+                            {
+                                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_145: [If device_index_add() fails, IoTHubTransport_AMQP_Common_Register shall fail and return NULL]
+                                LogError("Transport failed to register device '%s' (device_index_add failed)", device->deviceId);
+                                result = NULL;
+                            }
                             // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_074: [IoTHubTransport_AMQP_Common_Register shall add the `amqp_device_instance` to `instance->registered_devices`]
-                            else if (singlylinkedlist_add(transport_instance->registered_devices, amqp_device_instance) == NULL)
+                            else if ((amqp_device_instance->list_item = singlylinkedlist_add(transport_instance->registered_devices, amqp_device_instance)) == NULL)
                             {
                                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_075: [If it fails to add `amqp_device_instance`, IoTHubTransport_AMQP_Common_Register shall fail and return NULL]
                                 LogError("Transport failed to register device '%s' (singlylinkedlist_add failed)", device->deviceId);
+                                (void)device_index_remove(transport_instance->registered_devices_index, amqp_device_instance);
                                 result = NULL;
                             }
                             else
@@ -2020,7 +2287,6 @@ void IoTHubTransport_AMQP_Common_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
     {
         AMQP_TRANSPORT_DEVICE_INSTANCE* registered_device = (AMQP_TRANSPORT_DEVICE_INSTANCE*)deviceHandle;
         const char* device_id;
-        LIST_ITEM_HANDLE list_item;
 
         if ((device_id = STRING_c_str(registered_device->device_id)) == NULL)
         {
@@ -2032,19 +2298,22 @@ void IoTHubTransport_AMQP_Common_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
             LogError("Failed to unregister device '%s' (deviceHandle does not have a transport state associated to).", device_id);
         }
         // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_081: [If the device is not registered with this transport, IoTHubTransport_AMQP_Common_Unregister shall return]
-        else if (!is_device_registered_ex(registered_device->transport_instance->registered_devices, device_id, &list_item))
+        else if (!is_device_registered(registered_device))
         {
             LogError("Failed to unregister device '%s' (device is not registered within this transport).", device_id);
         }
         else
         {
             // Removing it first so the race hazzard is reduced between this function and DoWork. Best would be to use locks.
-            if (singlylinkedlist_remove(registered_device->transport_instance->registered_devices, list_item) != RESULT_OK)
+            if (singlylinkedlist_remove(registered_device->transport_instance->registered_devices, registered_device->list_item) != RESULT_OK)
             {
                 LogError("Failed to unregister device '%s' (singlylinkedlist_remove failed).", device_id);
             }
             else
             {
+                // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_146: [IoTHubTransport_AMQP_Common_Unregister shall remove the device from `instance->registered_devices_index` using device_index_remove()]
+                (void)device_index_remove(registered_device->transport_instance->registered_devices_index, registered_device);
+
                 // TODO: Q: should we go through waiting_to_send list and raise on_event_send_complete with BECAUSE_DESTROY ?
 
                 // Codes_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_012: [IoTHubTransport_AMQP_Common_Unregister shall destroy the C2D methods handler by calling iothubtransportamqp_methods_destroy]
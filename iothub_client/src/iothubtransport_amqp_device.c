@@ -993,6 +993,43 @@ int device_get_send_status(DEVICE_HANDLE handle, DEVICE_SEND_STATUS *send_status
     return result;
 }
 
+int device_get_sas_token_refresh_count(DEVICE_HANDLE handle, uint64_t* sas_token_refresh_count)
+{
+    int result;
+
+    // Codes_SRS_DEVICE_09_124: [If `handle` or `sas_token_refresh_count` is NULL, device_get_sas_token_refresh_count shall return a non-zero result]
+    if (handle == NULL || sas_token_refresh_count == NULL)
+    {
+        LogError("Failed getting the device SAS token refresh count (NULL parameter received; handle=%p, sas_token_refresh_count=%p)", handle, sas_token_refresh_count);
+        result = __FAILURE__;
+    }
+    else
+    {
+        DEVICE_INSTANCE* instance = (DEVICE_INSTANCE*)handle;
+
+        // Codes_SRS_DEVICE_09_125: [If `instance->authentication_mode` is not DEVICE_AUTH_MODE_CBS, device_get_sas_token_refresh_count shall set `sas_token_refresh_count` to 0 and return zero]
+        if (instance->config->authentication_mode != DEVICE_AUTH_MODE_CBS)
+        {
+            *sas_token_refresh_count = 0;
+            result = RESULT_OK;
+        }
+        // Codes_SRS_DEVICE_09_126: [Otherwise `sas_token_refresh_count` shall be obtained using authentication_get_sas_token_refresh_count]
+        else if (authentication_get_sas_token_refresh_count(instance->authentication_handle, sas_token_refresh_count) != RESULT_OK)
+        {
+            // Codes_SRS_DEVICE_09_127: [If authentication_get_sas_token_refresh_count fails, device_get_sas_token_refresh_count shall return a non-zero result]
+            LogError("Failed getting the device SAS token refresh count (authentication_get_sas_token_refresh_count failed)");
+            result = __FAILURE__;
+        }
+        else
+        {
+            // Codes_SRS_DEVICE_09_128: [If device_get_sas_token_refresh_count succeeds, it shall return zero as result]
+            result = RESULT_OK;
+        }
+    }
+
+    return result;
+}
+
 int device_subscribe_message(DEVICE_HANDLE handle, ON_DEVICE_C2D_MESSAGE_RECEIVED on_message_received_callback, void* context)
 {
     int result;
@@ -1184,6 +1221,32 @@ int device_set_option(DEVICE_HANDLE handle, const char* name, void* value)
                 result = RESULT_OK;
             }
         }
+        else if (strcmp(DEVICE_OPTION_EVENT_SEND_BATCHING, name) == 0)
+        {
+            // Codes_SRS_DEVICE_09_122: [If `name` is DEVICE_OPTION_EVENT_SEND_BATCHING, it shall be passed along with `value` to telemetry_messenger_set_option as MESSENGER_OPTION_EVENT_SEND_BATCHING]
+            if (telemetry_messenger_set_option(instance->messenger_handle, MESSENGER_OPTION_EVENT_SEND_BATCHING, value) != RESULT_OK)
+            {
+                LogError("failed setting option for device '%s' (failed setting messenger option '%s')", instance->config->device_id, name);
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = RESULT_OK;
+            }
+        }
+        else if (strcmp(DEVICE_OPTION_MESSAGE_POOL_SIZE, name) == 0)
+        {
+            // Codes_SRS_DEVICE_09_123: [If `name` is DEVICE_OPTION_MESSAGE_POOL_SIZE, it shall be passed along with `value` to telemetry_messenger_set_option as MESSENGER_OPTION_MESSAGE_POOL_SIZE]
+            if (telemetry_messenger_set_option(instance->messenger_handle, MESSENGER_OPTION_MESSAGE_POOL_SIZE, value) != RESULT_OK)
+            {
+                LogError("failed setting option for device '%s' (failed setting messenger option '%s')", instance->config->device_id, name);
+                result = __FAILURE__;
+            }
+            else
+            {
+                result = RESULT_OK;
+            }
+        }
         else if (strcmp(DEVICE_OPTION_SAVED_AUTH_OPTIONS, name) == 0)
         {
             // Codes_SRS_DEVICE_09_088: [If `name` is DEVICE_OPTION_SAVED_AUTH_OPTIONS but CBS authentication is not being used, device_set_option shall return a non-zero result]
@@ -35,6 +35,9 @@
 #define MAX_MESSAGE_RECEIVER_STATE_CHANGE_TIMEOUT_SECS  300
 #define UNIQUE_ID_BUFFER_SIZE                           37
 #define STRING_NULL_TERMINATOR                          '\0'
+#define AMQP_BATCHING_FORMAT_CODE                       0x80013700
+#define MAX_EVENT_BATCH_SIZE                            (256 * 1024)
+#define EVENT_BATCH_SECTION_OVERHEAD                    8
  
 typedef struct TELEMETRY_MESSENGER_INSTANCE_TAG
 {
@@ -65,6 +68,11 @@ typedef struct TELEMETRY_MESSENGER_INSTANCE_TAG
 	size_t event_send_retry_limit;
 	size_t event_send_error_count;
 	size_t event_send_timeout_secs;
+	bool event_send_batching;
+	// released tasks kept for reuse, chained through next_in_batch
+	struct MESSENGER_SEND_EVENT_TASK_TAG* free_tasks;
+	size_t free_task_count;
+	size_t message_pool_size;
 	time_t last_message_sender_state_change_time;
 	time_t last_message_receiver_state_change_time;
 } TELEMETRY_MESSENGER_INSTANCE;
@@ -77,8 +85,51 @@ typedef struct MESSENGER_SEND_EVENT_TASK_TAG
 	time_t send_time;
 	TELEMETRY_MESSENGER_INSTANCE *messenger;
 	bool is_timed_out;
+	struct MESSENGER_SEND_EVENT_TASK_TAG* next_in_batch;
 } MESSENGER_SEND_EVENT_TASK;
 
+static MESSENGER_SEND_EVENT_TASK* allocate_task(TELEMETRY_MESSENGER_INSTANCE* instance)
+{
+	MESSENGER_SEND_EVENT_TASK* result = instance->free_tasks;
+
+	if (result != NULL)
+	{
+		instance->free_tasks = result->next_in_batch;
+		instance->free_task_count--;
+	}
+	else
+	{
+		result = (MESSENGER_SEND_EVENT_TASK*)malloc(sizeof(MESSENGER_SEND_EVENT_TASK));
+	}
+
+	return result;
+}
+
+static void release_task(TELEMETRY_MESSENGER_INSTANCE* instance, MESSENGER_SEND_EVENT_TASK* task)
+{
+	if (instance->free_task_count < instance->message_pool_size)
+	{
+		task->next_in_batch = instance->free_tasks;
+		instance->free_tasks = task;
+		instance->free_task_count++;
+	}
+	else
+	{
+		free(task);
+	}
+}
+
+static void trim_task_pool(TELEMETRY_MESSENGER_INSTANCE* instance)
+{
+	while (instance->free_task_count > instance->message_pool_size)
+	{
+		MESSENGER_SEND_EVENT_TASK* free_task = instance->free_tasks;
+		instance->free_tasks = free_task->next_in_batch;
+		instance->free_task_count--;
+		free(free_task);
+	}
+}
+
 // @brief
 //     Evaluates if the ammount of time since start_time is greater or lesser than timeout_in_secs.
 // @param is_timed_out
@@ -918,33 +969,41 @@ static void internal_on_event_send_complete_callback(void* context, MESSAGE_SEND
 
 		if (task->messenger->message_sender_current_state != MESSAGE_SENDER_STATE_ERROR)
 		{
-			if (task->is_timed_out == false)
+			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_190: [If the event was sent in a batch, each event of the batch shall be completed individually]
+			while (task != NULL)
 			{
-				TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT messenger_send_result;
+				MESSENGER_SEND_EVENT_TASK* next_task = task->next_in_batch;
 
-				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_107: [If no failure occurs, `task->on_event_send_complete_callback` shall be invoked with result EVENT_SEND_COMPLETE_RESULT_OK]  
-				if (send_result == MESSAGE_SEND_OK)
+				if (task->is_timed_out == false)
 				{
-					messenger_send_result = TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_OK;
+					TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT messenger_send_result;
+
+					// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_107: [If no failure occurs, `task->on_event_send_complete_callback` shall be invoked with result EVENT_SEND_COMPLETE_RESULT_OK]  
+					if (send_result == MESSAGE_SEND_OK)
+					{
+						messenger_send_result = TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_OK;
+					}
+					// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_108: [If a failure occurred, `task->on_event_send_complete_callback` shall be invoked with result EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING] 
+					else
+					{
+						messenger_send_result = TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING;
+					}
+
+					task->on_event_send_complete_callback(task->message, messenger_send_result, (void*)task->context);
 				}
-				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_108: [If a failure occurred, `task->on_event_send_complete_callback` shall be invoked with result EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING] 
 				else
 				{
-					messenger_send_result = TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING;
+					LogInfo("messenger on_event_send_complete_callback invoked for timed out event %p; not firing upper layer callback.", task->message);
 				}
 
-				task->on_event_send_complete_callback(task->message, messenger_send_result, (void*)task->context);
-			}
-			else
-			{
-				LogInfo("messenger on_event_send_complete_callback invoked for timed out event %p; not firing upper layer callback.", task->message);
-			}
+				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_128: [`task` shall be removed from `instance->in_progress_list`]  
+				remove_event_from_in_progress_list(task);
 
-			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_128: [`task` shall be removed from `instance->in_progress_list`]  
-			remove_event_from_in_progress_list(task);
+				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be returned to the task pool while it holds fewer than `instance->message_pool_size` tasks, and destroyed using free() otherwise]  
+				release_task(task->messenger, task);
 
-			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be destroyed using free()]  
-			free(task);
+				task = next_task;
+			}
 		}
 	}
 }
@@ -1001,7 +1060,7 @@ static int send_pending_events(TELEMETRY_MESSENGER_INSTANCE* instance)
 
 				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_160: [If any failure occurs the event shall be removed from `instance->in_progress_list` and destroyed]  
 				remove_event_from_in_progress_list(task);
-				free(task);
+				release_task(instance, task);
 				
 				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_156: [If message_create_from_iothub_message() fails, telemetry_messenger_do_work() shall skip to the next event to be sent]  
 			}
@@ -1025,7 +1084,7 @@ static int send_pending_events(TELEMETRY_MESSENGER_INSTANCE* instance)
 
 					// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_160: [If any failure occurs the event shall be removed from `instance->in_progress_list` and destroyed]  
 					remove_event_from_in_progress_list(task);
-					free(task);
+					release_task(instance, task);
 
 					break;
 				}
@@ -1036,6 +1095,162 @@ static int send_pending_events(TELEMETRY_MESSENGER_INSTANCE* instance)
 	return result;
 }
 
+static void complete_event_batch(MESSENGER_SEND_EVENT_TASK* task, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT result)
+{
+	while (task != NULL)
+	{
+		MESSENGER_SEND_EVENT_TASK* next_task = task->next_in_batch;
+
+		task->on_event_send_complete_callback(task->message, result, (void*)task->context);
+		remove_event_from_in_progress_list(task);
+		release_task(task->messenger, task);
+
+		task = next_task;
+	}
+}
+
+static MESSAGE_HANDLE create_event_batch(void)
+{
+	MESSAGE_HANDLE batch;
+
+	// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_192: [The batch shall be a MESSAGE_HANDLE created with message_create() and its message format set to 0x80013700 using message_set_message_format()]
+	if ((batch = message_create()) == NULL)
+	{
+		LogError("Failed creating the event batch (message_create failed)");
+	}
+	else if (message_set_message_format(batch, AMQP_BATCHING_FORMAT_CODE) != RESULT_OK)
+	{
+		LogError("Failed creating the event batch (message_set_message_format failed)");
+		message_destroy(batch);
+		batch = NULL;
+	}
+
+	return batch;
+}
+
+static int send_event_batch(TELEMETRY_MESSENGER_INSTANCE* instance, MESSAGE_HANDLE batch, MESSENGER_SEND_EVENT_TASK* batch_head)
+{
+	int result;
+	MESSENGER_SEND_EVENT_TASK* task;
+	time_t send_time = get_time(NULL);
+
+	for (task = batch_head; task != NULL; task = task->next_in_batch)
+	{
+		task->send_time = send_time;
+	}
+
+	// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_194: [The batch shall be submitted using messagesender_send(), passing `internal_on_event_send_complete_callback` and the first event of the batch, and then destroyed using message_destroy()]
+	if (messagesender_send(instance->message_sender, batch, internal_on_event_send_complete_callback, batch_head) != RESULT_OK)
+	{
+		LogError("Failed sending event batch (messagesender_send failed)");
+
+		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_195: [If messagesender_send() fails, each event of the batch shall be completed with EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING]
+		complete_event_batch(batch_head, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING);
+		result = __FAILURE__;
+	}
+	else
+	{
+		result = RESULT_OK;
+	}
+
+	message_destroy(batch);
+
+	return result;
+}
+
+// @brief
+//     Packs the pending events into as few AMQP batched messages (one data section per encoded event) as MAX_EVENT_BATCH_SIZE allows.
+// @returns
+//     0 if no failures occur, non-zero otherwise.
+static int send_batched_events(TELEMETRY_MESSENGER_INSTANCE* instance)
+{
+	int result = RESULT_OK;
+	MESSAGE_HANDLE batch = NULL;
+	MESSENGER_SEND_EVENT_TASK* batch_head = NULL;
+	MESSENGER_SEND_EVENT_TASK* batch_tail = NULL;
+	size_t batch_size = 0;
+	MESSENGER_SEND_EVENT_TASK* task;
+
+	while (result == RESULT_OK && (task = get_next_event_to_send(instance)) != NULL)
+	{
+		BINARY_DATA encoded_event;
+
+		task->next_in_batch = NULL;
+
+		if (move_event_to_in_progress_list(task) != RESULT_OK)
+		{
+			result = __FAILURE__;
+			task->on_event_send_complete_callback(task->message, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING, (void*)task->context);
+		}
+		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_191: [If batching is enabled, each event shall be encoded using message_create_uamqp_encoding_from_iothub_message(), and if that fails completed with EVENT_SEND_COMPLETE_RESULT_ERROR_CANNOT_PARSE]
+		else if (message_create_uamqp_encoding_from_iothub_message(task->message->messageHandle, &encoded_event) != RESULT_OK)
+		{
+			LogError("Failed sending event message (failed encoding the event for the batch)");
+			complete_event_batch(task, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_CANNOT_PARSE);
+		}
+		else
+		{
+			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_193: [A batch shall be sent before adding an event that would make it exceed MAX_EVENT_BATCH_SIZE; a single event larger than that is sent alone]
+			if (batch_head != NULL && batch_size + encoded_event.length + EVENT_BATCH_SECTION_OVERHEAD > MAX_EVENT_BATCH_SIZE)
+			{
+				result = send_event_batch(instance, batch, batch_head);
+				batch = NULL;
+				batch_head = NULL;
+				batch_size = 0;
+			}
+
+			if (result != RESULT_OK)
+			{
+				complete_event_batch(task, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING);
+			}
+			else if (batch == NULL && (batch = create_event_batch()) == NULL)
+			{
+				result = __FAILURE__;
+				complete_event_batch(task, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING);
+			}
+			else if (message_add_body_amqp_data(batch, encoded_event) != RESULT_OK)
+			{
+				LogError("Failed adding event to the batch (message_add_body_amqp_data failed)");
+				complete_event_batch(task, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING);
+			}
+			else
+			{
+				if (batch_head == NULL)
+				{
+					batch_head = task;
+				}
+				else
+				{
+					batch_tail->next_in_batch = task;
+				}
+				batch_tail = task;
+				batch_size += encoded_event.length + EVENT_BATCH_SECTION_OVERHEAD;
+			}
+
+			free((void*)encoded_event.bytes);
+		}
+	}
+
+	if (batch_head != NULL)
+	{
+		if (result == RESULT_OK)
+		{
+			result = send_event_batch(instance, batch, batch_head);
+		}
+		else
+		{
+			complete_event_batch(batch_head, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING);
+			message_destroy(batch);
+		}
+	}
+	else if (batch != NULL)
+	{
+		message_destroy(batch);
+	}
+
+	return result;
+}
+
 // @brief
 //     Goes through each task in in_progress_list and checks if the events timed out to be sent.
 // @remarks
@@ -1098,7 +1313,7 @@ static void remove_timed_out_events(TELEMETRY_MESSENGER_INSTANCE* instance)
 		{
 			remove_event_from_in_progress_list(task);
 
-			free(task);
+			release_task(instance, task);
 		}
 
 		list_item = singlylinkedlist_get_next_item(list_item);
@@ -1125,6 +1340,8 @@ static void* telemetry_messenger_clone_option(const char* name, const void* valu
 	else
 	{
 		if (strcmp(MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, name) == 0 ||
+			strcmp(MESSENGER_OPTION_EVENT_SEND_BATCHING, name) == 0 ||
+			strcmp(MESSENGER_OPTION_MESSAGE_POOL_SIZE, name) == 0 ||
 			strcmp(MESSENGER_OPTION_SAVED_OPTIONS, name) == 0)
 		{
 			result = (void*)value;
@@ -1330,7 +1547,8 @@ int telemetry_messenger_send_async(TELEMETRY_MESSENGER_HANDLE messenger_handle,
 		TELEMETRY_MESSENGER_INSTANCE *instance = (TELEMETRY_MESSENGER_INSTANCE*)messenger_handle;
 
 		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_137: [telemetry_messenger_send_async() shall allocate memory for a MESSENGER_SEND_EVENT_TASK structure (aka `task`)]  
-		if ((task = (MESSENGER_SEND_EVENT_TASK*)malloc(sizeof(MESSENGER_SEND_EVENT_TASK))) == NULL)
+		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_198: [telemetry_messenger_send_async() shall reuse a task from the task pool when one is available]
+		if ((task = allocate_task(instance)) == NULL)
 		{
 			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_138: [If malloc() fails, telemetry_messenger_send_async() shall fail and return a non-zero value]
 			LogError("Failed sending event (failed to create struct for task; malloc failed)");
@@ -1345,7 +1563,7 @@ int telemetry_messenger_send_async(TELEMETRY_MESSENGER_HANDLE messenger_handle,
 			result = __FAILURE__;
 
 			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_142: [If any failure occurs, telemetry_messenger_send_async() shall free any memory it has allocated]
-			free(task);
+			release_task(instance, task);
 		}
 		else
 		{
@@ -1616,7 +1834,8 @@ void telemetry_messenger_do_work(TELEMETRY_MESSENGER_HANDLE messenger_handle)
 			{
 				update_messenger_state(instance, TELEMETRY_MESSENGER_STATE_ERROR);
 			}
-			else if (send_pending_events(instance) != RESULT_OK && instance->event_send_retry_limit > 0)
+			// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_196: [If `instance->event_send_batching` is true, the pending events shall be sent in batches, otherwise one by one]
+			else if ((instance->event_send_batching ? send_batched_events(instance) : send_pending_events(instance)) != RESULT_OK && instance->event_send_retry_limit > 0)
 			{
 				instance->event_send_error_count++;
 
@@ -1687,6 +1906,10 @@ void telemetry_messenger_destroy(TELEMETRY_MESSENGER_HANDLE messenger_handle)
 		singlylinkedlist_destroy(instance->waiting_to_send);
 		singlylinkedlist_destroy(instance->in_progress_list);
 
+		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_200: [All the tasks of the task pool shall be destroyed using free()]
+		instance->message_pool_size = 0;
+		trim_task_pool(instance);
+
 		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_112: [`instance->iothub_host_fqdn` shall be destroyed using STRING_delete()]
 		STRING_delete(instance->iothub_host_fqdn);
 		
@@ -1822,6 +2045,19 @@ int telemetry_messenger_set_option(TELEMETRY_MESSENGER_HANDLE messenger_handle,
 			instance->event_send_timeout_secs = *((size_t*)value);
 			result = RESULT_OK;
 		}
+		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_197: [If name matches MESSENGER_OPTION_EVENT_SEND_BATCHING, `value` shall be saved on `instance->event_send_batching`]
+		else if (strcmp(MESSENGER_OPTION_EVENT_SEND_BATCHING, name) == 0)
+		{
+			instance->event_send_batching = *((bool*)value);
+			result = RESULT_OK;
+		}
+		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_199: [If name matches MESSENGER_OPTION_MESSAGE_POOL_SIZE, `value` shall be saved on `instance->message_pool_size` and the pooled tasks above that number shall be destroyed using free()]
+		else if (strcmp(MESSENGER_OPTION_MESSAGE_POOL_SIZE, name) == 0)
+		{
+			instance->message_pool_size = *((size_t*)value);
+			trim_task_pool(instance);
+			result = RESULT_OK;
+		}
 		// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_169: [If name matches MESSENGER_OPTION_SAVED_OPTIONS, `value` shall be applied using OptionHandler_FeedOptions]
 		else if (strcmp(MESSENGER_OPTION_SAVED_OPTIONS, name) == 0)
 		{
@@ -1880,6 +2116,18 @@ OPTIONHANDLER_HANDLE telemetry_messenger_retrieve_options(TELEMETRY_MESSENGER_HA
 				LogError("Failed to retrieve options from messenger instance (OptionHandler_Create failed for option '%s')", MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS);
 				result = NULL;
 			}
+			else if (instance->event_send_batching &&
+				OptionHandler_AddOption(options, MESSENGER_OPTION_EVENT_SEND_BATCHING, (void*)&instance->event_send_batching) != OPTIONHANDLER_OK)
+			{
+				LogError("Failed to retrieve options from messenger instance (OptionHandler_Create failed for option '%s')", MESSENGER_OPTION_EVENT_SEND_BATCHING);
+				result = NULL;
+			}
+			else if (instance->message_pool_size != 0 &&
+				OptionHandler_AddOption(options, MESSENGER_OPTION_MESSAGE_POOL_SIZE, (void*)&instance->message_pool_size) != OPTIONHANDLER_OK)
+			{
+				LogError("Failed to retrieve options from messenger instance (OptionHandler_Create failed for option '%s')", MESSENGER_OPTION_MESSAGE_POOL_SIZE);
+				result = NULL;
+			}
 			else
 			{
 				// Codes_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_179: [If no failures occur, telemetry_messenger_retrieve_options shall return the OPTIONHANDLER_HANDLE instance]
@@ -8,6 +8,7 @@
 
 #include "azure_c_shared_utility/xlogging.h"
 #include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/doublylinkedlist.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 
@@ -47,6 +48,8 @@
 #define STATUS_CODE_FAILURE_VALUE   500
 #define STATUS_CODE_TIMEOUT_VALUE   408
 #define ERROR_TIME_FOR_RETRY_SECS   5       // We won't retry more than once every 5 seconds
+#define TELEMETRY_ACK_INDEX_SIZE    64      // Buckets of the packet id -> in-flight message index
+#define IOTHUB_APP_PREFIX           "iothub-app-"
 
 static const char TOPIC_DEVICE_TWIN_PREFIX[] = "$iothub/twin";
 static const char TOPIC_DEVICE_METHOD_PREFIX[] = "$iothub/methods";
@@ -63,6 +66,9 @@ static const char* TOPIC_DEVICE_METHOD_RESPONSE = "$iothub/methods/res";
 static const char* IOTHUB_API_VERSION = "2016-11-14";
 
 static const char* PROPERTY_SEPARATOR = "&";
+static const char SYS_PROP_CORRELATION_ID[] = "%24.cid=";
+static const char SYS_PROP_MESSAGE_ID[] = "%24.mid=";
+static const char BATCH_TOPIC_PROPERTIES[] = "%24.ct=application%2Fvnd.microsoft.iothub.json&%24.ce=utf-8";
 static const char* REPORTED_PROPERTIES_TOPIC = "$iothub/twin/PATCH/properties/reported/?$rid=%"PRIu16;
 static const char* GET_PROPERTIES_TOPIC = "$iothub/twin/GET/?$rid=%"PRIu16;
 static const char* DEVICE_METHOD_RESPONSE_TOPIC = "$iothub/methods/res/%d/?$rid=%s";
@@ -182,6 +188,7 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
     bool isRecoverableError;
     uint16_t keepAliveValue;
     tickcounter_ms_t mqtt_connect_time;
+    size_t sas_token_refresh_time; /*seconds after mqtt_connect_time*/
     size_t connectFailCount;
     tickcounter_ms_t connectTick;
     bool log_trace;
@@ -197,6 +204,37 @@ typedef struct MQTTTRANSPORT_HANDLE_DATA_TAG
 
     // Telemetry specific
     DLIST_ENTRY telemetry_waitingForAck;
+    struct MQTT_MESSAGE_DETAILS_LIST_TAG* telemetry_ackIndex[TELEMETRY_ACK_INDEX_SIZE];
+    size_t telemetry_inFlightCount;
+    // Number of IoTHub messages carried by the PUBLISHes in telemetry_waitingForAck (a batch carries several)
+    size_t telemetry_inFlightMessages;
+    size_t telemetry_maxInFlight;
+
+    // Batching: 0 disables, otherwise the maximum size of one batched PUBLISH payload
+    size_t telemetry_batchMaxSize;
+    tickcounter_ms_t telemetry_batchLingerMs;
+    bool telemetry_batchLingerStarted;
+    tickcounter_ms_t telemetry_batchLingerStart;
+
+    // Released MQTT_MESSAGE_DETAILS_LIST kept for reuse, chained through entry.Flink
+    struct MQTT_MESSAGE_DETAILS_LIST_TAG* telemetry_freeEntries;
+    size_t telemetry_freeEntriesCount;
+    size_t telemetry_poolSize;
+
+    // Event topic plus URL-encoded application properties of the last telemetry message,
+    // followed by the raw key\0value\0 pairs it was built from (same allocation)
+    char* telemetry_topicPrefix;
+    size_t telemetry_topicPrefixLength;
+    const char* telemetry_topicPropertySource;
+    size_t telemetry_topicPropertySourceLength;
+
+    // Counters reported through IoTHubTransport_MQTT_Common_GetStatistics
+    uint64_t stats_messagesSent;
+    uint64_t stats_bytesSent;
+    uint64_t stats_bytesReceived;
+    uint64_t stats_reconnectCount;
+    uint64_t stats_sasTokenRefreshCount;
+    bool stats_hasConnected;
 
     //Retry Logic
     RETRY_LOGIC* retryLogic;
@@ -232,6 +270,11 @@ typedef struct MQTT_MESSAGE_DETAILS_LIST_TAG
     void* context;
     uint16_t packet_id;
     DLIST_ENTRY entry;
+    struct MQTT_MESSAGE_DETAILS_LIST_TAG* nextInAckBucket;
+    size_t messageCount;
+    // Set for batched entries only: the JSON array payload and the IOTHUB_MESSAGE_LIST items it carries
+    STRING_HANDLE batchPayload;
+    DLIST_ENTRY batchedMessages;
 } MQTT_MESSAGE_DETAILS_LIST, *PMQTT_MESSAGE_DETAILS_LIST;
 
 typedef struct DEVICE_METHOD_INFO_TAG
@@ -239,6 +282,96 @@ typedef struct DEVICE_METHOD_INFO_TAG
     STRING_HANDLE request_id;
 } DEVICE_METHOD_INFO;
 
+static MQTT_MESSAGE_DETAILS_LIST* allocate_message_details(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    MQTT_MESSAGE_DETAILS_LIST* result = transport_data->telemetry_freeEntries;
+    if (result != NULL)
+    {
+        transport_data->telemetry_freeEntries = (MQTT_MESSAGE_DETAILS_LIST*)result->entry.Flink;
+        transport_data->telemetry_freeEntriesCount--;
+    }
+    else
+    {
+        result = (MQTT_MESSAGE_DETAILS_LIST*)malloc(sizeof(MQTT_MESSAGE_DETAILS_LIST));
+    }
+    if (result != NULL)
+    {
+        result->batchPayload = NULL;
+    }
+    return result;
+}
+
+static void release_message_details(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry)
+{
+    if (mqttMsgEntry->batchPayload != NULL)
+    {
+        STRING_delete(mqttMsgEntry->batchPayload);
+        mqttMsgEntry->batchPayload = NULL;
+    }
+    if (transport_data->telemetry_freeEntriesCount < transport_data->telemetry_poolSize)
+    {
+        mqttMsgEntry->entry.Flink = (PDLIST_ENTRY)transport_data->telemetry_freeEntries;
+        transport_data->telemetry_freeEntries = mqttMsgEntry;
+        transport_data->telemetry_freeEntriesCount++;
+    }
+    else
+    {
+        free(mqttMsgEntry);
+    }
+}
+
+static void trim_message_details_pool(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    while (transport_data->telemetry_freeEntriesCount > transport_data->telemetry_poolSize)
+    {
+        MQTT_MESSAGE_DETAILS_LIST* freeEntry = transport_data->telemetry_freeEntries;
+        transport_data->telemetry_freeEntries = (MQTT_MESSAGE_DETAILS_LIST*)freeEntry->entry.Flink;
+        transport_data->telemetry_freeEntriesCount--;
+        free(freeEntry);
+    }
+}
+
+static void track_inflight_message(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry)
+{
+    MQTT_MESSAGE_DETAILS_LIST** bucket = &transport_data->telemetry_ackIndex[mqttMsgEntry->packet_id % TELEMETRY_ACK_INDEX_SIZE];
+    mqttMsgEntry->nextInAckBucket = *bucket;
+    *bucket = mqttMsgEntry;
+    DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
+    transport_data->telemetry_inFlightCount++;
+    transport_data->telemetry_inFlightMessages += mqttMsgEntry->messageCount;
+}
+
+static void untrack_inflight_message(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry)
+{
+    MQTT_MESSAGE_DETAILS_LIST** bucket = &transport_data->telemetry_ackIndex[mqttMsgEntry->packet_id % TELEMETRY_ACK_INDEX_SIZE];
+    while (*bucket != NULL && *bucket != mqttMsgEntry)
+    {
+        bucket = &(*bucket)->nextInAckBucket;
+    }
+    if (*bucket != NULL)
+    {
+        *bucket = mqttMsgEntry->nextInAckBucket;
+    }
+    (void)DList_RemoveEntryList(&(mqttMsgEntry->entry));
+    transport_data->telemetry_inFlightCount--;
+    transport_data->telemetry_inFlightMessages -= mqttMsgEntry->messageCount;
+}
+
+static bool is_inflight_window_open(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    return (transport_data->telemetry_maxInFlight == 0 || transport_data->telemetry_inFlightCount < transport_data->telemetry_maxInFlight);
+}
+
+static MQTT_MESSAGE_DETAILS_LIST* find_inflight_message(PMQTTTRANSPORT_HANDLE_DATA transport_data, uint16_t packet_id)
+{
+    MQTT_MESSAGE_DETAILS_LIST* result = transport_data->telemetry_ackIndex[packet_id % TELEMETRY_ACK_INDEX_SIZE];
+    while (result != NULL && result->packet_id != packet_id)
+    {
+        result = result->nextInAckBucket;
+    }
+    return result;
+}
+
 static void free_proxy_data(MQTTTRANSPORT_HANDLE_DATA* mqtt_transport_instance)
 {
     if (mqtt_transport_instance->http_proxy_hostname != NULL)
@@ -799,69 +932,259 @@ static void sendMsgComplete(IOTHUB_MESSAGE_LIST* iothubMsgList, PMQTTTRANSPORT_H
     IoTHubClient_LL_SendComplete(transport_data->llClientHandle, &messageCompleted, confirmResult);
 }
 
-static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_message_handle, const char* eventTopic)
+static void complete_message_details(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_RESULT confirmResult)
 {
-    STRING_HANDLE result = STRING_construct(eventTopic);
-    const char* const* propertyKeys;
-    const char* const* propertyValues;
-    size_t propertyCount;
-    size_t index = 0;
+    if (mqttMsgEntry->batchPayload != NULL)
+    {
+        IoTHubClient_LL_SendComplete(transport_data->llClientHandle, &(mqttMsgEntry->batchedMessages), confirmResult);
+    }
+    else
+    {
+        sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, confirmResult);
+    }
+}
 
-    // Construct Properties
-    MAP_HANDLE properties_map = IoTHubMessage_Properties(iothub_message_handle);
-    if (properties_map != NULL)
+static bool is_url_unreserved_char(char value)
+{
+    return ((value >= 'a' && value <= 'z') || (value >= 'A' && value <= 'Z') || (value >= '0' && value <= '9') ||
+        value == '-' || value == '.' || value == '_' || value == '~');
+}
+
+static size_t get_url_encoded_length(const char* text)
+{
+    size_t result = 0;
+    while (*text != '\0')
+    {
+        result += is_url_unreserved_char(*text) ? 1 : 3;
+        text++;
+    }
+    return result;
+}
+
+static char* write_url_encoded(char* destination, const char* text)
+{
+    static const char hex_digits[] = "0123456789ABCDEF";
+    while (*text != '\0')
     {
-        if (Map_GetInternals(properties_map, &propertyKeys, &propertyValues, &propertyCount) != MAP_OK)
+        if (is_url_unreserved_char(*text))
         {
-            LogError("Failed to get the internals of the property map.");
-            STRING_delete(result);
-            result = NULL;
+            *destination++ = *text;
+        }
+        else
+        {
+            *destination++ = '%';
+            *destination++ = hex_digits[((unsigned char)*text) >> 4];
+            *destination++ = hex_digits[((unsigned char)*text) & 0x0F];
+        }
+        text++;
+    }
+    return destination;
+}
+
+static bool match_cached_property_token(const char** cached, const char* cached_end, const char* token)
+{
+    bool result;
+    size_t token_length = strlen(token) + 1;
+    if ((size_t)(cached_end - *cached) < token_length || memcmp(*cached, token, token_length) != 0)
+    {
+        result = false;
+    }
+    else
+    {
+        *cached += token_length;
+        result = true;
+    }
+    return result;
+}
+
+static bool is_topic_prefix_cached(PMQTTTRANSPORT_HANDLE_DATA transport_data, const char* const* propertyKeys, const char* const* propertyValues, size_t propertyCount)
+{
+    bool result;
+    if (transport_data->telemetry_topicPrefix == NULL)
+    {
+        result = false;
+    }
+    else
+    {
+        const char* cached = transport_data->telemetry_topicPropertySource;
+        const char* cached_end = cached + transport_data->telemetry_topicPropertySourceLength;
+        size_t index;
+
+        result = true;
+        for (index = 0; index < propertyCount && result; index++)
+        {
+            result = match_cached_property_token(&cached, cached_end, propertyKeys[index]) &&
+                match_cached_property_token(&cached, cached_end, propertyValues[index]);
+        }
+        if (result && cached != cached_end)
+        {
+            result = false;
+        }
+    }
+    return result;
+}
+
+static int update_topic_prefix_cache(PMQTTTRANSPORT_HANDLE_DATA transport_data, const char* const* propertyKeys, const char* const* propertyValues, size_t propertyCount)
+{
+    int result;
+    const char* event_topic = STRING_c_str(transport_data->topic_MqttEvent);
+    if (event_topic == NULL)
+    {
+        LogError("Failure getting the event topic.");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t event_topic_length = strlen(event_topic);
+        size_t prefix_length = event_topic_length;
+        size_t source_length = 0;
+        char* cache;
+        size_t index;
+
+        for (index = 0; index < propertyCount; index++)
+        {
+            prefix_length += (index == 0 ? 0 : 1) + get_url_encoded_length(propertyKeys[index]) + 1 + get_url_encoded_length(propertyValues[index]);
+            source_length += strlen(propertyKeys[index]) + 1 + strlen(propertyValues[index]) + 1;
+        }
+
+        /* The encoded prefix and the raw key\0value\0 pairs it was built from share one allocation */
+        if ((cache = (char*)malloc(prefix_length + 1 + source_length)) == NULL)
+        {
+            LogError("Failure allocating the telemetry topic prefix.");
+            result = __FAILURE__;
         }
         else
         {
-            if (propertyCount != 0)
+            char* iterator = cache;
+            (void)memcpy(iterator, event_topic, event_topic_length);
+            iterator += event_topic_length;
+            for (index = 0; index < propertyCount; index++)
             {
-                for (index = 0; index < propertyCount && result != NULL; index++)
+                if (index != 0)
                 {
-                    if (STRING_sprintf(result, "%s=%s%s", propertyKeys[index], propertyValues[index], propertyCount - 1 == index ? "" : PROPERTY_SEPARATOR) != 0)
-                    {
-                        LogError("Failed construting property string.");
-                        STRING_delete(result);
-                        result = NULL;
-                    }
+                    *iterator++ = *PROPERTY_SEPARATOR;
                 }
+                iterator = write_url_encoded(iterator, propertyKeys[index]);
+                *iterator++ = '=';
+                iterator = write_url_encoded(iterator, propertyValues[index]);
+            }
+            *iterator++ = '\0';
+
+            transport_data->telemetry_topicPropertySource = iterator;
+            for (index = 0; index < propertyCount; index++)
+            {
+                size_t key_length = strlen(propertyKeys[index]) + 1;
+                size_t value_length = strlen(propertyValues[index]) + 1;
+                (void)memcpy(iterator, propertyKeys[index], key_length);
+                iterator += key_length;
+                (void)memcpy(iterator, propertyValues[index], value_length);
+                iterator += value_length;
+            }
+
+            if (transport_data->telemetry_topicPrefix != NULL)
+            {
+                free(transport_data->telemetry_topicPrefix);
             }
+            transport_data->telemetry_topicPrefix = cache;
+            transport_data->telemetry_topicPrefixLength = prefix_length;
+            transport_data->telemetry_topicPropertySourceLength = source_length;
+            result = 0;
         }
     }
+    return result;
+}
 
-    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_07_052: [ IoTHubTransport_MQTT_Common_DoWork shall check for the CorrelationId property and if found add the value as a system property in the format of $.cid=<id> ] */
-    if (result != NULL)
+static size_t get_system_property_length(const char* name, const char* value, bool needs_separator)
+{
+    return (value == NULL) ? 0 : (needs_separator ? 1 : 0) + strlen(name) + get_url_encoded_length(value);
+}
+
+static char* write_system_property(char* destination, const char* name, const char* value, bool needs_separator)
+{
+    if (value != NULL)
     {
-        const char* correlation_id = IoTHubMessage_GetCorrelationId(iothub_message_handle);
-        if (correlation_id != NULL)
+        size_t name_length = strlen(name);
+        if (needs_separator)
         {
-            if (STRING_sprintf(result, "%s%%24.cid=%s", index == 0 ? "" : PROPERTY_SEPARATOR, correlation_id) != 0)
-            {
-                LogError("Failed setting correlation_id.");
-                STRING_delete(result);
-                result = NULL;
-            }
-            index++;
+            *destination++ = *PROPERTY_SEPARATOR;
         }
+        (void)memcpy(destination, name, name_length);
+        destination = write_url_encoded(destination + name_length, value);
     }
+    return destination;
+}
 
-    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_07_053: [ IoTHubTransport_MQTT_Common_DoWork shall check for the MessageId property and if found add the value as a system property in the format of $.mid=<id> ] */
-    if (result != NULL)
+/* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_003: [ IoTHubTransport_MQTT_Common_DoWork shall build the telemetry topic in a single buffer sized once, URL-encoding the property keys and values. ] */
+static char* build_telemetry_topic(PMQTTTRANSPORT_HANDLE_DATA transport_data, IOTHUB_MESSAGE_HANDLE iothub_message_handle)
+{
+    char* result;
+    const char* const* propertyKeys = NULL;
+    const char* const* propertyValues = NULL;
+    size_t propertyCount = 0;
+
+    // Construct Properties
+    MAP_HANDLE properties_map = IoTHubMessage_Properties(iothub_message_handle);
+    if (properties_map != NULL && Map_GetInternals(properties_map, &propertyKeys, &propertyValues, &propertyCount) != MAP_OK)
+    {
+        LogError("Failed to get the internals of the property map.");
+        result = NULL;
+    }
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_004: [ IoTHubTransport_MQTT_Common_DoWork shall reuse the encoded topic prefix of the previous telemetry message when the application properties are identical. ] */
+    else if (!is_topic_prefix_cached(transport_data, propertyKeys, propertyValues, propertyCount) &&
+        update_topic_prefix_cache(transport_data, propertyKeys, propertyValues, propertyCount) != 0)
     {
+        LogError("Failed construting property string.");
+        result = NULL;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_07_052: [ IoTHubTransport_MQTT_Common_DoWork shall check for the CorrelationId property and if found add the value as a system property in the format of $.cid=<id> ] */
+        const char* correlation_id = IoTHubMessage_GetCorrelationId(iothub_message_handle);
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_07_053: [ IoTHubTransport_MQTT_Common_DoWork shall check for the MessageId property and if found add the value as a system property in the format of $.mid=<id> ] */
         const char* msg_id = IoTHubMessage_GetMessageId(iothub_message_handle);
-        if (msg_id != NULL)
+        bool cid_needs_separator = (propertyCount != 0);
+        bool mid_needs_separator = (propertyCount != 0 || correlation_id != NULL);
+        size_t topic_length = transport_data->telemetry_topicPrefixLength +
+            get_system_property_length(SYS_PROP_CORRELATION_ID, correlation_id, cid_needs_separator) +
+            get_system_property_length(SYS_PROP_MESSAGE_ID, msg_id, mid_needs_separator);
+
+        if ((result = (char*)malloc(topic_length + 1)) == NULL)
         {
-            if (STRING_sprintf(result, "%s%%24.mid=%s", index == 0 ? "" : PROPERTY_SEPARATOR, msg_id) != 0)
-            {
-                LogError("Failed setting correlation_id.");
-                STRING_delete(result);
-                result = NULL;
-            }
+            LogError("Failure allocating the telemetry topic.");
+        }
+        else
+        {
+            char* iterator = result;
+            (void)memcpy(iterator, transport_data->telemetry_topicPrefix, transport_data->telemetry_topicPrefixLength);
+            iterator += transport_data->telemetry_topicPrefixLength;
+            iterator = write_system_property(iterator, SYS_PROP_CORRELATION_ID, correlation_id, cid_needs_separator);
+            iterator = write_system_property(iterator, SYS_PROP_MESSAGE_ID, msg_id, mid_needs_separator);
+            *iterator = '\0';
+        }
+    }
+    return result;
+}
+
+static char* build_batch_topic(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    char* result;
+    const char* event_topic = STRING_c_str(transport_data->topic_MqttEvent);
+    if (event_topic == NULL)
+    {
+        LogError("Failure getting the event topic.");
+        result = NULL;
+    }
+    else
+    {
+        size_t event_topic_length = strlen(event_topic);
+        if ((result = (char*)malloc(event_topic_length + sizeof(BATCH_TOPIC_PROPERTIES))) == NULL)
+        {
+            LogError("Failure allocating the batch topic.");
+        }
+        else
+        {
+            (void)memcpy(result, event_topic, event_topic_length);
+            (void)memcpy(result + event_topic_length, BATCH_TOPIC_PROPERTIES, sizeof(BATCH_TOPIC_PROPERTIES));
         }
     }
     return result;
@@ -870,14 +1193,17 @@ static STRING_HANDLE addPropertiesTouMqttMessage(IOTHUB_MESSAGE_HANDLE iothub_me
 static int publish_mqtt_telemetry_msg(PMQTTTRANSPORT_HANDLE_DATA transport_data, MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry, const unsigned char* payload, size_t len)
 {
     int result;
-    STRING_HANDLE msgTopic = addPropertiesTouMqttMessage(mqttMsgEntry->iotHubMessageEntry->messageHandle, STRING_c_str(transport_data->topic_MqttEvent));
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_010: [ A batch shall be published to the event topic with the system properties $.ct=application/vnd.microsoft.iothub.json and $.ce=utf-8. ] */
+    char* msgTopic = (mqttMsgEntry->batchPayload != NULL) ?
+        build_batch_topic(transport_data) :
+        build_telemetry_topic(transport_data, mqttMsgEntry->iotHubMessageEntry->messageHandle);
     if (msgTopic == NULL)
     {
         result = __FAILURE__;
     }
     else
     {
-        MQTT_MESSAGE_HANDLE mqttMsg = mqttmessage_create(mqttMsgEntry->packet_id, STRING_c_str(msgTopic), DELIVER_AT_LEAST_ONCE, payload, len);
+        MQTT_MESSAGE_HANDLE mqttMsg = mqttmessage_create(mqttMsgEntry->packet_id, msgTopic, DELIVER_AT_LEAST_ONCE, payload, len);
         if (mqttMsg == NULL)
         {
             result = __FAILURE__;
@@ -898,12 +1224,13 @@ static int publish_mqtt_telemetry_msg(PMQTTTRANSPORT_HANDLE_DATA transport_data,
                 else
                 {
                     mqttMsgEntry->retryCount++;
+                    transport_data->stats_bytesSent += len;
                     result = 0;
                 }
             }
             mqttmessage_destroy(mqttMsg);
         }
-        STRING_delete(msgTopic);
+        free(msgTopic);
     }
     return result;
 }
@@ -1243,6 +1570,7 @@ static void mqtt_notification_callback(MQTT_MESSAGE_HANDLE msgHandle, void* call
                 else
                 {
                     const APP_PAYLOAD* payload = mqttmessage_getApplicationMsg(msgHandle);
+                    transportData->stats_bytesReceived += payload->length;
                     if (notification_msg)
                     {
                         IoTHubClient_LL_RetrievePropertyComplete(transportData->llClientHandle, DEVICE_TWIN_UPDATE_PARTIAL, payload->message, payload->length);
@@ -1308,6 +1636,7 @@ static void mqtt_notification_callback(MQTT_MESSAGE_HANDLE msgHandle, void* call
                         {
                             /* CodesSRS_IOTHUB_MQTT_TRANSPORT_07_053: [ If type is IOTHUB_TYPE_DEVICE_METHODS, then on success mqtt_notification_callback shall call IoTHubClient_LL_DeviceMethodComplete. ] */
                             const APP_PAYLOAD* payload = mqttmessage_getApplicationMsg(msgHandle);
+                            transportData->stats_bytesReceived += payload->length;
                             if (IoTHubClient_LL_DeviceMethodComplete(transportData->llClientHandle, STRING_c_str(method_name), payload->message, payload->length, (void*)dev_method_info) != 0)
                             {
                                 LogError("Failure: IoTHubClient_LL_DeviceMethodComplete");
@@ -1322,7 +1651,9 @@ static void mqtt_notification_callback(MQTT_MESSAGE_HANDLE msgHandle, void* call
             else
             {
                 const APP_PAYLOAD* appPayload = mqttmessage_getApplicationMsg(msgHandle);
-                IOTHUB_MESSAGE_HANDLE IoTHubMessage = IoTHubMessage_CreateFromByteArray(appPayload->message, appPayload->length);
+                IOTHUB_MESSAGE_HANDLE IoTHubMessage;
+                transportData->stats_bytesReceived += appPayload->length;
+                IoTHubMessage = IoTHubMessage_CreateFromByteArray(appPayload->message, appPayload->length);
                 if (IoTHubMessage == NULL)
                 {
                     LogError("Failure: IotHub Message creation has failed.");
@@ -1377,20 +1708,13 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
                 const PUBLISH_ACK* puback = (const PUBLISH_ACK*)msgInfo;
                 if (puback != NULL)
                 {
-                    PDLIST_ENTRY currentListEntry = transport_data->telemetry_waitingForAck.Flink;
-                    while (currentListEntry != &transport_data->telemetry_waitingForAck)
+                    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_007: [ The PUBACK shall be matched to the in-flight telemetry message through an index keyed by packet id. ] */
+                    MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = find_inflight_message(transport_data, puback->packetId);
+                    if (mqttMsgEntry != NULL)
                     {
-                        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentListEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
-                        DLIST_ENTRY saveListEntry;
-                        saveListEntry.Flink = currentListEntry->Flink;
-
-                        if (puback->packetId == mqttMsgEntry->packet_id)
-                        {
-                            (void)DList_RemoveEntryList(currentListEntry); //First remove the item from Waiting for Ack List.
-                            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_OK);
-                            free(mqttMsgEntry);
-                        }
-                        currentListEntry = saveListEntry.Flink;
+                        untrack_inflight_message(transport_data, mqttMsgEntry); //First remove the item from Waiting for Ack List.
+                        complete_message_details(transport_data, mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_OK);
+                        release_message_details(transport_data, mqttMsgEntry);
                     }
                 }
                 else
@@ -1410,6 +1734,11 @@ static void mqtt_operation_complete_callback(MQTT_CLIENT_HANDLE handle, MQTT_CLI
                         transport_data->currPacketState = CONNACK_TYPE;
                         transport_data->isRecoverableError = true;
                         transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_CONNECTED;
+                        if (transport_data->stats_hasConnected)
+                        {
+                            transport_data->stats_reconnectCount++;
+                        }
+                        transport_data->stats_hasConnected = true;
                         StopRetryTimer(transport_data->retryLogic);
                         IoTHubClient_LL_ConnectionStatusCallBack(transport_data->llClientHandle, IOTHUB_CLIENT_CONNECTION_AUTHENTICATED, IOTHUB_CLIENT_CONNECTION_OK);
                     }
@@ -1640,6 +1969,361 @@ static const unsigned char* RetrieveMessagePayload(IOTHUB_MESSAGE_HANDLE message
     return result;
 }
 
+static const unsigned char* retrieve_message_details_payload(MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry, size_t* length)
+{
+    const unsigned char* result;
+    if (mqttMsgEntry->batchPayload != NULL)
+    {
+        result = (const unsigned char*)STRING_c_str(mqttMsgEntry->batchPayload);
+        *length = STRING_length(mqttMsgEntry->batchPayload);
+    }
+    else
+    {
+        result = RetrieveMessagePayload(mqttMsgEntry->iotHubMessageEntry->messageHandle, length);
+    }
+    return result;
+}
+
+/*publishes one IoTHub message in its own PUBLISH; a message without payload is left in waitingToSend*/
+static int publish_telemetry_message(PMQTTTRANSPORT_HANDLE_DATA transport_data, IOTHUB_MESSAGE_LIST* iothubMsgList)
+{
+    int result;
+    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
+    size_t messageLength;
+    const unsigned char* messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
+    if (messageLength == 0 || messagePayload == NULL)
+    {
+        LogError("Failure result from IoTHubMessage_GetData");
+        result = __FAILURE__;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_029: [IoTHubTransport_MQTT_Common_DoWork shall create a MQTT_MESSAGE_HANDLE and pass this to a call to mqtt_client_publish.] */
+        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = allocate_message_details(transport_data);
+        if (mqttMsgEntry == NULL)
+        {
+            LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
+            result = __FAILURE__;
+        }
+        else
+        {
+            mqttMsgEntry->retryCount = 0;
+            mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
+            mqttMsgEntry->messageCount = 1;
+            mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
+            int publishResult = publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength);
+            (void)(DList_RemoveEntryList(&(iothubMsgList->entry)));
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_018: [ Every message taken off waitingToSend shall have its inWaitingToSend flag cleared. ] */
+            iothubMsgList->inWaitingToSend = false;
+            if (publishResult != 0)
+            {
+                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+                release_message_details(transport_data, mqttMsgEntry);
+                result = __FAILURE__;
+            }
+            else
+            {
+                track_inflight_message(transport_data, mqttMsgEntry);
+                transport_data->stats_messagesSent++;
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+static size_t get_pending_telemetry_size(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    size_t result = 0;
+    PDLIST_ENTRY currentListEntry = transport_data->waitingToSend->Flink;
+    while (currentListEntry != transport_data->waitingToSend && result < transport_data->telemetry_batchMaxSize)
+    {
+        IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
+        size_t messageLength;
+        (void)RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
+        result += messageLength;
+        currentListEntry = currentListEntry->Flink;
+    }
+    return result;
+}
+
+/*appends ,"properties":{"iothub-app-a":"valueOfA"} when the message has application properties*/
+static int append_batch_item_properties(STRING_HANDLE item, IOTHUB_MESSAGE_HANDLE messageHandle)
+{
+    int result;
+    const char* const* keys;
+    const char* const* values;
+    size_t count;
+    MAP_HANDLE properties_map = IoTHubMessage_Properties(messageHandle);
+    if (properties_map == NULL)
+    {
+        result = 0;
+    }
+    else if (Map_GetInternals(properties_map, &keys, &values, &count) != MAP_OK)
+    {
+        LogError("Failed to get the internals of the property map.");
+        result = __FAILURE__;
+    }
+    else if (count == 0)
+    {
+        result = 0;
+    }
+    else if (STRING_concat(item, ",\"properties\":{") != 0)
+    {
+        LogError("unable to STRING_concat");
+        result = __FAILURE__;
+    }
+    else
+    {
+        size_t index;
+        for (index = 0; index < count; index++)
+        {
+            if (!(
+                (STRING_concat(item, (index == 0) ? "\"" IOTHUB_APP_PREFIX : ",\"" IOTHUB_APP_PREFIX) == 0) &&
+                (STRING_concat(item, keys[index]) == 0) &&
+                (STRING_concat(item, "\":\"") == 0) &&
+                (STRING_concat(item, values[index]) == 0) &&
+                (STRING_concat(item, "\"") == 0)
+                ))
+            {
+                LogError("unable to STRING_concat");
+                break;
+            }
+        }
+
+        if (index < count || STRING_concat(item, "}") != 0)
+        {
+            result = __FAILURE__;
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    return result;
+}
+
+/*a batch item has no place for the system properties, see publish_telemetry_batch*/
+static bool can_be_batched(IOTHUB_MESSAGE_HANDLE messageHandle)
+{
+    return (IoTHubMessage_GetMessageId(messageHandle) == NULL) && (IoTHubMessage_GetCorrelationId(messageHandle) == NULL);
+}
+
+/*makes {"body":"base64 encoding of the message content"[,"properties":{...}]} or {"body":"JSON string","base64Encoded":false[,"properties":{...}]}, same as the HTTP batch items*/
+static STRING_HANDLE make_batch_item(IOTHUB_MESSAGE_HANDLE messageHandle)
+{
+    STRING_HANDLE result;
+    STRING_HANDLE body;
+    IOTHUBMESSAGE_CONTENT_TYPE contentType = IoTHubMessage_GetContentType(messageHandle);
+
+    if (contentType == IOTHUBMESSAGE_BYTEARRAY)
+    {
+        const unsigned char* source;
+        size_t size;
+        if (IoTHubMessage_GetByteArray(messageHandle, &source, &size) != IOTHUB_MESSAGE_OK)
+        {
+            LogError("Failure result from IoTHubMessage_GetByteArray");
+            body = NULL;
+        }
+        else
+        {
+            body = Base64_Encode_Bytes(source, size);
+        }
+        result = (body == NULL) ? NULL : STRING_construct("{\"body\":\"");
+    }
+    else if (contentType == IOTHUBMESSAGE_STRING)
+    {
+        const char* source = IoTHubMessage_GetString(messageHandle);
+        if (source == NULL)
+        {
+            LogError("Failure result from IoTHubMessage_GetString");
+            body = NULL;
+        }
+        else
+        {
+            body = STRING_new_JSON(source);
+        }
+        result = (body == NULL) ? NULL : STRING_construct("{\"body\":");
+    }
+    else
+    {
+        LogError("Unsupported message content type");
+        body = NULL;
+        result = NULL;
+    }
+
+    if (result != NULL)
+    {
+        if (!(
+            (STRING_concat_with_STRING(result, body) == 0) &&
+            (STRING_concat(result, (contentType == IOTHUBMESSAGE_BYTEARRAY) ? "\"" : ",\"base64Encoded\":false") == 0) &&
+            (append_batch_item_properties(result, messageHandle) == 0) &&
+            (STRING_concat(result, "}") == 0)
+            ))
+        {
+            LogError("unable to build the batch item");
+            STRING_delete(result);
+            result = NULL;
+        }
+    }
+    else
+    {
+        LogError("Failure encoding the message for the batch");
+    }
+
+    if (body != NULL)
+    {
+        STRING_delete(body);
+    }
+    return result;
+}
+
+/* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_011: [ The messages of a batch shall be serialized as a JSON array, the same format as the HTTP transport, holding as many messages from the head of waitingToSend as fit in the configured size; a single message larger than the size is sent alone. ] */
+static int publish_telemetry_batch(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    int result;
+    IOTHUB_MESSAGE_LIST* headMsgList = containingRecord(transport_data->waitingToSend->Flink, IOTHUB_MESSAGE_LIST, entry);
+    MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry;
+    /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_017: [ A message with a messageId or a correlationId shall not be batched: it shall end the batch before it and be published alone with its system properties in the topic. ] */
+    if (!can_be_batched(headMsgList->messageHandle))
+    {
+        result = publish_telemetry_message(transport_data, headMsgList);
+    }
+    else if ((mqttMsgEntry = allocate_message_details(transport_data)) == NULL)
+    {
+        LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
+        result = __FAILURE__;
+    }
+    else if ((mqttMsgEntry->batchPayload = STRING_construct("[")) == NULL)
+    {
+        LogError("Failure allocating the batch payload.");
+        release_message_details(transport_data, mqttMsgEntry);
+        result = __FAILURE__;
+    }
+    else
+    {
+        PDLIST_ENTRY currentListEntry = transport_data->waitingToSend->Flink;
+        size_t itemCount = 0;
+        bool failed = false;
+
+        DList_InitializeListHead(&(mqttMsgEntry->batchedMessages));
+        while (currentListEntry != transport_data->waitingToSend)
+        {
+            IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
+            PDLIST_ENTRY nextListEntry = currentListEntry->Flink;
+            STRING_HANDLE item;
+            // The head of waitingToSend has been checked already
+            if (itemCount != 0 && !can_be_batched(iothubMsgList->messageHandle))
+            {
+                break;
+            }
+            else if ((item = make_batch_item(iothubMsgList->messageHandle)) == NULL)
+            {
+                (void)DList_RemoveEntryList(currentListEntry);
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_018: [ Every message taken off waitingToSend shall have its inWaitingToSend flag cleared. ] */
+                iothubMsgList->inWaitingToSend = false;
+                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+            }
+            else
+            {
+                // Room for the separating ',' and the closing ']'
+                if (itemCount != 0 && STRING_length(mqttMsgEntry->batchPayload) + STRING_length(item) + 2 > transport_data->telemetry_batchMaxSize)
+                {
+                    STRING_delete(item);
+                    break;
+                }
+                else if ((itemCount != 0 && STRING_concat(mqttMsgEntry->batchPayload, ",") != 0) ||
+                    STRING_concat_with_STRING(mqttMsgEntry->batchPayload, item) != 0)
+                {
+                    LogError("Failure appending to the batch payload.");
+                    STRING_delete(item);
+                    failed = true;
+                    break;
+                }
+                else
+                {
+                    (void)DList_RemoveEntryList(currentListEntry);
+                    iothubMsgList->inWaitingToSend = false;
+                    DList_InsertTailList(&(mqttMsgEntry->batchedMessages), currentListEntry);
+                    itemCount++;
+                    STRING_delete(item);
+                }
+            }
+            currentListEntry = nextListEntry;
+        }
+
+        if (itemCount == 0)
+        {
+            release_message_details(transport_data, mqttMsgEntry);
+            result = failed ? __FAILURE__ : 0;
+        }
+        else if (failed || STRING_concat(mqttMsgEntry->batchPayload, "]") != 0)
+        {
+            complete_message_details(transport_data, mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+            release_message_details(transport_data, mqttMsgEntry);
+            result = __FAILURE__;
+        }
+        else
+        {
+            size_t payloadLength;
+            const unsigned char* payload = retrieve_message_details_payload(mqttMsgEntry, &payloadLength);
+            mqttMsgEntry->retryCount = 0;
+            mqttMsgEntry->iotHubMessageEntry = NULL;
+            mqttMsgEntry->messageCount = itemCount;
+            mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
+            if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, payload, payloadLength) != 0)
+            {
+                complete_message_details(transport_data, mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+                release_message_details(transport_data, mqttMsgEntry);
+                result = __FAILURE__;
+            }
+            else
+            {
+                track_inflight_message(transport_data, mqttMsgEntry);
+                transport_data->stats_messagesSent += itemCount;
+                result = 0;
+            }
+        }
+    }
+    return result;
+}
+
+/* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_012: [ When batching is enabled IoTHubTransport_MQTT_Common_DoWork shall hold the messages in waitingToSend until the oldest has lingered for the configured time or the pending payloads reach the batch size, then publish batches while the in-flight window is open. ] */
+static void send_batched_telemetry(PMQTTTRANSPORT_HANDLE_DATA transport_data)
+{
+    tickcounter_ms_t current_ms;
+    if (DList_IsListEmpty(transport_data->waitingToSend))
+    {
+        transport_data->telemetry_batchLingerStarted = false;
+    }
+    else if (tickcounter_get_current_ms(transport_data->msgTickCounter, &current_ms) != 0)
+    {
+        LogError("Failed retrieving tickcounter info");
+    }
+    else
+    {
+        if (!transport_data->telemetry_batchLingerStarted)
+        {
+            transport_data->telemetry_batchLingerStarted = true;
+            transport_data->telemetry_batchLingerStart = current_ms;
+        }
+
+        if ((current_ms - transport_data->telemetry_batchLingerStart) >= transport_data->telemetry_batchLingerMs ||
+            get_pending_telemetry_size(transport_data) >= transport_data->telemetry_batchMaxSize)
+        {
+            while (!DList_IsListEmpty(transport_data->waitingToSend) && is_inflight_window_open(transport_data))
+            {
+                if (publish_telemetry_batch(transport_data) != 0)
+                {
+                    break;
+                }
+            }
+            // Whatever is left behind has already lingered, keep the timer running so it goes out next time
+            transport_data->telemetry_batchLingerStarted = !DList_IsListEmpty(transport_data->waitingToSend);
+        }
+    }
+}
+
 static int GetTransportProviderIfNecessary(PMQTTTRANSPORT_HANDLE_DATA transport_data)
 {
     int result;
@@ -1679,7 +2363,7 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
 {
     int result;
 
-    char* sasToken = NULL;
+    const char* sasToken = NULL;
     result = 0;
 
     IOTHUB_CREDENTIAL_TYPE cred_type = IoTHubClient_Auth_Get_Credential_Type(transport_data->authorization_module);
@@ -1687,7 +2371,7 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
     {
         size_t secSinceEpoch = (size_t)(difftime(get_time(NULL), EPOCH_TIME_T_VALUE) + 0);
         size_t expiryTime = secSinceEpoch + SAS_TOKEN_DEFAULT_LIFETIME;
-        sasToken = IoTHubClient_Auth_Get_SasToken(transport_data->authorization_module, STRING_c_str(transport_data->devicesPath), expiryTime);
+        sasToken = IoTHubClient_Auth_Get_Cached_SasToken(transport_data->authorization_module, STRING_c_str(transport_data->devicesPath), expiryTime);
         if (sasToken == NULL)
         {
             LogError("failure getting sas Token.");
@@ -1709,7 +2393,7 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
         }
         else
         {
-            sasToken = IoTHubClient_Auth_Get_SasToken(transport_data->authorization_module, NULL, 0);
+            sasToken = IoTHubClient_Auth_Get_Cached_SasToken(transport_data->authorization_module, NULL, 0);
             if (sasToken == NULL)
             {
                 LogError("failure getting sas Token.");
@@ -1763,7 +2447,7 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
         options.username = (char*)STRING_c_str(transport_data->configPassedThroughUsername);
         if (sasToken != NULL)
         {
-            options.password = sasToken;
+            options.password = (char*)sasToken;
         }
         options.keepAliveInterval = transport_data->keepAliveValue;
         options.useCleanSession = false;
@@ -1779,6 +2463,8 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
             else
             {
                 (void)tickcounter_get_current_ms(transport_data->msgTickCounter, &transport_data->mqtt_connect_time);
+                /*Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_016: [ Once mqtt_client_connect succeeds, IoTHubTransport_MQTT_Common_DoWork shall reconnect to refresh the SAS token after the time returned by IoTHubClient_Auth_Get_SasToken_Refresh_Time for 80% of the SAS token lifetime. ]*/
+                transport_data->sas_token_refresh_time = IoTHubClient_Auth_Get_SasToken_Refresh_Time(transport_data->authorization_module, (size_t)(SAS_TOKEN_DEFAULT_LIFETIME*SAS_REFRESH_MULTIPLIER));
                 result = 0;
             }
         }
@@ -1786,11 +2472,6 @@ static int SendMqttConnectMsg(PMQTTTRANSPORT_HANDLE_DATA transport_data)
         {
             result = __FAILURE__;
         }
-            
-        if (sasToken != NULL)
-        {
-            free(sasToken);
-        }
     }
     return result;
 }
@@ -1863,9 +2544,10 @@ static int InitializeConnection(PMQTTTRANSPORT_HANDLE_DATA transport_data)
             }
             else
             {
-                if ((current_time - transport_data->mqtt_connect_time) / 1000 > (SAS_TOKEN_DEFAULT_LIFETIME*SAS_REFRESH_MULTIPLIER))
+                if ((current_time - transport_data->mqtt_connect_time) / 1000 > transport_data->sas_token_refresh_time)
                 {
                     (void)mqtt_client_disconnect(transport_data->mqttClient);
+                    transport_data->stats_sasTokenRefreshCount++;
                     IoTHubClient_LL_ConnectionStatusCallBack(transport_data->llClientHandle, IOTHUB_CLIENT_CONNECTION_UNAUTHENTICATED, IOTHUB_CLIENT_CONNECTION_EXPIRED_SAS_TOKEN);
                     transport_data->mqttClientStatus = MQTT_CLIENT_STATUS_NOT_CONNECTED;
                     transport_data->currPacketState = UNKNOWN_TYPE;
@@ -2002,6 +2684,7 @@ static PMQTTTRANSPORT_HANDLE_DATA InitializeTransportHandleData(const IOTHUB_CLI
                         state->waitingToSend = waitingToSend;
                         state->currPacketState = CONNECT_TYPE;
                         state->keepAliveValue = DEFAULT_MQTT_KEEPALIVE;
+                        state->sas_token_refresh_time = (size_t)(SAS_TOKEN_DEFAULT_LIFETIME*SAS_REFRESH_MULTIPLIER);
                         state->connectFailCount = 0;
                         state->connectTick = 0;
                         state->topic_MqttMessage = NULL;
@@ -2114,8 +2797,16 @@ void IoTHubTransport_MQTT_Common_Destroy(TRANSPORT_LL_HANDLE handle)
         {
             PDLIST_ENTRY currentEntry = DList_RemoveHeadList(&transport_data->telemetry_waitingForAck);
             MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = containingRecord(currentEntry, MQTT_MESSAGE_DETAILS_LIST, entry);
-            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
-            free(mqttMsgEntry);
+            transport_data->telemetry_inFlightCount--;
+            transport_data->telemetry_inFlightMessages -= mqttMsgEntry->messageCount;
+            complete_message_details(transport_data, mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY);
+            release_message_details(transport_data, mqttMsgEntry);
+        }
+        transport_data->telemetry_poolSize = 0;
+        trim_message_details_pool(transport_data);
+        if (transport_data->telemetry_topicPrefix != NULL)
+        {
+            free(transport_data->telemetry_topicPrefix);
         }
         while (!DList_IsListEmpty(&transport_data->ack_waiting_queue))
         {
@@ -2533,9 +3224,9 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                         if (mqttMsgEntry->retryCount >= MAX_SEND_RECOUNT_LIMIT)
                         {
                             PDLIST_ENTRY current_entry;
-                            (void)DList_RemoveEntryList(currentListEntry);
-                            sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT);
-                            free(mqttMsgEntry);
+                            untrack_inflight_message(transport_data, mqttMsgEntry);
+                            complete_message_details(transport_data, mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT);
+                            release_message_details(transport_data, mqttMsgEntry);
 
                             transport_data->currPacketState = PACKET_TYPE_ERROR;
                             transport_data->device_twin_get_sent = false;
@@ -2554,7 +3245,7 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                         else
                         {
                             size_t messageLength;
-                            const unsigned char* messagePayload = RetrieveMessagePayload(mqttMsgEntry->iotHubMessageEntry->messageHandle, &messageLength);
+                            const unsigned char* messagePayload = retrieve_message_details_payload(mqttMsgEntry, &messageLength);
                             if (messageLength == 0 || messagePayload == NULL)
                             {
                                 LogError("Failure from creating Message IoTHubMessage_GetData");
@@ -2563,9 +3254,9 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
                             {
                                 if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
                                 {
-                                    (void)DList_RemoveEntryList(currentListEntry);
-                                    sendMsgComplete(mqttMsgEntry->iotHubMessageEntry, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                                    free(mqttMsgEntry);
+                                    untrack_inflight_message(transport_data, mqttMsgEntry);
+                                    complete_message_details(transport_data, mqttMsgEntry, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+                                    release_message_details(transport_data, mqttMsgEntry);
                                 }
                             }
                         }
@@ -2575,47 +3266,21 @@ void IoTHubTransport_MQTT_Common_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIEN
 
                 currentListEntry = transport_data->waitingToSend->Flink;
                 /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
-                while (currentListEntry != transport_data->waitingToSend)
+                /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_006: [ IoTHubTransport_MQTT_Common_DoWork shall stop publishing new telemetry messages while the number of unacknowledged messages has reached the in-flight window; the remaining messages stay in waitingToSend. ] */
+                while (transport_data->telemetry_batchMaxSize == 0 && currentListEntry != transport_data->waitingToSend && is_inflight_window_open(transport_data))
                 {
                     IOTHUB_MESSAGE_LIST* iothubMsgList = containingRecord(currentListEntry, IOTHUB_MESSAGE_LIST, entry);
                     DLIST_ENTRY savedFromCurrentListEntry;
                     savedFromCurrentListEntry.Flink = currentListEntry->Flink;
 
-                    /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_027: [IoTHubTransport_MQTT_Common_DoWork shall inspect the "waitingToSend" DLIST passed in config structure.] */
-                    size_t messageLength;
-                    const unsigned char* messagePayload = RetrieveMessagePayload(iothubMsgList->messageHandle, &messageLength);
-                    if (messageLength == 0 || messagePayload == NULL)
-                    {
-                        LogError("Failure result from IoTHubMessage_GetData");
-                    }
-                    else
-                    {
-                        /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_029: [IoTHubTransport_MQTT_Common_DoWork shall create a MQTT_MESSAGE_HANDLE and pass this to a call to mqtt_client_publish.] */
-                        MQTT_MESSAGE_DETAILS_LIST* mqttMsgEntry = (MQTT_MESSAGE_DETAILS_LIST*)malloc(sizeof(MQTT_MESSAGE_DETAILS_LIST));
-                        if (mqttMsgEntry == NULL)
-                        {
-                            LogError("Allocation Error: Failure allocating MQTT Message Detail List.");
-                        }
-                        else
-                        {
-                            mqttMsgEntry->retryCount = 0;
-                            mqttMsgEntry->iotHubMessageEntry = iothubMsgList;
-                            mqttMsgEntry->packet_id = get_next_packet_id(transport_data);
-                            if (publish_mqtt_telemetry_msg(transport_data, mqttMsgEntry, messagePayload, messageLength) != 0)
-                            {
-                                (void)(DList_RemoveEntryList(currentListEntry));
-                                sendMsgComplete(iothubMsgList, transport_data, IOTHUB_CLIENT_CONFIRMATION_ERROR);
-                                free(mqttMsgEntry);
-                            }
-                            else
-                            {
-                                (void)(DList_RemoveEntryList(currentListEntry));
-                                DList_InsertTailList(&(transport_data->telemetry_waitingForAck), &(mqttMsgEntry->entry));
-                            }
-                        }
-                    }
+                    (void)publish_telemetry_message(transport_data, iothubMsgList);
                     currentListEntry = savedFromCurrentListEntry.Flink;
                 }
+
+                if (transport_data->telemetry_batchMaxSize != 0)
+                {
+                    send_batched_telemetry(transport_data);
+                }
             }
             /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_030: [IoTHubTransport_MQTT_Common_DoWork shall call mqtt_client_dowork everytime it is called if it is connected.] */
             mqtt_client_dowork(transport_data->mqttClient);
@@ -2651,6 +3316,32 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_GetSendStatus(IOTHUB_DEVICE_HAN
     return result;
 }
 
+IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_GetStatistics(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (handle == NULL || statistics == NULL)
+    {
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_013: [ IoTHubTransport_MQTT_Common_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ] */
+        LogError("invalid argument (handle=%p, statistics=%p).", handle, statistics);
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else
+    {
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_014: [ IoTHubTransport_MQTT_Common_GetStatistics shall set messagesSent, bytesSent, bytesReceived, reconnectCount and sasTokenRefreshCount from the transport counters and return IOTHUB_CLIENT_OK. ] */
+        MQTTTRANSPORT_HANDLE_DATA* handleData = (MQTTTRANSPORT_HANDLE_DATA*)handle;
+        statistics->messagesSent = handleData->stats_messagesSent;
+        statistics->bytesSent = handleData->stats_bytesSent;
+        statistics->bytesReceived = handleData->stats_bytesReceived;
+        statistics->reconnectCount = handleData->stats_reconnectCount;
+        statistics->sasTokenRefreshCount = handleData->stats_sasTokenRefreshCount;
+        /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_015: [ IoTHubTransport_MQTT_Common_GetStatistics shall set waitingForAckCount to the number of messages carried by the PUBLISHes waiting for their PUBACK. ] */
+        statistics->waitingForAckCount = handleData->telemetry_inFlightMessages;
+        result = IOTHUB_CLIENT_OK;
+    }
+    return result;
+}
+
 IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
     /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_021: [If any parameter is NULL then IoTHubTransport_MQTT_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
@@ -2699,6 +3390,31 @@ IOTHUB_CLIENT_RESULT IoTHubTransport_MQTT_Common_SetOption(TRANSPORT_LL_HANDLE h
             }
             result = IOTHUB_CLIENT_OK;
         }
+        else if (strcmp(OPTION_MESSAGE_POOL_SIZE, option) == 0)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_002: [ If the option parameter is set to "message_pool_size" then the value shall be a size_t* with the number of released message details entries kept for reuse. ]*/
+            transport_data->telemetry_poolSize = *(const size_t*)value;
+            trim_message_details_pool(transport_data);
+            result = IOTHUB_CLIENT_OK;
+        }
+        else if (strcmp(OPTION_MAX_INFLIGHT_MESSAGES, option) == 0)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_005: [ If the option parameter is set to "max_inflight_messages" then the value shall be a size_t* with the maximum number of unacknowledged telemetry messages, 0 meaning no limit. ]*/
+            transport_data->telemetry_maxInFlight = *(const size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
+        else if (strcmp(OPTION_MQTT_BATCH_MAX_SIZE, option) == 0)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_008: [ If the option parameter is set to "mqtt_batch_max_size" then the value shall be a size_t* with the maximum batch payload size in bytes, 0 disabling batching. ] */
+            transport_data->telemetry_batchMaxSize = *(const size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
+        else if (strcmp(OPTION_MQTT_BATCH_LINGER_MS, option) == 0)
+        {
+            /* Codes_SRS_IOTHUB_TRANSPORT_MQTT_COMMON_09_009: [ If the option parameter is set to "mqtt_batch_linger_ms" then the value shall be a size_t* with the longest time in milliseconds a message waits for its batch to fill up. ] */
+            transport_data->telemetry_batchLingerMs = (tickcounter_ms_t)*(const size_t*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
         /* Codes_SRS_IOTHUB_MQTT_TRANSPORT_07_039: [If the option parameter is set to "x509certificate" then the value shall be a const char of the certificate to be used for x509.] */
         else if ((strcmp(OPTION_X509_CERT, option) == 0) && (cred_type != IOTHUB_CREDENTIAL_TYPE_X509 && cred_type != IOTHUB_CREDENTIAL_TYPE_UNKNOWN))
         {
@@ -113,6 +113,12 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportAMQP_GetSendStatus(IOTHUB_DEVICE_HAND
     return IoTHubTransport_AMQP_Common_GetSendStatus(handle, iotHubClientStatus);
 }
 
+static IOTHUB_CLIENT_RESULT IoTHubTransportAMQP_GetStatistics(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    // Codes_SRS_IOTHUBTRANSPORTAMQP_09_021: [IoTHubTransportAMQP_GetStatistics shall get the transport counters by calling into the IoTHubTransport_AMQP_Common_GetStatistics()]
+    return IoTHubTransport_AMQP_Common_GetStatistics(handle, statistics);
+}
+
 static IOTHUB_CLIENT_RESULT IoTHubTransportAMQP_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
     // Codes_SRS_IOTHUBTRANSPORTAMQP_09_017: [IoTHubTransportAMQP_SetOption shall set the options by calling into the IoTHubTransport_AMQP_Common_SetOption()]
@@ -174,7 +180,8 @@ static TRANSPORT_PROVIDER thisTransportProvider =
     IoTHubTransportAMQP_Unsubscribe,                /*pfIoTHubTransport_Unsubscribe IoTHubTransport_Unsubscribe;*/
     IoTHubTransportAMQP_DoWork,                     /*pfIoTHubTransport_DoWork IoTHubTransport_DoWork;*/
     IoTHubTransportAMQP_SetRetryPolicy,             /*pfIoTHubTransport_DoWork IoTHubTransport_SetRetryPolicy;*/
-    IoTHubTransportAMQP_GetSendStatus               /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+    IoTHubTransportAMQP_GetSendStatus,              /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+    IoTHubTransportAMQP_GetStatistics               /*pfIoTHubTransport_GetStatistics IoTHubTransport_GetStatistics;*/
 };
 
 /* Codes_SRS_IOTHUBTRANSPORTAMQP_09_019: [This function shall return a pointer to a structure of type TRANSPORT_PROVIDER having the following values for it's fields:
@@ -191,7 +198,8 @@ IoTHubTransport_Subscribe = IoTHubTransportAMQP_Subscribe
 IoTHubTransport_Unsubscribe = IoTHubTransportAMQP_Unsubscribe
 IoTHubTransport_DoWork = IoTHubTransportAMQP_DoWork
 IoTHubTransport_SetRetryPolicy = IoTHubTransportAMQP_SetRetryPolicy
-IoTHubTransport_SetOption = IoTHubTransportAMQP_SetOption]*/
+IoTHubTransport_SetOption = IoTHubTransportAMQP_SetOption
+IoTHubTransport_GetStatistics = IoTHubTransportAMQP_GetStatistics]*/
 extern const TRANSPORT_PROVIDER* AMQP_Protocol(void)
 {
     return &thisTransportProvider;
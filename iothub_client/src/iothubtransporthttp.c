@@ -10,6 +10,7 @@
 #include "iothub_client_private.h"
 #include "iothub_transport_ll.h"
 #include "iothubtransporthttp.h"
+#include "iothub_client_device_index.h"
 
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/httpapiexsas.h"
@@ -23,6 +24,10 @@
 #include "azure_c_shared_utility/vector.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/agenttime.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/httpapi.h"
+#include "iothub_client_callback_pool.h"
 
 #define IOTHUB_APP_PREFIX "iothub-app-"
 const char* IOTHUB_MESSAGE_ID = "iothub-messageid";
@@ -49,9 +54,22 @@ typedef struct HTTPTRANSPORT_HANDLE_DATA_TAG
     HTTPAPIEX_HANDLE httpApiExHandle;
     bool doBatchedTransfers;
     unsigned int getMinimumPollingTime;
+    unsigned int getMaximumPollingTime; /*0 or not above getMinimumPollingTime means every device polls every getMinimumPollingTime*/
+    size_t maximumPollsPerDoWork; /*0 means no limit*/
+    size_t nextPollDevice; /*index in perDeviceList where the next DoWork starts when maximumPollsPerDoWork is not 0*/
+    size_t eventSendConcurrency;
+    struct DEVICE_WORK_TAG* deviceWork; /*the pooled threads of EventSendConcurrency and their connections, NULL when eventSendConcurrency is 1*/
+    VECTOR_HANDLE httpApiExOptions; /*HTTPAPIEX_SAVED_OPTIONs, passed to the connections created after them; NULL until the first one*/
     VECTOR_HANDLE perDeviceList;
+    DEVICE_INDEX_HANDLE perDeviceIndex; /*the devices of perDeviceList by id and by handle, so lookups do not scan perDeviceList*/
 }HTTPTRANSPORT_HANDLE_DATA;
 
+typedef struct HTTPAPIEX_SAVED_OPTION_TAG
+{
+    STRING_HANDLE name;
+    const void* value; /*cloned by HTTPAPI_CloneOption*/
+} HTTPAPIEX_SAVED_OPTION;
+
 typedef struct HTTPTRANSPORT_PERDEVICE_DATA_TAG
 {
     HTTPTRANSPORT_HANDLE_DATA* transportHandle;
@@ -68,12 +86,51 @@ typedef struct HTTPTRANSPORT_PERDEVICE_DATA_TAG
     bool DoWork_PullMessage;
     time_t lastPollTime;
     bool isFirstPoll;
+    unsigned int pollingTime; /*seconds until the next GET when getMaximumPollingTime is used*/
+    bool hasDeferredSendComplete; /*events sent by a worker thread wait for DoWork to confirm them*/
+    IOTHUB_CLIENT_CONFIRMATION_RESULT deferredSendCompleteResult;
 
     IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle;
     PDLIST_ENTRY waitingToSend;
     DLIST_ENTRY eventConfirmations; /*holds items for event confirmations*/
+
+    /*counters reported by IoTHubTransportHttp_GetStatistics*/
+    uint64_t messagesSent;
+    uint64_t bytesSent;
+    uint64_t bytesReceived;
+
+    bool isPollDue; /*DoWork picked the device for a GET issued ahead of the device loop*/
+    HTTPAPIEX_RESULT pollResult; /*the GET response is kept from GetMessage until ProcessMessage*/
+    unsigned int pollStatusCode;
+    HTTP_HEADERS_HANDLE pollResponseHeaders;
+    BUFFER_HANDLE pollResponseContent;
 } HTTPTRANSPORT_PERDEVICE_DATA;
 
+struct DEVICE_WORK_TAG;
+typedef void(*DEVICE_WORK_FUNCTION)(struct DEVICE_WORK_TAG* work, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, HTTPAPIEX_HANDLE httpApiExHandle);
+
+typedef struct DEVICE_WORKER_TAG
+{
+    struct DEVICE_WORK_TAG* work;
+    HTTPAPIEX_HANDLE httpApiExHandle;
+} DEVICE_WORKER;
+
+/*created when EventSendConcurrency is set and reused by every DoWork, for the events and for the GETs*/
+typedef struct DEVICE_WORK_TAG
+{
+    HTTPTRANSPORT_HANDLE_DATA* handleData;
+    CALLBACK_POOL_HANDLE pool;
+    LOCK_HANDLE lock;
+    COND_HANDLE workerDone; /*posted under lock by every worker that finishes*/
+    size_t workerCount;
+    DEVICE_WORKER* workers; /*workerCount of them, each with its own connection*/
+    DEVICE_WORK_FUNCTION deviceFunction; /*guarded by lock*/
+    time_t pollTime; /*the time the GETs of the devices due for one are issued at*/
+    size_t deviceCount; /*guarded by lock*/
+    size_t nextDevice; /*guarded by lock*/
+    size_t runningWorkers; /*guarded by lock*/
+} DEVICE_WORK;
+
 typedef struct MESSAGE_DISPOSITION_CONTEXT_TAG
 {
     HTTPTRANSPORT_HANDLE_DATA* handleData;
@@ -474,10 +531,9 @@ static bool create_deviceSasToken(HTTPTRANSPORT_PERDEVICE_DATA* handleData, cons
 }
 
 /*
-* List queries  Find by handle and find by device name
+* List queries  Find by handle (the device index answers the lookups by name)
 */
 
-/*Codes_SRS_TRANSPORTMULTITHTTP_17_137: [ IoTHubTransportHttp_Register shall search the devices list for any device matching name deviceId. If deviceId is found it shall return NULL. ]*/
 static bool findDeviceHandle(const void* element, const void* value)
 {
     bool result;
@@ -488,17 +544,6 @@ static bool findDeviceHandle(const void* element, const void* value)
     return result;
 }
 
-static bool findDeviceById(const void* element, const void* value)
-{
-    bool result;
-    const char* deviceId = (const char *)value;
-    const HTTPTRANSPORT_PERDEVICE_DATA * perDeviceElement = *(const HTTPTRANSPORT_PERDEVICE_DATA **)element;
-
-    result = (strcmp(STRING_c_str(perDeviceElement->deviceId), deviceId) == 0);
-
-    return result;
-}
-
 static IOTHUB_DEVICE_HANDLE IoTHubTransportHttp_Register(TRANSPORT_LL_HANDLE handle, const IOTHUB_DEVICE_CONFIG* device, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, PDLIST_ENTRY waitingToSend)
 {
     HTTPTRANSPORT_PERDEVICE_DATA* result;
@@ -522,8 +567,8 @@ static IOTHUB_DEVICE_HANDLE IoTHubTransportHttp_Register(TRANSPORT_LL_HANDLE han
     {
         HTTPTRANSPORT_HANDLE_DATA* handleData = (HTTPTRANSPORT_HANDLE_DATA*)handle;
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_137: [ IoTHubTransportHttp_Register shall search the devices list for any device matching name deviceId. If deviceId is found it shall return NULL. ]*/
-        void* listItem = VECTOR_find_if(handleData->perDeviceList, findDeviceById, device->deviceId);
-        if (listItem != NULL)
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_019: [ IoTHubTransportHttp_Register shall search for deviceId by calling device_index_find_by_id on the transport device index. ]*/
+        if (device_index_find_by_id(handleData->perDeviceIndex, device->deviceId) != NULL)
         {
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_137: [ IoTHubTransportHttp_Register shall search the devices list for any device matching name deviceId. If deviceId is found it shall return NULL. ]*/
             LogError("Transport already has device registered by id: [%s]", device->deviceId);
@@ -594,8 +639,10 @@ static IOTHUB_DEVICE_HANDLE IoTHubTransportHttp_Register(TRANSPORT_LL_HANDLE han
                 }
             }
 
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_020: [ IoTHubTransportHttp_Register shall call device_index_add to add the new device to the transport device index. ]*/
+            bool was_index_add_ok = (was_sasObject_ok || was_create_deviceSasToken_ok || was_x509_ok) && (device_index_add(handleData->perDeviceIndex, device->deviceId, result) == 0);
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_041: [ IoTHubTransportHttp_Register shall call VECTOR_push_back to store the new device information. ]*/
-            bool was_list_add_ok = (was_sasObject_ok || was_create_deviceSasToken_ok || was_x509_ok) && (VECTOR_push_back(handleData->perDeviceList, &result, 1) == 0);
+            bool was_list_add_ok = was_index_add_ok && (VECTOR_push_back(handleData->perDeviceList, &result, 1) == 0);
 
             if (was_list_add_ok)
             {
@@ -604,6 +651,14 @@ static IOTHUB_DEVICE_HANDLE IoTHubTransportHttp_Register(TRANSPORT_LL_HANDLE han
                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_128: [ IoTHubTransportHttp_Register shall mark this device as unsubscribed. ]*/
                 result->DoWork_PullMessage = false;
                 result->isFirstPoll = true;
+                result->pollingTime = 0;
+                result->hasDeferredSendComplete = false;
+                result->isPollDue = false;
+                result->pollResponseHeaders = NULL;
+                result->pollResponseContent = NULL;
+                result->messagesSent = 0;
+                result->bytesSent = 0;
+                result->bytesReceived = 0;
                 result->waitingToSend = waitingToSend;
                 DList_InitializeListHead(&(result->eventConfirmations));
                 result->transportHandle = (HTTPTRANSPORT_HANDLE_DATA *) handle;
@@ -611,6 +666,8 @@ static IOTHUB_DEVICE_HANDLE IoTHubTransportHttp_Register(TRANSPORT_LL_HANDLE han
             else
             {
                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_042: [ If the singlylinkedlist_add fails then IoTHubTransportHttp_Register shall fail and return NULL. ]*/
+                /*Codes_SRS_TRANSPORTMULTITHTTP_09_021: [ If device_index_add fails then IoTHubTransportHttp_Register shall fail and return NULL. ]*/
+                if (was_index_add_ok) (void)device_index_remove(handleData->perDeviceIndex, result);
                 if (was_sasObject_ok) destroy_SASObject(result);
                 if (was_abandonHTTPrelativePathBegin_ok) destroy_abandonHTTPrelativePathBegin(result);
                 if (was_messageHTTPrelativePath_ok) destroy_messageHTTPrelativePath(result);
@@ -665,6 +722,19 @@ static IOTHUB_DEVICE_HANDLE* get_perDeviceDataItem(IOTHUB_DEVICE_HANDLE deviceHa
     return listItem;
 }
 
+static bool is_device_registered(IOTHUB_DEVICE_HANDLE deviceHandle)
+{
+    HTTPTRANSPORT_PERDEVICE_DATA* deviceHandleData = (HTTPTRANSPORT_PERDEVICE_DATA*)deviceHandle;
+    bool result = device_index_contains(deviceHandleData->transportHandle->perDeviceIndex, deviceHandle);
+
+    if (!result)
+    {
+        LogError("device handle not found in transport device index");
+    }
+
+    return result;
+}
+
 static void IoTHubTransportHttp_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
 {
     if (deviceHandle == NULL)
@@ -691,6 +761,8 @@ static void IoTHubTransportHttp_Unregister(IOTHUB_DEVICE_HANDLE deviceHandle)
             destroy_perDeviceData(perDeviceItem);
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_048: [ IoTHubTransportHttp_Unregister shall call singlylinkedlist_remove to remove device from devices list. ]*/
             VECTOR_erase(handleData->perDeviceList, listItem, 1);
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_022: [ IoTHubTransportHttp_Unregister shall call device_index_remove to remove device from the transport device index. ]*/
+            (void)device_index_remove(handleData->perDeviceIndex, deviceHandle);
             free(deviceHandleData);
         }
     }
@@ -767,10 +839,56 @@ static bool create_httpApiExHandle(HTTPTRANSPORT_HANDLE_DATA* handleData, const
     return result;
 }
 
+static void destroy_deviceWork(DEVICE_WORK* work)
+{
+    if (work != NULL)
+    {
+        size_t i;
+        /*the pool is idle between 2 DoWork calls, destroying it only joins its threads*/
+        if (work->pool != NULL)
+        {
+            callback_pool_destroy(work->pool);
+        }
+        if (work->workerDone != NULL)
+        {
+            Condition_Deinit(work->workerDone);
+        }
+        if (work->lock != NULL)
+        {
+            Lock_Deinit(work->lock);
+        }
+        for (i = 0; i < work->workerCount; i++)
+        {
+            HTTPAPIEX_Destroy(work->workers[i].httpApiExHandle);
+        }
+        free(work->workers);
+        free(work);
+    }
+}
+
+static void destroy_httpApiExOptions(HTTPTRANSPORT_HANDLE_DATA* handleData)
+{
+    if (handleData->httpApiExOptions != NULL)
+    {
+        size_t optionCount = VECTOR_size(handleData->httpApiExOptions);
+        size_t i;
+        for (i = 0; i < optionCount; i++)
+        {
+            HTTPAPIEX_SAVED_OPTION* savedOption = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->httpApiExOptions, i);
+            STRING_delete(savedOption->name);
+            free((void*)savedOption->value);
+        }
+        VECTOR_destroy(handleData->httpApiExOptions);
+        handleData->httpApiExOptions = NULL;
+    }
+}
+
 static void destroy_perDeviceList(HTTPTRANSPORT_HANDLE_DATA* handleData)
 {
     VECTOR_destroy(handleData->perDeviceList);
     handleData->perDeviceList = NULL;
+    device_index_destroy(handleData->perDeviceIndex);
+    handleData->perDeviceIndex = NULL;
 }
 
 /*Codes_SRS_TRANSPORTMULTITHTTP_17_009: [ IoTHubTransportHttp_Create shall call singlylinkedlist_create to create a list of registered devices. ]*/
@@ -783,6 +901,14 @@ static bool create_perDeviceList(HTTPTRANSPORT_HANDLE_DATA* handleData)
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_010: [ If creating the list fails, then IoTHubTransportHttp_Create shall fail and return NULL. ]*/
         result = false;
     }
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_024: [ IoTHubTransportHttp_Create shall call device_index_create to create an index of the registered devices. ]*/
+    else if ((handleData->perDeviceIndex = device_index_create()) == NULL)
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_025: [ If creating the index fails, then IoTHubTransportHttp_Create shall fail and return NULL. ]*/
+        VECTOR_destroy(handleData->perDeviceList);
+        handleData->perDeviceList = NULL;
+        result = false;
+    }
     else
     {
         result = true;
@@ -845,6 +971,12 @@ static TRANSPORT_LL_HANDLE IoTHubTransportHttp_Create(const IOTHUBTRANSPORT_CONF
                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_011: [ Otherwise, IoTHubTransportHttp_Create shall succeed and return a non-NULL value. ]*/
                 result->doBatchedTransfers = false;
                 result->getMinimumPollingTime = DEFAULT_GETMINIMUMPOLLINGTIME;
+                result->getMaximumPollingTime = 0;
+                result->maximumPollsPerDoWork = 0;
+                result->nextPollDevice = 0;
+                result->eventSendConcurrency = 1;
+                result->deviceWork = NULL;
+                result->httpApiExOptions = NULL;
             }
             else
             {
@@ -880,6 +1012,8 @@ static void IoTHubTransportHttp_Destroy(TRANSPORT_LL_HANDLE handle)
 
         destroy_hostName((HTTPTRANSPORT_HANDLE_DATA *) handle);
         destroy_httpApiExHandle((HTTPTRANSPORT_HANDLE_DATA *) handle);
+        destroy_deviceWork(handleData->deviceWork);
+        destroy_httpApiExOptions(handleData);
         destroy_perDeviceList((HTTPTRANSPORT_HANDLE_DATA *)handle);
         free(handle);
     }
@@ -897,9 +1031,8 @@ static int IoTHubTransportHttp_Subscribe(IOTHUB_DEVICE_HANDLE handle)
     else
     {
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_104: [ IoTHubTransportHttp_Subscribe shall locate deviceHandle in the transport device list by calling list_find_if. ]*/
-        IOTHUB_DEVICE_HANDLE* listItem = get_perDeviceDataItem(handle);
-
-        if (listItem == NULL)
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_023: [ IoTHubTransportHttp_Subscribe, IoTHubTransportHttp_Unsubscribe, IoTHubTransportHttp_GetSendStatus and IoTHubTransportHttp_GetStatistics shall locate deviceHandle by calling device_index_contains on the transport device index. ]*/
+        if (!is_device_registered(handle))
         {
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_105: [ If the device structure is not found, then this function shall fail and return a non-zero value. ]*/
             LogError("did not find device in transport handle");
@@ -909,7 +1042,7 @@ static int IoTHubTransportHttp_Subscribe(IOTHUB_DEVICE_HANDLE handle)
         {
             HTTPTRANSPORT_PERDEVICE_DATA * perDeviceItem;
 
-            perDeviceItem = (HTTPTRANSPORT_PERDEVICE_DATA *)(*listItem);
+            perDeviceItem = (HTTPTRANSPORT_PERDEVICE_DATA *)handle;
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_106: [ Otherwise, IoTHubTransportHttp_Subscribe shall set the device so that subsequent calls to DoWork should execute HTTP requests. ]*/
             perDeviceItem->DoWork_PullMessage = true;
         }
@@ -924,11 +1057,10 @@ static void IoTHubTransportHttp_Unsubscribe(IOTHUB_DEVICE_HANDLE handle)
     if (handle != NULL)
     {
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_108: [ IoTHubTransportHttp_Unsubscribe shall locate deviceHandle in the transport device list by calling list_find_if. ]*/
-        IOTHUB_DEVICE_HANDLE* listItem = get_perDeviceDataItem(handle);
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_109: [ If the device structure is not found, then this function shall fail and do nothing. ]*/
-        if (listItem != NULL)
+        if (is_device_registered(handle))
         {
-            HTTPTRANSPORT_PERDEVICE_DATA * perDeviceItem = (HTTPTRANSPORT_PERDEVICE_DATA *)(*listItem);
+            HTTPTRANSPORT_PERDEVICE_DATA * perDeviceItem = (HTTPTRANSPORT_PERDEVICE_DATA *)handle;
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_110: [ Otherwise, IoTHubTransportHttp_Subscribe shall set the device so that subsequent calls to DoWork shall not execute HTTP requests. ]*/
             perDeviceItem->DoWork_PullMessage = false;
         }
@@ -1218,6 +1350,14 @@ static STRING_HANDLE make1EventJSONitem(PDLIST_ENTRY item, size_t *messageSizeCo
 
 DEFINE_ENUM(MAKE_PAYLOAD_RESULT, MAKE_PAYLOAD_RESULT_VALUES);
 
+static void moveOldestToEventConfirmations(HTTPTRANSPORT_PERDEVICE_DATA* deviceData)
+{
+    PDLIST_ENTRY oldest = DList_RemoveHeadList(deviceData->waitingToSend);
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_033: [ Every message taken off waitingToSend shall have its inWaitingToSend flag cleared. ]*/
+    containingRecord(oldest, IOTHUB_MESSAGE_LIST, entry)->inWaitingToSend = false;
+    DList_InsertTailList(&(deviceData->eventConfirmations), oldest);
+}
+
 /*this function assembles several {"body":"base64 encoding of the message content"," base64Encoded": true} into 1 payload*/
 /*Codes_SRS_TRANSPORTMULTITHTTP_17_056: [IoTHubTransportHttp_DoWork shall build the following string:[{"body":"base64 encoding of the message1 content"},{"body":"base64 encoding of the message2 content"}...]]*/
 static MAKE_PAYLOAD_RESULT makePayload(HTTPTRANSPORT_PERDEVICE_DATA* deviceData, STRING_HANDLE* payload)
@@ -1258,8 +1398,7 @@ static MAKE_PAYLOAD_RESULT makePayload(HTTPTRANSPORT_PERDEVICE_DATA* deviceData,
                     /*Codes_SRS_TRANSPORTMULTITHTTP_17_061: [The message size shall be limited to 255KB - 1 byte.]*/
                     if (messageSize > MAXIMUM_MESSAGE_SIZE)
                     {
-                        PDLIST_ENTRY head = DList_RemoveHeadList(deviceData->waitingToSend); /*actually this is the same as "actual", but now it is removed*/
-                        DList_InsertTailList(&(deviceData->eventConfirmations), head);
+                        moveOldestToEventConfirmations(deviceData);
                         result = MAKE_PAYLOAD_FIRST_ITEM_DOES_NOT_FIT;
                         STRING_delete(*payload);
                         *payload = NULL;
@@ -1278,8 +1417,7 @@ static MAKE_PAYLOAD_RESULT makePayload(HTTPTRANSPORT_PERDEVICE_DATA* deviceData,
                         else
                         {
                             /*first item was put nicely in the payload*/
-                            PDLIST_ENTRY head = DList_RemoveHeadList(deviceData->waitingToSend); /*actually this is the same as "actual", but now it is removed*/
-                            DList_InsertTailList(&(deviceData->eventConfirmations), head);
+                            moveOldestToEventConfirmations(deviceData);
                             allMessagesSize += messageSize;
                         }
                     }
@@ -1315,8 +1453,7 @@ static MAKE_PAYLOAD_RESULT makePayload(HTTPTRANSPORT_PERDEVICE_DATA* deviceData,
                     else
                     {
                         /*cool, the payload made it there, let's continue... */
-                        PDLIST_ENTRY head = DList_RemoveHeadList(deviceData->waitingToSend); /*actually this is the same as "actual", but now it is removed*/
-                        DList_InsertTailList(&(deviceData->eventConfirmations), head);
+                        moveOldestToEventConfirmations(deviceData);
                         allMessagesSize += messageSize;
                     }
                     STRING_delete(temp);
@@ -1340,12 +1477,43 @@ static MAKE_PAYLOAD_RESULT makePayload(HTTPTRANSPORT_PERDEVICE_DATA* deviceData,
 static void reversePutListBackIn(PDLIST_ENTRY source, PDLIST_ENTRY destination)
 {
     /*this function takes a list, and inserts it in another list. When done in the context of this file, it reverses the effects of a not-able-to-send situation*/
+    PDLIST_ENTRY putBack;
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_034: [ Every message put back in waitingToSend shall have its inWaitingToSend flag set. ]*/
+    for (putBack = source->Flink; putBack != source; putBack = putBack->Flink)
+    {
+        containingRecord(putBack, IOTHUB_MESSAGE_LIST, entry)->inWaitingToSend = true;
+    }
     DList_AppendTailList(destination->Flink, source);
     DList_RemoveEntryList(source);
     DList_InitializeListHead(source);
 }
 
-static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
+static size_t countListEntries(PDLIST_ENTRY listHead)
+{
+    size_t result = 0;
+    PDLIST_ENTRY entry;
+    for (entry = listHead->Flink; entry != listHead; entry = entry->Flink)
+    {
+        result++;
+    }
+    return result;
+}
+
+static void completeEvents(HTTPTRANSPORT_PERDEVICE_DATA* deviceData, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_CONFIRMATION_RESULT result, bool isDeferred)
+{
+    if (isDeferred)
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_016: [ Events sent by a worker thread shall keep their confirmation until IoTHubTransportHttp_DoWork calls IoTHubClient_LL_SendComplete for them from the calling thread, in the order of the device list. ]*/
+        deviceData->hasDeferredSendComplete = true;
+        deviceData->deferredSendCompleteResult = result;
+    }
+    else
+    {
+        IoTHubClient_LL_SendComplete(iotHubClientHandle, &(deviceData->eventConfirmations), result);
+    }
+}
+
+static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, HTTPAPIEX_HANDLE httpApiExHandle, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, bool isSendCompleteDeferred)
 {
 
     if (DList_IsListEmpty(deviceData->waitingToSend))
@@ -1381,7 +1549,8 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                     }
                     else
                     {
-                        if (BUFFER_build(temp, (const unsigned char*)STRING_c_str(payload), STRING_length(payload)) != 0)
+                        size_t payloadLength = 0;
+                        if (BUFFER_build(temp, (const unsigned char*)STRING_c_str(payload), (payloadLength = STRING_length(payload))) != 0)
                         {
                             LogError("unable to BUFFER_build");
                             //items go back to waitingToSend
@@ -1393,7 +1562,7 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                             unsigned int statusCode;
                             if (HTTPAPIEX_SAS_ExecuteRequest(
                                 deviceData->sasObject,
-                                handleData->httpApiExHandle,
+                                httpApiExHandle,
                                 HTTPAPI_REQUEST_POST,
                                 STRING_c_str(deviceData->eventHTTPrelativePath),
                                 deviceData->eventHTTPrequestHeaders,
@@ -1413,7 +1582,9 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                                 if (statusCode < 300)
                                 {
                                     /*Codes_SRS_TRANSPORTMULTITHTTP_17_070: [If HTTPAPIEX_SAS_ExecuteRequest does not fail and http status code <300 then IoTHubTransportHttp_DoWork shall call IoTHubClient_LL_SendComplete. Parameter PDLIST_ENTRY completed shall point to a list containing all the items batched, and parameter IOTHUB_CLIENT_CONFIRMATION_RESULT result shall be set to IOTHUB_CLIENT_CONFIRMATION_OK. The batched items shall be removed from waitingToSend.] */
-                                    IoTHubClient_LL_SendComplete(iotHubClientHandle, &(deviceData->eventConfirmations), IOTHUB_CLIENT_CONFIRMATION_OK);
+                                    deviceData->messagesSent += countListEntries(&(deviceData->eventConfirmations));
+                                    deviceData->bytesSent += payloadLength;
+                                    completeEvents(deviceData, iotHubClientHandle, IOTHUB_CLIENT_CONFIRMATION_OK, isSendCompleteDeferred);
                                 }
                                 else
                                 {
@@ -1431,7 +1602,7 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                 }
                 case MAKE_PAYLOAD_FIRST_ITEM_DOES_NOT_FIT:
                 {
-                    IoTHubClient_LL_SendComplete(iotHubClientHandle, &(deviceData->eventConfirmations), IOTHUB_CLIENT_CONFIRMATION_ERROR); /*takes care of emptying the list too*/
+                    completeEvents(deviceData, iotHubClientHandle, IOTHUB_CLIENT_CONFIRMATION_ERROR, isSendCompleteDeferred); /*takes care of emptying the list too*/
                     break;
                 }
                 case MAKE_PAYLOAD_ERROR:
@@ -1483,9 +1654,8 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_072: [The message size shall be limited to 255KB -1 bytes.] */
                 if (messageSize > MAXIMUM_MESSAGE_SIZE)
                 {
-                    PDLIST_ENTRY head = DList_RemoveHeadList(deviceData->waitingToSend); /*actually this is the same as "actual", but now it is removed*/
-                    DList_InsertTailList(&(deviceData->eventConfirmations), head);
-                    IoTHubClient_LL_SendComplete(iotHubClientHandle, &(deviceData->eventConfirmations), IOTHUB_CLIENT_CONFIRMATION_ERROR); /*takes care of emptying the list too*/
+                    moveOldestToEventConfirmations(deviceData);
+                    completeEvents(deviceData, iotHubClientHandle, IOTHUB_CLIENT_CONFIRMATION_ERROR, isSendCompleteDeferred); /*takes care of emptying the list too*/
                 }
                 else
                 {
@@ -1531,9 +1701,8 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                                     if (messageSize > MAXIMUM_MESSAGE_SIZE)
                                     {
                                         /*Codes_SRS_TRANSPORTMULTITHTTP_17_072: [The message size shall be limited to 255KB -1 bytes.] */
-                                        PDLIST_ENTRY head = DList_RemoveHeadList(deviceData->waitingToSend); /*actually this is the same as "actual", but now it is removed*/
-                                        DList_InsertTailList(&(deviceData->eventConfirmations), head);
-                                        IoTHubClient_LL_SendComplete(iotHubClientHandle, &(deviceData->eventConfirmations), IOTHUB_CLIENT_CONFIRMATION_ERROR); /*takes care of emptying the list too*/
+                                        moveOldestToEventConfirmations(deviceData);
+                                        completeEvents(deviceData, iotHubClientHandle, IOTHUB_CLIENT_CONFIRMATION_ERROR, isSendCompleteDeferred); /*takes care of emptying the list too*/
                                         goOn = false;
                                     }
                                     else
@@ -1621,7 +1790,7 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
 
                                                 /*Codes_SRS_TRANSPORTMULTITHTTP_03_003: [If a deviceSasToken exists, IoTHubTransportHttp_DoWork shall call HTTPAPIEX_ExecuteRequest passing the following parameters] */
                                                 else if ((r = HTTPAPIEX_ExecuteRequest(
-                                                    handleData->httpApiExHandle,
+                                                    httpApiExHandle,
                                                     HTTPAPI_REQUEST_POST,
                                                     STRING_c_str(deviceData->eventHTTPrelativePath),
                                                     clonedEventHTTPrequestHeaders,
@@ -1639,7 +1808,7 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                                                 /*Codes_SRS_TRANSPORTMULTITHTTP_17_080: [If a deviceSasToken does not exist, IoTHubTransportHttp_DoWork shall call HTTPAPIEX_SAS_ExecuteRequest passing the following parameters] */
                                                 if ((r = HTTPAPIEX_SAS_ExecuteRequest(
                                                     deviceData->sasObject,
-                                                    handleData->httpApiExHandle,
+                                                    httpApiExHandle,
                                                     HTTPAPI_REQUEST_POST,
                                                     STRING_c_str(deviceData->eventHTTPrelativePath),
                                                     clonedEventHTTPrequestHeaders,
@@ -1657,9 +1826,10 @@ static void DoEvent(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVI
                                                 if (statusCode < 300)
                                                 {
                                                     /*Codes_SRS_TRANSPORTMULTITHTTP_17_082: [If HTTPAPIEX_SAS_ExecuteRequest does not fail and http status code <300 then IoTHubTransportHttp_DoWork shall call IoTHubClient_LL_SendComplete. Parameter PDLIST_ENTRY completed shall point to a list the item send, and parameter IOTHUB_CLIENT_CONFIRMATION_RESULT result shall be set to IOTHUB_CLIENT_CONFIRMATION_OK. The item shall be removed from waitingToSend.] */
-                                                    PDLIST_ENTRY justSent = DList_RemoveHeadList(deviceData->waitingToSend); /*actually this is the same as "actual", but now it is removed*/
-                                                    DList_InsertTailList(&(deviceData->eventConfirmations), justSent);
-                                                    IoTHubClient_LL_SendComplete(iotHubClientHandle, &(deviceData->eventConfirmations), IOTHUB_CLIENT_CONFIRMATION_OK); /*takes care of emptying the list too*/
+                                                    moveOldestToEventConfirmations(deviceData);
+                                                    deviceData->messagesSent++;
+                                                    deviceData->bytesSent += originalMessageSize;
+                                                    completeEvents(deviceData, iotHubClientHandle, IOTHUB_CLIENT_CONFIRMATION_OK, isSendCompleteDeferred); /*takes care of emptying the list too*/
                                                 }
                                                 else
                                                 {
@@ -1965,274 +2135,600 @@ static MESSAGE_CALLBACK_INFO* MESSAGE_CALLBACK_INFO_Create(IOTHUB_MESSAGE_HANDLE
     return result;
 }
 
-static void DoMessages(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
+static unsigned int get_pollingTime(const HTTPTRANSPORT_HANDLE_DATA* handleData, const HTTPTRANSPORT_PERDEVICE_DATA* deviceData)
 {
-    /*Codes_SRS_TRANSPORTMULTITHTTP_17_083: [ If device is not subscribed then _DoWork shall advance to the next action. ] */
-    if (deviceData->DoWork_PullMessage)
+    unsigned int result;
+    if (handleData->getMaximumPollingTime <= handleData->getMinimumPollingTime)
     {
-        /*Codes_SRS_TRANSPORTMULTITHTTP_17_123: [After client creation, the first GET shall be allowed no matter what the value of GetMinimumPollingTime.] */
-        /*Codes_SRS_TRANSPORTMULTITHTTP_17_124: [If time is not available then all calls shall be treated as if they are the first one.] */
-        /*Codes_SRS_TRANSPORTMULTITHTTP_17_122: [A GET request that happens earlier than GetMinimumPollingTime shall be ignored.] */
-        time_t timeNow = get_time(NULL);
-        bool isPollingAllowed = deviceData->isFirstPoll || (timeNow == (time_t)(-1)) || (get_difftime(timeNow, deviceData->lastPollTime) > handleData->getMinimumPollingTime);
-        if (isPollingAllowed)
+        result = handleData->getMinimumPollingTime;
+    }
+    else if (deviceData->pollingTime < handleData->getMinimumPollingTime)
+    {
+        result = handleData->getMinimumPollingTime;
+    }
+    else if (deviceData->pollingTime > handleData->getMaximumPollingTime)
+    {
+        result = handleData->getMaximumPollingTime;
+    }
+    else
+    {
+        result = deviceData->pollingTime;
+    }
+    return result;
+}
+
+static void update_pollingTime(const HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, bool wasMessageReceived)
+{
+    if (handleData->getMaximumPollingTime > handleData->getMinimumPollingTime)
+    {
+        if (wasMessageReceived)
         {
-            HTTP_HEADERS_HANDLE responseHTTPHeaders = HTTPHeaders_Alloc();
-            if (responseHTTPHeaders == NULL)
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_006: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET that completes with status code 200 shall set the polling time of the device back to MinimumPollingTime. ]*/
+            deviceData->pollingTime = handleData->getMinimumPollingTime;
+        }
+        else
+        {
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_005: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET that completes with status code 204 shall double the polling time of the device, up to MaximumPollingTime. ]*/
+            unsigned int current = get_pollingTime(handleData, deviceData);
+            if (current == 0)
             {
-                /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
-                LogError("unable to HTTPHeaders_Alloc");
+                deviceData->pollingTime = 1;
+            }
+            else if (current > handleData->getMaximumPollingTime / 2)
+            {
+                deviceData->pollingTime = handleData->getMaximumPollingTime;
             }
             else
             {
-                BUFFER_HANDLE responseContent = BUFFER_new();
-                if (responseContent == NULL)
+                deviceData->pollingTime = current * 2;
+            }
+        }
+    }
+}
+
+/*issues the GET of the device on httpApiExHandle, the response is kept in the device until ProcessMessage*/
+static void GetMessage(HTTPTRANSPORT_PERDEVICE_DATA* deviceData, HTTPAPIEX_HANDLE httpApiExHandle, time_t timeNow)
+{
+    deviceData->pollResult = HTTPAPIEX_ERROR;
+    deviceData->pollStatusCode = 0;
+    deviceData->pollResponseContent = NULL;
+    deviceData->pollResponseHeaders = HTTPHeaders_Alloc();
+    if (deviceData->pollResponseHeaders == NULL)
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
+        LogError("unable to HTTPHeaders_Alloc");
+    }
+    else
+    {
+        deviceData->pollResponseContent = BUFFER_new();
+        if (deviceData->pollResponseContent == NULL)
+        {
+            /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
+            LogError("unable to BUFFER_new");
+        }
+        else
+        {
+            HTTPAPIEX_RESULT r;
+            if (deviceData->deviceSasToken != NULL)
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_03_001: [if a deviceSasToken exists, HTTPHeaders_ReplaceHeaderNameValuePair shall be invoked with "Authorization" as its second argument and STRING_c_str (deviceSasToken) as its third argument.]*/
+                if (HTTPHeaders_ReplaceHeaderNameValuePair(deviceData->messageHTTPrequestHeaders, "Authorization", STRING_c_str(deviceData->deviceSasToken)) != HTTP_HEADERS_OK)
+                {
+                    r = HTTPAPIEX_ERROR;
+                    /*Codes_SRS_TRANSPORTMULTITHTTP_03_002: [If the result of the invocation of HTTPHeaders_ReplaceHeaderNameValuePair is NOT HTTP_HEADERS_OK then fallthrough.]*/
+                    LogError("Unable to replace the old SAS Token.");
+                }
+                else if ((r = HTTPAPIEX_ExecuteRequest(
+                    httpApiExHandle,
+                    HTTPAPI_REQUEST_GET,                                            /*requestType: GET*/
+                    STRING_c_str(deviceData->messageHTTPrelativePath),         /*relativePath: the message HTTP relative path*/
+                    deviceData->messageHTTPrequestHeaders,                     /*requestHttpHeadersHandle: message HTTP request headers created by _Create*/
+                    NULL,                                                           /*requestContent: NULL*/
+                    &deviceData->pollStatusCode,                                    /*statusCode: a pointer to unsigned int which shall be later examined*/
+                    deviceData->pollResponseHeaders,                                /*responseHeadearsHandle: a new instance of HTTP headers*/
+                    deviceData->pollResponseContent                                 /*responseContent: a new instance of buffer*/
+                    )) != HTTPAPIEX_OK)
                 {
                     /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
-                    LogError("unable to BUFFER_new");
+                    LogError("Unable to HTTPAPIEX_ExecuteRequest.");
+                }
+            }
+
+            /*Codes_SRS_TRANSPORTMULTITHTTP_17_084: [Otherwise, IoTHubTransportHttp_DoWork shall call HTTPAPIEX_SAS_ExecuteRequest passing the following parameters
+            requestType: GET
+            relativePath: the message HTTP relative path
+            requestHttpHeadersHandle: message HTTP request headers created by _Create
+            requestContent: NULL
+            statusCode: a pointer to unsigned int which shall be later examined
+            responseHeadearsHandle: a new instance of HTTP headers
+            responseContent: a new instance of buffer]
+            */
+            else if ((r = HTTPAPIEX_SAS_ExecuteRequest(
+                deviceData->sasObject,
+                httpApiExHandle,
+                HTTPAPI_REQUEST_GET,                                            /*requestType: GET*/
+                STRING_c_str(deviceData->messageHTTPrelativePath),         /*relativePath: the message HTTP relative path*/
+                deviceData->messageHTTPrequestHeaders,                     /*requestHttpHeadersHandle: message HTTP request headers created by _Create*/
+                NULL,                                                           /*requestContent: NULL*/
+                &deviceData->pollStatusCode,                                    /*statusCode: a pointer to unsigned int which shall be later examined*/
+                deviceData->pollResponseHeaders,                                /*responseHeadearsHandle: a new instance of HTTP headers*/
+                deviceData->pollResponseContent                                 /*responseContent: a new instance of buffer*/
+                )) != HTTPAPIEX_OK)
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
+                LogError("unable to HTTPAPIEX_SAS_ExecuteRequest");
+            }
+            if (r == HTTPAPIEX_OK)
+            {
+                /*HTTP dialogue was succesfull*/
+                if (timeNow == (time_t)(-1))
+                {
+                    deviceData->isFirstPoll = true;
                 }
                 else
                 {
-                    unsigned int statusCode = 0;
-                    HTTPAPIEX_RESULT r;
-                    if (deviceData->deviceSasToken != NULL)
-                    {
-                        /*Codes_SRS_TRANSPORTMULTITHTTP_03_001: [if a deviceSasToken exists, HTTPHeaders_ReplaceHeaderNameValuePair shall be invoked with "Authorization" as its second argument and STRING_c_str (deviceSasToken) as its third argument.]*/
-                        if (HTTPHeaders_ReplaceHeaderNameValuePair(deviceData->messageHTTPrequestHeaders, "Authorization", STRING_c_str(deviceData->deviceSasToken)) != HTTP_HEADERS_OK)
-                        {
-                            r = HTTPAPIEX_ERROR;
-                            /*Codes_SRS_TRANSPORTMULTITHTTP_03_002: [If the result of the invocation of HTTPHeaders_ReplaceHeaderNameValuePair is NOT HTTP_HEADERS_OK then fallthrough.]*/
-                            LogError("Unable to replace the old SAS Token.");
-                        }
-                        else if ((r = HTTPAPIEX_ExecuteRequest(
-                            handleData->httpApiExHandle,
-                            HTTPAPI_REQUEST_GET,                                            /*requestType: GET*/
-                            STRING_c_str(deviceData->messageHTTPrelativePath),         /*relativePath: the message HTTP relative path*/
-                            deviceData->messageHTTPrequestHeaders,                     /*requestHttpHeadersHandle: message HTTP request headers created by _Create*/
-                            NULL,                                                           /*requestContent: NULL*/
-                            &statusCode,                                                    /*statusCode: a pointer to unsigned int which shall be later examined*/
-                            responseHTTPHeaders,                                            /*responseHeadearsHandle: a new instance of HTTP headers*/
-                            responseContent                                                 /*responseContent: a new instance of buffer*/
-                            )) != HTTPAPIEX_OK)
-                        {
-                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
-                            LogError("Unable to HTTPAPIEX_ExecuteRequest.");
-                        }
-                    }
+                    deviceData->isFirstPoll = false;
+                    deviceData->lastPollTime = timeNow;
+                }
+                if ((deviceData->pollStatusCode == 200) || (deviceData->pollStatusCode == 204))
+                {
+                    update_pollingTime(deviceData->transportHandle, deviceData, (deviceData->pollStatusCode == 200));
+                }
+            }
+            deviceData->pollResult = r;
+        }
+    }
+}
+
+/*examines the response GetMessage kept in the device, hands the message to the client and frees the response*/
+static void ProcessMessage(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
+{
+    HTTP_HEADERS_HANDLE responseHTTPHeaders = deviceData->pollResponseHeaders;
+    BUFFER_HANDLE responseContent = deviceData->pollResponseContent;
+    unsigned int statusCode = deviceData->pollStatusCode;
+
+    if (responseContent != NULL)
+    {
+        if (deviceData->pollResult == HTTPAPIEX_OK)
+        {
+            if (statusCode == 204)
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_17_086: [If the HTTPAPIEX_SAS_ExecuteRequest executed successfully then status code shall be examined. Any status code different than 200 causes _DoWork to advance to the next action.] */
+                /*this is an expected status code, means "no commands", but logging that creates panic*/
 
-                    /*Codes_SRS_TRANSPORTMULTITHTTP_17_084: [Otherwise, IoTHubTransportHttp_DoWork shall call HTTPAPIEX_SAS_ExecuteRequest passing the following parameters
-                    requestType: GET
-                    relativePath: the message HTTP relative path
-                    requestHttpHeadersHandle: message HTTP request headers created by _Create
-                    requestContent: NULL
-                    statusCode: a pointer to unsigned int which shall be later examined
-                    responseHeadearsHandle: a new instance of HTTP headers
-                    responseContent: a new instance of buffer]
-                    */
-                    else if ((r = HTTPAPIEX_SAS_ExecuteRequest(
-                        deviceData->sasObject,
-                        handleData->httpApiExHandle,
-                        HTTPAPI_REQUEST_GET,                                            /*requestType: GET*/
-                        STRING_c_str(deviceData->messageHTTPrelativePath),         /*relativePath: the message HTTP relative path*/
-                        deviceData->messageHTTPrequestHeaders,                     /*requestHttpHeadersHandle: message HTTP request headers created by _Create*/
-                        NULL,                                                           /*requestContent: NULL*/
-                        &statusCode,                                                    /*statusCode: a pointer to unsigned int which shall be later examined*/
-                        responseHTTPHeaders,                                            /*responseHeadearsHandle: a new instance of HTTP headers*/
-                        responseContent                                                 /*responseContent: a new instance of buffer*/
-                        )) != HTTPAPIEX_OK)
+                /*do nothing, advance to next action*/
+            }
+            else if (statusCode != 200)
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_17_086: [If the HTTPAPIEX_SAS_ExecuteRequest executed successfully then status code shall be examined. Any status code different than 200 causes _DoWork to advance to the next action.] */
+                LogError("expected status code was 200, but actually was received %u... moving on", statusCode);
+            }
+            else
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_17_087: [If status code is 200, then _DoWork shall make a copy of the value of the "ETag" http header.]*/
+                const char* etagValue = HTTPHeaders_FindHeaderValue(responseHTTPHeaders, "ETag");
+                if (etagValue == NULL)
+                {
+                    LogError("unable to find a received header called \"E-Tag\"");
+                }
+                else
+                {
+                    /*Codes_SRS_TRANSPORTMULTITHTTP_17_088: [If no such header is found or is invalid, then _DoWork shall advance to the next action.]*/
+                    size_t etagsize = strlen(etagValue);
+                    if (
+                        (etagsize < 2) ||
+                        (etagValue[0] != '"') ||
+                        (etagValue[etagsize - 1] != '"')
+                        )
                     {
-                        /*Codes_SRS_TRANSPORTMULTITHTTP_17_085: [If the call to HTTPAPIEX_SAS_ExecuteRequest did not executed successfully or building any part of the prerequisites of the call fails, then _DoWork shall advance to the next action in this description.] */
-                        LogError("unable to HTTPAPIEX_SAS_ExecuteRequest");
+                        LogError("ETag is not a valid quoted string");
                     }
-                    if (r == HTTPAPIEX_OK)
+                    else
                     {
-                        /*HTTP dialogue was succesfull*/
-                        if (timeNow == (time_t)(-1))
-                        {
-                            deviceData->isFirstPoll = true;
-                        }
-                        else
-                        {
-                            deviceData->isFirstPoll = false;
-                            deviceData->lastPollTime = timeNow;
-                        }
-                        if (statusCode == 204)
+                        const unsigned char* resp_content;
+                        size_t resp_len;
+                        /*Codes_SRS_TRANSPORTMULTITHTTP_17_089: [_DoWork shall assemble an IOTHUBMESSAGE_HANDLE from the received HTTP content (using the responseContent buffer).] */
+                        resp_content = BUFFER_u_char(responseContent);
+                        resp_len = BUFFER_length(responseContent);
+                        deviceData->bytesReceived += resp_len;
+                        IOTHUB_MESSAGE_HANDLE receivedMessage = IoTHubMessage_CreateFromByteArray(resp_content, resp_len);
+                        if (receivedMessage == NULL)
                         {
-                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_086: [If the HTTPAPIEX_SAS_ExecuteRequest executed successfully then status code shall be examined. Any status code different than 200 causes _DoWork to advance to the next action.] */
-                            /*this is an expected status code, means "no commands", but logging that creates panic*/
-
-                            /*do nothing, advance to next action*/
-                        }
-                        else if (statusCode != 200)
-                        {
-                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_086: [If the HTTPAPIEX_SAS_ExecuteRequest executed successfully then status code shall be examined. Any status code different than 200 causes _DoWork to advance to the next action.] */
-                            LogError("expected status code was 200, but actually was received %u... moving on", statusCode);
+                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_092: [If assembling the message fails in any way, then _DoWork shall "abandon" the message.]*/
+                            LogError("unable to IoTHubMessage_CreateFromByteArray, trying to abandon the message... ");
+                            if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
+                            {
+                                LogError("HTTP Transport layer failed to report ABANDON disposition");
+                            }
                         }
                         else
                         {
-                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_087: [If status code is 200, then _DoWork shall make a copy of the value of the "ETag" http header.]*/
-                            const char* etagValue = HTTPHeaders_FindHeaderValue(responseHTTPHeaders, "ETag");
-                            if (etagValue == NULL)
+                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_090: [All the HTTP headers of the form iothub-app-name:somecontent shall be transformed in message properties {name, somecontent}.]*/
+                            /*Codes_SRS_TRANSPORTMULTITHTTP_17_091: [The HTTP header of iothub-messageid shall be set in the MessageId.]*/
+                            size_t nHeaders;
+                            if (HTTPHeaders_GetHeaderCount(responseHTTPHeaders, &nHeaders) != HTTP_HEADERS_OK)
                             {
-                                LogError("unable to find a received header called \"E-Tag\"");
+                                LogError("unable to get the count of HTTP headers");
+                                if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
+                                {
+                                    LogError("HTTP Transport layer failed to report ABANDON disposition");
+                                }
                             }
                             else
                             {
-                                /*Codes_SRS_TRANSPORTMULTITHTTP_17_088: [If no such header is found or is invalid, then _DoWork shall advance to the next action.]*/
-                                size_t etagsize = strlen(etagValue);
-                                if (
-                                    (etagsize < 2) ||
-                                    (etagValue[0] != '"') ||
-                                    (etagValue[etagsize - 1] != '"')
-                                    )
-                                {
-                                    LogError("ETag is not a valid quoted string");
-                                }
-                                else
+                                size_t i;
+                                MAP_HANDLE properties = (nHeaders > 0) ? IoTHubMessage_Properties(receivedMessage) : NULL;
+                                for (i = 0; i < nHeaders; i++)
                                 {
-                                    const unsigned char* resp_content;
-                                    size_t resp_len;
-                                    /*Codes_SRS_TRANSPORTMULTITHTTP_17_089: [_DoWork shall assemble an IOTHUBMESSAGE_HANDLE from the received HTTP content (using the responseContent buffer).] */
-                                    resp_content = BUFFER_u_char(responseContent);
-                                    resp_len = BUFFER_length(responseContent);
-                                    IOTHUB_MESSAGE_HANDLE receivedMessage = IoTHubMessage_CreateFromByteArray(resp_content, resp_len);
-                                    if (receivedMessage == NULL)
+                                    char* completeHeader;
+                                    if (HTTPHeaders_GetHeader(responseHTTPHeaders, i, &completeHeader) != HTTP_HEADERS_OK)
                                     {
-                                        /*Codes_SRS_TRANSPORTMULTITHTTP_17_092: [If assembling the message fails in any way, then _DoWork shall "abandon" the message.]*/
-                                        LogError("unable to IoTHubMessage_CreateFromByteArray, trying to abandon the message... ");
-                                        if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
-                                        {
-                                            LogError("HTTP Transport layer failed to report ABANDON disposition");
-                                        }
+                                        break;
                                     }
                                     else
                                     {
-                                        /*Codes_SRS_TRANSPORTMULTITHTTP_17_090: [All the HTTP headers of the form iothub-app-name:somecontent shall be transformed in message properties {name, somecontent}.]*/
-                                        /*Codes_SRS_TRANSPORTMULTITHTTP_17_091: [The HTTP header of iothub-messageid shall be set in the MessageId.]*/
-                                        size_t nHeaders;
-                                        if (HTTPHeaders_GetHeaderCount(responseHTTPHeaders, &nHeaders) != HTTP_HEADERS_OK)
+                                        if (strncmp(IOTHUB_APP_PREFIX, completeHeader, strlen(IOTHUB_APP_PREFIX)) == 0)
                                         {
-                                            LogError("unable to get the count of HTTP headers");
-                                            if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
+                                            /*looks like a property headers*/
+                                            /*there's a guaranteed ':' in the completeHeader, by HTTP_HEADERS module*/
+                                            char* whereIsColon = strchr(completeHeader, ':');
+                                            if (whereIsColon != NULL)
                                             {
-                                                LogError("HTTP Transport layer failed to report ABANDON disposition");
-                                            }
-                                        }
-                                        else
-                                        {
-                                            size_t i;
-                                            MAP_HANDLE properties = (nHeaders > 0) ? IoTHubMessage_Properties(receivedMessage) : NULL;
-                                            for (i = 0; i < nHeaders; i++)
-                                            {
-                                                char* completeHeader;
-                                                if (HTTPHeaders_GetHeader(responseHTTPHeaders, i, &completeHeader) != HTTP_HEADERS_OK)
-                                                {
-                                                    break;
-                                                }
-                                                else
+                                                *whereIsColon = '\0'; /*cut it down*/
+                                                if (Map_AddOrUpdate(properties, completeHeader + strlen(IOTHUB_APP_PREFIX), whereIsColon + 2) != MAP_OK) /*whereIsColon+1 is a space because HTTPEHADERS outputs a ": " between name and value*/
                                                 {
-                                                    if (strncmp(IOTHUB_APP_PREFIX, completeHeader, strlen(IOTHUB_APP_PREFIX)) == 0)
-                                                    {
-                                                        /*looks like a property headers*/
-                                                        /*there's a guaranteed ':' in the completeHeader, by HTTP_HEADERS module*/
-                                                        char* whereIsColon = strchr(completeHeader, ':');
-                                                        if (whereIsColon != NULL)
-                                                        {
-                                                            *whereIsColon = '\0'; /*cut it down*/
-                                                            if (Map_AddOrUpdate(properties, completeHeader + strlen(IOTHUB_APP_PREFIX), whereIsColon + 2) != MAP_OK) /*whereIsColon+1 is a space because HTTPEHADERS outputs a ": " between name and value*/
-                                                            {
-                                                                free(completeHeader);
-                                                                break;
-                                                            }
-                                                        }
-                                                    }
-                                                    else if (strncmp(IOTHUB_MESSAGE_ID, completeHeader, strlen(IOTHUB_MESSAGE_ID)) == 0)
-                                                    {
-                                                        char* whereIsColon = strchr(completeHeader, ':');
-                                                        if (whereIsColon != NULL)
-                                                        {
-                                                            *whereIsColon = '\0'; /*cut it down*/
-                                                            if (IoTHubMessage_SetMessageId(receivedMessage, whereIsColon + 2) != IOTHUB_MESSAGE_OK)
-                                                            {
-                                                                free(completeHeader);
-                                                                break;
-                                                            }
-                                                        }
-                                                    }
-                                                    else if (strncmp(IOTHUB_CORRELATION_ID, completeHeader, strlen(IOTHUB_CORRELATION_ID)) == 0)
-                                                    {
-                                                        char* whereIsColon = strchr(completeHeader, ':');
-                                                        if (whereIsColon != NULL)
-                                                        {
-                                                            *whereIsColon = '\0'; /*cut it down*/
-                                                            if (IoTHubMessage_SetCorrelationId(receivedMessage, whereIsColon + 2) != IOTHUB_MESSAGE_OK)
-                                                            {
-                                                                free(completeHeader);
-                                                                break;
-                                                            }
-                                                        }
-                                                    }
                                                     free(completeHeader);
+                                                    break;
                                                 }
                                             }
-
-                                            if (i < nHeaders)
+                                        }
+                                        else if (strncmp(IOTHUB_MESSAGE_ID, completeHeader, strlen(IOTHUB_MESSAGE_ID)) == 0)
+                                        {
+                                            char* whereIsColon = strchr(completeHeader, ':');
+                                            if (whereIsColon != NULL)
                                             {
-                                                if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
+                                                *whereIsColon = '\0'; /*cut it down*/
+                                                if (IoTHubMessage_SetMessageId(receivedMessage, whereIsColon + 2) != IOTHUB_MESSAGE_OK)
                                                 {
-                                                    LogError("HTTP Transport layer failed to report ABANDON disposition");
+                                                    free(completeHeader);
+                                                    break;
                                                 }
                                             }
-                                            else
+                                        }
+                                        else if (strncmp(IOTHUB_CORRELATION_ID, completeHeader, strlen(IOTHUB_CORRELATION_ID)) == 0)
+                                        {
+                                            char* whereIsColon = strchr(completeHeader, ':');
+                                            if (whereIsColon != NULL)
                                             {
-                                                MESSAGE_CALLBACK_INFO* messageData = MESSAGE_CALLBACK_INFO_Create(receivedMessage, handleData, deviceData, etagValue);
-                                                if (messageData == NULL)
-                                                {
-                                                    /*Codes_SRS_TRANSPORTMULTITHTTP_10_006: [If assembling the transport context fails, _DoWork shall "abandon" the message.] */
-                                                    LogError("failed to assemble callback info");
-                                                    if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
-                                                    {
-                                                        LogError("HTTP Transport layer failed to report ABANDON disposition");
-                                                    }
-                                                }
-                                                else
+                                                *whereIsColon = '\0'; /*cut it down*/
+                                                if (IoTHubMessage_SetCorrelationId(receivedMessage, whereIsColon + 2) != IOTHUB_MESSAGE_OK)
                                                 {
-                                                    bool abandon;
-                                                    if (IoTHubClient_LL_MessageCallback(iotHubClientHandle, messageData))
-                                                    {
-                                                        abandon = false;
-                                                    }
-                                                    else
-                                                    {
-                                                        LogError("IoTHubClient_LL_MessageCallback failed");
-                                                        abandon = true;
-                                                    }
-
-                                                    /*Codes_SRS_TRANSPORTMULTITHTTP_17_096: [If IoTHubClient_LL_MessageCallback returns false then _DoWork shall "abandon" the message.] */
-                                                    if (abandon)
-                                                    {
-                                                        (void)IoTHubTransportHttp_SendMessageDisposition(messageData, IOTHUBMESSAGE_ABANDONED);
-                                                    }
+                                                    free(completeHeader);
+                                                    break;
                                                 }
                                             }
                                         }
-                                        IoTHubMessage_Destroy(receivedMessage);
+                                        free(completeHeader);
+                                    }
+                                }
+
+                                if (i < nHeaders)
+                                {
+                                    if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
+                                    {
+                                        LogError("HTTP Transport layer failed to report ABANDON disposition");
+                                    }
+                                }
+                                else
+                                {
+                                    MESSAGE_CALLBACK_INFO* messageData = MESSAGE_CALLBACK_INFO_Create(receivedMessage, handleData, deviceData, etagValue);
+                                    if (messageData == NULL)
+                                    {
+                                        /*Codes_SRS_TRANSPORTMULTITHTTP_10_006: [If assembling the transport context fails, _DoWork shall "abandon" the message.] */
+                                        LogError("failed to assemble callback info");
+                                        if (!abandonOrAcceptMessage(handleData, deviceData, etagValue, IOTHUBMESSAGE_ABANDONED))
+                                        {
+                                            LogError("HTTP Transport layer failed to report ABANDON disposition");
+                                        }
+                                    }
+                                    else
+                                    {
+                                        bool abandon;
+                                        if (IoTHubClient_LL_MessageCallback(iotHubClientHandle, messageData))
+                                        {
+                                            abandon = false;
+                                        }
+                                        else
+                                        {
+                                            LogError("IoTHubClient_LL_MessageCallback failed");
+                                            abandon = true;
+                                        }
+
+                                        /*Codes_SRS_TRANSPORTMULTITHTTP_17_096: [If IoTHubClient_LL_MessageCallback returns false then _DoWork shall "abandon" the message.] */
+                                        if (abandon)
+                                        {
+                                            (void)IoTHubTransportHttp_SendMessageDisposition(messageData, IOTHUBMESSAGE_ABANDONED);
+                                        }
                                     }
                                 }
                             }
+                            IoTHubMessage_Destroy(receivedMessage);
                         }
                     }
-                    BUFFER_delete(responseContent);
                 }
-                HTTPHeaders_Free(responseHTTPHeaders);
             }
         }
+        BUFFER_delete(responseContent);
+        deviceData->pollResponseContent = NULL;
+    }
+    if (responseHTTPHeaders != NULL)
+    {
+        HTTPHeaders_Free(responseHTTPHeaders);
+        deviceData->pollResponseHeaders = NULL;
+    }
+}
+
+static bool isPollingAllowed(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, time_t timeNow)
+{
+    /*Codes_SRS_TRANSPORTMULTITHTTP_17_123: [After client creation, the first GET shall be allowed no matter what the value of GetMinimumPollingTime.] */
+    /*Codes_SRS_TRANSPORTMULTITHTTP_17_124: [If time is not available then all calls shall be treated as if they are the first one.] */
+    /*Codes_SRS_TRANSPORTMULTITHTTP_17_122: [A GET request that happens earlier than GetMinimumPollingTime shall be ignored.] */
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_007: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET request that happens earlier than the polling time of the device shall be ignored. ]*/
+    return deviceData->isFirstPoll || (timeNow == (time_t)(-1)) || (get_difftime(timeNow, deviceData->lastPollTime) > get_pollingTime(handleData, deviceData));
+}
+
+/*returns true when a GET was attempted for the device*/
+static bool DoMessages(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle)
+{
+    bool result = false;
+    /*Codes_SRS_TRANSPORTMULTITHTTP_17_083: [ If device is not subscribed then _DoWork shall advance to the next action. ] */
+    if (deviceData->DoWork_PullMessage)
+    {
+        time_t timeNow = get_time(NULL);
+        if (isPollingAllowed(handleData, deviceData, timeNow))
+        {
+            result = true;
+            GetMessage(deviceData, handleData->httpApiExHandle, timeNow);
+            ProcessMessage(handleData, deviceData, iotHubClientHandle);
+        }
         else
         {
             /*isPollingAllowed is false... */
             /*do nothing "shall be ignored*/
         }
     }
+    return result;
+}
+
+static void RunNextDevices(DEVICE_WORK* work, HTTPAPIEX_HANDLE httpApiExHandle)
+{
+    bool keepGoing = true;
+    while (keepGoing)
+    {
+        size_t deviceIndex = 0;
+        if (Lock(work->lock) != LOCK_OK)
+        {
+            LogError("unable to Lock, the devices left wait for the next DoWork");
+            keepGoing = false;
+        }
+        else
+        {
+            if (work->nextDevice < work->deviceCount)
+            {
+                deviceIndex = work->nextDevice;
+                work->nextDevice++;
+            }
+            else
+            {
+                keepGoing = false;
+            }
+            (void)Unlock(work->lock);
+        }
+
+        if (keepGoing)
+        {
+            IOTHUB_DEVICE_HANDLE* listItem = (IOTHUB_DEVICE_HANDLE *)VECTOR_element(work->handleData->perDeviceList, deviceIndex);
+            HTTPTRANSPORT_PERDEVICE_DATA* perDeviceItem = *(HTTPTRANSPORT_PERDEVICE_DATA**)(listItem);
+            work->deviceFunction(work, perDeviceItem, httpApiExHandle);
+        }
+    }
+}
+
+static void RunDeviceWork(void* context)
+{
+    DEVICE_WORKER* worker = (DEVICE_WORKER*)context;
+    DEVICE_WORK* work = worker->work;
+
+    RunNextDevices(work, worker->httpApiExHandle);
+
+    if (Lock(work->lock) != LOCK_OK)
+    {
+        /*not counting this worker out would keep DoWork waiting forever*/
+        LogError("unable to Lock, the worker is counted out without it");
+        work->runningWorkers--;
+        (void)Condition_Post(work->workerDone);
+    }
+    else
+    {
+        work->runningWorkers--;
+        (void)Condition_Post(work->workerDone);
+        (void)Unlock(work->lock);
+    }
+}
+
+static void WaitForDeviceWorkers(DEVICE_WORK* work)
+{
+    if (Lock(work->lock) != LOCK_OK)
+    {
+        LogError("unable to Lock, the workers are not waited for");
+    }
+    else
+    {
+        while (work->runningWorkers > 0)
+        {
+            /*0 waits until a worker posts workerDone*/
+            if (Condition_Wait(work->workerDone, work->lock, 0) == COND_ERROR)
+            {
+                LogError("unable to Condition_Wait");
+            }
+        }
+        (void)Unlock(work->lock);
+    }
+}
+
+/*runs deviceFunction for every device from up to workerCount pooled threads and the calling thread, returns false when the calling thread has to do all of it*/
+static bool RunConcurrently(DEVICE_WORK* work, DEVICE_WORK_FUNCTION deviceFunction, size_t deviceCount, size_t workerCount)
+{
+    bool result;
+    if (Lock(work->lock) != LOCK_OK)
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_017: [ If the threads cannot be set up, IoTHubTransportHttp_DoWork shall send the events of all the devices from the calling thread. ]*/
+        LogError("unable to Lock");
+        result = false;
+    }
+    else
+    {
+        size_t i;
+
+        work->deviceFunction = deviceFunction;
+        work->deviceCount = deviceCount;
+        work->nextDevice = 0;
+        work->runningWorkers = 0;
+
+        for (i = 0; (i < workerCount) && (i < work->workerCount); i++)
+        {
+            /*counted before posting, so a worker that finishes first never takes the count below 0*/
+            work->runningWorkers++;
+            if (callback_pool_post(work->pool, RunDeviceWork, &work->workers[i], false) != 0)
+            {
+                /*the workers already posted and the calling thread take over the remaining devices*/
+                LogError("unable to callback_pool_post");
+                work->runningWorkers--;
+                break;
+            }
+        }
+        (void)Unlock(work->lock);
+
+        RunNextDevices(work, work->handleData->httpApiExHandle);
+
+        WaitForDeviceWorkers(work);
+        result = true;
+    }
+    return result;
+}
+
+static void SendEventsOfDevice(DEVICE_WORK* work, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, HTTPAPIEX_HANDLE httpApiExHandle)
+{
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_015: [ Each device shall have its events sent by exactly one of the threads, so that the events of a device keep their order. ]*/
+    DoEvent(work->handleData, deviceData, httpApiExHandle, deviceData->iotHubClientHandle, true);
+}
+
+static void GetMessageOfDevice(DEVICE_WORK* work, HTTPTRANSPORT_PERDEVICE_DATA* deviceData, HTTPAPIEX_HANDLE httpApiExHandle)
+{
+    if (deviceData->isPollDue)
+    {
+        GetMessage(deviceData, httpApiExHandle, work->pollTime);
+    }
+}
+
+/*counts the devices that have events waiting, stopping at limit*/
+static size_t countDevicesWithEvents(HTTPTRANSPORT_HANDLE_DATA* handleData, size_t deviceListSize, size_t limit)
+{
+    size_t result = 0;
+    size_t i;
+    for (i = 0; (i < deviceListSize) && (result < limit); i++)
+    {
+        IOTHUB_DEVICE_HANDLE* listItem = (IOTHUB_DEVICE_HANDLE *)VECTOR_element(handleData->perDeviceList, i);
+        HTTPTRANSPORT_PERDEVICE_DATA* perDeviceItem = *(HTTPTRANSPORT_PERDEVICE_DATA**)(listItem);
+        if (!DList_IsListEmpty(perDeviceItem->waitingToSend))
+        {
+            result++;
+        }
+    }
+    return result;
+}
+
+/*returns false when the events have to be sent by the calling thread only*/
+static bool DoEventsConcurrently(HTTPTRANSPORT_HANDLE_DATA* handleData, size_t deviceListSize)
+{
+    bool result;
+    DEVICE_WORK* work = handleData->deviceWork;
+    /*there is no point in having more workers than devices with events, the calling thread sends events too*/
+    size_t devicesWithEvents = countDevicesWithEvents(handleData, deviceListSize, work->workerCount + 1);
+
+    if (devicesWithEvents < 2)
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_029: [ If fewer than 2 devices have events waiting, IoTHubTransportHttp_DoWork shall send the events from the calling thread without posting work to the callback pool. ]*/
+        result = false;
+    }
+    else
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_014: [ If EventSendConcurrency is greater than 1 and more than 1 device has events waiting, IoTHubTransportHttp_DoWork shall send the events of the devices from up to EventSendConcurrency - 1 work items posted to the callback pool (at most one per device with events beyond the first) and the calling thread, each using its own HTTPAPIEX_HANDLE. ]*/
+        /*the events sent by the workers are confirmed by DoWork once all of them are done*/
+        result = RunConcurrently(work, SendEventsOfDevice, deviceListSize, devicesWithEvents - 1);
+    }
+    return result;
+}
+
+/*picks the devices due for a GET in this DoWork and issues their GETs ahead of the device loop, which processes the responses*/
+static void GetMessagesConcurrently(HTTPTRANSPORT_HANDLE_DATA* handleData, size_t deviceListSize, size_t first)
+{
+    DEVICE_WORK* work = handleData->deviceWork;
+    size_t devicesDue = 0;
+    bool isTimeRead = false;
+    time_t timeNow = (time_t)(-1);
+    size_t j;
+
+    for (j = 0; j < deviceListSize; j++)
+    {
+        size_t i = (first + j) % deviceListSize;
+        IOTHUB_DEVICE_HANDLE* listItem = (IOTHUB_DEVICE_HANDLE *)VECTOR_element(handleData->perDeviceList, i);
+        HTTPTRANSPORT_PERDEVICE_DATA* perDeviceItem = *(HTTPTRANSPORT_PERDEVICE_DATA**)(listItem);
+
+        /*Codes_SRS_TRANSPORTMULTITHTTP_17_083: [ If device is not subscribed then _DoWork shall advance to the next action. ] */
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_009: [ Once MaximumPollsPerDoWork GET requests were attempted, IoTHubTransportHttp_DoWork shall not pull messages for the rest of the devices. ]*/
+        if (perDeviceItem->DoWork_PullMessage &&
+            ((handleData->maximumPollsPerDoWork == 0) || (devicesDue < handleData->maximumPollsPerDoWork)))
+        {
+            if (!isTimeRead)
+            {
+                timeNow = get_time(NULL);
+                isTimeRead = true;
+            }
+
+            if (isPollingAllowed(handleData, perDeviceItem, timeNow))
+            {
+                perDeviceItem->isPollDue = true;
+                devicesDue++;
+                if (handleData->maximumPollsPerDoWork != 0)
+                {
+                    handleData->nextPollDevice = (i + 1) % deviceListSize;
+                }
+            }
+        }
+    }
+
+    work->pollTime = timeNow;
+    /*Codes_SRS_TRANSPORTMULTITHTTP_09_030: [ If EventSendConcurrency is greater than 1 and more than 1 device is due for a GET, IoTHubTransportHttp_DoWork shall issue the GETs from up to EventSendConcurrency - 1 work items posted to the callback pool (at most one per due device beyond the first) and the calling thread, each using its own HTTPAPIEX_HANDLE. ]*/
+    if ((devicesDue > 0) &&
+        ((devicesDue < 2) || !RunConcurrently(work, GetMessageOfDevice, deviceListSize, devicesDue - 1)))
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_032: [ If fewer than 2 devices are due for a GET or the threads cannot be set up, IoTHubTransportHttp_DoWork shall issue the GETs from the calling thread. ]*/
+        for (j = 0; j < deviceListSize; j++)
+        {
+            IOTHUB_DEVICE_HANDLE* listItem = (IOTHUB_DEVICE_HANDLE *)VECTOR_element(handleData->perDeviceList, j);
+            GetMessageOfDevice(work, *(HTTPTRANSPORT_PERDEVICE_DATA**)(listItem), handleData->httpApiExHandle);
+        }
+    }
+}
+
+static void CompleteDeferredEvents(HTTPTRANSPORT_PERDEVICE_DATA* deviceData)
+{
+    if (deviceData->hasDeferredSendComplete)
+    {
+        deviceData->hasDeferredSendComplete = false;
+        IoTHubClient_LL_SendComplete(deviceData->iotHubClientHandle, &(deviceData->eventConfirmations), deviceData->deferredSendCompleteResult);
+    }
 }
 
 static IOTHUB_PROCESS_ITEM_RESULT IoTHubTransportHttp_ProcessItem(TRANSPORT_LL_HANDLE handle, IOTHUB_IDENTITY_TYPE item_type, IOTHUB_IDENTITY_INFO* iothub_item)
@@ -2255,16 +2751,51 @@ static void IoTHubTransportHttp_DoWork(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT
         HTTPTRANSPORT_HANDLE_DATA* handleData = (HTTPTRANSPORT_HANDLE_DATA*)handle;
         IOTHUB_DEVICE_HANDLE* listItem;
         size_t deviceListSize = VECTOR_size(handleData->perDeviceList);
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_010: [ If MaximumPollsPerDoWork is not 0, IoTHubTransportHttp_DoWork shall start the loop with the device following the last device that issued a GET in the previous call. ]*/
+        size_t first = (handleData->nextPollDevice < deviceListSize) ? handleData->nextPollDevice : 0;
+        size_t polls = 0;
+        bool areEventsSent = (handleData->deviceWork != NULL) && (deviceListSize > 1) && DoEventsConcurrently(handleData, deviceListSize);
+        bool areMessagesFetched = (handleData->deviceWork != NULL) && (deviceListSize > 1);
+        if (areMessagesFetched)
+        {
+            GetMessagesConcurrently(handleData, deviceListSize, first);
+        }
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_052: [ IoTHubTransportHttp_DoWork shall perform a round-robin loop through every deviceHandle in the transport device list, using the iotHubClientHandle field saved in the IOTHUB_DEVICE_HANDLE. ]*/
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_050: [ IoTHubTransportHttp_DoWork shall call loop through the device list. ] */
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_051: [ IF the list is empty, then IoTHubTransportHttp_DoWork shall do nothing. ]*/
-        for (size_t i = 0; i < deviceListSize; i++)
+        for (size_t j = 0; j < deviceListSize; j++)
         {
+            size_t i = (first + j) % deviceListSize;
             listItem = (IOTHUB_DEVICE_HANDLE *) VECTOR_element(handleData->perDeviceList, i);
             HTTPTRANSPORT_PERDEVICE_DATA* perDeviceItem = *(HTTPTRANSPORT_PERDEVICE_DATA**)(listItem);
-            DoEvent(handleData, perDeviceItem, perDeviceItem->iotHubClientHandle);
-            DoMessages(handleData, perDeviceItem, perDeviceItem->iotHubClientHandle);
+            if (areEventsSent)
+            {
+                CompleteDeferredEvents(perDeviceItem);
+            }
+            else
+            {
+                DoEvent(handleData, perDeviceItem, handleData->httpApiExHandle, perDeviceItem->iotHubClientHandle, false);
+            }
 
+            if (areMessagesFetched)
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_09_031: [ The responses of the GETs issued from the callback pool shall be processed by IoTHubTransportHttp_DoWork from the calling thread, in the order of the device list, so that IoTHubClient_LL_MessageCallback and the message dispositions stay on the calling thread. ]*/
+                if (perDeviceItem->isPollDue)
+                {
+                    perDeviceItem->isPollDue = false;
+                    ProcessMessage(handleData, perDeviceItem, perDeviceItem->iotHubClientHandle);
+                }
+            }
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_009: [ Once MaximumPollsPerDoWork GET requests were attempted, IoTHubTransportHttp_DoWork shall not pull messages for the rest of the devices. ]*/
+            else if ((handleData->maximumPollsPerDoWork == 0) || (polls < handleData->maximumPollsPerDoWork))
+            {
+                if (DoMessages(handleData, perDeviceItem, perDeviceItem->iotHubClientHandle) &&
+                    (handleData->maximumPollsPerDoWork != 0))
+                {
+                    polls++;
+                    handleData->nextPollDevice = (i + 1) % deviceListSize;
+                }
+            }
         }
     }
     else
@@ -2291,8 +2822,7 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_GetSendStatus(IOTHUB_DEVICE_HAND
     else
     {
         /*Codes_SRS_TRANSPORTMULTITHTTP_17_138: [ IoTHubTransportHttp_GetSendStatus shall locate deviceHandle in the transport device list by calling list_find_if. ]*/
-        IOTHUB_DEVICE_HANDLE* listItem = get_perDeviceDataItem(handle);
-        if (listItem == NULL)
+        if (!is_device_registered(handle))
         {
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_139: [ If the device structure is not found, then this function shall fail and return with IOTHUB_CLIENT_INVALID_ARG. ]*/
             result = IOTHUB_CLIENT_INVALID_ARG;
@@ -2300,7 +2830,7 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_GetSendStatus(IOTHUB_DEVICE_HAND
         }
         else
         {
-            HTTPTRANSPORT_PERDEVICE_DATA* deviceData = (HTTPTRANSPORT_PERDEVICE_DATA*)(*listItem);
+            HTTPTRANSPORT_PERDEVICE_DATA* deviceData = (HTTPTRANSPORT_PERDEVICE_DATA*)handle;
             /* Codes_SRS_TRANSPORTMULTITHTTP_17_113: [ IoTHubTransportHttp_GetSendStatus shall return IOTHUB_CLIENT_OK and status IOTHUB_CLIENT_SEND_STATUS_BUSY if there are currently event items to be sent or being sent. ] */
             if (!DList_IsListEmpty(deviceData->waitingToSend))
             {
@@ -2318,6 +2848,176 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_GetSendStatus(IOTHUB_DEVICE_HAND
     return result;
 }
 
+static int apply_httpApiExOptions(HTTPTRANSPORT_HANDLE_DATA* handleData, HTTPAPIEX_HANDLE httpApiExHandle)
+{
+    int result = 0;
+    if (handleData->httpApiExOptions != NULL)
+    {
+        size_t optionCount = VECTOR_size(handleData->httpApiExOptions);
+        size_t i;
+        for (i = 0; (result == 0) && (i < optionCount); i++)
+        {
+            HTTPAPIEX_SAVED_OPTION* savedOption = (HTTPAPIEX_SAVED_OPTION*)VECTOR_element(handleData->httpApiExOptions, i);
+            const char* optionName = STRING_c_str(savedOption->name);
+            if (HTTPAPIEX_SetOption(httpApiExHandle, optionName, savedOption->value) != HTTPAPIEX_OK)
+            {
+                LogError("unable to HTTPAPIEX_SetOption %s", optionName);
+                result = __FAILURE__;
+            }
+        }
+    }
+    return result;
+}
+
+static bool findSavedOption(const void* element, const void* value)
+{
+    const HTTPAPIEX_SAVED_OPTION* savedOption = (const HTTPAPIEX_SAVED_OPTION*)element;
+    return (strcmp(STRING_c_str(savedOption->name), (const char*)value) == 0);
+}
+
+static int save_httpApiExOption(HTTPTRANSPORT_HANDLE_DATA* handleData, const char* option, const void* value)
+{
+    int result;
+    const void* savedValue;
+    if ((handleData->httpApiExOptions == NULL) &&
+        ((handleData->httpApiExOptions = VECTOR_create(sizeof(HTTPAPIEX_SAVED_OPTION))) == NULL))
+    {
+        LogError("unable to VECTOR_create");
+        result = __FAILURE__;
+    }
+    else if (HTTPAPI_CloneOption(option, value, &savedValue) != HTTPAPI_OK)
+    {
+        LogError("unable to HTTPAPI_CloneOption %s", option);
+        result = __FAILURE__;
+    }
+    else
+    {
+        HTTPAPIEX_SAVED_OPTION* savedOption = (HTTPAPIEX_SAVED_OPTION*)VECTOR_find_if(handleData->httpApiExOptions, findSavedOption, option);
+        if (savedOption != NULL)
+        {
+            /*the last value wins, as it does on the connections that already exist*/
+            free((void*)savedOption->value);
+            savedOption->value = savedValue;
+            result = 0;
+        }
+        else
+        {
+            HTTPAPIEX_SAVED_OPTION newOption;
+            if ((newOption.name = STRING_construct(option)) == NULL)
+            {
+                LogError("unable to STRING_construct");
+                free((void*)savedValue);
+                result = __FAILURE__;
+            }
+            else
+            {
+                newOption.value = savedValue;
+                if (VECTOR_push_back(handleData->httpApiExOptions, &newOption, 1) != 0)
+                {
+                    LogError("unable to VECTOR_push_back");
+                    STRING_delete(newOption.name);
+                    free((void*)savedValue);
+                    result = __FAILURE__;
+                }
+                else
+                {
+                    result = 0;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+static DEVICE_WORK* create_deviceWork(HTTPTRANSPORT_HANDLE_DATA* handleData, size_t workerCount)
+{
+    DEVICE_WORK* result;
+    if ((result = (DEVICE_WORK*)malloc(sizeof(DEVICE_WORK))) == NULL)
+    {
+        LogError("unable to malloc");
+    }
+    else
+    {
+        result->handleData = handleData;
+        result->pool = NULL;
+        result->lock = NULL;
+        result->workerDone = NULL;
+        result->workerCount = 0;
+        result->deviceFunction = NULL;
+        result->pollTime = (time_t)(-1);
+        result->deviceCount = 0;
+        result->nextDevice = 0;
+        result->runningWorkers = 0;
+
+        if ((result->workers = (DEVICE_WORKER*)malloc(workerCount * sizeof(DEVICE_WORKER))) == NULL)
+        {
+            LogError("unable to malloc");
+            free(result);
+            result = NULL;
+        }
+        else
+        {
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_018: [ Setting EventSendConcurrency to more than 1 shall create EventSendConcurrency - 1 HTTPAPIEX_HANDLEs by calling HTTPAPIEX_Create with the host name, kept until the transport is destroyed. ]*/
+            while (result->workerCount < workerCount)
+            {
+                DEVICE_WORKER* worker = &(result->workers[result->workerCount]);
+                worker->work = result;
+                if ((worker->httpApiExHandle = HTTPAPIEX_Create(STRING_c_str(handleData->hostName))) == NULL)
+                {
+                    LogError("unable to HTTPAPIEX_Create");
+                    break;
+                }
+                /*Codes_SRS_TRANSPORTMULTITHTTP_09_028: [ The options passed to HTTPAPIEX_SetOption shall be saved by calling HTTPAPI_CloneOption and passed to the HTTPAPIEX_HANDLEs created by a later EventSendConcurrency, so that the options and EventSendConcurrency can be set in any order. ]*/
+                else if (apply_httpApiExOptions(handleData, worker->httpApiExHandle) != 0)
+                {
+                    HTTPAPIEX_Destroy(worker->httpApiExHandle);
+                    break;
+                }
+                else
+                {
+                    result->workerCount++;
+                }
+            }
+
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_026: [ Setting EventSendConcurrency to more than 1 shall also create a lock, a condition and a callback pool of EventSendConcurrency - 1 threads by calling callback_pool_create, reused by every call to IoTHubTransportHttp_DoWork. ]*/
+            if ((result->workerCount < workerCount) ||
+                ((result->lock = Lock_Init()) == NULL) ||
+                ((result->workerDone = Condition_Init()) == NULL) ||
+                ((result->pool = callback_pool_create(workerCount)) == NULL))
+            {
+                /*Codes_SRS_TRANSPORTMULTITHTTP_09_027: [ If any of them cannot be created, setting EventSendConcurrency shall destroy what was created, keep the previous EventSendConcurrency and return IOTHUB_CLIENT_ERROR. ]*/
+                LogError("unable to set up the device workers");
+                destroy_deviceWork(result);
+                result = NULL;
+            }
+        }
+    }
+    return result;
+}
+
+static IOTHUB_CLIENT_RESULT set_eventSendConcurrency(HTTPTRANSPORT_HANDLE_DATA* handleData, size_t concurrency)
+{
+    IOTHUB_CLIENT_RESULT result;
+    DEVICE_WORK* work = NULL;
+    if (concurrency == 0)
+    {
+        LogError("EventSendConcurrency cannot be 0");
+        result = IOTHUB_CLIENT_INVALID_ARG;
+    }
+    else if ((concurrency > 1) && ((work = create_deviceWork(handleData, concurrency - 1)) == NULL))
+    {
+        result = IOTHUB_CLIENT_ERROR;
+    }
+    else
+    {
+        destroy_deviceWork(handleData->deviceWork);
+        handleData->deviceWork = work;
+        handleData->eventSendConcurrency = concurrency;
+        result = IOTHUB_CLIENT_OK;
+    }
+    return result;
+}
+
 static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
     IOTHUB_CLIENT_RESULT result;
@@ -2349,6 +3049,24 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_SetOption(TRANSPORT_LL_HANDLE ha
             handleData->getMinimumPollingTime = *(unsigned int*)value;
             result = IOTHUB_CLIENT_OK;
         }
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_004: ["MaximumPollingTime"] */
+        else if (strcmp(OPTION_MAX_POLLING_TIME, option) == 0)
+        {
+            handleData->getMaximumPollingTime = *(unsigned int*)value;
+            result = IOTHUB_CLIENT_OK;
+        }
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_008: ["MaximumPollsPerDoWork"] */
+        else if (strcmp(OPTION_MAX_POLLS_PER_DO_WORK, option) == 0)
+        {
+            handleData->maximumPollsPerDoWork = *(size_t*)value;
+            handleData->nextPollDevice = 0;
+            result = IOTHUB_CLIENT_OK;
+        }
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_011: ["EventSendConcurrency"] */
+        else if (strcmp(OPTION_EVENT_SEND_CONCURRENCY, option) == 0)
+        {
+            result = set_eventSendConcurrency(handleData, *(size_t*)value);
+        }
         else
         {
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_126: [ "TrustedCerts"] */
@@ -2356,10 +3074,28 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_SetOption(TRANSPORT_LL_HANDLE ha
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_129: [ This option shall passed down to the lower layer by calling HTTPAPIEX_SetOption. ]*/
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_118: [Otherwise, IoTHubTransport_Http shall call HTTPAPIEX_SetOption with the same parameters and return the translated code.] */
             HTTPAPIEX_RESULT HTTPAPIEX_result = HTTPAPIEX_SetOption(handleData->httpApiExHandle, option, value);
+            if (handleData->deviceWork != NULL)
+            {
+                size_t i;
+                /*Codes_SRS_TRANSPORTMULTITHTTP_09_013: [ The options passed to HTTPAPIEX_SetOption shall also be passed to the HTTPAPIEX_HANDLEs created for EventSendConcurrency. ]*/
+                for (i = 0; (HTTPAPIEX_result == HTTPAPIEX_OK) && (i < handleData->deviceWork->workerCount); i++)
+                {
+                    HTTPAPIEX_result = HTTPAPIEX_SetOption(handleData->deviceWork->workers[i].httpApiExHandle, option, value);
+                }
+            }
             /*Codes_SRS_TRANSPORTMULTITHTTP_17_119: [The following table translates HTTPAPIEX return codes to IOTHUB_CLIENT_RESULT return codes:] */
             if (HTTPAPIEX_result == HTTPAPIEX_OK)
             {
-                result = IOTHUB_CLIENT_OK;
+                /*Codes_SRS_TRANSPORTMULTITHTTP_09_028: [ The options passed to HTTPAPIEX_SetOption shall be saved by calling HTTPAPI_CloneOption and passed to the HTTPAPIEX_HANDLEs created by a later EventSendConcurrency, so that the options and EventSendConcurrency can be set in any order. ]*/
+                if (save_httpApiExOption(handleData, option, value) != 0)
+                {
+                    LogError("unable to save option %s for the connections of a later EventSendConcurrency", option);
+                    result = IOTHUB_CLIENT_ERROR;
+                }
+                else
+                {
+                    result = IOTHUB_CLIENT_OK;
+                }
             }
             else if (HTTPAPIEX_result == HTTPAPIEX_INVALID_ARG)
             {
@@ -2407,6 +3143,40 @@ static int IoTHubTransportHttp_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHUB
     return result;
 }
 
+static IOTHUB_CLIENT_RESULT IoTHubTransportHttp_GetStatistics(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    IOTHUB_CLIENT_RESULT result;
+
+    if (handle == NULL || statistics == NULL)
+    {
+        /*Codes_SRS_TRANSPORTMULTITHTTP_09_001: [ IoTHubTransportHttp_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG if called with NULL parameter. ]*/
+        result = IOTHUB_CLIENT_INVALID_ARG;
+        LogError("Invalid argument (handle=%p, statistics=%p)", handle, statistics);
+    }
+    else
+    {
+        if (!is_device_registered(handle))
+        {
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_002: [ If the device structure is not found, then IoTHubTransportHttp_GetStatistics shall fail and return with IOTHUB_CLIENT_INVALID_ARG. ]*/
+            result = IOTHUB_CLIENT_INVALID_ARG;
+            LogError("Device not found in transport list.");
+        }
+        else
+        {
+            HTTPTRANSPORT_PERDEVICE_DATA* deviceData = (HTTPTRANSPORT_PERDEVICE_DATA*)handle;
+            /*Codes_SRS_TRANSPORTMULTITHTTP_09_003: [ IoTHubTransportHttp_GetStatistics shall set messagesSent, bytesSent and bytesReceived from the device counters, set reconnectCount and sasTokenRefreshCount to 0 and return IOTHUB_CLIENT_OK. ]*/
+            statistics->messagesSent = deviceData->messagesSent;
+            statistics->bytesSent = deviceData->bytesSent;
+            statistics->bytesReceived = deviceData->bytesReceived;
+            statistics->reconnectCount = 0;
+            statistics->sasTokenRefreshCount = 0;
+            result = IOTHUB_CLIENT_OK;
+        }
+    }
+
+    return result;
+}
+
 /*Codes_SRS_TRANSPORTMULTITHTTP_17_125: [This function shall return a pointer to a structure of type TRANSPORT_PROVIDER having the following values for its fields:] */
 static TRANSPORT_PROVIDER thisTransportProvider =
 {
@@ -2427,7 +3197,8 @@ static TRANSPORT_PROVIDER thisTransportProvider =
     IoTHubTransportHttp_Unsubscribe,                /*pfIoTHubTransport_Unsubscribe IoTHubTransport_Unsubscribe;*/
     IoTHubTransportHttp_DoWork,                     /*pfIoTHubTransport_DoWork IoTHubTransport_DoWork;*/
     IoTHubTransportHttp_SetRetryPolicy,             /*pfIoTHubTransport_DoWork IoTHubTransport_SetRetryPolicy;*/
-    IoTHubTransportHttp_GetSendStatus               /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+    IoTHubTransportHttp_GetSendStatus,              /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+    IoTHubTransportHttp_GetStatistics               /*pfIoTHubTransport_GetStatistics IoTHubTransport_GetStatistics;*/
 };
 
 const TRANSPORT_PROVIDER* HTTP_Protocol(void)
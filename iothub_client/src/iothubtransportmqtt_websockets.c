@@ -171,6 +171,12 @@ static IOTHUB_CLIENT_RESULT IoTHubTransportMqtt_WS_GetSendStatus(IOTHUB_DEVICE_H
     return IoTHubTransport_MQTT_Common_GetSendStatus(handle, iotHubClientStatus);
 }
 
+/* Codes_SRS_IOTHUB_MQTT_WEBSOCKET_TRANSPORT_09_001: [ IoTHubTransportMqtt_WS_GetStatistics shall get the transport counters by calling into the IoTHubTransport_MQTT_Common_GetStatistics function. ] */
+static IOTHUB_CLIENT_RESULT IoTHubTransportMqtt_WS_GetStatistics(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    return IoTHubTransport_MQTT_Common_GetStatistics(handle, statistics);
+}
+
 /* Codes_SRS_IOTHUB_MQTT_WEBSOCKET_TRANSPORT_07_009: [ IoTHubTransportMqtt_WS_SetOption shall set the options by calling into the IoTHubMqttAbstract_SetOption function. ] */
 static IOTHUB_CLIENT_RESULT IoTHubTransportMqtt_WS_SetOption(TRANSPORT_LL_HANDLE handle, const char* option, const void* value)
 {
@@ -238,7 +244,8 @@ static TRANSPORT_PROVIDER thisTransportProvider_WebSocketsOverTls = {
     IoTHubTransportMqtt_WS_Unsubscribe,
     IoTHubTransportMqtt_WS_DoWork,
     IoTHubTransportMqtt_WS_SetRetryPolicy,
-    IoTHubTransportMqtt_WS_GetSendStatus
+    IoTHubTransportMqtt_WS_GetSendStatus,
+    IoTHubTransportMqtt_WS_GetStatistics
 };
 
 const TRANSPORT_PROVIDER* MQTT_WebSocket_Protocol(void)
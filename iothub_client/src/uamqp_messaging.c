@@ -1,6 +1,7 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 #include <stdlib.h>
+#include <string.h>
 #include "uamqp_messaging.h"
 #include "azure_c_shared_utility/optimize_size.h"
 #include "azure_c_shared_utility/xlogging.h"
@@ -535,3 +536,137 @@ int message_create_from_iothub_message(IOTHUB_MESSAGE_HANDLE iothub_message, MES
 
 	return result;
 }
+
+static int encode_callback(void* context, const unsigned char* bytes, size_t length)
+{
+	BINARY_DATA* encoded_message = (BINARY_DATA*)context;
+	(void)memcpy((unsigned char*)encoded_message->bytes + encoded_message->length, bytes, length);
+	encoded_message->length += length;
+	return RESULT_OK;
+}
+
+int message_create_uamqp_encoding_from_iothub_message(IOTHUB_MESSAGE_HANDLE iothub_message, BINARY_DATA* encoded_message)
+{
+	int result;
+	MESSAGE_HANDLE uamqp_message;
+
+	// Codes_SRS_UAMQP_MESSAGING_09_100: [A uAMQP message shall be created out of `iothub_message` using message_create_from_iothub_message().]
+	if (message_create_from_iothub_message(iothub_message, &uamqp_message) != RESULT_OK)
+	{
+		// Codes_SRS_UAMQP_MESSAGING_09_101: [If message_create_from_iothub_message() fails, message_create_uamqp_encoding_from_iothub_message() shall fail and return.]
+		LogError("Failed encoding the IOTHUB_MESSAGE_HANDLE instance (message_create_from_iothub_message failed).");
+		result = __FAILURE__;
+	}
+	else
+	{
+		PROPERTIES_HANDLE properties = NULL;
+		AMQP_VALUE application_properties = NULL;
+		BINARY_DATA body;
+		// properties, application-properties and data sections, in the order of the AMQP message format
+		AMQP_VALUE sections[3] = { NULL, NULL, NULL };
+		size_t section_count = 0;
+
+		// Codes_SRS_UAMQP_MESSAGING_09_102: [The properties, application properties and body of the uAMQP message shall each be wrapped in its AMQP section using amqpvalue_create_properties(), amqpvalue_create_application_properties() and amqpvalue_create_data(); absent properties are skipped.]
+		if (message_get_properties(uamqp_message, &properties) != 0 ||
+			message_get_application_properties(uamqp_message, &application_properties) != 0 ||
+			message_get_body_amqp_data_in_place(uamqp_message, 0, &body) != 0)
+		{
+			LogError("Failed reading the sections of the uAMQP message.");
+			result = __FAILURE__;
+		}
+		else if (properties != NULL && (sections[section_count++] = amqpvalue_create_properties(properties)) == NULL)
+		{
+			LogError("Failed creating the properties section (amqpvalue_create_properties failed).");
+			result = __FAILURE__;
+		}
+		else if (application_properties != NULL && (sections[section_count++] = amqpvalue_create_application_properties(application_properties)) == NULL)
+		{
+			LogError("Failed creating the application properties section (amqpvalue_create_application_properties failed).");
+			result = __FAILURE__;
+		}
+		else
+		{
+			data body_data;
+			body_data.bytes = body.bytes;
+			body_data.length = (uint32_t)body.length;
+
+			if ((sections[section_count++] = amqpvalue_create_data(body_data)) == NULL)
+			{
+				LogError("Failed creating the data section (amqpvalue_create_data failed).");
+				result = __FAILURE__;
+			}
+			else
+			{
+				size_t encoded_size = 0;
+				size_t i;
+
+				result = RESULT_OK;
+
+				// Codes_SRS_UAMQP_MESSAGING_09_103: [The sections shall be encoded with amqpvalue_encode() into a single buffer sized with amqpvalue_get_encoded_size(), returned through `encoded_message`; the caller shall free it.]
+				for (i = 0; i < section_count; i++)
+				{
+					size_t section_size;
+					if (amqpvalue_get_encoded_size(sections[i], &section_size) != 0)
+					{
+						LogError("Failed getting the encoded size of a uAMQP message section.");
+						result = __FAILURE__;
+						break;
+					}
+					encoded_size += section_size;
+				}
+
+				if (result == RESULT_OK)
+				{
+					if ((encoded_message->bytes = (const unsigned char*)malloc(encoded_size)) == NULL)
+					{
+						LogError("Failed allocating the encoded uAMQP message.");
+						result = __FAILURE__;
+					}
+					else
+					{
+						encoded_message->length = 0;
+
+						for (i = 0; i < section_count; i++)
+						{
+							if (amqpvalue_encode(sections[i], encode_callback, encoded_message) != 0)
+							{
+								LogError("Failed encoding a uAMQP message section.");
+								result = __FAILURE__;
+								break;
+							}
+						}
+
+						if (result != RESULT_OK)
+						{
+							free((void*)encoded_message->bytes);
+							encoded_message->bytes = NULL;
+							encoded_message->length = 0;
+						}
+					}
+				}
+			}
+		}
+
+		for (; section_count > 0; section_count--)
+		{
+			if (sections[section_count - 1] != NULL)
+			{
+				amqpvalue_destroy(sections[section_count - 1]);
+			}
+		}
+
+		if (properties != NULL)
+		{
+			properties_destroy(properties);
+		}
+
+		if (application_properties != NULL)
+		{
+			amqpvalue_destroy(application_properties);
+		}
+
+		message_destroy(uamqp_message);
+	}
+
+	return result;
+}
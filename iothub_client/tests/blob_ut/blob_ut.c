@@ -29,6 +29,8 @@ static void my_gballoc_free(void* s)
 #include "azure_c_shared_utility/base64.h"
 #include "azure_c_shared_utility/httpheaders.h"
 #include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/threadapi.h"
 #undef ENABLE_MOCKS
 
 #include "blob.h"
@@ -69,6 +71,11 @@ static BUFFER_HANDLE my_BUFFER_create(const unsigned char* source, size_t size)
     return (BUFFER_HANDLE)my_gballoc_malloc(1);
 }
 
+static BUFFER_HANDLE my_BUFFER_new(void)
+{
+    return (BUFFER_HANDLE)my_gballoc_malloc(1);
+}
+
 static void my_BUFFER_delete(BUFFER_HANDLE h)
 {
     my_gballoc_free(h);
@@ -104,6 +111,14 @@ static STRING_HANDLE my_Base64_Encode_Bytes(const unsigned char* source, size_t
     return (STRING_HANDLE)my_gballoc_malloc(1);
 }
 
+/*the threads of Blob_UploadBlocksFromSasUri run to completion as soon as they are created*/
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+    *threadHandle = (THREAD_HANDLE)0x4243;
+    (void)func(arg);
+    return THREADAPI_OK;
+}
+
 TEST_DEFINE_ENUM_TYPE(BLOB_RESULT, BLOB_RESULT_VALUES);
 
 static TEST_MUTEX_HANDLE g_dllByDll;
@@ -130,6 +145,27 @@ static unsigned int httpResponse; /*used as out parameter in every call to Blob_
 static const unsigned int TwoHundred = 200;
 static const unsigned int FourHundredFour = 404;
 
+static unsigned char testBlock[] = { '3', '3', '3' };
+static size_t testBlockSize; /*size reported for every block by testGetDataCallback*/
+static size_t testBlocksLeft; /*blocks testGetDataCallback still has to produce*/
+
+static void testGetDataCallback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
+{
+    (void)result;
+    (void)context;
+    if (testBlocksLeft > 0)
+    {
+        *data = testBlock;
+        *size = testBlockSize;
+        testBlocksLeft--;
+    }
+    else
+    {
+        *data = NULL;
+        *size = 0;
+    }
+}
+
 
 BEGIN_TEST_SUITE(blob_ut)
 
@@ -152,6 +188,9 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_create, my_BUFFER_create);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_create, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(BUFFER_delete, my_BUFFER_delete);
+    REGISTER_GLOBAL_MOCK_HOOK(BUFFER_new, my_BUFFER_new);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_new, NULL);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(BUFFER_build, __FAILURE__);
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Alloc, my_HTTPHeaders_Alloc);
     REGISTER_GLOBAL_MOCK_HOOK(HTTPHeaders_Free, my_HTTPHeaders_Free);
@@ -166,6 +205,10 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
 
     REGISTER_GLOBAL_MOCK_RETURNS(HTTPAPIEX_SetOption, HTTPAPIEX_OK, HTTPAPIEX_ERROR);
 
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, (LOCK_HANDLE)0x4242);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+
     REGISTER_GLOBAL_MOCK_RETURN(STRING_c_str, "a");
     REGISTER_GLOBAL_MOCK_HOOK(STRING_delete, my_STRING_delete);
     
@@ -174,6 +217,12 @@ TEST_SUITE_INITIALIZE(TestSuiteInitialize)
 
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE*, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
 
     REGISTER_TYPE(HTTPAPI_REQUEST_TYPE, HTTPAPI_REQUEST_TYPE);
     REGISTER_TYPE(HTTPAPIEX_RESULT, HTTPAPIEX_RESULT);
@@ -247,6 +296,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_happy_path)
     {
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
             {
                 STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
@@ -272,8 +323,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_happy_path)
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -304,6 +353,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_with_certificates_happy_path)
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
             STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "TrustedCerts", IGNORED_PTR_ARG));
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
             {
                 STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
@@ -329,8 +380,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_with_certificates_happy_path)
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -353,6 +402,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_succeeds_when_HTTP_status_code_is_404)
     {
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
             {
                 STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
@@ -378,8 +429,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_succeeds_when_HTTP_status_code_is_404)
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -402,6 +451,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_HTTPAPIEX_ExecuteRequest_fails)
     {
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
             {
                 STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
@@ -427,8 +478,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_HTTPAPIEX_ExecuteRequest_fails)
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -451,6 +500,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_HTTPHeaders_AddHeaderNameValuePai
     {
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
             {
                 STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
@@ -469,8 +520,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_HTTPHeaders_AddHeaderNameValuePai
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -493,6 +542,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_HTTPHeaders_Alloc_fails)
     {
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1));
             {
                 STRICT_EXPECTED_CALL(HTTPHeaders_Alloc())
@@ -505,8 +556,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_HTTPHeaders_Alloc_fails)
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -529,6 +578,8 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_BUFFER_create_fails)
     {
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create(TEST_HOSTNAME_1));
         {
+            STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+                .IgnoreArgument_ptr();
             STRICT_EXPECTED_CALL(BUFFER_create(&c, 1))
                 .SetReturn(NULL)
                 ;
@@ -536,8 +587,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_fails_when_BUFFER_create_fails)
             STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
                 .IgnoreArgument_handle();
         }
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-            .IgnoreArgument_ptr();
     }
 
     ///act
@@ -633,7 +682,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_SasUri_is_wrong_fails_2)
 /*Tests_SRS_BLOB_02_021: [ For every block of 4MB the following operations shall happen: ]*/
 /*Tests_SRS_BLOB_02_020: [ Blob_UploadFromSasUri shall construct a BASE64 encoded string from the block ID (000000... 049999) ]*/
 /*Tests_SRS_BLOB_02_022: [ Blob_UploadFromSasUri shall construct a new relativePath from following string: base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId" ]*/
-/*Tests_SRS_BLOB_02_023: [ Blob_UploadFromSasUri shall create a BUFFER_HANDLE from source and size parameters. ]*/
+/*Tests_SRS_BLOB_02_023: [ Blob_UploadFromSasUri shall copy every block in a single request BUFFER_HANDLE that is reused for all the blocks and for the block list. ]*/
 /*Tests_SRS_BLOB_02_024: [ Blob_UploadFromSasUri shall call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
 /*Tests_SRS_BLOB_02_025: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
 /*Tests_SRS_BLOB_02_027: [ Otherwise Blob_UploadFromSasUri shall continue execution. ]*/
@@ -672,6 +721,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_happy_path)
             .IgnoreArgument_size();
 
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the one buffer used as content of every request*/
         STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
         /*uploading blocks (Put Block)*/
@@ -696,9 +748,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_happy_path)
                 .IgnoreArgument_s1()
                 .IgnoreArgument_s2();
 
-            STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
+            STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, content + blockNumber * 4 * 1024 * 1024,
                 (blockNumber != (sizes[iSize] - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (sizes[iSize] - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-            )); /*this is the content to be uploaded by this call*/
+            )); /*this is copying the content to be uploaded by this call in the request buffer*/
 
             STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
                 .IgnoreArgument_handle();
@@ -708,8 +760,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_happy_path)
                 .IgnoreArgument_relativePath()
                 .IgnoreArgument_requestContent();
 
-            STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-                .IgnoreArgument_handle();
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
                 .IgnoreArgument_handle();
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
@@ -727,7 +777,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_happy_path)
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
             .IgnoreArgument_handle();
 
-        STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+        STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is copying the XML in the request buffer*/
             .IgnoreAllArguments();
 
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
@@ -749,16 +799,14 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_happy_path)
             .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
             ;
 
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
             .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+            .IgnoreArgument_handle();
+STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
-            .IgnoreArgument_ptr();
 
         ///act
         BLOB_RESULT result = Blob_UploadFromSasUri("https://h.h/something?a=b", content, sizes[iSize], &httpResponse, testValidBufferHandle, NULL);
@@ -806,6 +854,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_with_certificates_happy_path)
 
         STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
         STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "TrustedCerts", IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the one buffer used as content of every request*/
         STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
                                                                                                              /*uploading blocks (Put Block)*/
@@ -830,9 +881,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_with_certificates_happy_path)
                 .IgnoreArgument_s1()
                 .IgnoreArgument_s2();
 
-            STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
+            STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, content + blockNumber * 4 * 1024 * 1024,
                 (blockNumber != (sizes[iSize] - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (sizes[iSize] - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-            )); /*this is the content to be uploaded by this call*/
+            )); /*this is copying the content to be uploaded by this call in the request buffer*/
 
             STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
                 .IgnoreArgument_handle();
@@ -842,8 +893,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_with_certificates_happy_path)
                 .IgnoreArgument_relativePath()
                 .IgnoreArgument_requestContent();
 
-            STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-                .IgnoreArgument_handle();
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
                 .IgnoreArgument_handle();
             STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
@@ -861,7 +910,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_with_certificates_happy_path)
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
             .IgnoreArgument_handle();
 
-        STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+        STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is copying the XML in the request buffer*/
             .IgnoreAllArguments();
 
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
@@ -883,16 +932,14 @@ TEST_FUNCTION(Blob_UploadFromSasUri_various_sizes_with_certificates_happy_path)
             .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
             ;
 
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
             .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+            .IgnoreArgument_handle();
+STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
-            .IgnoreArgument_ptr();
 
         ///act
         BLOB_RESULT result = Blob_UploadFromSasUri("https://h.h/something?a=b", content, sizes[iSize], &httpResponse, testValidBufferHandle, "a");
@@ -913,79 +960,63 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_unhappy_paths)
 
     size_t calls_that_cannot_fail[] =
     {
-        13   ,/*BUFFER_delete*/
-        26   ,/*BUFFER_delete*/
-        39   ,/*BUFFER_delete*/
-        52   ,/*BUFFER_delete*/
-        65   ,/*BUFFER_delete*/
-        78   ,/*BUFFER_delete*/
-        91   ,/*BUFFER_delete*/
-        104  ,/*BUFFER_delete*/
-        117  ,/*BUFFER_delete*/
-        130  ,/*BUFFER_delete*/
-        143  ,/*BUFFER_delete*/
-        156  ,/*BUFFER_delete*/
-        169  ,/*BUFFER_delete*/
-        182  ,/*BUFFER_delete*/
-        195  ,/*BUFFER_delete*/
-        208  ,/*BUFFER_delete*/
-        11   ,/*STRING_c_str*/
-        24   ,/*STRING_c_str*/
-        37   ,/*STRING_c_str*/
-        50   ,/*STRING_c_str*/
-        63   ,/*STRING_c_str*/
-        76   ,/*STRING_c_str*/
-        89   ,/*STRING_c_str*/
-        102  ,/*STRING_c_str*/
-        115  ,/*STRING_c_str*/
-        128  ,/*STRING_c_str*/
-        141  ,/*STRING_c_str*/
-        154  ,/*STRING_c_str*/
-        167  ,/*STRING_c_str*/
-        180  ,/*STRING_c_str*/
-        193  ,/*STRING_c_str*/
-        206  ,/*STRING_c_str*/
-        14   ,/*STRING_delete*/
-        27   ,/*STRING_delete*/
-        40   ,/*STRING_delete*/
-        53   ,/*STRING_delete*/
-        66   ,/*STRING_delete*/
-        79   ,/*STRING_delete*/
-        92   ,/*STRING_delete*/
-        105  ,/*STRING_delete*/
-        118  ,/*STRING_delete*/
-        131  ,/*STRING_delete*/
-        144  ,/*STRING_delete*/
-        157  ,/*STRING_delete*/
-        170  ,/*STRING_delete*/
-        183  ,/*STRING_delete*/
-        196  ,/*STRING_delete*/
-        209  ,/*STRING_delete*/
-        15   ,/*STRING_delete*/
-        28   ,/*STRING_delete*/
-        41   ,/*STRING_delete*/
-        54   ,/*STRING_delete*/
-        67   ,/*STRING_delete*/
-        80   ,/*STRING_delete*/
-        93   ,/*STRING_delete*/
-        106  ,/*STRING_delete*/
-        119  ,/*STRING_delete*/
-        132  ,/*STRING_delete*/
-        145  ,/*STRING_delete*/
-        158  ,/*STRING_delete*/
-        171  ,/*STRING_delete*/
-        184  ,/*STRING_delete*/
-        197  ,/*STRING_delete*/
-        210  ,/*STRING_delete*/
-
-
-        214, /*STRING_c_str*/
-        216, /*STRING_c_str*/
-        218, /*BUFFER_delete*/
-        219, /*STRING_delete*/
-        220, /*STRING_delete*/
-        221, /*HTTPAPIEX_Destroy*/
-        222, /*gballoc_free*/
+        2   ,/*gballoc_free*/
+        13  ,/*STRING_c_str*/
+        25  ,/*STRING_c_str*/
+        37  ,/*STRING_c_str*/
+        49  ,/*STRING_c_str*/
+        61  ,/*STRING_c_str*/
+        73  ,/*STRING_c_str*/
+        85  ,/*STRING_c_str*/
+        97  ,/*STRING_c_str*/
+        109 ,/*STRING_c_str*/
+        121 ,/*STRING_c_str*/
+        133 ,/*STRING_c_str*/
+        145 ,/*STRING_c_str*/
+        157 ,/*STRING_c_str*/
+        169 ,/*STRING_c_str*/
+        181 ,/*STRING_c_str*/
+        193 ,/*STRING_c_str*/
+        15  ,/*STRING_delete*/
+        27  ,/*STRING_delete*/
+        39  ,/*STRING_delete*/
+        51  ,/*STRING_delete*/
+        63  ,/*STRING_delete*/
+        75  ,/*STRING_delete*/
+        87  ,/*STRING_delete*/
+        99  ,/*STRING_delete*/
+        111 ,/*STRING_delete*/
+        123 ,/*STRING_delete*/
+        135 ,/*STRING_delete*/
+        147 ,/*STRING_delete*/
+        159 ,/*STRING_delete*/
+        171 ,/*STRING_delete*/
+        183 ,/*STRING_delete*/
+        195 ,/*STRING_delete*/
+        16  ,/*STRING_delete*/
+        28  ,/*STRING_delete*/
+        40  ,/*STRING_delete*/
+        52  ,/*STRING_delete*/
+        64  ,/*STRING_delete*/
+        76  ,/*STRING_delete*/
+        88  ,/*STRING_delete*/
+        100 ,/*STRING_delete*/
+        112 ,/*STRING_delete*/
+        124 ,/*STRING_delete*/
+        136 ,/*STRING_delete*/
+        148 ,/*STRING_delete*/
+        160 ,/*STRING_delete*/
+        172 ,/*STRING_delete*/
+        184 ,/*STRING_delete*/
+        196 ,/*STRING_delete*/
+
+
+        200, /*STRING_c_str*/
+        202, /*STRING_c_str*/
+        204, /*STRING_delete*/
+        205, /*STRING_delete*/
+        206, /*BUFFER_delete*/
+        207, /*HTTPAPIEX_Destroy*/
     };
 
     (void)umock_c_negative_tests_init();
@@ -1006,13 +1037,16 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_unhappy_paths)
         .IgnoreArgument_size();
 
     STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the one buffer used as content of every request*/
     STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
     /*uploading blocks (Put Block)*/
     for (size_t blockNumber = 0;blockNumber < (size - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
     {
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
-        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*3, 16, 29... (16 numbers)*/
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*5, 17, 29... (16 numbers)*/
             .IgnoreArgument_source();
 
         STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
@@ -1030,11 +1064,11 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_unhappy_paths)
             .IgnoreArgument_s1()
             .IgnoreArgument_s2();
 
-        STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
+        STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, content + blockNumber * 4 * 1024 * 1024,
             (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
+        )); /*this is copying the content to be uploaded by this call in the request buffer*/
 
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*11, 24, 27...*/
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*13, 25, 37...*/
             .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
@@ -1044,16 +1078,14 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_unhappy_paths)
             .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
             ;
 
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/ /*13, 26, 39... (16 numbers)*/
-            .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*14, 27, 40...*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*15, 27, 39...*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*15, 28, 41... 210*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*16, 28, 40... 196*/
             .IgnoreArgument_handle();
     }
 
     /*this part is Put Block list*/
-    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*211*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*197*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
 
@@ -1063,7 +1095,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_unhappy_paths)
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
         .IgnoreArgument_handle();
 
-    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is copying the XML in the request buffer*/
         .IgnoreAllArguments();
 
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
@@ -1085,16 +1117,14 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_unhappy_paths)
         .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
         ;
 
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
-        .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+        .IgnoreArgument_handle();
+STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
-        .IgnoreArgument_ptr();
 
     umock_c_negative_tests_snapshot();
 
@@ -1139,79 +1169,63 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_with_certificate_unhappy_paths)
 
     size_t calls_that_cannot_fail[] =
     {
-        13  + 1 ,/*BUFFER_delete*/
-        26  + 1 ,/*BUFFER_delete*/
-        39  + 1 ,/*BUFFER_delete*/
-        52  + 1 ,/*BUFFER_delete*/
-        65  + 1 ,/*BUFFER_delete*/
-        78  + 1 ,/*BUFFER_delete*/
-        91  + 1 ,/*BUFFER_delete*/
-        104 + 1 ,/*BUFFER_delete*/
-        117 + 1 ,/*BUFFER_delete*/
-        130 + 1 ,/*BUFFER_delete*/
-        143 + 1 ,/*BUFFER_delete*/
-        156 + 1 ,/*BUFFER_delete*/
-        169 + 1 ,/*BUFFER_delete*/
-        182 + 1 ,/*BUFFER_delete*/
-        195 + 1 ,/*BUFFER_delete*/
-        208 + 1 ,/*BUFFER_delete*/
-        11  + 1 ,/*STRING_c_str*/
-        24  + 1 ,/*STRING_c_str*/
-        37  + 1 ,/*STRING_c_str*/
-        50  + 1 ,/*STRING_c_str*/
-        63  + 1 ,/*STRING_c_str*/
-        76  + 1 ,/*STRING_c_str*/
-        89  + 1 ,/*STRING_c_str*/
-        102 + 1 ,/*STRING_c_str*/
-        115 + 1 ,/*STRING_c_str*/
-        128 + 1 ,/*STRING_c_str*/
-        141 + 1 ,/*STRING_c_str*/
-        154 + 1 ,/*STRING_c_str*/
-        167 + 1 ,/*STRING_c_str*/
-        180 + 1 ,/*STRING_c_str*/
-        193 + 1 ,/*STRING_c_str*/
-        206 + 1 ,/*STRING_c_str*/
-        14  + 1 ,/*STRING_delete*/
-        27  + 1 ,/*STRING_delete*/
-        40  + 1 ,/*STRING_delete*/
-        53  + 1 ,/*STRING_delete*/
-        66  + 1 ,/*STRING_delete*/
-        79  + 1 ,/*STRING_delete*/
-        92  + 1 ,/*STRING_delete*/
-        105 + 1 ,/*STRING_delete*/
-        118 + 1 ,/*STRING_delete*/
-        131 + 1 ,/*STRING_delete*/
-        144 + 1 ,/*STRING_delete*/
-        157 + 1 ,/*STRING_delete*/
-        170 + 1 ,/*STRING_delete*/
-        183 + 1 ,/*STRING_delete*/
-        196 + 1 ,/*STRING_delete*/
-        209 + 1 ,/*STRING_delete*/
-        15  + 1 ,/*STRING_delete*/
-        28  + 1 ,/*STRING_delete*/
-        41  + 1 ,/*STRING_delete*/
-        54  + 1 ,/*STRING_delete*/
-        67  + 1 ,/*STRING_delete*/
-        80  + 1 ,/*STRING_delete*/
-        93  + 1 ,/*STRING_delete*/
-        106 + 1 ,/*STRING_delete*/
-        119 + 1 ,/*STRING_delete*/
-        132 + 1 ,/*STRING_delete*/
-        145 + 1 ,/*STRING_delete*/
-        158 + 1 ,/*STRING_delete*/
-        171 + 1 ,/*STRING_delete*/
-        184 + 1 ,/*STRING_delete*/
-        197 + 1 ,/*STRING_delete*/
-        210 + 1 ,/*STRING_delete*/
-
-
-        214+1, /*STRING_c_str*/
-        216+1, /*STRING_c_str*/
-        218+1, /*BUFFER_delete*/
-        219+1, /*STRING_delete*/
-        220+1, /*STRING_delete*/
-        221+1, /*HTTPAPIEX_Destroy*/
-        222+1, /*gballoc_free*/
+        2   + 1,/*gballoc_free*/
+        13  + 1,/*STRING_c_str*/
+        25  + 1,/*STRING_c_str*/
+        37  + 1,/*STRING_c_str*/
+        49  + 1,/*STRING_c_str*/
+        61  + 1,/*STRING_c_str*/
+        73  + 1,/*STRING_c_str*/
+        85  + 1,/*STRING_c_str*/
+        97  + 1,/*STRING_c_str*/
+        109 + 1,/*STRING_c_str*/
+        121 + 1,/*STRING_c_str*/
+        133 + 1,/*STRING_c_str*/
+        145 + 1,/*STRING_c_str*/
+        157 + 1,/*STRING_c_str*/
+        169 + 1,/*STRING_c_str*/
+        181 + 1,/*STRING_c_str*/
+        193 + 1,/*STRING_c_str*/
+        15  + 1,/*STRING_delete*/
+        27  + 1,/*STRING_delete*/
+        39  + 1,/*STRING_delete*/
+        51  + 1,/*STRING_delete*/
+        63  + 1,/*STRING_delete*/
+        75  + 1,/*STRING_delete*/
+        87  + 1,/*STRING_delete*/
+        99  + 1,/*STRING_delete*/
+        111 + 1,/*STRING_delete*/
+        123 + 1,/*STRING_delete*/
+        135 + 1,/*STRING_delete*/
+        147 + 1,/*STRING_delete*/
+        159 + 1,/*STRING_delete*/
+        171 + 1,/*STRING_delete*/
+        183 + 1,/*STRING_delete*/
+        195 + 1,/*STRING_delete*/
+        16  + 1,/*STRING_delete*/
+        28  + 1,/*STRING_delete*/
+        40  + 1,/*STRING_delete*/
+        52  + 1,/*STRING_delete*/
+        64  + 1,/*STRING_delete*/
+        76  + 1,/*STRING_delete*/
+        88  + 1,/*STRING_delete*/
+        100 + 1,/*STRING_delete*/
+        112 + 1,/*STRING_delete*/
+        124 + 1,/*STRING_delete*/
+        136 + 1,/*STRING_delete*/
+        148 + 1,/*STRING_delete*/
+        160 + 1,/*STRING_delete*/
+        172 + 1,/*STRING_delete*/
+        184 + 1,/*STRING_delete*/
+        196 + 1,/*STRING_delete*/
+
+
+        200+1, /*STRING_c_str*/
+        202+1, /*STRING_c_str*/
+        204+1, /*STRING_delete*/
+        205+1, /*STRING_delete*/
+        206+1, /*BUFFER_delete*/
+        207+1, /*HTTPAPIEX_Destroy*/
     };
 
     (void)umock_c_negative_tests_init();
@@ -1233,13 +1247,16 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_with_certificate_unhappy_paths)
 
     STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
     STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "TrustedCerts", IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the one buffer used as content of every request*/
     STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
                                                                                                          /*uploading blocks (Put Block)*/
     for (size_t blockNumber = 0;blockNumber < (size - 1) / (4 * 1024 * 1024) + 1;blockNumber++)
     {
         /*here some sprintf happens and that produces a string in the form: 000000...049999*/
-        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*3, 16, 29... (16 numbers)*/
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/ /*5, 17, 29... (16 numbers)*/
             .IgnoreArgument_source();
 
         STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
@@ -1257,11 +1274,11 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_with_certificate_unhappy_paths)
             .IgnoreArgument_s1()
             .IgnoreArgument_s2();
 
-        STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
+        STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, content + blockNumber * 4 * 1024 * 1024,
             (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
+        )); /*this is copying the content to be uploaded by this call in the request buffer*/
 
-        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*11, 24, 27...*/
+        STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */ /*13, 25, 37...*/
             .IgnoreArgument_handle();
 
         STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
@@ -1271,16 +1288,14 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_with_certificate_unhappy_paths)
             .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
             ;
 
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/ /*13, 26, 39... (16 numbers)*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*15, 27, 39...*/
             .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/ /*14, 27, 40...*/
-            .IgnoreArgument_handle();
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*15, 28, 41... 210*/
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/ /*16, 28, 40... 196*/
             .IgnoreArgument_handle();
     }
 
     /*this part is Put Block list*/
-    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*211*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>")) /*This is closing the XML*/ /*197*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relative path for the Put BLock list*/
 
@@ -1290,7 +1305,7 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_with_certificate_unhappy_paths)
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the XML as const char* so it can be passed to _ExecuteRequest*/
         .IgnoreArgument_handle();
 
-    STRICT_EXPECTED_CALL(BUFFER_create(IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is creating the XML body as BUFFER_HANDLE*/
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_NUM_ARG)) /*this is copying the XML in the request buffer*/
         .IgnoreAllArguments();
 
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path*/
@@ -1312,16 +1327,14 @@ TEST_FUNCTION(Blob_UploadFromSasUri_64MB_with_certificate_unhappy_paths)
         .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred))
         ;
 
-    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*This is the XML as BUFFER_HANDLE*/
-        .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is destroying the relative path for Put Block List*/
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+        .IgnoreArgument_handle();
+STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
-        .IgnoreArgument_ptr();
 
     umock_c_negative_tests_snapshot();
 
@@ -1404,6 +1417,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
         .IgnoreArgument_size();
 
     STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the one buffer used as content of every request*/
     STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
 
     /*uploading blocks (Put Block)*/ /*this simply fails first block*/
@@ -1428,9 +1444,9 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
             .IgnoreArgument_s1()
             .IgnoreArgument_s2();
 
-        STRICT_EXPECTED_CALL(BUFFER_create(content + blockNumber * 4 * 1024 * 1024,
+        STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, content + blockNumber * 4 * 1024 * 1024,
             (blockNumber != (size - 1) / (4 * 1024 * 1024)) ? 4 * 1024 * 1024 : (size - 1) % (4 * 1024 * 1024) + 1 /*condition to take care of "the size of the last block*/
-        )); /*this is the content to be uploaded by this call*/
+        )); /*this is copying the content to be uploaded by this call in the request buffer*/
 
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
             .IgnoreArgument_handle();
@@ -1442,8 +1458,6 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
             .CopyOutArgumentBuffer_statusCode(&FourHundredFour, sizeof(FourHundredFour))
             ;
 
-        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this was the content to be uploaded*/
-            .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
             .IgnoreArgument_handle();
         STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
@@ -1454,10 +1468,10 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
 
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))/*this is the XML string used for Put Block List operation*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+        .IgnoreArgument_handle();
+STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of hte hostname*/
-        .IgnoreArgument_ptr();
 
     ///act
     BLOB_RESULT result = Blob_UploadFromSasUri("https://h.h/something?a=b", content, size, &httpResponse, testValidBufferHandle, NULL);
@@ -1472,4 +1486,579 @@ TEST_FUNCTION(Blob_UploadFromSasUri_when_http_code_is_404_it_immediately_succeed
 }
 
 
+static void setup_Blob_UploadMultipleBlocksFromSasUri_put_block_expectations(const unsigned int* statusCode, HTTPAPIEX_RESULT executeRequestResult)
+{
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
+        .IgnoreArgument_source();
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>")) /*this is building the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is building the XML*/
+        .IgnoreArgument_s1()
+        .IgnoreArgument_s2();
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</Latest>")) /*this is building the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relativePath*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=block&blockid=")) /*this is building the relativePath*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is building the relativePath by adding the blockId (base64 encoded_*/
+        .IgnoreArgument_s1()
+        .IgnoreArgument_s2();
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, testBlock, testBlockSize)); /*the block is copied in the one request buffer*/
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(statusCode, sizeof(*statusCode))
+        .SetReturn(executeRequestResult);
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
+        .IgnoreArgument_handle();
+}
+
+/*Tests_SRS_BLOB_09_001: [ If SASURI is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_SasUri_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri(NULL, testGetDataCallback, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_002: [ If getDataCallback is NULL then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_NULL_getDataCallback_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", NULL, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_004: [ If the hostname cannot be determined, then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_without_hostname_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h", testGetDataCallback, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_003: [ Blob_UploadMultipleBlocksFromSasUri shall copy from SASURI the hostname, the hostname being found between "://" and the next "/". ]*/
+/*Tests_SRS_BLOB_09_005: [ Blob_UploadMultipleBlocksFromSasUri shall create a new HTTPAPI_EX_HANDLE by calling HTTPAPIEX_Create passing the hostname. ]*/
+/*Tests_SRS_BLOB_09_006: [ If certificates is non-NULL then Blob_UploadMultipleBlocksFromSasUri shall pass certificates to HTTPAPI_EX_HANDLE by calling HTTPAPIEX_SetOption with the option name "TrustedCerts". ]*/
+/*Tests_SRS_BLOB_09_007: [ Blob_UploadMultipleBlocksFromSasUri shall create a single BUFFER_HANDLE that is reused as content of every request. ]*/
+/*Tests_SRS_BLOB_09_008: [ Blob_UploadMultipleBlocksFromSasUri shall get the next block by calling getDataCallback with FILE_UPLOAD_OK, the addresses of a data pointer and of a size, and context. ]*/
+/*Tests_SRS_BLOB_09_009: [ When getDataCallback returns a NULL data or a size of 0, Blob_UploadMultipleBlocksFromSasUri shall stop getting blocks and put the block list. ]*/
+/*Tests_SRS_BLOB_09_011: [ For every block Blob_UploadMultipleBlocksFromSasUri shall construct a BASE64 encoded string from the block ID, add it to the XML block list, construct a new relativePath from base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId", copy the block in the request BUFFER_HANDLE and call HTTPAPIEX_ExecuteRequest with a PUT operation, passing httpStatus and httpResponse. ]*/
+/*Tests_SRS_BLOB_09_014: [ Blob_UploadMultipleBlocksFromSasUri shall complete the XML block list, construct a new relativePath from base relativePath + "&comp=blocklist" and call HTTPAPIEX_ExecuteRequest with a PUT operation, passing the new relativePath, httpStatus, httpResponse and the XML block list as content. ]*/
+/*Tests_SRS_BLOB_09_017: [ Otherwise, Blob_UploadMultipleBlocksFromSasUri shall succeed and return BLOB_OK. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_2_blocks_happy_path)
+{
+    ///arrange
+    testBlocksLeft = 2;
+    testBlockSize = sizeof(testBlock);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*this is creating the httpapiex handle to storage (it is always the same host)*/
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "TrustedCerts", IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the one buffer used as content of every request*/
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*this is starting to build the XML used in Put Block List operation*/
+
+    setup_Blob_UploadMultipleBlocksFromSasUri_put_block_expectations(&TwoHundred, HTTPAPIEX_OK);
+    setup_Blob_UploadMultipleBlocksFromSasUri_put_block_expectations(&TwoHundred, HTTPAPIEX_OK);
+
+    /*this part is Put Block list*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>"))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b"));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist"))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)); /*STRING_c_str returns "a"*/
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is the relative path*/
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG)) /*this is the HTTPAPIEX handle*/
+        .IgnoreArgument_handle();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", testGetDataCallback, NULL, &httpResponse, testValidBufferHandle, "certificates");
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(size_t, 0, testBlocksLeft);
+}
+
+/*Tests_SRS_BLOB_09_010: [ If getDataCallback returns a block bigger than 4MB or more than 50000 blocks then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_with_a_block_bigger_than_4MB_fails)
+{
+    ///arrange
+    testBlocksLeft = 1;
+    testBlockSize = 4 * 1024 * 1024 + 1;
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h"));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"));
+
+    /*no Put Block, no Put Block List*/
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", testGetDataCallback, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+}
+
+/*Tests_SRS_BLOB_09_013: [ If the HTTP response code of a block is >=300 then Blob_UploadMultipleBlocksFromSasUri shall stop and return BLOB_OK. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_http_code_is_404_it_immediately_succeeds)
+{
+    ///arrange
+    testBlocksLeft = 2;
+    testBlockSize = sizeof(testBlock);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h"));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"));
+
+    setup_Blob_UploadMultipleBlocksFromSasUri_put_block_expectations(&FourHundredFour, HTTPAPIEX_OK);
+
+    /*notice: no Put Block List because the first block failed with 404*/
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", testGetDataCallback, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 404, httpResponse);
+    ASSERT_ARE_EQUAL(size_t, 1, testBlocksLeft);
+}
+
+/*Tests_SRS_BLOB_09_012: [ If HTTPAPIEX_ExecuteRequest fails then Blob_UploadMultipleBlocksFromSasUri shall fail and return BLOB_HTTP_ERROR. ]*/
+TEST_FUNCTION(Blob_UploadMultipleBlocksFromSasUri_when_put_block_fails_it_fails)
+{
+    ///arrange
+    testBlocksLeft = 2;
+    testBlockSize = sizeof(testBlock);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h"));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>"));
+
+    setup_Blob_UploadMultipleBlocksFromSasUri_put_block_expectations(&TwoHundred, HTTPAPIEX_ERROR);
+
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadMultipleBlocksFromSasUri("https://h.h/something?a=b", testGetDataCallback, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_HTTP_ERROR, result);
+    ASSERT_ARE_EQUAL(size_t, 1, testBlocksLeft);
+}
+
+static const unsigned char testSource[] = { '1', '2', '3', '4', '5' }; /*uploaded as 2 blocks of 3 bytes*/
+
+static void setup_Blob_UploadBlocksFromSasUri_connection_expectations(void)
+{
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a copy of the hostname */
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create("h.h")); /*every connection has its own httpapiex handle*/
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)) /*this is freeing the copy of the hostname*/
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the request buffer of the connection*/
+    STRICT_EXPECTED_CALL(BUFFER_new()); /*this is the response buffer of the connection*/
+}
+
+static void setup_Blob_UploadBlocksFromSasUri_put_block_expectations(const unsigned char* block, size_t blockSize, const unsigned int* statusCode, HTTPAPIEX_RESULT executeRequestResult)
+{
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is taking the next block ID*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6)) /*this is converting the produced blockID string to a base64 representation*/
+        .IgnoreArgument_source();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b")); /*this is building the relativePath*/
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=block&blockid=")) /*this is building the relativePath*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*this is building the relativePath by adding the blockId (base64 encoded_*/
+        .IgnoreArgument_s1()
+        .IgnoreArgument_s2();
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, block, blockSize)); /*the block is copied in the request buffer of the connection*/
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is getting the relative path as const char* */
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .IgnoreArgument_statusCode()
+        .IgnoreArgument_responseContent()
+        .CopyOutArgumentBuffer_statusCode(statusCode, sizeof(*statusCode))
+        .SetReturn(executeRequestResult);
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the relativePath*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is unbuilding the blockID string to a base64 representation*/
+        .IgnoreArgument_handle();
+}
+
+static void setup_Blob_UploadBlocksFromSasUri_put_block_list_expectations(size_t blockCount)
+{
+    size_t i;
+    STRICT_EXPECTED_CALL(STRING_construct("<?xml version=\"1.0\" encoding=\"utf-8\"?>\r\n<BlockList>")); /*the XML is built once all the blocks are uploaded*/
+    for (i = 0; i < blockCount; i++)
+    {
+        STRICT_EXPECTED_CALL(Base64_Encode_Bytes(IGNORED_PTR_ARG, 6))
+            .IgnoreArgument_source();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "<Latest>"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_concat_with_STRING(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_s1()
+            .IgnoreArgument_s2();
+        STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</Latest>"))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+    }
+
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "</BlockList>"))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_construct("/something?a=b"));
+    STRICT_EXPECTED_CALL(STRING_concat(IGNORED_PTR_ARG, "&comp=blocklist"))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is the XML*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_build(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1)); /*STRING_c_str returns "a"*/
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG)) /*this is the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_ExecuteRequest(IGNORED_PTR_ARG, HTTPAPI_REQUEST_PUT, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, &httpResponse, NULL, testValidBufferHandle))
+        .IgnoreArgument_handle()
+        .IgnoreArgument_relativePath()
+        .IgnoreArgument_requestContent()
+        .CopyOutArgumentBuffer_statusCode(&TwoHundred, sizeof(TwoHundred));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is the relative path*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG)) /*this is the XML string used for Put Block List operation*/
+        .IgnoreArgument_handle();
+}
+
+static void setup_Blob_UploadBlocksFromSasUri_cleanup_expectations(void)
+{
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the response buffer*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG)) /*this is the request buffer*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+}
+
+/*Tests_SRS_BLOB_09_018: [ If SASURI or httpStatus is NULL, or source is NULL and size is not zero, then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_with_NULL_SasUri_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri(NULL, testSource, sizeof(testSource), 3, 2, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_018: [ If SASURI or httpStatus is NULL, or source is NULL and size is not zero, then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_with_NULL_source_and_non_zero_size_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", NULL, 1, 3, 2, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_019: [ If blockSize is 0 or bigger than BLOB_BLOCK_SIZE_MAX, concurrency is 0 or size needs more than 50000 blocks then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_with_a_block_size_bigger_than_4MB_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), BLOB_BLOCK_SIZE_MAX + 1, 2, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_019: [ If blockSize is 0 or bigger than BLOB_BLOCK_SIZE_MAX, concurrency is 0 or size needs more than 50000 blocks then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_with_0_concurrency_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 0, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_019: [ If blockSize is 0 or bigger than BLOB_BLOCK_SIZE_MAX, concurrency is 0 or size needs more than 50000 blocks then Blob_UploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_with_more_than_50000_blocks_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, 50001, 1, 2, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_020: [ Blob_UploadBlocksFromSasUri shall create a HTTPAPIEX_HANDLE to the hostname of SASURI, passing certificates, if any, as "TrustedCerts". ]*/
+/*Tests_SRS_BLOB_09_024: [ Every connection shall take the next block ID that has not been taken yet until all the blocks are uploaded or the upload is stopped. ]*/
+/*Tests_SRS_BLOB_09_025: [ For every block Blob_UploadBlocksFromSasUri shall construct a new relativePath from base relativePath + "&comp=block&blockid=BASE64 encoded string of blockId", copy the block in the connection's request BUFFER_HANDLE and call HTTPAPIEX_ExecuteRequest with a PUT operation. ]*/
+/*Tests_SRS_BLOB_09_028: [ Once all the blocks are uploaded, Blob_UploadBlocksFromSasUri shall put the XML block list with the block IDs in order, passing httpStatus and httpResponse, and return BLOB_HTTP_ERROR if HTTPAPIEX_ExecuteRequest fails, BLOB_OK otherwise. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_with_concurrency_1_uploads_from_the_calling_thread)
+{
+    ///arrange
+    setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource, 3, &TwoHundred, HTTPAPIEX_OK);
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource + 3, 2, &TwoHundred, HTTPAPIEX_OK);
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*there is no block left*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_list_expectations(2);
+    setup_Blob_UploadBlocksFromSasUri_cleanup_expectations();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 1, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+}
+
+/*Tests_SRS_BLOB_09_021: [ Blob_UploadBlocksFromSasUri shall start concurrency - 1 threads (at most one per block), the calling thread uploading blocks as well. ]*/
+/*Tests_SRS_BLOB_09_023: [ Every other thread shall create its own HTTPAPIEX_HANDLE (passing certificates, if any, as "TrustedCerts"), request BUFFER_HANDLE and response BUFFER_HANDLE. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_starts_at_most_one_thread_per_block)
+{
+    ///arrange
+    setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is the array of thread handles*/
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)); /*only 1 thread for 2 blocks, even if concurrency is 8*/
+
+    {/*this is the thread, the test hook runs it to completion*/
+        setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+        setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource, 3, &TwoHundred, HTTPAPIEX_OK);
+        setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource + 3, 2, &TwoHundred, HTTPAPIEX_OK);
+        STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+        STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG))
+            .IgnoreArgument_handle();
+    }
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*the calling thread finds no block left*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument_ptr();
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_list_expectations(2);
+    setup_Blob_UploadBlocksFromSasUri_cleanup_expectations();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 8, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+}
+
+/*Tests_SRS_BLOB_09_027: [ If the HTTP response code of a block is >=300 then Blob_UploadBlocksFromSasUri shall stop all the connections and return BLOB_OK with that HTTP status and HTTP response. ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_when_http_code_is_404_it_immediately_succeeds)
+{
+    ///arrange
+    setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource, 3, &FourHundredFour, HTTPAPIEX_OK);
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is stopping the upload*/
+    STRICT_EXPECTED_CALL(BUFFER_u_char(IGNORED_PTR_ARG)) /*the response of the block is copied in httpResponse*/
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_length(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(BUFFER_build(testValidBufferHandle, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    setup_Blob_UploadBlocksFromSasUri_cleanup_expectations();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 1, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 404, httpResponse);
+}
+
+/*Tests_SRS_BLOB_09_026: [ If uploading a block fails then Blob_UploadBlocksFromSasUri shall stop all the connections and return the failure (BLOB_HTTP_ERROR when HTTPAPIEX_ExecuteRequest fails, BLOB_ERROR otherwise). ]*/
+TEST_FUNCTION(Blob_UploadBlocksFromSasUri_when_put_block_fails_it_fails)
+{
+    ///arrange
+    setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource, 3, &TwoHundred, HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is stopping the upload*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    setup_Blob_UploadBlocksFromSasUri_cleanup_expectations();
+
+    ///act
+    BLOB_RESULT result = Blob_UploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 1, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_HTTP_ERROR, result);
+}
+
+/*Tests_SRS_BLOB_09_030: [ If uploadedBlocks is NULL then Blob_ResumeUploadBlocksFromSasUri shall fail and return BLOB_INVALID_ARG. ]*/
+TEST_FUNCTION(Blob_ResumeUploadBlocksFromSasUri_with_NULL_uploadedBlocks_fails)
+{
+    ///arrange
+
+    ///act
+    BLOB_RESULT result = Blob_ResumeUploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 1, NULL, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_BLOB_09_031: [ Otherwise Blob_ResumeUploadBlocksFromSasUri shall behave as Blob_UploadBlocksFromSasUri. ]*/
+/*Tests_SRS_BLOB_09_032: [ Blob_ResumeUploadBlocksFromSasUri shall not upload again the blocks whose uploadedBlocks entry is not 0. ]*/
+/*Tests_SRS_BLOB_09_033: [ Blob_ResumeUploadBlocksFromSasUri shall set to 1 the uploadedBlocks entry of every block that has been uploaded with a HTTP status < 300, even when the upload fails later. ]*/
+TEST_FUNCTION(Blob_ResumeUploadBlocksFromSasUri_skips_the_uploaded_blocks_and_commits_all_of_them)
+{
+    ///arrange
+    unsigned char uploadedBlocks[2] = { 1, 0 };
+
+    setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource + 3, 2, &TwoHundred, HTTPAPIEX_OK); /*block 0 is already in the storage*/
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*there is no block left*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_list_expectations(2);
+    setup_Blob_UploadBlocksFromSasUri_cleanup_expectations();
+
+    ///act
+    BLOB_RESULT result = Blob_ResumeUploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 1, uploadedBlocks, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_OK, result);
+    ASSERT_ARE_EQUAL(int, 200, httpResponse);
+    ASSERT_ARE_EQUAL(int, 1, uploadedBlocks[0]);
+    ASSERT_ARE_EQUAL(int, 1, uploadedBlocks[1]);
+}
+
+/*Tests_SRS_BLOB_09_033: [ Blob_ResumeUploadBlocksFromSasUri shall set to 1 the uploadedBlocks entry of every block that has been uploaded with a HTTP status < 300, even when the upload fails later. ]*/
+TEST_FUNCTION(Blob_ResumeUploadBlocksFromSasUri_when_put_block_fails_remembers_the_blocks_uploaded_before)
+{
+    ///arrange
+    unsigned char uploadedBlocks[2] = { 0, 0 };
+
+    setup_Blob_UploadBlocksFromSasUri_connection_expectations();
+    STRICT_EXPECTED_CALL(Lock_Init());
+
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource, 3, &TwoHundred, HTTPAPIEX_OK);
+    setup_Blob_UploadBlocksFromSasUri_put_block_expectations(testSource + 3, 2, &TwoHundred, HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is stopping the upload*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    setup_Blob_UploadBlocksFromSasUri_cleanup_expectations();
+
+    ///act
+    BLOB_RESULT result = Blob_ResumeUploadBlocksFromSasUri("https://h.h/something?a=b", testSource, sizeof(testSource), 3, 1, uploadedBlocks, &httpResponse, testValidBufferHandle, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(BLOB_RESULT, BLOB_HTTP_ERROR, result);
+    ASSERT_ARE_EQUAL(int, 1, uploadedBlocks[0]);
+    ASSERT_ARE_EQUAL(int, 0, uploadedBlocks[1]);
+}
+
 END_TEST_SUITE(blob_ut);
@@ -61,12 +61,14 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
     return 0;
 }
 
+static size_t g_sas_token_expiry;
+
 static STRING_HANDLE my_SASToken_CreateString(const char* key, const char* scope, const char* keyName, size_t expiry)
 {
     (void)key;
     (void)scope;
     (void)keyName;
-    (void)expiry;
+    g_sas_token_expiry = expiry;
     return (STRING_HANDLE)my_gballoc_malloc(1);
 }
 
@@ -167,9 +169,9 @@ static void setup_IoTHubClient_Auth_Get_ConnString_mocks()
     STRICT_EXPECTED_CALL(get_time(NULL));
     STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, SCOPE_NAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
     STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 }
 
 static int should_skip_index(size_t current_index, const size_t skip_array[], size_t length)
@@ -513,7 +515,7 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 1, 3, 5 };
+    size_t calls_cannot_fail[] = { 1, 4 };
 
     //act
     size_t count = umock_c_negative_tests_call_count();
@@ -541,6 +543,336 @@ TEST_FUNCTION(IoTHubClient_Auth_Get_ConnString_fail)
     umock_c_negative_tests_deinit();
 }
 
+/* Tests_SRS_IoTHub_Authorization_09_001: [ if handle or scope are NULL, IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_handle_NULL_fail)
+{
+    //arrange
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(NULL, SCOPE_NAME, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_IS_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_002: [ If the device_sas_token is NOT NULL IoTHubClient_Auth_Get_Cached_SasToken shall return the device_sas_token. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_device_sas_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(NULL, DEVICE_ID, TEST_SAS_TOKEN);
+    umock_c_reset_all_calls();
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, NULL, 0);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_SAS_TOKEN, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_004: [ Otherwise IoTHubClient_Auth_Get_Cached_SasToken shall call SASToken_CreateString with an expiry of the current time plus expire_time, and cache the sas token with its scope and expiry. ] */
+/* Tests_SRS_IoTHub_Authorization_09_005: [ The sas token returned by IoTHubClient_Auth_Get_Cached_SasToken shall be owned by handle and stay valid until the next call to IoTHubClient_Auth_Get_Cached_SasToken or IoTHubClient_Auth_Destroy. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_creates_the_sas_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(1000);
+    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, SCOPE_NAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 3600);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1000 + 3600, g_sas_token_expiry);
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_004: [ Otherwise IoTHubClient_Auth_Get_Cached_SasToken shall call SASToken_CreateString with an expiry of the current time plus expire_time, and cache the sas token with its scope and expiry. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_keeps_the_lifetime_asked_for)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 86400);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 86400, g_sas_token_expiry);
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_003: [ If the cached sas token was created for the same scope and expires no sooner than the current time plus expire_time minus a tenth of expire_time (at most 10 minutes), IoTHubClient_Auth_Get_Cached_SasToken shall return it without creating a new one. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_reuses_the_cached_sas_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, TEST_STRING_VALUE, sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_003: [ If the cached sas token was created for the same scope and expires no sooner than the current time plus expire_time minus a tenth of expire_time (at most 10 minutes), IoTHubClient_Auth_Get_Cached_SasToken shall return it without creating a new one. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_other_scope_creates_a_new_sas_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, "other_scope", IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, "other_scope"));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, "other_scope", TEST_EXPIRY_TIME);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_003: [ If the cached sas token was created for the same scope and expires no sooner than the current time plus expire_time minus a tenth of expire_time (at most 10 minutes), IoTHubClient_Auth_Get_Cached_SasToken shall return it without creating a new one. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_reuses_the_cached_sas_token_for_at_most_10_minutes)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 86400);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG)).SetReturn(600);
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, 86400);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_003: [ If the cached sas token was created for the same scope and expires no sooner than the current time plus expire_time minus a tenth of expire_time (at most 10 minutes), IoTHubClient_Auth_Get_Cached_SasToken shall return it without creating a new one. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_longer_expiry_creates_a_new_sas_token_succeed)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    (void)IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, SCOPE_NAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+    STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+
+    //act
+    const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME + 11);
+
+    //assert
+    ASSERT_IS_NOT_NULL(sas_token);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_006: [ If any error is encountered IoTHubClient_Auth_Get_Cached_SasToken shall return NULL. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_Cached_SasToken_fail)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    STRICT_EXPECTED_CALL(get_difftime(IGNORED_NUM_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(SASToken_CreateString(IGNORED_PTR_ARG, SCOPE_NAME, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, SCOPE_NAME));
+
+    umock_c_negative_tests_snapshot();
+
+    size_t calls_cannot_fail[] = { 1 };
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail) / sizeof(calls_cannot_fail[0])) != 0)
+        {
+            continue;
+        }
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "IoTHubClient_Auth_Get_Cached_SasToken failure in test %zu/%zu", index, count);
+
+        //act
+        const char* sas_token = IoTHubClient_Auth_Get_Cached_SasToken(handle, SCOPE_NAME, TEST_EXPIRY_TIME);
+
+        //assert
+        ASSERT_IS_NULL_WITH_MSG(sas_token, tmp_msg);
+    }
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_008: [ if handle is NULL, IoTHubClient_Auth_Get_SasToken_Refresh_Time shall return refresh_time. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_Refresh_Time_handle_NULL)
+{
+    //arrange
+
+    //act
+    size_t refresh_time = IoTHubClient_Auth_Get_SasToken_Refresh_Time(NULL, 1800);
+
+    //assert
+    ASSERT_ARE_EQUAL(size_t, 1800, refresh_time);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_009: [ IoTHubClient_Auth_Get_SasToken_Refresh_Time shall return refresh_time minus a random part of a tenth of refresh_time (at most 10 minutes). ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_Refresh_Time_brings_the_refresh_forward_by_at_most_a_tenth)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    for (size_t i = 0; i < 100; i++)
+    {
+        size_t refresh_time = IoTHubClient_Auth_Get_SasToken_Refresh_Time(handle, 1800);
+
+        //assert
+        ASSERT_IS_TRUE(refresh_time <= 1800);
+        ASSERT_IS_TRUE(refresh_time >= 1800 - 180);
+    }
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_009: [ IoTHubClient_Auth_Get_SasToken_Refresh_Time shall return refresh_time minus a random part of a tenth of refresh_time (at most 10 minutes). ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_Refresh_Time_brings_the_refresh_forward_by_at_most_10_minutes)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    //act
+    for (size_t i = 0; i < 100; i++)
+    {
+        size_t refresh_time = IoTHubClient_Auth_Get_SasToken_Refresh_Time(handle, 86400);
+
+        //assert
+        ASSERT_IS_TRUE(refresh_time >= 86400 - 600);
+    }
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_010: [ The random part shall come from a generator of the handle, seeded on the first call from get_time and the handle. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_Refresh_Time_seeds_the_handle_once)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handle = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(get_time(NULL));
+
+    //act
+    (void)IoTHubClient_Auth_Get_SasToken_Refresh_Time(handle, 1800);
+    (void)IoTHubClient_Auth_Get_SasToken_Refresh_Time(handle, 1800);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_Auth_Destroy(handle);
+}
+
+/* Tests_SRS_IoTHub_Authorization_09_010: [ The random part shall come from a generator of the handle, seeded on the first call from get_time and the handle. ] */
+TEST_FUNCTION(IoTHubClient_Auth_Get_SasToken_Refresh_Time_differs_between_handles)
+{
+    //arrange
+    IOTHUB_AUTHORIZATION_HANDLE handles[8];
+    size_t first_refresh_time;
+    bool is_spread = false;
+    for (size_t i = 0; i < sizeof(handles) / sizeof(handles[0]); i++)
+    {
+        handles[i] = IoTHubClient_Auth_Create(DEVICE_KEY, DEVICE_ID, NULL);
+    }
+    umock_c_reset_all_calls();
+
+    //act
+    first_refresh_time = IoTHubClient_Auth_Get_SasToken_Refresh_Time(handles[0], 1800);
+    for (size_t i = 1; i < sizeof(handles) / sizeof(handles[0]); i++)
+    {
+        if (IoTHubClient_Auth_Get_SasToken_Refresh_Time(handles[i], 1800) != first_refresh_time)
+        {
+            is_spread = true;
+        }
+    }
+
+    //assert
+    ASSERT_IS_TRUE(is_spread);
+
+    //cleanup
+    for (size_t i = 0; i < sizeof(handles) / sizeof(handles[0]); i++)
+    {
+        IoTHubClient_Auth_Destroy(handles[i]);
+    }
+}
+
 /* Codes_SRS_IoTHub_Authorization_07_013: [ if handle is NULL, IoTHubClient_Auth_Get_DeviceId shall return NULL. ] */
 TEST_FUNCTION(IoTHubClient_Auth_Get_DeviceId_handle_NULL)
 {
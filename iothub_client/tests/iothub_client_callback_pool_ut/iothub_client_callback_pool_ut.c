@@ -0,0 +1,506 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdbool>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+void* real_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void real_free(void* ptr)
+{
+	free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "umocktypes.h"
+#include "umocktypes_c.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
+#include "azure_c_shared_utility/threadapi.h"
+
+MOCKABLE_FUNCTION(, void, test_work, void*, context);
+#undef ENABLE_MOCKS
+
+#include "iothub_client_callback_pool.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+
+// Data definitions
+
+#define TEST_LOCK_HANDLE                    (LOCK_HANDLE)0x4440
+#define TEST_COND_HANDLE                    (COND_HANDLE)0x4441
+#define TEST_THREAD_HANDLE                  (THREAD_HANDLE)0x4442
+#define TEST_WORK_1                         (void*)0x4443
+#define TEST_WORK_2                         (void*)0x4444
+#define TEST_WORK_3                         (void*)0x4445
+#define TEST_THREAD_COUNT                   2
+
+static THREAD_START_FUNC g_thread_func;
+static void* g_thread_func_arg;
+
+
+// Helpers
+
+static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_START_FUNC func, void* arg)
+{
+	*threadHandle = TEST_THREAD_HANDLE;
+	g_thread_func = func;
+	g_thread_func_arg = arg;
+	return THREADAPI_OK;
+}
+
+// The pool threads are run by the test when they are joined, so they find their pool already shut down and exit once the posted work is done.
+static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int* res)
+{
+	(void)threadHandle;
+	*res = g_thread_func(g_thread_func_arg);
+	return THREADAPI_OK;
+}
+
+static void register_global_mock_hooks()
+{
+	REGISTER_GLOBAL_MOCK_HOOK(malloc, real_malloc);
+	REGISTER_GLOBAL_MOCK_HOOK(free, real_free);
+	REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
+	REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Join, my_ThreadAPI_Join);
+}
+
+static void register_global_mock_returns()
+{
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(malloc, NULL);
+	REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, TEST_LOCK_HANDLE);
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+	REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock, LOCK_ERROR);
+	REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+	REGISTER_GLOBAL_MOCK_RETURN(Condition_Init, TEST_COND_HANDLE);
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(Condition_Init, NULL);
+	REGISTER_GLOBAL_MOCK_RETURN(Condition_Post, COND_OK);
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Create, THREADAPI_ERROR);
+}
+
+static void register_umock_alias_types()
+{
+	REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+	REGISTER_UMOCK_ALIAS_TYPE(LOCK_RESULT, int);
+	REGISTER_UMOCK_ALIAS_TYPE(COND_HANDLE, void*);
+	REGISTER_UMOCK_ALIAS_TYPE(COND_RESULT, int);
+	REGISTER_UMOCK_ALIAS_TYPE(THREAD_HANDLE, void*);
+	REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
+	REGISTER_UMOCK_ALIAS_TYPE(THREADAPI_RESULT, int);
+}
+
+static void set_expected_calls_for_create(size_t thread_count)
+{
+	size_t i;
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	STRICT_EXPECTED_CALL(Lock_Init());
+	STRICT_EXPECTED_CALL(Condition_Init());
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+
+	for (i = 0; i < thread_count; i++)
+	{
+		STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+	}
+}
+
+static void set_expected_calls_for_shutdown(size_t thread_count)
+{
+	size_t i;
+
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+	for (i = 0; i < thread_count; i++)
+	{
+		STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+	}
+
+	for (i = 0; i < thread_count; i++)
+	{
+		// Each thread finds no work left and exits.
+		STRICT_EXPECTED_CALL(ThreadAPI_Join(TEST_THREAD_HANDLE, IGNORED_PTR_ARG));
+		STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+		STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+	}
+}
+
+static void set_expected_calls_for_free_pool()
+{
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(Condition_Deinit(TEST_COND_HANDLE));
+	STRICT_EXPECTED_CALL(Lock_Deinit(TEST_LOCK_HANDLE));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+}
+
+static CALLBACK_POOL_HANDLE create_pool(size_t thread_count)
+{
+	umock_c_reset_all_calls();
+	CALLBACK_POOL_HANDLE handle = callback_pool_create(thread_count);
+	ASSERT_IS_NOT_NULL(handle);
+	umock_c_reset_all_calls();
+
+	return handle;
+}
+
+
+BEGIN_TEST_SUITE(iothub_client_callback_pool_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+	int result = umocktypes_charptr_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+	result = umocktypes_stdint_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+	result = umocktypes_bool_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+
+	register_umock_alias_types();
+	register_global_mock_returns();
+	register_global_mock_hooks();
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+	umock_c_negative_tests_deinit();
+
+	g_thread_func = NULL;
+	g_thread_func_arg = NULL;
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_001: [If `thread_count` is 0, `callback_pool_create` shall return NULL]
+TEST_FUNCTION(create_thread_count_0_fails)
+{
+	// arrange
+	umock_c_reset_all_calls();
+
+	// act
+	CALLBACK_POOL_HANDLE handle = callback_pool_create(0);
+
+	// assert
+	ASSERT_IS_NULL(handle);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_002: [`callback_pool_create` shall allocate the pool, create its lock and condition and start `thread_count` threads]
+TEST_FUNCTION(create_success)
+{
+	// arrange
+	umock_c_reset_all_calls();
+	set_expected_calls_for_create(TEST_THREAD_COUNT);
+
+	// act
+	CALLBACK_POOL_HANDLE handle = callback_pool_create(TEST_THREAD_COUNT);
+
+	// assert
+	ASSERT_IS_NOT_NULL(handle);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	callback_pool_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+TEST_FUNCTION(create_failure_checks)
+{
+	// arrange
+	ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+
+	set_expected_calls_for_create(TEST_THREAD_COUNT);
+	umock_c_negative_tests_snapshot();
+
+	// act
+	size_t i;
+	for (i = 0; i < umock_c_negative_tests_call_count(); i++)
+	{
+		umock_c_negative_tests_reset();
+		umock_c_negative_tests_fail_call(i);
+
+		CALLBACK_POOL_HANDLE handle = callback_pool_create(TEST_THREAD_COUNT);
+
+		// assert
+		ASSERT_IS_NULL_WITH_MSG(handle, "callback_pool_create did not fail as expected");
+	}
+
+	// cleanup
+	umock_c_negative_tests_deinit();
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_003: [If any of these steps fails, `callback_pool_create` shall stop the threads already started, free what it allocated and return NULL]
+TEST_FUNCTION(create_second_thread_fails_joins_first)
+{
+	// arrange
+	umock_c_reset_all_calls();
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	STRICT_EXPECTED_CALL(Lock_Init());
+	STRICT_EXPECTED_CALL(Condition_Init());
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+		.SetReturn(THREADAPI_ERROR);
+	set_expected_calls_for_shutdown(1);
+	set_expected_calls_for_free_pool();
+
+	// act
+	CALLBACK_POOL_HANDLE handle = callback_pool_create(TEST_THREAD_COUNT);
+
+	// assert
+	ASSERT_IS_NULL(handle);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_004: [If `pool` or `work` are NULL, `callback_pool_post` shall fail and return non-zero]
+TEST_FUNCTION(post_NULL_arguments)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(1);
+
+	// act
+	int result1 = callback_pool_post(NULL, test_work, TEST_WORK_1, true);
+	int result2 = callback_pool_post(handle, NULL, TEST_WORK_1, true);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+	ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	callback_pool_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_007: [`callback_pool_post` shall queue the item as ordered or unordered work according to `ordered`, signal the pool condition and return 0]
+TEST_FUNCTION(post_success)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(1);
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+	// act
+	int result = callback_pool_post(handle, test_work, TEST_WORK_1, true);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	callback_pool_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_005: [`callback_pool_post` shall allocate an item holding `work` and `context`; if that fails it shall return non-zero]
+TEST_FUNCTION(post_failure_checks)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(1);
+
+	ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	umock_c_negative_tests_snapshot();
+
+	// act
+	size_t i;
+	for (i = 0; i < umock_c_negative_tests_call_count(); i++)
+	{
+		umock_c_negative_tests_reset();
+		umock_c_negative_tests_fail_call(i);
+
+		int result = callback_pool_post(handle, test_work, TEST_WORK_1, true);
+
+		// assert
+		ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, "callback_pool_post did not fail as expected");
+	}
+
+	// cleanup
+	umock_c_negative_tests_deinit();
+	umock_c_reset_all_calls();
+	callback_pool_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_006: [If the pool is being shut down, `callback_pool_post` shall free the item and return non-zero]
+TEST_FUNCTION(post_after_shutdown_fails)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(1);
+	callback_pool_shutdown(handle);
+	umock_c_reset_all_calls();
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+	// act
+	int result = callback_pool_post(handle, test_work, TEST_WORK_1, false);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	callback_pool_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_008: [Each thread shall run posted work until the pool is shut down and no work is left]
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_009: [Ordered work shall run one item at a time, in the order it was posted; unordered work shall run on any free thread]
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_011: [`callback_pool_shutdown` shall stop accepting work, let the threads run all the work already posted and join them; once the pool is shut down it shall do nothing]
+TEST_FUNCTION(shutdown_runs_posted_work)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(1);
+	ASSERT_ARE_EQUAL(int, 0, callback_pool_post(handle, test_work, TEST_WORK_1, true));
+	ASSERT_ARE_EQUAL(int, 0, callback_pool_post(handle, test_work, TEST_WORK_2, false));
+	ASSERT_ARE_EQUAL(int, 0, callback_pool_post(handle, test_work, TEST_WORK_3, true));
+	umock_c_reset_all_calls();
+
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+	STRICT_EXPECTED_CALL(ThreadAPI_Join(TEST_THREAD_HANDLE, IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(test_work(TEST_WORK_1));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(test_work(TEST_WORK_3));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(test_work(TEST_WORK_2));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(Lock(TEST_LOCK_HANDLE));
+	STRICT_EXPECTED_CALL(Unlock(TEST_LOCK_HANDLE));
+
+	// act
+	callback_pool_shutdown(handle);
+	callback_pool_shutdown(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	callback_pool_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_010: [If `pool` is NULL, `callback_pool_shutdown` shall return]
+TEST_FUNCTION(shutdown_NULL_handle)
+{
+	// arrange
+	umock_c_reset_all_calls();
+
+	// act
+	callback_pool_shutdown(NULL);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_012: [If `pool` is NULL, `callback_pool_destroy` shall return]
+TEST_FUNCTION(destroy_NULL_handle)
+{
+	// arrange
+	umock_c_reset_all_calls();
+
+	// act
+	callback_pool_destroy(NULL);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_013: [`callback_pool_destroy` shall shut the pool down if that was not done yet, then free its threads, condition, lock and the pool itself]
+TEST_FUNCTION(destroy_success)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(TEST_THREAD_COUNT);
+
+	set_expected_calls_for_shutdown(TEST_THREAD_COUNT);
+	set_expected_calls_for_free_pool();
+
+	// act
+	callback_pool_destroy(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_CALLBACK_POOL_09_013: [`callback_pool_destroy` shall shut the pool down if that was not done yet, then free its threads, condition, lock and the pool itself]
+TEST_FUNCTION(destroy_after_shutdown)
+{
+	// arrange
+	CALLBACK_POOL_HANDLE handle = create_pool(TEST_THREAD_COUNT);
+	callback_pool_shutdown(handle);
+	umock_c_reset_all_calls();
+
+	set_expected_calls_for_free_pool();
+
+	// act
+	callback_pool_destroy(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+END_TEST_SUITE(iothub_client_callback_pool_ut)
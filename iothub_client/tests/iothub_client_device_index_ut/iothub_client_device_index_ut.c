@@ -0,0 +1,562 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdbool>
+#include <cstdint>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#endif
+
+void* real_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void real_free(void* ptr)
+{
+	free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "umocktypes.h"
+#include "umocktypes_c.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+#undef ENABLE_MOCKS
+
+#include "iothub_client_device_index.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+
+// Data definitions
+
+#define TEST_DEVICE_ID_1                    "device1"
+#define TEST_DEVICE_ID_2                    "device2"
+#define TEST_DEVICE_1                       (void*)0x4441
+#define TEST_DEVICE_2                       (void*)0x4442
+#define TEST_INITIAL_BUCKET_COUNT           16
+#define TEST_MANY_DEVICES_COUNT             10000
+
+
+// Helpers
+
+static void* get_test_device(int index)
+{
+	return (void*)(uintptr_t)(0x10000 + index * 16);
+}
+
+static void get_test_device_id(int index, char* buffer, size_t buffer_size)
+{
+	(void)snprintf(buffer, buffer_size, "device-%d", index);
+}
+
+static void register_global_mock_hooks()
+{
+	REGISTER_GLOBAL_MOCK_HOOK(malloc, real_malloc);
+	REGISTER_GLOBAL_MOCK_HOOK(free, real_free);
+}
+
+static void register_global_mock_returns()
+{
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(malloc, NULL);
+}
+
+static DEVICE_INDEX_HANDLE create_device_index()
+{
+	umock_c_reset_all_calls();
+	DEVICE_INDEX_HANDLE handle = device_index_create();
+	ASSERT_IS_NOT_NULL(handle);
+	umock_c_reset_all_calls();
+
+	return handle;
+}
+
+static void add_devices(DEVICE_INDEX_HANDLE handle, int device_count)
+{
+	char device_id[32];
+	int i;
+
+	for (i = 0; i < device_count; i++)
+	{
+		get_test_device_id(i, device_id, sizeof(device_id));
+		ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, device_id, get_test_device(i)));
+	}
+
+	umock_c_reset_all_calls();
+}
+
+
+BEGIN_TEST_SUITE(iothub_client_device_index_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+	int result = umocktypes_charptr_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+	result = umocktypes_stdint_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+	result = umocktypes_bool_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+
+	register_global_mock_returns();
+	register_global_mock_hooks();
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+	umock_c_negative_tests_deinit();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_001: [`device_index_create` shall allocate memory for the index and its buckets]
+TEST_FUNCTION(create_success)
+{
+	// arrange
+	umock_c_reset_all_calls();
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(TEST_INITIAL_BUCKET_COUNT * sizeof(void*)));
+	EXPECTED_CALL(malloc(TEST_INITIAL_BUCKET_COUNT * sizeof(void*)));
+
+	// act
+	DEVICE_INDEX_HANDLE handle = device_index_create();
+
+	// assert
+	ASSERT_IS_NOT_NULL(handle);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_002: [If any allocation fails, `device_index_create` shall free what it allocated and return NULL]
+TEST_FUNCTION(create_failure_checks)
+{
+	// arrange
+	ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+
+	umock_c_reset_all_calls();
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	umock_c_negative_tests_snapshot();
+
+	size_t i;
+	for (i = 0; i < umock_c_negative_tests_call_count(); i++)
+	{
+		// arrange
+		char error_msg[64];
+
+		umock_c_negative_tests_reset();
+		umock_c_negative_tests_fail_call(i);
+
+		// act
+		DEVICE_INDEX_HANDLE handle = device_index_create();
+
+		// assert
+		sprintf(error_msg, "On failed call %zu", i);
+		ASSERT_IS_NULL_WITH_MSG(handle, error_msg);
+	}
+
+	// cleanup
+	umock_c_negative_tests_deinit();
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_003: [If `device_index`, `device_id` or `device` are NULL, `device_index_add` shall fail and return non-zero]
+TEST_FUNCTION(add_NULL_arguments)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+
+	// act
+	int result1 = device_index_add(NULL, TEST_DEVICE_ID_1, TEST_DEVICE_1);
+	int result2 = device_index_add(handle, NULL, TEST_DEVICE_1);
+	int result3 = device_index_add(handle, TEST_DEVICE_ID_1, NULL);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+	ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+	ASSERT_ARE_NOT_EQUAL(int, 0, result3);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_005: [`device_index_add` shall allocate an entry holding `device` and a copy of `device_id`]
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_009: [If no failures occur, `device_index_add` shall return 0]
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_015: [`device_index_find_by_id` shall return the device added with `device_id`, or NULL if there is none]
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_017: [`device_index_contains` shall return true if `device` is in the index, false otherwise]
+TEST_FUNCTION(add_success)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(sizeof(TEST_DEVICE_ID_1)));
+
+	// act
+	int result = device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(void_ptr, TEST_DEVICE_1, device_index_find_by_id(handle, TEST_DEVICE_ID_1));
+	ASSERT_IS_NULL(device_index_find_by_id(handle, TEST_DEVICE_ID_2));
+	ASSERT_IS_TRUE(device_index_contains(handle, TEST_DEVICE_1));
+	ASSERT_IS_FALSE(device_index_contains(handle, TEST_DEVICE_2));
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_004: [If `device_id` or `device` are already in the index, `device_index_add` shall fail and return non-zero]
+TEST_FUNCTION(add_device_already_indexed)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1));
+	umock_c_reset_all_calls();
+
+	// act
+	int result1 = device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_2);
+	int result2 = device_index_add(handle, TEST_DEVICE_ID_2, TEST_DEVICE_1);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+	ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(void_ptr, TEST_DEVICE_1, device_index_find_by_id(handle, TEST_DEVICE_ID_1));
+	ASSERT_IS_NULL(device_index_find_by_id(handle, TEST_DEVICE_ID_2));
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_006: [If any allocation fails, `device_index_add` shall fail and return non-zero]
+TEST_FUNCTION(add_failure_checks)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+
+	ASSERT_ARE_EQUAL(int, 0, umock_c_negative_tests_init());
+
+	umock_c_reset_all_calls();
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	umock_c_negative_tests_snapshot();
+
+	size_t i;
+	for (i = 0; i < umock_c_negative_tests_call_count(); i++)
+	{
+		// arrange
+		char error_msg[64];
+
+		umock_c_negative_tests_reset();
+		umock_c_negative_tests_fail_call(i);
+
+		// act
+		int result = device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1);
+
+		// assert
+		sprintf(error_msg, "On failed call %zu", i);
+		ASSERT_ARE_NOT_EQUAL_WITH_MSG(int, 0, result, error_msg);
+		ASSERT_IS_NULL_WITH_MSG(device_index_find_by_id(handle, TEST_DEVICE_ID_1), error_msg);
+	}
+
+	// cleanup
+	umock_c_negative_tests_deinit();
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_007: [If the index would become more than 3/4 full, its buckets shall be doubled before the entry is added]
+TEST_FUNCTION(add_grows_buckets)
+{
+	// arrange
+	char device_id[32];
+	int i;
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	add_devices(handle, TEST_INITIAL_BUCKET_COUNT / 4 * 3);
+
+	get_test_device_id(TEST_INITIAL_BUCKET_COUNT, device_id, sizeof(device_id));
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(TEST_INITIAL_BUCKET_COUNT * 2 * sizeof(void*)));
+	EXPECTED_CALL(malloc(TEST_INITIAL_BUCKET_COUNT * 2 * sizeof(void*)));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+	// act
+	int result = device_index_add(handle, device_id, get_test_device(TEST_INITIAL_BUCKET_COUNT));
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	for (i = 0; i < TEST_INITIAL_BUCKET_COUNT / 4 * 3; i++)
+	{
+		get_test_device_id(i, device_id, sizeof(device_id));
+		ASSERT_ARE_EQUAL(void_ptr, get_test_device(i), device_index_find_by_id(handle, device_id));
+		ASSERT_IS_TRUE(device_index_contains(handle, get_test_device(i)));
+	}
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_008: [If growing the buckets fails, the entry shall still be added to the current buckets]
+TEST_FUNCTION(add_grow_buckets_fails)
+{
+	// arrange
+	char device_id[32];
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	add_devices(handle, TEST_INITIAL_BUCKET_COUNT / 4 * 3);
+
+	get_test_device_id(TEST_INITIAL_BUCKET_COUNT, device_id, sizeof(device_id));
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(TEST_INITIAL_BUCKET_COUNT * 2 * sizeof(void*)))
+		.SetReturn(NULL);
+
+	// act
+	int result = device_index_add(handle, device_id, get_test_device(TEST_INITIAL_BUCKET_COUNT));
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(void_ptr, get_test_device(TEST_INITIAL_BUCKET_COUNT), device_index_find_by_id(handle, device_id));
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_010: [If `device_index` or `device` are NULL, `device_index_remove` shall fail and return non-zero]
+TEST_FUNCTION(remove_NULL_arguments)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+
+	// act
+	int result1 = device_index_remove(NULL, TEST_DEVICE_1);
+	int result2 = device_index_remove(handle, NULL);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+	ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_011: [If `device` is not in the index, `device_index_remove` shall fail and return non-zero]
+TEST_FUNCTION(remove_device_not_indexed)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1));
+	umock_c_reset_all_calls();
+
+	// act
+	int result = device_index_remove(handle, TEST_DEVICE_2);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_IS_TRUE(device_index_contains(handle, TEST_DEVICE_1));
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_012: [`device_index_remove` shall unlink the entry of `device` from the index and free it]
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_013: [If no failures occur, `device_index_remove` shall return 0]
+TEST_FUNCTION(remove_success)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1));
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_2, TEST_DEVICE_2));
+	umock_c_reset_all_calls();
+
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+	// act
+	int result = device_index_remove(handle, TEST_DEVICE_1);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_IS_NULL(device_index_find_by_id(handle, TEST_DEVICE_ID_1));
+	ASSERT_IS_FALSE(device_index_contains(handle, TEST_DEVICE_1));
+	ASSERT_ARE_EQUAL(void_ptr, TEST_DEVICE_2, device_index_find_by_id(handle, TEST_DEVICE_ID_2));
+	ASSERT_IS_TRUE(device_index_contains(handle, TEST_DEVICE_2));
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_014: [If `device_index` or `device_id` are NULL, `device_index_find_by_id` shall return NULL]
+TEST_FUNCTION(find_by_id_NULL_arguments)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1));
+	umock_c_reset_all_calls();
+
+	// act
+	void* result1 = device_index_find_by_id(NULL, TEST_DEVICE_ID_1);
+	void* result2 = device_index_find_by_id(handle, NULL);
+
+	// assert
+	ASSERT_IS_NULL(result1);
+	ASSERT_IS_NULL(result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_016: [If `device_index` or `device` are NULL, `device_index_contains` shall return false]
+TEST_FUNCTION(contains_NULL_arguments)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1));
+	umock_c_reset_all_calls();
+
+	// act
+	bool result1 = device_index_contains(NULL, TEST_DEVICE_1);
+	bool result2 = device_index_contains(handle, NULL);
+
+	// assert
+	ASSERT_IS_FALSE(result1);
+	ASSERT_IS_FALSE(result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_018: [If `device_index` is NULL, `device_index_destroy` shall return]
+TEST_FUNCTION(destroy_NULL_handle)
+{
+	// arrange
+	umock_c_reset_all_calls();
+
+	// act
+	device_index_destroy(NULL);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_DEVICE_INDEX_09_019: [`device_index_destroy` shall free all the entries, the buckets and the index itself; the indexed devices are not touched]
+TEST_FUNCTION(destroy_success)
+{
+	// arrange
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_1, TEST_DEVICE_1));
+	ASSERT_ARE_EQUAL(int, 0, device_index_add(handle, TEST_DEVICE_ID_2, TEST_DEVICE_2));
+	umock_c_reset_all_calls();
+
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+	// act
+	device_index_destroy(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Registers, looks up and unregisters enough devices to grow the index many times.
+TEST_FUNCTION(add_find_remove_many_devices)
+{
+	// arrange
+	char device_id[32];
+	int i;
+	DEVICE_INDEX_HANDLE handle = create_device_index();
+
+	// act
+	add_devices(handle, TEST_MANY_DEVICES_COUNT);
+
+	for (i = 0; i < TEST_MANY_DEVICES_COUNT; i++)
+	{
+		get_test_device_id(i, device_id, sizeof(device_id));
+		ASSERT_ARE_EQUAL(void_ptr, get_test_device(i), device_index_find_by_id(handle, device_id));
+		ASSERT_IS_TRUE(device_index_contains(handle, get_test_device(i)));
+	}
+
+	for (i = 0; i < TEST_MANY_DEVICES_COUNT; i++)
+	{
+		ASSERT_ARE_EQUAL(int, 0, device_index_remove(handle, get_test_device(i)));
+	}
+
+	// assert
+	for (i = 0; i < TEST_MANY_DEVICES_COUNT; i++)
+	{
+		get_test_device_id(i, device_id, sizeof(device_id));
+		ASSERT_IS_NULL(device_index_find_by_id(handle, device_id));
+	}
+
+	// cleanup
+	device_index_destroy(handle);
+}
+
+END_TEST_SUITE(iothub_client_device_index_ut)
@@ -0,0 +1,328 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifdef __cplusplus
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <cstdbool>
+#else
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#endif
+
+void* real_malloc(size_t size)
+{
+	return malloc(size);
+}
+
+void real_free(void* ptr)
+{
+	free(ptr);
+}
+
+#include "testrunnerswitcher.h"
+#include "umock_c.h"
+#include "umock_c_negative_tests.h"
+#include "umocktypes_charptr.h"
+#include "umocktypes_stdint.h"
+#include "umocktypes_bool.h"
+#include "umocktypes.h"
+#include "umocktypes_c.h"
+
+#define ENABLE_MOCKS
+#include "azure_c_shared_utility/gballoc.h"
+
+MOCKABLE_FUNCTION(, void, test_on_item, void*, context, void*, item);
+#undef ENABLE_MOCKS
+
+#include "iothub_client_mpsc_queue.h"
+
+static TEST_MUTEX_HANDLE g_testByTest;
+static TEST_MUTEX_HANDLE g_dllByDll;
+
+DEFINE_ENUM_STRINGS(UMOCK_C_ERROR_CODE, UMOCK_C_ERROR_CODE_VALUES)
+
+static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
+{
+    char temp_str[256];
+    (void)snprintf(temp_str, sizeof(temp_str), "umock_c reported error :%s", ENUM_TO_STRING(UMOCK_C_ERROR_CODE, error_code));
+    ASSERT_FAIL(temp_str);
+}
+
+
+// Data definitions
+
+#define TEST_ITEM_1                         (void*)0x4441
+#define TEST_ITEM_2                         (void*)0x4442
+#define TEST_ITEM_3                         (void*)0x4443
+#define TEST_CONTEXT                        (void*)0x4444
+
+
+// Helpers
+
+static void register_global_mock_hooks()
+{
+	REGISTER_GLOBAL_MOCK_HOOK(malloc, real_malloc);
+	REGISTER_GLOBAL_MOCK_HOOK(free, real_free);
+}
+
+static void register_global_mock_returns()
+{
+	REGISTER_GLOBAL_MOCK_FAIL_RETURN(malloc, NULL);
+}
+
+static MPSC_QUEUE_HANDLE create_queue()
+{
+	umock_c_reset_all_calls();
+	MPSC_QUEUE_HANDLE handle = mpsc_queue_create();
+	ASSERT_IS_NOT_NULL(handle);
+	umock_c_reset_all_calls();
+
+	return handle;
+}
+
+static void push_items(MPSC_QUEUE_HANDLE handle)
+{
+	ASSERT_ARE_EQUAL(int, 0, mpsc_queue_push(handle, TEST_ITEM_1, NULL));
+	ASSERT_ARE_EQUAL(int, 0, mpsc_queue_push(handle, TEST_ITEM_2, NULL));
+	ASSERT_ARE_EQUAL(int, 0, mpsc_queue_push(handle, TEST_ITEM_3, NULL));
+	umock_c_reset_all_calls();
+}
+
+
+BEGIN_TEST_SUITE(iothub_client_mpsc_queue_ut)
+
+TEST_SUITE_INITIALIZE(TestClassInitialize)
+{
+    TEST_INITIALIZE_MEMORY_DEBUG(g_dllByDll);
+    g_testByTest = TEST_MUTEX_CREATE();
+    ASSERT_IS_NOT_NULL(g_testByTest);
+
+    umock_c_init(on_umock_c_error);
+
+	int result = umocktypes_charptr_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+	result = umocktypes_stdint_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+	result = umocktypes_bool_register_types();
+	ASSERT_ARE_EQUAL(int, 0, result);
+
+	register_global_mock_returns();
+	register_global_mock_hooks();
+}
+
+TEST_SUITE_CLEANUP(TestClassCleanup)
+{
+    umock_c_deinit();
+
+    TEST_MUTEX_DESTROY(g_testByTest);
+    TEST_DEINITIALIZE_MEMORY_DEBUG(g_dllByDll);
+}
+
+TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
+{
+    if (TEST_MUTEX_ACQUIRE(g_testByTest))
+    {
+        ASSERT_FAIL("our mutex is ABANDONED. Failure in test framework");
+    }
+
+    umock_c_reset_all_calls();
+	umock_c_negative_tests_deinit();
+}
+
+TEST_FUNCTION_CLEANUP(TestMethodCleanup)
+{
+    TEST_MUTEX_RELEASE(g_testByTest);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_001: [`mpsc_queue_create` shall allocate memory for the queue and initialize it empty]
+TEST_FUNCTION(create_success)
+{
+	// arrange
+	umock_c_reset_all_calls();
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+
+	// act
+	MPSC_QUEUE_HANDLE handle = mpsc_queue_create();
+
+	// assert
+	ASSERT_IS_NOT_NULL(handle);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(size_t, 0, mpsc_queue_drain(handle, test_on_item, TEST_CONTEXT));
+
+	// cleanup
+	mpsc_queue_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_002: [If any allocation fails, `mpsc_queue_create` shall free what it allocated and return NULL]
+TEST_FUNCTION(create_malloc_fails)
+{
+	// arrange
+	umock_c_reset_all_calls();
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG))
+		.SetReturn(NULL);
+
+	// act
+	MPSC_QUEUE_HANDLE handle = mpsc_queue_create();
+
+	// assert
+	ASSERT_IS_NULL(handle);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_003: [If `queue` or `item` are NULL, `mpsc_queue_push` shall fail and return non-zero]
+TEST_FUNCTION(push_NULL_arguments)
+{
+	// arrange
+	MPSC_QUEUE_HANDLE handle = create_queue();
+
+	// act
+	int result1 = mpsc_queue_push(NULL, TEST_ITEM_1, NULL);
+	int result2 = mpsc_queue_push(handle, NULL, NULL);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result1);
+	ASSERT_ARE_NOT_EQUAL(int, 0, result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	mpsc_queue_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_004: [`mpsc_queue_push` shall allocate a node holding `item`]
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_006: [`mpsc_queue_push` shall link the node as the new head of the queue with an atomic compare-and-swap, retrying while other threads change the head]
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_007: [If `was_empty` is not NULL, it shall be set to true if the queue had no items before the push, false otherwise]
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_008: [If no failures occur, `mpsc_queue_push` shall return 0]
+TEST_FUNCTION(push_success)
+{
+	// arrange
+	bool was_empty1 = false;
+	bool was_empty2 = true;
+	MPSC_QUEUE_HANDLE handle = create_queue();
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
+
+	// act
+	int result1 = mpsc_queue_push(handle, TEST_ITEM_1, &was_empty1);
+	int result2 = mpsc_queue_push(handle, TEST_ITEM_2, &was_empty2);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result1);
+	ASSERT_ARE_EQUAL(int, 0, result2);
+	ASSERT_IS_TRUE(was_empty1);
+	ASSERT_IS_FALSE(was_empty2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	mpsc_queue_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_005: [If allocating or linking the node fails, `mpsc_queue_push` shall free what it allocated and return non-zero]
+TEST_FUNCTION(push_malloc_fails)
+{
+	// arrange
+	MPSC_QUEUE_HANDLE handle = create_queue();
+
+	EXPECTED_CALL(malloc(IGNORED_NUM_ARG))
+		.SetReturn(NULL);
+
+	// act
+	int result = mpsc_queue_push(handle, TEST_ITEM_1, NULL);
+
+	// assert
+	ASSERT_ARE_NOT_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(size_t, 0, mpsc_queue_drain(handle, test_on_item, TEST_CONTEXT));
+
+	// cleanup
+	mpsc_queue_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_009: [If `queue` or `on_item` are NULL, `mpsc_queue_drain` shall return 0]
+TEST_FUNCTION(drain_NULL_arguments)
+{
+	// arrange
+	MPSC_QUEUE_HANDLE handle = create_queue();
+	push_items(handle);
+
+	// act
+	size_t result1 = mpsc_queue_drain(NULL, test_on_item, TEST_CONTEXT);
+	size_t result2 = mpsc_queue_drain(handle, NULL, TEST_CONTEXT);
+
+	// assert
+	ASSERT_ARE_EQUAL(size_t, 0, result1);
+	ASSERT_ARE_EQUAL(size_t, 0, result2);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	mpsc_queue_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_010: [`mpsc_queue_drain` shall atomically detach all the nodes from the queue]
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_011: [`mpsc_queue_drain` shall invoke `on_item` with `context` for each detached item, in the order they were pushed, and free its node]
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_012: [`mpsc_queue_drain` shall return the number of items passed to `on_item`]
+TEST_FUNCTION(drain_success)
+{
+	// arrange
+	bool was_empty = false;
+	MPSC_QUEUE_HANDLE handle = create_queue();
+	push_items(handle);
+
+	STRICT_EXPECTED_CALL(test_on_item(TEST_CONTEXT, TEST_ITEM_1));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(test_on_item(TEST_CONTEXT, TEST_ITEM_2));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	STRICT_EXPECTED_CALL(test_on_item(TEST_CONTEXT, TEST_ITEM_3));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+	// act
+	size_t result = mpsc_queue_drain(handle, test_on_item, TEST_CONTEXT);
+
+	// assert
+	ASSERT_ARE_EQUAL(size_t, 3, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(size_t, 0, mpsc_queue_drain(handle, test_on_item, TEST_CONTEXT));
+	ASSERT_ARE_EQUAL(int, 0, mpsc_queue_push(handle, TEST_ITEM_1, &was_empty));
+	ASSERT_IS_TRUE(was_empty);
+
+	// cleanup
+	mpsc_queue_destroy(handle);
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_013: [If `queue` is NULL, `mpsc_queue_destroy` shall return]
+TEST_FUNCTION(destroy_NULL_handle)
+{
+	// arrange
+	umock_c_reset_all_calls();
+
+	// act
+	mpsc_queue_destroy(NULL);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+// Tests_SRS_IOTHUB_CLIENT_MPSC_QUEUE_09_014: [`mpsc_queue_destroy` shall free all the remaining nodes and the queue itself; the queued items are not touched]
+TEST_FUNCTION(destroy_success)
+{
+	// arrange
+	MPSC_QUEUE_HANDLE handle = create_queue();
+	push_items(handle);
+
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	EXPECTED_CALL(free(IGNORED_PTR_ARG));
+
+	// act
+	mpsc_queue_destroy(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+END_TEST_SUITE(iothub_client_mpsc_queue_ut)
@@ -78,6 +78,7 @@ MOCKABLE_FUNCTION(, void, FAKE_IoTHubTransport_Unsubscribe, IOTHUB_DEVICE_HANDLE
 MOCKABLE_FUNCTION(, void, FAKE_IoTHubTransport_DoWork, TRANSPORT_LL_HANDLE, handle, IOTHUB_CLIENT_LL_HANDLE, iotHubClientHandle);
 MOCKABLE_FUNCTION(, int, FAKE_IoTHubTransport_SetRetryPolicy, TRANSPORT_LL_HANDLE, handle, IOTHUB_CLIENT_RETRY_POLICY, retryPolicy, size_t, retryTimeoutLimitInSeconds);
 MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, FAKE_IoTHubTransport_GetSendStatus, IOTHUB_DEVICE_HANDLE, handle, IOTHUB_CLIENT_STATUS*, iotHubClientStatus);
+MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, FAKE_IoTHubTransport_GetStatistics, IOTHUB_DEVICE_HANDLE, handle, IOTHUB_CLIENT_STATISTICS*, statistics);
 MOCKABLE_FUNCTION(, int, FAKE_IoTHubTransport_Subscribe_DeviceTwin, IOTHUB_DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, void, FAKE_IoTHubTransport_Unsubscribe_DeviceTwin, IOTHUB_DEVICE_HANDLE, handle);
 MOCKABLE_FUNCTION(, IOTHUB_CLIENT_RESULT, FAKE_IoTHubTransport_SendMessageDisposition, MESSAGE_CALLBACK_INFO*, messageData, IOTHUBMESSAGE_DISPOSITION_RESULT, disposition);
@@ -162,12 +163,15 @@ static const char* TEST_STRING_VALUE = "Test string value";
 #define TEST_BUFFER_HANDLE                  (BUFFER_HANDLE)0x52
 #define TEST_RETRY_POLICY                   IOTHUB_CLIENT_RETRY_EXPONENTIAL_BACKOFF_WITH_JITTER
 #define TEST_RETRY_TIMEOUT_SECS             60
+#define TEST_TRANSPORT_BYTES_SENT           4242
+#define TEST_TRANSPORT_RECONNECT_COUNT      3
 
 #define TEST_METHOD_ID                      (METHOD_HANDLE)0x61
 
 static const char* TEST_METHOD_NAME = "method_name";
 static const char* TEST_CHAR = "TestChar";
 static tickcounter_ms_t g_current_ms = 0;
+static PDLIST_ENTRY g_waitingToSend = NULL;
 static const char* TEST_DEVICE_METHOD_RESPONSE = "{device:method, response:true}";
 
 const unsigned char TEST_REPORTED_STATE[] = { 0x01, 0x02, 0x03 };
@@ -359,12 +363,20 @@ static void my_IoTHubClient_LL_UploadToBlob_Destroy(IOTHUB_CLIENT_LL_UPLOADTOBLO
     my_gballoc_free(handle);
 }
 
+static void test_getDataCallback(IOTHUB_CLIENT_FILE_UPLOAD_RESULT result, unsigned char const ** data, size_t* size, void* context)
+{
+    (void)result;
+    (void)data;
+    (void)size;
+    (void)context;
+}
+
 static IOTHUB_DEVICE_HANDLE my_FAKE_IoTHubTransport_Register(TRANSPORT_LL_HANDLE handle, const IOTHUB_DEVICE_CONFIG* device, IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, PDLIST_ENTRY waitingToSend)
 {
     (void)handle;
     (void)device;
     (void)iotHubClientHandle;
-    (void)waitingToSend;
+    g_waitingToSend = waitingToSend;
     return (IOTHUB_DEVICE_HANDLE)my_gballoc_malloc(1);
 }
 
@@ -380,6 +392,17 @@ static IOTHUB_CLIENT_RESULT my_FAKE_IoTHubTransport_GetSendStatus(TRANSPORT_LL_H
     return IOTHUB_CLIENT_OK;
 }
 
+static size_t g_transport_waiting_for_ack_count;
+
+static IOTHUB_CLIENT_RESULT my_FAKE_IoTHubTransport_GetStatistics(IOTHUB_DEVICE_HANDLE handle, IOTHUB_CLIENT_STATISTICS* statistics)
+{
+    (void)handle;
+    statistics->waitingForAckCount = g_transport_waiting_for_ack_count;
+    statistics->bytesSent = TEST_TRANSPORT_BYTES_SENT;
+    statistics->reconnectCount = TEST_TRANSPORT_RECONNECT_COUNT;
+    return IOTHUB_CLIENT_OK;
+}
+
 static int my_FAKE_IoTHubTransport_SetRetryPolicy(TRANSPORT_LL_HANDLE handle, IOTHUB_CLIENT_RETRY_POLICY retryPolicy, size_t retryTimeoutLimitInSeconds)
 {
     (void)handle;
@@ -437,7 +460,8 @@ static TRANSPORT_PROVIDER FAKE_transport_provider =
     FAKE_IoTHubTransport_Unsubscribe,   /*pfIoTHubTransport_Unsubscribe IoTHubTransport_Unsubscribe;    */
     FAKE_IoTHubTransport_DoWork,        /*pfIoTHubTransport_DoWork IoTHubTransport_DoWork;              */
     FAKE_IoTHubTransport_SetRetryPolicy,/*pfIoTHubTransport_SetRetryPolicy IoTHubTransport_SetRetryPolicy;*/
-    FAKE_IoTHubTransport_GetSendStatus  /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+    FAKE_IoTHubTransport_GetSendStatus, /*pfIoTHubTransport_GetSendStatus IoTHubTransport_GetSendStatus;*/
+    FAKE_IoTHubTransport_GetStatistics  /*pfIoTHubTransport_GetStatistics IoTHubTransport_GetStatistics;*/
 };
 
 static const TRANSPORT_PROVIDER* provideFAKE(void)
@@ -534,6 +558,7 @@ TEST_SUITE_INITIALIZE(suite_init)
 
 #ifndef DONT_USE_UPLOADTOBLOB
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_UPLOADTOBLOB_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_FILE_UPLOAD_GET_DATA_CALLBACK, void*);
 #endif // DONT_USE_UPLOADTOBLOB
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_GetVersionString, "version 1.0");
@@ -559,6 +584,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_SetRetryPolicy, __FAILURE__);
     REGISTER_GLOBAL_MOCK_HOOK(FAKE_IoTHubTransport_GetSendStatus, my_FAKE_IoTHubTransport_GetSendStatus);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_GetSendStatus, IOTHUB_CLIENT_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(FAKE_IoTHubTransport_GetStatistics, my_FAKE_IoTHubTransport_GetStatistics);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_GetStatistics, IOTHUB_CLIENT_ERROR);
     REGISTER_GLOBAL_MOCK_RETURN(FAKE_IoTHubTransport_Subscribe_DeviceMethod, 0);
 
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(FAKE_IoTHubTransport_Subscribe_DeviceMethod, __FAILURE__);
@@ -574,6 +601,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_UploadToBlob_Create, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_UploadToBlob_Destroy, my_IoTHubClient_LL_UploadToBlob_Destroy);
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_UploadToBlob_SetOption, IOTHUB_CLIENT_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl, IOTHUB_CLIENT_OK);
 #endif
 
     REGISTER_GLOBAL_MOCK_RETURN(deviceMethodCallback, 200);
@@ -586,6 +614,8 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(gballoc_realloc, my_gballoc_realloc);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_realloc, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_free, my_gballoc_free);
 
     REGISTER_GLOBAL_MOCK_HOOK(STRING_new, my_STRING_new);
@@ -653,6 +683,7 @@ TEST_FUNCTION_INITIALIZE(method_init)
     g_fail_string_construct_sprintf = false;
     g_fail_platform_get_platform_info = false;
     g_fail_string_concat_with_string = false;
+    g_transport_waiting_for_ack_count = 0;
 }
 
 TEST_FUNCTION_CLEANUP(TestMethodCleanup)
@@ -1501,6 +1532,9 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_succeeds)
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*the message is stamped with the time it was queued*/
+        .IgnoreAllArguments();
+
     STRICT_EXPECTED_CALL(IoTHubMessage_Clone(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -1583,6 +1617,9 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_fails)
     STRICT_EXPECTED_CALL(IoTHubMessage_Clone(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the timeout heap*/
+        .IgnoreArgument(2);
+
     STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument(1)
         .IgnoreArgument(2);
@@ -1590,7 +1627,7 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_fails)
     umock_c_negative_tests_snapshot();
 
     // act
-    size_t calls_cannot_fail[] = { 3 };
+    size_t calls_cannot_fail[] = { 4 };
     size_t count = umock_c_negative_tests_call_count();
     for (size_t index = 0; index < count; index++)
     {
@@ -1616,6 +1653,66 @@ TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_fails)
     umock_c_negative_tests_deinit();
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_048: [ IoTHubClient_LL_SendEventAsync_TakeOwnership shall behave as IoTHubClient_LL_SendEventAsync, except that the new record shall hold eventMessageHandle itself instead of a clone. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_TakeOwnership_does_not_clone_the_message)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*the message is stamped with the time it was queued*/
+        .IgnoreAllArguments();
+
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .IgnoreArgument(2);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync_TakeOwnership(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_049: [ If IoTHubClient_LL_SendEventAsync_TakeOwnership fails, eventMessageHandle shall still belong to the caller. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_TakeOwnership_fails_does_not_destroy_the_message)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t thisIsNotZero = 312984751;
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &thisIsNotZero); /*this makes _SendEventAsync index the message in the timeout heap*/
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument(1);
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+
+    STRICT_EXPECTED_CALL(gballoc_realloc(NULL, IGNORED_NUM_ARG)) /*the timeout heap*/
+        .IgnoreArgument(2)
+        .SetReturn(NULL);
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*the record is released, the message is not destroyed*/
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync_TakeOwnership(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
 /*Tests_SRS_IOTHUBCLIENT_LL_25_111: [IoTHubClient_LL_SetConnectionStatusCallback shall return IOTHUB_CLIENT_INVALID_ARG if called with NULL parameter iotHubClientHandle]*/
 TEST_FUNCTION(IoTHubClient_LL_SetConnectionStatusCallback_with_NULL_iotHubClientHandle_fails)
 {
@@ -1918,9 +2015,14 @@ TEST_FUNCTION(IoTHubClient_LL_SendComplete_with_1_items_with_callback_succeeds)
     one->messageHandle = (IOTHUB_MESSAGE_HANDLE)1;
     one->callback = eventConfirmationCallback;
     one->context = (void*)1;
+    one->ms_timesOutAfter = 0;
+    one->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(one->entry));
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the acknowledgement latency*/
+        .IgnoreAllArguments();
+
     STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, (void*)1));
@@ -1953,22 +2055,31 @@ TEST_FUNCTION(IoTHubClient_LL_SendComplete_with_3_items_with_callback_succeeds)
     one->messageHandle = (IOTHUB_MESSAGE_HANDLE)1;
     one->callback = eventConfirmationCallback;
     one->context = (void*)1;
+    one->ms_timesOutAfter = 0;
+    one->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(one->entry));
 
     IOTHUB_MESSAGE_LIST* two = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     two->messageHandle = (IOTHUB_MESSAGE_HANDLE)2;
     two->callback = eventConfirmationCallback;
     two->context = (void*)2;
+    two->ms_timesOutAfter = 0;
+    two->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(two->entry));
 
     IOTHUB_MESSAGE_LIST* three = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     three->messageHandle = (IOTHUB_MESSAGE_HANDLE)3;
     three->callback = eventConfirmationCallback;
     three->context = (void*)3;
+    three->ms_timesOutAfter = 0;
+    three->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(three->entry));
 
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the acknowledgement latency*/
+        .IgnoreAllArguments();
+
     STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, (void*)1));
@@ -2013,18 +2124,21 @@ TEST_FUNCTION(IoTHubClient_LL_SendComplete_with_3_items_with_callback__but_batch
     one->messageHandle = (IOTHUB_MESSAGE_HANDLE)1;
     one->callback = eventConfirmationCallback;
     one->context = (void*)1;
+    one->ms_timesOutAfter = 0;
     DList_InsertTailList(&temp, &(one->entry));
 
     IOTHUB_MESSAGE_LIST* two = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     two->messageHandle = (IOTHUB_MESSAGE_HANDLE)2;
     two->callback = eventConfirmationCallback;
     two->context = (void*)2;
+    two->ms_timesOutAfter = 0;
     DList_InsertTailList(&temp, &(two->entry));
 
     IOTHUB_MESSAGE_LIST* three = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     three->messageHandle = (IOTHUB_MESSAGE_HANDLE)3;
     three->callback = eventConfirmationCallback;
     three->context = (void*)3;
+    three->ms_timesOutAfter = 0;
     DList_InsertTailList(&temp, &(three->entry));
 
 
@@ -2261,6 +2375,8 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_calls_underlying_succeeds)
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, handle))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -2313,6 +2429,9 @@ TEST_FUNCTION(IoTHubClient_LL_SendComplete_with_empty_completed_shall_return)
     DList_InitializeListHead(&temp);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the acknowledgement latency*/
+        .IgnoreAllArguments();
+
     STRICT_EXPECTED_CALL(DList_RemoveHeadList(&temp));
 
     //act
@@ -2339,22 +2458,31 @@ TEST_FUNCTION(IoTHubClient_LL_SendComplete_with_3_items_one_without_callback_suc
     one->messageHandle = (IOTHUB_MESSAGE_HANDLE)1;
     one->callback = test_event_confirmation_callback;
     one->context = (void*)1;
+    one->ms_timesOutAfter = 0;
+    one->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(one->entry));
 
     IOTHUB_MESSAGE_LIST* two = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     two->messageHandle = (IOTHUB_MESSAGE_HANDLE)2;
     two->callback = NULL;
     two->context = NULL;
+    two->ms_timesOutAfter = 0;
+    two->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(two->entry));
 
     IOTHUB_MESSAGE_LIST* three = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     three->messageHandle = (IOTHUB_MESSAGE_HANDLE)3;
     three->callback = test_event_confirmation_callback;
     three->context = (void*)3;
+    three->ms_timesOutAfter = 0;
+    three->ms_enqueued = 0;
     DList_InsertTailList(&temp, &(three->entry));
 
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the acknowledgement latency*/
+        .IgnoreAllArguments();
+
     STRICT_EXPECTED_CALL(DList_RemoveHeadList(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, (void*)1));
@@ -2398,18 +2526,21 @@ TEST_FUNCTION(IoTHubClient_LL_SendComplete_with_3_items_one_with_callback_but_ba
     one->messageHandle = (IOTHUB_MESSAGE_HANDLE)1;
     one->callback = NULL;
     one->context = NULL;
+    one->ms_timesOutAfter = 0;
     DList_InsertTailList(&temp, &(one->entry));
 
     IOTHUB_MESSAGE_LIST* two = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     two->messageHandle = (IOTHUB_MESSAGE_HANDLE)2;
     two->callback = NULL;
     two->context = NULL;
+    two->ms_timesOutAfter = 0;
     DList_InsertTailList(&temp, &(two->entry));
 
     IOTHUB_MESSAGE_LIST* three = (IOTHUB_MESSAGE_LIST*)malloc(sizeof(IOTHUB_MESSAGE_LIST)); /*this is SendEvent wannabe*/
     three->messageHandle = (IOTHUB_MESSAGE_HANDLE)3;
     three->callback = test_event_confirmation_callback;
     three->context = (void*)3;
+    three->ms_timesOutAfter = 0;
     DList_InsertTailList(&temp, &(three->entry));
 
     umock_c_reset_all_calls();
@@ -2757,6 +2888,490 @@ TEST_FUNCTION(IoTHubClient_LL_GetLastMessageReceiveTime_MessagesReceived_succeed
     destroy_test_message_info(testMessage);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_014: [ IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetNextMessageTimeout_NULL_handle_fails)
+{
+    // arrange
+    uint64_t msUntilNextTimeout;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetNextMessageTimeout(NULL, &msUntilNextTimeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_014: [ IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetNextMessageTimeout_NULL_msUntilNextTimeout_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetNextMessageTimeout(handle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_015: [ IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_INDEFINITE_TIME - and not set msUntilNextTimeout - if no pending message has a timeout. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetNextMessageTimeout_without_timeout_messages_returns_INDEFINITE_TIME)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1); /*messageTimeout was never set*/
+    umock_c_reset_all_calls();
+    uint64_t msUntilNextTimeout = 42;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetNextMessageTimeout(handle, &msUntilNextTimeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INDEFINITE_TIME, result);
+    ASSERT_ARE_EQUAL(int, 42, (int)msUntilNextTimeout);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_016: [ If getting the current time fails, IoTHubClient_LL_GetNextMessageTimeout shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetNextMessageTimeout_tickcounter_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t one = 1;
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &one);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments()
+        .SetReturn(__LINE__);
+    uint64_t msUntilNextTimeout;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetNextMessageTimeout(handle, &msUntilNextTimeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_010: [ If the message has a timeout, IoTHubClient_LL_SendEventAsync shall index it by its timeout in a min-heap. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_017: [ Otherwise IoTHubClient_LL_GetNextMessageTimeout shall set msUntilNextTimeout to the number of milliseconds until the earliest pending message timeout, or 0 if it is already due, and return IOTHUB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetNextMessageTimeout_returns_the_earliest_timeout)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t ten = 10;
+    tickcounter_ms_t five = 5;
+    tickcounter_ms_t twelve = 12;
+
+    /*first message times out at 10 + 10 = 20, second one at 10 + 5 = 15*/
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &ten);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &ten, sizeof(ten));
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE);
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &five);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &ten, sizeof(ten));
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE_2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
+    uint64_t msUntilNextTimeout = 0;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetNextMessageTimeout(handle, &msUntilNextTimeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(int, 3, (int)msUntilNextTimeout);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_011: [ DoTimeouts shall pop from the timeout heap every message whose timeout has passed and mark it as expired. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_012: [ IoTHubClient_LL_DoWork shall unlink every expired message that is still linked in waitingToSend directly, without walking waitingToSend. Expired messages that the transport already took off waitingToSend are completed by the transport. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_times_out_messages_in_timeout_order)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t ten = 10;
+    tickcounter_ms_t one = 1;
+    tickcounter_ms_t twelve = 12;
+
+    /*first message times out at 10 + 10 = 20, second one at 10 + 1 = 11*/
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &ten);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &ten, sizeof(ten));
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE);
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &one);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &ten, sizeof(ten));
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE_2);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
+    STRICT_EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG)) /*only the second message is removed from waitingToSend*/
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_MESSAGE_TIMEOUT, (void*)TEST_DEVICEMESSAGE_HANDLE_2));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument(1);
+    EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
+
+    // act
+    IoTHubClient_LL_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_012: [ IoTHubClient_LL_DoWork shall unlink every expired message that is still linked in waitingToSend directly, without walking waitingToSend. Expired messages that the transport already took off waitingToSend are completed by the transport. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_does_not_time_out_messages_taken_by_the_transport)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t one = 1;
+    tickcounter_ms_t ten = 10;
+    tickcounter_ms_t twelve = 12;
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &one);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &ten, sizeof(ten));
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE);
+
+    /*the transport takes the message in flight*/
+    DLIST_ENTRY inFlight;
+    DList_InitializeListHead(&inFlight);
+    PDLIST_ENTRY taken = DList_RemoveHeadList(g_waitingToSend);
+    containingRecord(taken, IOTHUB_MESSAGE_LIST, entry)->inWaitingToSend = false;
+    DList_InsertTailList(&inFlight, taken);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
+    EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
+
+    // act
+    IoTHubClient_LL_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_SendComplete(handle, &inFlight, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_012: [ IoTHubClient_LL_DoWork shall unlink every expired message that is still linked in waitingToSend directly, without walking waitingToSend. Expired messages that the transport already took off waitingToSend are completed by the transport. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_055: [ IoTHubClient_LL_SendEventAsync shall mark the new record as linked in waitingToSend (inWaitingToSend). A transport that takes a record off waitingToSend shall clear inWaitingToSend. ]*/
+TEST_FUNCTION(IoTHubClient_LL_DoWork_does_not_walk_waitingToSend_for_an_expired_message_in_flight)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t zero = 0;
+    tickcounter_ms_t one = 1;
+    tickcounter_ms_t ten = 10;
+    tickcounter_ms_t twelve = 12;
+    size_t i;
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &one);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &ten, sizeof(ten));
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE);
+
+    /*the transport takes the message in flight*/
+    DLIST_ENTRY inFlight;
+    DList_InitializeListHead(&inFlight);
+    PDLIST_ENTRY taken = DList_RemoveHeadList(g_waitingToSend);
+    containingRecord(taken, IOTHUB_MESSAGE_LIST, entry)->inWaitingToSend = false;
+    DList_InsertTailList(&inFlight, taken);
+
+    /*a long waitingToSend of messages that do not time out*/
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &zero);
+    for (i = 0; i < 100; i++)
+    {
+        (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE);
+    }
+
+    /*its tail looks expired, so it would be timed out by a walk that reached it*/
+    IOTHUB_MESSAGE_LIST* tail = (IOTHUB_MESSAGE_LIST*)my_gballoc_malloc(sizeof(IOTHUB_MESSAGE_LIST));
+    ASSERT_IS_NOT_NULL(tail);
+    tail->messageHandle = TEST_DEVICEMESSAGE_HANDLE_2;
+    tail->callback = test_event_confirmation_callback;
+    tail->context = (void*)TEST_DEVICEMESSAGE_HANDLE_2;
+    tail->ms_timesOutAfter = one;
+    tail->ms_enqueued = zero;
+    tail->timeoutHeapIndex = (size_t)(-1);
+    tail->inWaitingToSend = true;
+    DList_InsertTailList(g_waitingToSend, &(tail->entry));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument(1)
+        .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
+    EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
+
+    // act
+    IoTHubClient_LL_DoWork(handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    DList_RemoveEntryList(&(tail->entry));
+    my_gballoc_free(tail);
+    IoTHubClient_LL_SendComplete(handle, &inFlight, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_013: [ IoTHubClient_LL_SendComplete shall remove every completed message that has a pending timeout from the timeout heap. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendComplete_removes_the_message_from_the_timeout_heap)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    tickcounter_ms_t one = 1;
+    (void)IoTHubClient_LL_SetOption(handle, "messageTimeout", &one);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_DEVICEMESSAGE_HANDLE, test_event_confirmation_callback, (void*)TEST_DEVICEMESSAGE_HANDLE);
+
+    DLIST_ENTRY completed;
+    DList_InitializeListHead(&completed);
+    PDLIST_ENTRY taken = DList_RemoveHeadList(g_waitingToSend);
+    DList_InsertTailList(&completed, taken);
+    uint64_t msUntilNextTimeout;
+
+    // act
+    IoTHubClient_LL_SendComplete(handle, &completed, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetNextMessageTimeout(handle, &msUntilNextTimeout);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INDEFINITE_TIME, result);
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_025: [ IoTHubClient_LL_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetStatistics_NULL_handle_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetStatistics(NULL, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_025: [ IoTHubClient_LL_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG if any of the arguments is NULL. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetStatistics_NULL_statistics_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetStatistics(handle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_022: [ IoTHubClient_LL_SendEventAsync shall stamp the message with the current tick count, which IoTHubClient_LL_SendComplete uses to measure the acknowledgement latency. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_023: [ If result is IOTHUB_CLIENT_CONFIRMATION_OK, IoTHubClient_LL_SendComplete shall read the tick count once and add the time elapsed since IoTHubClient_LL_SendEventAsync of each completed message to the acknowledgement latency histogram. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_026: [ IoTHubClient_LL_GetStatistics shall copy the counters kept by IoTHubClient_LL into statistics. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_027: [ IoTHubClient_LL_GetStatistics shall set waitingToSendCount, without walking waitingToSend, to the number of queued messages that are neither completed nor reported in waitingForAckCount by the transport. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_029: [ If the transport provides IoTHubTransport_GetStatistics, IoTHubClient_LL_GetStatistics shall call it to fill in the transport counters and return IOTHUB_CLIENT_ERROR if it fails. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_030: [ Otherwise IoTHubClient_LL_GetStatistics shall return IOTHUB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetStatistics_counts_the_messages_by_outcome)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    IOTHUB_CLIENT_STATISTICS statistics;
+    DLIST_ENTRY acknowledged;
+    DLIST_ENTRY failed;
+    DLIST_ENTRY inFlight;
+    uint64_t latencySamples = 0;
+    size_t i;
+
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)2);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)3);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)4); /*this one stays in waitingToSend*/
+
+    DList_InitializeListHead(&acknowledged);
+    DList_InitializeListHead(&failed);
+    DList_InitializeListHead(&inFlight);
+    DList_InsertTailList(&acknowledged, DList_RemoveHeadList(g_waitingToSend));
+    DList_InsertTailList(&failed, DList_RemoveHeadList(g_waitingToSend));
+    DList_InsertTailList(&inFlight, DList_RemoveHeadList(g_waitingToSend));
+    IoTHubClient_LL_SendComplete(handle, &acknowledged, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_LL_SendComplete(handle, &failed, IOTHUB_CLIENT_CONFIRMATION_ERROR);
+    g_transport_waiting_for_ack_count = 1;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetStatistics(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 4, (int)statistics.messagesQueued);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.messagesAcknowledged);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.messagesFailed);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.messagesTimedOut);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.waitingToSendCount);
+    ASSERT_ARE_EQUAL(size_t, 1, statistics.waitingForAckCount);
+    ASSERT_ARE_EQUAL(int, TEST_TRANSPORT_BYTES_SENT, (int)statistics.bytesSent);
+    ASSERT_ARE_EQUAL(int, TEST_TRANSPORT_RECONNECT_COUNT, (int)statistics.reconnectCount);
+    for (i = 0; i < IOTHUB_CLIENT_STATISTICS_BUCKET_COUNT; i++)
+    {
+        latencySamples += statistics.ackLatencyHistogram[i];
+    }
+    ASSERT_ARE_EQUAL(int, 1, (int)latencySamples);
+
+    ///cleanup
+    IoTHubClient_LL_SendComplete(handle, &inFlight, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_024: [ If the tick count could be read when IoTHubClient_LL_DoWork started, IoTHubClient_LL_DoWork shall read it again once done and add its duration to the statistics. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_028: [ IoTHubClient_LL_GetStatistics shall set the DoWork duration percentiles to the upper bound of the histogram bucket holding them, capped by the longest DoWork duration. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetStatistics_reports_the_DoWork_durations)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    IOTHUB_CLIENT_STATISTICS statistics;
+    tickcounter_ms_t startTimes[] = { 100, 200, 300, 400 };
+    tickcounter_ms_t endTimes[] = { 100, 103, 340, 2400 }; /*0ms, 3ms, 40ms and 2000ms*/
+    size_t i;
+
+    for (i = 0; i < sizeof(startTimes) / sizeof(startTimes[0]); i++)
+    {
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .CopyOutArgumentBuffer(2, &startTimes[i], sizeof(startTimes[i]));
+        EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument(1)
+            .CopyOutArgumentBuffer(2, &endTimes[i], sizeof(endTimes[i]));
+        IoTHubClient_LL_DoWork(handle);
+    }
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(int, 4, (int)statistics.doWorkCount);
+    ASSERT_ARE_EQUAL(int, 2000, (int)statistics.doWorkDurationMaxMs);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.doWorkDurationHistogram[0]);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.doWorkDurationHistogram[1]);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.doWorkDurationHistogram[3]);
+    ASSERT_ARE_EQUAL(int, 1, (int)statistics.doWorkDurationHistogram[7]);
+    ASSERT_ARE_EQUAL(int, 5, (int)statistics.doWorkDurationP50Ms);
+    ASSERT_ARE_EQUAL(int, 2000, (int)statistics.doWorkDurationP90Ms);
+    ASSERT_ARE_EQUAL(int, 2000, (int)statistics.doWorkDurationP99Ms);
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_029: [ If the transport provides IoTHubTransport_GetStatistics, IoTHubClient_LL_GetStatistics shall call it to fill in the transport counters and return IOTHUB_CLIENT_ERROR if it fails. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetStatistics_fails_when_the_transport_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    IOTHUB_CLIENT_STATISTICS statistics;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_GetStatistics(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_047: [ IoTHubClient_LL_GetStatistics shall set waitingForAckCount to 0 before calling IoTHubTransport_GetStatistics, so that transports that keep no message in flight between calls to DoWork report none. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_030: [ Otherwise IoTHubClient_LL_GetStatistics shall return IOTHUB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubClient_LL_GetStatistics_without_transport_statistics_succeeds)
+{
+    // arrange
+    IOTHUB_CLIENT_LL_HANDLE handle;
+    IOTHUB_CLIENT_STATISTICS statistics;
+    FAKE_transport_provider.IoTHubTransport_GetStatistics = NULL;
+    handle = IoTHubClient_LL_Create(&TEST_CONFIG);
+    FAKE_transport_provider.IoTHubTransport_GetStatistics = FAKE_IoTHubTransport_GetStatistics;
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+    (void)IoTHubClient_LL_SendEventAsync(handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)2);
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_GetStatistics(handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.bytesSent);
+    ASSERT_ARE_EQUAL(int, 0, (int)statistics.reconnectCount);
+    ASSERT_ARE_EQUAL(size_t, 2, statistics.waitingToSendCount);
+    ASSERT_ARE_EQUAL(size_t, 0, statistics.waitingForAckCount);
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(handle);
+}
+
 /*** IoTHubClient_LL_GetSendStatus ***/
 
 /* Tests_SRS_IOTHUBCLIENT_09_007: [IoTHubClient_LL_GetSendStatus shall return IOTHUB_CLIENT_INVALID_ARG if called with NULL parameter] */
@@ -3109,6 +3724,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_calls_timeout_callback)
         .IgnoreArgument(1);
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3145,6 +3762,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_defaults_to_zero)
         .CopyOutArgumentBuffer(2, &twelve, sizeof(twelve));
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3190,6 +3809,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_only_removes_the_message_
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3228,6 +3849,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_messageTimeout_when_exactly_on_the_edge_
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3282,6 +3905,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_with_timeouts_at_11_and_12_ca
     /*we don't care what happens in the Transport, so let's ignore all those calls*/
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     /*because we're at time = 12 in this test, the second message is untouched*/
 
@@ -3341,6 +3966,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_with_timeouts_at_11_and_12_ca
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     timeIsNow = 13; /*13 > 10 (receive time) + 2 (timeout) => timeout!!!*/
     STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -3357,6 +3984,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_with_timeouts_at_11_and_12_ca
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
 
     /*because we're at time = 13 in this test, the second message times out too*/
@@ -3418,6 +4047,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_one_with_timeout_one_without_
 
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     {/*this scope happen in the second _DoWork call*/
         tickcounter_ms_t timeIsNow = 999999999UL; /*some very big number*/
@@ -3427,6 +4058,8 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_2_messages_one_with_timeout_one_without_
     }
     EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreAllCalls();
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(handle);
@@ -3533,6 +4166,78 @@ TEST_FUNCTION(IoTHubClient_LL_UploadToBlob_with_NULL_source_and_size_greater_tha
     ///cleanup
     IoTHubClient_LL_Destroy(h);
 }
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_035: [ If iotHubClientHandle, destinationFileName or getDataCallback are NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_with_NULL_handle_fails)
+{
+    //arrange
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob(NULL, "someFileName.txt", test_getDataCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_035: [ If iotHubClientHandle, destinationFileName or getDataCallback are NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_with_NULL_fileName_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob(h, NULL, test_getDataCallback, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_035: [ If iotHubClientHandle, destinationFileName or getDataCallback are NULL then IoTHubClient_LL_UploadMultipleBlocksToBlob shall fail and return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_with_NULL_getDataCallback_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob(h, "someFileName.txt", NULL, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_036: [ Otherwise IoTHubClient_LL_UploadMultipleBlocksToBlob shall call IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl and return what it returns. ]*/
+TEST_FUNCTION(IoTHubClient_LL_UploadMultipleBlocksToBlob_calls_the_upload_to_blob_module)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_UploadMultipleBlocksToBlob_Impl(IGNORED_PTR_ARG, "someFileName.txt", test_getDataCallback, (void*)1))
+        .IgnoreArgument(1)
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_UploadMultipleBlocksToBlob(h, "someFileName.txt", test_getDataCallback, (void*)1);
+
+    ///assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubClient_LL_Destroy(h);
+}
 #endif 
 
 /* Tests_SRS_IOTHUBCLIENT_LL_10_016: [ Otherwise IoTHubClient_LL_SendReportedState shall succeed and return IOTHUB_CLIENT_OK.] */
@@ -3676,6 +4381,8 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_SendReportedState_succeed)
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(h);
@@ -3708,6 +4415,8 @@ TEST_FUNCTION(IoTHubClient_LL_DoWork_SendReportedState_continue_processing_succe
 
     STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_DoWork(IGNORED_PTR_ARG, h))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*for the _DoWork duration*/
+        .IgnoreAllArguments();
 
     //act
     IoTHubClient_LL_DoWork(h);
@@ -4521,6 +5230,90 @@ TEST_FUNCTION(IoTHubClient_LL_SetOption_product_info_twice_succeeds)
     IoTHubClient_LL_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBCLIENT_LL_09_020: [ "message_pool_size" - IoTHubClient_LL_SetOption shall set the number of released records kept for reuse to *value, a size_t, and free the records above that number. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_021: [ IoTHubClient_LL_SetOption shall pass "message_pool_size" down to the transport and return IOTHUB_CLIENT_ERROR only if the transport returns IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_message_pool_size_transport_not_supporting_it_succeeds)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    size_t poolSize = 4;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_SetOption(IGNORED_PTR_ARG, OPTION_MESSAGE_POOL_SIZE, &poolSize))
+        .IgnoreArgument_handle()
+        .SetReturn(IOTHUB_CLIENT_INVALID_ARG);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_POOL_SIZE, &poolSize);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_021: [ IoTHubClient_LL_SetOption shall pass "message_pool_size" down to the transport and return IOTHUB_CLIENT_ERROR only if the transport returns IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SetOption_message_pool_size_transport_fails)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    size_t poolSize = 4;
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(FAKE_IoTHubTransport_SetOption(IGNORED_PTR_ARG, OPTION_MESSAGE_POOL_SIZE, &poolSize))
+        .IgnoreArgument_handle()
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_POOL_SIZE, &poolSize);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBCLIENT_LL_09_018: [ IoTHubClient_LL_SendEventAsync shall reuse a released record from the message pool when one is available. ]*/
+/*Tests_SRS_IOTHUBCLIENT_LL_09_019: [ IoTHubClient_LL_SendComplete shall return each completed record to the message pool while the pool holds fewer than "message_pool_size" records, and free it otherwise. ]*/
+TEST_FUNCTION(IoTHubClient_LL_SendEventAsync_reuses_record_released_by_SendComplete)
+{
+    //arrange
+    IOTHUB_CLIENT_LL_HANDLE h = IoTHubClient_LL_Create(&TEST_CONFIG);
+    size_t poolSize = 1;
+    (void)IoTHubClient_LL_SetOption(h, OPTION_MESSAGE_POOL_SIZE, &poolSize);
+    (void)IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)1);
+
+    DLIST_ENTRY completed;
+    DList_InitializeListHead(&completed);
+    DList_InsertTailList(&completed, DList_RemoveHeadList(g_waitingToSend));
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, (void*)1));
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(DList_RemoveHeadList(&completed)); /*no gballoc_free, the record went to the pool*/
+
+    STRICT_EXPECTED_CALL(tickcounter_get_current_ms(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*no gballoc_malloc, the record comes from the pool*/
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(DList_InsertTailList(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+
+    //act
+    IoTHubClient_LL_SendComplete(h, &completed, IOTHUB_CLIENT_CONFIRMATION_OK);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_LL_SendEventAsync(h, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)2);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubClient_LL_Destroy(h);
+}
+
 TEST_FUNCTION(IoTHubClient_LL_SetOption_product_info_succeeds)
 {
     //arrange
@@ -5,10 +5,12 @@
 #include <cstdlib>
 #include <cstddef>
 #include <cstdbool>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 #endif
 
 static bool g_fail_my_gballoc_malloc = false;
@@ -38,9 +40,12 @@ void* my_gballoc_realloc(void* ptr, size_t size)
 #define ENABLE_MOCKS
 #include "azure_c_shared_utility/vector.h"
 #include "iothubtransport.h"
+#include "iothub_client_mpsc_queue.h"
+#include "iothub_client_callback_pool.h"
 #undef ENABLE_MOCKS
 
 #include "iothub_client.h"
+#include "iothub_client_options.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -61,6 +66,11 @@ extern "C" {
     extern int real_mallocAndStrcpy_s(char** destination, const char* source);
     extern int real_size_tToString(char* destination, size_t destinationSize, size_t value);
 
+    extern MPSC_QUEUE_HANDLE real_mpsc_queue_create(void);
+    extern int real_mpsc_queue_push(MPSC_QUEUE_HANDLE queue, void* item, bool* was_empty);
+    extern size_t real_mpsc_queue_drain(MPSC_QUEUE_HANDLE queue, MPSC_QUEUE_ON_ITEM on_item, void* context);
+    extern void real_mpsc_queue_destroy(MPSC_QUEUE_HANDLE queue);
+
 #ifdef __cplusplus
 }
 #endif
@@ -94,6 +104,7 @@ static int my_DeviceMethodCallback_Impl(const char* method_name, const unsigned
 #include "azure_c_shared_utility/singlylinkedlist.h"
 #include "azure_c_shared_utility/vector.h"
 #include "azure_c_shared_utility/threadapi.h"
+#include "azure_c_shared_utility/condition.h"
 
 #include "iothub_client_ll.h"
 
@@ -150,6 +161,9 @@ static IOTHUB_CLIENT_MESSAGE_CALLBACK_ASYNC_EX g_messageCallback_ex;
 static size_t g_how_thread_loops = 0;
 static size_t g_thread_loop_count = 0;
 
+static CALLBACK_POOL_WORK g_pool_work;
+static void* g_pool_work_context;
+
 
 static const IOTHUB_CLIENT_TRANSPORT_PROVIDER TEST_TRANSPORT_PROVIDER = (IOTHUB_CLIENT_TRANSPORT_PROVIDER)0x1110;
 static IOTHUB_CLIENT_LL_HANDLE TEST_IOTHUB_CLIENT_HANDLE = (IOTHUB_CLIENT_LL_HANDLE)0x1111;
@@ -163,6 +177,9 @@ static IOTHUB_CLIENT_DEVICE_CONFIG* TEST_CLIENT_DEVICE_CONFIG = (IOTHUB_CLIENT_D
 static METHOD_HANDLE TEST_METHOD_ID = (METHOD_HANDLE)0x111B;
 static STRING_HANDLE TEST_STRING_HANDLE = (STRING_HANDLE)0x111C;
 static BUFFER_HANDLE TEST_BUFFER_HANDLE = (BUFFER_HANDLE)0x111D;
+static COND_HANDLE TEST_COND_HANDLE = (COND_HANDLE)0x111E;
+static IOTHUB_MESSAGE_HANDLE TEST_CLONED_MESSAGE_HANDLE = (IOTHUB_MESSAGE_HANDLE)0x111F;
+static CALLBACK_POOL_HANDLE TEST_CALLBACK_POOL_HANDLE = (CALLBACK_POOL_HANDLE)0x1120;
 
 static const char* TEST_CONNECTION_STRING = "Test_connection_string";
 static const char* TEST_DEVICE_ID = "theidofTheDevice";
@@ -211,6 +228,15 @@ static LOCK_HANDLE my_IoTHubTransport_GetLock(TRANSPORT_HANDLE transportHandle)
     return (LOCK_HANDLE)&g_transport_lock;
 }
 
+static IOTHUB_CLIENT_MULTIPLEXED_DO_WORK g_mux_do_work;
+static IOTHUB_CLIENT_RESULT my_IoTHubTransport_StartWorkerThread(TRANSPORT_HANDLE transportHandle, IOTHUB_CLIENT_HANDLE clientHandle, IOTHUB_CLIENT_MULTIPLEXED_DO_WORK muxDoWork)
+{
+    (void)transportHandle;
+    (void)clientHandle;
+    g_mux_do_work = muxDoWork;
+    return IOTHUB_CLIENT_OK;
+}
+
 static THREADAPI_RESULT my_ThreadAPI_Join(THREAD_HANDLE threadHandle, int *res)
 {
     (void)threadHandle;
@@ -226,6 +252,16 @@ static THREADAPI_RESULT my_ThreadAPI_Create(THREAD_HANDLE* threadHandle, THREAD_
     return THREADAPI_OK;
 }
 
+/*the callback pool only records the last work posted, the test runs it*/
+static int my_callback_pool_post(CALLBACK_POOL_HANDLE pool, CALLBACK_POOL_WORK work, void* context, bool ordered)
+{
+    (void)pool;
+    (void)ordered;
+    g_pool_work = work;
+    g_pool_work_context = context;
+    return 0;
+}
+
 static void my_ThreadAPI_Sleep(unsigned int milliseconds)
 {
     (void)milliseconds;
@@ -236,10 +272,24 @@ static void my_ThreadAPI_Sleep(unsigned int milliseconds)
     }
 }
 
+static COND_RESULT my_Condition_Wait(COND_HANDLE handle, LOCK_HANDLE lock, int timeout_milliseconds)
+{
+    (void)handle;
+    (void)lock;
+    (void)timeout_milliseconds;
+    g_thread_loop_count++;
+    if ((g_how_thread_loops > 0) && (g_how_thread_loops == g_thread_loop_count))
+    {
+        *(sig_atomic_t*)(((char*)g_thread_func_arg) + IoTHubClient_ThreadTerminationOffset) = 1; /*tell the thread to stop*/
+    }
+    return COND_TIMEOUT;
+}
+
+static IOTHUB_CLIENT_STATUS g_send_status;
 static IOTHUB_CLIENT_RESULT my_IoTHubClient_LL_GetSendStatus(IOTHUB_CLIENT_LL_HANDLE iotHubClientHandle, IOTHUB_CLIENT_STATUS *iotHubClientStatus)
 {
     (void)iotHubClientHandle;
-    *iotHubClientStatus = IOTHUB_CLIENT_SEND_STATUS_IDLE;
+    *iotHubClientStatus = g_send_status;
     return IOTHUB_CLIENT_OK;
 }
 
@@ -350,6 +400,10 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MPSC_QUEUE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(MPSC_QUEUE_ON_ITEM, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CALLBACK_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CALLBACK_POOL_WORK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(THREAD_START_FUNC, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_LL_HANDLE, void*);
@@ -381,12 +435,15 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(const VECTOR_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(TRANSPORT_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_MULTIPLEXED_DO_WORK, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_STATUS, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUBMESSAGE_DISPOSITION_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(METHOD_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(BUFFER_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_RESULT, int);
 
     REGISTER_GLOBAL_MOCK_HOOK(gballoc_malloc, my_gballoc_malloc);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(gballoc_malloc, NULL);
@@ -400,6 +457,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_CreateWithTransport, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_SendEventAsync, my_IoTHubClient_LL_SendEventAsync);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_SendEventAsync, IOTHUB_CLIENT_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_SendEventAsync_TakeOwnership, my_IoTHubClient_LL_SendEventAsync);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_SendEventAsync_TakeOwnership, IOTHUB_CLIENT_ERROR);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_GetSendStatus, my_IoTHubClient_LL_GetSendStatus);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_GetSendStatus, IOTHUB_CLIENT_ERROR);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_GetLastMessageReceiveTime, my_IoTHubClient_LL_GetLastMessageReceiveTime);
@@ -423,6 +482,8 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_UploadToBlob, IOTHUB_CLIENT_OK);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubClient_LL_UploadToBlob, IOTHUB_CLIENT_ERROR);
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_GetRetryPolicy, IOTHUB_CLIENT_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_GetStatistics, IOTHUB_CLIENT_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubClient_LL_GetNextMessageTimeout, IOTHUB_CLIENT_INDEFINITE_TIME);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_LL_Destroy, my_IoTHubClient_LL_Destroy);
     REGISTER_GLOBAL_MOCK_HOOK(test_event_confirmation_callback, my_test_event_confirmation_callback);
     
@@ -458,6 +519,12 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_HOOK(ThreadAPI_Create, my_ThreadAPI_Create);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(ThreadAPI_Create, THREADAPI_ERROR);
 
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Init, TEST_COND_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Condition_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Post, COND_OK);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Condition_Post, COND_ERROR);
+    REGISTER_GLOBAL_MOCK_HOOK(Condition_Wait, my_Condition_Wait);
+
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_create, real_VECTOR_create);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(VECTOR_create, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_move, real_VECTOR_move);
@@ -477,6 +544,22 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(singlylinkedlist_add, NULL);
 
     REGISTER_GLOBAL_MOCK_RETURN(IoTHubTransport_SignalEndWorkerThread, true);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubTransport_StartWorkerThread, my_IoTHubTransport_StartWorkerThread);
+
+    REGISTER_GLOBAL_MOCK_RETURN(IoTHubMessage_Clone, TEST_CLONED_MESSAGE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(IoTHubMessage_Clone, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(mpsc_queue_create, real_mpsc_queue_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mpsc_queue_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(mpsc_queue_push, real_mpsc_queue_push);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(mpsc_queue_push, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_HOOK(mpsc_queue_drain, real_mpsc_queue_drain);
+    REGISTER_GLOBAL_MOCK_HOOK(mpsc_queue_destroy, real_mpsc_queue_destroy);
+
+    REGISTER_GLOBAL_MOCK_RETURN(callback_pool_create, TEST_CALLBACK_POOL_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(callback_pool_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(callback_pool_post, my_callback_pool_post);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(callback_pool_post, __FAILURE__);
 
     REGISTER_GLOBAL_MOCK_HOOK(my_DeviceMethodCallback, my_DeviceMethodCallback_Impl);
 }
@@ -498,6 +581,10 @@ TEST_FUNCTION_INITIALIZE(method_init)
     g_userContextCallback = NULL;
     g_how_thread_loops = 0;
     g_thread_loop_count = 0;
+    g_pool_work = NULL;
+    g_pool_work_context = NULL;
+    g_mux_do_work = NULL;
+    g_send_status = IOTHUB_CLIENT_SEND_STATUS_IDLE;
     
     g_eventConfirmationCallback = NULL;
     g_deviceTwinCallback = NULL;
@@ -570,18 +657,88 @@ static void setup_iothubclient_sendeventasync(bool use_threads)
 {
     if (use_threads)
     {
+        STRICT_EXPECTED_CALL(Condition_Init());
+        STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+        STRICT_EXPECTED_CALL(mpsc_queue_create());
+        STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
         EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     }
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument(1);
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SendEventAsync(IGNORED_PTR_ARG, TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(1)
-        .IgnoreArgument(3)
-        .IgnoreArgument(4);
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the SEND_EVENT_REQUEST*/
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the IOTHUB_QUEUE_CONTEXT*/
+    STRICT_EXPECTED_CALL(mpsc_queue_push(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    if (use_threads)
+    {
+        STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+        STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+        STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    }
+}
+
+static void setup_worker_sends_queued_event(IOTHUB_CLIENT_RESULT send_result)
+{
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SendEventAsync_TakeOwnership(TEST_IOTHUB_CLIENT_HANDLE, TEST_CLONED_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .SetReturn(send_result);
+    if (send_result != IOTHUB_CLIENT_OK)
+    {
+        STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the IOTHUB_QUEUE_CONTEXT*/
+        STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(TEST_CLONED_MESSAGE_HANDLE));
+    }
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the SEND_EVENT_REQUEST*/
+}
+
+static void run_worker_thread_once(void)
+{
+    g_how_thread_loops = 1;
+    g_thread_loop_count = 0;
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    g_thread_func(g_thread_func_arg);
+
+    /*the worker was told to stop after one loop, let the test run it again*/
+    *(sig_atomic_t*)(((char*)g_thread_func_arg) + IoTHubClient_ThreadTerminationOffset) = 0;
+    g_how_thread_loops = 0;
+    g_thread_loop_count = 0;
+}
+
+static IOTHUB_CLIENT_HANDLE create_client_with_callback_pool(void)
+{
+    size_t callback_thread_count = 2;
+    IOTHUB_CLIENT_HANDLE result = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, IoTHubClient_SetOption(result, OPTION_CALLBACK_THREAD_COUNT, &callback_thread_count));
+    return result;
+}
+
+static void setup_worker_dispatches_one_callback(void)
+{
+    g_how_thread_loops = 1;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+}
+
+static void setup_worker_waits(void)
+{
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 }
 
 static void setup_iothubclient_uploadtoblobasync()
@@ -593,6 +750,10 @@ static void setup_iothubclient_uploadtoblobasync()
         .IgnoreArgument_source();
     STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is creating a UPLOADTOBLOB_SAVED_DATA*/
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
@@ -926,6 +1087,7 @@ TEST_FUNCTION(IoTHubClient_Destroy_succeed)
     // cleanup
 }
 
+/* Tests_SRS_IOTHUBCLIENT_09_026: [ After the worker thread is joined, IoTHubClient_Destroy shall invoke the eventConfirmationCallback of each event still in the send queue with IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, destroy their copies and destroy the send queue. ]*/
 TEST_FUNCTION(IoTHubClient_Destroy_calls_IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBACK_succeed)
 {
     // arrange
@@ -933,19 +1095,17 @@ TEST_FUNCTION(IoTHubClient_Destroy_calls_IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBA
     umock_c_reset_all_calls();
 
     setup_iothubclient_sendeventasync(true);
-    (void)IoTHubClient_SendEventAsync(iothub_handle, (IOTHUB_MESSAGE_HANDLE)0x42, test_event_confirmation_callback, (void*)0x42);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)0x42);
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
     EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_Destroy(IGNORED_PTR_ARG))
         .IgnoreArgument_iotHubClientHandle();
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-        .IgnoreArgument_handle()
-        .IgnoreArgument_elements();
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument_ptr();
     STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -953,9 +1113,16 @@ TEST_FUNCTION(IoTHubClient_Destroy_calls_IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBA
         .IgnoreArgument_threadHandle()
         .IgnoreArgument_res();
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG,0));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_BECAUSE_DESTROY, (void*)0x42));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the IOTHUB_QUEUE_CONTEXT*/
+    STRICT_EXPECTED_CALL(IoTHubMessage_Destroy(TEST_CLONED_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the SEND_EVENT_REQUEST*/
+    STRICT_EXPECTED_CALL(mpsc_queue_destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Condition_Deinit(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG)); /*this is the statistics lock*/
     STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
     EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
@@ -970,7 +1137,37 @@ TEST_FUNCTION(IoTHubClient_Destroy_calls_IOTHUB_CLIENT_EVENT_CONFIRMATION_CALLBA
     // cleanup
 }
 
+/* Tests_SRS_IOTHUBCLIENT_09_032: [ Before taking the serializing lock, IoTHubClient_Destroy shall call callback_pool_shutdown so that the user callbacks already handed to the pool run while the client is still alive. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_033: [ After the worker thread is joined, IoTHubClient_Destroy shall destroy the callback pool by calling callback_pool_destroy. ]*/
+TEST_FUNCTION(IoTHubClient_Destroy_with_callback_pool_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = create_client_with_callback_pool();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(callback_pool_shutdown(TEST_CALLBACK_POOL_HANDLE));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_Destroy(IGNORED_PTR_ARG))
+        .IgnoreArgument_iotHubClientHandle();
+    STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(callback_pool_destroy(TEST_CALLBACK_POOL_HANDLE));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    // act
+    IoTHubClient_Destroy(iothub_handle);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
 
+/* Tests_SRS_IOTHUBCLIENT_01_011: [If iotHubClientHandle is NULL, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_INVALID_ARG.] */
 TEST_FUNCTION(IoTHubClient_SendEventAsync_handle_NULL_fail)
 {
     // arrange
@@ -989,8 +1186,12 @@ TEST_FUNCTION(IoTHubClient_SendEventAsync_handle_NULL_fail)
 }
 
 /* Tests_SRS_IOTHUBCLIENT_01_009: [IoTHubClient_SendEventAsync shall start the worker thread if it was not previously started.] */
-/* Tests_SRS_IOTHUBCLIENT_01_012: [IoTHubClient_SendEventAsync shall call IoTHubClient_LL_SendEventAsync, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameters eventMessageHandle, eventConfirmationCallback and userContextCallback.] */
-/* Tests_SRS_IOTHUBCLIENT_01_025: [IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+/* Tests_SRS_IOTHUBCLIENT_09_019: [ If the transport connection is not shared, IoTHubClient_SendEventAsync shall queue the event for the worker thread without acquiring the lock. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_021: [ IoTHubClient_SendEventAsync shall copy the event by calling IoTHubMessage_Clone and, if eventConfirmationCallback is not NULL, allocate a IOTHUB_QUEUE_CONTEXT for it. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_022: [ IoTHubClient_SendEventAsync shall queue the copy by calling mpsc_queue_push; if any of these steps fail it shall free what it allocated and return IOTHUB_CLIENT_ERROR. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_023: [ If the queue was empty before the push, the worker thread shall be woken up by calling Condition_Post. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_041: [ Before starting the worker thread the worker lock shall be created by calling Lock_Init. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_042: [ The worker thread shall be signaled while holding the worker lock, after setting the flag it checks under that lock before waiting. ]*/
 TEST_FUNCTION(IoTHubClient_SendEventAsync_succeed)
 {
     // arrange
@@ -1011,9 +1212,7 @@ TEST_FUNCTION(IoTHubClient_SendEventAsync_succeed)
 }
 
 /* Tests_SRS_IOTHUBCLIENT_01_010: [If starting the thread fails, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_ERROR.] */
-/* Tests_SRS_IOTHUBCLIENT_01_011: [If iotHubClientHandle is NULL, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_INVALID_ARG.] */
-/* Tests_SRS_IOTHUBCLIENT_01_013: [When IoTHubClient_LL_SendEventAsync is called, IoTHubClient_SendEventAsync shall return the result of IoTHubClient_LL_SendEventAsync.] */
-/* Tests_SRS_IOTHUBCLIENT_01_026: [If acquiring the lock fails, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_ERROR.] */
+/* Tests_SRS_IOTHUBCLIENT_09_022: [ IoTHubClient_SendEventAsync shall queue the copy by calling mpsc_queue_push; if any of these steps fail it shall free what it allocated and return IOTHUB_CLIENT_ERROR. ]*/
 TEST_FUNCTION(IoTHubClient_SendEventAsync_fail)
 {
     // arrange
@@ -1027,17 +1226,10 @@ TEST_FUNCTION(IoTHubClient_SendEventAsync_fail)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 3 };
-
     // act
     size_t count = umock_c_negative_tests_call_count();
     for (size_t index = 0; index < count; index++)
     {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail)/sizeof(calls_cannot_fail[0])) != 0)
-        {
-            continue;
-        }
-
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
@@ -1054,112 +1246,96 @@ TEST_FUNCTION(IoTHubClient_SendEventAsync_fail)
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_07_001: [ IoTHubClient_SendEventAsync shall allocate a IOTHUB_QUEUE_CONTEXT object to be sent to the IoTHubClient_LL_SendEventAsync function as a user context. ] */
-TEST_FUNCTION(IoTHubClient_SendEventAsync_event_confirm_callback_succeed)
+/* Tests_SRS_IOTHUBCLIENT_09_020: [ If eventMessageHandle is NULL, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_SendEventAsync_message_NULL_fail)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
-    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
-        .IgnoreArgument_elements();
-    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG) );
-
-    // act
-    g_eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, g_userContextCallback);
-
-    g_how_thread_loops = 1;
-
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
-    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
-
-    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-
-    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(1);
-        STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
-    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, NULL));
-    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     // act
-    ASSERT_IS_NOT_NULL(g_thread_func);
-    g_thread_func(g_thread_func_arg);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SendEventAsync(iothub_handle, NULL, test_event_confirmation_callback, NULL);
 
     // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-TEST_FUNCTION(IoTHubClient_GetSendStatus_iothub_handle_NULL_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_043: [ If eventConfirmationCallback is NULL and userContextCallback is not NULL, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_INVALID_ARG without queuing the event. ]*/
+TEST_FUNCTION(IoTHubClient_SendEventAsync_NULL_callback_with_context_fail)
 {
     // arrange
-    IOTHUB_CLIENT_STATUS iothub_status;
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetSendStatus(NULL, &iothub_status);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, NULL, (void*)0x42);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_023: [If iotHubClientHandle is NULL, IoTHubClient_ GetSendStatus shall return IOTHUB_CLIENT_INVALID_ARG.] */
-/* Tests_SRS_IOTHUBCLIENT_01_024: [Otherwise, IoTHubClient_GetSendStatus shall return the result of IoTHubClient_LL_GetSendStatus.] */
-/* Tests_SRS_IOTHUBCLIENT_01_034: [If acquiring the lock fails, IoTHubClient_GetSendStatus shall return IOTHUB_CLIENT_ERROR.] */
-TEST_FUNCTION(IoTHubClient_GetSendStatus_lock_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_021: [ IoTHubClient_SendEventAsync shall copy the event by calling IoTHubMessage_Clone and, if eventConfirmationCallback is not NULL, allocate a IOTHUB_QUEUE_CONTEXT for it. ]*/
+TEST_FUNCTION(IoTHubClient_SendEventAsync_no_callback_succeed)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
-    IOTHUB_CLIENT_STATUS iothub_status;
-
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle().SetReturn(LOCK_ERROR);
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the SEND_EVENT_REQUEST*/
+    STRICT_EXPECTED_CALL(IoTHubMessage_Clone(TEST_MESSAGE_HANDLE));
+    STRICT_EXPECTED_CALL(mpsc_queue_push(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetSendStatus(iothub_handle, &iothub_status);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, NULL, NULL);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_022: [IoTHubClient_GetSendStatus shall call IoTHubClient_LL_GetSendStatus, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameter iotHubClientStatus.] */
-/* Tests_SRS_IOTHUBCLIENT_01_033: [IoTHubClient_GetSendStatus shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
-TEST_FUNCTION(IoTHubClient_GetSendStatus_succeed)
+/* Tests_SRS_IOTHUBCLIENT_09_023: [ If the queue was empty before the push, the worker thread shall be woken up by calling Condition_Post. ]*/
+TEST_FUNCTION(IoTHubClient_SendEventAsync_queue_not_empty_does_not_wake_worker)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
     umock_c_reset_all_calls();
 
-    IOTHUB_CLIENT_STATUS iothub_status;
-
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, &iothub_status));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    setup_iothubclient_sendeventasync(false);
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetSendStatus(iothub_handle, &iothub_status);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
@@ -1169,92 +1345,596 @@ TEST_FUNCTION(IoTHubClient_GetSendStatus_succeed)
     IoTHubClient_Destroy(iothub_handle);
 }
 
-TEST_FUNCTION(IoTHubClient_SetMessageCallback_client_handle_NULL_fail)
+/* Tests_SRS_IOTHUBCLIENT_01_012: [IoTHubClient_SendEventAsync shall call IoTHubClient_LL_SendEventAsync, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameters eventMessageHandle, eventConfirmationCallback and userContextCallback.] */
+/* Tests_SRS_IOTHUBCLIENT_01_013: [When IoTHubClient_LL_SendEventAsync is called, IoTHubClient_SendEventAsync shall return the result of IoTHubClient_LL_SendEventAsync.] */
+/* Tests_SRS_IOTHUBCLIENT_01_025: [IoTHubClient_SendEventAsync shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+/* Tests_SRS_IOTHUBCLIENT_09_002: [ If the transport connection is shared, the worker thread shall be woken up by calling IoTHubTransport_WakeWorkerThread. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_035: [ Before starting the worker thread the statistics lock shall be created by calling Lock_Init. ]*/
+TEST_FUNCTION(IoTHubClient_SendEventAsync_shared_transport_succeed)
 {
     // arrange
+    IOTHUB_CLIENT_CONFIG client_config;
+    client_config.deviceId = TEST_DEVICE_ID;
+    client_config.deviceKey = TEST_DEVICE_KEY;
+    client_config.deviceSasToken = TEST_DEVICE_SAS;
+    client_config.protocol = TEST_TRANSPORT_PROVIDER;
+
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_CreateWithTransport(TEST_TRANSPORT_HANDLE, &client_config);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    STRICT_EXPECTED_CALL(IoTHubTransport_StartWorkerThread(TEST_TRANSPORT_HANDLE, iothub_handle, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SendEventAsync(TEST_IOTHUB_CLIENT_HANDLE, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL));
+    STRICT_EXPECTED_CALL(IoTHubTransport_WakeWorkerThread(TEST_TRANSPORT_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(NULL, test_message_confirmation_callback, NULL);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_014: [IoTHubClient_SetMessageCallback shall start the worker thread if it was not previously started.] */
-/* Tests_SRS_IOTHUBCLIENT_01_017: [IoTHubClient_SetMessageCallback shall call IoTHubClient_LL_SetMessageCallback, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameters messageCallback and userContextCallback.] */
-/* Tests_SRS_IOTHUBCLIENT_01_018: [When IoTHubClient_LL_SetMessageCallback is called, IoTHubClient_SetMessageCallback shall return the result of IoTHubClient_LL_SetMessageCallback.] */
-/* Tests_SRS_IOTHUBCLIENT_01_027: [IoTHubClient_SetMessageCallback shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
-/* Tests_SRS_IOTHUBCLIENT_25_087: [ `IoTHubClient_SetConnectionStatusCallback` shall be made thread-safe by using the lock created in `IoTHubClient_Create`. ] */
-/* Tests_SRS_IOTHUBCLIENT_25_086: [ When `IoTHubClient_LL_SetConnectionStatusCallback` is called, `IoTHubClient_SetConnectionStatusCallback` shall return the result of `IoTHubClient_LL_SetConnectionStatusCallback`.] */
-TEST_FUNCTION(IoTHubClient_SetMessageCallback_succeed)
+/* Tests_SRS_IOTHUBCLIENT_01_026: [If acquiring the lock fails, IoTHubClient_SendEventAsync shall return IOTHUB_CLIENT_ERROR.] */
+TEST_FUNCTION(IoTHubClient_SendEventAsync_shared_transport_Lock_fails)
 {
     // arrange
-    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    IOTHUB_CLIENT_CONFIG client_config;
+    client_config.deviceId = TEST_DEVICE_ID;
+    client_config.deviceKey = TEST_DEVICE_KEY;
+    client_config.deviceSasToken = TEST_DEVICE_SAS;
+    client_config.protocol = TEST_TRANSPORT_PROVIDER;
+
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_CreateWithTransport(TEST_TRANSPORT_HANDLE, &client_config);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    STRICT_EXPECTED_CALL(IoTHubTransport_StartWorkerThread(TEST_TRANSPORT_HANDLE, iothub_handle, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument_size();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetMessageCallback_Ex(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_messageCallback()
-        .IgnoreArgument_userContextCallback();
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+        .SetReturn(LOCK_ERROR);
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_015: [If starting the thread fails, IoTHubClient_SetMessageCallback shall return IOTHUB_CLIENT_ERROR.] */
-/* Tests_SRS_IOTHUBCLIENT_01_016: [If iotHubClientHandle is NULL, IoTHubClient_SetMessageCallback shall return IOTHUB_CLIENT_INVALID_ARG.] */
-/* Tests_SRS_IOTHUBCLIENT_01_028: [If acquiring the lock fails, IoTHubClient_SetMessageCallback shall return IOTHUB_CLIENT_ERROR.] */
-TEST_FUNCTION(IoTHubClient_SetMessageCallback_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_024: [ Before each call to IoTHubClient_LL_DoWork the thread shall drain the send queue by calling mpsc_queue_drain, handing each event's copy over to IoTHubClient_LL_SendEventAsync_TakeOwnership in the order they were queued. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_034: [ After each DoWork the worker thread shall call IoTHubClient_LL_GetStatistics and copy its result into the statistics snapshot while holding the statistics lock. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_sends_queued_events_succeed)
 {
     // arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, NULL, NULL);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)0x42);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument_size();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetMessageCallback_Ex(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_messageCallback()
-        .IgnoreArgument_userContextCallback();
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-
-    umock_c_negative_tests_snapshot();
+    g_how_thread_loops = 1;
 
-    // act
-    size_t count = umock_c_negative_tests_call_count();
-    for (size_t index = 0; index < count; index++)
-    {
-        if (index == 4)
-        {
-            continue;
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SendEventAsync_TakeOwnership(TEST_IOTHUB_CLIENT_HANDLE, TEST_CLONED_MESSAGE_HANDLE, NULL, NULL));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the SEND_EVENT_REQUEST, the copy now belongs to the LL layer*/
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SendEventAsync_TakeOwnership(TEST_IOTHUB_CLIENT_HANDLE, TEST_CLONED_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the SEND_EVENT_REQUEST, the copy now belongs to the LL layer*/
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    g_thread_func(g_thread_func_arg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_025: [ If IoTHubClient_LL_SendEventAsync_TakeOwnership fails for a queued event, its eventConfirmationCallback shall be invoked with IOTHUB_CLIENT_CONFIRMATION_ERROR and its copy shall be destroyed. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_queued_event_IoTHubClient_LL_SendEventAsync_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, (void*)0x42);
+    umock_c_reset_all_calls();
+
+    g_how_thread_loops = 1;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    setup_worker_sends_queued_event(IOTHUB_CLIENT_ERROR);
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_ERROR, (void*)0x42));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    g_thread_func(g_thread_func_arg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_07_001: [ IoTHubClient_SendEventAsync shall allocate a IOTHUB_QUEUE_CONTEXT object to be sent to the IoTHubClient_LL_SendEventAsync function as a user context. ] */
+TEST_FUNCTION(IoTHubClient_SendEventAsync_event_confirm_callback_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
+    run_worker_thread_once(); /*this hands the queued event to the IoTHubClient_LL layer*/
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1))
+        .IgnoreArgument_elements();
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG) );
+
+    // act
+    g_eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, g_userContextCallback);
+
+    g_how_thread_loops = 1;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(1);
+        STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, NULL));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    ASSERT_IS_NOT_NULL(g_thread_func);
+    g_thread_func(g_thread_func_arg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_029: [ If a callback pool was created, the worker thread shall hand each user callback to it by calling callback_pool_post instead of invoking the callback itself. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_030: [ Device method callbacks shall be posted as unordered work, every other user callback as ordered work, so that confirmations, twin updates, connection status changes and messages reach the application in the order they happened. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_posts_event_confirm_callback_to_pool)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = create_client_with_callback_pool();
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
+    run_worker_thread_once(); /*this hands the queued event to the IoTHubClient_LL layer*/
+    g_eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, g_userContextCallback);
+    umock_c_reset_all_calls();
+
+    setup_worker_dispatches_one_callback();
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the POOLED_USER_CALLBACK*/
+    STRICT_EXPECTED_CALL(callback_pool_post(TEST_CALLBACK_POOL_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, true));
+    setup_worker_waits();
+
+    // act
+    g_thread_func(g_thread_func_arg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // the user callback runs when the pool runs the work
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, NULL));
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the POOLED_USER_CALLBACK*/
+
+    ASSERT_IS_NOT_NULL(g_pool_work);
+    g_pool_work(g_pool_work_context);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_030: [ Device method callbacks shall be posted as unordered work, every other user callback as ordered work, so that confirmations, twin updates, connection status changes and messages reach the application in the order they happened. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_posts_device_method_callback_unordered)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = create_client_with_callback_pool();
+    (void)IoTHubClient_SetDeviceMethodCallback_Ex(iothub_handle, test_incoming_method_callback, NULL);
+    (void)g_inboundDeviceCallback(TEST_METHOD_NAME, TEST_DEVICE_METHOD_RESPONSE, TEST_DEVICE_RESP_LENGTH, TEST_METHOD_ID, g_userContextCallback);
+    umock_c_reset_all_calls();
+
+    setup_worker_dispatches_one_callback();
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the POOLED_USER_CALLBACK*/
+    STRICT_EXPECTED_CALL(callback_pool_post(TEST_CALLBACK_POOL_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, false));
+    setup_worker_waits();
+
+    // act
+    g_thread_func(g_thread_func_arg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    ASSERT_IS_NOT_NULL(g_pool_work);
+    g_pool_work(g_pool_work_context);
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_031: [ If handing a user callback to the callback pool fails, the callback shall be invoked on the worker thread. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_callback_pool_post_fails_invokes_callback)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = create_client_with_callback_pool();
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
+    run_worker_thread_once(); /*this hands the queued event to the IoTHubClient_LL layer*/
+    g_eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, g_userContextCallback);
+    umock_c_reset_all_calls();
+
+    setup_worker_dispatches_one_callback();
+    EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)); /*this is the POOLED_USER_CALLBACK*/
+    STRICT_EXPECTED_CALL(callback_pool_post(TEST_CALLBACK_POOL_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, true))
+        .SetReturn(__FAILURE__);
+    EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG)); /*this is the POOLED_USER_CALLBACK*/
+    STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, NULL));
+    setup_worker_waits();
+
+    // act
+    g_thread_func(g_thread_func_arg);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+TEST_FUNCTION(IoTHubClient_GetSendStatus_iothub_handle_NULL_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_STATUS iothub_status;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetSendStatus(NULL, &iothub_status);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+/* Tests_SRS_IOTHUBCLIENT_01_023: [If iotHubClientHandle is NULL, IoTHubClient_ GetSendStatus shall return IOTHUB_CLIENT_INVALID_ARG.] */
+/* Tests_SRS_IOTHUBCLIENT_01_024: [Otherwise, IoTHubClient_GetSendStatus shall return the result of IoTHubClient_LL_GetSendStatus.] */
+/* Tests_SRS_IOTHUBCLIENT_01_034: [If acquiring the lock fails, IoTHubClient_GetSendStatus shall return IOTHUB_CLIENT_ERROR.] */
+TEST_FUNCTION(IoTHubClient_GetSendStatus_lock_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATUS iothub_status;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle().SetReturn(LOCK_ERROR);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetSendStatus(iothub_handle, &iothub_status);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_01_022: [IoTHubClient_GetSendStatus shall call IoTHubClient_LL_GetSendStatus, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameter iotHubClientStatus.] */
+/* Tests_SRS_IOTHUBCLIENT_01_033: [IoTHubClient_GetSendStatus shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+TEST_FUNCTION(IoTHubClient_GetSendStatus_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATUS iothub_status;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, &iothub_status));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetSendStatus(iothub_handle, &iothub_status);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_010: [If iotHubClientHandle is NULL, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG.] */
+TEST_FUNCTION(IoTHubClient_GetStatistics_iothub_handle_NULL_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetStatistics(NULL, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_012: [If acquiring the lock fails, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_ERROR.] */
+TEST_FUNCTION(IoTHubClient_GetStatistics_lock_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle().SetReturn(LOCK_ERROR);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetStatistics(iothub_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_011: [IoTHubClient_GetStatistics shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+/* Tests_SRS_IOTHUBCLIENT_09_013: [IoTHubClient_GetStatistics shall call IoTHubClient_LL_GetStatistics, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameter statistics, and return its result.] */
+TEST_FUNCTION(IoTHubClient_GetStatistics_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, &statistics))
+        .SetReturn(IOTHUB_CLIENT_OK);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetStatistics(iothub_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_037: [ If statistics is NULL, IoTHubClient_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_GetStatistics_statistics_NULL_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetStatistics(iothub_handle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_034: [ After each DoWork the worker thread shall call IoTHubClient_LL_GetStatistics and copy its result into the statistics snapshot while holding the statistics lock. ]*/
+/* Tests_SRS_IOTHUBCLIENT_09_036: [ Once the worker thread has taken a statistics snapshot, IoTHubClient_GetStatistics shall copy the snapshot into statistics while holding the statistics lock, without taking the lock created in IoTHubClient_Create, and return IOTHUB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubClient_GetStatistics_returns_worker_snapshot_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATISTICS worker_statistics;
+    IOTHUB_CLIENT_STATISTICS statistics;
+    (void)memset(&worker_statistics, 0, sizeof(worker_statistics));
+    (void)memset(&statistics, 0, sizeof(statistics));
+    worker_statistics.messagesQueued = 3;
+    worker_statistics.waitingToSendCount = 1;
+    worker_statistics.waitingForAckCount = 2;
+
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_statistics(&worker_statistics, sizeof(worker_statistics));
+    run_worker_thread_once();
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the statistics lock*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetStatistics(iothub_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_TRUE(statistics.messagesQueued == 3);
+    ASSERT_IS_TRUE(statistics.waitingToSendCount == 1);
+    ASSERT_IS_TRUE(statistics.waitingForAckCount == 2);
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+TEST_FUNCTION(IoTHubClient_SetMessageCallback_client_handle_NULL_fail)
+{
+    // arrange
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(NULL, test_message_confirmation_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+/* Tests_SRS_IOTHUBCLIENT_01_014: [IoTHubClient_SetMessageCallback shall start the worker thread if it was not previously started.] */
+/* Tests_SRS_IOTHUBCLIENT_01_017: [IoTHubClient_SetMessageCallback shall call IoTHubClient_LL_SetMessageCallback, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameters messageCallback and userContextCallback.] */
+/* Tests_SRS_IOTHUBCLIENT_01_018: [When IoTHubClient_LL_SetMessageCallback is called, IoTHubClient_SetMessageCallback shall return the result of IoTHubClient_LL_SetMessageCallback.] */
+/* Tests_SRS_IOTHUBCLIENT_01_027: [IoTHubClient_SetMessageCallback shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+/* Tests_SRS_IOTHUBCLIENT_25_087: [ `IoTHubClient_SetConnectionStatusCallback` shall be made thread-safe by using the lock created in `IoTHubClient_Create`. ] */
+/* Tests_SRS_IOTHUBCLIENT_25_086: [ When `IoTHubClient_LL_SetConnectionStatusCallback` is called, `IoTHubClient_SetConnectionStatusCallback` shall return the result of `IoTHubClient_LL_SetConnectionStatusCallback`.] */
+TEST_FUNCTION(IoTHubClient_SetMessageCallback_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetMessageCallback_Ex(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_messageCallback()
+        .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_01_015: [If starting the thread fails, IoTHubClient_SetMessageCallback shall return IOTHUB_CLIENT_ERROR.] */
+/* Tests_SRS_IOTHUBCLIENT_01_016: [If iotHubClientHandle is NULL, IoTHubClient_SetMessageCallback shall return IOTHUB_CLIENT_INVALID_ARG.] */
+/* Tests_SRS_IOTHUBCLIENT_01_028: [If acquiring the lock fails, IoTHubClient_SetMessageCallback shall return IOTHUB_CLIENT_ERROR.] */
+TEST_FUNCTION(IoTHubClient_SetMessageCallback_fail)
+{
+    // arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetMessageCallback_Ex(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_messageCallback()
+        .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    umock_c_negative_tests_snapshot();
+
+    // act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        if (index == 7)
+        {
+            continue;
         }
-        else if (index == 2)
+        else if (index == 5)
         {
             g_fail_my_gballoc_malloc = true;
         }
-        else if (index == 3)
+        else if (index == 6)
         {
             my_IoTHubClient_LL_SetMessageCallback_Ex_result = IOTHUB_CLIENT_ERROR;
         }
@@ -1267,57 +1947,312 @@ TEST_FUNCTION(IoTHubClient_SetMessageCallback_fail)
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
-        char tmp_msg[64];
-        sprintf(tmp_msg, "IoTHubClient_SetMessageCallback failure in test %zu/%zu", index, count);
-        IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+        char tmp_msg[64];
+        sprintf(tmp_msg, "IoTHubClient_SetMessageCallback failure in test %zu/%zu", index, count);
+        IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+
+        // assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
+    }
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IOTHUBCLIENT_01_018: [When IoTHubClient_LL_SetMessageCallback_Ex is called, IoTHubClient_SetMessageCallback shall return the result of IoTHubClient_LL_SetMessageCallback_Ex.] */
+TEST_FUNCTION(IoTHubClient_SetMessageCallback_fails_if_SetMessageCallback_Ex_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetMessageCallback_Ex(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments()
+        .SetReturn(IOTHUB_CLIENT_ERROR);
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+        .IgnoreArgument_ptr();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_client_handle_NULL_fail)
+{
+    // arrange
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetConnectionStatusCallback(NULL, test_connection_status_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetConnectionStatusCallback(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_connectionStatusCallback()
+        .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetConnectionStatusCallback(iothub_handle, test_connection_status_callback, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_fail)
+{
+    // arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
+        .IgnoreArgument_size();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetConnectionStatusCallback(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreArgument_connectionStatusCallback()
+        .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    umock_c_negative_tests_snapshot();
+
+    // act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        if (index == 7)
+        {
+            continue;
+        }
+        else if (index == 5)
+        {
+            g_fail_my_gballoc_malloc = true;
+        }
+        else if (index == 6)
+        {
+            my_IoTHubClient_LL_SetConnectionStatusCallback_result = IOTHUB_CLIENT_ERROR;
+        }
+        else
+        {
+            my_IoTHubClient_LL_SetConnectionStatusCallback_result = IOTHUB_CLIENT_OK;
+            g_fail_my_gballoc_malloc = false;
+        }
+
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "IoTHubClient_SetConnectionStatusCallback failure in test %zu/%zu", index, count);
+        IOTHUB_CLIENT_RESULT result = IoTHubClient_SetConnectionStatusCallback(iothub_handle, test_connection_status_callback, NULL);
+
+        // assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
+    }
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+    umock_c_negative_tests_deinit();
+}
+
+/* Tests_SRS_IOTHUBCLIENT_25_076: [ If `iotHubClientHandle` is `NULL`, `IoTHubClient_SetRetryPolicy` shall return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_SetRetryPolicy_client_handle_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_RETRY_POLICY retry_policy = IOTHUB_CLIENT_RETRY_RANDOM;
+    size_t retry_in_seconds = 10;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetRetryPolicy(NULL, retry_policy, retry_in_seconds);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+/* Tests_SRS_IOTHUBCLIENT_25_078: [ When `IoTHubClient_LL_SetRetryPolicy` is called, `IoTHubClient_SetRetryPolicy` shall return the result of `IoTHubClient_LL_SetRetryPolicy`. ]*/
+TEST_FUNCTION(IoTHubClient_SetRetryPolicy_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_RETRY_POLICY retry_policy = IOTHUB_CLIENT_RETRY_RANDOM;
+    size_t retry_in_seconds = 10;
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetRetryPolicy(TEST_IOTHUB_CLIENT_HANDLE, retry_policy, retry_in_seconds))
+        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetRetryPolicy(iothub_handle, retry_policy, retry_in_seconds);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_25_092: [ If `iotHubClientHandle` is `NULL`, `IoTHubClient_GetRetryPolicy` shall return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
+TEST_FUNCTION(IoTHubClient_GetRetryPolicy_client_handle_NULL_fail)
+{
+    // arrange
+    IOTHUB_CLIENT_RETRY_POLICY retry_policy;
+    size_t retry_in_seconds;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetRetryPolicy(NULL, &retry_policy, &retry_in_seconds);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+/* Tests_SRS_IOTHUBCLIENT_25_094: [ When `IoTHubClient_LL_GetRetryPolicy` is called, `IoTHubClient_GetRetryPolicy` shall return the result of `IoTHubClient_LL_GetRetryPolicy`.]*/
+TEST_FUNCTION(IoTHubClient_GetRetryPolicy_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_RETRY_POLICY retry_policy;
+    size_t retry_in_seconds;
+
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
+    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetRetryPolicy(TEST_IOTHUB_CLIENT_HANDLE, &retry_policy, &retry_in_seconds));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
+        .IgnoreArgument_handle();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetRetryPolicy(iothub_handle, &retry_policy, &retry_in_seconds);
 
-        // assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
-    }
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
-    umock_c_negative_tests_deinit();
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_018: [When IoTHubClient_LL_SetMessageCallback_Ex is called, IoTHubClient_SetMessageCallback shall return the result of IoTHubClient_LL_SetMessageCallback_Ex.] */
-TEST_FUNCTION(IoTHubClient_SetMessageCallback_fails_if_SetMessageCallback_Ex_fails)
+TEST_FUNCTION(IoTHubClient_GetRetryPolicy_fail)
 {
     // arrange
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments();
+    IOTHUB_CLIENT_RETRY_POLICY retry_policy;
+    size_t retry_in_seconds;
+
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument_size();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetMessageCallback_Ex(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreAllArguments()
-        .SetReturn(IOTHUB_CLIENT_ERROR);
-    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
-        .IgnoreArgument_ptr();
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetRetryPolicy(TEST_IOTHUB_CLIENT_HANDLE, &retry_policy, &retry_in_seconds));
+
+    umock_c_negative_tests_snapshot();
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
 
-    // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
-    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        char tmp_msg[64];
+        sprintf(tmp_msg, "IoTHubClient_CreateFromConnectionString failure in test %zu/%zu", index, count);
+        IOTHUB_CLIENT_RESULT result = IoTHubClient_GetRetryPolicy(iothub_handle, &retry_policy, &retry_in_seconds);
+
+        // assert
+        ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
+    }
 
     // cleanup
+    umock_c_negative_tests_deinit();
     IoTHubClient_Destroy(iothub_handle);
 }
 
-TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_client_handle_NULL_fail)
+/* Tests_SRS_IOTHUBCLIENT_01_020: [If iotHubClientHandle is NULL, IoTHubClient_GetLastMessageReceiveTime shall return IOTHUB_CLIENT_INVALID_ARG.] */
+/* Tests_SRS_IOTHUBCLIENT_01_021: [Otherwise, IoTHubClient_GetLastMessageReceiveTime shall return the result of IoTHubClient_LL_GetLastMessageReceiveTime.] */
+/* Tests_SRS_IOTHUBCLIENT_01_036: [If acquiring the lock fails, IoTHubClient_GetLastMessageReceiveTime shall return IOTHUB_CLIENT_ERROR.] */
+TEST_FUNCTION(IoTHubClient_GetLastMessageReceiveTime_client_handle_NULL_fail)
 {
     // arrange
+    time_t recv_time;
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetConnectionStatusCallback(NULL, test_connection_status_callback, NULL);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetLastMessageReceiveTime(NULL, &recv_time);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
@@ -1326,25 +2261,24 @@ TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_client_handle_NULL_fail)
     // cleanup
 }
 
-TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_succeed)
+/* Tests_SRS_IOTHUBCLIENT_01_019: [IoTHubClient_GetLastMessageReceiveTime shall call IoTHubClient_LL_GetLastMessageReceiveTime, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameter lastMessageReceiveTime.] */
+/* Tests_SRS_IOTHUBCLIENT_01_035: [IoTHubClient_GetLastMessageReceiveTime shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
+TEST_FUNCTION(IoTHubClient_GetLastMessageReceiveTime_succeed)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
-    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    time_t recv_time;
+
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument_size();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetConnectionStatusCallback(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_connectionStatusCallback()
-        .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetLastMessageReceiveTime(TEST_IOTHUB_CLIENT_HANDLE, &recv_time));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetConnectionStatusCallback(iothub_handle, test_connection_status_callback, NULL);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetLastMessageReceiveTime(iothub_handle, &recv_time);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
@@ -1354,75 +2288,61 @@ TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_succeed)
     IoTHubClient_Destroy(iothub_handle);
 }
 
-TEST_FUNCTION(IoTHubClient_SetConnectionStatusCallback_fail)
+TEST_FUNCTION(IoTHubClient_GetLastMessageReceiveTime_failed)
 {
     // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
     int negativeTestsInitResult = umock_c_negative_tests_init();
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
-    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
-    umock_c_reset_all_calls();
+    time_t recv_time;
 
-    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-        .IgnoreArgument_size();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetConnectionStatusCallback(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument_connectionStatusCallback()
-        .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetLastMessageReceiveTime(TEST_IOTHUB_CLIENT_HANDLE, &recv_time));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
 
     umock_c_negative_tests_snapshot();
 
     // act
+    size_t calls_cannot_fail[] = { 2 };
+
     size_t count = umock_c_negative_tests_call_count();
     for (size_t index = 0; index < count; index++)
     {
-        if (index == 4)
+        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail)/sizeof(calls_cannot_fail[0])) != 0)
         {
             continue;
         }
-        else if (index == 2)
-        {
-            g_fail_my_gballoc_malloc = true;
-        }
-        else if (index == 3)
-        {
-            my_IoTHubClient_LL_SetConnectionStatusCallback_result = IOTHUB_CLIENT_ERROR;
-        }
-        else
-        {
-            my_IoTHubClient_LL_SetConnectionStatusCallback_result = IOTHUB_CLIENT_OK;
-            g_fail_my_gballoc_malloc = false;
-        }
 
         umock_c_negative_tests_reset();
         umock_c_negative_tests_fail_call(index);
 
         char tmp_msg[64];
-        sprintf(tmp_msg, "IoTHubClient_SetConnectionStatusCallback failure in test %zu/%zu", index, count);
-        IOTHUB_CLIENT_RESULT result = IoTHubClient_SetConnectionStatusCallback(iothub_handle, test_connection_status_callback, NULL);
+        sprintf(tmp_msg, "IoTHubClient_GetLastMessageReceiveTime failure in test %zu/%zu", index, count);
+        IOTHUB_CLIENT_RESULT result = IoTHubClient_GetLastMessageReceiveTime(iothub_handle, &recv_time);
 
         // assert
         ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
     }
 
     // cleanup
-    IoTHubClient_Destroy(iothub_handle);
     umock_c_negative_tests_deinit();
+    IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_25_076: [ If `iotHubClientHandle` is `NULL`, `IoTHubClient_SetRetryPolicy` shall return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
-TEST_FUNCTION(IoTHubClient_SetRetryPolicy_client_handle_fail)
+/*Tests_SRS_IOTHUBCLIENT_02_034: [If parameter iotHubClientHandle is NULL then IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
+TEST_FUNCTION(IoTHubClient_SetOption_client_handle_NULL_fail)
 {
     // arrange
-    IOTHUB_CLIENT_RETRY_POLICY retry_policy = IOTHUB_CLIENT_RETRY_RANDOM;
-    size_t retry_in_seconds = 10;
+    const char* option_name = "option_name";
+    const void* option_value = (void*)0x0123;
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetRetryPolicy(NULL, retry_policy, retry_in_seconds);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(NULL, option_name, option_value);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
@@ -1431,71 +2351,65 @@ TEST_FUNCTION(IoTHubClient_SetRetryPolicy_client_handle_fail)
     // cleanup
 }
 
-/* Tests_SRS_IOTHUBCLIENT_25_078: [ When `IoTHubClient_LL_SetRetryPolicy` is called, `IoTHubClient_SetRetryPolicy` shall return the result of `IoTHubClient_LL_SetRetryPolicy`. ]*/
-TEST_FUNCTION(IoTHubClient_SetRetryPolicy_succeed)
+/*Tests_SRS_IOTHUBCLIENT_02_035: [If parameter optionName is NULL then IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
+TEST_FUNCTION(IoTHubClient_SetOption_option_name_NULL_fail)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
-    IOTHUB_CLIENT_RETRY_POLICY retry_policy = IOTHUB_CLIENT_RETRY_RANDOM;
-    size_t retry_in_seconds = 10;
-
-    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetRetryPolicy(TEST_IOTHUB_CLIENT_HANDLE, retry_policy, retry_in_seconds))
-        .IgnoreArgument(2);
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    const void* option_value = (void*)0x0123;
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetRetryPolicy(iothub_handle, retry_policy, retry_in_seconds);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, NULL, option_value);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_25_092: [ If `iotHubClientHandle` is `NULL`, `IoTHubClient_GetRetryPolicy` shall return `IOTHUB_CLIENT_INVALID_ARG`. ]*/
-TEST_FUNCTION(IoTHubClient_GetRetryPolicy_client_handle_NULL_fail)
+/*Tests_SRS_IOTHUBCLIENT_02_036: [If parameter value is NULL then IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
+TEST_FUNCTION(IoTHubClient_SetOption_option_value_NULL_fail)
 {
     // arrange
-    IOTHUB_CLIENT_RETRY_POLICY retry_policy;
-    size_t retry_in_seconds;
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    umock_c_reset_all_calls();
+
+    const char* option_name = "option_name";
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetRetryPolicy(NULL, &retry_policy, &retry_in_seconds);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, option_name, NULL);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_25_094: [ When `IoTHubClient_LL_GetRetryPolicy` is called, `IoTHubClient_GetRetryPolicy` shall return the result of `IoTHubClient_LL_GetRetryPolicy`.]*/
-TEST_FUNCTION(IoTHubClient_GetRetryPolicy_succeed)
+/* Tests_SRS_IOTHUBCLIENT_02_038: [If optionName doesn't match one of the options handled by this module then IoTHubClient_SetOption shall call IoTHubClient_LL_SetOption passing the same parameters and return what IoTHubClient_LL_SetOption returns.] */
+/* Tests_SRS_IOTHUBCLIENT_01_041: [ IoTHubClient_SetOption shall be made thread-safe by using the lock created in IoTHubClient_Create. ] */
+TEST_FUNCTION(IoTHubClient_SetOption_succeed)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
-    IOTHUB_CLIENT_RETRY_POLICY retry_policy;
-    size_t retry_in_seconds;
+    const char* option_name = "option_name";
+    const void* option_value = (void*)0x0123;
 
-    EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetRetryPolicy(TEST_IOTHUB_CLIENT_HANDLE, &retry_policy, &retry_in_seconds));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetOption(TEST_IOTHUB_CLIENT_HANDLE, option_name, option_value));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetRetryPolicy(iothub_handle, &retry_policy, &retry_in_seconds);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, option_name, option_value);
 
     // assert
     ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
@@ -1505,214 +2419,347 @@ TEST_FUNCTION(IoTHubClient_GetRetryPolicy_succeed)
     IoTHubClient_Destroy(iothub_handle);
 }
 
-TEST_FUNCTION(IoTHubClient_GetRetryPolicy_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_008: [ Otherwise IoTHubClient_SetOption shall store the longest time the worker thread waits between two calls to IoTHubClient_LL_DoWork and return IOTHUB_CLIENT_OK. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_do_work_frequency_succeed)
 {
     // arrange
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
-
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+    unsigned int do_work_frequency = 250;
     umock_c_reset_all_calls();
 
-    IOTHUB_CLIENT_RETRY_POLICY retry_policy;
-    size_t retry_in_seconds;
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetRetryPolicy(TEST_IOTHUB_CLIENT_HANDLE, &retry_policy, &retry_in_seconds));
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_DO_WORK_FREQUENCY_IN_MS, &do_work_frequency);
 
-    umock_c_negative_tests_snapshot();
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // the worker thread now waits for at most the configured frequency
+    umock_c_reset_all_calls();
+    g_how_thread_loops = 1;
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, IGNORED_PTR_ARG, 250));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+
+    g_thread_func(g_thread_func_arg);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_006: [ If optionName is OPTION_DO_WORK_FREQUENCY_IN_MS and the value is 0, IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_do_work_frequency_zero_fails)
+{
+    // arrange
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    unsigned int do_work_frequency = 0;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    size_t count = umock_c_negative_tests_call_count();
-    for (size_t index = 0; index < count; index++)
-    {
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_DO_WORK_FREQUENCY_IN_MS, &do_work_frequency);
 
-        char tmp_msg[64];
-        sprintf(tmp_msg, "IoTHubClient_CreateFromConnectionString failure in test %zu/%zu", index, count);
-        IOTHUB_CLIENT_RESULT result = IoTHubClient_GetRetryPolicy(iothub_handle, &retry_policy, &retry_in_seconds);
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-        // assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
-    }
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_007: [ If the transport connection is shared, IoTHubClient_SetOption shall call IoTHubTransport_SetDoWorkFrequency, which takes the transport lock itself, without taking the lock created in IoTHubClient_Create, and return its result. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_do_work_frequency_shared_transport_succeed)
+{
+    // arrange
+    IOTHUB_CLIENT_CONFIG client_config;
+    client_config.deviceId = TEST_DEVICE_ID;
+    client_config.deviceKey = TEST_DEVICE_KEY;
+    client_config.deviceSasToken = TEST_DEVICE_SAS;
+    client_config.protocol = TEST_TRANSPORT_PROVIDER;
+
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_CreateWithTransport(TEST_TRANSPORT_HANDLE, &client_config);
+    unsigned int do_work_frequency = 250;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(IoTHubTransport_SetDoWorkFrequency(TEST_TRANSPORT_HANDLE, 250))
+        .SetReturn(IOTHUB_CLIENT_OK);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_DO_WORK_FREQUENCY_IN_MS, &do_work_frequency);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    umock_c_negative_tests_deinit();
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_020: [If iotHubClientHandle is NULL, IoTHubClient_GetLastMessageReceiveTime shall return IOTHUB_CLIENT_INVALID_ARG.] */
-/* Tests_SRS_IOTHUBCLIENT_01_021: [Otherwise, IoTHubClient_GetLastMessageReceiveTime shall return the result of IoTHubClient_LL_GetLastMessageReceiveTime.] */
-/* Tests_SRS_IOTHUBCLIENT_01_036: [If acquiring the lock fails, IoTHubClient_GetLastMessageReceiveTime shall return IOTHUB_CLIENT_ERROR.] */
-TEST_FUNCTION(IoTHubClient_GetLastMessageReceiveTime_client_handle_NULL_fail)
+static void setup_worker_loop_until_wait(void)
+{
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+}
+
+/* Tests_SRS_IOTHUBCLIENT_09_038: [ While IoTHubClient_LL_GetSendStatus reports IOTHUB_CLIENT_SEND_STATUS_BUSY, the thread shall wait at most 1 ms before calling IoTHubClient_LL_DoWork again. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_waits_1ms_while_busy)
 {
     // arrange
-    time_t recv_time;
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+    umock_c_reset_all_calls();
+    g_how_thread_loops = 1;
+    g_send_status = IOTHUB_CLIENT_SEND_STATUS_BUSY;
+
+    setup_worker_loop_until_wait();
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetLastMessageReceiveTime(NULL, &recv_time);
+    g_thread_func(g_thread_func_arg);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_01_019: [IoTHubClient_GetLastMessageReceiveTime shall call IoTHubClient_LL_GetLastMessageReceiveTime, while passing the IoTHubClient_LL handle created by IoTHubClient_Create and the parameter lastMessageReceiveTime.] */
-/* Tests_SRS_IOTHUBCLIENT_01_035: [IoTHubClient_GetLastMessageReceiveTime shall be made thread-safe by using the lock created in IoTHubClient_Create.] */
-TEST_FUNCTION(IoTHubClient_GetLastMessageReceiveTime_succeed)
+/* Tests_SRS_IOTHUBCLIENT_09_039: [ Otherwise, if IoTHubClient_LL_GetNextMessageTimeout returns IOTHUB_CLIENT_OK, the thread shall not wait past the earliest message timeout it reports. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_waits_until_next_message_timeout)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+    uint64_t ms_until_next_timeout = 20;
     umock_c_reset_all_calls();
+    g_how_thread_loops = 1;
 
-    time_t recv_time;
-
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetLastMessageReceiveTime(TEST_IOTHUB_CLIENT_HANDLE, &recv_time));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    setup_worker_loop_until_wait();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_msUntilNextTimeout(&ms_until_next_timeout, sizeof(ms_until_next_timeout))
+        .SetReturn(IOTHUB_CLIENT_OK);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, IGNORED_PTR_ARG, 20));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_GetLastMessageReceiveTime(iothub_handle, &recv_time);
+    g_thread_func(g_thread_func_arg);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-TEST_FUNCTION(IoTHubClient_GetLastMessageReceiveTime_failed)
+/* Tests_SRS_IOTHUBCLIENT_09_039: [ Otherwise, if IoTHubClient_LL_GetNextMessageTimeout returns IOTHUB_CLIENT_OK, the thread shall not wait past the earliest message timeout it reports. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_does_not_wait_when_a_message_timeout_is_due)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    (void)IoTHubClient_SetMessageCallback(iothub_handle, test_message_confirmation_callback, NULL);
+    uint64_t ms_until_next_timeout = 0;
     umock_c_reset_all_calls();
+    g_how_thread_loops = 1;
 
-    int negativeTestsInitResult = umock_c_negative_tests_init();
-    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+    setup_worker_loop_until_wait();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_msUntilNextTimeout(&ms_until_next_timeout, sizeof(ms_until_next_timeout))
+        .SetReturn(IOTHUB_CLIENT_OK);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    /*the next loop finds no message timing out and waits out the frequency*/
+    setup_worker_loop_until_wait();
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(TEST_COND_HANDLE, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
-    time_t recv_time;
+    // act
+    g_thread_func(g_thread_func_arg);
 
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetLastMessageReceiveTime(TEST_IOTHUB_CLIENT_HANDLE, &recv_time));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
-    umock_c_negative_tests_snapshot();
+    // cleanup
+    IoTHubClient_Destroy(iothub_handle);
+}
 
-    // act
-    size_t calls_cannot_fail[] = { 2 };
+/* Tests_SRS_IOTHUBCLIENT_09_040: [ If the transport connection is shared, the client shall return to the transport's worker thread how long it can wait before its next DoWork, computed as for an unshared connection. ]*/
+TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_ForMultiplexing_returns_time_until_next_message_timeout)
+{
+    // arrange
+    IOTHUB_CLIENT_CONFIG client_config;
+    client_config.deviceId = TEST_DEVICE_ID;
+    client_config.deviceKey = TEST_DEVICE_KEY;
+    client_config.deviceSasToken = TEST_DEVICE_SAS;
+    client_config.protocol = TEST_TRANSPORT_PROVIDER;
 
-    size_t count = umock_c_negative_tests_call_count();
-    for (size_t index = 0; index < count; index++)
-    {
-        if (should_skip_index(index, calls_cannot_fail, sizeof(calls_cannot_fail)/sizeof(calls_cannot_fail[0])) != 0)
-        {
-            continue;
-        }
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_CreateWithTransport(TEST_TRANSPORT_HANDLE, &client_config);
+    (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
+    uint64_t ms_until_next_timeout = 20;
+    umock_c_reset_all_calls();
 
-        umock_c_negative_tests_reset();
-        umock_c_negative_tests_fail_call(index);
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_msUntilNextTimeout(&ms_until_next_timeout, sizeof(ms_until_next_timeout))
+        .SetReturn(IOTHUB_CLIENT_OK);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
 
-        char tmp_msg[64];
-        sprintf(tmp_msg, "IoTHubClient_GetLastMessageReceiveTime failure in test %zu/%zu", index, count);
-        IOTHUB_CLIENT_RESULT result = IoTHubClient_GetLastMessageReceiveTime(iothub_handle, &recv_time);
+    // act
+    ASSERT_IS_NOT_NULL(g_mux_do_work);
+    unsigned int wait_time = g_mux_do_work(iothub_handle);
 
-        // assert
-        ASSERT_ARE_NOT_EQUAL_WITH_MSG(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result, tmp_msg);
-    }
+    // assert
+    ASSERT_ARE_EQUAL(int, 20, (int)wait_time);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
-    umock_c_negative_tests_deinit();
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_02_034: [If parameter iotHubClientHandle is NULL then IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
-TEST_FUNCTION(IoTHubClient_SetOption_client_handle_NULL_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_028: [ If optionName is OPTION_CALLBACK_THREAD_COUNT, IoTHubClient_SetOption shall create a callback pool with that many threads by calling callback_pool_create; if the value is 0 no pool is created and IoTHubClient_SetOption shall return IOTHUB_CLIENT_OK; if callback_pool_create fails it shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_callback_thread_count_succeed)
 {
     // arrange
-    const char* option_name = "option_name";
-    const void* option_value = (void*)0x0123;
+    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    size_t callback_thread_count = 4;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(callback_pool_create(4));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(NULL, option_name, option_value);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_CALLBACK_THREAD_COUNT, &callback_thread_count);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
+    IoTHubClient_Destroy(iothub_handle);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_02_035: [If parameter optionName is NULL then IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
-TEST_FUNCTION(IoTHubClient_SetOption_option_name_NULL_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_028: [ If optionName is OPTION_CALLBACK_THREAD_COUNT, IoTHubClient_SetOption shall create a callback pool with that many threads by calling callback_pool_create; if the value is 0 no pool is created and IoTHubClient_SetOption shall return IOTHUB_CLIENT_OK; if callback_pool_create fails it shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_callback_thread_count_zero_succeed)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    size_t callback_thread_count = 0;
     umock_c_reset_all_calls();
 
-    const void* option_value = (void*)0x0123;
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, NULL, option_value);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_CALLBACK_THREAD_COUNT, &callback_thread_count);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/*Tests_SRS_IOTHUBCLIENT_02_036: [If parameter value is NULL then IoTHubClient_SetOption shall return IOTHUB_CLIENT_INVALID_ARG.] */
-TEST_FUNCTION(IoTHubClient_SetOption_option_value_NULL_fail)
+/* Tests_SRS_IOTHUBCLIENT_09_028: [ If optionName is OPTION_CALLBACK_THREAD_COUNT, IoTHubClient_SetOption shall create a callback pool with that many threads by calling callback_pool_create; if the value is 0 no pool is created and IoTHubClient_SetOption shall return IOTHUB_CLIENT_OK; if callback_pool_create fails it shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_callback_thread_count_callback_pool_create_fails)
 {
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    size_t callback_thread_count = 4;
     umock_c_reset_all_calls();
 
-    const char* option_name = "option_name";
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(callback_pool_create(4))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, option_name, NULL);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_CALLBACK_THREAD_COUNT, &callback_thread_count);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
     IoTHubClient_Destroy(iothub_handle);
 }
 
-/* Tests_SRS_IOTHUBCLIENT_02_038: [If optionName doesn't match one of the options handled by this module then IoTHubClient_SetOption shall call IoTHubClient_LL_SetOption passing the same parameters and return what IoTHubClient_LL_SetOption returns.] */
-/* Tests_SRS_IOTHUBCLIENT_01_041: [ IoTHubClient_SetOption shall be made thread-safe by using the lock created in IoTHubClient_Create. ] */
-TEST_FUNCTION(IoTHubClient_SetOption_succeed)
+/* Tests_SRS_IOTHUBCLIENT_09_027: [ If optionName is OPTION_CALLBACK_THREAD_COUNT and a callback pool was already created, IoTHubClient_SetOption shall return IOTHUB_CLIENT_ERROR. ]*/
+TEST_FUNCTION(IoTHubClient_SetOption_callback_thread_count_twice_fails)
 {
     // arrange
-    IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
+    IOTHUB_CLIENT_HANDLE iothub_handle = create_client_with_callback_pool();
+    size_t callback_thread_count = 4;
     umock_c_reset_all_calls();
 
-    const char* option_name = "option_name";
-    const void* option_value = (void*)0x0123;
-
-    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
-    STRICT_EXPECTED_CALL(IoTHubClient_LL_SetOption(TEST_IOTHUB_CLIENT_HANDLE, option_name, option_value));
-    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
-        .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
     // act
-    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, option_name, option_value);
+    IOTHUB_CLIENT_RESULT result = IoTHubClient_SetOption(iothub_handle, OPTION_CALLBACK_THREAD_COUNT, &callback_thread_count);
 
     // assert
-    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
     // cleanup
@@ -1795,6 +2842,10 @@ TEST_FUNCTION(IoTHubClient_SetDeviceTwinCallback_succeed)
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -1913,6 +2964,10 @@ TEST_FUNCTION(IoTHubClient_SendReportedState_succeed)
 
     const unsigned char* reported_state = (const unsigned char*)0x1234;
 
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -1921,6 +2976,9 @@ TEST_FUNCTION(IoTHubClient_SendReportedState_succeed)
     STRICT_EXPECTED_CALL(IoTHubClient_LL_SendReportedState(TEST_IOTHUB_CLIENT_HANDLE, reported_state, 1, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
         .IgnoreArgument_reportedStateCallback()
         .IgnoreArgument_userContextCallback();
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Post(TEST_COND_HANDLE));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
 
@@ -2040,6 +3098,10 @@ TEST_FUNCTION(IoTHubClient_SetDeviceMethodCallback_succeed)
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -2072,6 +3134,10 @@ TEST_FUNCTION(IoTHubClient_SetDeviceMethodCallback_fail)
     ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
 
     umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -2087,11 +3153,11 @@ TEST_FUNCTION(IoTHubClient_SetDeviceMethodCallback_fail)
     {
         my_IoTHubClient_LL_SetDeviceMethodCallback_Ex_result = IOTHUB_CLIENT_OK;
 
-        if (index == 2)
+        if (index == 5)
         {
             continue;
         }
-        else if (index == 3)
+        else if (index == 6)
         {
             my_IoTHubClient_LL_SetDeviceMethodCallback_Ex_result = IOTHUB_CLIENT_ERROR;
         }
@@ -2137,6 +3203,10 @@ TEST_FUNCTION(IoTHubClient_SetDeviceMethodCallback_Ex_succeed)
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -2168,6 +3238,10 @@ TEST_FUNCTION(IoTHubClient_SetDeviceMethodCallback_Ex_NonNULL_callback_succeed)
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -2243,6 +3317,10 @@ TEST_FUNCTION(IoTHubClient_SetDeviceMethodCallback_Ex_remove_succeed)
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     umock_c_reset_all_calls();
 
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(mpsc_queue_create());
+    STRICT_EXPECTED_CALL(Lock_Init()); /*this is the statistics lock*/
     EXPECTED_CALL(ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
@@ -2433,11 +3511,21 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_VECTOR_move_FAILS
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG)).SetReturn(NULL);
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2462,13 +3550,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_STRING_construct_
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2496,13 +3594,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_BUFFER_create_FAI
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2532,13 +3640,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_VECTOR_push_back_
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2562,13 +3680,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_NULL_CONTEXT_fail
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2593,7 +3721,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_DMR_Fails)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -2610,7 +3742,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_DMR_Fails)
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2635,7 +3773,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_succeed)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -2652,7 +3794,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_method_callback_succeed)
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2680,7 +3828,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_repeated_method_callback_succeed)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -2698,7 +3850,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_repeated_method_callback_succeed)
     }
 
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2724,13 +3882,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_incoming_method_callback_STRING_c
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2758,13 +3926,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_incoming_method_callback_BUFFER_c
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2795,13 +3973,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_incoming_method_callback_VECTOR_p
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2825,13 +4013,23 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_incoming_method_callback_NULL_CON
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG)).SetReturn(0);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2856,7 +4054,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_incoming_method_callback_succeed)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -2869,7 +4071,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_incoming_method_callback_succeed)
     STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2897,7 +4105,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_repeated_incoming_method_callback
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -2915,7 +4127,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_repeated_incoming_method_callback
     }
 
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -2942,7 +4160,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_device_twin_succeed)
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
@@ -2957,7 +4179,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_device_twin_succeed)
     STRICT_EXPECTED_CALL(test_device_twin_callback(DEVICE_TWIN_UPDATE_COMPLETE, NULL, 0, NULL));
 
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
@@ -2984,6 +4212,7 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_event_confirm_succeed)
     // arrange
     IOTHUB_CLIENT_HANDLE iothub_handle = IoTHubClient_Create(TEST_CLIENT_CONFIG);
     (void)IoTHubClient_SendEventAsync(iothub_handle, TEST_MESSAGE_HANDLE, test_event_confirmation_callback, NULL);
+    run_worker_thread_once(); /*this hands the queued event to the IoTHubClient_LL layer*/
     g_eventConfirmationCallback(IOTHUB_CLIENT_CONFIRMATION_OK, g_userContextCallback);
     umock_c_reset_all_calls();
 
@@ -2991,7 +4220,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_event_confirm_succeed)
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
@@ -3003,7 +4236,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_event_confirm_succeed)
     STRICT_EXPECTED_CALL(test_event_confirmation_callback(IOTHUB_CLIENT_CONFIRMATION_OK, NULL));
 
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
@@ -3034,7 +4273,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_reported_state_succeed)
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
@@ -3046,7 +4289,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_reported_state_succeed)
     STRICT_EXPECTED_CALL(test_report_state_callback(REPORTED_STATE_STATUS_CODE, NULL));
 
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG))
         .IgnoreArgument_handle();
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG))
@@ -3076,7 +4325,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_message_callback_LOCK_Fails)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -3085,7 +4338,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_message_callback_LOCK_Fails)
     STRICT_EXPECTED_CALL(test_message_confirmation_callback(NULL, NULL));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)).SetReturn(LOCK_ERROR);
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -3115,7 +4374,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_message_callback_SMD_Fails)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -3126,7 +4389,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_message_callback_SMD_Fails)
     STRICT_EXPECTED_CALL(IoTHubClient_LL_SendMessageDisposition(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IOTHUBMESSAGE_ACCEPTED)).SetReturn(IOTHUB_CLIENT_ERROR);
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -3157,7 +4426,11 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_message_callback_succeed)
     g_how_thread_loops = 1;
 
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(mpsc_queue_drain(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(IoTHubClient_LL_DoWork(TEST_IOTHUB_CLIENT_HANDLE));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetStatistics(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_SLL_HANDLE));
     STRICT_EXPECTED_CALL(VECTOR_move(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
@@ -3168,7 +4441,13 @@ TEST_FUNCTION(IoTHubClient_ScheduleWork_Thread_message_callback_succeed)
     STRICT_EXPECTED_CALL(IoTHubClient_LL_SendMessageDisposition(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IOTHUBMESSAGE_ACCEPTED));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetSendStatus(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_LL_GetNextMessageTimeout(TEST_IOTHUB_CLIENT_HANDLE, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG)); /*this is the worker lock*/
+    STRICT_EXPECTED_CALL(Condition_Wait(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 100));
+    STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Lock(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(Unlock(IGNORED_PTR_ARG));
 
@@ -0,0 +1,11 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define mpsc_queue_create real_mpsc_queue_create
+#define mpsc_queue_push real_mpsc_queue_push
+#define mpsc_queue_drain real_mpsc_queue_drain
+#define mpsc_queue_destroy real_mpsc_queue_destroy
+
+#define GBALLOC_H
+
+#include "../../src/iothub_client_mpsc_queue.c"
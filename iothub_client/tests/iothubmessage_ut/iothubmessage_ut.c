@@ -109,6 +109,17 @@ static int my_mallocAndStrcpy_s(char** destination, const char* source)
     return 0;
 }
 
+static size_t g_releaseCallbackCount;
+static const unsigned char* g_releasedByteArray;
+static void* g_releasedContext;
+
+static void test_release_callback(const unsigned char* byteArray, void* releaseContext)
+{
+    g_releaseCallbackCount++;
+    g_releasedByteArray = byteArray;
+    g_releasedContext = releaseContext;
+}
+
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
 
@@ -179,6 +190,9 @@ TEST_FUNCTION_INITIALIZE(method_init)
     umock_c_reset_all_calls();
 
     g_mapFilterFunc = NULL;
+    g_releaseCallbackCount = 0;
+    g_releasedByteArray = NULL;
+    g_releasedContext = NULL;
 }
 
 TEST_FUNCTION_CLEANUP(method_cleanup)
@@ -310,6 +324,79 @@ TEST_FUNCTION(IoTHubMessage_CreateFromByteArray_fails)
     umock_c_negative_tests_deinit();
 }
 
+/*Tests_SRS_IOTHUBMESSAGE_09_002: [IoTHubMessage_CreateFromByteArrayNoCopy shall not copy byteArray; it shall keep byteArray, size, releaseCallback and releaseContext in a reference counted record.] */
+/*Tests_SRS_IOTHUBMESSAGE_09_003: [IoTHubMessage_CreateFromByteArrayNoCopy shall call Map_Create to create the message properties.] */
+/*Tests_SRS_IOTHUBMESSAGE_09_004: [Otherwise IoTHubMessage_CreateFromByteArrayNoCopy shall return a non-NULL handle of type IOTHUBMESSAGE_BYTEARRAY.] */
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArrayNoCopy_happy_path)
+{
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, test_release_callback, (void*)0x4243);
+
+    //assert
+    ASSERT_IS_NOT_NULL(h);
+    ASSERT_ARE_EQUAL(IOTHUBMESSAGE_CONTENT_TYPE, IOTHUBMESSAGE_BYTEARRAY, IoTHubMessage_GetContentType(h));
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_releaseCallbackCount);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_001: [If size is NOT zero and byteArray is NULL, IoTHubMessage_CreateFromByteArrayNoCopy shall fail and return NULL.] */
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArrayNoCopy_fails_when_size_non_zero_buffer_NULL)
+{
+    //arrange
+
+    //act
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(NULL, 1, test_release_callback, NULL);
+
+    //assert
+    ASSERT_IS_NULL(h);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_releaseCallbackCount);
+
+    //cleanup
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_005: [If there are any errors then IoTHubMessage_CreateFromByteArrayNoCopy shall return NULL and shall not invoke releaseCallback.] */
+TEST_FUNCTION(IoTHubMessage_CreateFromByteArrayNoCopy_fails)
+{
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    // arrange
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Create(IGNORED_PTR_ARG));
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "IoTHubMessage_CreateFromByteArrayNoCopy failure in test %zu/%zu", index, count);
+
+        IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, test_release_callback, NULL);
+
+        //assert
+        ASSERT_IS_NULL_WITH_MSG(h, tmp_msg);
+    }
+    ASSERT_ARE_EQUAL(size_t, 0, g_releaseCallbackCount);
+
+    //cleanup
+    umock_c_negative_tests_deinit();
+}
+
 /*Tests_SRS_IOTHUBMESSAGE_02_027: [IoTHubMessage_CreateFromString shall call STRING_construct passing source as parameter.] */
 /*Tests_SRS_IOTHUBMESSAGE_02_028: [IoTHubMessage_CreateFromString shall call Map_Create to create the message properties.] */
 /*Tests_SRS_IOTHUBMESSAGE_02_031: [Otherwise, IoTHubMessage_CreateFromString shall return a non-NULL handle.] */
@@ -491,6 +578,54 @@ TEST_FUNCTION(IoTHubMessage_Destroy_destroys_a_STRING_IoTHubMessage)
     //cleanup
 }
 
+/*Tests_SRS_IOTHUBMESSAGE_09_007: [When the last message referencing the borrowed buffer is destroyed, IoTHubMessage_Destroy shall invoke releaseCallback (if not NULL) passing byteArray and releaseContext.] */
+TEST_FUNCTION(IoTHubMessage_Destroy_NoCopy_message_invokes_release_callback)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, test_release_callback, (void*)0x4243);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(h));
+
+    //act
+    IoTHubMessage_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 1, g_releaseCallbackCount);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)c, (void*)g_releasedByteArray);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)0x4243, g_releasedContext);
+
+    //cleanup
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_09_007: [When the last message referencing the borrowed buffer is destroyed, IoTHubMessage_Destroy shall invoke releaseCallback (if not NULL) passing byteArray and releaseContext.] */
+TEST_FUNCTION(IoTHubMessage_Destroy_NoCopy_message_with_NULL_release_callback_succeeds)
+{
+    // arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, NULL, NULL);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Map_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(h));
+
+    //act
+    IoTHubMessage_Destroy(h);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(size_t, 0, g_releaseCallbackCount);
+
+    //cleanup
+}
+
 /*Tests_SRS_IOTHUBMESSAGE_01_011: [The pointer shall be obtained by using BUFFER_u_char and it shall be copied in the buffer argument.]*/
 /*Tests_SRS_IOTHUBMESSAGE_01_012: [The size of the associated data shall be obtained by using BUFFER_length and it shall be copied to the size argument.]*/
 /*Tests_SRS_IOTHUBMESSAGE_02_033: [IoTHubMessage_GetByteArray shall return IOTHUBMESSAGE_OK when all oeprations complete succesfully.] */
@@ -518,6 +653,28 @@ TEST_FUNCTION(IoTHubMessage_GetByteArray_happy_path)
     IoTHubMessage_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBMESSAGE_09_008: [If the message borrows its payload, IoTHubMessage_GetByteArray shall return the byteArray and size given to IoTHubMessage_CreateFromByteArrayNoCopy.] */
+TEST_FUNCTION(IoTHubMessage_GetByteArray_NoCopy_returns_the_borrowed_buffer)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, test_release_callback, NULL);
+    const unsigned char* byteArray;
+    size_t size;
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_MESSAGE_RESULT r = IoTHubMessage_GetByteArray(h, &byteArray, &size);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, r);
+    ASSERT_ARE_EQUAL(void_ptr, (void*)c, (void*)byteArray);
+    ASSERT_ARE_EQUAL(size_t, 1, size);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    ///cleanup
+    IoTHubMessage_Destroy(h);
+}
+
 /*Tests_SRS_IOTHUBMESSAGE_01_014: [If any of the arguments passed to IoTHubMessage_GetByteArray  is NULL IoTHubMessage_GetByteArray shall return IOTHUBMESSAGE_INVALID_ARG.] */
 TEST_FUNCTION(IoTHubMessage_GetByteArray_with_NULL_handle_fails)
 {
@@ -600,6 +757,75 @@ TEST_FUNCTION(IoTHubMessage_Clone_with_BYTE_ARRAY_happy_path)
     IoTHubMessage_Destroy(h);
 }
 
+/*Tests_SRS_IOTHUBMESSAGE_09_006: [If iotHubMessageHandle was created by IoTHubMessage_CreateFromByteArrayNoCopy, IoTHubMessage_Clone shall share the borrowed buffer with the clone by incrementing its reference count instead of copying it.] */
+/*Tests_SRS_IOTHUBMESSAGE_09_007: [When the last message referencing the borrowed buffer is destroyed, IoTHubMessage_Destroy shall invoke releaseCallback (if not NULL) passing byteArray and releaseContext.] */
+TEST_FUNCTION(IoTHubMessage_Clone_NoCopy_message_shares_the_borrowed_buffer)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, test_release_callback, NULL);
+    const unsigned char* byteArray;
+    size_t size;
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+
+    //assert
+    ASSERT_IS_NOT_NULL(r);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(IOTHUB_MESSAGE_RESULT, IOTHUB_MESSAGE_OK, IoTHubMessage_GetByteArray(r, &byteArray, &size));
+    ASSERT_ARE_EQUAL(void_ptr, (void*)c, (void*)byteArray);
+    ASSERT_ARE_EQUAL(size_t, 1, size);
+
+    IoTHubMessage_Destroy(h);
+    ASSERT_ARE_EQUAL(size_t, 0, g_releaseCallbackCount);
+    IoTHubMessage_Destroy(r);
+    ASSERT_ARE_EQUAL(size_t, 1, g_releaseCallbackCount);
+
+    ///cleanup
+}
+
+/*Tests_SRS_IOTHUBMESSAGE_03_004: [IoTHubMessage_Clone shall return NULL if it fails for any reason.]*/
+TEST_FUNCTION(IoTHubMessage_Clone_NoCopy_message_fails)
+{
+    //arrange
+    IOTHUB_MESSAGE_HANDLE h = IoTHubMessage_CreateFromByteArrayNoCopy(c, 1, test_release_callback, NULL);
+    umock_c_reset_all_calls();
+
+    int negativeTestsInitResult = umock_c_negative_tests_init();
+    ASSERT_ARE_EQUAL(int, 0, negativeTestsInitResult);
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(Map_Clone(IGNORED_PTR_ARG));
+
+    umock_c_negative_tests_snapshot();
+
+    //act
+    size_t count = umock_c_negative_tests_call_count();
+    for (size_t index = 0; index < count; index++)
+    {
+        umock_c_negative_tests_reset();
+        umock_c_negative_tests_fail_call(index);
+
+        char tmp_msg[64];
+        sprintf(tmp_msg, "IoTHubMessage_Clone_NoCopy failure in test %zu/%zu", index, count);
+
+        IOTHUB_MESSAGE_HANDLE r = IoTHubMessage_Clone(h);
+
+        //assert
+        ASSERT_IS_NULL_WITH_MSG(r, tmp_msg);
+    }
+    ASSERT_ARE_EQUAL(size_t, 0, g_releaseCallbackCount);
+
+    //cleanup
+    IoTHubMessage_Destroy(h);
+    ASSERT_ARE_EQUAL(size_t, 1, g_releaseCallbackCount);
+    umock_c_negative_tests_deinit();
+}
+
 TEST_FUNCTION(IoTHubMessage_Clone_handle_NULL_fail)
 {
     //arrange
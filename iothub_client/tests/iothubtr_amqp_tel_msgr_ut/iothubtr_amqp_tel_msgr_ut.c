@@ -375,6 +375,17 @@ static int TEST_message_create_from_iothub_message(IOTHUB_MESSAGE_HANDLE iothub_
     return TEST_message_create_from_iothub_message_return;
 }
 
+#define TEST_ENCODED_EVENT_SIZE                           32
+
+static int TEST_message_create_uamqp_encoding_from_iothub_message(IOTHUB_MESSAGE_HANDLE iothub_message, BINARY_DATA* encoded_message)
+{
+    (void)iothub_message;
+
+    encoded_message->bytes = (const unsigned char*)TEST_malloc(TEST_ENCODED_EVENT_SIZE);
+    encoded_message->length = TEST_ENCODED_EVENT_SIZE;
+
+    return 0;
+}
 
 static MESSAGE_HANDLE saved_IoTHubMessage_CreateFromUamqpMessage_uamqp_message;
 static int TEST_IoTHubMessage_CreateFromUamqpMessage_return;
@@ -722,8 +733,10 @@ static void set_expected_calls_for_telemetry_messenger_send_async()
 static IOTHUB_MESSAGE_LIST* TEST_on_event_send_complete_message;
 static TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT TEST_on_event_send_complete_result;
 static void* TEST_on_event_send_complete_context;
+static int TEST_on_event_send_complete_count;
 static void TEST_on_event_send_complete(IOTHUB_MESSAGE_LIST* message, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT result, void* context)
 {
+	TEST_on_event_send_complete_count++;
 	TEST_on_event_send_complete_message = message;
 	TEST_on_event_send_complete_result = result;
 	TEST_on_event_send_complete_context = context;
@@ -1183,6 +1196,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_SENDER_STATE_CHANGED, void*);
     REGISTER_UMOCK_ALIAS_TYPE(fields, void*);
     REGISTER_UMOCK_ALIAS_TYPE(MESSAGE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(BINARY_DATA, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_SEND_COMPLETE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(ON_MESSAGE_RECEIVED, void*);
@@ -1208,6 +1222,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_HOOK(messagereceiver_create, TEST_messagereceiver_create);
     REGISTER_GLOBAL_MOCK_HOOK(messagereceiver_open, TEST_messagereceiver_open);
     REGISTER_GLOBAL_MOCK_HOOK(message_create_from_iothub_message, TEST_message_create_from_iothub_message);
+    REGISTER_GLOBAL_MOCK_HOOK(message_create_uamqp_encoding_from_iothub_message, TEST_message_create_uamqp_encoding_from_iothub_message);
     REGISTER_GLOBAL_MOCK_HOOK(IoTHubMessage_CreateFromUamqpMessage, TEST_IoTHubMessage_CreateFromUamqpMessage);
 	REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_add, TEST_singlylinkedlist_add);
 	REGISTER_GLOBAL_MOCK_HOOK(singlylinkedlist_get_head_item, TEST_singlylinkedlist_get_head_item);
@@ -1256,6 +1271,17 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
     REGISTER_GLOBAL_MOCK_RETURN(message_create_from_iothub_message, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(message_create_from_iothub_message, 1);
 
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(message_create_uamqp_encoding_from_iothub_message, 1);
+
+    REGISTER_GLOBAL_MOCK_RETURN(message_create, TEST_MESSAGE_HANDLE);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(message_create, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(message_set_message_format, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(message_set_message_format, 1);
+
+    REGISTER_GLOBAL_MOCK_RETURN(message_add_body_amqp_data, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(message_add_body_amqp_data, 1);
+
     REGISTER_GLOBAL_MOCK_RETURN(amqpvalue_create_map, TEST_LINK_ATTACH_PROPERTIES);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(amqpvalue_create_map, NULL);
 
@@ -1379,6 +1405,7 @@ TEST_FUNCTION_INITIALIZE(TestMethodInitialize)
 
 	TEST_on_event_send_complete_message = NULL;
 	TEST_on_event_send_complete_result = TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_OK;
+	TEST_on_event_send_complete_count = 0;
 	TEST_on_event_send_complete_context = NULL;
 
 	TEST_DELIVERY_NUMBER = (delivery_number)1234;
@@ -1872,6 +1899,121 @@ TEST_FUNCTION(telemetry_messenger_do_work_send_events_success)
     telemetry_messenger_destroy(handle);
 }
 
+static void set_expected_calls_for_send_batched_events(int number_of_events_pending, time_t current_time)
+{
+	int i;
+	for (i = 0; i < number_of_events_pending; i++)
+	{
+		STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_WAIT_TO_SEND_LIST));
+		EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+		STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_WAIT_TO_SEND_LIST, IGNORED_PTR_ARG)).IgnoreArgument(2);
+		STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_IN_PROGRESS_LIST, IGNORED_PTR_ARG)).IgnoreArgument(2);
+		STRICT_EXPECTED_CALL(message_create_uamqp_encoding_from_iothub_message(TEST_IOTHUB_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+			.IgnoreArgument(2);
+
+		if (i == 0)
+		{
+			STRICT_EXPECTED_CALL(message_create());
+			STRICT_EXPECTED_CALL(message_set_message_format(TEST_MESSAGE_HANDLE, 0x80013700));
+		}
+
+		STRICT_EXPECTED_CALL(message_add_body_amqp_data(TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG))
+			.IgnoreArgument(2);
+		EXPECTED_CALL(free(IGNORED_PTR_ARG));
+	}
+
+	STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_WAIT_TO_SEND_LIST));
+	STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+	STRICT_EXPECTED_CALL(messagesender_send(TEST_MESSAGE_SENDER_HANDLE, TEST_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+		.IgnoreArgument(3).IgnoreArgument(4);
+	STRICT_EXPECTED_CALL(message_destroy(TEST_MESSAGE_HANDLE));
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_191: [If batching is enabled, each event shall be encoded using message_create_uamqp_encoding_from_iothub_message(), and if that fails completed with EVENT_SEND_COMPLETE_RESULT_ERROR_CANNOT_PARSE]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_192: [The batch shall be a MESSAGE_HANDLE created with message_create() and its message format set to 0x80013700 using message_set_message_format()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_194: [The batch shall be submitted using messagesender_send(), passing `internal_on_event_send_complete_callback` and the first event of the batch, and then destroyed using message_destroy()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_196: [If `instance->event_send_batching` is true, the pending events shall be sent in batches, otherwise one by one]
+TEST_FUNCTION(telemetry_messenger_do_work_send_batched_events_success)
+{
+	// arrange
+	TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+	TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+	bool batching = true;
+	ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_set_option(handle, MESSENGER_OPTION_EVENT_SEND_BATCHING, &batching));
+	ASSERT_ARE_EQUAL(int, 2, send_events(handle, 2));
+
+	time_t current_time = time(NULL);
+
+	umock_c_reset_all_calls();
+	STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_IN_PROGRESS_LIST)).SetReturn(NULL);
+	set_expected_calls_for_send_batched_events(2, current_time);
+
+	// act
+	telemetry_messenger_do_work(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(int, 0, TEST_on_event_send_complete_count);
+
+	// cleanup
+	telemetry_messenger_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_190: [If the event was sent in a batch, each event of the batch shall be completed individually]
+TEST_FUNCTION(telemetry_messenger_do_work_send_batched_events_on_send_complete_OK)
+{
+	// arrange
+	TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+	TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+	bool batching = true;
+	ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_set_option(handle, MESSENGER_OPTION_EVENT_SEND_BATCHING, &batching));
+	ASSERT_ARE_EQUAL(int, 2, send_events(handle, 2));
+	telemetry_messenger_do_work(handle);
+
+	umock_c_reset_all_calls();
+
+	// act
+	ASSERT_IS_NOT_NULL(saved_messagesender_send_on_message_send_complete);
+
+	saved_messagesender_send_on_message_send_complete(saved_messagesender_send_callback_context, MESSAGE_SEND_OK);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 2, TEST_on_event_send_complete_count);
+	ASSERT_ARE_EQUAL(int, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_OK, TEST_on_event_send_complete_result);
+	ASSERT_ARE_EQUAL(void_ptr, TEST_IOTHUB_CLIENT_HANDLE, TEST_on_event_send_complete_context);
+
+	// cleanup
+	telemetry_messenger_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_195: [If messagesender_send() fails, each event of the batch shall be completed with EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING]
+TEST_FUNCTION(telemetry_messenger_do_work_send_batched_events_messagesender_send_fails)
+{
+	// arrange
+	TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+	TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+	bool batching = true;
+	ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_set_option(handle, MESSENGER_OPTION_EVENT_SEND_BATCHING, &batching));
+	ASSERT_ARE_EQUAL(int, 2, send_events(handle, 2));
+
+	TEST_messagesender_send_result = 1;
+	umock_c_reset_all_calls();
+
+	// act
+	telemetry_messenger_do_work(handle);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 2, TEST_on_event_send_complete_count);
+	ASSERT_ARE_EQUAL(int, TELEMETRY_MESSENGER_EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING, TEST_on_event_send_complete_result);
+
+	// cleanup
+	TEST_messagesender_send_result = 0;
+	telemetry_messenger_destroy(handle);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_067: [If `instance->receive_messages` is true and `instance->message_receiver` is NULL, a message_receiver shall be created]  
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_068: [A variable, named `devices_path`, shall be created concatenating `instance->iothub_host_fqdn`, "/devices/" and `instance->device_id`]  
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_070: [A variable, named `message_receive_address`, shall be created concatenating "amqps://", `devices_path` and "/messages/devicebound"]  
@@ -2081,7 +2223,7 @@ TEST_FUNCTION(telemetry_messenger_do_work_destroy_message_receiver)
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_107: [If no failure occurs, `task->on_event_send_complete_callback` shall be invoked with result EVENT_SEND_COMPLETE_RESULT_OK]  
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_128: [`task` shall be removed from `instance->in_progress_list`]  
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be destroyed using free()]  
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be returned to the task pool while it holds fewer than `instance->message_pool_size` tasks, and destroyed using free() otherwise]  
 TEST_FUNCTION(telemetry_messenger_do_work_on_event_send_complete_OK)
 {
     // arrange
@@ -2114,7 +2256,7 @@ TEST_FUNCTION(telemetry_messenger_do_work_on_event_send_complete_OK)
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_108: [If a failure occurred, `task->on_event_send_complete_callback` shall be invoked with result EVENT_SEND_COMPLETE_RESULT_ERROR_FAIL_SENDING]  
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_128: [`task` shall be removed from `instance->in_progress_list`]  
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be destroyed using free()]  
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be returned to the task pool while it holds fewer than `instance->message_pool_size` tasks, and destroyed using free() otherwise]  
 TEST_FUNCTION(telemetry_messenger_do_work_on_event_send_complete_ERROR)
 {
     // arrange
@@ -2737,6 +2879,84 @@ TEST_FUNCTION(telemetry_messenger_set_option_EVENT_SEND_TIMEOUT_SECS)
 	telemetry_messenger_destroy(handle);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_197: [If name matches MESSENGER_OPTION_EVENT_SEND_BATCHING, `value` shall be saved on `instance->event_send_batching`]
+TEST_FUNCTION(telemetry_messenger_set_option_EVENT_SEND_BATCHING)
+{
+	// arrange
+	TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+	TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+	bool value = true;
+
+	// act
+	int result = telemetry_messenger_set_option(handle, MESSENGER_OPTION_EVENT_SEND_BATCHING, &value);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+
+	// cleanup
+	telemetry_messenger_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_199: [If name matches MESSENGER_OPTION_MESSAGE_POOL_SIZE, `value` shall be saved on `instance->message_pool_size` and the pooled tasks above that number shall be destroyed using free()]
+TEST_FUNCTION(telemetry_messenger_set_option_MESSAGE_POOL_SIZE)
+{
+	// arrange
+	TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+	TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+	size_t value = 16;
+	umock_c_reset_all_calls();
+
+	// act
+	int result = telemetry_messenger_set_option(handle, MESSENGER_OPTION_MESSAGE_POOL_SIZE, &value);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	telemetry_messenger_destroy(handle);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_130: [`task` shall be returned to the task pool while it holds fewer than `instance->message_pool_size` tasks, and destroyed using free() otherwise]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_198: [telemetry_messenger_send_async() shall reuse a task from the task pool when one is available]
+TEST_FUNCTION(telemetry_messenger_send_async_reuses_pooled_task)
+{
+	// arrange
+	TELEMETRY_MESSENGER_CONFIG* config = get_messenger_config();
+	TELEMETRY_MESSENGER_HANDLE handle = create_and_start_messenger2(config, false);
+
+	size_t pool_size = 1;
+	ASSERT_ARE_EQUAL(int, 0, telemetry_messenger_set_option(handle, MESSENGER_OPTION_MESSAGE_POOL_SIZE, &pool_size));
+
+	send_events(handle, 1);
+
+	time_t current_time = time(NULL);
+	MESSENGER_DO_WORK_EXP_CALL_PROFILE *mdwp = get_msgr_do_work_exp_call_profile(TELEMETRY_MESSENGER_STATE_STARTED, false, false, 1, 0, current_time, DEFAULT_EVENT_SEND_TIMEOUT_SECS);
+	crank_telemetry_messenger_do_work(handle, mdwp);
+
+	umock_c_reset_all_calls();
+	STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_IN_PROGRESS_LIST, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+		.IgnoreArgument_match_context()
+		.IgnoreArgument_match_function();
+	STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_IN_PROGRESS_LIST, IGNORED_PTR_ARG)).IgnoreArgument_item_handle();
+	EXPECTED_CALL(singlylinkedlist_add(TEST_IN_PROGRESS_LIST, IGNORED_PTR_ARG));
+
+	ASSERT_IS_NOT_NULL(saved_messagesender_send_on_message_send_complete);
+	saved_messagesender_send_on_message_send_complete(saved_messagesender_send_callback_context, MESSAGE_SEND_OK);
+
+	// act
+	int result = telemetry_messenger_send_async(handle, TEST_IOTHUB_MESSAGE_LIST_HANDLE, TEST_on_event_send_complete, TEST_IOTHUB_CLIENT_HANDLE);
+
+	// assert
+	ASSERT_ARE_EQUAL(int, 0, result);
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+	// cleanup
+	telemetry_messenger_destroy(handle);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_MESSENGER_09_169: [If name matches MESSENGER_OPTION_SAVED_OPTIONS, `value` shall be applied using OptionHandler_FeedOptions]
 TEST_FUNCTION(telemetry_messenger_set_option_SAVED_OPTIONS)
 {
@@ -154,16 +154,18 @@ static int TEST_cbs_put_token_async(CBS_HANDLE cbs, const char* type, const char
     return TEST_cbs_put_token_async_return;
 }
 
-char* TEST_IoTHubClient_Auth_Get_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, size_t expire_time)
+const char* TEST_IoTHubClient_Auth_Get_Cached_SasToken(IOTHUB_AUTHORIZATION_HANDLE handle, const char* scope, size_t expire_time)
 {
     (void)handle;
     (void)scope;
     (void)expire_time;
-    char* result;
-    size_t len = strlen(TEST_USER_DEFINED_SAS_TOKEN);
-    result = (char*)real_malloc(len+1);
-    strcpy(result, TEST_USER_DEFINED_SAS_TOKEN);
-    return result;
+    return TEST_USER_DEFINED_SAS_TOKEN;
+}
+
+size_t TEST_IoTHubClient_Auth_Get_SasToken_Refresh_Time(IOTHUB_AUTHORIZATION_HANDLE handle, size_t refresh_time)
+{
+    (void)handle;
+    return refresh_time;
 }
 
 #ifdef __cplusplus
@@ -235,7 +237,8 @@ static void register_global_mock_hooks()
     REGISTER_GLOBAL_MOCK_HOOK(malloc, TEST_malloc);
     REGISTER_GLOBAL_MOCK_HOOK(free, TEST_free);
     REGISTER_GLOBAL_MOCK_HOOK(cbs_put_token_async, TEST_cbs_put_token_async);
-    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Auth_Get_SasToken, TEST_IoTHubClient_Auth_Get_SasToken);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Auth_Get_Cached_SasToken, TEST_IoTHubClient_Auth_Get_Cached_SasToken);
+    REGISTER_GLOBAL_MOCK_HOOK(IoTHubClient_Auth_Get_SasToken_Refresh_Time, TEST_IoTHubClient_Auth_Get_SasToken_Refresh_Time);
 }
 
 static void register_global_mock_returns()
@@ -376,11 +379,12 @@ static void set_expected_calls_for_put_SAS_token_to_cbs(AUTHENTICATION_HANDLE ha
         STRICT_EXPECTED_CALL(get_difftime(current_time, IGNORED_NUM_ARG)).SetReturn(13245);
         STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
     }
-    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_SasToken(TEST_AUTHORIZATION_MODULE_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_Cached_SasToken(TEST_AUTHORIZATION_MODULE_HANDLE, IGNORED_PTR_ARG, IGNORED_NUM_ARG));
 
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICES_PATH_STRING_HANDLE)).SetReturn(TEST_DEVICES_PATH);
     STRICT_EXPECTED_CALL(cbs_put_token_async(TEST_CBS_HANDLE, SAS_TOKEN_TYPE, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, handle));
     STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(current_time);
+    STRICT_EXPECTED_CALL(IoTHubClient_Auth_Get_SasToken_Refresh_Time(TEST_AUTHORIZATION_MODULE_HANDLE, IGNORED_NUM_ARG));
 }
 
 static void set_expected_calls_for_create_and_put_sas_token(AUTHENTICATION_HANDLE handle, time_t current_time, AUTHENTICATION_DO_WORK_EXPECTED_STATE* exp_context)
@@ -416,7 +420,6 @@ static void set_expected_calls_for_authentication_do_work(AUTHENTICATION_CONFIG*
     {
         STRICT_EXPECTED_CALL(STRING_c_str(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
         set_expected_calls_for_put_SAS_token_to_cbs(handle, current_time, exp_context->sas_token_to_use);
-        STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
         STRICT_EXPECTED_CALL(STRING_delete(TEST_DEVICES_PATH_STRING_HANDLE));
     }
     else if (exp_context->current_state == AUTHENTICATION_STATE_STARTED)
@@ -876,7 +879,7 @@ TEST_FUNCTION(authentication_do_work_SAS_TOKEN_AUTHENTICATION_STATE_STARTING_suc
 }
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_042: [Otherwise, authentication_do_work() shall use device keys for CBS authentication]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using `IoTHubClient_Auth_Get_SasToken`, unless it has failed previously]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall get a SAS token using `IoTHubClient_Auth_Get_Cached_SasToken`, unless it has failed previously]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_052: [The SAS token expiration time shall be calculated adding `instance->sas_token_lifetime_secs` to the current number of seconds since epoch time UTC]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_053: [A STRING_HANDLE, referred to as `devices_path`, shall be created from the following parts: iothub_host_fqdn + "/devices/" + device_id]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_057: [authentication_do_work() shall set `instance->is_cbs_put_token_in_progress` to TRUE]
@@ -944,7 +947,7 @@ TEST_FUNCTION(authentication_do_work_SAS_TOKEN_on_cbs_put_token_callback_success
     authentication_destroy(handle);
 }
 
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall create a SAS token using `IoTHubClient_Auth_Get_SasToken`, unless it has failed previously]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_049: [authentication_do_work() shall get a SAS token using `IoTHubClient_Auth_Get_Cached_SasToken`, unless it has failed previously]
 TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_primary_key_only_fallback)
 {
     // arrange
@@ -1178,7 +1181,7 @@ TEST_FUNCTION(authentication_do_work_SAS_TOKEN_next_calls_no_op)
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_039: [If `instance->state` is AUTHENTICATION_STATE_STARTED and device keys were used, authentication_do_work() shall only verify the SAS token refresh time]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_023: [authentication_create() shall set `instance->sas_token_refresh_time_secs` with the default value of 30 minutes]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->sas_token_refresh_time_secs`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_065: [The SAS token shall be refreshed if the current time minus `instance->current_sas_token_put_time` equals or exceeds `instance->current_sas_token_refresh_time_secs`]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_066: [If SAS token does not need to be refreshed, authentication_do_work() shall return]
 TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh_check)
 {
@@ -1222,8 +1225,10 @@ TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh_check)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_073: [The SAS token shall be created using SASToken_Create(), passing the selected device key, device_path, sasTokenKeyName and expiration time as arguments]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_076: [The SAS token shall be sent to CBS using cbs_put_token_async(), using `servicebus.windows.net:sastoken` as token type, `devices_path` as audience and passing on_cbs_put_token_complete_callback]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_077: [If cbs_put_token_async() succeeds, authentication_do_work() shall set `instance->current_sas_token_put_time` with the current time]
-// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_081: [authentication_do_work() shall free the memory it allocated for `devices_path`, `sasTokenKeyName` and SAS token]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_081: [authentication_do_work() shall free the memory it allocated for `devices_path` and `sasTokenKeyName`; the SAS token stays owned by the authorization module]
 // Tests_SRSIOTHUBTRANSPORT_AMQP_AUTH_09_125: [If name matches AUTHENTICATION_OPTION_SAS_TOKEN_LIFETIME_SECS, `value` shall be saved on `instance->sas_token_lifetime_secs`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_130: [If cbs_put_token_async() succeeds while `instance->is_sas_token_refresh_in_progress` is TRUE, authentication_do_work() shall increment `instance->sas_token_refresh_count`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_132: [authentication_get_sas_token_refresh_count shall set `sas_token_refresh_count` to `instance->sas_token_refresh_count` and return 0]
 TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh)
 {
     // arrange
@@ -1255,6 +1260,11 @@ TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh)
     exp_state->sas_token_refresh_time_in_seconds = 10;
     exp_state->sastoken_expiration_time = (size_t)(difftime(next_time, (time_t)0) + 123);
 
+    uint64_t sas_token_refresh_count;
+    result = authentication_get_sas_token_refresh_count(handle, &sas_token_refresh_count);
+    ASSERT_ARE_EQUAL_WITH_MSG(int, 0, result, "authentication_get_sas_token_refresh_count failed!");
+    ASSERT_IS_TRUE_WITH_MSG(sas_token_refresh_count == 0, "the first authentication is not a refresh");
+
     umock_c_reset_all_calls();
     set_expected_calls_for_authentication_do_work(config, handle, next_time, exp_state);
 
@@ -1263,6 +1273,9 @@ TEST_FUNCTION(authentication_do_work_DEVICE_KEYS_sas_token_refresh)
 
     // assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    result = authentication_get_sas_token_refresh_count(handle, &sas_token_refresh_count);
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(sas_token_refresh_count == 1);
 
     // cleanup
     authentication_destroy(handle);
@@ -1602,4 +1615,40 @@ TEST_FUNCTION(authentication_retrieve_options_failure_checks)
     authentication_destroy(handle);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [If `authentication_handle` or `sas_token_refresh_count` is NULL, authentication_get_sas_token_refresh_count shall fail and return a non-zero value]
+TEST_FUNCTION(authentication_get_sas_token_refresh_count_NULL_handle)
+{
+    // arrange
+    uint64_t sas_token_refresh_count;
+    umock_c_reset_all_calls();
+
+    // act
+    int result = authentication_get_sas_token_refresh_count(NULL, &sas_token_refresh_count);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_AUTH_09_131: [If `authentication_handle` or `sas_token_refresh_count` is NULL, authentication_get_sas_token_refresh_count shall fail and return a non-zero value]
+TEST_FUNCTION(authentication_get_sas_token_refresh_count_NULL_sas_token_refresh_count)
+{
+    // arrange
+    AUTHENTICATION_CONFIG* config = get_auth_config(USE_DEVICE_KEYS);
+    AUTHENTICATION_HANDLE handle = create_and_start_authentication(config);
+    umock_c_reset_all_calls();
+
+    // act
+    int result = authentication_get_sas_token_refresh_count(handle, NULL);
+
+    // assert
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    authentication_destroy(handle);
+}
+
 END_TEST_SUITE(iothubtransport_amqp_cbs_auth_ut)
@@ -113,6 +113,7 @@ extern "C"
 #include "iothub_client_private.h"
 #include "iothub_client_version.h"
 #include "iothub_client_retry_control.h"
+#include "iothub_client_device_index.h"
 #include "iothubtransportamqp_methods.h"
 #include "iothubtransport_amqp_connection.h"
 #include "iothubtransport_amqp_device.h"
@@ -175,6 +176,16 @@ extern "C"
         return TEST_singlylinkedlist_add_fail_return ? NULL : (LIST_ITEM_HANDLE)item;
     }
 
+    // device_index
+    static int TEST_device_index_add_return = 0;
+    static int TEST_device_index_add(DEVICE_INDEX_HANDLE device_index, const char* device_id, void* device)
+    {
+        (void)device_index;
+        (void)device_id;
+        (void)device;
+        return TEST_device_index_add_return;
+    }
+
     static int TEST_singlylinkedlist_remove_return = 0;
     static int TEST_singlylinkedlist_remove(SINGLYLINKEDLIST_HANDLE list, LIST_ITEM_HANDLE item)
     {
@@ -394,8 +405,10 @@ static void on_umock_c_error(UMOCK_C_ERROR_CODE error_code)
 #define TEST_IOTHUB_HOST_FQDN_CLONE_STRING_HANDLE  (STRING_HANDLE)0x4265
 #define TEST_PROTOCOL_PROVIDER                     (IOTHUB_CLIENT_TRANSPORT_PROVIDER)0x4266
 #define TEST_REGISTERED_DEVICES_LIST               (SINGLYLINKEDLIST_HANDLE)0x4267
+#define TEST_REGISTERED_DEVICES_INDEX              (DEVICE_INDEX_HANDLE)0x4280
 #define TEST_DEVICE_ID_STRING_HANDLE               (STRING_HANDLE)0x4268
 #define TEST_DEVICE_HANDLE                         (DEVICE_HANDLE)0x4269
+#define TEST_DEVICE_HANDLE_2                       (DEVICE_HANDLE)0x4279
 #define TEST_LIST_ITEM_HANDLE                      (LIST_ITEM_HANDLE)0x4270
 #define TEST_AMQP_CONNECTION_HANDLE                (AMQP_CONNECTION_HANDLE)0x4271
 #define TEST_IOTHUB_MESSAGE_LIST_HANDLE            (IOTHUB_MESSAGE_LIST*)0x4272
@@ -441,6 +454,7 @@ static void set_expected_calls_for_Create(IOTHUBTRANSPORT_CONFIG* transport_conf
 
     STRICT_EXPECTED_CALL(singlylinkedlist_create())
         .SetReturn(TEST_REGISTERED_DEVICES_LIST);
+    STRICT_EXPECTED_CALL(device_index_create());
 }
 
 static void set_expected_calls_for_GetSendStatus(DEVICE_SEND_STATUS send_status)
@@ -456,14 +470,10 @@ static void set_expected_calls_for_GetHostname()
     STRICT_EXPECTED_CALL(STRING_clone(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE)).SetReturn(TEST_IOTHUB_HOST_FQDN_CLONE_STRING_HANDLE);
 }
 
-static void set_expected_calls_for_is_device_registered_ex(IOTHUB_DEVICE_CONFIG* device_config, IOTHUB_DEVICE_HANDLE registered_device)
+static void set_expected_calls_for_find_device_by_id(IOTHUB_DEVICE_CONFIG* device_config, IOTHUB_DEVICE_HANDLE registered_device)
 {
-    (void)device_config;
-
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2)
-        .IgnoreArgument(3)
-        .SetReturn((LIST_ITEM_HANDLE)registered_device);
+    STRICT_EXPECTED_CALL(device_index_find_by_id(TEST_REGISTERED_DEVICES_INDEX, device_config->deviceId))
+        .SetReturn((void*)registered_device);
 }
 
 static MESSAGE_DISPOSITION_CONTEXT* TRANSPORT_CONTEXT_DATA_create2(IOTHUB_DEVICE_HANDLE device_handle)
@@ -530,15 +540,16 @@ static void set_expected_calls_for_SendMessageDisposition(IOTHUBMESSAGE_DISPOSIT
 //     or NULL if the intent is to return "not registered".
 static void set_expected_calls_for_is_device_registered(IOTHUB_DEVICE_CONFIG* device_config, IOTHUB_DEVICE_HANDLE registered_device)
 {
-    STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
-        .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
+    (void)device_config;
 
-    set_expected_calls_for_is_device_registered_ex(device_config, registered_device);
+    STRICT_EXPECTED_CALL(device_index_contains(TEST_REGISTERED_DEVICES_INDEX, IGNORED_PTR_ARG))
+        .IgnoreArgument_device()
+        .SetReturn(registered_device != NULL);
 }
 
 static void set_expected_calls_for_Register(IOTHUB_DEVICE_CONFIG* device_config, bool is_using_cbs)
 {
-    set_expected_calls_for_is_device_registered_ex(device_config, NULL);
+    set_expected_calls_for_find_device_by_id(device_config, NULL);
 
     // is_device_credential_acceptable
     // Nothing to expect.
@@ -574,6 +585,8 @@ static void set_expected_calls_for_Register(IOTHUB_DEVICE_CONFIG* device_config,
             .IgnoreArgument(3);
     }
 
+    STRICT_EXPECTED_CALL(device_index_add(TEST_REGISTERED_DEVICES_INDEX, device_config->deviceId, IGNORED_PTR_ARG))
+        .IgnoreArgument_device();
     STRICT_EXPECTED_CALL(singlylinkedlist_add(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG))
         .IgnoreArgument(2);
     STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
@@ -584,13 +597,12 @@ static void set_expected_calls_for_Unregister(IOTHUB_DEVICE_HANDLE iothub_device
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
         .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-        .IgnoreArgument(2)
-        .IgnoreArgument(3)
-        .SetReturn((LIST_ITEM_HANDLE)iothub_device_handle);
+    STRICT_EXPECTED_CALL(device_index_contains(TEST_REGISTERED_DEVICES_INDEX, iothub_device_handle))
+        .SetReturn(true);
 
     STRICT_EXPECTED_CALL(singlylinkedlist_remove(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG))
         .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(device_index_remove(TEST_REGISTERED_DEVICES_INDEX, iothub_device_handle));
 
 #ifdef WIP_C2D_METHODS_AMQP /* This feature is WIP, do not use yet */
     STRICT_EXPECTED_CALL(iothubtransportamqp_methods_destroy(TEST_IOTHUBTRANSPORTAMQP_METHODS));
@@ -641,6 +653,8 @@ static void set_expected_calls_for_send_pending_events(PDLIST_ENTRY wts, int exp
     {
         STRICT_EXPECTED_CALL(DList_IsListEmpty(wts));
         EXPECTED_CALL(DList_RemoveEntryList(IGNORED_PTR_ARG));
+        EXPECTED_CALL(IoTHubMessage_GetContentType(IGNORED_PTR_ARG));
+        EXPECTED_CALL(IoTHubMessage_GetByteArray(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
 
         STRICT_EXPECTED_CALL(device_send_event_async(TEST_DEVICE_HANDLE, TEST_IOTHUB_MESSAGE_LIST_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
             .IgnoreArgument(3)
@@ -747,6 +761,25 @@ static void set_expected_calls_for_DoWork(PDLIST_ENTRY wts, int wts_length, DEVI
     set_expected_calls_for_DoWork2(wts, wts_length, current_device_state, is_tls_io_acquired, false /* feed_options */, is_using_cbs, is_connection_created, is_connection_open, number_of_registered_devices, current_time, subscribe_for_methods);
 }
 
+static void set_expected_calls_for_device_start_scan(PDLIST_ENTRY* wts, bool* is_waiting_to_start, int number_of_registered_devices)
+{
+    int i;
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+
+    for (i = 0; i < number_of_registered_devices; i++)
+    {
+        EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+
+        if (is_waiting_to_start[i])
+        {
+            STRICT_EXPECTED_CALL(DList_IsListEmpty(wts[i]));
+        }
+
+        EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    }
+}
+
 static void set_expected_calls_for_Destroy(int number_of_registered_devices, IOTHUB_DEVICE_HANDLE* registered_devices)
 {
     STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
@@ -760,6 +793,7 @@ static void set_expected_calls_for_Destroy(int number_of_registered_devices, IOT
     }
     
     STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(device_index_destroy(TEST_REGISTERED_DEVICES_INDEX));
     STRICT_EXPECTED_CALL(amqp_connection_destroy(TEST_AMQP_CONNECTION_HANDLE));
     STRICT_EXPECTED_CALL(xio_destroy(TEST_UNDERLYING_IO_TRANSPORT));
     STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
@@ -1067,6 +1101,7 @@ static void register_umock_alias_types()
     REGISTER_UMOCK_ALIAS_TYPE(CONNECTION_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(delivery_number, int);
     REGISTER_UMOCK_ALIAS_TYPE(DEVICE_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DEVICE_INDEX_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(DEVICE_CONFIG, void*);
     REGISTER_UMOCK_ALIAS_TYPE(DEVICE_MESSAGE_DISPOSITION_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(DEVICE_SEND_STATUS, int);
@@ -1199,6 +1234,8 @@ static void register_global_mock_returns()
 
     REGISTER_GLOBAL_MOCK_RETURN(device_get_send_status, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_get_send_status, 1);
+    REGISTER_GLOBAL_MOCK_RETURN(device_get_sas_token_refresh_count, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_get_sas_token_refresh_count, 1);
 
     REGISTER_GLOBAL_MOCK_RETURN(device_send_message_disposition, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_send_message_disposition, 1);
@@ -1208,6 +1245,16 @@ static void register_global_mock_returns()
 
     REGISTER_GLOBAL_MOCK_RETURN(retry_control_create, TEST_RETRY_CONTROL_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(retry_control_create, NULL);
+
+    REGISTER_GLOBAL_MOCK_RETURN(device_index_create, TEST_REGISTERED_DEVICES_INDEX);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_index_create, NULL);
+
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_add, TEST_device_index_add);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_index_add, 1);
+
+    REGISTER_GLOBAL_MOCK_RETURN(device_index_remove, 0);
+    REGISTER_GLOBAL_MOCK_RETURN(device_index_find_by_id, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(device_index_contains, true);
 }
 
 static void initialize_static_variables()
@@ -1241,6 +1288,7 @@ static void initialize_static_variables()
 
     TEST_MESSAGE_ID = (delivery_number)1234;
     TEST_mallocAndStrcpy_s_return = 0;
+    TEST_device_index_add_return = 0;
 }
 
 static void initialize_test_variables()
@@ -1983,6 +2031,7 @@ TEST_FUNCTION(GetHostName_success)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_010: [`get_io_transport` shall be saved on `instance->underlying_io_transport_provider`]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_012: [If IoTHubTransport_AMQP_Common_Create succeeds it shall return a pointer to `instance`.]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_124: [`instance->connection_retry_control` shall be set using retry_control_create(), passing defaults EXPONENTIAL_BACKOFF_WITH_JITTER and 0]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_141: [`instance->registered_devices_index` shall be set using device_index_create()]
 TEST_FUNCTION(Create_success)
 {
     // arrange
@@ -2009,6 +2058,7 @@ TEST_FUNCTION(Create_success)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_009: [If singlylinkedlist_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_011: [If IoTHubTransport_AMQP_Common_Create fails it shall free any memory it allocated]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_125: [If retry_control_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_142: [If device_index_create() fails, IoTHubTransport_AMQP_Common_Create shall fail and return NULL]
 TEST_FUNCTION(Create_failure_checks)
 {
     // arrange
@@ -2175,6 +2225,7 @@ TEST_FUNCTION(Register_NULL_config_device_id)
 }
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_064: [If the device is already registered, IoTHubTransport_AMQP_Common_Register shall fail and return NULL.]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_143: [The device shall be looked up by id using device_index_find_by_id() on `instance->registered_devices_index`]
 TEST_FUNCTION(Register_device_already_registered)
 {
     // arrange
@@ -2183,9 +2234,8 @@ TEST_FUNCTION(Register_device_already_registered)
 
     IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, device_config->deviceId))
-        .IgnoreArgument(2)
-        .SetReturn(TEST_LIST_ITEM_HANDLE);
+    STRICT_EXPECTED_CALL(device_index_find_by_id(TEST_REGISTERED_DEVICES_INDEX, device_config->deviceId))
+        .SetReturn((void*)TEST_LIST_ITEM_HANDLE);
 
     // act
     IOTHUB_DEVICE_HANDLE device_handle = IoTHubTransport_AMQP_Common_Register(handle, device_config, TEST_IOTHUB_CLIENT_LL_HANDLE, &TEST_waitingToSend);
@@ -2214,8 +2264,7 @@ TEST_FUNCTION(Register_CBS_transport_X509_credentials)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, device_config2->deviceId))
-        .IgnoreArgument(2)
+    STRICT_EXPECTED_CALL(device_index_find_by_id(TEST_REGISTERED_DEVICES_INDEX, device_config2->deviceId))
         .SetReturn(NULL);
 
     // act
@@ -2246,8 +2295,7 @@ TEST_FUNCTION(Register_X509_transport_CBS_credentials)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(singlylinkedlist_find(TEST_REGISTERED_DEVICES_LIST, IGNORED_PTR_ARG, device_config2->deviceId))
-        .IgnoreArgument(2)
+    STRICT_EXPECTED_CALL(device_index_find_by_id(TEST_REGISTERED_DEVICES_INDEX, device_config2->deviceId))
         .SetReturn(NULL);
 
     // act
@@ -2310,6 +2358,28 @@ TEST_FUNCTION(Register_failure_checks)
     destroy_transport(handle, NULL, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_145: [If device_index_add() fails, IoTHubTransport_AMQP_Common_Register shall fail and return NULL]
+TEST_FUNCTION(Register_device_index_add_fails)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+
+    umock_c_reset_all_calls();
+    TEST_device_index_add_return = 1;
+
+    // act
+    IOTHUB_DEVICE_HANDLE device_handle = IoTHubTransport_AMQP_Common_Register(handle, device_config, TEST_IOTHUB_CLIENT_LL_HANDLE, &TEST_waitingToSend);
+
+    // assert
+    ASSERT_IS_NULL(device_handle);
+    ASSERT_ARE_EQUAL(int, 0, saved_registered_devices_list_count);
+
+    // cleanup
+    destroy_transport(handle, NULL, NULL);
+}
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_066: [IoTHubTransport_AMQP_Common_Register shall allocate an instance of AMQP_TRANSPORT_DEVICE_STATE to store the state of the new registered device.]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_068: [IoTHubTransport_AMQP_Common_Register shall save the handle references to the IoTHubClient, transport, waitingToSend list on `amqp_device_instance`.]
@@ -2318,6 +2388,7 @@ TEST_FUNCTION(Register_failure_checks)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_072: [The configuration for device_create shall be set according to the authentication preferred by IOTHUB_DEVICE_CONFIG]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_010: [ `IoTHubTransport_AMQP_Common_Register` shall create a new iothubtransportamqp_methods instance by calling `iothubtransportamqp_methods_create` while passing to it the the fully qualified domain name and the device Id]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_074: [IoTHubTransport_AMQP_Common_Register shall add the `amqp_device_instance` to `instance->registered_devices`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_144: [IoTHubTransport_AMQP_Common_Register shall add the `amqp_device_instance` to `instance->registered_devices_index` using device_index_add()]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_076: [If the device is the first being registered on the transport, IoTHubTransport_AMQP_Common_Register shall save its authentication mode as the transport preferred authentication mode]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_078: [IoTHubTransport_AMQP_Common_Register shall return a handle to `amqp_device_instance` as a IOTHUB_DEVICE_HANDLE]
 TEST_FUNCTION(Register_succeeds)
@@ -2526,6 +2597,174 @@ TEST_FUNCTION(Unsubscribe_messages_succeeds)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_132: [If `handle` or `statistics` are NULL, IoTHubTransport_AMQP_Common_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG]
+TEST_FUNCTION(GetStatistics_NULL_handle)
+{
+    // arrange
+    initialize_test_variables();
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetStatistics(NULL, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_133: [IoTHubTransport_AMQP_Common_GetStatistics shall set `messagesSent` to the number of events of the device sent with device_send_event_async() and `reconnectCount` to the number of reconnections of the transport]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_147: [IoTHubTransport_AMQP_Common_GetStatistics shall set `waitingForAckCount` to the number of events of the device taken from `waiting_to_send` whose send has not completed yet]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_134: [IoTHubTransport_AMQP_Common_GetStatistics shall set `sasTokenRefreshCount` using device_get_sas_token_refresh_count()]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_154: [IoTHubTransport_AMQP_Common_GetStatistics shall set `bytesSent` and `bytesReceived` to the payload bytes of the events sent and the messages received by the device]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_135: [If no failures occur, IoTHubTransport_AMQP_Common_GetStatistics shall return IOTHUB_CLIENT_OK]
+TEST_FUNCTION(GetStatistics_after_register_success)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+    (void)memset(&statistics, 0xFF, sizeof(statistics));
+    uint64_t sas_token_refresh_count = 2;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(device_get_sas_token_refresh_count(TEST_DEVICE_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_sas_token_refresh_count(&sas_token_refresh_count, sizeof(sas_token_refresh_count));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetStatistics(device_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_IS_TRUE(statistics.messagesSent == 0);
+    ASSERT_IS_TRUE(statistics.bytesSent == 0);
+    ASSERT_IS_TRUE(statistics.bytesReceived == 0);
+    ASSERT_IS_TRUE(statistics.reconnectCount == 0);
+    ASSERT_IS_TRUE(statistics.sasTokenRefreshCount == 2);
+    ASSERT_IS_TRUE(statistics.waitingForAckCount == 0);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_153: [If device_get_sas_token_refresh_count() fails, IoTHubTransport_AMQP_Common_GetStatistics shall return IOTHUB_CLIENT_ERROR]
+TEST_FUNCTION(GetStatistics_device_get_sas_token_refresh_count_fails)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(device_get_sas_token_refresh_count(TEST_DEVICE_HANDLE, IGNORED_PTR_ARG))
+        .SetReturn(1);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetStatistics(device_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_151: [If device_send_event_async() succeeds, the payload size of the event shall be added to the bytes sent by the device]
+TEST_FUNCTION(GetStatistics_counts_the_payload_bytes_of_the_events_sent)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    crank_transport_ready_after_create(handle, &TEST_waitingToSend, 0, false, true, 1, TEST_current_time, false);
+
+    IOTHUB_MESSAGE_LIST event;
+    event.messageHandle = TEST_IOTHUB_MESSAGE_HANDLE;
+    real_DList_InsertTailList(&TEST_waitingToSend, &event.entry);
+
+    size_t payload_size = 5;
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn(IOTHUBMESSAGE_BYTEARRAY);
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_IOTHUB_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_size(&payload_size, sizeof(payload_size));
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetStatistics(device_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_IS_TRUE(statistics.messagesSent == 1);
+    ASSERT_IS_TRUE(statistics.bytesSent == 5);
+    ASSERT_IS_TRUE(statistics.bytesReceived == 0);
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_152: [The payload size of `message` shall be added to the bytes received by the device]
+TEST_FUNCTION(GetStatistics_counts_the_payload_bytes_of_the_messages_received)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_Subscribe(device_config, device_handle);
+    (void)IoTHubTransport_AMQP_Common_Subscribe(device_handle);
+
+    DEVICE_MESSAGE_DISPOSITION_INFO disposition_info;
+    disposition_info.source = "some link source name";
+    disposition_info.message_id = TEST_MESSAGE_ID;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn(IOTHUBMESSAGE_STRING);
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetString(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn("payload");
+    g_MessageCallback_return = true;
+    (void)TEST_device_subscribe_message_saved_callback(TEST_IOTHUB_MESSAGE_HANDLE, &disposition_info, TEST_device_subscribe_message_saved_context);
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_GetStatistics(device_handle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_IS_TRUE(statistics.bytesReceived == 7);
+    ASSERT_IS_TRUE(statistics.bytesSent == 0);
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_096: [If `handle` or `iotHubClientStatus` are NULL, IoTHubTransport_AMQP_Common_GetSendStatus shall return IOTHUB_CLIENT_INVALID_ARG]
 TEST_FUNCTION(GetSendStatus_NULL_handle)
 {
@@ -2767,6 +3006,36 @@ TEST_FUNCTION(SetOption_device_specific_failure_check)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_149: [If `option` is `message_pool_size`, `value` shall be a size_t* with the number of released event send tasks each device keeps for reuse, saved and applied to each registered device]
+TEST_FUNCTION(SetOption_message_pool_size_success)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    size_t value = 16;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG)).SetReturn(device_handle);
+    STRICT_EXPECTED_CALL(device_set_option(TEST_DEVICE_HANDLE, DEVICE_OPTION_MESSAGE_POOL_SIZE, &value));
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_MESSAGE_POOL_SIZE, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_02_007: [ If `option` is `x509certificate` and the transport preferred authentication method is not x509 then IoTHubTransport_AMQP_Common_SetOption shall return IOTHUB_CLIENT_INVALID_ARG. ]
 TEST_FUNCTION(SetOption_CBS_transport_option_x509certificate)
 {
@@ -2851,6 +3120,32 @@ TEST_FUNCTION(SetOption_log_trace)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_140: [If `option` is `device_starts_per_second`, `value` shall be a size_t* saved as the number of registered devices allowed to start per second, 0 meaning no limit]
+TEST_FUNCTION(SetOption_device_starts_per_second)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    size_t value = 10;
+
+    umock_c_reset_all_calls();
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_DEVICE_STARTS_PER_SECOND, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(int, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_105: [If `option` does not match one of the options handled by this module, it shall be passed to `instance->tls_io` using xio_setoption()]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_106: [If `instance->tls_io` is NULL, it shall be set invoking instance->underlying_io_transport_provider()]
@@ -3707,6 +4002,7 @@ TEST_FUNCTION(IoTHubTransport_AMQP_Common_Destroy_frees_proxy_options)
     set_expected_calls_for_Unregister(device_handle);
 
     STRICT_EXPECTED_CALL(singlylinkedlist_destroy(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(device_index_destroy(TEST_REGISTERED_DEVICES_INDEX));
     STRICT_EXPECTED_CALL(retry_control_destroy(TEST_RETRY_CONTROL_HANDLE));
     STRICT_EXPECTED_CALL(STRING_delete(TEST_IOTHUB_HOST_FQDN_STRING_HANDLE));
     STRICT_EXPECTED_CALL(free(IGNORED_PTR_ARG));
@@ -3750,7 +4046,7 @@ TEST_FUNCTION(Unregister_device_not_registered)
     umock_c_reset_all_calls();
     STRICT_EXPECTED_CALL(STRING_c_str(TEST_DEVICE_ID_STRING_HANDLE))
         .SetReturn(TEST_DEVICE_ID_CHAR_PTR);
-    set_expected_calls_for_is_device_registered_ex(device_config, NULL);
+    set_expected_calls_for_is_device_registered(device_config, NULL);
 
     // act
     IoTHubTransport_AMQP_Common_Unregister(device_handle);
@@ -3764,6 +4060,7 @@ TEST_FUNCTION(Unregister_device_not_registered)
 
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_080: [if `deviceHandle` has a NULL reference to its transport instance, IoTHubTransport_AMQP_Common_Unregister shall return.] (NT)
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_082: [`device_instance` shall be removed from `instance->registered_devices`]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_146: [IoTHubTransport_AMQP_Common_Unregister shall remove the device from `instance->registered_devices_index` using device_index_remove()]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_01_012: [IoTHubTransport_AMQP_Common_Unregister shall destroy the C2D methods handler by calling iothubtransportamqp_methods_destroy]
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_083: [IoTHubTransport_AMQP_Common_Unregister shall free all the memory allocated for the `device_instance`]
 TEST_FUNCTION(Unregister_succeeds)
@@ -3810,6 +4107,9 @@ TEST_FUNCTION(on_message_received_succeeds)
     disposition_info.message_id = TEST_MESSAGE_ID;
 
     umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn(IOTHUBMESSAGE_BYTEARRAY);
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_IOTHUB_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
@@ -3852,6 +4152,9 @@ TEST_FUNCTION(on_message_received_fails)
     disposition_info.message_id = TEST_MESSAGE_ID;
 
     umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetContentType(TEST_IOTHUB_MESSAGE_HANDLE))
+        .SetReturn(IOTHUBMESSAGE_BYTEARRAY);
+    STRICT_EXPECTED_CALL(IoTHubMessage_GetByteArray(TEST_IOTHUB_MESSAGE_HANDLE, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
     EXPECTED_CALL(malloc(IGNORED_NUM_ARG));
     EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
@@ -3982,6 +4285,142 @@ TEST_FUNCTION(on_amqp_connection_state_changed_CLOSED_unexpectedly)
     destroy_transport(handle, device_handle, NULL);
 }
 
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_136: [If `device_starts_per_second` is not 0, a token bucket holding at most `device_starts_per_second` starts shall be refilled at `device_starts_per_second` starts per second]
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_139: [If `device_starts_per_second` is not 0, a stopped device that was not admitted shall stay stopped until a later call to IoTHubTransport_AMQP_Common_DoWork]
+TEST_FUNCTION(DoWork_device_starts_per_second_limits_device_start_attempts)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    size_t device_starts_per_second = 1;
+    (void)IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_DEVICE_STARTS_PER_SECOND, &device_starts_per_second);
+
+    crank_transport(handle, &TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 1, TEST_current_time, false);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+
+    PDLIST_ENTRY wts[1] = { &TEST_waitingToSend };
+    bool is_waiting_to_start[1] = { true };
+
+    umock_c_reset_all_calls();
+
+    // The first start is admitted right away...
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    set_expected_calls_for_Device_DoWork(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, true, TEST_current_time, false);
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // ... the retry within the same second is not...
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_current_time, TEST_current_time));
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(device_do_work(TEST_DEVICE_HANDLE));
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // ... and the one a second later is.
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time + 1);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_current_time + 1, TEST_current_time));
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    set_expected_calls_for_device_start_scan(wts, is_waiting_to_start, 1);
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    set_expected_calls_for_Device_DoWork(&TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, true, TEST_current_time, false);
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, NULL);
+}
+
+// Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_137: [Stopped devices with events waiting to be sent shall be admitted to start before the other stopped devices, one start from the token bucket each]
+TEST_FUNCTION(DoWork_device_starts_per_second_starts_devices_with_pending_events_first)
+{
+    // arrange
+    initialize_test_variables();
+    TRANSPORT_LL_HANDLE handle = create_transport();
+
+    DLIST_ENTRY waiting_to_send2;
+    DLIST_ENTRY pending_event;
+    real_DList_InitializeListHead(&waiting_to_send2);
+    real_DList_InsertTailList(&waiting_to_send2, &pending_event);
+
+    IOTHUB_DEVICE_CONFIG* device_config = create_device_config(TEST_DEVICE_ID_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle = register_device(handle, device_config, &TEST_waitingToSend, true);
+    ASSERT_IS_NOT_NULL(device_handle);
+
+    TEST_device_create_return = TEST_DEVICE_HANDLE_2;
+    IOTHUB_DEVICE_CONFIG* device_config2 = create_device_config(TEST_DEVICE_ID_2_CHAR_PTR, true);
+    IOTHUB_DEVICE_HANDLE device_handle2 = register_device(handle, device_config2, &waiting_to_send2, true);
+    ASSERT_IS_NOT_NULL(device_handle2);
+
+    size_t device_starts_per_second = 1;
+    (void)IoTHubTransport_AMQP_Common_SetOption(handle, OPTION_DEVICE_STARTS_PER_SECOND, &device_starts_per_second);
+
+    crank_transport(handle, &TEST_waitingToSend, 0, DEVICE_STATE_STOPPED, false, true, false, false, 2, TEST_current_time, false);
+
+    TEST_amqp_connection_create_saved_on_state_changed_callback(
+        TEST_amqp_connection_create_saved_on_state_changed_context,
+        AMQP_CONNECTION_STATE_CLOSED, AMQP_CONNECTION_STATE_OPENED);
+
+    PDLIST_ENTRY wts[2] = { &TEST_waitingToSend, &waiting_to_send2 };
+    bool both_waiting_to_start[2] = { true, true };
+    bool first_waiting_to_start[2] = { true, false };
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(singlylinkedlist_get_head_item(TEST_REGISTERED_DEVICES_LIST));
+    STRICT_EXPECTED_CALL(get_time(NULL)).SetReturn(TEST_current_time);
+    set_expected_calls_for_device_start_scan(wts, both_waiting_to_start, 2);
+    set_expected_calls_for_device_start_scan(wts, both_waiting_to_start, 2);
+    set_expected_calls_for_device_start_scan(wts, first_waiting_to_start, 2);
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(device_do_work(TEST_DEVICE_HANDLE));
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    EXPECTED_CALL(singlylinkedlist_item_get_value(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_get_session_handle(TEST_AMQP_CONNECTION_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_session_handle();
+    STRICT_EXPECTED_CALL(amqp_connection_get_cbs_handle(TEST_AMQP_CONNECTION_HANDLE, IGNORED_PTR_ARG))
+        .IgnoreArgument_cbs_handle();
+    STRICT_EXPECTED_CALL(device_start_async(TEST_DEVICE_HANDLE_2, TEST_SESSION_HANDLE, TEST_CBS_HANDLE));
+    STRICT_EXPECTED_CALL(device_do_work(TEST_DEVICE_HANDLE_2));
+    EXPECTED_CALL(singlylinkedlist_get_next_item(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(amqp_connection_do_work(TEST_AMQP_CONNECTION_HANDLE));
+
+    // act
+    IoTHubTransport_AMQP_Common_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    destroy_transport(handle, device_handle, device_handle2);
+}
+
 // Tests_SRS_IOTHUBTRANSPORT_AMQP_COMMON_09_016: [If `handle` is NULL, IoTHubTransport_AMQP_Common_DoWork shall return without doing any work]
 TEST_FUNCTION(DoWork_NULL_handle)
 {
@@ -387,6 +387,9 @@ static void register_global_mock_returns()
     REGISTER_GLOBAL_MOCK_RETURN(authentication_set_option, 0);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(authentication_set_option, 1);
 
+    REGISTER_GLOBAL_MOCK_RETURN(authentication_get_sas_token_refresh_count, 0);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(authentication_get_sas_token_refresh_count, 1);
+
     REGISTER_GLOBAL_MOCK_RETURN(telemetry_messenger_create, TEST_TELEMETRY_MESSENGER_HANDLE);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(telemetry_messenger_create, NULL);
 
@@ -586,6 +589,14 @@ static void set_expected_calls_for_device_set_option(DEVICE_HANDLE handle, DEVIC
     {
         STRICT_EXPECTED_CALL(telemetry_messenger_set_option(TEST_TELEMETRY_MESSENGER_HANDLE, MESSENGER_OPTION_EVENT_SEND_TIMEOUT_SECS, option_value));
     }
+    else if (strcmp(DEVICE_OPTION_EVENT_SEND_BATCHING, option_name) == 0)
+    {
+        STRICT_EXPECTED_CALL(telemetry_messenger_set_option(TEST_TELEMETRY_MESSENGER_HANDLE, MESSENGER_OPTION_EVENT_SEND_BATCHING, option_value));
+    }
+    else if (strcmp(DEVICE_OPTION_MESSAGE_POOL_SIZE, option_name) == 0)
+    {
+        STRICT_EXPECTED_CALL(telemetry_messenger_set_option(TEST_TELEMETRY_MESSENGER_HANDLE, MESSENGER_OPTION_MESSAGE_POOL_SIZE, option_value));
+    }
     else if (strcmp(DEVICE_OPTION_SAVED_MESSENGER_OPTIONS, option_name) == 0)
     {
         STRICT_EXPECTED_CALL(OptionHandler_FeedOptions((OPTIONHANDLER_HANDLE)option_value, TEST_TELEMETRY_MESSENGER_HANDLE));
@@ -1295,6 +1306,126 @@ TEST_FUNCTION(device_get_send_status_failure_checks)
     device_destroy(handle);
 }
 
+// Tests_SRS_DEVICE_09_124: [If `handle` or `sas_token_refresh_count` is NULL, device_get_sas_token_refresh_count shall return a non-zero result]
+TEST_FUNCTION(device_get_sas_token_refresh_count_NULL_handle)
+{
+    // arrange
+    umock_c_reset_all_calls();
+
+    uint64_t sas_token_refresh_count;
+
+    // act
+    int result = device_get_sas_token_refresh_count(NULL, &sas_token_refresh_count);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+}
+
+// Tests_SRS_DEVICE_09_124: [If `handle` or `sas_token_refresh_count` is NULL, device_get_sas_token_refresh_count shall return a non-zero result]
+TEST_FUNCTION(device_get_sas_token_refresh_count_NULL_sas_token_refresh_count)
+{
+    // arrange
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    DEVICE_HANDLE handle = create_device(config, TEST_current_time);
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = device_get_sas_token_refresh_count(handle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    device_destroy(handle);
+}
+
+// Tests_SRS_DEVICE_09_125: [If `instance->authentication_mode` is not DEVICE_AUTH_MODE_CBS, device_get_sas_token_refresh_count shall set `sas_token_refresh_count` to 0 and return zero]
+TEST_FUNCTION(device_get_sas_token_refresh_count_X509_success)
+{
+    // arrange
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_X509);
+    DEVICE_HANDLE handle = create_device(config, TEST_current_time);
+
+    uint64_t sas_token_refresh_count = 3;
+
+    umock_c_reset_all_calls();
+
+    // act
+    int result = device_get_sas_token_refresh_count(handle, &sas_token_refresh_count);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(sas_token_refresh_count == 0);
+
+    // cleanup
+    device_destroy(handle);
+}
+
+// Tests_SRS_DEVICE_09_126: [Otherwise `sas_token_refresh_count` shall be obtained using authentication_get_sas_token_refresh_count]
+// Tests_SRS_DEVICE_09_128: [If device_get_sas_token_refresh_count succeeds, it shall return zero as result]
+TEST_FUNCTION(device_get_sas_token_refresh_count_CBS_success)
+{
+    // arrange
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    DEVICE_HANDLE handle = create_device(config, TEST_current_time);
+
+    uint64_t authentication_sas_token_refresh_count = 4;
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(authentication_get_sas_token_refresh_count(TEST_AUTHENTICATION_HANDLE, IGNORED_PTR_ARG))
+        .CopyOutArgumentBuffer_sas_token_refresh_count(&authentication_sas_token_refresh_count, sizeof(authentication_sas_token_refresh_count))
+        .SetReturn(0);
+
+    // act
+    uint64_t sas_token_refresh_count;
+    int result = device_get_sas_token_refresh_count(handle, &sas_token_refresh_count);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+    ASSERT_IS_TRUE(sas_token_refresh_count == 4);
+
+    // cleanup
+    device_destroy(handle);
+}
+
+// Tests_SRS_DEVICE_09_127: [If authentication_get_sas_token_refresh_count fails, device_get_sas_token_refresh_count shall return a non-zero result]
+TEST_FUNCTION(device_get_sas_token_refresh_count_failure_checks)
+{
+    // arrange
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    DEVICE_HANDLE handle = create_device(config, TEST_current_time);
+
+    umock_c_reset_all_calls();
+    STRICT_EXPECTED_CALL(authentication_get_sas_token_refresh_count(TEST_AUTHENTICATION_HANDLE, IGNORED_PTR_ARG))
+        .SetReturn(1);
+
+    // act
+    uint64_t sas_token_refresh_count;
+    int result = device_get_sas_token_refresh_count(handle, &sas_token_refresh_count);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_NOT_EQUAL(int, 0, result);
+
+    // cleanup
+    device_destroy(handle);
+}
+
 // Tests_SRS_DEVICE_09_066: [If `handle` or `on_message_received_callback` or `context` is NULL, device_subscribe_message shall return a non-zero result]
 TEST_FUNCTION(device_subscribe_message_NULL_handle)
 {
@@ -1713,6 +1844,56 @@ TEST_FUNCTION(device_set_option_MSGR_succeeds)
     device_destroy(handle);
 }
 
+// Tests_SRS_DEVICE_09_122: [If `name` is DEVICE_OPTION_EVENT_SEND_BATCHING, it shall be passed along with `value` to telemetry_messenger_set_option as MESSENGER_OPTION_EVENT_SEND_BATCHING]
+TEST_FUNCTION(device_set_option_EVENT_SEND_BATCHING_succeeds)
+{
+    // arrange
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    DEVICE_HANDLE handle = create_and_start_device(config, TEST_current_time);
+
+    bool value = true;
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_device_set_option(handle, config, DEVICE_OPTION_EVENT_SEND_BATCHING, &value);
+
+    // act
+    int result = device_set_option(handle, DEVICE_OPTION_EVENT_SEND_BATCHING, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+    device_destroy(handle);
+}
+
+// Tests_SRS_DEVICE_09_123: [If `name` is DEVICE_OPTION_MESSAGE_POOL_SIZE, it shall be passed along with `value` to telemetry_messenger_set_option as MESSENGER_OPTION_MESSAGE_POOL_SIZE]
+TEST_FUNCTION(device_set_option_MESSAGE_POOL_SIZE_succeeds)
+{
+    // arrange
+    ASSERT_IS_TRUE_WITH_MSG(INDEFINITE_TIME != TEST_current_time, "Failed setting TEST_current_time");
+
+    DEVICE_CONFIG* config = get_device_config(DEVICE_AUTH_MODE_CBS);
+    DEVICE_HANDLE handle = create_and_start_device(config, TEST_current_time);
+
+    size_t value = 16;
+
+    umock_c_reset_all_calls();
+    set_expected_calls_for_device_set_option(handle, config, DEVICE_OPTION_MESSAGE_POOL_SIZE, &value);
+
+    // act
+    int result = device_set_option(handle, DEVICE_OPTION_MESSAGE_POOL_SIZE, &value);
+
+    // assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_ARE_EQUAL(int, 0, result);
+
+    // cleanup
+    device_destroy(handle);
+}
+
 // Tests_SRS_DEVICE_09_088: [If `name` is DEVICE_OPTION_SAVED_AUTH_OPTIONS but CBS authentication is not being used, device_set_option shall return a non-zero result]
 TEST_FUNCTION(device_set_option_X509_saved_auth_options)
 {
@@ -4,6 +4,7 @@
 #include <cstdlib>
 #include <cstddef>
 #include <cstdbool>
+#include <climits>
 #include "testrunnerswitcher.h"
 #include "micromock.h"
 #include "micromockcharstararenullterminatedstrings.h"
@@ -12,6 +13,7 @@
 #include "iothubtransport.h"
 
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
 #include "azure_c_shared_utility/doublylinkedlist.h"
 #include "azure_c_shared_utility/vector.h"
 
@@ -73,6 +75,7 @@ static void* threadFuncArg;
 #define TEST_LOCK_HANDLE (LOCK_HANDLE)0x4443
 #define TEST_CLIENTS_LOCK_HANDLE (LOCK_HANDLE)0x4445
 #define TEST_THREAD_HANDLE (THREAD_HANDLE)0x4442
+#define TEST_COND_HANDLE (COND_HANDLE)0x4446
 
 
 
@@ -127,10 +130,12 @@ static size_t whenShallmalloc_fail;
 static IOTHUB_CLIENT_STATUS currentIotHubClientStatus;
 
 static size_t  clientDoWork_calls = 0;
-static void clientDoWork(void* clientHandle)
+static unsigned int clientDoWork_firstWaitTimeInMs = UINT_MAX;
+static unsigned int clientDoWork(void* clientHandle)
 {
     (void)clientHandle;
     clientDoWork_calls++;
+    return (clientDoWork_calls == 1) ? clientDoWork_firstWaitTimeInMs : UINT_MAX;
 }
 
 TYPED_MOCK_CLASS(CIotHubTransportMocks, CGlobalMock)
@@ -383,6 +388,20 @@ public:
     MOCK_STATIC_METHOD_1(, LOCK_RESULT, Lock_Deinit, LOCK_HANDLE, handle);
     MOCK_METHOD_END(LOCK_RESULT, LOCK_OK);
 
+    /* Condition mocks */
+    MOCK_STATIC_METHOD_0(, COND_HANDLE, Condition_Init);
+    MOCK_METHOD_END(COND_HANDLE, TEST_COND_HANDLE);
+    MOCK_STATIC_METHOD_1(, COND_RESULT, Condition_Post, COND_HANDLE, handle);
+    MOCK_METHOD_END(COND_RESULT, COND_OK);
+    MOCK_STATIC_METHOD_3(, COND_RESULT, Condition_Wait, COND_HANDLE, handle, LOCK_HANDLE, lock, int, timeout_milliseconds)
+        if ((howManyDoWorkCalls > 0) && (howManyDoWorkCalls == doWorkCallCount))
+        {
+            * (sig_atomic_t*)(((char*)threadFuncArg) + IoTHubTransport_ThreadTerminationOffset) = 1; /*tell the thread to stop*/
+        }
+    MOCK_METHOD_END(COND_RESULT, COND_TIMEOUT);
+    MOCK_STATIC_METHOD_1(, void, Condition_Deinit, COND_HANDLE, handle);
+    MOCK_VOID_METHOD_END();
+
 };
 
 DECLARE_GLOBAL_MOCK_METHOD_1(CIotHubTransportMocks, , void, DList_InitializeListHead, PDLIST_ENTRY, listHead);
@@ -455,6 +474,11 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CIotHubTransportMocks, , LOCK_RESULT, Lock, LOCK_HA
 DECLARE_GLOBAL_MOCK_METHOD_1(CIotHubTransportMocks, , LOCK_RESULT, Unlock, LOCK_HANDLE, handle);
 DECLARE_GLOBAL_MOCK_METHOD_1(CIotHubTransportMocks, , LOCK_RESULT, Lock_Deinit, LOCK_HANDLE, handle);
 
+DECLARE_GLOBAL_MOCK_METHOD_0(CIotHubTransportMocks, , COND_HANDLE, Condition_Init);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIotHubTransportMocks, , COND_RESULT, Condition_Post, COND_HANDLE, handle);
+DECLARE_GLOBAL_MOCK_METHOD_3(CIotHubTransportMocks, , COND_RESULT, Condition_Wait, COND_HANDLE, handle, LOCK_HANDLE, lock, int, timeout_milliseconds);
+DECLARE_GLOBAL_MOCK_METHOD_1(CIotHubTransportMocks, , void, Condition_Deinit, COND_HANDLE, handle);
+
 static TRANSPORT_PROVIDER FAKE_transport_provider =
 {
     FAKE_IoTHubTransport_SendMessageDisposition,
@@ -748,6 +772,7 @@ TEST_FUNCTION(IoTHubTransport_Destroy_success_thread_join_fails)
 
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mocks, Condition_Post(TEST_COND_HANDLE));
     STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE))
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(mocks, ThreadAPI_Join(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
@@ -761,6 +786,7 @@ TEST_FUNCTION(IoTHubTransport_Destroy_success_thread_join_fails)
         .IgnoreArgument(1);
     STRICT_EXPECTED_CALL(mocks, Lock_Deinit(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mocks, Condition_Deinit(TEST_COND_HANDLE));
     STRICT_EXPECTED_CALL(mocks, gballoc_free(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
 
@@ -906,6 +932,7 @@ TEST_FUNCTION(IoTHubTransport_StartWorkerThread_success)
     auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
     mocks.ResetAllCalls();
 
+    STRICT_EXPECTED_CALL(mocks, Condition_Init());
     STRICT_EXPECTED_CALL(mocks, ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, transportHandle))
         .IgnoreArgument(1)
         .IgnoreArgument(2);
@@ -1046,6 +1073,7 @@ TEST_FUNCTION(IoTHubTransport_StartWorkerThread_thread_create_fails_returns_erro
     auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
     mocks.ResetAllCalls();
 
+    STRICT_EXPECTED_CALL(mocks, Condition_Init());
     STRICT_EXPECTED_CALL(mocks, ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, transportHandle))
         .IgnoreArgument(1)
         .IgnoreArgument(2)
@@ -1073,6 +1101,7 @@ TEST_FUNCTION(IoTHubTransport_StartWorkerThread_Vector_push_back_returns_error)
 
     STRICT_EXPECTED_CALL(mocks, Lock(IGNORED_PTR_ARG))
         .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(mocks, Condition_Init());
     STRICT_EXPECTED_CALL(mocks, ThreadAPI_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG, transportHandle))
         .IgnoreArgument(1)
         .IgnoreArgument(2);
@@ -1120,6 +1149,7 @@ TEST_FUNCTION(IoTHubTransport_SignalEndWorkerThread_success)
         .IgnoreArgument(2);
     STRICT_EXPECTED_CALL(mocks, VECTOR_size(IGNORED_PTR_ARG))
         .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(mocks, Condition_Post(TEST_COND_HANDLE));
     STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
         .IgnoreAllArguments();
 
@@ -1327,9 +1357,9 @@ TEST_FUNCTION(IoTHubTransport_JoinWorkerThread_join_fails)
     IoTHubTransport_Destroy(transportHandle);
 }
 
-//Tests_SRS_IOTHUBTRANSPORT_17_029: [ The thread shall call lower layer transport DoWork every 1 ms. ]
+//Tests_SRS_IOTHUBTRANSPORT_17_029: [ The thread shall wait on the worker condition for at most the DoWork frequency (100 ms by default) before calling lower layer transport DoWork again. ]
 //Tests_SRS_IOTHUBTRANSPORT_17_030: [ All calls to lower layer transport DoWork shall be protected by the lock created in IoTHubTransport_Create. ]
-TEST_FUNCTION(IoTHubTransport_worker_thread_runs_every_1_ms)
+TEST_FUNCTION(IoTHubTransport_worker_thread_runs_every_do_work_frequency)
 {
     CIotHubTransportMocks mocks;
     ///arrange
@@ -1350,7 +1380,9 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_every_1_ms)
     EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(mocks, ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 100));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
 
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
     STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
@@ -1361,7 +1393,9 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_every_1_ms)
     EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(mocks, ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 100));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
 
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
     STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
@@ -1380,7 +1414,7 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_every_1_ms)
     IoTHubTransport_Destroy(transportHandle);
 }
 
-//Tests_SRS_IOTHUBTRANSPORT_17_029: [ The thread shall call lower layer transport DoWork every 1 ms. ]
+//Tests_SRS_IOTHUBTRANSPORT_17_029: [ The thread shall wait on the worker condition for at most the DoWork frequency (100 ms by default) before calling lower layer transport DoWork again. ]
 //Tests_SRS_IOTHUBTRANSPORT_17_030: [ All calls to lower layer transport DoWork shall be protected by the lock created in IoTHubTransport_Create. 
 TEST_FUNCTION(IoTHubTransport_worker_thread_runs_two_devices_once)
 {
@@ -1405,7 +1439,9 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_two_devices_once)
     EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(mocks, ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 100));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
 
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
     STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
@@ -1438,7 +1474,9 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_lock_fails)
     howManyDoWorkCalls = 1;
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE))
         .SetFailReturn(LOCK_ERROR);
-    STRICT_EXPECTED_CALL(mocks, ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 100));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
 
     /* DoWork needs to run at least once, so, the number of calls to DoWork increments. */
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
@@ -1451,7 +1489,9 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_lock_fails)
     EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
     STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
         .IgnoreAllArguments();
-    STRICT_EXPECTED_CALL(mocks, ThreadAPI_Sleep(1));
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 100));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
 
     STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
     STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
@@ -1476,5 +1516,271 @@ TEST_FUNCTION(IoTHubTransport_worker_thread_runs_lock_fails)
     IoTHubTransport_Destroy(transportHandle);
 }
 
+//Tests_SRS_IOTHUBTRANSPORT_09_004: [ If transportHandle is NULL, IoTHubTransport_WakeWorkerThread shall do nothing. ]
+TEST_FUNCTION(IoTHubTransport_WakeWorkerThread_null_transport_does_nothing)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+
+    ///act
+    IoTHubTransport_WakeWorkerThread(NULL);
+
+    ///assert
+    mocks.AssertActualAndExpectedCalls();
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_005: [ If the worker thread exists, IoTHubTransport_WakeWorkerThread shall mark work as pending and signal the worker condition by calling Condition_Post. ]
+TEST_FUNCTION(IoTHubTransport_WakeWorkerThread_no_thread_does_nothing)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    mocks.ResetAllCalls();
+
+    ///act
+    IoTHubTransport_WakeWorkerThread(transportHandle);
+
+    ///assert
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_005: [ If the worker thread exists, IoTHubTransport_WakeWorkerThread shall mark work as pending and signal the worker condition by calling Condition_Post. ]
+//Tests_SRS_IOTHUBTRANSPORT_09_001: [ If work was signaled by IoTHubTransport_WakeWorkerThread since the last DoWork, the thread shall not wait. ]
+TEST_FUNCTION(IoTHubTransport_WakeWorkerThread_signals_condition_success)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    (void)IoTHubTransport_StartWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1, clientDoWork);
+    mocks.ResetAllCalls();
+
+    STRICT_EXPECTED_CALL(mocks, Condition_Post(TEST_COND_HANDLE));
+
+    ///act
+    IoTHubTransport_WakeWorkerThread(transportHandle);
+
+    ///assert
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    IoTHubTransport_SignalEndWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1);
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_006: [ If transportHandle is NULL or doWorkFrequencyInMs is 0, IoTHubTransport_SetDoWorkFrequency shall return IOTHUB_CLIENT_INVALID_ARG. ]
+TEST_FUNCTION(IoTHubTransport_SetDoWorkFrequency_null_transport_returns_bad_arg)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_SetDoWorkFrequency(NULL, 10);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, (int)IOTHUB_CLIENT_INVALID_ARG, (int)result);
+    mocks.AssertActualAndExpectedCalls();
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_006: [ If transportHandle is NULL or doWorkFrequencyInMs is 0, IoTHubTransport_SetDoWorkFrequency shall return IOTHUB_CLIENT_INVALID_ARG. ]
+TEST_FUNCTION(IoTHubTransport_SetDoWorkFrequency_zero_returns_bad_arg)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    mocks.ResetAllCalls();
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_SetDoWorkFrequency(transportHandle, 0);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, (int)IOTHUB_CLIENT_INVALID_ARG, (int)result);
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_007: [ IoTHubTransport_SetDoWorkFrequency shall set the longest time the worker thread waits between two calls to DoWork and return IOTHUB_CLIENT_OK. ]
+TEST_FUNCTION(IoTHubTransport_SetDoWorkFrequency_worker_thread_waits_for_frequency)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    (void)IoTHubTransport_StartWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1, clientDoWork);
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_SetDoWorkFrequency(transportHandle, 50);
+    mocks.ResetAllCalls();
+
+    howManyDoWorkCalls = 1;
+    clientDoWork_calls = 0;
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, FAKE_IoTHubTransport_DoWork((TRANSPORT_LL_HANDLE)(0x42), NULL));
+    STRICT_EXPECTED_CALL(mocks, Lock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    EXPECTED_CALL(mocks, VECTOR_size(IGNORED_PTR_ARG));
+    EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 50));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    threadFunc(threadFuncArg);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, (int)IOTHUB_CLIENT_OK, (int)result);
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    IoTHubTransport_SignalEndWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1);
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_009: [ IoTHubTransport_SetDoWorkFrequency shall take the lock created in IoTHubTransport_Create while it changes the frequency; if acquiring the lock fails it shall return IOTHUB_CLIENT_ERROR. ]
+TEST_FUNCTION(IoTHubTransport_SetDoWorkFrequency_takes_the_transport_lock)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    mocks.ResetAllCalls();
+
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_SetDoWorkFrequency(transportHandle, 50);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, (int)IOTHUB_CLIENT_OK, (int)result);
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_009: [ IoTHubTransport_SetDoWorkFrequency shall take the lock created in IoTHubTransport_Create while it changes the frequency; if acquiring the lock fails it shall return IOTHUB_CLIENT_ERROR. ]
+TEST_FUNCTION(IoTHubTransport_SetDoWorkFrequency_lock_fails)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    mocks.ResetAllCalls();
+
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE))
+        .SetFailReturn(LOCK_ERROR);
+
+    ///act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransport_SetDoWorkFrequency(transportHandle, 50);
+
+    ///assert
+    ASSERT_ARE_EQUAL(int, (int)IOTHUB_CLIENT_ERROR, (int)result);
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_008: [ The thread shall not wait longer than the shortest time returned by the clients' multiplexed DoWork functions, and shall not wait at all if that time is 0. ]
+TEST_FUNCTION(IoTHubTransport_worker_thread_waits_for_shortest_client_wait_time)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    (void)IoTHubTransport_StartWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1, clientDoWork);
+    (void)IoTHubTransport_StartWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE2, clientDoWork);
+    mocks.ResetAllCalls();
+
+    howManyDoWorkCalls = 1;
+    clientDoWork_calls = 0;
+    clientDoWork_firstWaitTimeInMs = 20;
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, FAKE_IoTHubTransport_DoWork((TRANSPORT_LL_HANDLE)(0x42), NULL));
+    STRICT_EXPECTED_CALL(mocks, Lock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    EXPECTED_CALL(mocks, VECTOR_size(IGNORED_PTR_ARG));
+    EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 20));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    threadFunc(threadFuncArg);
+
+    ///assert
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    clientDoWork_firstWaitTimeInMs = UINT_MAX;
+    IoTHubTransport_SignalEndWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1);
+    IoTHubTransport_SignalEndWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE2);
+    IoTHubTransport_Destroy(transportHandle);
+}
+
+//Tests_SRS_IOTHUBTRANSPORT_09_008: [ The thread shall not wait longer than the shortest time returned by the clients' multiplexed DoWork functions, and shall not wait at all if that time is 0. ]
+TEST_FUNCTION(IoTHubTransport_worker_thread_does_not_wait_when_a_client_wait_time_is_0)
+{
+    CIotHubTransportMocks mocks;
+    ///arrange
+    auto transportHandle = IoTHubTransport_Create(TEST_CONFIG.protocol, TEST_CONFIG.iotHubName, TEST_CONFIG.iotHubSuffix);
+    (void)IoTHubTransport_StartWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1, clientDoWork);
+    mocks.ResetAllCalls();
+
+    howManyDoWorkCalls = 2;
+    clientDoWork_calls = 0;
+    clientDoWork_firstWaitTimeInMs = 0;
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, FAKE_IoTHubTransport_DoWork((TRANSPORT_LL_HANDLE)(0x42), NULL));
+    STRICT_EXPECTED_CALL(mocks, Lock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    EXPECTED_CALL(mocks, VECTOR_size(IGNORED_PTR_ARG));
+    EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, FAKE_IoTHubTransport_DoWork((TRANSPORT_LL_HANDLE)(0x42), NULL));
+    STRICT_EXPECTED_CALL(mocks, Lock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    EXPECTED_CALL(mocks, VECTOR_size(IGNORED_PTR_ARG));
+    EXPECTED_CALL(mocks, VECTOR_element(IGNORED_PTR_ARG, IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(mocks, Unlock(IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Condition_Wait(TEST_COND_HANDLE, TEST_LOCK_HANDLE, 100));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    STRICT_EXPECTED_CALL(mocks, Lock(TEST_LOCK_HANDLE));
+    STRICT_EXPECTED_CALL(mocks, Unlock(TEST_LOCK_HANDLE));
+
+    ///act
+    threadFunc(threadFuncArg);
+
+    ///assert
+    mocks.AssertActualAndExpectedCalls();
+
+    ///cleanup
+    clientDoWork_firstWaitTimeInMs = UINT_MAX;
+    IoTHubTransport_SignalEndWorkerThread(transportHandle, TEST_IOTHUB_CLIENT_HANDLE1);
+    IoTHubTransport_Destroy(transportHandle);
+}
+
 END_TEST_SUITE(iothubtransport_ut)
 
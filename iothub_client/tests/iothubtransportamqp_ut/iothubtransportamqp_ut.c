@@ -286,6 +286,7 @@ TEST_SUITE_INITIALIZE(TestClassInitialize)
 	REGISTER_GLOBAL_MOCK_RETURN(IoTHubTransport_AMQP_Common_Subscribe_DeviceMethod, 0);
 	REGISTER_GLOBAL_MOCK_RETURN(IoTHubTransport_AMQP_Common_ProcessItem, IOTHUB_PROCESS_OK);
 	REGISTER_GLOBAL_MOCK_RETURN(IoTHubTransport_AMQP_Common_GetSendStatus, IOTHUB_CLIENT_OK);
+	REGISTER_GLOBAL_MOCK_RETURN(IoTHubTransport_AMQP_Common_GetStatistics, IOTHUB_CLIENT_OK);
 }
 
 TEST_SUITE_CLEANUP(TestClassCleanup)
@@ -669,6 +670,27 @@ TEST_FUNCTION(AMQP_GetSendStatus)
 	// cleanup
 }
 
+// Tests_SRS_IOTHUBTRANSPORTAMQP_09_021: [IoTHubTransportAMQP_GetStatistics shall get the transport counters by calling into the IoTHubTransport_AMQP_Common_GetStatistics()]
+TEST_FUNCTION(AMQP_GetStatistics)
+{
+	// arrange
+	TRANSPORT_PROVIDER* provider = (TRANSPORT_PROVIDER*)AMQP_Protocol();
+
+	IOTHUB_CLIENT_STATISTICS statistics;
+
+	umock_c_reset_all_calls();
+	STRICT_EXPECTED_CALL(IoTHubTransport_AMQP_Common_GetStatistics(TEST_IOTHUB_DEVICE_HANDLE, &statistics));
+
+	// act
+	IOTHUB_CLIENT_RESULT result = provider->IoTHubTransport_GetStatistics(TEST_IOTHUB_DEVICE_HANDLE, &statistics);
+
+	// assert
+	ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+	ASSERT_ARE_EQUAL(int, result, IOTHUB_CLIENT_OK);
+
+	// cleanup
+}
+
 
 // Tests_SRS_IOTHUBTRANSPORTAMQP_09_018: [IoTHubTransportAMQP_GetHostname shall get the hostname by calling into the IoTHubTransport_AMQP_Common_GetHostname()]
 TEST_FUNCTION(AMQP_GetHostname)
@@ -5,10 +5,12 @@
 #include <cstdlib>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #else
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #endif
 
 #include "testrunnerswitcher.h"
@@ -42,10 +44,13 @@ static void my_gballoc_free(void* ptr)
 #include "azure_c_shared_utility/vector.h"
 #include "azure_c_shared_utility/vector_types_internal.h"
 #include "azure_c_shared_utility/lock.h"
+#include "azure_c_shared_utility/condition.h"
 
 #include "iothub_client_options.h"
 #include "iothub_client_version.h"
 #include "iothub_client_private.h"
+#include "iothub_client_device_index.h"
+#include "iothub_client_callback_pool.h"
 #undef ENABLE_MOCKS
 
 #include "iothubtransporthttp.h"
@@ -88,6 +93,13 @@ extern "C" {
     extern int real_DList_RemoveEntryList(PDLIST_ENTRY listEntry);
     extern PDLIST_ENTRY real_DList_RemoveHeadList(PDLIST_ENTRY listHead);
 
+    extern DEVICE_INDEX_HANDLE real_device_index_create(void);
+    extern int real_device_index_add(DEVICE_INDEX_HANDLE device_index, const char* device_id, void* device);
+    extern int real_device_index_remove(DEVICE_INDEX_HANDLE device_index, void* device);
+    extern void* real_device_index_find_by_id(DEVICE_INDEX_HANDLE device_index, const char* device_id);
+    extern bool real_device_index_contains(DEVICE_INDEX_HANDLE device_index, void* device);
+    extern void real_device_index_destroy(DEVICE_INDEX_HANDLE device_index);
+
 #ifdef __cplusplus
 }
 #endif
@@ -485,6 +497,7 @@ static pfIoTHubTransport_Subscribe                      IoTHubTransportHttp_Subs
 static pfIoTHubTransport_Unsubscribe                    IoTHubTransportHttp_Unsubscribe;
 static pfIoTHubTransport_DoWork                         IoTHubTransportHttp_DoWork;
 static pfIoTHubTransport_GetSendStatus                  IoTHubTransportHttp_GetSendStatus;
+static pfIoTHubTransport_GetStatistics                  IoTHubTransportHttp_GetStatistics;
 
 static TEST_MUTEX_HANDLE g_testByTest;
 static TEST_MUTEX_HANDLE g_dllByDll;
@@ -515,6 +528,23 @@ static void my_HTTPAPIEX_Destroy(HTTPAPIEX_HANDLE handle)
     my_gballoc_free(handle);
 }
 
+/*the work posted to send events runs to completion as soon as it is posted*/
+static int my_callback_pool_post(CALLBACK_POOL_HANDLE pool, CALLBACK_POOL_WORK work, void* context, bool ordered)
+{
+    (void)pool;
+    (void)ordered;
+    work(context);
+    return 0;
+}
+
+static HTTPAPI_RESULT my_HTTPAPI_CloneOption(const char* optionName, const void* value, const void** savedValue)
+{
+    (void)optionName;
+    (void)value;
+    *savedValue = my_gballoc_malloc(1);
+    return HTTPAPI_OK;
+}
+
 static IOTHUB_CLIENT_RESULT my_IoTHubClient_LL_GetOption(IOTHUB_CLIENT_LL_HANDLE handle, const char* option, void** value)
 {
     (void)handle;
@@ -842,9 +872,11 @@ static void setupCreateHappyPathApiExHandle(bool deallocateCreated)
 static void setupCreateHappyPathPerDeviceList(bool deallocateCreated)
 {
     STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(device_index_create());
     if (deallocateCreated == true)
     {
         STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(device_index_destroy(IGNORED_PTR_ARG));
     }
 }
 
@@ -1018,12 +1050,13 @@ static void setupRegisterHappyPatheventConfirmations()
 
 static void setupRegisterHappyPathDeviceListAdd()
 {
+    STRICT_EXPECTED_CALL(device_index_add(IGNORED_PTR_ARG, TEST_DEVICE_ID, IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
 }
 
 static void setupRegisterHappyPathWithSasToken(bool deallocateCreated)
 {
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(device_index_find_by_id(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     setupRegisterHappyPathAllocHandle(deallocateCreated);
     setupRegisterHappyPathcreate_deviceId(deallocateCreated);
     setupRegisterHappyPathcreate_deviceSasToken(deallocateCreated);
@@ -1038,7 +1071,7 @@ static void setupRegisterHappyPathWithSasToken(bool deallocateCreated)
 
 static void setupRegisterHappyPath(bool deallocateCreated, bool is_x509_used)
 {
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(device_index_find_by_id(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     setupRegisterHappyPathAllocHandle(deallocateCreated);
     setupRegisterHappyPathcreate_deviceId(deallocateCreated);
     setupRegisterHappyPathcreate_deviceKey(deallocateCreated, is_x509_used);
@@ -1063,6 +1096,18 @@ static void setupDoWorkLoopForNextDevice(size_t next)
     STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, next));
 }
 
+/*a GET that the service answers with 204 (no message)*/
+static void setupDoWorkGetNoMessage(void)
+{
+    STRICT_EXPECTED_CALL(HTTPHeaders_Alloc());
+    STRICT_EXPECTED_CALL(BUFFER_new());
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, HTTPAPI_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments();
+    STRICT_EXPECTED_CALL(BUFFER_delete(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPHeaders_Free(IGNORED_PTR_ARG));
+}
+
 BEGIN_TEST_SUITE(iothubtransporthttp_ut)
 
 TEST_SUITE_INITIALIZE(suite_init)
@@ -1088,6 +1133,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(MAP_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(STRING_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(DEVICE_INDEX_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(PREDICATE_FUNCTION, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTP_HEADERS_HANDLE, void*);
@@ -1097,6 +1143,10 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPIEX_SAS_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_HANDLE, void*);
     REGISTER_UMOCK_ALIAS_TYPE(HTTPAPI_REQUEST_TYPE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(LOCK_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(COND_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CALLBACK_POOL_HANDLE, void*);
+    REGISTER_UMOCK_ALIAS_TYPE(CALLBACK_POOL_WORK, void*);
 
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_CLIENT_CONFIRMATION_RESULT, int);
     REGISTER_UMOCK_ALIAS_TYPE(IOTHUB_MESSAGE_RESULT, int);
@@ -1153,6 +1203,16 @@ TEST_SUITE_INITIALIZE(suite_init)
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(VECTOR_find_if, NULL);
     REGISTER_GLOBAL_MOCK_HOOK(VECTOR_size, real_VECTOR_size);
 
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_create, real_device_index_create);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_index_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_add, real_device_index_add);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_index_add, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_remove, real_device_index_remove);
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_find_by_id, real_device_index_find_by_id);
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_contains, real_device_index_contains);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(device_index_contains, false);
+    REGISTER_GLOBAL_MOCK_HOOK(device_index_destroy, real_device_index_destroy);
+
     REGISTER_GLOBAL_MOCK_HOOK(URL_EncodeString, my_URL_EncodeString);
     REGISTER_GLOBAL_MOCK_FAIL_RETURN(URL_EncodeString, NULL);
 
@@ -1201,6 +1261,19 @@ TEST_SUITE_INITIALIZE(suite_init)
 
     REGISTER_GLOBAL_MOCK_HOOK(HTTPAPIEX_SAS_Destroy, my_HTTPAPIEX_SAS_Destroy);
 
+    REGISTER_GLOBAL_MOCK_RETURN(Lock_Init, (LOCK_HANDLE)0x4242);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Lock_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(Lock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Unlock, LOCK_OK);
+    REGISTER_GLOBAL_MOCK_RETURN(Condition_Init, (COND_HANDLE)0x4243);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(Condition_Init, NULL);
+    REGISTER_GLOBAL_MOCK_RETURN(callback_pool_create, (CALLBACK_POOL_HANDLE)0x4244);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(callback_pool_create, NULL);
+    REGISTER_GLOBAL_MOCK_HOOK(callback_pool_post, my_callback_pool_post);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(callback_pool_post, __FAILURE__);
+    REGISTER_GLOBAL_MOCK_HOOK(HTTPAPI_CloneOption, my_HTTPAPI_CloneOption);
+    REGISTER_GLOBAL_MOCK_FAIL_RETURN(HTTPAPI_CloneOption, HTTPAPI_ERROR);
+
     REGISTER_GLOBAL_MOCK_HOOK(DList_InitializeListHead, real_DList_InitializeListHead);
     REGISTER_GLOBAL_MOCK_HOOK(DList_IsListEmpty, real_DList_IsListEmpty);
     REGISTER_GLOBAL_MOCK_HOOK(DList_InsertTailList, real_DList_InsertTailList);
@@ -1235,6 +1308,7 @@ TEST_SUITE_INITIALIZE(suite_init)
     IoTHubTransportHttp_Unsubscribe = ((TRANSPORT_PROVIDER*)HTTP_Protocol())->IoTHubTransport_Unsubscribe;
     IoTHubTransportHttp_DoWork = ((TRANSPORT_PROVIDER*)HTTP_Protocol())->IoTHubTransport_DoWork;
     IoTHubTransportHttp_GetSendStatus = ((TRANSPORT_PROVIDER*)HTTP_Protocol())->IoTHubTransport_GetSendStatus;
+    IoTHubTransportHttp_GetStatistics = ((TRANSPORT_PROVIDER*)HTTP_Protocol())->IoTHubTransport_GetStatistics;
 
     TEST_STRING_HANDLE = real_STRING_construct(TEST_STRING_DATA);
 }
@@ -1386,6 +1460,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Create_with_NULL_iothub_suffix_fails)
 //Tests_SRS_TRANSPORTMULTITHTTP_17_009: [ IoTHubTransportHttp_Create shall call VECTOR_create to create a list of registered devices. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_130: [ IoTHubTransportHttp_Create shall allocate memory for the handle. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_011: [ Otherwise, IoTHubTransportHttp_Create shall succeed and return a non-NULL value. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_024: [ IoTHubTransportHttp_Create shall call device_index_create to create an index of the registered devices. ]
 TEST_FUNCTION(IoTHubTransportHttp_Create_happy_path)
 {
     //arrange
@@ -1431,6 +1506,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Create_happy_path_with_gwhostname)
 //Tests_SRS_TRANSPORTMULTITHTTP_17_006: [ If creating the hostname fails then IoTHubTransportHttp_Create shall fail and return NULL. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_006: [ If creating the hostname fails then IoTHubTransportHttp_Create shall fail and return NULL. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_131: [ If allocation fails, IoTHubTransportHttp_Create shall fail and return NULL. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_025: [ If creating the index fails, then IoTHubTransportHttp_Create shall fail and return NULL. ]
 TEST_FUNCTION(IoTHubTransportHttp_Create_fails)
 {
     int negativeTestsInitResult = umock_c_negative_tests_init();
@@ -1493,6 +1569,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Destroy_succeeds_NoRegistered_devices)
     STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));                                             //HTTPAPIEX_HANDLE httpApiExHandle;
     STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(device_index_destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(handle));
 
     //act
@@ -1517,6 +1594,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Destroy_succeeds_One_Registered_device)
     STRICT_EXPECTED_CALL(gballoc_free(devHandle));
 
     STRICT_EXPECTED_CALL(VECTOR_destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(device_index_destroy(IGNORED_PTR_ARG));
     STRICT_EXPECTED_CALL(gballoc_free(handle));
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
 
@@ -1548,6 +1626,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Destroy_succeeds_One_Registered_device)
 //Tests_SRS_TRANSPORTMULTITHTTP_17_128: [ IoTHubTransportHttp_Register shall mark this device as unsubscribed. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_041: [ IoTHubTransportHttp_Register shall call VECTOR_push_back to store the new device information. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_043: [ Upon success, IoTHubTransportHttp_Register shall store the transport handle, iotHubClientHandle, and the waitingToSend queue in the device handle return a non-NULL value. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_019: [ IoTHubTransportHttp_Register shall search for deviceId by calling device_index_find_by_id on the transport device index. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_020: [ IoTHubTransportHttp_Register shall call device_index_add to add the new device to the transport device index. ]
 TEST_FUNCTION(IoTHubTransportHttp_Register_HappyPath_with_deviceKey_success_fun_time)
 {
     //arrange
@@ -1617,9 +1697,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Register_2nd_device_HappyPath_success_fun_time
     IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
     umock_c_reset_all_calls();
 
-    // find in vector..
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    // find in index..
+    STRICT_EXPECTED_CALL(device_index_find_by_id(IGNORED_PTR_ARG, TEST_DEVICE_ID));
     setupRegisterHappyPathAllocHandle(false);
     setupRegisterHappyPathcreate_deviceId(false);
     setupRegisterHappyPathcreate_deviceKey(false, false);
@@ -1657,10 +1736,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Register_sameDevice_twice_returns_null)
     (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
     umock_c_reset_all_calls();
 
-    // find in vector.. 2 and 1a
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
-    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    // find in index.. 1a
+    STRICT_EXPECTED_CALL(device_index_find_by_id(IGNORED_PTR_ARG, TEST_DEVICE_ID));
 
     //act 
     IOTHUB_DEVICE_HANDLE devHandle1b = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
@@ -1680,6 +1757,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Register_sameDevice_twice_returns_null)
 //Tests_SRS_TRANSPORTMULTITHTTP_17_032: [ If the STRING_concat_with_STRING fails then IoTHubTransportHttp_Register shall fail and return NULL. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_034: [ If the STRING_construct fails then IoTHubTransportHttp_Register shall fail and return NULL. ] 
 //Tests_SRS_TRANSPORTMULTITHTTP_17_035: [ The keyName is shortened to zero length, if that fails then IoTHubTransportHttp_Register shall fail and return NULL. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_021: [ If device_index_add fails then IoTHubTransportHttp_Register shall fail and return NULL. ]
 TEST_FUNCTION(IoTHubTransportHttp_Register_HappyPath_with_deviceKey_fail)
 {
     int negativeTestsInitResult = umock_c_negative_tests_init();
@@ -1693,7 +1771,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Register_HappyPath_with_deviceKey_fail)
 
     umock_c_negative_tests_snapshot();
 
-    size_t calls_cannot_fail[] = { 0, 8, 13, 19, 24, 25, 27, 28, 30, 31, 38, 46, 47, 48, 50, 51 };
+    size_t calls_cannot_fail[] = { 0, 8, 13, 19, 24, 25, 27, 28, 30, 31, 38, 46, 47, 48, 51, 52 };
 
     //act
     size_t count = umock_c_negative_tests_call_count();
@@ -2788,7 +2866,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Register_deviceFoundInList_fails)
     TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG)).SetReturn((void_ptr)0x1);
+    STRICT_EXPECTED_CALL(device_index_find_by_id(IGNORED_PTR_ARG, TEST_DEVICE_ID)).SetReturn((void_ptr)0x1);
 
     //act
     IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
@@ -2920,6 +2998,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Unregister_null_does_nothing)
 //Tests_SRS_TRANSPORTMULTITHTTP_17_045: [IoTHubTransportHttp_Unregister shall locate deviceHandle in the transport device list by calling VECTOR_find_if.]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_047 : [IoTHubTransportHttp_Unregister shall free all the resources used in the device structure.]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_048 : [IoTHubTransportHttp_Unregister shall call VECTOR_erase to remove device from devices list.]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_022: [ IoTHubTransportHttp_Unregister shall call device_index_remove to remove device from the transport device index. ]
 TEST_FUNCTION(IoTHubTransportHttp_Unregister_superHappyFunPath)
 {
     //arrange
@@ -2931,6 +3010,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Unregister_superHappyFunPath)
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     setupUnregisterOneDevice();
     STRICT_EXPECTED_CALL(VECTOR_erase(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(device_index_remove(IGNORED_PTR_ARG, devHandle));
     STRICT_EXPECTED_CALL(gballoc_free(devHandle));
 
     //act
@@ -2958,6 +3038,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Unregister_2nd_device_superHappyFunPath)
     STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
     setupUnregisterOneDevice();
     STRICT_EXPECTED_CALL(VECTOR_erase(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(device_index_remove(IGNORED_PTR_ARG, devHandle1));
     STRICT_EXPECTED_CALL(gballoc_free(devHandle1));
 
     //act
@@ -3004,6 +3085,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Subscribe_with_NULL_parameter_fails)
 
 //Tests_SRS_TRANSPORTMULTITHTTP_17_104: [ IoTHubTransportHttp_Subscribe shall locate deviceHandle in the transport device list by calling VECTOR_find_if. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_106: [ Otherwise, IoTHubTransportHttp_Subscribe shall set the device so that subsequent calls to DoWork should execute HTTP requests. 
+//Tests_SRS_TRANSPORTMULTITHTTP_09_023: [ IoTHubTransportHttp_Subscribe, IoTHubTransportHttp_Unsubscribe, IoTHubTransportHttp_GetSendStatus and IoTHubTransportHttp_GetStatistics shall locate deviceHandle by calling device_index_contains on the transport device index. ]
 TEST_FUNCTION(IoTHubTransportHttp_Subscribe_with_non_NULL_parameter_succeeds)
 {
     //arrange
@@ -3012,7 +3094,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Subscribe_with_non_NULL_parameter_succeeds)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle));
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle));
 
     //act
     int result = IoTHubTransportHttp_Subscribe(devHandle);
@@ -3035,8 +3117,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Subscribe_2devices_succeeds)
     IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle1));
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle2));
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle1));
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle2));
 
     //act
     int result1 = IoTHubTransportHttp_Subscribe(devHandle1);
@@ -3059,8 +3141,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Subscribe_with_list_find_fails)
     IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle))
-        .SetReturn((void_ptr)NULL);
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle))
+        .SetReturn(false);
 
     //act
     int result = IoTHubTransportHttp_Subscribe(devHandle);
@@ -3095,7 +3177,7 @@ TEST_FUNCTION(IoTHubTransportHttp_Unsubscribe_with_non_NULL_parameter_succeeds)
     IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle));
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle));
 
     //act
     IoTHubTransportHttp_Unsubscribe(devHandle);
@@ -3117,8 +3199,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Unsubscribe_with_2devices_succeeds)
     IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle));
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle2));
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle));
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle2));
 
     //act
     IoTHubTransportHttp_Unsubscribe(devHandle);
@@ -3140,8 +3222,8 @@ TEST_FUNCTION(IoTHubTransportHttp_Unsubscribe_with_device_not_found_does_nothing
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle))
-        .SetFailReturn((void_ptr)NULL);
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle))
+        .SetReturn(false);
 
     //act
     IoTHubTransportHttp_Unsubscribe(devHandle);
@@ -8892,10 +8974,12 @@ TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_1_event_item_when_HTTP_headers_fai
 //Tests_SRS_TRANSPORTMULTITHTTP_17_065: [ If the oldest message in waitingToSend causes the message size to exceed the message size limit then it shall be removed from waitingToSend, and IoTHubClient_LL_SendComplete shall be called. Parameter PDLIST_ENTRY completed shall point to a list containing only the oldest item, and parameter IOTHUB_BATCHSTATE result shall be set to IOTHUB_CLIENT_CONFIRMATION_ERROR. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_061: [ The message size shall be limited to 255KB - 1 byte. ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_062: [ The message size is computed from the length of the payload + 384. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_033: [ Every message taken off waitingToSend shall have its inWaitingToSend flag cleared. ]
 TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_1_event_item_bigger_than_256K_path_succeeds)
 {
     //arrange
      
+    message4.inWaitingToSend = true;
     DList_InsertTailList(&(waitingToSend), &(message4.entry));
     TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
     (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
@@ -8965,6 +9049,7 @@ TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_1_event_item_bigger_than_256K_path
 
     //assert
     ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+    ASSERT_IS_FALSE(message4.inWaitingToSend);
 
     //cleanup
     IoTHubTransportHttp_Destroy(handle);
@@ -9805,9 +9890,7 @@ TEST_FUNCTION(IoTHubTransportHttp_GetSendStatus_empty_waitingToSend_and_empty_ev
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle))
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle));
 
     STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
 
@@ -9842,9 +9925,7 @@ TEST_FUNCTION(IoTHubTransportHttp_GetSendStatus_waitingToSend_not_empty_success)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle))
-        .IgnoreArgument(1)
-        .IgnoreArgument(2);
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle));
     STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
 
     IOTHUB_CLIENT_STATUS status;
@@ -9878,10 +9959,8 @@ TEST_FUNCTION(IoTHubTransportHttp_GetSendStatus_deviceData_is_not_found_fails)
 
     umock_c_reset_all_calls();
 
-    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, devHandle))
-        .IgnoreArgument(1)
-        .IgnoreArgument(2)
-        .SetFailReturn((void_ptr)NULL);
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle))
+        .SetReturn(false);
 
     IOTHUB_CLIENT_STATUS status;
 
@@ -9898,6 +9977,88 @@ TEST_FUNCTION(IoTHubTransportHttp_GetSendStatus_deviceData_is_not_found_fails)
     IoTHubMessage_Destroy(eventMessageHandle);
 }
 
+//Tests_SRS_TRANSPORTMULTITHTTP_09_001: [ IoTHubTransportHttp_GetStatistics shall return IOTHUB_CLIENT_INVALID_ARG if called with NULL parameter. ]
+TEST_FUNCTION(IoTHubTransportHttp_GetStatistics_InvalidArguments_fail)
+{
+    // arrange
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+
+    umock_c_reset_all_calls();
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result1 = IoTHubTransportHttp_GetStatistics(NULL, &statistics);
+    IOTHUB_CLIENT_RESULT result2 = IoTHubTransportHttp_GetStatistics(devHandle, NULL);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result1);
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result2);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_003: [ IoTHubTransportHttp_GetStatistics shall set messagesSent, bytesSent and bytesReceived from the device counters, set reconnectCount and sasTokenRefreshCount to 0 and return IOTHUB_CLIENT_OK. ]
+TEST_FUNCTION(IoTHubTransportHttp_GetStatistics_after_Register_succeeds)
+{
+    // arrange
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle));
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+    (void)memset(&statistics, 0xFF, sizeof(statistics));
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_GetStatistics(devHandle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_IS_TRUE(statistics.messagesSent == 0);
+    ASSERT_IS_TRUE(statistics.bytesSent == 0);
+    ASSERT_IS_TRUE(statistics.bytesReceived == 0);
+    ASSERT_IS_TRUE(statistics.reconnectCount == 0);
+    ASSERT_IS_TRUE(statistics.sasTokenRefreshCount == 0);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_002: [ If the device structure is not found, then IoTHubTransportHttp_GetStatistics shall fail and return with IOTHUB_CLIENT_INVALID_ARG. ]
+TEST_FUNCTION(IoTHubTransportHttp_GetStatistics_deviceData_is_not_found_fails)
+{
+    // arrange
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(device_index_contains(IGNORED_PTR_ARG, devHandle))
+        .SetReturn(false);
+
+    IOTHUB_CLIENT_STATISTICS statistics;
+
+    // act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_GetStatistics(devHandle, &statistics);
+
+    // assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    // cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
 void setupIrrelevantMocksForProperties(CIoTHubTransportHttpMocks *IOTHUB_MESSAGE_HANDLE messageHandle) /*these are copy pasted from TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_1_event_items))*/
 {
     (void)(*mocks);
@@ -10619,6 +10780,7 @@ TEST_FUNCTION(IoTHubTransportHttp_SetOption_with_NULL_value_fails)
 
 //Tests_SRS_TRANSPORTMULTITHTTP_17_119: [ The following table translates HTTPAPIEX return codes to IOTHUB_CLIENT_RESULT return codes: ]
 //Tests_SRS_TRANSPORTMULTITHTTP_17_118: [ Otherwise, IoTHubTransport_Http shall call HTTPAPIEX_SetOption with the same parameters and return the translated code. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_028: [ The options passed to HTTPAPIEX_SetOption shall be saved by calling HTTPAPI_CloneOption and passed to the HTTPAPIEX_HANDLEs created by a later EventSendConcurrency, so that the options and EventSendConcurrency can be set in any order. ]
 TEST_FUNCTION(IoTHubTransportHttp_SetOption_succeeds_when_HTTPAPIEX_succeeds)
 {
     //arrange
@@ -10627,6 +10789,11 @@ TEST_FUNCTION(IoTHubTransportHttp_SetOption_succeeds_when_HTTPAPIEX_succeeds)
     umock_c_reset_all_calls();
 
     STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(TEST_HTTPAPIEX_HANDLE, "someOption", (void*)42));
+    STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_CloneOption("someOption", (void*)42, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_construct("someOption"));
+    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
 
     //act
     auto result = IoTHubTransportHttp_SetOption(handle, "someOption", (void*)42);
@@ -10708,6 +10875,713 @@ TEST_FUNCTION(IoTHubTransportHttp_SetOption_fails_when_HTTPAPIEX_returns_any_oth
     IoTHubTransportHttp_Destroy(handle);
 }
 
+//Tests_SRS_TRANSPORTMULTITHTTP_09_004: [ "MaximumPollingTime" ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_MaximumPollingTime_succeeds)
+{
+    //arrange
+    unsigned int maximumPollingTime = 300;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLING_TIME, &maximumPollingTime);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_008: [ "MaximumPollsPerDoWork" ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_MaximumPollsPerDoWork_succeeds)
+{
+    //arrange
+    size_t maximumPollsPerDoWork = 4;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLS_PER_DO_WORK, &maximumPollsPerDoWork);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_005: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET that completes with status code 204 shall double the polling time of the device, up to MaximumPollingTime. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_007: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET request that happens earlier than the polling time of the device shall be ignored. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_MaximumPollingTime_doubles_the_polling_time_after_a_GET_without_message)
+{
+    //arrange
+    unsigned int minimumPollingTime = 10;
+    unsigned int maximumPollingTime = 40;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MIN_POLLING_TIME, &minimumPollingTime);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLING_TIME, &maximumPollingTime);
+    IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle);
+
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE);
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE); /*the service answers 204, the polling time becomes 20 seconds*/
+    umock_c_reset_all_calls();
+
+    setupDoWorkLoopOnceForOneDevice();
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE + 15);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_GET_TIME_VALUE + 15, TEST_GET_TIME_VALUE))
+        .IgnoreAllArguments()
+        .SetReturn(15.0);
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_005: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET that completes with status code 204 shall double the polling time of the device, up to MaximumPollingTime. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_MaximumPollingTime_does_not_grow_the_polling_time_above_MaximumPollingTime)
+{
+    //arrange
+    unsigned int minimumPollingTime = 10;
+    unsigned int maximumPollingTime = 15;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MIN_POLLING_TIME, &minimumPollingTime);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLING_TIME, &maximumPollingTime);
+    IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle);
+
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE);
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE); /*the service answers 204, the polling time becomes 15 seconds*/
+    umock_c_reset_all_calls();
+
+    setupDoWorkLoopOnceForOneDevice();
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE + 16);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_GET_TIME_VALUE + 16, TEST_GET_TIME_VALUE))
+        .IgnoreAllArguments()
+        .SetReturn(16.0);
+    setupDoWorkGetNoMessage();
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_006: [ If MaximumPollingTime is greater than MinimumPollingTime, a GET that completes with status code 200 shall set the polling time of the device back to MinimumPollingTime. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_MaximumPollingTime_sets_the_polling_time_back_to_MinimumPollingTime_after_a_message)
+{
+    //arrange
+    unsigned int statusCode200 = 200;
+    unsigned int minimumPollingTime = 10;
+    unsigned int maximumPollingTime = 40;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MIN_POLLING_TIME, &minimumPollingTime);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLING_TIME, &maximumPollingTime);
+    IOTHUB_DEVICE_HANDLE devHandle = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle);
+
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE);
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE); /*the service answers 204, the polling time becomes 20 seconds*/
+
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE + 21);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_GET_TIME_VALUE + 21, TEST_GET_TIME_VALUE))
+        .IgnoreAllArguments()
+        .SetReturn(21.0);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SAS_ExecuteRequest(IGNORED_PTR_ARG, IGNORED_PTR_ARG, HTTPAPI_REQUEST_GET, IGNORED_PTR_ARG, IGNORED_PTR_ARG, NULL, IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+        .IgnoreAllArguments()
+        .CopyOutArgumentBuffer(7, &statusCode200, sizeof(statusCode200));
+    STRICT_EXPECTED_CALL(HTTPHeaders_FindHeaderValue(IGNORED_PTR_ARG, "ETag"))
+        .IgnoreArgument(1)
+        .SetReturn(NULL);
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE); /*the service answers 200, the polling time goes back to 10 seconds*/
+    umock_c_reset_all_calls();
+
+    setupDoWorkLoopOnceForOneDevice();
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+    STRICT_EXPECTED_CALL(get_time(NULL))
+        .SetReturn(TEST_GET_TIME_VALUE + 32);
+    STRICT_EXPECTED_CALL(get_difftime(TEST_GET_TIME_VALUE + 32, TEST_GET_TIME_VALUE + 21))
+        .IgnoreAllArguments()
+        .SetReturn(11.0);
+    setupDoWorkGetNoMessage();
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_009: [ Once MaximumPollsPerDoWork GET requests were attempted, IoTHubTransportHttp_DoWork shall not pull messages for the rest of the devices. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_MaximumPollsPerDoWork_stops_polling_when_the_limit_is_reached)
+{
+    //arrange
+    size_t maximumPollsPerDoWork = 1;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLS_PER_DO_WORK, &maximumPollsPerDoWork);
+    IOTHUB_DEVICE_HANDLE devHandle1 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle1);
+    (void)IoTHubTransportHttp_Subscribe(devHandle2);
+    umock_c_reset_all_calls();
+
+    setupDoWorkLoopOnceForOneDevice();
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    setupDoWorkGetNoMessage();
+    setupDoWorkLoopForNextDevice(1);
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend2));
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_010: [ If MaximumPollsPerDoWork is not 0, IoTHubTransportHttp_DoWork shall start the loop with the device following the last device that issued a GET in the previous call. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_MaximumPollsPerDoWork_starts_with_the_device_after_the_last_polled_one)
+{
+    //arrange
+    size_t maximumPollsPerDoWork = 1;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_MAX_POLLS_PER_DO_WORK, &maximumPollsPerDoWork);
+    IOTHUB_DEVICE_HANDLE devHandle1 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle1);
+    (void)IoTHubTransportHttp_Subscribe(devHandle2);
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE); /*polls only the first device*/
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    setupDoWorkLoopForNextDevice(1);
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend2));
+    STRICT_EXPECTED_CALL(get_time(NULL));
+    setupDoWorkGetNoMessage();
+    setupDoWorkLoopForNextDevice(0);
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_011: [ "EventSendConcurrency" ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_018: [ Setting EventSendConcurrency to more than 1 shall create EventSendConcurrency - 1 HTTPAPIEX_HANDLEs by calling HTTPAPIEX_Create with the host name, kept until the transport is destroyed. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_026: [ Setting EventSendConcurrency to more than 1 shall also create a lock, a condition and a callback pool of EventSendConcurrency - 1 threads by calling callback_pool_create, reused by every call to IoTHubTransportHttp_DoWork. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_EventSendConcurrency_creates_the_connections)
+{
+    //arrange
+    size_t eventSendConcurrency = 3;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(callback_pool_create(2));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_018: [ Setting EventSendConcurrency to more than 1 shall create EventSendConcurrency - 1 HTTPAPIEX_HANDLEs by calling HTTPAPIEX_Create with the host name, kept until the transport is destroyed. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_027: [ If any of them cannot be created, setting EventSendConcurrency shall destroy what was created, keep the previous EventSendConcurrency and return IOTHUB_CLIENT_ERROR. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_EventSendConcurrency_fails_when_HTTPAPIEX_Create_fails)
+{
+    //arrange
+    size_t eventSendConcurrency = 3;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_027: [ If any of them cannot be created, setting EventSendConcurrency shall destroy what was created, keep the previous EventSendConcurrency and return IOTHUB_CLIENT_ERROR. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_EventSendConcurrency_fails_when_callback_pool_create_fails)
+{
+    //arrange
+    size_t eventSendConcurrency = 3;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(callback_pool_create(2))
+        .SetReturn(NULL);
+    STRICT_EXPECTED_CALL(Condition_Deinit(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Deinit(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_011: [ "EventSendConcurrency" ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_EventSendConcurrency_0_fails)
+{
+    //arrange
+    size_t eventSendConcurrency = 0;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_INVALID_ARG, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_028: [ The options passed to HTTPAPIEX_SetOption shall be saved by calling HTTPAPI_CloneOption and passed to the HTTPAPIEX_HANDLEs created by a later EventSendConcurrency, so that the options and EventSendConcurrency can be set in any order. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_EventSendConcurrency_after_an_HTTPAPIEX_option_passes_it_to_the_new_connections)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, "someOption", (void*)42);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "someOption", IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(Lock_Init());
+    STRICT_EXPECTED_CALL(Condition_Init());
+    STRICT_EXPECTED_CALL(callback_pool_create(1));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_027: [ If any of them cannot be created, setting EventSendConcurrency shall destroy what was created, keep the previous EventSendConcurrency and return IOTHUB_CLIENT_ERROR. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_EventSendConcurrency_fails_when_a_saved_option_cannot_be_set)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, "someOption", (void*)42);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Create(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "someOption", IGNORED_PTR_ARG))
+        .SetReturn(HTTPAPIEX_ERROR);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_Destroy(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_013: [ The options passed to HTTPAPIEX_SetOption shall also be passed to the HTTPAPIEX_HANDLEs created for EventSendConcurrency. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_with_EventSendConcurrency_passes_the_option_to_every_connection)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "someOption", (void*)42))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(IGNORED_PTR_ARG, "someOption", (void*)42))
+        .IgnoreArgument(1);
+    STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_CloneOption("someOption", (void*)42, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_construct("someOption"));
+    STRICT_EXPECTED_CALL(VECTOR_push_back(IGNORED_PTR_ARG, IGNORED_PTR_ARG, 1));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, "someOption", (void*)42);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_028: [ The options passed to HTTPAPIEX_SetOption shall be saved by calling HTTPAPI_CloneOption and passed to the HTTPAPIEX_HANDLEs created by a later EventSendConcurrency, so that the options and EventSendConcurrency can be set in any order. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_keeps_the_last_value_of_an_HTTPAPIEX_option)
+{
+    //arrange
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, "someOption", (void*)42);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(TEST_HTTPAPIEX_HANDLE, "someOption", (void*)43));
+    STRICT_EXPECTED_CALL(HTTPAPI_CloneOption("someOption", (void*)43, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_find_if(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, "someOption", (void*)43);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_OK, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_028: [ The options passed to HTTPAPIEX_SetOption shall be saved by calling HTTPAPI_CloneOption and passed to the HTTPAPIEX_HANDLEs created by a later EventSendConcurrency, so that the options and EventSendConcurrency can be set in any order. ]
+TEST_FUNCTION(IoTHubTransportHttp_SetOption_fails_when_the_HTTPAPIEX_option_cannot_be_saved)
+{
+    //arrange
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(HTTPAPIEX_SetOption(TEST_HTTPAPIEX_HANDLE, "someOption", (void*)42));
+    STRICT_EXPECTED_CALL(VECTOR_create(IGNORED_NUM_ARG));
+    STRICT_EXPECTED_CALL(HTTPAPI_CloneOption("someOption", (void*)42, IGNORED_PTR_ARG))
+        .SetReturn(HTTPAPI_ERROR);
+
+    //act
+    IOTHUB_CLIENT_RESULT result = IoTHubTransportHttp_SetOption(handle, "someOption", (void*)42);
+
+    //assert
+    ASSERT_ARE_EQUAL(IOTHUB_CLIENT_RESULT, IOTHUB_CLIENT_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_014: [ If EventSendConcurrency is greater than 1 and more than 1 device has events waiting, IoTHubTransportHttp_DoWork shall send the events of the devices from up to EventSendConcurrency - 1 work items posted to the callback pool (at most one per device with events beyond the first) and the calling thread, each using its own HTTPAPIEX_HANDLE. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_015: [ Each device shall have its events sent by exactly one of the threads, so that the events of a device keep their order. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_posts_1_work_item_for_2_devices)
+{
+    //arrange
+    size_t eventSendConcurrency = 4;
+    bool batching = true;
+    DList_InsertTailList(&(waitingToSend), &(message1.entry));
+    DList_InsertTailList(&(waitingToSend2), &(message10.entry));
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_BATCHING, &batching);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    const char* actualCalls = umock_c_get_actual_calls();
+    const char* posted = strstr(actualCalls, "callback_pool_post(");
+    const char* firstSent = strstr(actualCalls, "HTTPAPIEX_SAS_ExecuteRequest(");
+    ASSERT_IS_NOT_NULL(posted);
+    ASSERT_IS_NULL(strstr(posted + 1, "callback_pool_post(")); /*only 1 work item for 2 devices, even if concurrency is 4*/
+    ASSERT_IS_NOT_NULL(firstSent);
+    ASSERT_IS_NOT_NULL(strstr(firstSent + 1, "HTTPAPIEX_SAS_ExecuteRequest("));
+    ASSERT_IS_NULL(strstr(actualCalls, "Lock_Init(")); /*the workers are reused from one DoWork to the next*/
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_029: [ If fewer than 2 devices have events waiting, IoTHubTransportHttp_DoWork shall send the events from the calling thread without posting work to the callback pool. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_does_not_post_work_when_no_events_are_waiting)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    umock_c_reset_all_calls();
+
+    STRICT_EXPECTED_CALL(VECTOR_size(IGNORED_PTR_ARG));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend2));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0)); /*no device is subscribed, no GET is due*/
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 0));
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend));
+    STRICT_EXPECTED_CALL(VECTOR_element(IGNORED_PTR_ARG, 1));
+    STRICT_EXPECTED_CALL(DList_IsListEmpty(&waitingToSend2));
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_016: [ Events sent by a worker thread shall keep their confirmation until IoTHubTransportHttp_DoWork calls IoTHubClient_LL_SendComplete for them from the calling thread, in the order of the device list. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_calls_SendComplete_once_the_workers_are_done)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    bool batching = true;
+    DList_InsertTailList(&(waitingToSend), &(message1.entry));
+    DList_InsertTailList(&(waitingToSend2), &(message10.entry));
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_BATCHING, &batching);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    const char* actualCalls = umock_c_get_actual_calls();
+    const char* posted = strstr(actualCalls, "callback_pool_post(");
+    const char* sent = strstr(actualCalls, "HTTPAPIEX_SAS_ExecuteRequest(");
+    const char* completed = strstr(actualCalls, "IoTHubClient_LL_SendComplete(");
+    ASSERT_IS_NOT_NULL(posted);
+    ASSERT_IS_NOT_NULL(sent);
+    ASSERT_IS_NOT_NULL(completed);
+    ASSERT_IS_TRUE(posted < sent);
+    ASSERT_IS_TRUE(sent < completed);
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_017: [ If the threads cannot be set up, IoTHubTransportHttp_DoWork shall send the events of all the devices from the calling thread. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_sends_from_the_calling_thread_when_callback_pool_post_fails)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    bool batching = true;
+    DList_InsertTailList(&(waitingToSend), &(message1.entry));
+    DList_InsertTailList(&(waitingToSend2), &(message10.entry));
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_BATCHING, &batching);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(callback_pool_post(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, false))
+        .SetReturn(__FAILURE__);
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    const char* actualCalls = umock_c_get_actual_calls();
+    const char* firstSent = strstr(actualCalls, "HTTPAPIEX_SAS_ExecuteRequest(");
+    ASSERT_IS_NOT_NULL(firstSent);
+    ASSERT_IS_NOT_NULL(strstr(firstSent + 1, "HTTPAPIEX_SAS_ExecuteRequest("));
+    ASSERT_IS_NOT_NULL(strstr(actualCalls, "IoTHubClient_LL_SendComplete("));
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_030: [ If EventSendConcurrency is greater than 1 and more than 1 device is due for a GET, IoTHubTransportHttp_DoWork shall issue the GETs from up to EventSendConcurrency - 1 work items posted to the callback pool (at most one per due device beyond the first) and the calling thread, each using its own HTTPAPIEX_HANDLE. ]
+//Tests_SRS_TRANSPORTMULTITHTTP_09_031: [ The responses of the GETs issued from the callback pool shall be processed by IoTHubTransportHttp_DoWork from the calling thread, in the order of the device list, so that IoTHubClient_LL_MessageCallback and the message dispositions stay on the calling thread. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_gets_the_messages_of_2_devices_before_processing_them)
+{
+    //arrange
+    size_t eventSendConcurrency = 4;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    IOTHUB_DEVICE_HANDLE devHandle1 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle1);
+    (void)IoTHubTransportHttp_Subscribe(devHandle2);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    const char* actualCalls = umock_c_get_actual_calls();
+    const char* posted = strstr(actualCalls, "callback_pool_post(");
+    const char* firstGet = strstr(actualCalls, "HTTPAPIEX_SAS_ExecuteRequest(");
+    const char* processed = strstr(actualCalls, "HTTPHeaders_Free(");
+    ASSERT_IS_NOT_NULL(posted);
+    ASSERT_IS_NULL(strstr(posted + 1, "callback_pool_post(")); /*only 1 work item for 2 devices, even if concurrency is 4*/
+    ASSERT_IS_NOT_NULL(firstGet);
+    ASSERT_IS_NOT_NULL(processed);
+    const char* secondGet = strstr(firstGet + 1, "HTTPAPIEX_SAS_ExecuteRequest(");
+    ASSERT_IS_NOT_NULL(secondGet);
+    ASSERT_IS_TRUE(secondGet < processed); /*both GETs are done before the first response is processed*/
+    ASSERT_IS_NOT_NULL(strstr(processed + 1, "HTTPHeaders_Free("));
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_032: [ If fewer than 2 devices are due for a GET or the threads cannot be set up, IoTHubTransportHttp_DoWork shall issue the GETs from the calling thread. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_gets_the_message_of_1_device_without_posting_work)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    IOTHUB_DEVICE_HANDLE devHandle1 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    (void)IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle1);
+    umock_c_reset_all_calls();
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    const char* actualCalls = umock_c_get_actual_calls();
+    const char* get = strstr(actualCalls, "HTTPAPIEX_SAS_ExecuteRequest(");
+    ASSERT_IS_NULL(strstr(actualCalls, "callback_pool_post("));
+    ASSERT_IS_NOT_NULL(get);
+    ASSERT_IS_NULL(strstr(get + 1, "HTTPAPIEX_SAS_ExecuteRequest("));
+    ASSERT_IS_NOT_NULL(strstr(get, "HTTPHeaders_Free("));
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
+//Tests_SRS_TRANSPORTMULTITHTTP_09_032: [ If fewer than 2 devices are due for a GET or the threads cannot be set up, IoTHubTransportHttp_DoWork shall issue the GETs from the calling thread. ]
+TEST_FUNCTION(IoTHubTransportHttp_DoWork_with_EventSendConcurrency_gets_the_messages_from_the_calling_thread_when_callback_pool_post_fails)
+{
+    //arrange
+    size_t eventSendConcurrency = 2;
+    TRANSPORT_LL_HANDLE handle = IoTHubTransportHttp_Create(&TEST_CONFIG);
+    (void)IoTHubTransportHttp_SetOption(handle, OPTION_EVENT_SEND_CONCURRENCY, &eventSendConcurrency);
+    IOTHUB_DEVICE_HANDLE devHandle1 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_1, TEST_IOTHUB_CLIENT_LL_HANDLE, TEST_CONFIG.waitingToSend);
+    IOTHUB_DEVICE_HANDLE devHandle2 = IoTHubTransportHttp_Register(handle, &TEST_DEVICE_2, TEST_IOTHUB_CLIENT_LL_HANDLE2, TEST_CONFIG2.waitingToSend);
+    (void)IoTHubTransportHttp_Subscribe(devHandle1);
+    (void)IoTHubTransportHttp_Subscribe(devHandle2);
+    umock_c_reset_all_calls();
+
+    EXPECTED_CALL(callback_pool_post(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG, false))
+        .SetReturn(__FAILURE__);
+
+    //act
+    IoTHubTransportHttp_DoWork(handle, TEST_IOTHUB_CLIENT_LL_HANDLE);
+
+    //assert
+    const char* actualCalls = umock_c_get_actual_calls();
+    const char* firstGet = strstr(actualCalls, "HTTPAPIEX_SAS_ExecuteRequest(");
+    const char* processed = strstr(actualCalls, "HTTPHeaders_Free(");
+    ASSERT_IS_NOT_NULL(firstGet);
+    ASSERT_IS_NOT_NULL(processed);
+    ASSERT_IS_NOT_NULL(strstr(firstGet + 1, "HTTPAPIEX_SAS_ExecuteRequest("));
+    ASSERT_IS_NOT_NULL(strstr(processed + 1, "HTTPHeaders_Free("));
+
+    //cleanup
+    IoTHubTransportHttp_Destroy(handle);
+}
+
 //Tests_SRS_TRANSPORTMULTITHTTP_17_096: [ If IoTHubClient_LL_MessageCallback returns IOTHUBMESSAGE_ABANDONED then _DoWork shall "abandon" the message. ]
 TEST_FUNCTION(IoTHubTransportHttp_DoWork_happy_path_with_empty_waitingToSend_and_1_service_message_with_abandon_succeeds)
 {
@@ -0,0 +1,13 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#define device_index_create real_device_index_create
+#define device_index_add real_device_index_add
+#define device_index_remove real_device_index_remove
+#define device_index_find_by_id real_device_index_find_by_id
+#define device_index_contains real_device_index_contains
+#define device_index_destroy real_device_index_destroy
+
+#define GBALLOC_H
+
+#include "../../src/iothub_client_device_index.c"
@@ -0,0 +1,357 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <float.h>
+#include "azure_c_shared_utility/strings.h"
+#include "azure_c_shared_utility/crt_abstractions.h"
+#include "agenttypesystem.h"
+#include "serializer_benchmarks.h"
+
+/*every operation formats all the values of a set, the way one telemetry message with this many fields is encoded*/
+#define VALUES_PER_OPERATION 16
+
+/*readings of the kind a device sends: a few decimals, coordinates, counters and small negative offsets*/
+static const double DOUBLE_VALUES[VALUES_PER_OPERATION] =
+{
+    21.5, 60.25, 1013.25, 0.1, 3.14159, 47.6062, -122.3321, 12345.678,
+    0.001, 98.6, -40.0, 255.0, 1.0 / 3.0, 6.02214076, 299792458.0, -0.5
+};
+
+static const int64_t INT64_VALUES[VALUES_PER_OPERATION] =
+{
+    0, 1, -1, 42, 1000, -32768, 65535, 2147483647,
+    -2147483647 - 1, 1234567890123LL, -987654321098LL, 1475072240000LL, 7, 99, -100, INT64_MAX
+};
+
+typedef struct TOSTRING_BENCHMARK_CONTEXT_TAG
+{
+    /*emptied before every operation and reused, like the scratch STRING_HANDLE of JSONEncoder_EncodeProperties*/
+    STRING_HANDLE destination;
+    AGENT_DATA_TYPE values[VALUES_PER_OPERATION];
+    size_t value_count;
+} TOSTRING_BENCHMARK_CONTEXT;
+
+static TOSTRING_BENCHMARK_CONTEXT* create_context(void)
+{
+    TOSTRING_BENCHMARK_CONTEXT* result;
+
+    if ((result = (TOSTRING_BENCHMARK_CONTEXT*)malloc(sizeof(TOSTRING_BENCHMARK_CONTEXT))) != NULL)
+    {
+        result->value_count = 0;
+        if ((result->destination = STRING_new()) == NULL)
+        {
+            free(result);
+            result = NULL;
+        }
+    }
+
+    return result;
+}
+
+static void tostring_teardown(void* context)
+{
+    TOSTRING_BENCHMARK_CONTEXT* tostring_context = (TOSTRING_BENCHMARK_CONTEXT*)context;
+    size_t i;
+
+    for (i = 0; i < tostring_context->value_count; i++)
+    {
+        Destroy_AGENT_DATA_TYPE(&tostring_context->values[i]);
+    }
+    STRING_delete(tostring_context->destination);
+    free(tostring_context);
+}
+
+/*builds one AGENT_DATA_TYPE per entry of DOUBLE_VALUES or INT64_VALUES (narrowed to the benchmarked type)*/
+static int setup_values(void** context, AGENT_DATA_TYPE_TYPE type)
+{
+    int result = 0;
+    TOSTRING_BENCHMARK_CONTEXT* tostring_context;
+
+    if ((tostring_context = create_context()) == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        size_t i;
+
+        for (i = 0; i < VALUES_PER_OPERATION; i++)
+        {
+            AGENT_DATA_TYPES_RESULT create_result;
+            AGENT_DATA_TYPE* value = &tostring_context->values[i];
+
+            switch (type)
+            {
+            default:
+                create_result = AGENT_DATA_TYPES_INVALID_ARG;
+                break;
+#ifndef NO_FLOATS
+            case EDM_DOUBLE_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_DOUBLE(value, DOUBLE_VALUES[i]);
+                break;
+            case EDM_SINGLE_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_FLOAT(value, (float)DOUBLE_VALUES[i]);
+                break;
+#endif
+            case EDM_INT64_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_SINT64(value, INT64_VALUES[i]);
+                break;
+            case EDM_INT32_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_SINT32(value, (int32_t)INT64_VALUES[i]);
+                break;
+            case EDM_INT16_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_SINT16(value, (int16_t)INT64_VALUES[i]);
+                break;
+            case EDM_SBYTE_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_SINT8(value, (int8_t)INT64_VALUES[i]);
+                break;
+            case EDM_BYTE_TYPE:
+                create_result = Create_AGENT_DATA_TYPE_from_UINT8(value, (uint8_t)INT64_VALUES[i]);
+                break;
+            }
+
+            if (create_result != AGENT_DATA_TYPES_OK)
+            {
+                result = __LINE__;
+                break;
+            }
+            tostring_context->value_count++;
+        }
+
+        if (result != 0)
+        {
+            tostring_teardown(tostring_context);
+        }
+        else
+        {
+            *context = tostring_context;
+        }
+    }
+
+    return result;
+}
+
+#ifndef NO_FLOATS
+static int double_setup(void** context)
+{
+    return setup_values(context, EDM_DOUBLE_TYPE);
+}
+
+static int single_setup(void** context)
+{
+    return setup_values(context, EDM_SINGLE_TYPE);
+}
+#endif
+
+static int int64_setup(void** context)
+{
+    return setup_values(context, EDM_INT64_TYPE);
+}
+
+static int int32_setup(void** context)
+{
+    return setup_values(context, EDM_INT32_TYPE);
+}
+
+static int int16_setup(void** context)
+{
+    return setup_values(context, EDM_INT16_TYPE);
+}
+
+static int sbyte_setup(void** context)
+{
+    return setup_values(context, EDM_SBYTE_TYPE);
+}
+
+static int byte_setup(void** context)
+{
+    return setup_values(context, EDM_BYTE_TYPE);
+}
+
+static int tostring_run_once(void* context)
+{
+    int result = 0;
+    TOSTRING_BENCHMARK_CONTEXT* tostring_context = (TOSTRING_BENCHMARK_CONTEXT*)context;
+    size_t i;
+
+    if (STRING_empty(tostring_context->destination) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        for (i = 0; i < tostring_context->value_count; i++)
+        {
+            if (AgentDataTypes_ToString(tostring_context->destination, &tostring_context->values[i]) != AGENT_DATA_TYPES_OK)
+            {
+                result = __LINE__;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*
+ * The legacy_* benchmarks reproduce how AgentDataTypes_ToString formatted numbers before it wrote them into a stack
+ * buffer: doubles and floats went through a heap buffer and "%.*f", integers through a loop over the decimal ranks.
+ */
+#ifndef NO_FLOATS
+static int legacy_double_to_string(STRING_HANDLE destination, double value)
+{
+    int result;
+    size_t tempBufferSize = DECIMAL_DIG * 2;
+    char* tempBuffer = (char*)malloc(tempBufferSize);
+
+    if (tempBuffer == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value) < 0 ||
+            STRING_concat(destination, tempBuffer) != 0)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+        free(tempBuffer);
+    }
+
+    return result;
+}
+
+static int legacy_single_to_string(STRING_HANDLE destination, float value)
+{
+    int result;
+    size_t tempBufferSize = DECIMAL_DIG * 2 + 2;
+    char* tempBuffer = (char*)malloc(tempBufferSize);
+
+    if (tempBuffer == NULL)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)value) < 0 ||
+            STRING_concat(destination, tempBuffer) != 0)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            result = 0;
+        }
+        free(tempBuffer);
+    }
+
+    return result;
+}
+#endif
+
+static int legacy_int64_to_string(STRING_HANDLE destination, int64_t value)
+{
+    char buffertemp2[21];
+    uint64_t positiveValue;
+    size_t pos = 0;
+    uint64_t rank = 10000000000000000000ULL;
+    int foundFirstDigit = 0;
+
+    if (value < 0)
+    {
+        buffertemp2[pos++] = '-';
+        positiveValue = (uint64_t)0 - (uint64_t)value;
+    }
+    else
+    {
+        positiveValue = (uint64_t)value;
+    }
+
+    while (rank >= 10)
+    {
+        if (foundFirstDigit || (positiveValue / rank) > 0)
+        {
+            buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
+            foundFirstDigit = 1;
+        }
+        positiveValue %= rank;
+        rank /= 10;
+    }
+    buffertemp2[pos++] = '0' + (char)(positiveValue);
+    buffertemp2[pos++] = '\0';
+
+    return (STRING_concat(destination, buffertemp2) != 0) ? __LINE__ : 0;
+}
+
+static int legacy_run_once(void* context)
+{
+    int result = 0;
+    TOSTRING_BENCHMARK_CONTEXT* tostring_context = (TOSTRING_BENCHMARK_CONTEXT*)context;
+    size_t i;
+
+    if (STRING_empty(tostring_context->destination) != 0)
+    {
+        result = __LINE__;
+    }
+    else
+    {
+        for (i = 0; (result == 0) && (i < tostring_context->value_count); i++)
+        {
+            const AGENT_DATA_TYPE* value = &tostring_context->values[i];
+
+            switch (value->type)
+            {
+            default:
+                result = __LINE__;
+                break;
+#ifndef NO_FLOATS
+            case EDM_DOUBLE_TYPE:
+                result = legacy_double_to_string(tostring_context->destination, value->value.edmDouble.value);
+                break;
+            case EDM_SINGLE_TYPE:
+                result = legacy_single_to_string(tostring_context->destination, value->value.edmSingle.value);
+                break;
+#endif
+            case EDM_INT64_TYPE:
+                result = legacy_int64_to_string(tostring_context->destination, value->value.edmInt64.value);
+                break;
+            case EDM_INT32_TYPE:
+                result = legacy_int64_to_string(tostring_context->destination, value->value.edmInt32.value);
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+static const BENCHMARK agenttypesystem_benchmarks[] =
+{
+#ifndef NO_FLOATS
+    { "agenttypesystem_tostring_double", double_setup, tostring_run_once, tostring_teardown, 0 },
+    { "agenttypesystem_tostring_single", single_setup, tostring_run_once, tostring_teardown, 0 },
+#endif
+    { "agenttypesystem_tostring_int64", int64_setup, tostring_run_once, tostring_teardown, 0 },
+    { "agenttypesystem_tostring_int32", int32_setup, tostring_run_once, tostring_teardown, 0 },
+    { "agenttypesystem_tostring_int16", int16_setup, tostring_run_once, tostring_teardown, 0 },
+    { "agenttypesystem_tostring_sbyte", sbyte_setup, tostring_run_once, tostring_teardown, 0 },
+    { "agenttypesystem_tostring_byte", byte_setup, tostring_run_once, tostring_teardown, 0 },
+#ifndef NO_FLOATS
+    { "legacy_tostring_double", double_setup, legacy_run_once, tostring_teardown, 0 },
+    { "legacy_tostring_single", single_setup, legacy_run_once, tostring_teardown, 0 },
+#endif
+    { "legacy_tostring_int64", int64_setup, legacy_run_once, tostring_teardown, 0 },
+    { "legacy_tostring_int32", int32_setup, legacy_run_once, tostring_teardown, 0 }
+};
+
+const BENCHMARK* agenttypesystem_benchmarks_get(size_t* count)
+{
+    *count = sizeof(agenttypesystem_benchmarks) / sizeof(agenttypesystem_benchmarks[0]);
+    return agenttypesystem_benchmarks;
+}
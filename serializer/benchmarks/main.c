@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#include "serializer_benchmarks.h"
+
+static const BENCHMARK_GROUP_GET benchmark_groups[] =
+{
+    agenttypesystem_benchmarks_get,
+};
+
+/*
+ * usage: serializer_benchmarks [iterations [name_filter]]
+ *
+ * Prints one JSON object per line (see readme.md) for each benchmark whose name contains name_filter.
+ * Returns non-zero if any benchmark failed.
+ */
+int main(int argc, char** argv)
+{
+    return benchmark_main(argc, argv, benchmark_groups, sizeof(benchmark_groups) / sizeof(benchmark_groups[0]));
+}
@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef SERIALIZER_BENCHMARKS_H
+#define SERIALIZER_BENCHMARKS_H
+
+#include <stddef.h>
+#include "benchmark.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+extern const BENCHMARK* agenttypesystem_benchmarks_get(size_t* count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SERIALIZER_BENCHMARKS_H */
@@ -22,9 +22,24 @@ typedef enum JSON_DECODER_RESULT_TAG
     JSON_DECODER_ERROR
 } JSON_DECODER_RESULT;
 
+/*reads a JSON text in place, one member or value at a time, without building a MULTITREE_HANDLE*/
+/*the fields are private to jsondecoder.c; the structure is public so that a reader can live on the stack*/
+typedef struct JSON_DECODER_READER_TAG
+{
+    char* json;
+    char* terminator;
+    char terminatedChar;
+} JSON_DECODER_READER;
+
 #include "azure_c_shared_utility/umock_c_prod.h"
 MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_JSON_To_MultiTree, char*, json, MULTITREE_HANDLE*, multiTreeHandle);
 
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_Reader_Init, JSON_DECODER_READER*, reader, char*, json);
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_Reader_BeginObject, JSON_DECODER_READER*, reader);
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_Reader_NextMember, JSON_DECODER_READER*, reader, const char**, name);
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_Reader_GetValue, JSON_DECODER_READER*, reader, const char**, value);
+MOCKABLE_FUNCTION(, JSON_DECODER_RESULT, JSONDecoder_Reader_SkipValue, JSON_DECODER_READER*, reader);
+
 #ifdef __cplusplus
 }
 #endif
@@ -35,10 +35,17 @@ DEFINE_ENUM(JSON_ENCODER_TOSTRING_RESULT, JSON_ENCODER_TOSTRING_RESULT_VALUES);
 
 typedef JSON_ENCODER_TOSTRING_RESULT(*JSON_ENCODER_TOSTRING_FUNC)(STRING_HANDLE, const void* value);
 
+typedef struct JSON_ENCODER_PROPERTY_TAG
+{
+    const char* path;
+    const void* value;
+} JSON_ENCODER_PROPERTY;
+
 #include "azure_c_shared_utility/umock_c_prod.h"
 
 MOCKABLE_FUNCTION(, JSON_ENCODER_TOSTRING_RESULT, JSONEncoder_CharPtr_ToString, STRING_HANDLE, destination, const void*, value);
 MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_EncodeTree, MULTITREE_HANDLE, treeHandle, STRING_HANDLE, destination, JSON_ENCODER_TOSTRING_FUNC, toStringFunc);
+MOCKABLE_FUNCTION(, JSON_ENCODER_RESULT, JSONEncoder_EncodeProperties, const JSON_ENCODER_PROPERTY*, properties, size_t, propertyCount, JSON_ENCODER_TOSTRING_FUNC, toStringFunc, unsigned char**, destination, size_t*, destinationSize);
 
 #ifdef __cplusplus
 }
@@ -12,6 +12,7 @@
 #endif
 
 #include <stddef.h>
+#include <string.h>
 
 #include <float.h>
 #include <math.h>
@@ -48,16 +49,10 @@
 
 #define GUID_STRING_LENGTH 38
 
-// This is an artificial upper limit on floating point string length
-// (e.g. the size of the string when printing %f). It is set to twice the
-// maximum decimal precision plus 2. 1 for the decimal point and 1 for a
-// sign (+/-)
-// Unfortunately it is quite possible to print a float larger than this.
-// An example of this would be printf("%.*f", MAX_FLOATING_POINT_STRING_LENGTH, 1.3);
-// But currently no explicit requests for this exist in the file nor are
-// any expected to reasonably occur when being used (numbers that hit
-// this limit would be experiencing significant precision loss in storage anyway.
-#define MAX_FLOATING_POINT_STRING_LENGTH (DECIMAL_DIG *2 + 2)
+// Upper limit on the text produced for a float or a double by FormatSingle/FormatDouble: a sign, at most
+// 17 significant digits padded with zeroes up to 21 integer digits or 6 leading fractional zeroes, the
+// decimal point or an "e-308" exponent and the terminating '\0' all fit in it.
+#define FLOATING_POINT_STRING_BUFFER_SIZE 32
 
 // This maximum length is 11 for 32 bit integers (including the sign)
 // optionally increase to 21 if longs are 64 bit
@@ -1283,6 +1278,425 @@ static char hexDigitToChar(uint8_t hexDigit)
     else return ('A' - 10) + hexDigit;
 }
 
+/*two characters per value from 00 to 99, so that integers are formatted two digits per division*/
+static const char DIGIT_PAIRS[200] =
+{
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+/*writes the decimal digits of value right before end and returns the first character written*/
+static char* FormatUInt64Backward(char* end, uint64_t value)
+{
+    char* pos = end;
+    while (value >= 100)
+    {
+        size_t pair = (size_t)(value % 100) * 2;
+        value /= 100;
+        *--pos = DIGIT_PAIRS[pair + 1];
+        *--pos = DIGIT_PAIRS[pair];
+    }
+
+    if (value >= 10)
+    {
+        size_t pair = (size_t)value * 2;
+        *--pos = DIGIT_PAIRS[pair + 1];
+        *--pos = DIGIT_PAIRS[pair];
+    }
+    else
+    {
+        *--pos = (char)('0' + value);
+    }
+    return pos;
+}
+
+static AGENT_DATA_TYPES_RESULT ConcatInteger(STRING_HANDLE destination, int64_t value)
+{
+    AGENT_DATA_TYPES_RESULT result;
+    char buffer[1 + MAX_ULONG_LONG_STRING_LENGTH + 1]; /*sign, digits and '\0'*/
+    char* begin = &buffer[sizeof(buffer) - 1];
+    *begin = '\0';
+
+    /*the magnitude is computed in unsigned arithmetic so that INT64_MIN does not overflow*/
+    if (value < 0)
+    {
+        begin = FormatUInt64Backward(begin, (uint64_t)0 - (uint64_t)value);
+        *--begin = '-';
+    }
+    else
+    {
+        begin = FormatUInt64Backward(begin, (uint64_t)value);
+    }
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ Numeric values shall be formatted into a buffer on the stack and appended to destination with a single call to STRING_concat, without allocating memory. ]*/
+    if (STRING_concat(destination, begin) != 0)
+    {
+        result = AGENT_DATA_TYPES_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
+    }
+    else
+    {
+        result = AGENT_DATA_TYPES_OK;
+    }
+    return result;
+}
+
+#ifndef NO_FLOATS
+/*
+ * Shortest round-trip formatting of binary floating point numbers (Grisu2, Florian Loitsch, "Printing
+ * Floating-Point Numbers Quickly and Accurately with Integers", PLDI 2010). The digits produced lie strictly
+ * between the midpoints to the neighbouring representable values, so parsing them back yields the same
+ * float or double.
+ */
+typedef struct DIY_FP_TAG
+{
+    uint64_t f;
+    int e;
+} DIY_FP;
+
+/*normalized 64 bit approximations of 10^k for k = -348, -340, ..., 340 (10^k ~= f * 2^e)*/
+static const DIY_FP CACHED_POWERS[] =
+{
+    { 0xFA8FD5A0081C0288ULL, -1220 }, { 0xBAAEE17FA23EBF76ULL, -1193 }, { 0x8B16FB203055AC76ULL, -1166 },
+    { 0xCF42894A5DCE35EAULL, -1140 }, { 0x9A6BB0AA55653B2DULL, -1113 }, { 0xE61ACF033D1A45DFULL, -1087 },
+    { 0xAB70FE17C79AC6CAULL, -1060 }, { 0xFF77B1FCBEBCDC4FULL, -1034 }, { 0xBE5691EF416BD60CULL, -1007 },
+    { 0x8DD01FAD907FFC3CULL, -980 }, { 0xD3515C2831559A83ULL, -954 }, { 0x9D71AC8FADA6C9B5ULL, -927 },
+    { 0xEA9C227723EE8BCBULL, -901 }, { 0xAECC49914078536DULL, -874 }, { 0x823C12795DB6CE57ULL, -847 },
+    { 0xC21094364DFB5637ULL, -821 }, { 0x9096EA6F3848984FULL, -794 }, { 0xD77485CB25823AC7ULL, -768 },
+    { 0xA086CFCD97BF97F4ULL, -741 }, { 0xEF340A98172AACE5ULL, -715 }, { 0xB23867FB2A35B28EULL, -688 },
+    { 0x84C8D4DFD2C63F3BULL, -661 }, { 0xC5DD44271AD3CDBAULL, -635 }, { 0x936B9FCEBB25C996ULL, -608 },
+    { 0xDBAC6C247D62A584ULL, -582 }, { 0xA3AB66580D5FDAF6ULL, -555 }, { 0xF3E2F893DEC3F126ULL, -529 },
+    { 0xB5B5ADA8AAFF80B8ULL, -502 }, { 0x87625F056C7C4A8BULL, -475 }, { 0xC9BCFF6034C13053ULL, -449 },
+    { 0x964E858C91BA2655ULL, -422 }, { 0xDFF9772470297EBDULL, -396 }, { 0xA6DFBD9FB8E5B88FULL, -369 },
+    { 0xF8A95FCF88747D94ULL, -343 }, { 0xB94470938FA89BCFULL, -316 }, { 0x8A08F0F8BF0F156BULL, -289 },
+    { 0xCDB02555653131B6ULL, -263 }, { 0x993FE2C6D07B7FACULL, -236 }, { 0xE45C10C42A2B3B06ULL, -210 },
+    { 0xAA242499697392D3ULL, -183 }, { 0xFD87B5F28300CA0EULL, -157 }, { 0xBCE5086492111AEBULL, -130 },
+    { 0x8CBCCC096F5088CCULL, -103 }, { 0xD1B71758E219652CULL, -77 }, { 0x9C40000000000000ULL, -50 },
+    { 0xE8D4A51000000000ULL, -24 }, { 0xAD78EBC5AC620000ULL, 3 }, { 0x813F3978F8940984ULL, 30 },
+    { 0xC097CE7BC90715B3ULL, 56 }, { 0x8F7E32CE7BEA5C70ULL, 83 }, { 0xD5D238A4ABE98068ULL, 109 },
+    { 0x9F4F2726179A2245ULL, 136 }, { 0xED63A231D4C4FB27ULL, 162 }, { 0xB0DE65388CC8ADA8ULL, 189 },
+    { 0x83C7088E1AAB65DBULL, 216 }, { 0xC45D1DF942711D9AULL, 242 }, { 0x924D692CA61BE758ULL, 269 },
+    { 0xDA01EE641A708DEAULL, 295 }, { 0xA26DA3999AEF774AULL, 322 }, { 0xF209787BB47D6B85ULL, 348 },
+    { 0xB454E4A179DD1877ULL, 375 }, { 0x865B86925B9BC5C2ULL, 402 }, { 0xC83553C5C8965D3DULL, 428 },
+    { 0x952AB45CFA97A0B3ULL, 455 }, { 0xDE469FBD99A05FE3ULL, 481 }, { 0xA59BC234DB398C25ULL, 508 },
+    { 0xF6C69A72A3989F5CULL, 534 }, { 0xB7DCBF5354E9BECEULL, 561 }, { 0x88FCF317F22241E2ULL, 588 },
+    { 0xCC20CE9BD35C78A5ULL, 614 }, { 0x98165AF37B2153DFULL, 641 }, { 0xE2A0B5DC971F303AULL, 667 },
+    { 0xA8D9D1535CE3B396ULL, 694 }, { 0xFB9B7CD9A4A7443CULL, 720 }, { 0xBB764C4CA7A44410ULL, 747 },
+    { 0x8BAB8EEFB6409C1AULL, 774 }, { 0xD01FEF10A657842CULL, 800 }, { 0x9B10A4E5E9913129ULL, 827 },
+    { 0xE7109BFBA19C0C9DULL, 853 }, { 0xAC2820D9623BF429ULL, 880 }, { 0x80444B5E7AA7CF85ULL, 907 },
+    { 0xBF21E44003ACDD2DULL, 933 }, { 0x8E679C2F5E44FF8FULL, 960 }, { 0xD433179D9C8CB841ULL, 986 },
+    { 0x9E19DB92B4E31BA9ULL, 1013 }, { 0xEB96BF6EBADF77D9ULL, 1039 }, { 0xAF87023B9BF0EE6BULL, 1066 }
+};
+
+#define CACHED_POWERS_MIN_DECIMAL_EXPONENT (-348)
+#define CACHED_POWERS_DECIMAL_EXPONENT_STEP 8
+
+static const uint64_t POW10[] =
+{
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL, 1000000000000000ULL,
+    10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+};
+
+static DIY_FP DiyFp_Multiply(DIY_FP x, DIY_FP y)
+{
+    /*upper 64 bits of the 128 bit product, rounded*/
+    const uint64_t M32 = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32;
+    uint64_t b = x.f & M32;
+    uint64_t c = y.f >> 32;
+    uint64_t d = y.f & M32;
+    uint64_t ac = a * c;
+    uint64_t bc = b * c;
+    uint64_t ad = a * d;
+    uint64_t bd = b * d;
+    uint64_t middle = (bd >> 32) + (ad & M32) + (bc & M32) + (1ULL << 31);
+    DIY_FP result;
+    result.f = ac + (ad >> 32) + (bc >> 32) + (middle >> 32);
+    result.e = x.e + y.e + 64;
+    return result;
+}
+
+static DIY_FP DiyFp_Normalize(DIY_FP x)
+{
+    while ((x.f & (1ULL << 63)) == 0)
+    {
+        x.f <<= 1;
+        x.e--;
+    }
+    return x;
+}
+
+static DIY_FP GetCachedPower(int binaryExponent, int* decimalExponent)
+{
+    /*picks 10^-k so that the scaled number has its binary exponent in [-60, -32]; 0.30102999566398114 = log10(2)*/
+    double dk = (-61 - binaryExponent) * 0.30102999566398114 + 347;
+    int k = (int)dk;
+    size_t index;
+    if (dk - k > 0.0)
+    {
+        k++;
+    }
+    index = (size_t)((k >> 3) + 1);
+    *decimalExponent = -(CACHED_POWERS_MIN_DECIMAL_EXPONENT + (int)index * CACHED_POWERS_DECIMAL_EXPONENT_STEP);
+    return CACHED_POWERS[index];
+}
+
+static int CountDecimalDigits32(uint32_t n)
+{
+    if (n < 10) return 1;
+    if (n < 100) return 2;
+    if (n < 1000) return 3;
+    if (n < 10000) return 4;
+    if (n < 100000) return 5;
+    if (n < 1000000) return 6;
+    if (n < 10000000) return 7;
+    if (n < 100000000) return 8;
+    if (n < 1000000000) return 9;
+    return 10;
+}
+
+static void GrisuRound(char* digits, int length, uint64_t delta, uint64_t rest, uint64_t tenKappa, uint64_t distance)
+{
+    /*moves the last digit towards the exact value as long as the result stays inside the rounding interval*/
+    while ((rest < distance) &&
+        (delta - rest >= tenKappa) &&
+        ((rest + tenKappa < distance) || (distance - rest > rest + tenKappa - distance)))
+    {
+        digits[length - 1]--;
+        rest += tenKappa;
+    }
+}
+
+static int GrisuDigitGen(DIY_FP w, DIY_FP upper, uint64_t delta, char* digits, int* decimalExponent)
+{
+    const int shift = -upper.e;
+    const uint64_t one = 1ULL << shift;
+    const uint64_t distance = upper.f - w.f;
+    uint32_t integral = (uint32_t)(upper.f >> shift);
+    uint64_t fractional = upper.f & (one - 1);
+    int kappa = CountDecimalDigits32(integral);
+    int length = 0;
+
+    while (kappa > 0)
+    {
+        uint32_t divisor = (uint32_t)POW10[kappa - 1];
+        uint32_t digit = integral / divisor;
+        uint64_t rest;
+        integral %= divisor;
+        if ((digit != 0) || (length != 0))
+        {
+            digits[length++] = (char)('0' + digit);
+        }
+        kappa--;
+        rest = ((uint64_t)integral << shift) + fractional;
+        if (rest <= delta)
+        {
+            *decimalExponent += kappa;
+            GrisuRound(digits, length, delta, rest, POW10[kappa] << shift, distance);
+            return length;
+        }
+    }
+
+    for (;;)
+    {
+        char digit;
+        fractional *= 10;
+        delta *= 10;
+        digit = (char)(fractional >> shift);
+        if ((digit != 0) || (length != 0))
+        {
+            digits[length++] = (char)('0' + digit);
+        }
+        fractional &= one - 1;
+        kappa--;
+        if (fractional < delta)
+        {
+            *decimalExponent += kappa;
+            GrisuRound(digits, length, delta, fractional, one, distance * ((-kappa < 20) ? POW10[-kappa] : 0));
+            return length;
+        }
+    }
+}
+
+/*significand and exponent are the IEEE 754 fields with the hidden bit already applied (value = significand * 2^exponent)*/
+static int Grisu2(uint64_t significand, int exponent, int significandBits, bool lowerBoundaryIsCloser, char* digits, int* decimalExponent)
+{
+    DIY_FP v;
+    DIY_FP upper;
+    DIY_FP lower;
+    DIY_FP cachedPower;
+    DIY_FP w;
+    const uint64_t hiddenBit = 1ULL << significandBits;
+
+    /*the rounding interval is bounded by the midpoints to the two neighbouring representable values*/
+    upper.f = (significand << 1) + 1;
+    upper.e = exponent - 1;
+    while ((upper.f & (hiddenBit << 1)) == 0)
+    {
+        upper.f <<= 1;
+        upper.e--;
+    }
+    upper.f <<= (64 - significandBits - 2);
+    upper.e -= (64 - significandBits - 2);
+
+    if (lowerBoundaryIsCloser)
+    {
+        lower.f = (significand << 2) - 1;
+        lower.e = exponent - 2;
+    }
+    else
+    {
+        lower.f = (significand << 1) - 1;
+        lower.e = exponent - 1;
+    }
+    lower.f <<= lower.e - upper.e;
+    lower.e = upper.e;
+
+    v.f = significand;
+    v.e = exponent;
+
+    cachedPower = GetCachedPower(upper.e, decimalExponent);
+    w = DiyFp_Multiply(DiyFp_Normalize(v), cachedPower);
+    upper = DiyFp_Multiply(upper, cachedPower);
+    lower = DiyFp_Multiply(lower, cachedPower);
+    /*the products are rounded, so the interval is shrunk by one unit on each side to stay conservative*/
+    lower.f++;
+    upper.f--;
+    return GrisuDigitGen(w, upper, upper.f - lower.f, digits, decimalExponent);
+}
+
+/*lays out length digits (value = digits * 10^decimalExponent) as JSON/OData text, returns the number of characters written*/
+static size_t PrettifyDecimal(char* buffer, int length, int decimalExponent)
+{
+    const int pointPosition = length + decimalExponent; /*10^(pointPosition-1) <= value < 10^pointPosition*/
+    size_t written;
+
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_004: [ Values whose magnitude is at least 1e-6 and less than 1e21 shall be written in plain decimal notation with at least one digit after the decimal point. ]*/
+    if ((decimalExponent >= 0) && (pointPosition <= 21))
+    {
+        /*1234e7 -> 12340000000.0*/
+        int i;
+        for (i = length; i < pointPosition; i++)
+        {
+            buffer[i] = '0';
+        }
+        buffer[pointPosition] = '.';
+        buffer[pointPosition + 1] = '0';
+        written = (size_t)pointPosition + 2;
+    }
+    else if ((pointPosition > 0) && (pointPosition <= 21))
+    {
+        /*1234e-2 -> 12.34*/
+        (void)memmove(&buffer[pointPosition + 1], &buffer[pointPosition], (size_t)(length - pointPosition));
+        buffer[pointPosition] = '.';
+        written = (size_t)length + 1;
+    }
+    else if ((pointPosition > -6) && (pointPosition <= 0))
+    {
+        /*1234e-6 -> 0.001234*/
+        int offset = 2 - pointPosition;
+        int i;
+        (void)memmove(&buffer[offset], &buffer[0], (size_t)length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        for (i = 2; i < offset; i++)
+        {
+            buffer[i] = '0';
+        }
+        written = (size_t)(length + offset);
+    }
+    else
+    {
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_005: [ All other values shall be written as their significant digits, with a decimal point after the first digit when there is more than one, followed by "e" and the decimal exponent without a "+" sign or leading zeroes. ]*/
+        int exponent = pointPosition - 1;
+        char exponentDigits[4];
+        char* exponentBegin = &exponentDigits[sizeof(exponentDigits)];
+        if (length == 1)
+        {
+            /*1e30*/
+            written = 1;
+        }
+        else
+        {
+            /*1234e30 -> 1.234e33*/
+            (void)memmove(&buffer[2], &buffer[1], (size_t)(length - 1));
+            buffer[1] = '.';
+            written = (size_t)length + 1;
+        }
+        buffer[written++] = 'e';
+        if (exponent < 0)
+        {
+            buffer[written++] = '-';
+            exponent = -exponent;
+        }
+        exponentBegin = FormatUInt64Backward(exponentBegin, (uint64_t)exponent);
+        while (exponentBegin < &exponentDigits[sizeof(exponentDigits)])
+        {
+            buffer[written++] = *exponentBegin++;
+        }
+    }
+    return written;
+}
+
+static void FormatBinaryFloatingPoint(char* buffer, bool isNegative, uint64_t fraction, int biasedExponent, int significandBits, int exponentBias)
+{
+    size_t pos = 0;
+    if (isNegative)
+    {
+        buffer[pos++] = '-';
+    }
+
+    if ((fraction == 0) && (biasedExponent == 0))
+    {
+        /*Codes_SRS_AGENT_TYPE_SYSTEM_09_006: [ Zero shall be written as 0.0 and negative zero as -0.0. ]*/
+        buffer[pos++] = '0';
+        buffer[pos++] = '.';
+        buffer[pos++] = '0';
+    }
+    else
+    {
+        int decimalExponent;
+        int length;
+        if (biasedExponent != 0)
+        {
+            length = Grisu2(fraction | (1ULL << significandBits), biasedExponent - exponentBias, significandBits, (fraction == 0) && (biasedExponent > 1), &buffer[pos], &decimalExponent);
+        }
+        else
+        {
+            /*subnormal*/
+            length = Grisu2(fraction, 1 - exponentBias, significandBits, false, &buffer[pos], &decimalExponent);
+        }
+        pos += PrettifyDecimal(&buffer[pos], length, decimalExponent);
+    }
+    buffer[pos] = '\0';
+}
+
+static void FormatDouble(char* buffer, double value)
+{
+    uint64_t bits;
+    (void)memcpy(&bits, &value, sizeof(bits));
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_002: [ EDM_DOUBLE values that are not NaN or infinite shall be written with the shortest sequence of decimal digits that parses back to the same double. ]*/
+    FormatBinaryFloatingPoint(buffer, (bits >> 63) != 0, bits & ((1ULL << 52) - 1), (int)((bits >> 52) & 0x7FF), 52, 1023 + 52);
+}
+
+static void FormatSingle(char* buffer, float value)
+{
+    uint32_t bits;
+    (void)memcpy(&bits, &value, sizeof(bits));
+    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_003: [ EDM_SINGLE values that are not NaN or infinite shall be written with the shortest sequence of decimal digits that parses back to the same float. ]*/
+    FormatBinaryFloatingPoint(buffer, (bits >> 31) != 0, bits & ((1UL << 23) - 1), (int)((bits >> 23) & 0xFF), 23, 127 + 23);
+}
+#endif
+
 AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const AGENT_DATA_TYPE* value)
 {
     AGENT_DATA_TYPES_RESULT result;
@@ -1370,22 +1784,7 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             }
             case(EDM_BYTE_TYPE) :
             {
-                char tempbuffer2[4]; /*because bytes can at most be 255 and that is 3 characters + 1 for '\0'*/
-                size_t pos = 0;
-                if (value->value.edmByte.value >= 100) tempbuffer2[pos++] = '0' + (value->value.edmByte.value / 100);
-                if (value->value.edmByte.value >= 10) tempbuffer2[pos++] = '0' + (value->value.edmByte.value % 100) / 10;
-                tempbuffer2[pos++] = '0' + (value->value.edmByte.value % 10);
-                tempbuffer2[pos++] = '\0';
-
-                if (STRING_concat(destination, tempbuffer2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
+                result = ConcatInteger(destination, value->value.edmByte.value);
                 break;
             }
             case(EDM_DATE_TYPE) :
@@ -1670,159 +2069,24 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
             case (EDM_INT16_TYPE) :
             {
                 /*-32768 to +32767*/
-                char buffertemp2[7]; /*because 5 digits and sign and '\0'*/
-                uint16_t positiveValue;
-                size_t pos = 0;
-                uint16_t rank = (uint16_t)10000;
-                bool foundFirstDigit = false;
-
-                if (value->value.edmInt16.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = -value->value.edmInt16.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt16.value;
-                }
-
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
-                
-                if (STRING_concat(destination, buffertemp2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
+                result = ConcatInteger(destination, value->value.edmInt16.value);
                 break;
             }
             case (EDM_INT32_TYPE) :
             {
                 /*-2147483648 to +2147483647*/
-                char buffertemp2[12]; /*because 10 digits and sign and '\0'*/
-                uint32_t positiveValue;
-                size_t pos = 0;
-                uint32_t rank = 1000000000UL;
-                bool foundFirstDigit = false;
-
-                if (value->value.edmInt32.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = - value->value.edmInt32.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt32.value;
-                }
-
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
-                
-                if (STRING_concat(destination, buffertemp2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
+                result = ConcatInteger(destination, value->value.edmInt32.value);
                 break;
             }
             case (EDM_INT64_TYPE):
             {
-                char buffertemp2[21]; /*because 19 digits and sign and '\0'*/
-                uint64_t positiveValue;
-                size_t pos = 0;
-                uint64_t rank = 10000000000000000000ULL;
-                bool foundFirstDigit = false;
-
-                if (value->value.edmInt64.value < 0)
-                {
-                    buffertemp2[pos++] = '-';
-                    positiveValue = -value->value.edmInt64.value;
-                }
-                else
-                {
-                    positiveValue = value->value.edmInt64.value;
-                }
-
-                while (rank >= 10)
-                {
-                    if ((foundFirstDigit == true) || (positiveValue / rank) > 0)
-                    {
-                        buffertemp2[pos++] = '0' + (char)(positiveValue / rank);
-                        foundFirstDigit = true;
-                    }
-                    positiveValue %= rank;
-                    rank /= 10;
-                }
-                buffertemp2[pos++] = '0' + (char)(positiveValue);
-                buffertemp2[pos++] = '\0';
-
-                if (STRING_concat(destination, buffertemp2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
+                result = ConcatInteger(destination, value->value.edmInt64.value);
                 break;
             }
             case (EDM_SBYTE_TYPE) :
             {
-                char tempbuffer2[5]; /* because '-' and 3 characters for 127 let's say and '\0'*/
-                int absValue = value->value.edmSbyte.value;
-                size_t pos=0;
                 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_026:[ EDM_SBYTE: sbyteValue = [ sign ] 1*3DIGIT  ; numbers in the range from -128 to 127]*/
-
-                if (value->value.edmSbyte.value < 0)
-                {
-                    tempbuffer2[pos++] = '-';
-                    absValue = -absValue;
-                }
-
-                if (absValue >= 100 ) tempbuffer2[pos++] = '0' + (char)(absValue / 100);
-                if (absValue >=10) tempbuffer2[pos++] = '0' + (absValue % 100) / 10;
-                tempbuffer2[pos++] = '0' + (absValue % 10);
-                tempbuffer2[pos++] = '\0';
-
-
-                if (STRING_concat(destination, tempbuffer2) != 0)
-                {
-                    result = AGENT_DATA_TYPES_ERROR;
-                    LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                }
-                else
-                {
-                    result = AGENT_DATA_TYPES_OK;
-                }
+                result = ConcatInteger(destination, value->value.edmSbyte.value);
                 break;
             }
             case (EDM_STRING_TYPE):
@@ -1955,8 +2219,6 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 /*C89 standard says: When a float is promoted to double or long double, or a double is promoted to long double, its value is unchanged*/
                 /*I read that as : when a float is NaN or Inf, it will stay NaN or INF in double representation*/
 
-                /*The sprintf function returns the number of characters written in the array, not counting the terminating null character.*/
-
                 if(ISNAN(value->value.edmSingle.value))
                 {
                     if (STRING_concat(destination, NaN_STRING) != 0)
@@ -1995,38 +2257,23 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 }
                 else
                 {
-                    size_t tempBufferSize = MAX_FLOATING_POINT_STRING_LENGTH;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
+                    char tempBuffer[FLOATING_POINT_STRING_BUFFER_SIZE];
+                    FormatSingle(tempBuffer, value->value.edmSingle.value);
+                    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ Numeric values shall be formatted into a buffer on the stack and appended to destination with a single call to STRING_concat, without allocating memory. ]*/
+                    if (STRING_concat(destination, tempBuffer) != 0)
                     {
                         result = AGENT_DATA_TYPES_ERROR;
                         LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                     }
                     else
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", FLT_DIG, (double)(value->value.edmSingle.value)) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
-
-                        free(tempBuffer);
+                        result = AGENT_DATA_TYPES_OK;
                     }
                 }
                 break;
             }
             case(EDM_DOUBLE_TYPE):
             {
-                /*The sprintf function returns the number of characters written in the array, not counting the terminating null character.*/
                 /*OData-ABNF says these can be used: nanInfinity = 'NaN' / '-INF' / 'INF'*/
                 /*C90 doesn't declare a NaN or Inf in the standard, however, values might be NaN or Inf...*/
                 /*C99 ... does*/
@@ -2073,31 +2320,17 @@ AGENT_DATA_TYPES_RESULT AgentDataTypes_ToString(STRING_HANDLE destination, const
                 /*Codes_SRS_AGENT_TYPE_SYSTEM_99_022:[ EDM_DOUBLE: doubleValue = decimalValue [ "e" [SIGN] 1*DIGIT ] / nanInfinity ; IEEE 754 binary64 floating-point number (15-17 decimal digits). The representation shall use DBL_DIG C #define*/
                 else
                 {
-                    size_t tempBufferSize = DECIMAL_DIG * 2;
-                    char* tempBuffer = (char*)malloc(tempBufferSize);
-                    if (tempBuffer == NULL)
+                    char tempBuffer[FLOATING_POINT_STRING_BUFFER_SIZE];
+                    FormatDouble(tempBuffer, value->value.edmDouble.value);
+                    /*Codes_SRS_AGENT_TYPE_SYSTEM_09_001: [ Numeric values shall be formatted into a buffer on the stack and appended to destination with a single call to STRING_concat, without allocating memory. ]*/
+                    if (STRING_concat(destination, tempBuffer) != 0)
                     {
                         result = AGENT_DATA_TYPES_ERROR;
                         LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
                     }
                     else
                     {
-                        if (sprintf_s(tempBuffer, tempBufferSize, "%.*f", DBL_DIG, value->value.edmDouble.value) < 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else if (STRING_concat(destination, tempBuffer) != 0)
-                        {
-                            result = AGENT_DATA_TYPES_ERROR;
-                            LogError("(result = %s)", ENUM_TO_STRING(AGENT_DATA_TYPES_RESULT, result));
-                        }
-                        else
-                        {
-                            result = AGENT_DATA_TYPES_OK;
-                        }
-
-                        free(tempBuffer);
+                        result = AGENT_DATA_TYPES_OK;
                     }
                 }
                 break;
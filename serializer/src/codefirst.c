@@ -3,12 +3,14 @@
 
 #include <stdlib.h>
 #include <stdarg.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "codefirst.h"
 #include "azure_c_shared_utility/macro_utils.h"
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "azure_c_shared_utility/xlogging.h"
+#include "azure_c_shared_utility/optimize_size.h"
 #include <stddef.h>
 #include "azure_c_shared_utility/crt_abstractions.h"
 #include "iotdevice.h"
@@ -19,6 +21,22 @@ DEFINE_ENUM_STRINGS(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_RESULT_VALUES)
 #define LOG_CODEFIRST_ERROR \
     LogError("(result = %s)", ENUM_TO_STRING(CODEFIRST_RESULT, result))
 
+/*one WITH_DATA or WITH_REPORTED_PROPERTY of a device, child models included*/
+typedef struct PROPERTY_OFFSET_ENTRY_TAG
+{
+    size_t offset; /*from the start of the device block*/
+    size_t depth; /*0 for the device model, 1 for its child models and so on*/
+    char* path; /*"ChildModel/InnerProperty", as passed to Device*/
+    const REFLECTED_SOMETHING* something;
+} PROPERTY_OFFSET_ENTRY;
+
+/*entries are sorted by offset, then by depth, so that a value that starts both a child model and its first property is found as the child model*/
+typedef struct PROPERTY_OFFSET_TABLE_TAG
+{
+    PROPERTY_OFFSET_ENTRY* entries;
+    size_t count;
+} PROPERTY_OFFSET_TABLE;
+
 typedef struct DEVICE_HEADER_DATA_TAG
 {
     DEVICE_HANDLE DeviceHandle;
@@ -26,6 +44,8 @@ typedef struct DEVICE_HEADER_DATA_TAG
     SCHEMA_MODEL_TYPE_HANDLE ModelHandle;
     size_t DataSize;
     unsigned char* data;
+    PROPERTY_OFFSET_TABLE* PropertyOffsets; /*built by CodeFirst_CreateDevice*/
+    PROPERTY_OFFSET_TABLE* ReportedPropertyOffsets; /*built by CodeFirst_CreateDevice*/
 } DEVICE_HEADER_DATA;
 
 #define COUNT_OF(A) (sizeof(A) / sizeof((A)[0]))
@@ -153,11 +173,27 @@ static void deinitializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void*
     }
 }
 
+static void DestroyPropertyOffsetTable(PROPERTY_OFFSET_TABLE* table)
+{
+    if (table != NULL)
+    {
+        size_t i;
+        for (i = 0; i < table->count; i++)
+        {
+            free(table->entries[i].path);
+        }
+        free(table->entries);
+        free(table);
+    }
+}
+
 static void DestroyDevice(DEVICE_HEADER_DATA* deviceHeader)
 {
     /* Codes_SRS_CODEFIRST_99_085:[CodeFirst_DestroyDevice shall free all resources associated with a device.] */
     /* Codes_SRS_CODEFIRST_99_087:[In order to release the device handle, CodeFirst_DestroyDevice shall call Device_Destroy.] */
-    
+
+    DestroyPropertyOffsetTable(deviceHeader->PropertyOffsets);
+    DestroyPropertyOffsetTable(deviceHeader->ReportedPropertyOffsets);
     Device_Destroy(deviceHeader->DeviceHandle);
     free(deviceHeader->data);
     free(deviceHeader);
@@ -876,6 +912,212 @@ static void initializeDesiredProperties(SCHEMA_MODEL_TYPE_HANDLE model, void* de
     }
 }
 
+/*returns true when something is a memberType (WITH_DATA or WITH_REPORTED_PROPERTY) of modelName and then fills in its name, type and offset*/
+static bool GetModelMember(const REFLECTED_SOMETHING* something, REFLECTION_TYPE memberType, const char* modelName, const char** name, const char** type, size_t* offset)
+{
+    bool result;
+
+    if (something->type != memberType)
+    {
+        result = false;
+    }
+    else if (memberType == REFLECTION_PROPERTY_TYPE)
+    {
+        result = (strcmp(something->what.property.modelName, modelName) == 0);
+        *name = something->what.property.name;
+        *type = something->what.property.type;
+        *offset = something->what.property.offset;
+    }
+    else
+    {
+        result = (strcmp(something->what.reportedProperty.modelName, modelName) == 0);
+        *name = something->what.reportedProperty.name;
+        *type = something->what.reportedProperty.type;
+        *offset = something->what.reportedProperty.offset;
+    }
+
+    return result;
+}
+
+static size_t CountModelMembers(const REFLECTED_SOMETHING* reflectedData, REFLECTION_TYPE memberType, const char* modelName)
+{
+    size_t result = 0;
+    const REFLECTED_SOMETHING* something;
+
+    for (something = reflectedData; something != NULL; something = something->next)
+    {
+        const char* name;
+        const char* type;
+        size_t offset;
+
+        if (GetModelMember(something, memberType, modelName, &name, &type, &offset))
+        {
+            /*a member whose type is a model brings in the members of that model*/
+            result += 1 + CountModelMembers(reflectedData, memberType, type);
+        }
+    }
+
+    return result;
+}
+
+static int AddModelMembers(PROPERTY_OFFSET_TABLE* table, const REFLECTED_SOMETHING* reflectedData, REFLECTION_TYPE memberType, const char* modelName, const char* pathPrefix, size_t startOffset, size_t depth)
+{
+    int result = 0;
+    const REFLECTED_SOMETHING* something;
+    size_t prefixLength = (pathPrefix == NULL) ? 0 : strlen(pathPrefix) + 1;
+
+    for (something = reflectedData; something != NULL; something = something->next)
+    {
+        const char* name;
+        const char* type;
+        size_t offset;
+
+        if (GetModelMember(something, memberType, modelName, &name, &type, &offset))
+        {
+            PROPERTY_OFFSET_ENTRY* entry = &table->entries[table->count];
+            size_t nameLength = strlen(name);
+
+            if ((entry->path = (char*)malloc(prefixLength + nameLength + 1)) == NULL)
+            {
+                LogError("unable to malloc the path of %s", name);
+                result = __FAILURE__;
+                break;
+            }
+            else
+            {
+                if (pathPrefix != NULL)
+                {
+                    (void)memcpy(entry->path, pathPrefix, prefixLength - 1);
+                    entry->path[prefixLength - 1] = '/';
+                }
+                (void)memcpy(entry->path + prefixLength, name, nameLength + 1);
+
+                entry->offset = startOffset + offset;
+                entry->depth = depth;
+                entry->something = something;
+                table->count++;
+
+                /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
+                if (AddModelMembers(table, reflectedData, memberType, type, entry->path, entry->offset, depth + 1) != 0)
+                {
+                    result = __FAILURE__;
+                    break;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+static int ComparePropertyOffsetEntries(const void* left, const void* right)
+{
+    const PROPERTY_OFFSET_ENTRY* leftEntry = (const PROPERTY_OFFSET_ENTRY*)left;
+    const PROPERTY_OFFSET_ENTRY* rightEntry = (const PROPERTY_OFFSET_ENTRY*)right;
+    int result;
+
+    if (leftEntry->offset != rightEntry->offset)
+    {
+        result = (leftEntry->offset < rightEntry->offset) ? -1 : 1;
+    }
+    else if (leftEntry->depth != rightEntry->depth)
+    {
+        result = (leftEntry->depth < rightEntry->depth) ? -1 : 1;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+static PROPERTY_OFFSET_TABLE* CreatePropertyOffsetTable(DEVICE_HEADER_DATA* deviceHeader, REFLECTION_TYPE memberType, const char* modelName)
+{
+    PROPERTY_OFFSET_TABLE* result;
+
+    if ((result = (PROPERTY_OFFSET_TABLE*)malloc(sizeof(PROPERTY_OFFSET_TABLE))) == NULL)
+    {
+        LogError("unable to malloc the property offset table");
+    }
+    else
+    {
+        size_t memberCount = CountModelMembers(deviceHeader->ReflectedData->reflectedData, memberType, modelName);
+
+        result->count = 0;
+        if ((result->entries = (PROPERTY_OFFSET_ENTRY*)malloc((memberCount == 0 ? 1 : memberCount) * sizeof(PROPERTY_OFFSET_ENTRY))) == NULL)
+        {
+            LogError("unable to malloc %lu property offset entries", (unsigned long)memberCount);
+            free(result);
+            result = NULL;
+        }
+        else if (AddModelMembers(result, deviceHeader->ReflectedData->reflectedData, memberType, modelName, NULL, 0, 0) != 0)
+        {
+            DestroyPropertyOffsetTable(result);
+            result = NULL;
+        }
+        else
+        {
+            qsort(result->entries, result->count, sizeof(PROPERTY_OFFSET_ENTRY), ComparePropertyOffsetEntries);
+        }
+    }
+
+    return result;
+}
+
+/*both tables are built before the device is published in g_Devices, so CodeFirst_SendAsync and CodeFirst_SendAsyncReported only ever read them*/
+static int CreatePropertyOffsetTables(DEVICE_HEADER_DATA* deviceHeader)
+{
+    int result;
+    const char* modelName;
+
+    if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
+    {
+        LogError("unable to get the model name of the device");
+        result = __FAILURE__;
+    }
+    else if ((deviceHeader->PropertyOffsets = CreatePropertyOffsetTable(deviceHeader, REFLECTION_PROPERTY_TYPE, modelName)) == NULL)
+    {
+        LogError("unable to build the property offset table");
+        result = __FAILURE__;
+    }
+    else if ((deviceHeader->ReportedPropertyOffsets = CreatePropertyOffsetTable(deviceHeader, REFLECTION_REPORTED_PROPERTY_TYPE, modelName)) == NULL)
+    {
+        LogError("unable to build the reported property offset table");
+        DestroyPropertyOffsetTable(deviceHeader->PropertyOffsets);
+        deviceHeader->PropertyOffsets = NULL;
+        result = __FAILURE__;
+    }
+    else
+    {
+        result = 0;
+    }
+
+    return result;
+}
+
+/*g_Devices is kept sorted by the address of the device data; returns how many devices have their data starting at or before value*/
+static size_t CountDevicesStartingAtOrBefore(const unsigned char* value)
+{
+    size_t low = 0;
+    size_t high = g_DeviceCount;
+
+    while (low < high)
+    {
+        size_t middle = low + (high - low) / 2;
+        if (g_Devices[middle]->data <= value)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    return low;
+}
+
 /* Codes_SRS_CODEFIRST_99_079:[CodeFirst_CreateDevice shall create a device and allocate a memory block that should hold the device data.] */
 void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DATA_FROM_DATAPROVIDER* metadata, size_t dataSize, bool includePropertyPath)
 {
@@ -903,6 +1145,9 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
         /* Codes_SRS_CODEFIRST_99_082: [ CodeFirst_CreateDevice shall pass to Device_Create the function CodeFirst_InvokeAction, action callback argument and the CodeFirst_InvokeMethod ] */
         else
         {
+            deviceHeader->PropertyOffsets = NULL;
+            deviceHeader->ReportedPropertyOffsets = NULL;
+
             if ((deviceHeader->data = malloc(dataSize)) == NULL)
             {
                 free(deviceHeader);
@@ -926,40 +1171,52 @@ void* CodeFirst_CreateDevice(SCHEMA_MODEL_TYPE_HANDLE model, const REFLECTED_DAT
                     result = NULL;
                     LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_DEVICE_FAILED));
                 }
-                else if ((newDevices = (DEVICE_HEADER_DATA**)realloc(g_Devices, sizeof(DEVICE_HEADER_DATA*) * (g_DeviceCount + 1))) == NULL)
-                {
-                    Device_Destroy(deviceHeader->DeviceHandle);
-                    free(deviceHeader->data);
-                    free(deviceHeader);
-
-                    /* Codes_SRS_CODEFIRST_99_102:[On any other errors, Device_Create shall return NULL.] */
-                    result = NULL;
-                    LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_ERROR));
-                }
                 else
                 {
-                    SCHEMA_RESULT schemaResult;
                     deviceHeader->ReflectedData = metadata;
                     deviceHeader->DataSize = dataSize;
                     deviceHeader->ModelHandle = model;
-                    schemaResult = Schema_AddDeviceRef(model);
-                    if (schemaResult != SCHEMA_OK)
+
+                    /* Codes_SRS_CODEFIRST_09_001: [ CodeFirst_CreateDevice shall build for the device a table of all its properties, child models included, sorted by their offset in the device block and holding the full path of each property. ] */
+                    /* Codes_SRS_CODEFIRST_09_004: [ CodeFirst_CreateDevice shall build for the device a table of all its reported properties, child models included, sorted by their offset in the device block and holding the full path of each reported property. ] */
+                    if (CreatePropertyOffsetTables(deviceHeader) != 0)
                     {
-                        Device_Destroy(deviceHeader->DeviceHandle);
-                        free(deviceHeader->data);
-                        free(deviceHeader);
+                        DestroyDevice(deviceHeader);
+
+                        /* Codes_SRS_CODEFIRST_09_002: [ If building either table fails, CodeFirst_CreateDevice shall return NULL. ] */
+                        result = NULL;
+                        LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_ERROR));
+                    }
+                    else if ((newDevices = (DEVICE_HEADER_DATA**)realloc(g_Devices, sizeof(DEVICE_HEADER_DATA*) * (g_DeviceCount + 1))) == NULL)
+                    {
+                        DestroyDevice(deviceHeader);
 
                         /* Codes_SRS_CODEFIRST_99_102:[On any other errors, Device_Create shall return NULL.] */
                         result = NULL;
+                        LogError(" %s ", ENUM_TO_STRING(CODEFIRST_RESULT, CODEFIRST_ERROR));
                     }
                     else
                     {
                         g_Devices = newDevices;
-                        g_Devices[g_DeviceCount] = deviceHeader;
-                        g_DeviceCount++;
 
-                        /* Codes_SRS_CODEFIRST_99_101:[On success, CodeFirst_CreateDevice shall return a non NULL pointer to the device data.] */
-                        result = deviceHeader->data;
+                        if (Schema_AddDeviceRef(model) != SCHEMA_OK)
+                        {
+                            DestroyDevice(deviceHeader);
+
+                            /* Codes_SRS_CODEFIRST_99_102:[On any other errors, Device_Create shall return NULL.] */
+                            result = NULL;
+                        }
+                        else
+                        {
+                            /* Codes_SRS_CODEFIRST_09_007: [ CodeFirst_CreateDevice shall keep the devices sorted by the address of their device block. ] */
+                            size_t index = CountDevicesStartingAtOrBefore((unsigned char*)deviceHeader->data);
+                            (void)memmove(&g_Devices[index + 1], &g_Devices[index], (g_DeviceCount - index) * sizeof(DEVICE_HEADER_DATA*));
+                            g_Devices[index] = deviceHeader;
+                            g_DeviceCount++;
+
+                            /* Codes_SRS_CODEFIRST_99_101:[On success, CodeFirst_CreateDevice shall return a non NULL pointer to the device data.] */
+                            result = deviceHeader->data;
+                        }
                     }
                 }
             }
@@ -975,23 +1232,21 @@ void CodeFirst_DestroyDevice(void* device)
     /* Codes_SRS_CODEFIRST_99_086:[If the argument is NULL, CodeFirst_DestroyDevice shall do nothing.] */
     if (device != NULL)
     {
-        size_t i;
+        size_t count = CountDevicesStartingAtOrBefore((unsigned char*)device);
 
-        for (i = 0; i < g_DeviceCount; i++)
+        if ((count > 0) && (g_Devices[count - 1]->data == device))
         {
-            if (g_Devices[i]->data == device)
-            {
-                deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
-                Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
+            size_t i = count - 1;
 
-                // Delete the Created Schema if all the devices are unassociated
-                Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+            deinitializeDesiredProperties(g_Devices[i]->ModelHandle, g_Devices[i]->data);
+            Schema_ReleaseDeviceRef(g_Devices[i]->ModelHandle);
 
-                DestroyDevice(g_Devices[i]);
-                (void)memcpy(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
-                g_DeviceCount--;
-                break;
-            }
+            // Delete the Created Schema if all the devices are unassociated
+            Schema_DestroyIfUnused(g_Devices[i]->ModelHandle);
+
+            DestroyDevice(g_Devices[i]);
+            (void)memmove(&g_Devices[i], &g_Devices[i + 1], (g_DeviceCount - i - 1) * sizeof(DEVICE_HEADER_DATA*));
+            g_DeviceCount--;
         }
 
         /*Codes_SRS_CODEFIRST_02_039: [ If the current device count is zero then CodeFirst_DestroyDevice shall deallocate all other used resources. ]*/
@@ -1006,100 +1261,40 @@ void CodeFirst_DestroyDevice(void* device)
 
 static DEVICE_HEADER_DATA* FindDevice(void* value)
 {
-    size_t i;
+    /* Codes_SRS_CODEFIRST_09_008: [ CodeFirst_SendAsync shall find the device of a value by a binary search of the devices on the address of their device block. ] */
+    size_t count = CountDevicesStartingAtOrBefore((unsigned char*)value);
     DEVICE_HEADER_DATA* result = NULL;
 
-    for (i = 0; i < g_DeviceCount; i++)
-    {
-        if ((g_Devices[i]->data <= (unsigned char*)value) &&
-            (g_Devices[i]->data + g_Devices[i]->DataSize > (unsigned char*)value))
-        {
-            result = g_Devices[i];
-            break;
-        }
-    }
-
-    return result;
-}
-
-static const REFLECTED_SOMETHING* FindValue(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
-{
-    const REFLECTED_SOMETHING* result;
-    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
-
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
-    {
-        if (result->type == REFLECTION_PROPERTY_TYPE &&
-            (strcmp(result->what.property.modelName, modelName) == 0) &&
-            (result->what.property.offset <= valueOffset) &&
-            (result->what.property.offset + result->what.property.size > valueOffset))
-        {
-            if (startOffset != 0)
-            {
-                STRING_concat(valuePath, "/");
-            }
-
-            STRING_concat(valuePath, result->what.property.name);
-            break;
-        }
-    }
-
-    if (result != NULL)
+    if ((count > 0) &&
+        (g_Devices[count - 1]->data + g_Devices[count - 1]->DataSize > (unsigned char*)value))
     {
-        /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.property.offset < valueOffset)
-        {
-            /* find recursively the property in the inner model, if there is one */
-            result = FindValue(deviceHeader, value, result->what.property.type, startOffset + result->what.property.offset, valuePath);
-        }
+        result = g_Devices[count - 1];
     }
 
     return result;
 }
 
-static const REFLECTED_SOMETHING* FindReportedProperty(DEVICE_HEADER_DATA* deviceHeader, void* value, const char* modelName, size_t startOffset, STRING_HANDLE valuePath)
+/*a value is found only when it is the start of a property; when it starts both a child model and its first property, the child model is returned*/
+static const PROPERTY_OFFSET_ENTRY* FindPropertyOffsetEntry(const PROPERTY_OFFSET_TABLE* table, DEVICE_HEADER_DATA* deviceHeader, void* value)
 {
-    const REFLECTED_SOMETHING* result;
-    size_t valueOffset = (size_t)((unsigned char*)value - (unsigned char*)deviceHeader->data) - startOffset;
+    size_t valueOffset = (size_t)((unsigned char*)value - deviceHeader->data);
+    size_t low = 0;
+    size_t high = table->count;
 
-    for (result = deviceHeader->ReflectedData->reflectedData; result != NULL; result = result->next)
+    while (low < high)
     {
-        if (result->type == REFLECTION_REPORTED_PROPERTY_TYPE &&
-            (strcmp(result->what.reportedProperty.modelName, modelName) == 0) &&
-            (result->what.reportedProperty.offset <= valueOffset) &&
-            (result->what.reportedProperty.offset + result->what.reportedProperty.size > valueOffset))
+        size_t middle = low + (high - low) / 2;
+        if (table->entries[middle].offset < valueOffset)
         {
-            if (startOffset != 0)
-            {
-                if (STRING_concat(valuePath, "/") != 0)
-                {
-                    LogError("unable to STRING_concat");
-                    result = NULL;
-                    break;
-                }
-            }
-
-            if (STRING_concat(valuePath, result->what.reportedProperty.name) != 0)
-            {
-                LogError("unable to STRING_concat");
-                result = NULL;
-                break;
-            }
-            break;
+            low = middle + 1;
         }
-    }
-
-    if (result != NULL)
-    {
-        /* Codes_SRS_CODEFIRST_99_133:[CodeFirst_SendAsync shall allow sending of properties that are part of a child model.] */
-        if (result->what.reportedProperty.offset < valueOffset)
+        else
         {
-            /* find recursively the property in the inner model, if there is one */
-            result = FindReportedProperty(deviceHeader, value, result->what.reportedProperty.type, startOffset + result->what.reportedProperty.offset, valuePath);
+            high = middle;
         }
     }
 
-    return result;
+    return ((low < table->count) && (table->entries[low].offset == valueOffset)) ? &table->entries[low] : NULL;
 }
 
 /* Codes_SRS_CODEFIRST_99_130:[If a pointer to the beginning of a device block is passed to CodeFirst_SendAsync instead of a pointer to a property, CodeFirst_SendAsync shall send all the properties that belong to that device.] */
@@ -1265,70 +1460,44 @@ CODEFIRST_RESULT CodeFirst_SendAsync(unsigned char** destination, size_t* destin
                 }
                 else
                 {
-                    const REFLECTED_SOMETHING* propertyReflectedData;
-                    const char* modelName;
-                    STRING_HANDLE valuePath;
+                    const PROPERTY_OFFSET_ENTRY* property;
 
-                    if ((valuePath = STRING_new()) == NULL)
+                    /* Codes_SRS_CODEFIRST_09_003: [ CodeFirst_SendAsync shall find each value by a binary search of the property table of its device on the offset of the value in the device block. ] */
+                    if ((property = FindPropertyOffsetEntry(deviceHeader->PropertyOffsets, deviceHeader, value)) == NULL)
                     {
-                        /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                        result = CODEFIRST_ERROR;
+                        /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
+                        result = CODEFIRST_INVALID_ARG;
                         LOG_CODEFIRST_ERROR;
                         break;
                     }
                     else
                     {
-                        if ((modelName = Schema_GetModelName(deviceHeader->ModelHandle)) == NULL)
-                        {
-                            /* Codes_SRS_CODEFIRST_99_134:[If CodeFirst_Notify fails for any other reason it shall return CODEFIRST_ERROR.] */
-                            result = CODEFIRST_ERROR;
-                            LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
-                            break;
-                        }
-                        else if ((propertyReflectedData = FindValue(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                        AGENT_DATA_TYPE agentDataType;
+
+                        /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
+                        /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
+                        if (property->something->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
                         {
-                            /* Codes_SRS_CODEFIRST_99_104:[If a property cannot be associated with a device, CodeFirst_SendAsync shall return CODEFIRST_INVALID_ARG.] */
-                            result = CODEFIRST_INVALID_ARG;
+                            /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
+                            result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                             LOG_CODEFIRST_ERROR;
-                            STRING_delete(valuePath);
                             break;
                         }
                         else
                         {
-                            AGENT_DATA_TYPE agentDataType;
-
-                            /* Codes_SRS_CODEFIRST_99_097:[For each value marshalling to AGENT_DATA_TYPE shall be performed.] */
-                            /* Codes_SRS_CODEFIRST_99_098:[The marshalling shall be done by calling the Create_AGENT_DATA_TYPE_from_Ptr function associated with the property.] */
-                            if (propertyReflectedData->what.property.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                            /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
+                            /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
+                            if (Device_PublishTransacted(transaction, property->path, &agentDataType) != DEVICE_OK)
                             {
-                                /* Codes_SRS_CODEFIRST_99_099:[If Create_AGENT_DATA_TYPE_from_Ptr fails, CodeFirst_SendAsync shall return CODEFIRST_AGENT_DATA_TYPE_ERROR.] */
-                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
+
+                                /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
+                                result = CODEFIRST_DEVICE_PUBLISH_FAILED;
                                 LOG_CODEFIRST_ERROR;
-                                STRING_delete(valuePath);
                                 break;
                             }
-                            else
-                            {
-                                /* Codes_SRS_CODEFIRST_99_092:[CodeFirst shall publish each value by using Device_PublishTransacted.] */
-                                /* Codes_SRS_CODEFIRST_99_136:[CodeFirst_SendAsync shall build the full path for each property and then pass it to Device_PublishTransacted.] */
-                                if (Device_PublishTransacted(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                {
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
-
-                                    /* Codes_SRS_CODEFIRST_99_094:[If any Device API fail, CodeFirst_SendAsync shall return CODEFIRST_DEVICE_PUBLISH_FAILED.] */
-                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                                    LOG_CODEFIRST_ERROR;
-                                    STRING_delete(valuePath);
-                                    break;
-                                }
-                                else
-                                {
-                                    STRING_delete(valuePath); /*anyway*/
-                                }
 
-                                Destroy_AGENT_DATA_TYPE(&agentDataType);
-                            }
+                            Destroy_AGENT_DATA_TYPE(&agentDataType);
                         }
                     }
                 }
@@ -1435,56 +1604,37 @@ CODEFIRST_RESULT CodeFirst_SendAsyncReported(unsigned char** destination, size_t
                     else
                     {
                         /*Codes_SRS_CODEFIRST_02_020: [ If values passed through va_args are not all of type REFLECTED_REPORTED_PROPERTY then CodeFirst_SendAsyncReported shall fail and return CODEFIRST_INVALID_ARG. ]*/
-                        const REFLECTED_SOMETHING* propertyReflectedData;
-                        const char* modelName;
+                        const PROPERTY_OFFSET_ENTRY* reportedProperty;
 
-                        STRING_HANDLE valuePath;
-                        if ((valuePath = STRING_new()) == NULL)
+                        /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
+                        /*Codes_SRS_CODEFIRST_09_006: [ CodeFirst_SendAsyncReported shall find each value by a binary search of the reported property table of its device on the offset of the value in the device block. ]*/
+                        if ((reportedProperty = FindPropertyOffsetEntry(deviceHeader->ReportedPropertyOffsets, deviceHeader, value)) == NULL)
                         {
-                            result = CODEFIRST_ERROR;
+                            result = CODEFIRST_INVALID_ARG;
                             LOG_CODEFIRST_ERROR;
                             break;
                         }
                         else
                         {
-                            modelName = Schema_GetModelName(deviceHeader->ModelHandle);
-
-                            /*Codes_SRS_CODEFIRST_02_025: [ CodeFirst_SendAsyncReported shall compute for every AGENT_DATA_TYPE the valuePath. ]*/
-                            if ((propertyReflectedData = FindReportedProperty(deviceHeader, value, modelName, 0, valuePath)) == NULL)
+                            AGENT_DATA_TYPE agentDataType;
+                            /*Codes_SRS_CODEFIRST_02_023: [ CodeFirst_SendAsyncReported shall convert all REPORTED_PROPERTY model components to AGENT_DATA_TYPE. ]*/
+                            if (reportedProperty->something->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
                             {
-                                result = CODEFIRST_INVALID_ARG;
+                                result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
                                 LOG_CODEFIRST_ERROR;
-                                STRING_delete(valuePath);
                                 break;
                             }
                             else
                             {
-                                AGENT_DATA_TYPE agentDataType;
-                                /*Codes_SRS_CODEFIRST_02_023: [ CodeFirst_SendAsyncReported shall convert all REPORTED_PROPERTY model components to AGENT_DATA_TYPE. ]*/
-                                if (propertyReflectedData->what.reportedProperty.Create_AGENT_DATA_TYPE_from_Ptr(value, &agentDataType) != AGENT_DATA_TYPES_OK)
+                                /*Codes_SRS_CODEFIRST_02_024: [ CodeFirst_SendAsyncReported shall call Device_PublishTransacted_ReportedProperty for every AGENT_DATA_TYPE converted from REPORTED_PROPERTY. ]*/
+                                if (Device_PublishTransacted_ReportedProperty(transaction, reportedProperty->path, &agentDataType) != DEVICE_OK)
                                 {
-                                    result = CODEFIRST_AGENT_DATA_TYPE_ERROR;
+                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
+                                    result = CODEFIRST_DEVICE_PUBLISH_FAILED;
                                     LOG_CODEFIRST_ERROR;
-                                    STRING_delete(valuePath);
                                     break;
                                 }
-                                else
-                                {
-                                    /*Codes_SRS_CODEFIRST_02_024: [ CodeFirst_SendAsyncReported shall call Device_PublishTransacted_ReportedProperty for every AGENT_DATA_TYPE converted from REPORTED_PROPERTY. ]*/
-                                    if (Device_PublishTransacted_ReportedProperty(transaction, STRING_c_str(valuePath), &agentDataType) != DEVICE_OK)
-                                    {
-                                        Destroy_AGENT_DATA_TYPE(&agentDataType);
-                                        result = CODEFIRST_DEVICE_PUBLISH_FAILED;
-                                        LOG_CODEFIRST_ERROR;
-                                        STRING_delete(valuePath);
-                                        break;
-                                    }
-                                    else
-                                    {
-                                        STRING_delete(valuePath);
-                                    }
-                                    Destroy_AGENT_DATA_TYPE(&agentDataType);
-                                }
+                                Destroy_AGENT_DATA_TYPE(&agentDataType);
                             }
                         }
                     }
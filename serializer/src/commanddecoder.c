@@ -6,6 +6,7 @@
 #include "azure_c_shared_utility/gballoc.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "commanddecoder.h"
 #include "multitree.h"
@@ -795,183 +796,384 @@ void CommandDecoder_Destroy(COMMAND_DECODER_HANDLE commandDecoderHandle)
 
 DEFINE_ENUM_STRINGS(AGENT_DATA_TYPE_TYPE, AGENT_DATA_TYPE_TYPE_VALUES);
 
-/*validates that the multitree (coming from a JSON) is actually a serialization of the model (complete or incomplete)*/
-/*if the serialization contains more than the model, then it fails.*/
-/*if the serialization does not contain mandatory items from the model, it fails*/
-static bool validateModel_vs_Multitree(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, MULTITREE_HANDLE desiredPropertiesTree, size_t offset)
+/*decodes the value the reader is positioned on; values of struct types are decoded from the members of a JSON object with the same names*/
+static int DecodeValueFromReader(SCHEMA_HANDLE schemaHandle, AGENT_DATA_TYPE* agentDataType, JSON_DECODER_READER* reader, const char* edmTypeName)
 {
-    
-    bool result;
-    size_t nChildren;
-    size_t nProcessedChildren = 0;
-    (void)MultiTree_GetChildCount(desiredPropertiesTree, &nChildren);
-    for (size_t i = 0;i < nChildren;i++)
+    int result;
+    AGENT_DATA_TYPE_TYPE primitiveType;
+
+    if ((primitiveType = CodeFirst_GetPrimitiveType(edmTypeName)) == EDM_NO_TYPE)
     {
-        MULTITREE_HANDLE child;
-        if (MultiTree_GetChild(desiredPropertiesTree, i, &child) != MULTITREE_OK)
+        SCHEMA_STRUCT_TYPE_HANDLE structTypeHandle;
+        size_t propertyCount;
+
+        if (((structTypeHandle = Schema_GetStructTypeByName(schemaHandle, edmTypeName)) == NULL) ||
+            (Schema_GetStructTypePropertyCount(structTypeHandle, &propertyCount) != SCHEMA_OK))
+        {
+            result = __FAILURE__;
+            LogError("Getting Struct information failed.");
+        }
+        else if (propertyCount == 0)
         {
-            LogError("failure in MultiTree_GetChild");
-            i = nChildren;
+            result = __FAILURE__;
+            LogError("Struct type with 0 members is not allowed");
         }
         else
         {
-            STRING_HANDLE childName = STRING_new();
-            if (childName == NULL)
+            AGENT_DATA_TYPE* memberValues = (AGENT_DATA_TYPE*)malloc(sizeof(AGENT_DATA_TYPE)* propertyCount);
+            if (memberValues == NULL)
             {
-                LogError("failure to STRING_new");
-                i = nChildren;
+                result = __FAILURE__;
+                LogError("Failed allocating member values for desired property");
             }
             else
             {
-                if (MultiTree_GetName(child, childName) != MULTITREE_OK)
+                const char** memberNames = (const char**)malloc(sizeof(const char*)* propertyCount);
+                if (memberNames == NULL)
                 {
-                    LogError("failure to MultiTree_GetName");
-                    i = nChildren;
+                    result = __FAILURE__;
+                    LogError("Failed allocating member names for desired property.");
                 }
                 else
                 {
-                    const char *childName_str = STRING_c_str(childName);
-                    SCHEMA_MODEL_ELEMENT elementType = Schema_GetModelElementByName(modelHandle, childName_str);
-                    switch (elementType.elementType)
+                    size_t j;
+                    size_t nDecodedMembers = 0;
+
+                    result = 0;
+                    for (j = 0; j < propertyCount; j++)
                     {
-                        default:
-                        {
-                            LogError("INTERNAL ERROR: unexpected function return");
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_PROPERTY):
-                        {
-                            LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", STRING_c_str);
-                            i = nChildren;
-                            break;
-                        }
-                        case (SCHEMA_REPORTED_PROPERTY):
+                        SCHEMA_PROPERTY_HANDLE propertyHandle;
+
+                        memberValues[j].type = EDM_NO_TYPE;
+                        if (((propertyHandle = Schema_GetStructTypePropertyByIndex(structTypeHandle, j)) == NULL) ||
+                            ((memberNames[j] = Schema_GetPropertyName(propertyHandle)) == NULL))
                         {
-                            LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", STRING_c_str);
-                            i = nChildren;
+                            result = __FAILURE__;
+                            LogError("Getting the struct member information failed.");
                             break;
                         }
-                        case (SCHEMA_DESIRED_PROPERTY):
+                    }
+
+                    if (result != 0)
+                    {
+                        /*already logged*/
+                    }
+                    else if (JSONDecoder_Reader_BeginObject(reader) != JSON_DECODER_OK)
+                    {
+                        result = __FAILURE__;
+                        LogError("value of struct type %s is not a JSON object", edmTypeName);
+                    }
+                    else
+                    {
+                        const char* memberName;
+
+                        while (result == 0)
                         {
-                            /*Codes_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
-                            SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = elementType.elementHandle.desiredPropertyHandle;
-                            
-                            const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
-                            AGENT_DATA_TYPE output;
-                            if (DecodeValueFromNode(Schema_GetSchemaForModelType(modelHandle), &output, child, desiredPropertyType) != 0)
+                            if (JSONDecoder_Reader_NextMember(reader, &memberName) != JSON_DECODER_OK)
                             {
-                                LogError("failure in DecodeValueFromNode");
-                                i = nChildren;
+                                result = __FAILURE__;
+                                LogError("failure in JSONDecoder_Reader_NextMember");
+                            }
+                            else if (memberName == NULL)
+                            {
+                                break;
                             }
                             else
                             {
-                                /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-                                pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
-                                if (leFunction(&output, (char*)startAddress + offset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle)) != 0)
+                                for (j = 0; j < propertyCount; j++)
+                                {
+                                    if (strcmp(memberNames[j], memberName) == 0)
+                                    {
+                                        break;
+                                    }
+                                }
+
+                                if (j == propertyCount)
+                                {
+                                    /*Codes_SRS_COMMAND_DECODER_09_007: [ If the type of the desired property is a struct then every member of the struct shall be decoded from the member of the JSON object with the same name; the members of the JSON object that are not members of the struct shall be skipped. ]*/
+                                    if (JSONDecoder_Reader_SkipValue(reader) != JSON_DECODER_OK)
+                                    {
+                                        result = __FAILURE__;
+                                        LogError("failure in JSONDecoder_Reader_SkipValue");
+                                    }
+                                }
+                                else if (memberValues[j].type != EDM_NO_TYPE)
                                 {
-                                    LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
+                                    result = __FAILURE__;
+                                    LogError("member %s appears more than once", memberName);
                                 }
                                 else
                                 {
-                                    /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
-                                    pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
-                                    if (onDesiredProperty != NULL)
+                                    SCHEMA_PROPERTY_HANDLE propertyHandle;
+                                    const char* propertyType;
+
+                                    if (((propertyHandle = Schema_GetStructTypePropertyByIndex(structTypeHandle, j)) == NULL) ||
+                                        ((propertyType = Schema_GetPropertyType(propertyHandle)) == NULL))
+                                    {
+                                        result = __FAILURE__;
+                                        LogError("Getting the struct member information failed.");
+                                    }
+                                    else if (DecodeValueFromReader(schemaHandle, &memberValues[j], reader, propertyType) != 0)
+                                    {
+                                        memberValues[j].type = EDM_NO_TYPE;
+                                        result = __FAILURE__;
+                                        LogError("failure decoding member %s", memberName);
+                                    }
+                                    else
                                     {
-                                        onDesiredProperty((char*)startAddress + offset);
+                                        nDecodedMembers++;
                                     }
-                                    nProcessedChildren++;
                                 }
-                                Destroy_AGENT_DATA_TYPE(&output);
                             }
-                            
-                            break;
                         }
-                        case(SCHEMA_MODEL_IN_MODEL):
+
+                        if (result != 0)
+                        {
+                            /*already logged*/
+                        }
+                        else if (nDecodedMembers != propertyCount)
+                        {
+                            result = __FAILURE__;
+                            LogError("value of struct type %s misses members", edmTypeName);
+                        }
+                        else if (Create_AGENT_DATA_TYPE_from_Members(agentDataType, edmTypeName, propertyCount, (const char* const*)memberNames, memberValues) != AGENT_DATA_TYPES_OK)
+                        {
+                            result = __FAILURE__;
+                            LogError("Creating the agent data type from members failed.");
+                        }
+                        else
+                        {
+                            /*all fine*/
+                        }
+                    }
+
+                    for (j = 0; j < propertyCount; j++)
+                    {
+                        if (memberValues[j].type != EDM_NO_TYPE)
                         {
-                            SCHEMA_MODEL_TYPE_HANDLE modelModel = elementType.elementHandle.modelHandle;
-                            
-                            /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
-                            if (!validateModel_vs_Multitree(startAddress, modelModel, child, offset + Schema_GetModelModelByName_Offset(modelHandle, childName_str)))
+                            Destroy_AGENT_DATA_TYPE(&memberValues[j]);
+                        }
+                    }
+
+                    free((void*)memberNames);
+                }
+
+                free(memberValues);
+            }
+        }
+    }
+    else
+    {
+        const char* valueText;
+
+        if (JSONDecoder_Reader_GetValue(reader, &valueText) != JSON_DECODER_OK)
+        {
+            result = __FAILURE__;
+            LogError("failure in JSONDecoder_Reader_GetValue");
+        }
+        else if (CreateAgentDataType_From_String(valueText, primitiveType, agentDataType) != AGENT_DATA_TYPES_OK)
+        {
+            result = __FAILURE__;
+            LogError("Failed parsing value %s.", valueText);
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+
+    return result;
+}
+
+/*walks the members of the JSON object the reader is positioned on together with the model (complete or incomplete)*/
+/*if the JSON contains more than the model, then it fails.*/
+/*isRoot is true for the object of the desired properties themselves, which has to be an object and may have a $version*/
+static bool IngestModelDesiredProperties(void* startAddress, SCHEMA_MODEL_TYPE_HANDLE modelHandle, JSON_DECODER_READER* reader, size_t offset, bool isRoot)
+{
+    bool result;
+    JSON_DECODER_RESULT beginResult = JSONDecoder_Reader_BeginObject(reader);
+
+    if (!isRoot && (beginResult == JSON_DECODER_PARSE_ERROR))
+    {
+        /*Codes_SRS_COMMAND_DECODER_09_009: [ If the value of a model in model is not a JSON object (a TWIN patch deletes a property with null) then the value shall be skipped and the model in model shall be ingested as having no members. ]*/
+        if (JSONDecoder_Reader_SkipValue(reader) != JSON_DECODER_OK)
+        {
+            LogError("failure in JSONDecoder_Reader_SkipValue");
+            result = false;
+        }
+        else
+        {
+            result = true;
+        }
+    }
+    else if (beginResult != JSON_DECODER_OK)
+    {
+        LogError("desired properties of a model have to be a JSON object");
+        result = false;
+    }
+    else
+    {
+        const char* memberName;
+
+        result = true;
+        while (result)
+        {
+            /*Codes_SRS_COMMAND_DECODER_09_005: [ CommandDecoder_IngestDesiredProperties shall walk the members of the JSON object in document order together with the model, recursively. ]*/
+            if (JSONDecoder_Reader_NextMember(reader, &memberName) != JSON_DECODER_OK)
+            {
+                LogError("failure in JSONDecoder_Reader_NextMember");
+                result = false;
+            }
+            else if (memberName == NULL)
+            {
+                /*Codes_SRS_COMMAND_DECODER_09_008: [ If all the members of the JSON object have been ingested then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+                break;
+            }
+            else if (isRoot && (strcmp(memberName, "$version") == 0))
+            {
+                /*Codes_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
+                if (JSONDecoder_Reader_SkipValue(reader) != JSON_DECODER_OK)
+                {
+                    LogError("failure in JSONDecoder_Reader_SkipValue");
+                    result = false;
+                }
+            }
+            else
+            {
+                SCHEMA_MODEL_ELEMENT elementType = Schema_GetModelElementByName(modelHandle, memberName);
+                switch (elementType.elementType)
+                {
+                    default:
+                    {
+                        LogError("INTERNAL ERROR: unexpected function return");
+                        result = false;
+                        break;
+                    }
+                    case (SCHEMA_PROPERTY):
+                    {
+                        LogError("cannot ingest name (WITH_DATA instead of WITH_DESIRED_PROPERTY): %s", memberName);
+                        result = false;
+                        break;
+                    }
+                    case (SCHEMA_REPORTED_PROPERTY):
+                    {
+                        LogError("cannot ingest name (WITH_REPORTED_PROPERTY instead of WITH_DESIRED_PROPERTY): %s", memberName);
+                        result = false;
+                        break;
+                    }
+                    case (SCHEMA_DESIRED_PROPERTY):
+                    {
+                        /*Codes_SRS_COMMAND_DECODER_09_006: [ If the member name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the member value, read in place. ]*/
+                        SCHEMA_DESIRED_PROPERTY_HANDLE desiredPropertyHandle = elementType.elementHandle.desiredPropertyHandle;
+
+                        const char* desiredPropertyType = Schema_GetModelDesiredPropertyType(desiredPropertyHandle);
+                        AGENT_DATA_TYPE output;
+                        if (DecodeValueFromReader(Schema_GetSchemaForModelType(modelHandle), &output, reader, desiredPropertyType) != 0)
+                        {
+                            LogError("failure in DecodeValueFromReader");
+                            result = false;
+                        }
+                        else
+                        {
+                            /*Codes_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
+                            pfDesiredPropertyFromAGENT_DATA_TYPE leFunction = Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(desiredPropertyHandle);
+                            if (leFunction(&output, (char*)startAddress + offset + Schema_GetModelDesiredProperty_offset(desiredPropertyHandle)) != 0)
                             {
-                                LogError("failure in validateModel_vs_Multitree");
-                                i = nChildren;
+                                LogError("failure in a function that converts from AGENT_DATA_TYPE to C data");
+                                result = false;
                             }
                             else
                             {
-                                /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
-                                /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
-                                pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(modelHandle, childName_str);
+                                /*Codes_SRS_COMMAND_DECODER_02_013: [ If the desired property has a non-NULL pfOnDesiredProperty then it shall be called. ]*/
+                                pfOnDesiredProperty onDesiredProperty = Schema_GetModelDesiredProperty_pfOnDesiredProperty(desiredPropertyHandle);
                                 if (onDesiredProperty != NULL)
                                 {
                                     onDesiredProperty((char*)startAddress + offset);
                                 }
-                                
-                                nProcessedChildren++;
                             }
-                            
-                            break;
+                            Destroy_AGENT_DATA_TYPE(&output);
                         }
 
-                    } /*switch*/
-                }
-                STRING_delete(childName);
+                        break;
+                    }
+                    case(SCHEMA_MODEL_IN_MODEL):
+                    {
+                        SCHEMA_MODEL_TYPE_HANDLE modelModel = elementType.elementHandle.modelHandle;
+
+                        /*Codes_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
+                        if (!IngestModelDesiredProperties(startAddress, modelModel, reader, offset + Schema_GetModelModelByName_Offset(modelHandle, memberName), false))
+                        {
+                            LogError("failure in IngestModelDesiredProperties");
+                            result = false;
+                        }
+                        else
+                        {
+                            /*if the model in model so happened to be a WITH_DESIRED_PROPERTY... (only those has non_NULL pfOnDesiredProperty) */
+                            /*Codes_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
+                            pfOnDesiredProperty onDesiredProperty = Schema_GetModelModelByName_OnDesiredProperty(modelHandle, memberName);
+                            if (onDesiredProperty != NULL)
+                            {
+                                onDesiredProperty((char*)startAddress + offset);
+                            }
+                        }
+
+                        break;
+                    }
+                } /*switch*/
             }
         }
     }
 
-    if(nProcessedChildren == nChildren)
-    {
-        /*Codes_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
-        result = true;
-    }
-    else
+    if (!result)
     {
         /*Codes_SRS_COMMAND_DECODER_02_011: [ Otherwise CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_FAILED. ]*/
         LogError("not all constituents of the JSON have been ingested");
-        result = false;
     }
     return result;
 }
 
-static EXECUTE_COMMAND_RESULT DecodeDesiredProperties(void* startAddress, COMMAND_DECODER_HANDLE_DATA* handle, MULTITREE_HANDLE desiredPropertiesTree)
-{
-    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-    return validateModel_vs_Multitree(startAddress, handle->ModelHandle, desiredPropertiesTree, 0 )?EXECUTE_COMMAND_SUCCESS:EXECUTE_COMMAND_FAILED;
-}
-
-/* Raw JSON has properties we don't need; potentially nodes other than "desired" for full TWIN as well as a $version we don't pass to callees */
-static bool RemoveUnneededTwinProperties(MULTITREE_HANDLE initialParsedTree, bool parseDesiredNode, MULTITREE_HANDLE *desiredPropertiesTree)
+/* A full TWIN has nodes other than "desired"; those are skipped without being decoded */
+static bool MoveToDesiredNode(JSON_DECODER_READER* reader)
 {
-    MULTITREE_HANDLE updateTree;
     bool result;
 
-    if (parseDesiredNode)
+    if (JSONDecoder_Reader_BeginObject(reader) != JSON_DECODER_OK)
     {
-        /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
-        if (MultiTree_GetChildByName(initialParsedTree, "desired", &updateTree) != MULTITREE_OK)
-        {
-            LogError("Unable to find 'desired' in tree");
-            return false;
-        }
+        LogError("TWIN is not a JSON object");
+        result = false;
     }
     else
     {
-        // Tree already starts on node we want so just use it.
-        updateTree = initialParsedTree;
-    }
+        const char* memberName;
 
-    /*Codes_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
-    MULTITREE_RESULT deleteChildResult = MultiTree_DeleteChild(updateTree, "$version");
-    if ((deleteChildResult == MULTITREE_OK) || (deleteChildResult == MULTITREE_CHILD_NOT_FOUND))
-    {
-        *desiredPropertiesTree = updateTree;
-        result = true;
-    }
-    else
-    {
-        *desiredPropertiesTree = NULL;
-        result = false;
+        while (true)
+        {
+            if (JSONDecoder_Reader_NextMember(reader, &memberName) != JSON_DECODER_OK)
+            {
+                LogError("failure in JSONDecoder_Reader_NextMember");
+                result = false;
+                break;
+            }
+            else if (memberName == NULL)
+            {
+                /*Codes_SRS_COMMAND_DECODER_09_004: [ If parseDesiredNode is TRUE and the root object has no member called desired then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+                LogError("Unable to find 'desired' in TWIN");
+                result = false;
+                break;
+            }
+            else if (strcmp(memberName, "desired") == 0)
+            {
+                result = true;
+                break;
+            }
+            /*Codes_SRS_COMMAND_DECODER_09_003: [ If parseDesiredNode is TRUE then the members of the root object other than desired shall be skipped without being decoded. ]*/
+            else if (JSONDecoder_Reader_SkipValue(reader) != JSON_DECODER_OK)
+            {
+                LogError("failure in JSONDecoder_Reader_SkipValue");
+                result = false;
+                break;
+            }
+        }
     }
 
     return result;
@@ -1004,32 +1206,27 @@ EXECUTE_COMMAND_RESULT CommandDecoder_IngestDesiredProperties(void* startAddress
         }
         else
         {
-            /*Codes_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-            MULTITREE_HANDLE initialParsedTree;
-            MULTITREE_HANDLE desiredPropertiesTree;
+            /*Codes_SRS_COMMAND_DECODER_09_001: [ CommandDecoder_IngestDesiredProperties shall read the clone of jsonPayload in place with a JSON_DECODER_READER, without building a MULTITREE_HANDLE. ]*/
+            JSON_DECODER_READER reader;
 
-            if (JSONDecoder_JSON_To_MultiTree(copy, &initialParsedTree) != JSON_DECODER_OK)
+            if (JSONDecoder_Reader_Init(&reader, copy) != JSON_DECODER_OK)
             {
-                LogError("Decoding JSON to a multi tree failed");
+                /*Codes_SRS_COMMAND_DECODER_09_002: [ If the clone of jsonPayload is not well formed JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR before any desired property is constructed. ]*/
+                LogError("Decoding JSON failed");
+                result = EXECUTE_COMMAND_ERROR;
+            }
+            /*Codes_SRS_COMMAND_DECODER_02_014: [ If parseDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
+            else if (parseDesiredNode && !MoveToDesiredNode(&reader))
+            {
+                LogError("Locating the desired properties in the TWIN failed");
                 result = EXECUTE_COMMAND_ERROR;
             }
             else
             {
-                if (RemoveUnneededTwinProperties(initialParsedTree, parseDesiredNode, &desiredPropertiesTree) == false)
-                {
-                    LogError("Removing unneeded twin properties failed");
-                    result = EXECUTE_COMMAND_ERROR;
-                }
-                else
-                {
-                    COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
+                COMMAND_DECODER_HANDLE_DATA* commandDecoderInstance = (COMMAND_DECODER_HANDLE_DATA*)handle;
 
-                    /*Codes_SRS_COMMAND_DECODER_02_006: [ CommandDecoder_IngestDesiredProperties shall parse the MULTITREEE recursively. ]*/
-                    result = DecodeDesiredProperties(startAddress, commandDecoderInstance, desiredPropertiesTree);
-
-                    // Do NOT free desiredPropertiesTree.  It is only a pointer into initialParsedTree.
-                    MultiTree_Destroy(initialParsedTree);
-                }
+                /*Codes_SRS_COMMAND_DECODER_09_005: [ CommandDecoder_IngestDesiredProperties shall walk the members of the JSON object in document order together with the model, recursively. ]*/
+                result = IngestModelDesiredProperties(startAddress, commandDecoderInstance->ModelHandle, &reader, 0, true) ? EXECUTE_COMMAND_SUCCESS : EXECUTE_COMMAND_FAILED;
             }
             free(copy);
         }
@@ -25,17 +25,6 @@ typedef struct DATA_MARSHALLER_HANDLE_DATA_TAG
     bool IncludePropertyPath;
 } DATA_MARSHALLER_HANDLE_DATA;
 
-static int NoCloneFunction(void** destination, const void* source)
-{
-    *destination = (void*)source;
-    return 0;
-}
-
-static void NoFreeFunction(void* value)
-{
-    (void)value;
-}
-
 DATA_MARSHALLER_HANDLE DataMarshaller_Create(SCHEMA_MODEL_TYPE_HANDLE modelHandle, bool includePropertyPath)
 {
     DATA_MARSHALLER_HANDLE_DATA* result;
@@ -77,7 +66,6 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 {
     DATA_MARSHALLER_HANDLE_DATA* dataMarshallerInstance = (DATA_MARSHALLER_HANDLE_DATA*)dataMarshallerHandle;
     DATA_MARSHALLER_RESULT result;
-    MULTITREE_HANDLE treeHandle;
 
     /* Codes_SRS_DATA_MARSHALLER_99_034:[All argument checks shall be performed before calling any other modules.] */
     /* Codes_SRS_DATA_MARSHALLER_99_004:[ DATA_MARSHALLER_INVALID_ARG shall be returned when the function has detected an invalid parameter (NULL) being passed to the function.] */
@@ -120,96 +108,75 @@ DATA_MARSHALLER_RESULT DataMarshaller_SendData(DATA_MARSHALLER_HANDLE dataMarsha
 
         if (i == valueCount)
         {
-            /* Codes_SRS_DATA_MARSHALLER_99_037:[DataMarshaller shall store as MultiTree the data to be encoded by the JSONEncoder module.] */
-            if ((treeHandle = MultiTree_Create(NoCloneFunction, NoFreeFunction)) == NULL)
+            size_t propertyCount = 0;
+            size_t j;
+            JSON_ENCODER_PROPERTY* properties;
+
+            for (j = 0; j < valueCount; j++)
             {
-                /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                result = DATA_MARSHALLER_MULTITREE_ERROR;
+                propertyCount += ((includePropertyPath == false) && (values[j].Value->type == EDM_COMPLEX_TYPE_TYPE)) ?
+                    values[j].Value->value.edmComplexType.nMembers :
+                    1;
+            }
+
+            /* Codes_SRS_DATA_MARSHALLER_09_001: [DataMarshaller_SendData shall gather the (path, value) pairs to be encoded in one array of JSON_ENCODER_PROPERTY and pass it to JSONEncoder_EncodeProperties, without building a MultiTree.] */
+            if ((properties = (JSON_ENCODER_PROPERTY*)malloc((propertyCount == 0 ? 1 : propertyCount) * sizeof(JSON_ENCODER_PROPERTY))) == NULL)
+            {
+                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+                result = DATA_MARSHALLER_ERROR;
                 LOG_DATA_MARSHALLER_ERROR
             }
             else
             {
-                size_t j;
-                result = DATA_MARSHALLER_OK; /* addressing warning in VS compiler */
+                size_t k = 0;
+                JSON_ENCODER_RESULT encodeResult;
+
                 /* Codes_SRS_DATA_MARSHALLER_99_038:[For each pair in the values argument, a string : value pair shall exist in the JSON object in the form of propertyName : value.] */
                 for (j = 0; j < valueCount; j++)
                 {
                     if ((includePropertyPath == false) && (values[j].Value->type == EDM_COMPLEX_TYPE_TYPE))
                     {
-                        size_t k;
+                        size_t m;
 
                         /* Codes_SRS_DATAMARSHALLER_01_001: [If the includePropertyPath argument passed to DataMarshaller_Create was false and only one struct is being sent, the relative path of the value passed to DataMarshaller_SendData - including property name - shall be ignored and the value shall be placed at JSON root.] */
-                        for (k = 0; k < values[j].Value->value.edmComplexType.nMembers; k++)
-                        {
-                            /* Codes_SRS_DATAMARSHALLER_01_004: [In this case the members of the struct shall be added as leafs into the MultiTree, each leaf having the name of the struct member.] */
-                            if (MultiTree_AddLeaf(treeHandle, values[j].Value->value.edmComplexType.fields[k].fieldName, (void*)values[j].Value->value.edmComplexType.fields[k].value) != MULTITREE_OK)
-                            {
-                                break;
-                            }
-                        }
-
-                        if (k < values[j].Value->value.edmComplexType.nMembers)
+                        for (m = 0; m < values[j].Value->value.edmComplexType.nMembers; m++)
                         {
-                            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                            result = DATA_MARSHALLER_MULTITREE_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                            break;
+                            /* Codes_SRS_DATA_MARSHALLER_09_003: [In this case the members of the struct shall be encoded at JSON root, each having the name of the struct member.] */
+                            properties[k].path = values[j].Value->value.edmComplexType.fields[m].fieldName;
+                            properties[k].value = values[j].Value->value.edmComplexType.fields[m].value;
+                            k++;
                         }
                     }
                     else
                     {
                         /* Codes_SRS_DATA_MARSHALLER_99_039:[ If the includePropertyPath argument passed to DataMarshaller_Create was true each property shall be placed in the appropriate position in the JSON according to its path in the model.] */
-                        if (MultiTree_AddLeaf(treeHandle, values[j].PropertyPath, (void*)values[j].Value) != MULTITREE_OK)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-                            result = DATA_MARSHALLER_MULTITREE_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                            break;
-                        }
+                        properties[k].path = values[j].PropertyPath;
+                        properties[k].value = values[j].Value;
+                        k++;
                     }
-
                 }
 
-                if (j == valueCount)
+                /* Codes_SRS_DATA_MARSHALLER_09_002: [DataMarshaller_SendData shall return in the output parameters *destination, *destinationSize the buffer produced by JSONEncoder_EncodeProperties and its length, without copying it.] */
+                encodeResult = JSONEncoder_EncodeProperties(properties, propertyCount, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString, destination, destinationSize);
+                if (encodeResult == JSON_ENCODER_ALREADY_EXISTS)
                 {
-                    STRING_HANDLE payload = STRING_new();
-                    if (payload == NULL)
-                    {
-                        result = DATA_MARSHALLER_ERROR;
-                        LOG_DATA_MARSHALLER_ERROR
-                    }
-                    else
-                    {
-                        if (JSONEncoder_EncodeTree(treeHandle, payload, (JSON_ENCODER_TOSTRING_FUNC)AgentDataTypes_ToString) != JSON_ENCODER_OK)
-                        {
-                            /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
-                            result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
-                            LOG_DATA_MARSHALLER_ERROR
-                        }
-                        else
-                        {
-                            /*Codes_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
-                            size_t resultSize = STRING_length(payload);
-                            unsigned char* temp = malloc(resultSize);
-                            if (temp == NULL)
-                            {
-                                /*Codes_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
-                                result = DATA_MARSHALLER_ERROR;
-                                LOG_DATA_MARSHALLER_ERROR;
-                            }
-                            else
-                            {
-                                (void)memcpy(temp, STRING_c_str(payload), resultSize);
-                                *destination = temp;
-                                *destinationSize = resultSize;
-                                result = DATA_MARSHALLER_OK;
-                            }
-                        }
-                        STRING_delete(payload);
-                    }
-                } /* if (j==valueCount)*/
-                MultiTree_Destroy(treeHandle);
-            } /* MultiTree_Create */
+                    /* Codes_SRS_DATA_MARSHALLER_09_004: [If JSONEncoder_EncodeProperties returns JSON_ENCODER_ALREADY_EXISTS, DataMarshaller_SendData shall return DATA_MARSHALLER_MULTITREE_ERROR.] */
+                    result = DATA_MARSHALLER_MULTITREE_ERROR;
+                    LOG_DATA_MARSHALLER_ERROR
+                }
+                else if (encodeResult != JSON_ENCODER_OK)
+                {
+                    /* Codes_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
+                    result = DATA_MARSHALLER_JSON_ENCODER_ERROR;
+                    LOG_DATA_MARSHALLER_ERROR
+                }
+                else
+                {
+                    result = DATA_MARSHALLER_OK;
+                }
+
+                free(properties);
+            }
         }
     }
 
@@ -216,12 +216,11 @@ static JSON_DECODER_RESULT ParseNumber(PARSER_STATE* parserState)
     return result;
 }
 
-static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode, char** stringBegin)
+/* parses a string, a number or a literal name; objects and arrays are left to the caller */
+static JSON_DECODER_RESULT ParseScalarValue(PARSER_STATE* parserState, char** stringBegin)
 {
     JSON_DECODER_RESULT result;
 
-    SkipWhiteSpaces(parserState);
-
     if (*(parserState->json) == '"')
     {
         result = ParseString(parserState, stringBegin);
@@ -247,17 +246,6 @@ static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, MULTITREE_HANDL
         parserState->json += 4;
         result = JSON_DECODER_OK;
     }
-    /* Tests_SRS_JSON_DECODER_99_018:[ A JSON value MUST be an object, array, number, or string, or one of the following three literal names: false null true] */
-    else if (*(parserState->json) == '[')
-    {
-        result = ParseArray(parserState, currentNode);
-        *stringBegin = NULL;
-    }
-    else if (*(parserState->json) == '{')
-    {
-        result = ParseObject(parserState, currentNode);
-        *stringBegin = NULL;
-    }
     else if (
         (
             ISDIGIT(*(parserState->json))
@@ -276,6 +264,31 @@ static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, MULTITREE_HANDL
     return result;
 }
 
+static JSON_DECODER_RESULT ParseValue(PARSER_STATE* parserState, MULTITREE_HANDLE currentNode, char** stringBegin)
+{
+    JSON_DECODER_RESULT result;
+
+    SkipWhiteSpaces(parserState);
+
+    /* Tests_SRS_JSON_DECODER_99_018:[ A JSON value MUST be an object, array, number, or string, or one of the following three literal names: false null true] */
+    if (*(parserState->json) == '[')
+    {
+        result = ParseArray(parserState, currentNode);
+        *stringBegin = NULL;
+    }
+    else if (*(parserState->json) == '{')
+    {
+        result = ParseObject(parserState, currentNode);
+        *stringBegin = NULL;
+    }
+    else
+    {
+        result = ParseScalarValue(parserState, stringBegin);
+    }
+
+    return result;
+}
+
 static JSON_DECODER_RESULT ParseColon(PARSER_STATE* parserState)
 {
     JSON_DECODER_RESULT result;
@@ -609,3 +622,390 @@ JSON_DECODER_RESULT JSONDecoder_JSON_To_MultiTree(char* json, MULTITREE_HANDLE*
 
     return result;
 }
+
+static JSON_DECODER_RESULT SkipValue(PARSER_STATE* parserState);
+
+/* SkipObject and SkipArray accept the same texts as ParseObject and ParseArray, but they neither write to the JSON nor build a multi tree */
+static JSON_DECODER_RESULT SkipObject(PARSER_STATE* parserState)
+{
+    JSON_DECODER_RESULT result = ParseOpenCurly(parserState);
+    if (result == JSON_DECODER_OK)
+    {
+        char jsonChar;
+
+        SkipWhiteSpaces(parserState);
+
+        jsonChar = *(parserState->json);
+        while ((jsonChar != '}') && (jsonChar != '\0'))
+        {
+            char* memberNameBegin;
+
+            SkipWhiteSpaces(parserState);
+
+            /* Codes_SRS_JSON_DECODER_99_022:[ A name is a string.] */
+            if (((result = ParseString(parserState, &memberNameBegin)) != JSON_DECODER_OK) ||
+                ((result = ParseColon(parserState)) != JSON_DECODER_OK) ||
+                ((result = SkipValue(parserState)) != JSON_DECODER_OK))
+            {
+                break;
+            }
+
+            SkipWhiteSpaces(parserState);
+            jsonChar = *(parserState->json);
+
+            /* Codes_SRS_JSON_DECODER_99_024:[ A single comma separates a value from a following name.] */
+            if (jsonChar == ',')
+            {
+                parserState->json++;
+            }
+        }
+
+        if (result != JSON_DECODER_OK)
+        {
+            /* already have error */
+        }
+        else if (jsonChar != '}')
+        {
+            /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+        else
+        {
+            parserState->json++;
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_RESULT SkipArray(PARSER_STATE* parserState)
+{
+    JSON_DECODER_RESULT result;
+
+    SkipWhiteSpaces(parserState);
+
+    /* Codes_SRS_JSON_DECODER_99_026:[ An array structure is represented as square brackets surrounding zero or more values (or elements).] */
+    if (*(parserState->json) != '[')
+    {
+        /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+        result = JSON_DECODER_PARSE_ERROR;
+    }
+    else
+    {
+        char jsonChar;
+        result = JSON_DECODER_OK;
+
+        parserState->json++;
+
+        SkipWhiteSpaces(parserState);
+
+        jsonChar = *parserState->json;
+        while ((jsonChar != ']') && (jsonChar != '\0'))
+        {
+            if ((result = SkipValue(parserState)) != JSON_DECODER_OK)
+            {
+                break;
+            }
+
+            SkipWhiteSpaces(parserState);
+            jsonChar = *(parserState->json);
+
+            /* Codes_SRS_JSON_DECODER_99_027:[ Elements are separated by commas.] */
+            if (jsonChar == ',')
+            {
+                parserState->json++;
+            }
+            else if (jsonChar == ']')
+            {
+                break;
+            }
+            else
+            {
+                /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+                result = JSON_DECODER_PARSE_ERROR;
+                break;
+            }
+        }
+
+        if (result != JSON_DECODER_OK)
+        {
+            /* already have error */
+        }
+        else if (jsonChar != ']')
+        {
+            /* Codes_SRS_JSON_DECODER_99_007:[ If parsing the JSON fails due to the JSON string being malformed, JSONDecoder_JSON_To_MultiTree shall return JSON_DECODER_PARSE_ERROR.] */
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+        else
+        {
+            parserState->json++;
+        }
+    }
+
+    return result;
+}
+
+static JSON_DECODER_RESULT SkipValue(PARSER_STATE* parserState)
+{
+    JSON_DECODER_RESULT result;
+    char* stringBegin;
+
+    SkipWhiteSpaces(parserState);
+
+    if (*(parserState->json) == '{')
+    {
+        result = SkipObject(parserState);
+    }
+    else if (*(parserState->json) == '[')
+    {
+        result = SkipArray(parserState);
+    }
+    else
+    {
+        result = ParseScalarValue(parserState, &stringBegin);
+    }
+
+    return result;
+}
+
+/* the reader terminates names and values in place; a value can be followed immediately by the ',' or '}' the reader still has to see, so that character is put back before the reader moves on */
+static void RestoreTerminatedChar(JSON_DECODER_READER* reader)
+{
+    if (reader->terminator != NULL)
+    {
+        *(reader->terminator) = reader->terminatedChar;
+        reader->terminator = NULL;
+    }
+}
+
+JSON_DECODER_RESULT JSONDecoder_Reader_Init(JSON_DECODER_READER* reader, char* json)
+{
+    JSON_DECODER_RESULT result;
+
+    if ((reader == NULL) ||
+        (json == NULL))
+    {
+        /* Codes_SRS_JSON_DECODER_09_001: [ If reader or json is NULL then JSONDecoder_Reader_Init shall return JSON_DECODER_INVALID_ARG. ] */
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        PARSER_STATE parserState;
+        parserState.json = json;
+
+        /* Codes_SRS_JSON_DECODER_09_002: [ JSONDecoder_Reader_Init shall check that json is an object or an array followed only by white space, without modifying json and without allocating memory. ] */
+        SkipWhiteSpaces(&parserState);
+        if (*(parserState.json) == '{')
+        {
+            result = SkipObject(&parserState);
+        }
+        else if (*(parserState.json) == '[')
+        {
+            result = SkipArray(&parserState);
+        }
+        else
+        {
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+
+        if (result == JSON_DECODER_OK)
+        {
+            SkipWhiteSpaces(&parserState);
+            if (*(parserState.json) != '\0')
+            {
+                result = JSON_DECODER_PARSE_ERROR;
+            }
+        }
+
+        if (result != JSON_DECODER_OK)
+        {
+            /* Codes_SRS_JSON_DECODER_09_003: [ If json is malformed then JSONDecoder_Reader_Init shall return JSON_DECODER_PARSE_ERROR. ] */
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+        else
+        {
+            /* Codes_SRS_JSON_DECODER_09_004: [ Otherwise JSONDecoder_Reader_Init shall position reader on the first value of json and return JSON_DECODER_OK. ] */
+            reader->json = json;
+            reader->terminator = NULL;
+            reader->terminatedChar = '\0';
+        }
+    }
+
+    return result;
+}
+
+JSON_DECODER_RESULT JSONDecoder_Reader_BeginObject(JSON_DECODER_READER* reader)
+{
+    JSON_DECODER_RESULT result;
+
+    if (reader == NULL)
+    {
+        /* Codes_SRS_JSON_DECODER_09_005: [ If reader is NULL then JSONDecoder_Reader_BeginObject shall return JSON_DECODER_INVALID_ARG. ] */
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        PARSER_STATE parserState;
+
+        /* Codes_SRS_JSON_DECODER_09_016: [ Every reader function shall first put back the character that the previous call replaced with a terminator. ] */
+        RestoreTerminatedChar(reader);
+        parserState.json = reader->json;
+
+        /* Codes_SRS_JSON_DECODER_09_006: [ JSONDecoder_Reader_BeginObject shall enter the object at the position of reader and return JSON_DECODER_OK. ] */
+        /* Codes_SRS_JSON_DECODER_09_007: [ If the value at the position of reader is not an object then JSONDecoder_Reader_BeginObject shall return JSON_DECODER_PARSE_ERROR and leave reader where it is. ] */
+        result = ParseOpenCurly(&parserState);
+        if (result == JSON_DECODER_OK)
+        {
+            reader->json = parserState.json;
+        }
+    }
+
+    return result;
+}
+
+JSON_DECODER_RESULT JSONDecoder_Reader_NextMember(JSON_DECODER_READER* reader, const char** name)
+{
+    JSON_DECODER_RESULT result;
+
+    if ((reader == NULL) ||
+        (name == NULL))
+    {
+        /* Codes_SRS_JSON_DECODER_09_008: [ If reader or name is NULL then JSONDecoder_Reader_NextMember shall return JSON_DECODER_INVALID_ARG. ] */
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        PARSER_STATE parserState;
+
+        /* Codes_SRS_JSON_DECODER_09_016: [ Every reader function shall first put back the character that the previous call replaced with a terminator. ] */
+        RestoreTerminatedChar(reader);
+        parserState.json = reader->json;
+
+        SkipWhiteSpaces(&parserState);
+        if (*(parserState.json) == ',')
+        {
+            parserState.json++;
+            SkipWhiteSpaces(&parserState);
+        }
+
+        if (*(parserState.json) == '}')
+        {
+            /* Codes_SRS_JSON_DECODER_09_010: [ At the end of the current object JSONDecoder_Reader_NextMember shall set name to NULL, position reader after the object and return JSON_DECODER_OK. ] */
+            parserState.json++;
+            reader->json = parserState.json;
+            *name = NULL;
+            result = JSON_DECODER_OK;
+        }
+        else
+        {
+            char* memberNameBegin;
+
+            if (ParseString(&parserState, &memberNameBegin) != JSON_DECODER_OK)
+            {
+                /* Codes_SRS_JSON_DECODER_09_011: [ If reader is not positioned on a member of an object then JSONDecoder_Reader_NextMember shall return JSON_DECODER_PARSE_ERROR. ] */
+                result = JSON_DECODER_PARSE_ERROR;
+            }
+            else
+            {
+                char* memberNameEnd = parserState.json - 1;
+
+                if (ParseColon(&parserState) != JSON_DECODER_OK)
+                {
+                    /* Codes_SRS_JSON_DECODER_09_011: [ If reader is not positioned on a member of an object then JSONDecoder_Reader_NextMember shall return JSON_DECODER_PARSE_ERROR. ] */
+                    result = JSON_DECODER_PARSE_ERROR;
+                }
+                else
+                {
+                    /* Codes_SRS_JSON_DECODER_09_009: [ JSONDecoder_Reader_NextMember shall return in name the name of the next member of the current object, terminated in place in json, position reader on the value of the member and return JSON_DECODER_OK. ] */
+                    /* the closing quotation mark of the name is never read again, so it is overwritten for good */
+                    *memberNameEnd = '\0';
+                    *name = memberNameBegin + 1;
+                    reader->json = parserState.json;
+                    result = JSON_DECODER_OK;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+JSON_DECODER_RESULT JSONDecoder_Reader_GetValue(JSON_DECODER_READER* reader, const char** value)
+{
+    JSON_DECODER_RESULT result;
+
+    if ((reader == NULL) ||
+        (value == NULL))
+    {
+        /* Codes_SRS_JSON_DECODER_09_012: [ If reader or value is NULL then JSONDecoder_Reader_GetValue shall return JSON_DECODER_INVALID_ARG. ] */
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        PARSER_STATE parserState;
+
+        /* Codes_SRS_JSON_DECODER_09_016: [ Every reader function shall first put back the character that the previous call replaced with a terminator. ] */
+        RestoreTerminatedChar(reader);
+        parserState.json = reader->json;
+
+        SkipWhiteSpaces(&parserState);
+        if ((*(parserState.json) == '{') ||
+            (*(parserState.json) == '['))
+        {
+            /* Codes_SRS_JSON_DECODER_09_014: [ If the value at the position of reader is an object or an array then JSONDecoder_Reader_GetValue shall return JSON_DECODER_PARSE_ERROR and leave reader where it is. ] */
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+        else
+        {
+            char* valueBegin;
+
+            result = ParseScalarValue(&parserState, &valueBegin);
+            if (result == JSON_DECODER_OK)
+            {
+                /* Codes_SRS_JSON_DECODER_09_013: [ JSONDecoder_Reader_GetValue shall return in value the text of the string, number or literal name at the position of reader, terminated in place in json, position reader after it and return JSON_DECODER_OK. ] */
+                /* Codes_SRS_JSON_DECODER_99_049:[ JSONDecoder shall not allocate new string values for the leafs, but rather point to strings in the original JSON.] */
+                /* Codes_SRS_JSON_DECODER_09_015: [ value shall stay valid until the next call of a reader function on reader. ] */
+                reader->terminator = parserState.json;
+                reader->terminatedChar = *(parserState.json);
+                *(parserState.json) = '\0';
+                reader->json = parserState.json;
+                *value = valueBegin;
+            }
+        }
+    }
+
+    return result;
+}
+
+JSON_DECODER_RESULT JSONDecoder_Reader_SkipValue(JSON_DECODER_READER* reader)
+{
+    JSON_DECODER_RESULT result;
+
+    if (reader == NULL)
+    {
+        /* Codes_SRS_JSON_DECODER_09_017: [ If reader is NULL then JSONDecoder_Reader_SkipValue shall return JSON_DECODER_INVALID_ARG. ] */
+        result = JSON_DECODER_INVALID_ARG;
+    }
+    else
+    {
+        PARSER_STATE parserState;
+
+        /* Codes_SRS_JSON_DECODER_09_016: [ Every reader function shall first put back the character that the previous call replaced with a terminator. ] */
+        RestoreTerminatedChar(reader);
+        parserState.json = reader->json;
+
+        /* Codes_SRS_JSON_DECODER_09_018: [ JSONDecoder_Reader_SkipValue shall position reader after the value at its position, objects and arrays included, without terminating anything in json, and return JSON_DECODER_OK. ] */
+        result = SkipValue(&parserState);
+        if (result == JSON_DECODER_OK)
+        {
+            reader->json = parserState.json;
+        }
+        else
+        {
+            /* Codes_SRS_JSON_DECODER_09_019: [ If the value at the position of reader cannot be skipped then JSONDecoder_Reader_SkipValue shall return JSON_DECODER_PARSE_ERROR. ] */
+            result = JSON_DECODER_PARSE_ERROR;
+        }
+    }
+
+    return result;
+}
@@ -1,6 +1,10 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "jsonencoder.h"
@@ -15,6 +19,16 @@
 DEFINE_ENUM_STRINGS(JSON_ENCODER_TOSTRING_RESULT, JSON_ENCODER_TOSTRING_RESULT_VALUES);
 DEFINE_ENUM_STRINGS(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 
+/* Room for a small telemetry message; the buffer doubles from here when needed. */
+#define JSON_ENCODER_INITIAL_BUFFER_SIZE 128
+
+typedef struct JSON_ENCODER_BUFFER_TAG
+{
+    unsigned char* data;
+    size_t size;
+    size_t capacity;
+} JSON_ENCODER_BUFFER;
+
 JSON_ENCODER_RESULT JSONEncoder_EncodeTree(MULTITREE_HANDLE treeHandle, STRING_HANDLE destination, JSON_ENCODER_TOSTRING_FUNC toStringFunc)
 {
     JSON_ENCODER_RESULT result;
@@ -190,6 +204,368 @@ JSON_ENCODER_RESULT JSONEncoder_EncodeTree(MULTITREE_HANDLE treeHandle, STRING_H
 #endif
 }
 
+static int appendToBuffer(JSON_ENCODER_BUFFER* buffer, const char* source, size_t length)
+{
+    int result;
+
+    if (length > buffer->capacity - buffer->size)
+    {
+        size_t newCapacity = (buffer->capacity == 0) ? JSON_ENCODER_INITIAL_BUFFER_SIZE : buffer->capacity;
+        unsigned char* newData;
+
+        while ((newCapacity - buffer->size) < length)
+        {
+            newCapacity *= 2;
+        }
+
+        if ((newData = (unsigned char*)realloc(buffer->data, newCapacity)) == NULL)
+        {
+            LogError("unable to grow the JSON output buffer to %lu bytes", (unsigned long)newCapacity);
+            result = __FAILURE__;
+        }
+        else
+        {
+            buffer->data = newData;
+            buffer->capacity = newCapacity;
+            result = 0;
+        }
+    }
+    else
+    {
+        result = 0;
+    }
+
+    if (result == 0)
+    {
+        (void)memcpy(buffer->data + buffer->size, source, length);
+        buffer->size += length;
+    }
+
+    return result;
+}
+
+static const char* skipLeadingSlash(const char* path)
+{
+    return (path[0] == '/') ? path + 1 : path;
+}
+
+#define JSON_ENCODER_NO_NODE ((size_t)-1)
+
+/*one per distinct name of the object being written, the root object being node 0. The children of a node are linked in the order their names first appear*/
+typedef struct JSON_ENCODER_NODE_TAG
+{
+    const char* name;
+    size_t nameLength;
+    size_t hash;
+    size_t parent;
+    size_t firstChild;
+    size_t lastChild;
+    size_t nextSibling;
+    size_t propertyIndex; /*JSON_ENCODER_NO_NODE when the node is an object*/
+} JSON_ENCODER_NODE;
+
+typedef struct JSON_ENCODER_NODES_TAG
+{
+    JSON_ENCODER_NODE* nodes;
+    size_t nodeCount;
+    size_t* slots; /*open addressing table of node indexes, kept at most half full*/
+    size_t mask; /*the number of slots is a power of 2, mask is that number - 1*/
+} JSON_ENCODER_NODES;
+
+static size_t hashName(size_t parent, const char* name, size_t nameLength)
+{
+    /*FNV-1a over the characters of the name followed by the parent node*/
+    size_t result = 2166136261u;
+    size_t i;
+    for (i = 0; i < nameLength; i++)
+    {
+        result = (result ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return (result ^ parent) * 16777619u;
+}
+
+/*returns the node named name (of nameLength characters) under parent, creating it when it does not exist yet*/
+static size_t getNode(JSON_ENCODER_NODES* nodes, size_t parent, const char* name, size_t nameLength, bool* isNew)
+{
+    size_t hash = hashName(parent, name, nameLength);
+    size_t i;
+
+    for (i = hash & nodes->mask; nodes->slots[i] != JSON_ENCODER_NO_NODE; i = (i + 1) & nodes->mask)
+    {
+        const JSON_ENCODER_NODE* node = &nodes->nodes[nodes->slots[i]];
+        if ((node->hash == hash) &&
+            (node->parent == parent) &&
+            (node->nameLength == nameLength) &&
+            (memcmp(node->name, name, nameLength) == 0))
+        {
+            break;
+        }
+    }
+
+    if (nodes->slots[i] != JSON_ENCODER_NO_NODE)
+    {
+        *isNew = false;
+    }
+    else
+    {
+        size_t newNode = nodes->nodeCount++;
+        JSON_ENCODER_NODE* node = &nodes->nodes[newNode];
+        node->name = name;
+        node->nameLength = nameLength;
+        node->hash = hash;
+        node->parent = parent;
+        node->firstChild = JSON_ENCODER_NO_NODE;
+        node->lastChild = JSON_ENCODER_NO_NODE;
+        node->nextSibling = JSON_ENCODER_NO_NODE;
+        node->propertyIndex = JSON_ENCODER_NO_NODE;
+
+        if (nodes->nodes[parent].lastChild == JSON_ENCODER_NO_NODE)
+        {
+            nodes->nodes[parent].firstChild = newNode;
+        }
+        else
+        {
+            nodes->nodes[nodes->nodes[parent].lastChild].nextSibling = newNode;
+        }
+        nodes->nodes[parent].lastChild = newNode;
+
+        nodes->slots[i] = newNode;
+        *isNew = true;
+    }
+
+    return nodes->slots[i];
+}
+
+/*groups the properties by name with one pass over their paths*/
+static JSON_ENCODER_RESULT buildNodes(const JSON_ENCODER_PROPERTY* properties, size_t propertyCount, JSON_ENCODER_NODES* nodes)
+{
+    JSON_ENCODER_RESULT result = JSON_ENCODER_OK;
+    size_t i;
+
+    for (i = 0; (i < propertyCount) && (result == JSON_ENCODER_OK); i++)
+    {
+        const char* name = skipLeadingSlash(properties[i].path);
+        size_t parent = 0;
+        bool isDone = false;
+
+        while (!isDone && (result == JSON_ENCODER_OK))
+        {
+            const char* nameEnd = strchr(name, '/');
+            size_t nameLength = (nameEnd == NULL) ? strlen(name) : (size_t)(nameEnd - name);
+
+            if (nameLength == 0)
+            {
+                /*Codes_SRS_JSON_ENCODER_09_005: [If a path contains an empty name, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+                result = JSON_ENCODER_INVALID_ARG;
+                LogError("empty name in path \"%s\"", properties[i].path);
+            }
+            else
+            {
+                bool isNew;
+                size_t node = getNode(nodes, parent, name, nameLength, &isNew);
+
+                if ((!isNew && (nameEnd == NULL)) ||
+                    (nodes->nodes[node].propertyIndex != JSON_ENCODER_NO_NODE))
+                {
+                    /*Codes_SRS_JSON_ENCODER_09_006: [If the same path is given twice, or a path names both a value and an object, JSONEncoder_EncodeProperties shall return JSON_ENCODER_ALREADY_EXISTS.]*/
+                    result = JSON_ENCODER_ALREADY_EXISTS;
+                    LogError("path \"%s\" conflicts with an earlier path", properties[i].path);
+                }
+                else if (nameEnd == NULL)
+                {
+                    nodes->nodes[node].propertyIndex = i;
+                    isDone = true;
+                }
+                else
+                {
+                    /*Codes_SRS_JSON_ENCODER_09_004: [A path is a list of names separated by "/", with an optional leading "/"; properties whose paths share a first name shall be placed, in the order that name first appears, in a nested JSON object having that name.]*/
+                    parent = node;
+                    name = nameEnd + 1;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*writes the JSON object of node, its names in the order they first appear in properties*/
+static JSON_ENCODER_RESULT encodeObject(const JSON_ENCODER_NODES* nodes, size_t node, const JSON_ENCODER_PROPERTY* properties, JSON_ENCODER_TOSTRING_FUNC toStringFunc, STRING_HANDLE scratch, JSON_ENCODER_BUFFER* buffer)
+{
+    JSON_ENCODER_RESULT result;
+
+    if (appendToBuffer(buffer, "{", 1) != 0)
+    {
+        result = JSON_ENCODER_ERROR;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else
+    {
+        size_t child;
+
+        result = JSON_ENCODER_OK;
+        for (child = nodes->nodes[node].firstChild; (child != JSON_ENCODER_NO_NODE) && (result == JSON_ENCODER_OK); child = nodes->nodes[child].nextSibling)
+        {
+            const JSON_ENCODER_NODE* childNode = &nodes->nodes[child];
+
+            /*Codes_SRS_JSON_ENCODER_09_009: [The output shall be formatted like the output of JSONEncoder_EncodeTree for the equivalent tree: "{", name:value pairs separated by ", ", "}".]*/
+            if (((child != nodes->nodes[node].firstChild) && (appendToBuffer(buffer, ", ", 2) != 0)) ||
+                (appendToBuffer(buffer, "\"", 1) != 0) ||
+                (appendToBuffer(buffer, childNode->name, childNode->nameLength) != 0) ||
+                (appendToBuffer(buffer, "\":", 2) != 0))
+            {
+                result = JSON_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else if (childNode->propertyIndex == JSON_ENCODER_NO_NODE)
+            {
+                result = encodeObject(nodes, child, properties, toStringFunc, scratch, buffer);
+            }
+            /*Codes_SRS_JSON_ENCODER_09_007: [Each value shall be converted to text by calling toStringFunc with one scratch STRING_HANDLE that is reused for all the values.]*/
+            else if (STRING_empty(scratch) != 0)
+            {
+                result = JSON_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else if (toStringFunc(scratch, properties[childNode->propertyIndex].value) != JSON_ENCODER_TOSTRING_OK)
+            {
+                /*Codes_SRS_JSON_ENCODER_09_008: [If toStringFunc fails, JSONEncoder_EncodeProperties shall return JSON_ENCODER_TOSTRING_FUNCTION_ERROR.]*/
+                result = JSON_ENCODER_TOSTRING_FUNCTION_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else if (appendToBuffer(buffer, STRING_c_str(scratch), STRING_length(scratch)) != 0)
+            {
+                result = JSON_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else
+            {
+                /*do nothing, result = JSON_ENCODER_OK is set above at the beginning of the FOR loop*/
+            }
+        }
+
+        if ((result == JSON_ENCODER_OK) &&
+            (appendToBuffer(buffer, "}", 1) != 0))
+        {
+            result = JSON_ENCODER_ERROR;
+            LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+        }
+    }
+
+    return result;
+}
+
+JSON_ENCODER_RESULT JSONEncoder_EncodeProperties(const JSON_ENCODER_PROPERTY* properties, size_t propertyCount, JSON_ENCODER_TOSTRING_FUNC toStringFunc, unsigned char** destination, size_t* destinationSize)
+{
+    JSON_ENCODER_RESULT result;
+
+    /*Codes_SRS_JSON_ENCODER_09_001: [If properties, toStringFunc, destination or destinationSize is NULL, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+    if ((properties == NULL) ||
+        (toStringFunc == NULL) ||
+        (destination == NULL) ||
+        (destinationSize == NULL))
+    {
+        result = JSON_ENCODER_INVALID_ARG;
+        LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+    }
+    else
+    {
+        size_t i;
+        size_t nameCount = 0;
+
+        for (i = 0; i < propertyCount; i++)
+        {
+            const char* path;
+
+            if ((properties[i].path == NULL) ||
+                (properties[i].value == NULL))
+            {
+                break;
+            }
+
+            /*a path adds at most one node per name*/
+            nameCount++;
+            for (path = strchr(skipLeadingSlash(properties[i].path), '/'); path != NULL; path = strchr(path + 1, '/'))
+            {
+                nameCount++;
+            }
+        }
+
+        if (i < propertyCount)
+        {
+            /*Codes_SRS_JSON_ENCODER_09_002: [If any property has a NULL path or a NULL value, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+            result = JSON_ENCODER_INVALID_ARG;
+            LogError("invalid property at index %lu", (unsigned long)i);
+        }
+        else
+        {
+            STRING_HANDLE scratch = STRING_new();
+            if (scratch == NULL)
+            {
+                /*Codes_SRS_JSON_ENCODER_09_011: [If any other error occurs, JSONEncoder_EncodeProperties shall free the output buffer and return JSON_ENCODER_ERROR.]*/
+                result = JSON_ENCODER_ERROR;
+                LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+            }
+            else
+            {
+                JSON_ENCODER_NODES nodes;
+                size_t slotCount = 8;
+
+                while (slotCount < 2 * nameCount)
+                {
+                    slotCount *= 2;
+                }
+
+                nodes.nodes = NULL;
+                nodes.slots = NULL;
+                if ((nameCount >= SIZE_MAX / (2 * sizeof(JSON_ENCODER_NODE))) ||
+                    ((nodes.nodes = (JSON_ENCODER_NODE*)malloc((nameCount + 1) * sizeof(JSON_ENCODER_NODE))) == NULL) ||
+                    ((nodes.slots = (size_t*)malloc(slotCount * sizeof(size_t))) == NULL))
+                {
+                    /*Codes_SRS_JSON_ENCODER_09_011: [If any other error occurs, JSONEncoder_EncodeProperties shall free the output buffer and return JSON_ENCODER_ERROR.]*/
+                    result = JSON_ENCODER_ERROR;
+                    LogError("unable to index %lu names", (unsigned long)nameCount);
+                }
+                else
+                {
+                    JSON_ENCODER_BUFFER buffer = { NULL, 0, 0 };
+
+                    for (i = 0; i < slotCount; i++)
+                    {
+                        nodes.slots[i] = JSON_ENCODER_NO_NODE;
+                    }
+                    nodes.mask = slotCount - 1;
+                    nodes.nodeCount = 1;
+                    nodes.nodes[0].firstChild = JSON_ENCODER_NO_NODE;
+                    nodes.nodes[0].lastChild = JSON_ENCODER_NO_NODE;
+                    nodes.nodes[0].propertyIndex = JSON_ENCODER_NO_NODE;
+
+                    /*Codes_SRS_JSON_ENCODER_09_003: [JSONEncoder_EncodeProperties shall group the properties by name in one pass over their paths, then write the JSON object in one pass into a single output buffer that grows as needed, without building a MultiTree.]*/
+                    if (((result = buildNodes(properties, propertyCount, &nodes)) != JSON_ENCODER_OK) ||
+                        ((result = encodeObject(&nodes, 0, properties, toStringFunc, scratch, &buffer)) != JSON_ENCODER_OK))
+                    {
+                        /*Codes_SRS_JSON_ENCODER_09_011: [If any other error occurs, JSONEncoder_EncodeProperties shall free the output buffer and return JSON_ENCODER_ERROR.]*/
+                        LogError("(result = %s)", ENUM_TO_STRING(JSON_ENCODER_RESULT, result));
+                        free(buffer.data);
+                    }
+                    else
+                    {
+                        /*Codes_SRS_JSON_ENCODER_09_010: [On success, JSONEncoder_EncodeProperties shall hand the output buffer over to the caller in *destination (not NUL-terminated), its length in *destinationSize and return JSON_ENCODER_OK.]*/
+                        *destination = buffer.data;
+                        *destinationSize = buffer.size;
+                    }
+                }
+
+                free(nodes.slots);
+                free(nodes.nodes);
+                STRING_delete(scratch);
+            }
+        }
+    }
+
+    return result;
+}
+
 JSON_ENCODER_TOSTRING_RESULT JSONEncoder_CharPtr_ToString(STRING_HANDLE destination, const void* value)
 {
     JSON_ENCODER_TOSTRING_RESULT result;
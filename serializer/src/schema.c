@@ -2,6 +2,8 @@
 // Licensed under the MIT license. See LICENSE file in the project root for full license information.
 
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
 #include "azure_c_shared_utility/gballoc.h"
 
 #include "schema.h"
@@ -68,6 +70,32 @@ typedef struct MODEL_IN_MODEL_TAG
     SCHEMA_MODEL_TYPE_HANDLE modelHandle;
 } MODEL_IN_MODEL;
 
+typedef enum SCHEMA_NAME_KIND_TAG
+{
+    SCHEMA_NAME_MODEL,
+    SCHEMA_NAME_PROPERTY,
+    SCHEMA_NAME_REPORTED_PROPERTY,
+    SCHEMA_NAME_DESIRED_PROPERTY,
+    SCHEMA_NAME_ACTION,
+    SCHEMA_NAME_METHOD,
+    SCHEMA_NAME_MODEL_IN_MODEL
+} SCHEMA_NAME_KIND;
+
+typedef struct SCHEMA_NAME_INDEX_ENTRY_TAG
+{
+    const char* name; /*is NULL for a free entry, otherwise points to the name owned by the element*/
+    size_t nameLength;
+    size_t hash;
+    SCHEMA_NAME_KIND kind;
+    void* element; /*what a lookup by name of this kind finds, see BuildModelNameIndex*/
+} SCHEMA_NAME_INDEX_ENTRY;
+
+typedef struct SCHEMA_NAME_INDEX_TAG
+{
+    size_t mask; /*the number of entries is a power of 2, mask is that number - 1*/
+    SCHEMA_NAME_INDEX_ENTRY* entries;
+} SCHEMA_NAME_INDEX;
+
 typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
 {
     VECTOR_HANDLE methods; /*holds SCHEMA_METHOD_HANDLE*/
@@ -81,6 +109,7 @@ typedef struct SCHEMA_MODEL_TYPE_HANDLE_DATA_TAG
     size_t ActionCount;
     VECTOR_HANDLE models;
     size_t DeviceCount;
+    SCHEMA_NAME_INDEX* NameIndex; /*built by Schema_AddDeviceRef, discarded when an element is added to the model, NULL means lookups scan*/
 } SCHEMA_MODEL_TYPE_HANDLE_DATA;
 
 typedef struct SCHEMA_STRUCT_TYPE_HANDLE_DATA_TAG
@@ -98,10 +127,308 @@ typedef struct SCHEMA_HANDLE_DATA_TAG
     size_t ModelTypeCount;
     SCHEMA_STRUCT_TYPE_HANDLE* StructTypes;
     size_t StructTypeCount;
+    SCHEMA_NAME_INDEX* ModelIndex; /*built by Schema_AddDeviceRef, discarded when a model is added, NULL means Schema_GetModelByName scans*/
 } SCHEMA_HANDLE_DATA;
 
 static VECTOR_HANDLE g_schemas = NULL;
 
+static size_t HashName(SCHEMA_NAME_KIND kind, const char* name, size_t nameLength)
+{
+    /*FNV-1a over the characters of the name followed by the kind*/
+    size_t result = 2166136261u;
+    size_t i;
+    for (i = 0; i < nameLength; i++)
+    {
+        result = (result ^ (unsigned char)name[i]) * 16777619u;
+    }
+    return (result ^ (size_t)kind) * 16777619u;
+}
+
+static SCHEMA_NAME_INDEX* CreateNameIndex(size_t nameCount)
+{
+    SCHEMA_NAME_INDEX* result;
+
+    if (nameCount > (SIZE_MAX - sizeof(SCHEMA_NAME_INDEX)) / (4 * sizeof(SCHEMA_NAME_INDEX_ENTRY)))
+    {
+        LogError("too many names to index: %zu", nameCount);
+        result = NULL;
+    }
+    else
+    {
+        /*the index is kept at most half full, so that the probe sequences stay short*/
+        size_t entryCount = 8;
+        while (entryCount < 2 * nameCount)
+        {
+            entryCount *= 2;
+        }
+
+        if ((result = (SCHEMA_NAME_INDEX*)malloc(sizeof(SCHEMA_NAME_INDEX) + entryCount * sizeof(SCHEMA_NAME_INDEX_ENTRY))) == NULL)
+        {
+            LogError("failure in malloc");
+        }
+        else
+        {
+            size_t i;
+            result->mask = entryCount - 1;
+            result->entries = (SCHEMA_NAME_INDEX_ENTRY*)(result + 1);
+            for (i = 0; i < entryCount; i++)
+            {
+                result->entries[i].name = NULL;
+            }
+        }
+    }
+
+    return result;
+}
+
+static void DestroyNameIndex(SCHEMA_NAME_INDEX** nameIndex)
+{
+    if (*nameIndex != NULL)
+    {
+        free(*nameIndex);
+        *nameIndex = NULL;
+    }
+}
+
+static void* FindName(const SCHEMA_NAME_INDEX* nameIndex, SCHEMA_NAME_KIND kind, const char* name, size_t nameLength)
+{
+    void* result = NULL;
+    size_t hash = HashName(kind, name, nameLength);
+    size_t i;
+
+    for (i = hash & nameIndex->mask; nameIndex->entries[i].name != NULL; i = (i + 1) & nameIndex->mask)
+    {
+        const SCHEMA_NAME_INDEX_ENTRY* entry = &nameIndex->entries[i];
+        if ((entry->hash == hash) &&
+            (entry->kind == kind) &&
+            (entry->nameLength == nameLength) &&
+            (memcmp(entry->name, name, nameLength) == 0))
+        {
+            result = entry->element;
+            break;
+        }
+    }
+
+    return result;
+}
+
+static void InsertName(SCHEMA_NAME_INDEX* nameIndex, SCHEMA_NAME_KIND kind, const char* name, void* element)
+{
+    size_t nameLength = strlen(name);
+
+    /*the first element inserted with a name is the one found, same as the first match of a scan in insertion order*/
+    if (FindName(nameIndex, kind, name, nameLength) == NULL)
+    {
+        size_t hash = HashName(kind, name, nameLength);
+        size_t i = hash & nameIndex->mask;
+        while (nameIndex->entries[i].name != NULL)
+        {
+            i = (i + 1) & nameIndex->mask;
+        }
+
+        nameIndex->entries[i].name = name;
+        nameIndex->entries[i].nameLength = nameLength;
+        nameIndex->entries[i].hash = hash;
+        nameIndex->entries[i].kind = kind;
+        nameIndex->entries[i].element = element;
+    }
+}
+
+static SCHEMA_NAME_INDEX* BuildModelIndex(SCHEMA_HANDLE_DATA* schema)
+{
+    SCHEMA_NAME_INDEX* result = CreateNameIndex(schema->ModelTypeCount);
+    if (result != NULL)
+    {
+        size_t i;
+        for (i = 0; i < schema->ModelTypeCount; i++)
+        {
+            InsertName(result, SCHEMA_NAME_MODEL, ((SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i])->Name, schema->ModelTypes[i]);
+        }
+    }
+    return result;
+}
+
+static const char* GetModelElementName(SCHEMA_NAME_KIND kind, const void* element)
+{
+    /*element is what the index stores for that kind, see BuildModelNameIndex*/
+    const char* result;
+    switch (kind)
+    {
+    case SCHEMA_NAME_PROPERTY:
+        result = ((const SCHEMA_PROPERTY_HANDLE_DATA*)element)->PropertyName;
+        break;
+    case SCHEMA_NAME_REPORTED_PROPERTY:
+        result = (*(SCHEMA_REPORTED_PROPERTY_HANDLE_DATA* const*)element)->reportedPropertyName;
+        break;
+    case SCHEMA_NAME_DESIRED_PROPERTY:
+        result = (*(SCHEMA_DESIRED_PROPERTY_HANDLE_DATA* const*)element)->desiredPropertyName;
+        break;
+    case SCHEMA_NAME_ACTION:
+        result = ((const SCHEMA_ACTION_HANDLE_DATA*)element)->ActionName;
+        break;
+    case SCHEMA_NAME_METHOD:
+        result = (*(const SCHEMA_METHOD_HANDLE*)element)->methodName;
+        break;
+    case SCHEMA_NAME_MODEL_IN_MODEL:
+        result = ((const MODEL_IN_MODEL*)element)->propertyName;
+        break;
+    default: /*SCHEMA_NAME_MODEL*/
+        result = ((const SCHEMA_MODEL_TYPE_HANDLE_DATA*)element)->Name;
+        break;
+    }
+    return result;
+}
+
+static bool IsSameName(const char* elementName, const char* name, size_t nameLength)
+{
+    return (strncmp(elementName, name, nameLength) == 0) && (elementName[nameLength] == '\0');
+}
+
+static SCHEMA_NAME_INDEX* BuildModelNameIndex(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    size_t nReportedProperties = VECTOR_size(modelType->reportedProperties);
+    size_t nDesiredProperties = VECTOR_size(modelType->desiredProperties);
+    size_t nMethods = VECTOR_size(modelType->methods);
+    size_t nModels = VECTOR_size(modelType->models);
+    SCHEMA_NAME_INDEX* result = CreateNameIndex(modelType->PropertyCount + nReportedProperties + nDesiredProperties + modelType->ActionCount + nMethods + nModels);
+    if (result == NULL)
+    {
+        LogError("unable to index the names of model %s", modelType->Name);
+    }
+    else
+    {
+        size_t i;
+
+        /*properties and actions are indexed by their handle, reported properties, desired properties and methods by the address of their handle in the VECTOR
+        (which is what VECTOR_find_if produces) and models in model by their MODEL_IN_MODEL*/
+        for (i = 0; i < modelType->PropertyCount; i++)
+        {
+            InsertName(result, SCHEMA_NAME_PROPERTY, ((SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i])->PropertyName, modelType->Properties[i]);
+        }
+
+        for (i = 0; i < nReportedProperties; i++)
+        {
+            SCHEMA_REPORTED_PROPERTY_HANDLE_DATA** reportedProperty = (SCHEMA_REPORTED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->reportedProperties, i);
+            InsertName(result, SCHEMA_NAME_REPORTED_PROPERTY, (*reportedProperty)->reportedPropertyName, reportedProperty);
+        }
+
+        for (i = 0; i < nDesiredProperties; i++)
+        {
+            SCHEMA_DESIRED_PROPERTY_HANDLE_DATA** desiredProperty = (SCHEMA_DESIRED_PROPERTY_HANDLE_DATA**)VECTOR_element(modelType->desiredProperties, i);
+            InsertName(result, SCHEMA_NAME_DESIRED_PROPERTY, (*desiredProperty)->desiredPropertyName, desiredProperty);
+        }
+
+        for (i = 0; i < modelType->ActionCount; i++)
+        {
+            InsertName(result, SCHEMA_NAME_ACTION, ((SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i])->ActionName, modelType->Actions[i]);
+        }
+
+        for (i = 0; i < nMethods; i++)
+        {
+            SCHEMA_METHOD_HANDLE* method = (SCHEMA_METHOD_HANDLE*)VECTOR_element(modelType->methods, i);
+            InsertName(result, SCHEMA_NAME_METHOD, (*method)->methodName, method);
+        }
+
+        for (i = 0; i < nModels; i++)
+        {
+            MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+            InsertName(result, SCHEMA_NAME_MODEL_IN_MODEL, modelInModel->propertyName, modelInModel);
+        }
+    }
+
+    return result;
+}
+
+static void IndexModelNames(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType)
+{
+    size_t nModels;
+    size_t i;
+
+    if (modelType->NameIndex == NULL)
+    {
+        modelType->NameIndex = BuildModelNameIndex(modelType);
+    }
+
+    /*the path lookups descend into the models in model, so those are indexed too*/
+    nModels = VECTOR_size(modelType->models);
+    for (i = 0; i < nModels; i++)
+    {
+        MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
+        IndexModelNames((SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelInModel->modelHandle);
+    }
+}
+
+static void* ScanModelElements(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, SCHEMA_NAME_KIND kind, const char* name, size_t nameLength)
+{
+    void* result = NULL;
+    size_t i;
+
+    if ((kind == SCHEMA_NAME_PROPERTY) || (kind == SCHEMA_NAME_ACTION))
+    {
+        size_t count = (kind == SCHEMA_NAME_PROPERTY) ? modelType->PropertyCount : modelType->ActionCount;
+        void** elements = (kind == SCHEMA_NAME_PROPERTY) ? (void**)modelType->Properties : (void**)modelType->Actions;
+        for (i = 0; i < count; i++)
+        {
+            if (IsSameName(GetModelElementName(kind, elements[i]), name, nameLength))
+            {
+                result = elements[i];
+                break;
+            }
+        }
+    }
+    else
+    {
+        VECTOR_HANDLE elements;
+        size_t count;
+
+        if (kind == SCHEMA_NAME_REPORTED_PROPERTY)
+        {
+            elements = modelType->reportedProperties;
+        }
+        else if (kind == SCHEMA_NAME_DESIRED_PROPERTY)
+        {
+            elements = modelType->desiredProperties;
+        }
+        else if (kind == SCHEMA_NAME_METHOD)
+        {
+            elements = modelType->methods;
+        }
+        else
+        {
+            elements = modelType->models;
+        }
+
+        count = VECTOR_size(elements);
+        for (i = 0; i < count; i++)
+        {
+            void* element = VECTOR_element(elements, i);
+            if (IsSameName(GetModelElementName(kind, element), name, nameLength))
+            {
+                result = element;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+static void* FindModelElement(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType, SCHEMA_NAME_KIND kind, const char* name, size_t nameLength)
+{
+    void* result;
+    /*Codes_SRS_SCHEMA_09_001: [ Schema_AddDeviceRef shall build an index of the names of all the properties, reported properties, desired properties, actions, methods and models in model of the model, and of every model in model it contains, that are not indexed yet; lookups by name shall use that index and shall not modify it. ]*/
+    if (modelType->NameIndex == NULL)
+    {
+        /*Codes_SRS_SCHEMA_09_003: [ A lookup by name in a model that has no index, because no device of the model exists yet, because an element was added since or because the index could not be built, shall scan the elements of the model. ]*/
+        result = ScanModelElements(modelType, kind, name, nameLength);
+    }
+    else
+    {
+        result = FindName(modelType->NameIndex, kind, name, nameLength);
+    }
+    return result;
+}
+
 static void DestroyProperty(SCHEMA_PROPERTY_HANDLE propertyHandle)
 {
     SCHEMA_PROPERTY_HANDLE_DATA* propertyType = (SCHEMA_PROPERTY_HANDLE_DATA*)propertyHandle;
@@ -244,6 +571,7 @@ static void DestroyModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     VECTOR_destroy(modelType->models);
 
     free(modelType->Actions);
+    DestroyNameIndex(&modelType->NameIndex);
     free(modelType);
 }
 
@@ -319,6 +647,8 @@ static SCHEMA_RESULT AddModelProperty(SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType,
                     {
                         modelType->Properties[modelType->PropertyCount] = (SCHEMA_PROPERTY_HANDLE)newProperty;
                         modelType->PropertyCount++;
+                        /*Codes_SRS_SCHEMA_09_002: [ Adding a property, reported property, desired property, action, method or model in model to a model shall discard the index of the names of that model. ]*/
+                        DestroyNameIndex(&modelType->NameIndex);
 
                         /* Codes_SRS_SCHEMA_99_012:[On success, Schema_AddModelProperty shall return SCHEMA_OK.] */
                         result = SCHEMA_OK;
@@ -406,6 +736,7 @@ SCHEMA_HANDLE Schema_Create(const char* schemaNamespace, void* metadata)
             result->ModelTypeCount = 0;
             result->StructTypes = NULL;
             result->StructTypeCount = 0;
+            result->ModelIndex = NULL;
             result->metadata = metadata;
         }
     }
@@ -481,6 +812,7 @@ void Schema_Destroy(SCHEMA_HANDLE schemaHandle)
         }
 
         free(schema->StructTypes);
+        DestroyNameIndex(&schema->ModelIndex);
         free((void*)schema->Namespace);
         free(schema);
 
@@ -553,8 +885,22 @@ SCHEMA_RESULT Schema_AddDeviceRef(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle)
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
+        SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)model->SchemaHandle;
+
+        /*the schema is complete once a device uses one of its models, so the indexes are built here and lookups, which may run on any thread, only read them*/
+        /*Codes_SRS_SCHEMA_09_001: [ Schema_AddDeviceRef shall build an index of the names of all the properties, reported properties, desired properties, actions, methods and models in model of the model, and of every model in model it contains, that are not indexed yet; lookups by name shall use that index and shall not modify it. ]*/
+        IndexModelNames(model);
+
+        /*Codes_SRS_SCHEMA_09_004: [ Schema_AddDeviceRef shall build an index of the names of the models of the schema of the model, if it is not built yet; Schema_GetModelByName shall use that index and shall not modify it. ]*/
+        if ((schema->ModelIndex == NULL) &&
+            ((schema->ModelIndex = BuildModelIndex(schema)) == NULL))
+        {
+            LogError("unable to index the models of schema %s", schema->Namespace);
+        }
+
         /* Codes_SRS_SCHEMA_07_188: [If the modelTypeHandle is nonNULL, Schema_AddDeviceRef shall increment the SCHEMA_MODEL_TYPE_HANDLE_DATA DeviceCount variable.] */
         model->DeviceCount++;
+        /*Codes_SRS_SCHEMA_09_007: [ If an index cannot be built, Schema_AddDeviceRef shall still succeed. ]*/
         result = SCHEMA_OK;
     }
     return result;
@@ -705,9 +1051,12 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_CreateModelType(SCHEMA_HANDLE schemaHandle, cons
                                     modelType->Actions = NULL;
                                     modelType->SchemaHandle = schemaHandle;
                                     modelType->DeviceCount = 0;
+                                    modelType->NameIndex = NULL;
 
                                     schema->ModelTypes[schema->ModelTypeCount] = modelType;
                                     schema->ModelTypeCount++;
+                                    /*Codes_SRS_SCHEMA_09_005: [ Schema_CreateModelType shall discard the index of the model names of the schema. ]*/
+                                    DestroyNameIndex(&schema->ModelIndex);
                                     /* Codes_SRS_SCHEMA_99_008:[On success, a non-NULL handle shall be returned.] */
                                     result = (SCHEMA_MODEL_TYPE_HANDLE)modelType;
                                 }
@@ -832,6 +1181,8 @@ SCHEMA_RESULT Schema_AddModelReportedProperty(SCHEMA_MODEL_TYPE_HANDLE modelType
                         }
                         else
                         {
+                            /*Codes_SRS_SCHEMA_09_002: [ Adding a property, reported property, desired property, action, method or model in model to a model shall discard the index of the names of that model. ]*/
+                            DestroyNameIndex(&modelType->NameIndex);
                             /*Codes_SRS_SCHEMA_02_007: [ Otherwise Schema_AddModelReportedProperty shall succeed and return SCHEMA_OK. ]*/
                             result = SCHEMA_OK;
                         }
@@ -912,6 +1263,8 @@ SCHEMA_ACTION_HANDLE Schema_CreateModelAction(SCHEMA_MODEL_TYPE_HANDLE modelType
 
                         modelType->Actions[modelType->ActionCount] = newAction;
                         modelType->ActionCount++;
+                        /*Codes_SRS_SCHEMA_09_002: [ Adding a property, reported property, desired property, action, method or model in model to a model shall discard the index of the names of that model. ]*/
+                        DestroyNameIndex(&modelType->NameIndex);
                         result = (SCHEMA_ACTION_HANDLE)(newAction);
                     }
 
@@ -1009,6 +1362,8 @@ SCHEMA_METHOD_HANDLE Schema_CreateModelMethod(SCHEMA_MODEL_TYPE_HANDLE modelType
                         }
                         else
                         {
+                            /*Codes_SRS_SCHEMA_09_002: [ Adding a property, reported property, desired property, action, method or model in model to a model shall discard the index of the names of that model. ]*/
+                            DestroyNameIndex(&modelTypeHandle->NameIndex);
                             /*Codes_SRS_SCHEMA_02_104: [ Otherwise, Schema_CreateModelMethod shall succeed and return a non-NULL SCHEMA_METHOD_HANDLE. ]*/
                             /*return as is*/
                         }
@@ -1219,29 +1574,14 @@ SCHEMA_PROPERTY_HANDLE Schema_GetModelPropertyByName(SCHEMA_MODEL_TYPE_HANDLE mo
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_036:[Schema_GetModelPropertyByName shall return a non-NULL SCHEMA_PROPERTY_HANDLE corresponding to the model type identified by modelTypeHandle and matching the propertyName argument value.] */
-        for (i = 0; i < modelType->PropertyCount; i++)
-        {
-            SCHEMA_PROPERTY_HANDLE_DATA* modelProperty = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-            if (strcmp(modelProperty->PropertyName, propertyName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == modelType->PropertyCount)
+        if ((result = (SCHEMA_PROPERTY_HANDLE)FindModelElement(modelType, SCHEMA_NAME_PROPERTY, propertyName, strlen(propertyName))) == NULL)
         {
             /* Codes_SRS_SCHEMA_99_038:[Schema_GetModelPropertyByName shall return NULL if unable to find a matching property or if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = (SCHEMA_PROPERTY_HANDLE)(modelType->Properties[i]);
-        }
     }
 
     return result;
@@ -1313,7 +1653,7 @@ SCHEMA_REPORTED_PROPERTY_HANDLE Schema_GetModelReportedPropertyByName(SCHEMA_MOD
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_013: [ If reported property by the name reportedPropertyName exists then Schema_GetModelReportedPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_014: [ Otherwise Schema_GetModelReportedPropertyByName shall fail and return NULL. ]*/
-        if((result = VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyName))==NULL)
+        if ((result = FindModelElement(modelType, SCHEMA_NAME_REPORTED_PROPERTY, reportedPropertyName, strlen(reportedPropertyName))) == NULL)
         {
             LogError("a reported property with name \"%s\" does not exist", reportedPropertyName);
         }
@@ -1387,42 +1727,19 @@ SCHEMA_ACTION_HANDLE Schema_GetModelActionByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     }
     else
     {
-        size_t i;
         SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
         /* Codes_SRS_SCHEMA_99_040:[Schema_GetModelActionByName shall return a non-NULL SCHEMA_ACTION_HANDLE corresponding to the model type identified by modelTypeHandle and matching the actionName argument value.] */
-        for (i = 0; i < modelType->ActionCount; i++)
-        {
-            SCHEMA_ACTION_HANDLE_DATA* modelAction = (SCHEMA_ACTION_HANDLE_DATA*)modelType->Actions[i];
-            if (strcmp(modelAction->ActionName, actionName) == 0)
-            {
-                break;
-            }
-        }
-
-        if (i == modelType->ActionCount)
+        if ((result = (SCHEMA_ACTION_HANDLE)FindModelElement(modelType, SCHEMA_NAME_ACTION, actionName, strlen(actionName))) == NULL)
         {
             /* Codes_SRS_SCHEMA_99_041:[Schema_GetModelActionByName shall return NULL if unable to find a matching action, if any of the arguments are NULL.] */
-            result = NULL;
             LogError("(Error code:%s)", ENUM_TO_STRING(SCHEMA_RESULT, SCHEMA_ELEMENT_NOT_FOUND));
         }
-        else
-        {
-            result = modelType->Actions[i];
-        }
     }
 
     return result;
 }
 
-static bool matchModelMethod(const void* element, const void* value)
-{
-    /*element is a pointer to SCHEMA_METHOD_HANDLE_DATA*/
-    const SCHEMA_METHOD_HANDLE* decodedElement = (const SCHEMA_METHOD_HANDLE* )element;
-    const char* name = (const char*)value;
-    return (strcmp((*decodedElement)->methodName, name) == 0);
-}
-
 SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* methodName)
 {
     SCHEMA_METHOD_HANDLE result;
@@ -1438,7 +1755,7 @@ SCHEMA_METHOD_HANDLE Schema_GetModelMethodByName(SCHEMA_MODEL_TYPE_HANDLE modelT
     else
     {
         /*Codes_SRS_SCHEMA_02_117: [ If a method with the name methodName exists then Schema_GetModelMethodByName shall succeed and returns its handle. ]*/
-        SCHEMA_METHOD_HANDLE* found = VECTOR_find_if(modelTypeHandle->methods, matchModelMethod, methodName);
+        SCHEMA_METHOD_HANDLE* found = (SCHEMA_METHOD_HANDLE*)FindModelElement(modelTypeHandle, SCHEMA_NAME_METHOD, methodName, strlen(methodName));
         if (found == NULL)
         {
             /*Codes_SRS_SCHEMA_02_118: [ Otherwise, Schema_GetModelMethodByName shall fail and return NULL. ]*/
@@ -2197,23 +2514,26 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelByName(SCHEMA_HANDLE schemaHandle, const
     {
         /* Codes_SRS_SCHEMA_99_124: [Schema_GetModelByName shall return a non-NULL SCHEMA_MODEL_TYPE_HANDLE corresponding to the model identified by schemaHandle and matching the modelName argument value.] */
         SCHEMA_HANDLE_DATA* schema = (SCHEMA_HANDLE_DATA*)schemaHandle;
-        size_t i;
-        for (i = 0; i < schema->ModelTypeCount; i++)
+
+        /*Codes_SRS_SCHEMA_09_004: [ Schema_AddDeviceRef shall build an index of the names of the models of the schema of the model, if it is not built yet; Schema_GetModelByName shall use that index and shall not modify it. ]*/
+        if (schema->ModelIndex != NULL)
         {
-            SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i];
-            if (strcmp(modelName, modelType->Name)==0)
-            {
-                break;
-            }
+            result = (SCHEMA_MODEL_TYPE_HANDLE)FindName(schema->ModelIndex, SCHEMA_NAME_MODEL, modelName, strlen(modelName));
         }
-        if (i == schema->ModelTypeCount)
+        else
         {
+            /*Codes_SRS_SCHEMA_09_006: [ If the schema has no index of the names of its models, Schema_GetModelByName shall scan the models of the schema. ]*/
+            size_t i;
             /* Codes_SRS_SCHEMA_99_125: [Schema_GetModelByName shall return NULL if unable to find a matching model, or if any of the arguments are NULL.] */
             result = NULL;
-        }
-        else
-        {
-            result = schema->ModelTypes[i];
+            for (i = 0; i < schema->ModelTypeCount; i++)
+            {
+                if (strcmp(((SCHEMA_MODEL_TYPE_HANDLE_DATA*)schema->ModelTypes[i])->Name, modelName) == 0)
+                {
+                    result = schema->ModelTypes[i];
+                    break;
+                }
+            }
         }
     }
     return result;
@@ -2293,8 +2613,9 @@ SCHEMA_RESULT Schema_AddModelModel(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, con
         }
         else
         {
+            /*Codes_SRS_SCHEMA_09_002: [ Adding a property, reported property, desired property, action, method or model in model to a model shall discard the index of the names of that model. ]*/
+            DestroyNameIndex(&parentModel->NameIndex);
             /*Codes_SRS_SCHEMA_99_164: [If the function succeeds, then the return value shall be SCHEMA_OK.]*/
-            
             result = SCHEMA_OK;
         }
     }
@@ -2325,13 +2646,6 @@ SCHEMA_RESULT Schema_GetModelModelCount(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle
     return result;
 }
 
-static bool matchModelName(const void* element, const void* value)
-{
-    MODEL_IN_MODEL* decodedElement = (MODEL_IN_MODEL*)element;
-    const char* name = (const char*)value;
-    return (strcmp(decodedElement->propertyName, name) == 0);
-}
-
 SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* propertyName)
 {
     SCHEMA_MODEL_TYPE_HANDLE result;
@@ -2349,7 +2663,7 @@ SCHEMA_MODEL_TYPE_HANDLE Schema_GetModelModelByName(SCHEMA_MODEL_TYPE_HANDLE mod
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_99_170: [Schema_GetModelModelByName shall return a handle to the model identified by the property with the name propertyName in the model identified by the handle modelTypeHandle.]*/
         /*Codes_SRS_SCHEMA_99_171: [If Schema_GetModelModelByName is unable to provide the handle it shall return NULL.]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelElement(model, SCHEMA_NAME_MODEL_IN_MODEL, propertyName, strlen(propertyName));
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2381,7 +2695,7 @@ size_t Schema_GetModelModelByName_Offset(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandl
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
         /*Codes_SRS_SCHEMA_02_056: [ If propertyName is not a model then Schema_GetModelModelByName_Offset shall fail and return 0. ]*/
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelElement(model, SCHEMA_NAME_MODEL_IN_MODEL, propertyName, strlen(propertyName));
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2412,7 +2726,7 @@ pfOnDesiredProperty Schema_GetModelModelByName_OnDesiredProperty(SCHEMA_MODEL_TY
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* model = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        void* temp = VECTOR_find_if(model->models, matchModelName, propertyName);
+        void* temp = FindModelElement(model, SCHEMA_NAME_MODEL_IN_MODEL, propertyName, strlen(propertyName));
         if (temp == NULL)
         {
             LogError("specified propertyName not found (%s)", propertyName);
@@ -2538,8 +2852,7 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             /* Codes_SRS_SCHEMA_99_179: [The propertyPath shall be assumed to be in the format model1/model2/.../propertyName.] */
@@ -2551,21 +2864,11 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             }
 
             /* get the child-model */
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            childModel = (MODEL_IN_MODEL*)FindModelElement(modelType, SCHEMA_NAME_MODEL_IN_MODEL, propertyPath, (size_t)(endPos - propertyPath));
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, propertyPath, endPos - propertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - propertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2583,19 +2886,8 @@ bool Schema_ModelPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle,
             {
                 /* no model found, let's see if this is a property */
                 /* Codes_SRS_SCHEMA_99_178: [The argument propertyPath shall be used to find the leaf property.] */
-                for (i = 0; i < modelType->PropertyCount; i++)
-                {
-                    SCHEMA_PROPERTY_HANDLE_DATA* property = (SCHEMA_PROPERTY_HANDLE_DATA*)modelType->Properties[i];
-                    if ((strncmp(property->PropertyName, propertyPath, endPos - propertyPath) == 0) &&
-                        (strlen(property->PropertyName) == (size_t)(endPos - propertyPath)))
-                    {
-                        /* found property */
-                        /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
-                        result = true;
-                        break;
-                    }
-                }
-
+                /* Codes_SRS_SCHEMA_99_177: [Schema_ModelPropertyByPathExists shall return true if a leaf property exists in the model modelTypeHandle.] */
+                result = (FindModelElement(modelType, SCHEMA_NAME_PROPERTY, propertyPath, (size_t)(endPos - propertyPath)) != NULL);
                 break;
             }
         } while (slashPos != NULL);
@@ -2632,8 +2924,7 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(reportedPropertyPath, '/');
@@ -2643,21 +2934,11 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
                 endPos = &reportedPropertyPath[strlen(reportedPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            childModel = (MODEL_IN_MODEL*)FindModelElement(modelType, SCHEMA_NAME_MODEL_IN_MODEL, reportedPropertyPath, (size_t)(endPos - reportedPropertyPath));
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, reportedPropertyPath, endPos - reportedPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - reportedPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2675,7 +2956,7 @@ bool Schema_ModelReportedPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelType
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->reportedProperties, reportedPropertyExists, reportedPropertyPath) != NULL);
+                result = (FindModelElement(modelType, SCHEMA_NAME_REPORTED_PROPERTY, reportedPropertyPath, strlen(reportedPropertyPath)) != NULL);
                 if (!result)
                 {
                     LogError("no such reported property \"%s\"", reportedPropertyPath);
@@ -2773,6 +3054,8 @@ SCHEMA_RESULT Schema_AddModelDesiredProperty(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                             desiredProperty->desiredPropertDeinitialize = desiredPropertyDeinitialize;
                             desiredProperty->onDesiredProperty = onDesiredProperty; /*NULL is a perfectly fine value*/
                             desiredProperty->offset = offset;
+                            /*Codes_SRS_SCHEMA_09_002: [ Adding a property, reported property, desired property, action, method or model in model to a model shall discard the index of the names of that model. ]*/
+                            DestroyNameIndex(&handleData->NameIndex);
                             result = SCHEMA_OK;
                         }
                     }
@@ -2825,7 +3108,7 @@ SCHEMA_DESIRED_PROPERTY_HANDLE Schema_GetModelDesiredPropertyByName(SCHEMA_MODEL
         /*Codes_SRS_SCHEMA_02_036: [ If a desired property having the name desiredPropertyName exists then Schema_GetModelDesiredPropertyByName shall succeed and return a non-NULL value. ]*/
         /*Codes_SRS_SCHEMA_02_037: [ Otherwise, Schema_GetModelDesiredPropertyByName shall fail and return NULL. ]*/
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
-        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, desiredPropertyName);
+        SCHEMA_DESIRED_PROPERTY_HANDLE* temp = (SCHEMA_DESIRED_PROPERTY_HANDLE*)FindModelElement(handleData, SCHEMA_NAME_DESIRED_PROPERTY, desiredPropertyName, strlen(desiredPropertyName));
         if (temp == NULL)
         {
             LogError("no such desired property by name %s", desiredPropertyName);
@@ -2896,8 +3179,7 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
         do
         {
             const char* endPos;
-            size_t i;
-            size_t modelCount;
+            MODEL_IN_MODEL* childModel;
             SCHEMA_MODEL_TYPE_HANDLE_DATA* modelType = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
 
             slashPos = strchr(desiredPropertyPath, '/');
@@ -2907,21 +3189,11 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
                 endPos = &desiredPropertyPath[strlen(desiredPropertyPath)];
             }
 
-            modelCount = VECTOR_size(modelType->models);
-            for (i = 0; i < modelCount; i++)
+            childModel = (MODEL_IN_MODEL*)FindModelElement(modelType, SCHEMA_NAME_MODEL_IN_MODEL, desiredPropertyPath, (size_t)(endPos - desiredPropertyPath));
+            if (childModel != NULL)
             {
-                MODEL_IN_MODEL* childModel = (MODEL_IN_MODEL*)VECTOR_element(modelType->models, i);
-                if ((strncmp(childModel->propertyName, desiredPropertyPath, endPos - desiredPropertyPath) == 0) &&
-                    (strlen(childModel->propertyName) == (size_t)(endPos - desiredPropertyPath)))
-                {
-                    /* found */
-                    modelTypeHandle = childModel->modelHandle;
-                    break;
-                }
-            }
+                modelTypeHandle = childModel->modelHandle;
 
-            if (i < modelCount)
-            {
                 /* model found, check if there is more in the path */
                 if (slashPos == NULL)
                 {
@@ -2939,7 +3211,7 @@ bool Schema_ModelDesiredPropertyByPathExists(SCHEMA_MODEL_TYPE_HANDLE modelTypeH
             else
             {
                 /* no model found, let's see if this is a property */
-                result = (VECTOR_find_if(modelType->desiredProperties, desiredPropertyExists, desiredPropertyPath) != NULL);
+                result = (FindModelElement(modelType, SCHEMA_NAME_DESIRED_PROPERTY, desiredPropertyPath, strlen(desiredPropertyPath)) != NULL);
                 if (!result)
                 {
                     LogError("no such desired property \"%s\"", desiredPropertyPath);
@@ -3021,12 +3293,6 @@ size_t Schema_GetModelDesiredProperty_offset(SCHEMA_DESIRED_PROPERTY_HANDLE desi
     return result;
 }
 
-static bool modelInModelExists(const void* element, const void* value)
-{
-    MODEL_IN_MODEL* modelInModel = (MODEL_IN_MODEL*)element;
-    return (strcmp(modelInModel->propertyName, value) == 0);
-}
-
 SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE modelTypeHandle, const char* elementName)
 {
     SCHEMA_MODEL_ELEMENT result;
@@ -3043,88 +3309,47 @@ SCHEMA_MODEL_ELEMENT Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE model
     else
     {
         SCHEMA_MODEL_TYPE_HANDLE_DATA* handleData = (SCHEMA_MODEL_TYPE_HANDLE_DATA*)modelTypeHandle;
+        size_t elementNameLength = strlen(elementName);
+        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle;
+        SCHEMA_PROPERTY_HANDLE propertyHandle;
+        SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle;
+        SCHEMA_ACTION_HANDLE actionHandle;
+        MODEL_IN_MODEL* modelInModel;
 
-        SCHEMA_DESIRED_PROPERTY_HANDLE* desiredPropertyHandle = VECTOR_find_if(handleData->desiredProperties, desiredPropertyExists, elementName);
-        if (desiredPropertyHandle != NULL)
+        if ((desiredPropertyHandle = (SCHEMA_DESIRED_PROPERTY_HANDLE*)FindModelElement(handleData, SCHEMA_NAME_DESIRED_PROPERTY, elementName, elementNameLength)) != NULL)
         {
             /*Codes_SRS_SCHEMA_02_080: [ If elementName is a desired property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_DESIRED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.desiredPropertyHandle to the handle of the desired property. ]*/
             result.elementType = SCHEMA_DESIRED_PROPERTY;
             result.elementHandle.desiredPropertyHandle = *desiredPropertyHandle;
         }
+        else if ((propertyHandle = (SCHEMA_PROPERTY_HANDLE)FindModelElement(handleData, SCHEMA_NAME_PROPERTY, elementName, elementNameLength)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
+            result.elementType = SCHEMA_PROPERTY;
+            result.elementHandle.propertyHandle = propertyHandle;
+        }
+        else if ((reportedPropertyHandle = (SCHEMA_REPORTED_PROPERTY_HANDLE*)FindModelElement(handleData, SCHEMA_NAME_REPORTED_PROPERTY, elementName, elementNameLength)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
+            result.elementType = SCHEMA_REPORTED_PROPERTY;
+            result.elementHandle.reportedPropertyHandle = *reportedPropertyHandle;
+        }
+        else if ((actionHandle = (SCHEMA_ACTION_HANDLE)FindModelElement(handleData, SCHEMA_NAME_ACTION, elementName, elementNameLength)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
+            result.elementType = SCHEMA_MODEL_ACTION;
+            result.elementHandle.actionHandle = actionHandle;
+        }
+        else if ((modelInModel = (MODEL_IN_MODEL*)FindModelElement(handleData, SCHEMA_NAME_MODEL_IN_MODEL, elementName, elementNameLength)) != NULL)
+        {
+            /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
+            result.elementType = SCHEMA_MODEL_IN_MODEL;
+            result.elementHandle.modelHandle = modelInModel->modelHandle;
+        }
         else
         {
-            size_t nProcessedProperties = 0;
-            SCHEMA_PROPERTY_HANDLE_DATA* property = NULL;
-            for (size_t i = 0; i < handleData->PropertyCount;i++)
-            {
-                property = (SCHEMA_PROPERTY_HANDLE_DATA*)(handleData->Properties[i]);
-                if (strcmp(property->PropertyName, elementName) == 0)
-                {
-                    i = handleData->PropertyCount; /*found it*/
-                }
-                else
-                {
-                    nProcessedProperties++;
-                }
-            }
-
-            if (nProcessedProperties < handleData->PropertyCount)
-            {
-                /*Codes_SRS_SCHEMA_02_078: [ If elementName is a property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.propertyHandle to the handle of the property. ]*/
-                result.elementType = SCHEMA_PROPERTY;
-                result.elementHandle.propertyHandle = property;
-            }
-            else
-            {
-
-                SCHEMA_REPORTED_PROPERTY_HANDLE* reportedPropertyHandle = VECTOR_find_if(handleData->reportedProperties, reportedPropertyExists, elementName);
-                if (reportedPropertyHandle != NULL)
-                {
-                    /*Codes_SRS_SCHEMA_02_079: [ If elementName is a reported property then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_REPORTED_PROPERTY and SCHEMA_MODEL_ELEMENT.elementHandle.reportedPropertyHandle to the handle of the reported property. ]*/
-                    result.elementType = SCHEMA_REPORTED_PROPERTY;
-                    result.elementHandle.reportedPropertyHandle = *reportedPropertyHandle;
-                }
-                else
-                {
-
-                    size_t nProcessedActions = 0;
-                    SCHEMA_ACTION_HANDLE_DATA* actionHandleData = NULL;
-                    for (size_t i = 0;i < handleData->ActionCount; i++)
-                    {
-                        actionHandleData = (SCHEMA_ACTION_HANDLE_DATA*)(handleData->Actions[i]);
-                        if (strcmp(actionHandleData->ActionName, elementName) == 0)
-                        {
-                            i = handleData->ActionCount; /*get out quickly*/
-                        }
-                        else
-                        {
-                            nProcessedActions++;
-                        }
-                    }
-
-                    if (nProcessedActions < handleData->ActionCount)
-                    {
-                        /*Codes_SRS_SCHEMA_02_081: [ If elementName is a model action then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_ACTION and SCHEMA_MODEL_ELEMENT.elementHandle.actionHandle to the handle of the action. ]*/
-                        result.elementType = SCHEMA_MODEL_ACTION;
-                        result.elementHandle.actionHandle = actionHandleData;
-                    }
-                    else
-                    {
-                        MODEL_IN_MODEL* modelInModel = VECTOR_find_if(handleData->models, modelInModelExists, elementName);
-                        if (modelInModel != NULL)
-                        {
-                            /*Codes_SRS_SCHEMA_02_082: [ If elementName is a model in model then Schema_GetModelElementByName shall succeed and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_MODEL_IN_MODEL and SCHEMA_MODEL_ELEMENT.elementHandle.modelHandle to the handle of the model. ]*/
-                            result.elementType = SCHEMA_MODEL_IN_MODEL;
-                            result.elementHandle.modelHandle = modelInModel->modelHandle;
-                        }
-                        else
-                        {
-                            /*Codes_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
-                            result.elementType = SCHEMA_NOT_FOUND;
-                        }
-                    }
-                }
-            }
+            /*Codes_SRS_SCHEMA_02_083: [ Otherwise Schema_GetModelElementByName shall fail and set SCHEMA_MODEL_ELEMENT.elementType to SCHEMA_NOT_FOUND. ]*/
+            result.elementType = SCHEMA_NOT_FOUND;
         }
     }
     return result;
@@ -4405,6 +4405,188 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(double, TEST_DOUBLE_2, atof(STRING_c_str(global_bufferTemp)));
         }
 
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_002: [ EDM_DOUBLE values that are not NaN or infinite shall be written with the shortest sequence of decimal digits that parses back to the same double. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_writes_the_shortest_digits)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, 0.1);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "0.1", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_002: [ EDM_DOUBLE values that are not NaN or infinite shall be written with the shortest sequence of decimal digits that parses back to the same double. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_round_trips)
+        {
+            const double values[] = { TEST_DOUBLE_2, 1.0 / 3.0, -2.5e-300, 4.9406564584124654e-324, 2.2250738585072014e-308, 9007199254740993.0, 123456789.012345678 };
+            size_t i;
+
+            for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                ///arrange
+                AGENT_DATA_TYPE ag;
+                (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, values[i]);
+                (void)BASEIMPLEMENTATION::STRING_empty(global_bufferTemp);
+
+                ///act
+                auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(double, values[i], strtod(STRING_c_str(global_bufferTemp), NULL));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_004: [ Values whose magnitude is at least 1e-6 and less than 1e21 shall be written in plain decimal notation with at least one digit after the decimal point. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_integral_value_keeps_the_decimal_point)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, 100.0);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "100.0", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_004: [ Values whose magnitude is at least 1e-6 and less than 1e21 shall be written in plain decimal notation with at least one digit after the decimal point. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_small_value_uses_plain_notation)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, -0.000001234);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "-0.000001234", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_005: [ All other values shall be written as their significant digits, with a decimal point after the first digit when there is more than one, followed by "e" and the decimal exponent without a "+" sign or leading zeroes. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_large_value_uses_exponent)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, DBL_MAX);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "1.7976931348623157e308", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_005: [ All other values shall be written as their significant digits, with a decimal point after the first digit when there is more than one, followed by "e" and the decimal exponent without a "+" sign or leading zeroes. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_tiny_value_uses_negative_exponent)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, 1e-7);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "1e-7", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_006: [ Zero shall be written as 0.0 and negative zero as -0.0. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_zero_succeeds)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, 0.0);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "0.0", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_006: [ Zero shall be written as 0.0 and negative zero as -0.0. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_negative_zero_succeeds)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_DOUBLE(&ag, -0.0);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "-0.0", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_001: [ Numeric values shall be formatted into a buffer on the stack and appended to destination with a single call to STRING_concat, without allocating memory. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_calls_STRING_concat_once)
+        {
+            ///arrange
+            mocks->ResetAllCalls();
+
+            EXPECTED_CALL((*mocks), STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .ExpectedTimesExactly(1);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &agDouble2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            mocks->AssertActualAndExpectedCalls();
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_DOUBLE_insuficient_buffer_fails)
+        {
+            ///arrange
+            EXPECTED_CALL((*mocks), STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .SetReturn(1);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &agDouble2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
+        }
+
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_047:[ Creates an AGENT_DATA_TYPE containing an EDM_SINGLE from float]*/
         TEST_FUNCTION(Create_AGENT_DATA_TYPE_from_FLOAT_succeeds_1)
         {
@@ -4639,6 +4821,99 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             ASSERT_ARE_EQUAL(float, TEST_FLOAT_2, (float)atof(STRING_c_str(global_bufferTemp)));
 
         }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_003: [ EDM_SINGLE values that are not NaN or infinite shall be written with the shortest sequence of decimal digits that parses back to the same float. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_writes_the_shortest_digits)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, 0.1f);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "0.1", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_003: [ EDM_SINGLE values that are not NaN or infinite shall be written with the shortest sequence of decimal digits that parses back to the same float. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_round_trips)
+        {
+            const float values[] = { TEST_FLOAT_2, 1.0f / 3.0f, -1.17549435e-38f, 1.40129846e-45f, 16777217.0f, 3.14159265f };
+            size_t i;
+
+            for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+            {
+                ///arrange
+                AGENT_DATA_TYPE ag;
+                (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, values[i]);
+                (void)BASEIMPLEMENTATION::STRING_empty(global_bufferTemp);
+
+                ///act
+                auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+                ///assert
+                ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+                ASSERT_ARE_EQUAL(float, values[i], strtof(STRING_c_str(global_bufferTemp), NULL));
+
+                ///cleanup
+                Destroy_AGENT_DATA_TYPE(&ag);
+            }
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_005: [ All other values shall be written as their significant digits, with a decimal point after the first digit when there is more than one, followed by "e" and the decimal exponent without a "+" sign or leading zeroes. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_large_value_uses_exponent)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, FLT_MAX);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "3.4028235e38", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_006: [ Zero shall be written as 0.0 and negative zero as -0.0. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_negative_zero_succeeds)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_FLOAT(&ag, -0.0f);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "-0.0", STRING_c_str(global_bufferTemp));
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_FLOAT_insuficient_buffer_fails)
+        {
+            ///arrange
+            EXPECTED_CALL((*mocks), STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .SetReturn(1);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &agSingle2);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
+        }
 #endif
 
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_043:[ Creates an AGENT_DATA_TYPE containing an EDM_INT16 from int16_t]*/
@@ -5065,6 +5340,49 @@ BEGIN_TEST_SUITE(AgentTypeSystem_ut)
             Destroy_AGENT_DATA_TYPE(&ag);
         }
 
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_09_001: [ Numeric values shall be formatted into a buffer on the stack and appended to destination with a single call to STRING_concat, without allocating memory. ]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_SINT32_calls_STRING_concat_once)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_SINT32(&ag, -2147483647 - 1);
+            mocks->ResetAllCalls();
+
+            EXPECTED_CALL((*mocks), STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .ExpectedTimesExactly(1);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_OK, res);
+            ASSERT_ARE_EQUAL(char_ptr, "-2147483648", BASEIMPLEMENTATION::STRING_c_str(global_bufferTemp));
+            mocks->AssertActualAndExpectedCalls();
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
+        /*Tests_SRS_AGENT_TYPE_SYSTEM_99_016:[ When the value cannot be converted to a string AgentDataTypes_ToString shall return AGENT_DATA_TYPES_ERROR.]*/
+        TEST_FUNCTION(AgentDataTypes_ToString_SINT32_insuficient_buffer_fails)
+        {
+            ///arrange
+            AGENT_DATA_TYPE ag;
+            (void)Create_AGENT_DATA_TYPE_from_SINT32(&ag, 42);
+
+            EXPECTED_CALL((*mocks), STRING_concat(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .SetReturn(1);
+
+            ///act
+            auto res = AgentDataTypes_ToString(global_bufferTemp, &ag);
+
+            ///assert
+            ASSERT_ARE_EQUAL(AGENT_DATA_TYPES_RESULT, AGENT_DATA_TYPES_ERROR, res);
+
+            ///cleanup
+            Destroy_AGENT_DATA_TYPE(&ag);
+        }
+
         /*Tests_SRS_AGENT_TYPE_SYSTEM_99_045:[ Creates an AGENT_DATA_TYPE containing an EDM_INT64 from int64_t]*/
         TEST_FUNCTION(Create_AGENT_DATA_TYPE_from_SINT64_succeeds_1)
         {
@@ -339,6 +339,11 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
         REGISTER_GLOBAL_MOCK_HOOK(JSONDecoder_JSON_To_MultiTree, my_JSONDecoder_JSON_To_MultiTree);
         REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_JSON_To_MultiTree, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_Reader_Init, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_Reader_BeginObject, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_Reader_NextMember, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_Reader_GetValue, JSON_DECODER_ERROR);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONDecoder_Reader_SkipValue, JSON_DECODER_ERROR);
         REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
         
         REGISTER_GLOBAL_MOCK_HOOK(Create_AGENT_DATA_TYPE_from_Members, my_Create_AGENT_DATA_TYPE_from_Members);
@@ -2991,59 +2996,48 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertyHasCallback)
+    void CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, bool desiredPropertyHasCallback)
     {
+        const char* int_field = "int_field";
+        const char* endOfObject = NULL;
+
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
             .IgnoreArgument_destination();
 
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
-
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json();
 
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG)) /*2*/
+            .IgnoreArgument_reader();
 
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("int_field");
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&int_field, sizeof(int_field));
 
         STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
             .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*5*/
             .SetReturn("int");
 
         STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
             .SetReturn(TEST_SCHEMA);
 
-        /*this is DecodeValueFromNode expected calls*/
+        /*this is DecodeValueFromReader expected calls*/
 
         STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
             .SetReturn(EDM_INT32_TYPE);
 
-        STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_destination(&three, sizeof(three));
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*8*/
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_value(&three, sizeof(three));
 
-        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-            .IgnoreArgument_source()
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(three, EDM_INT32_TYPE, IGNORED_PTR_ARG))
             .IgnoreArgument_agentData()
             .SetReturn(AGENT_DATA_TYPES_OK);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*10*/
             .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
 
         STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
@@ -3052,7 +3046,7 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 2))
             .IgnoreArgument_source();
 
-        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG))
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG)) /*13*/
             .IgnoreArgument_desiredPropertyHandle()
             .SetReturn(desiredPropertyHasCallback ? onDesiredPropertySimpleProperty : NULL);
 
@@ -3065,10 +3059,9 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
             .IgnoreArgument_agentData();
 
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*15*/
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
 
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument_ptr();
@@ -3076,10 +3069,10 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
 
     /*case1: a simple property (non-recursive) is ingested*/
     /*the property is called "int_field" and shall have the value 3*/
-    /*Tests_SRS_COMMAND_DECODER_02_005: [ CommandDecoder_IngestDesiredProperties shall create a MULTITREE_HANDLE ouf of the clone of desiredProperties. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_007: [ If the child name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the MULTITREE node. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_001: [ CommandDecoder_IngestDesiredProperties shall read the clone of jsonPayload in place with a JSON_DECODER_READER, without building a MULTITREE_HANDLE. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_006: [ If the member name corresponds to a desired property then an AGENT_DATA_TYPE shall be constructed from the member value, read in place. ]*/
     /*Tests_SRS_COMMAND_DECODER_02_008: [ The desired property shall be constructed in memory by calling pfDesiredPropertyFromAGENT_DATA_TYPE. ]*/
-    /*Tests_SRS_COMMAND_DECODER_02_010: [ If the complete MULTITREE has been parsed then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_008: [ If all the members of the JSON object have been ingested then CommandDecoder_IngestDesiredProperties shall succeed and return EXECUTE_COMMAND_SUCCESS. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_happy_path)
     {
         ///arrange
@@ -3088,10 +3081,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
         const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3113,32 +3104,23 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
         const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-        
-            3,/*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-
-            9, /*Schema_GetModelDesiredPropertyType*/
-            10, /*Schema_GetSchemaForModelType*/
-            11, /*CodeFirst_GetPrimitiveType*/
-            14, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            15, /*Schema_GetModelDesiredProperty_offset*/
-            17, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            18, /*Destroy_AGENT_DATA_TYPE*/
-            19, /*STRING_delete*/
-            20, /*MultiTree_Destroy*/
-            21 /*gballoc_free*/
+            5, /*Schema_GetModelDesiredPropertyType*/
+            6, /*Schema_GetSchemaForModelType*/
+            7, /*CodeFirst_GetPrimitiveType*/
+            10, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            11, /*Schema_GetModelDesiredProperty_offset*/
+            13, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            14, /*Destroy_AGENT_DATA_TYPE*/
+            16 /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3173,93 +3155,74 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
     }
 
-    void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, size_t one, MULTITREE_HANDLE childHandle, bool desiredPropertiesHaveCallbacks)
+    void CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(unsigned char* deviceMemoryArea, const char* desiredPropertiesJSON, const char* three, bool desiredPropertiesHaveCallbacks)
     {
+        const char* modelInModel = "modelInModel";
+        const char* int_field = "int_field";
+        const char* endOfObject = NULL;
+
         STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
             .IgnoreArgument_destination();
 
-        STRICT_EXPECTED_CALL(JSONDecoder_JSON_To_MultiTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_json()
-            .IgnoreArgument_multiTreeHandle();
-
-        STRICT_EXPECTED_CALL(MultiTree_DeleteChild(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_childName();
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*2*/
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_count(&one, sizeof(one));
-
-        STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-        STRICT_EXPECTED_CALL(STRING_new())
-            .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json();
 
-        STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "modelInModel"*/
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG)) /*2*/
+            .IgnoreArgument_reader();
 
-        STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*6*/
-            .SetReturn("modelInModel");
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&modelInModel, sizeof(modelInModel));
 
         STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
             .SetReturn(Schema_GetModelElementByName_modelInModel);
 
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*9*/
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel")) /*5*/
             .SetReturn(10);
 
         /*here recursion happens*/
 
         {
-            STRICT_EXPECTED_CALL(MultiTree_GetChildCount(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*10*/
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_count(&one, sizeof(one));
+            STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG)) /*6*/
+                .IgnoreArgument_reader();
 
-            STRICT_EXPECTED_CALL(MultiTree_GetChild(IGNORED_PTR_ARG, 0, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_childHandle(&childHandle, sizeof(childHandle));
-
-            STRICT_EXPECTED_CALL(STRING_new())
-                .SetReturn(TEST_STRING_HANDLE_CHILD_NAME);
-
-            STRICT_EXPECTED_CALL(MultiTree_GetName(childHandle, TEST_STRING_HANDLE_CHILD_NAME)); /*13*/ /*this fills in TEST_STRING_HANDLE_CHILD_NAME with "int_field"*/
-
-            STRICT_EXPECTED_CALL(STRING_c_str(TEST_STRING_HANDLE_CHILD_NAME)) /*14*/
-                .SetReturn("int_field");
+            STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument_reader()
+                .CopyOutArgumentBuffer_name(&int_field, sizeof(int_field));
 
-            STRICT_EXPECTED_CALL(Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, "int_field"))
+            STRICT_EXPECTED_CALL(Schema_GetModelElementByName(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL, "int_field")) /*8*/
                 .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*17*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*9*/
                 .SetReturn("int");
 
-            STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL)) /*18*/
+            STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(SCHEMA_MODEL_TYPE_HANDLE_MODEL_IN_MODEL)) /*10*/
                 .SetReturn(TEST_SCHEMA);
 
-            /*this is DecodeValueFromNodea expected calls*/
+            /*this is DecodeValueFromReader expected calls*/
 
-            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int")) /*19*/
+            STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int")) /*11*/
                 .SetReturn(EDM_INT32_TYPE);
 
-            STRICT_EXPECTED_CALL(MultiTree_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-                .IgnoreArgument_treeHandle()
-                .CopyOutArgumentBuffer_destination(&three, sizeof(three));
+            STRICT_EXPECTED_CALL(JSONDecoder_Reader_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreArgument_reader()
+                .CopyOutArgumentBuffer_value(&three, sizeof(three));
 
-            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(IGNORED_PTR_ARG, EDM_INT32_TYPE, IGNORED_PTR_ARG))
-                .IgnoreArgument_source()
+            STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(three, EDM_INT32_TYPE, IGNORED_PTR_ARG))
                 .IgnoreArgument_agentData()
                 .SetReturn(AGENT_DATA_TYPES_OK);
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*22*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*14*/
                 .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*23*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD)) /*15*/
                 .SetReturn(2);
 
             STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 12))  /*notice here the new offset (2+10)*/
                 .IgnoreArgument_source();
 
-            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG)) /*24*/
+            STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(IGNORED_PTR_ARG)) /*17*/
                 .IgnoreArgument_desiredPropertyHandle()
                 .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertySimpleProperty : NULL);
 
@@ -3269,14 +3232,15 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
                     .IgnoreArgument_v();
             }
 
-
             STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
                 .IgnoreArgument_agentData();
 
-            STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
+            STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*19*/
+                .IgnoreArgument_reader()
+                .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
         }
 
-        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(IGNORED_PTR_ARG, "modelInModel")) /*27*/
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(IGNORED_PTR_ARG, "modelInModel")) /*20*/
             .IgnoreArgument_modelTypeHandle()
             .SetReturn(desiredPropertiesHaveCallbacks ? onDesiredPropertyModelInModel : NULL);
 
@@ -3286,16 +3250,16 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
                 .IgnoreArgument_v();
         }
 
-        STRICT_EXPECTED_CALL(STRING_delete(TEST_STRING_HANDLE_CHILD_NAME));
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG)) /*21*/
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
 
         STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
             .IgnoreArgument_ptr();
     }
 
     /*Tests_SRS_COMMAND_DECODER_02_009: [ If the child name corresponds to a model in model then the function shall call itself recursively. ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_005: [ CommandDecoder_IngestDesiredProperties shall walk the members of the JSON object in document order together with the model, recursively. ]*/
     TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_happy_path)
     {
         ///arrange
@@ -3304,10 +3268,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
         const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, false);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3329,36 +3291,25 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
         const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
         (void)umock_c_negative_tests_init();
         umock_c_reset_all_calls();
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, false);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, false);
 
         umock_c_negative_tests_snapshot();
 
         size_t calls_that_cannot_fail[] =
         {
-            2, /*MultiTree_DeleteChild*/
-            3, /*MultiTree_GetChildCount*/
-            7, /*STRING_c_str*/
-            9, /*Schema_GetModelModelByName_Offset*/
-            10, /*MultiTree_GetChildCount*/
-            13, /*MultiTree_GetName*/
-            14, /*STRING_c_str*/
-            16, /*Schema_GetModelDesiredPropertyType*/
-            17, /*Schema_GetSchemaForModelType*/
-            18, /*CodeFirst_GetPrimitiveType*/
-            21, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
-            22, /*Schema_GetModelDesiredProperty_offset*/
-            24, /*Destroy_AGENT_DATA_TYPE*/
-            25, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
-            26, /*STRING_delete*/
-            27, /*STRING_delete*/
-            28, /*Schema_GetModelModelByName_OnDesiredProperty*/
-            29, /*MultiTree_Destroy*/
-            30, /*gballoc_free*/
+            5, /*Schema_GetModelModelByName_Offset*/
+            9, /*Schema_GetModelDesiredPropertyType*/
+            10, /*Schema_GetSchemaForModelType*/
+            11, /*CodeFirst_GetPrimitiveType*/
+            14, /*Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE*/
+            15, /*Schema_GetModelDesiredProperty_offset*/
+            17, /*Schema_GetModelDesiredProperty_pfOnDesiredProperty*/
+            18, /*Destroy_AGENT_DATA_TYPE*/
+            20, /*Schema_GetModelModelByName_OnDesiredProperty*/
+            22, /*gballoc_free*/
         };
 
         for (size_t i = 0; i < umock_c_negative_tests_call_count(); i++)
@@ -3403,10 +3354,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"int_field\":3}";
         const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_desired_property_succeeds_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3430,10 +3379,8 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         unsigned char deviceMemoryArea[100];
         const char* desiredPropertiesJSON = "{\"modelInModel\":{\"int_field\":3}}";
         const char* three = "3";
-        size_t one = 1;
-        MULTITREE_HANDLE childHandle = (MULTITREE_HANDLE)0x11;
 
-        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, one, childHandle, true);
+        CommandDecoder_IngestDesiredProperties_with_1_simple_model_in_model_desired_property_inert_path(deviceMemoryArea, desiredPropertiesJSON, three, true);
 
         ///act
         EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
@@ -3446,6 +3393,351 @@ BEGIN_TEST_SUITE(CommandDecoder_ut)
         CommandDecoder_Destroy(commandDecoderHandle);
 
     }
+
+    /*Tests_SRS_COMMAND_DECODER_09_009: [ If the value of a model in model is not a JSON object (a TWIN patch deletes a property with null) then the value shall be skipped and the model in model shall be ingested as having no members. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_012: [ If the child model in model has a non-NULL pfOnDesiredProperty then pfOnDesiredProperty shall be called. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_null_model_in_model_calls_onDesiredProperty_succeeds)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"modelInModel\":null,\"$version\":5}";
+        const char* modelInModel = "modelInModel";
+        const char* version = "$version";
+        const char* endOfObject = NULL;
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&modelInModel, sizeof(modelInModel));
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(Schema_GetModelElementByName_modelInModel);
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_Offset(TEST_MODEL_HANDLE, "modelInModel"))
+            .SetReturn(10);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG)) /*null is not an object*/
+            .IgnoreArgument_reader()
+            .SetReturn(JSON_DECODER_PARSE_ERROR);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_SkipValue(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(Schema_GetModelModelByName_OnDesiredProperty(IGNORED_PTR_ARG, "modelInModel"))
+            .IgnoreArgument_modelTypeHandle()
+            .SetReturn(onDesiredPropertyModelInModel);
+        STRICT_EXPECTED_CALL(onDesiredPropertyModelInModel(IGNORED_PTR_ARG))
+            .IgnoreArgument_v();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&version, sizeof(version));
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_SkipValue(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_002: [ If the clone of jsonPayload is not well formed JSON then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR before any desired property is constructed. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_malformed_JSON_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"int_field\":3,\"other\":}";
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json()
+            .SetReturn(JSON_DECODER_PARSE_ERROR);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_02_014: [ If removedDesiredNode is TRUE, parse only the `desired` part of JSON tree ]*/
+    /*Tests_SRS_COMMAND_DECODER_09_003: [ If parseDesiredNode is TRUE then the members of the root object other than desired shall be skipped without being decoded. ]*/
+    /*Tests_SRS_COMMAND_DECODER_02_015: [ Remove '$version' string from node, if it is present.  It not being present is not an error ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_full_twin_skips_all_but_desired_succeeds)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"reported\":{\"int_field\":4,\"$version\":1},\"desired\":{\"$version\":2,\"int_field\":3}}";
+        const char* reported = "reported";
+        const char* desired = "desired";
+        const char* version = "$version";
+        const char* int_field = "int_field";
+        const char* three = "3";
+        const char* endOfObject = NULL;
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&reported, sizeof(reported));
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_SkipValue(IGNORED_PTR_ARG)) /*"reported" is never decoded*/
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&desired, sizeof(desired));
+
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&version, sizeof(version));
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_SkipValue(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&int_field, sizeof(int_field));
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "int_field"))
+            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn("int");
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
+            .SetReturn(TEST_SCHEMA);
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("int"))
+            .SetReturn(EDM_INT32_TYPE);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_value(&three, sizeof(three));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(three, EDM_INT32_TYPE, IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 2))
+            .IgnoreArgument_source();
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD));
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_004: [ If parseDesiredNode is TRUE and the root object has no member called desired then CommandDecoder_IngestDesiredProperties shall fail and return EXECUTE_COMMAND_ERROR. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_full_twin_without_desired_fails)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"reported\":{\"int_field\":4}}";
+        const char* reported = "reported";
+        const char* endOfObject = NULL;
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&reported, sizeof(reported));
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_SkipValue(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, true);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_ERROR, result);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
+
+    /*Tests_SRS_COMMAND_DECODER_09_007: [ If the type of the desired property is a struct then every member of the struct shall be decoded from the member of the JSON object with the same name; the members of the JSON object that are not members of the struct shall be skipped. ]*/
+    TEST_FUNCTION(CommandDecoder_IngestDesiredProperties_with_struct_desired_property_succeeds)
+    {
+        ///arrange
+        COMMAND_DECODER_HANDLE commandDecoderHandle = CommandDecoder_Create(TEST_MODEL_HANDLE, ActionCallbackMock, TEST_CALLBACK_CONTEXT_VALUE, methodCallbackMock, TEST_CALLBACK_CONTEXT_VALUE);
+        umock_c_reset_all_calls();
+        unsigned char deviceMemoryArea[100];
+        const char* desiredPropertiesJSON = "{\"location\":{\"extra\":[1,2],\"Long\":1.2,\"Lat\":42.42}}";
+        const char* location = "location";
+        const char* extra = "extra";
+        const char* longName = "Long";
+        const char* latName = "Lat";
+        const char* longValue = "1.2";
+        const char* latValue = "42.42";
+        const char* endOfObject = NULL;
+        size_t memberCount = 2;
+        AGENT_DATA_TYPE doubleAgentDataType;
+        doubleAgentDataType.type = EDM_DOUBLE_TYPE;
+        doubleAgentDataType.value.edmDouble.value = 0;
+
+        STRICT_EXPECTED_CALL(mallocAndStrcpy_s(IGNORED_PTR_ARG, desiredPropertiesJSON))
+            .IgnoreArgument_destination();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_Init(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .IgnoreArgument_json();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&location, sizeof(location));
+        STRICT_EXPECTED_CALL(Schema_GetModelElementByName(TEST_MODEL_HANDLE, "location"))
+            .SetReturn(Schema_GetModelElementByName_desiredProperty_int_field);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredPropertyType(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn("GeoLocation");
+        STRICT_EXPECTED_CALL(Schema_GetSchemaForModelType(TEST_MODEL_HANDLE))
+            .SetReturn(TEST_SCHEMA);
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("GeoLocation"))
+            .SetReturn(EDM_NO_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypeByName(TEST_SCHEMA, "GeoLocation"))
+            .SetReturn(TEST_STRUCT_1_HANDLE);
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyCount(TEST_STRUCT_1_HANDLE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_propertyCount(&memberCount, sizeof(memberCount));
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is allocating the member values of the struct*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG)) /*this is allocating the member names of the struct*/
+            .IgnoreArgument_size();
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 0))
+            .SetReturn(memberProperty1);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(memberProperty1))
+            .SetReturn("Lat");
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 1))
+            .SetReturn(memberProperty2);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyName(memberProperty2))
+            .SetReturn("Long");
+
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_BeginObject(IGNORED_PTR_ARG))
+            .IgnoreArgument_reader();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&extra, sizeof(extra));
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_SkipValue(IGNORED_PTR_ARG)) /*"extra" is not a member of GeoLocation*/
+            .IgnoreArgument_reader();
+
+        /*the members are decoded in the order of the JSON*/
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&longName, sizeof(longName));
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 1))
+            .SetReturn(memberProperty2);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberProperty2))
+            .SetReturn("double");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("double"))
+            .SetReturn(EDM_DOUBLE_TYPE);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_value(&longValue, sizeof(longValue));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(longValue, EDM_DOUBLE_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&doubleAgentDataType, sizeof(doubleAgentDataType));
+
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&latName, sizeof(latName));
+        STRICT_EXPECTED_CALL(Schema_GetStructTypePropertyByIndex(TEST_STRUCT_1_HANDLE, 0))
+            .SetReturn(memberProperty1);
+        STRICT_EXPECTED_CALL(Schema_GetPropertyType(memberProperty1))
+            .SetReturn("double");
+        STRICT_EXPECTED_CALL(CodeFirst_GetPrimitiveType("double"))
+            .SetReturn(EDM_DOUBLE_TYPE);
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_GetValue(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_value(&latValue, sizeof(latValue));
+        STRICT_EXPECTED_CALL(CreateAgentDataType_From_String(latValue, EDM_DOUBLE_TYPE, IGNORED_PTR_ARG))
+            .CopyOutArgumentBuffer_agentData(&doubleAgentDataType, sizeof(doubleAgentDataType));
+
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
+
+        EXPECTED_CALL(Create_AGENT_DATA_TYPE_from_Members(IGNORED_PTR_ARG, "GeoLocation", 2, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .ValidateArgument(2).ValidateArgument(3);
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfDesiredPropertyFromAGENT_DATA_TYPE(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(int_pfDesiredPropertyFromAGENT_DATA_TYPE);
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_offset(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD))
+            .SetReturn(2);
+        STRICT_EXPECTED_CALL(int_pfDesiredPropertyFromAGENT_DATA_TYPE(IGNORED_PTR_ARG, (unsigned char*)deviceMemoryArea + 2))
+            .IgnoreArgument_source();
+        STRICT_EXPECTED_CALL(Schema_GetModelDesiredProperty_pfOnDesiredProperty(TEST_DESIRED_PROPERTY_HANDLE_INT_FIELD));
+        STRICT_EXPECTED_CALL(Destroy_AGENT_DATA_TYPE(IGNORED_PTR_ARG))
+            .IgnoreArgument_agentData();
+        STRICT_EXPECTED_CALL(JSONDecoder_Reader_NextMember(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+            .IgnoreArgument_reader()
+            .CopyOutArgumentBuffer_name(&endOfObject, sizeof(endOfObject));
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG))
+            .IgnoreArgument_ptr();
+
+        ///act
+        EXECUTE_COMMAND_RESULT result = CommandDecoder_IngestDesiredProperties(deviceMemoryArea, commandDecoderHandle, desiredPropertiesJSON, false);
+
+        ///assert
+        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(EXECUTE_COMMAND_RESULT, EXECUTE_COMMAND_SUCCESS, result);
+        ASSERT_ARE_EQUAL(char_ptr, "Lat", lastMemberNames[0][0]);
+        ASSERT_ARE_EQUAL(char_ptr, "Long", lastMemberNames[0][1]);
+
+        ///clean
+        CommandDecoder_Destroy(commandDecoderHandle);
+    }
     
     /*Tests_SRS_COMMAND_DECODER_02_014: [ If handle is NULL then CommandDecoder_ExecuteMethod shall fail and return NULL. ]*/
     TEST_FUNCTION(CommandDecoder_ExecuteMethod_with_NULL_handle_fails)
@@ -111,16 +111,22 @@ IMPLEMENT_UMOCK_C_ENUM_TYPE(JSON_ENCODER_RESULT, JSON_ENCODER_RESULT_VALUES);
 
 #define DEFAULT_PROPERTY_NAME_2 "blahBlah"
 
-static MULTITREE_HANDLE my_MultiTree_Create(MULTITREE_CLONE_FUNCTION cloneFunction, MULTITREE_FREE_FUNCTION freeFunction)
-{
-    (void)cloneFunction;
-    (void)freeFunction;
-    return (MULTITREE_HANDLE)my_gballoc_malloc(1);
-}
+#define TEST_JSON_PAYLOAD "Test"
+
+static JSON_ENCODER_PROPERTY encodedProperties[2];
 
-static void my_MultiTree_Destroy(MULTITREE_HANDLE treeHandle)
+static JSON_ENCODER_RESULT my_JSONEncoder_EncodeProperties(const JSON_ENCODER_PROPERTY* properties, size_t propertyCount, JSON_ENCODER_TOSTRING_FUNC toStringFunc, unsigned char** destination, size_t* destinationSize)
 {
-    my_gballoc_free(treeHandle);
+    size_t i;
+    (void)toStringFunc;
+    for (i = 0; (i < propertyCount) && (i < COUNT_OF(encodedProperties)); i++)
+    {
+        encodedProperties[i] = properties[i];
+    }
+    *destinationSize = strlen(TEST_JSON_PAYLOAD);
+    *destination = (unsigned char*)my_gballoc_malloc(*destinationSize);
+    (void)memcpy(*destination, TEST_JSON_PAYLOAD, *destinationSize);
+    return JSON_ENCODER_OK;
 }
 
 static STRING_HANDLE my_STRING_new(void)
@@ -179,13 +185,16 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_TOSTRING_FUNC, void*);
         REGISTER_UMOCK_ALIAS_TYPE(VECTOR_HANDLE, void*);
         REGISTER_UMOCK_ALIAS_TYPE(const VECTOR_HANDLE, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(const JSON_ENCODER_PROPERTY*, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(unsigned char**, void*);
+        REGISTER_UMOCK_ALIAS_TYPE(size_t*, void*);
         
         REGISTER_UMOCK_ALIAS_TYPE(MULTITREE_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(DATA_MARSHALLER_RESULT, int);
         REGISTER_UMOCK_ALIAS_TYPE(JSON_ENCODER_RESULT, int);
             
-        REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Create, my_MultiTree_Create);
-        REGISTER_GLOBAL_MOCK_HOOK(MultiTree_Destroy, my_MultiTree_Destroy);
+        REGISTER_GLOBAL_MOCK_HOOK(JSONEncoder_EncodeProperties, my_JSONEncoder_EncodeProperties);
+        REGISTER_GLOBAL_MOCK_FAIL_RETURN(JSONEncoder_EncodeProperties, JSON_ENCODER_ERROR);
 
         REGISTER_GLOBAL_MOCK_HOOK(STRING_new, real_STRING_new);
         REGISTER_GLOBAL_MOCK_HOOK(STRING_c_str, real_STRING_c_str);
@@ -532,8 +541,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_Create_Fails_Then_Fails)
+    /*Tests_SRS_DATA_MARSHALLER_99_015:[ DATA_MARSHALLER_ERROR shall be returned in all the other error cases not explicitly defined here.]*/
+    TEST_FUNCTION(DataMarshaller_SendData_when_allocating_the_properties_fails_then_fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
@@ -543,133 +552,78 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
 
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .SetReturn((MULTITREE_HANDLE)NULL);
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(JSON_ENCODER_PROPERTY)))
+            .SetReturn(NULL);
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
 
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_AddLeaf_With_Property_Value_Fails_Then_Fails)
+    /* Tests_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
+    TEST_FUNCTION(DataMarshaller_SendData_When_Encoding_The_Values_To_JSON_Fails_Then_Fails)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
+        umock_c_reset_all_calls();
         unsigned char* destination;
         size_t destinationSize;
-        umock_c_reset_all_calls();
-
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
 
-        STRICT_EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_cloneFunction()
-            .IgnoreArgument_freeFunction();
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 1, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
+            .IgnoreArgument_toStringFunc()
+            .SetReturn(JSON_ENCODER_ERROR);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
 
         ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
-        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-        ///cleanup
-        DataMarshaller_Destroy(handle);
-    }
-
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_MultiTree_AddLeaf_With_The_Second_Property_Value_Fails_Then_Fails)
-    {
-        ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
-        unsigned char* destination;
-        size_t destinationSize;
-        umock_c_reset_all_calls();
-        AGENT_DATA_TYPE floatValid2;
-
-        DATA_MARSHALLER_VALUE values[2];
-        values[0].PropertyPath = DEFAULT_PROPERTY_NAME;
-        values[0].Value = &floatValid;
-
-        values[1].PropertyPath = DEFAULT_PROPERTY_NAME_2;
-        values[1].Value = &floatValid2;
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid2))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, sizeof(values) / sizeof(values[0]), values, &destination, &destinationSize);
-
-        ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_JSON_ENCODER_ERROR, result);
 
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_027:[ DATA_MARSHALLER_JSON_ENCODER_ERROR shall be returned when JSONEncoder returns an error code.] */
-    TEST_FUNCTION(DataMarshaller_SendData_When_Encoding_The_Values_Tree_To_JSON_Fails_Then_Fails)
+    /* Tests_SRS_DATA_MARSHALLER_09_004: [If JSONEncoder_EncodeProperties returns JSON_ENCODER_ALREADY_EXISTS, DataMarshaller_SendData shall return DATA_MARSHALLER_MULTITREE_ERROR.] */
+    TEST_FUNCTION(DataMarshaller_SendData_with_the_same_property_path_twice_returns_DATA_MARSHALLER_MULTITREE_ERROR)
     {
         ///arrange
         DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, true);
         umock_c_reset_all_calls();
         unsigned char* destination;
         size_t destinationSize;
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
+        DATA_MARSHALLER_VALUE values[2] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME, &floatValid } };
 
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
             .IgnoreArgument_toStringFunc()
-            .SetReturn(JSON_ENCODER_ERROR);
-
-        STRICT_EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG))
-            .IgnoreArgument_handle();
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+            .SetReturn(JSON_ENCODER_ALREADY_EXISTS);
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
+        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, values, &destination, &destinationSize);
 
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_JSON_ENCODER_ERROR, result);
-            
+        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
 
         ///cleanup
         DataMarshaller_Destroy(handle);
     }
 
     /* Tests_SRS_DATAMARSHALLER_01_002: [If the includePropertyPath argument passed to DataMarshaller_Create was false and the number of values passed to SendData is greater than 1 and at least one of them is a struct, DataMarshaller_SendData shall fallback to  including the complete property path in the output JSON.] */
-    /*Tests_SRS_DATAMARSHALLER_02_007: [DataMarshaller_SendData shall copy in the output parameters *destination, *destinationSize the content and the content length of the encoded JSON tree.] */
+    /* Tests_SRS_DATA_MARSHALLER_09_002: [DataMarshaller_SendData shall return in the output parameters *destination, *destinationSize the buffer produced by JSONEncoder_EncodeProperties and its length, without copying it.] */
     TEST_FUNCTION(when_includepropertypath_is_false_and_value_count_is_greater_than_1_and_one_of_them_is_a_struct_the_property_path_is_included)
     {
         ///arrange
@@ -678,32 +632,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
 
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
+            .IgnoreArgument_toStringFunc();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
@@ -711,9 +645,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
-        ASSERT_ARE_EQUAL(size_t, strlen(json_payload), destinationSize);
-        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, json_payload, destinationSize));
-            
+        ASSERT_ARE_EQUAL(char_ptr, DEFAULT_PROPERTY_NAME, encodedProperties[0].path);
+        ASSERT_ARE_EQUAL(void_ptr, &floatValid, (void_ptr)encodedProperties[0].value);
+        ASSERT_ARE_EQUAL(char_ptr, DEFAULT_PROPERTY_NAME_2, encodedProperties[1].path);
+        ASSERT_ARE_EQUAL(void_ptr, &structTypeValue, (void_ptr)encodedProperties[1].value);
+        ASSERT_ARE_EQUAL(size_t, strlen(TEST_JSON_PAYLOAD), destinationSize);
+        ASSERT_ARE_EQUAL(int, 0, memcmp(destination, TEST_JSON_PAYLOAD, destinationSize));
 
         ///cleanup
         free(destination);
@@ -721,6 +658,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
     }
 
     /*Tests_SRS_DATAMARSHALLER_02_006: [The complete JSON object shall be handed over to IoTHubClient by a call to IoTHubClient_LL_SendEventAsync if parameter transportType of _Create was TRANSPORT_LL.] */
+    /* Tests_SRS_DATA_MARSHALLER_09_001: [DataMarshaller_SendData shall gather the (path, value) pairs to be encoded in one array of JSON_ENCODER_PROPERTY and pass it to JSONEncoder_EncodeProperties, without building a MultiTree.] */
     TEST_FUNCTION(DataMarshaller_SendData_sends_to_LL_layer_succeeds)
     {
         ///arrange
@@ -729,32 +667,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &structTypeValue } };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &structTypeValue))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
 
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
+            .IgnoreArgument_toStringFunc();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
@@ -777,32 +695,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value[] = { { DEFAULT_PROPERTY_NAME, &floatValid }, { DEFAULT_PROPERTY_NAME_2, &floatValid } };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME_2, &floatValid))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
 
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
+            .IgnoreArgument_toStringFunc();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 2, value, &destination, &destinationSize);
@@ -810,6 +708,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(char_ptr, DEFAULT_PROPERTY_NAME, encodedProperties[0].path);
+        ASSERT_ARE_EQUAL(char_ptr, DEFAULT_PROPERTY_NAME_2, encodedProperties[1].path);
 
         ///cleanup
         free(destination);
@@ -824,31 +724,13 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         unsigned char* destination;
         size_t destinationSize;
         umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
-        char json_payload[] = "Test";
+        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME_LEVEL2, &structTypeValue2Members };
 
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
+        STRICT_EXPECTED_CALL(gballoc_malloc(sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 1, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
             .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
-
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -856,6 +738,8 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(char_ptr, DEFAULT_PROPERTY_NAME_LEVEL2, encodedProperties[0].path);
+        ASSERT_ARE_EQUAL(void_ptr, &structTypeValue2Members, (void_ptr)encodedProperties[0].value);
 
         ///cleanup
         free(destination);
@@ -863,7 +747,7 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
     }
 
     /* Tests_SRS_DATAMARSHALLER_01_001: [If the includePropertyPath argument passed to DataMarshaller_Create was false and only one struct is being sent, the relative path of the value passed to DataMarshaller_SendData - including property name - shall be ignored and the value shall be placed at JSON root.] */
-    /* Tests_SRS_DATAMARSHALLER_01_004: [In this case the members of the struct shall be added as leafs into the MultiTree, each leaf having the name of the struct member.] */
+    /* Tests_SRS_DATA_MARSHALLER_09_003: [In this case the members of the struct shall be encoded at JSON root, each having the name of the struct member.] */
     TEST_FUNCTION(when_includePropertyPath_is_false_and_one_struct_is_being_sent_the_property_name_is_not_placed_in_the_JSON_and_SendAsync_is_called)
     {
         ///arrange
@@ -872,31 +756,12 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         size_t destinationSize;
         umock_c_reset_all_calls();
         DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
-        char json_payload[] = "Test";
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new());
-        EXPECTED_CALL(JSONEncoder_EncodeTree(IGNORED_PTR_ARG, IGNORED_PTR_ARG, IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle()
-            .IgnoreArgument_destination()
-            .IgnoreArgument_toStringFunc();
-
-        EXPECTED_CALL(STRING_length(IGNORED_PTR_ARG))
-            .SetReturn(strlen(json_payload));
-
-        STRICT_EXPECTED_CALL(gballoc_malloc(IGNORED_NUM_ARG))
-            .IgnoreArgument_size();
 
-        EXPECTED_CALL(STRING_c_str(IGNORED_PTR_ARG))
-            .SetReturn(json_payload);
-        EXPECTED_CALL(STRING_delete(IGNORED_PTR_ARG));
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
+        STRICT_EXPECTED_CALL(gballoc_malloc(2 * sizeof(JSON_ENCODER_PROPERTY)));
+        STRICT_EXPECTED_CALL(JSONEncoder_EncodeProperties(IGNORED_PTR_ARG, 2, IGNORED_PTR_ARG, &destination, &destinationSize))
+            .IgnoreArgument_properties()
+            .IgnoreArgument_toStringFunc();
+        STRICT_EXPECTED_CALL(gballoc_free(IGNORED_PTR_ARG));
 
         ///act
         DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
@@ -904,104 +769,16 @@ BEGIN_TEST_SUITE(DataMarshaller_ut)
         ///assert
         ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_OK, result);
         ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
+        ASSERT_ARE_EQUAL(char_ptr, "x", encodedProperties[0].path);
+        ASSERT_ARE_EQUAL(void_ptr, structTypeValue2Members.value.edmComplexType.fields[0].value, (void_ptr)encodedProperties[0].value);
+        ASSERT_ARE_EQUAL(char_ptr, "y", encodedProperties[1].path);
+        ASSERT_ARE_EQUAL(void_ptr, structTypeValue2Members.value.edmComplexType.fields[1].value, (void_ptr)encodedProperties[1].value);
 
         ///cleanup
         free(destination);
         DataMarshaller_Destroy(handle);
     }
 
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(when_adding_the_first_member_of_the_struct_fails_then_senddata_fails)
-    {
-        ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
-        unsigned char* destination;
-        size_t destinationSize;
-        umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
-
-        ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
-        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-        ///cleanup
-        DataMarshaller_Destroy(handle);
-    }
-
-    /* Tests_SRS_DATA_MARSHALLER_99_035:[DATA_MARSHALLER_MULTITREE_ERROR shall be returned in case any MultiTree API call fails.] */
-    TEST_FUNCTION(when_adding_the_second_member_of_the_struct_fails_then_senddata_fails)
-    {
-        ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
-        unsigned char* destination;
-        size_t destinationSize;
-        umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &structTypeValue2Members };
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "x", structTypeValue2Members.value.edmComplexType.fields[0].value))
-            .IgnoreArgument_treeHandle();
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, "y", structTypeValue2Members.value.edmComplexType.fields[1].value))
-            .IgnoreArgument_treeHandle()
-            .SetReturn(MULTITREE_ERROR);
-
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
-
-        ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_MULTITREE_ERROR, result);
-        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-        ///cleanup
-        DataMarshaller_Destroy(handle);
-    }
-
-    /* Tests_SRS_DATAMARSHALLER_01_003: [DATA_MARSHALLER_ERROR shall be returned for any errors when calling IoTHubMessage APIs.] */
-    TEST_FUNCTION(when_STRING_new_fails_SendData_Fails)
-    {
-        ///arrange
-        DATA_MARSHALLER_HANDLE handle = DataMarshaller_Create(TEST_MODEL_HANDLE, false);
-        unsigned char* destination;
-        size_t destinationSize;
-        umock_c_reset_all_calls();
-        DATA_MARSHALLER_VALUE value = { DEFAULT_PROPERTY_NAME, &floatValid };
-
-        EXPECTED_CALL(MultiTree_Create(IGNORED_PTR_ARG, IGNORED_PTR_ARG));
-
-        STRICT_EXPECTED_CALL(MultiTree_AddLeaf(IGNORED_PTR_ARG, DEFAULT_PROPERTY_NAME, &floatValid))
-            .IgnoreArgument_treeHandle();
-        EXPECTED_CALL(STRING_new())
-            .SetReturn(NULL);
-        STRICT_EXPECTED_CALL(MultiTree_Destroy(IGNORED_PTR_ARG))
-            .IgnoreArgument_treeHandle();
-
-        ///act
-        DATA_MARSHALLER_RESULT result = DataMarshaller_SendData(handle, 1, &value, &destination, &destinationSize);
-
-        ///assert
-        ASSERT_ARE_EQUAL(DATA_MARSHALLER_RESULT, DATA_MARSHALLER_ERROR, result);
-        ASSERT_ARE_EQUAL(char_ptr, umock_c_get_expected_calls(), umock_c_get_actual_calls());
-
-        ///cleanup
-        DataMarshaller_Destroy(handle);
-    }
-
     /*Tests_SRS_DATA_MARSHALLER_02_021: [ If argument dataMarshallerHandle is NULL then DataMarshaller_SendData_ReportedProperties shall fail and return DATA_MARSHALLER_INVALID_ARG. ]*/
     TEST_FUNCTION(DataMarshaller_SendData_ReportedProperties_with_NULL_dataMarshallerHandle_fails)
     {
@@ -2589,4 +2589,181 @@ TEST_FUNCTION(JSONDecoder_When_String_Has_Several_Escaped_Chars_Decoding_Succeed
     TestSpecialCharacter_Success(json);
 }
 
+/* Tests_SRS_JSON_DECODER_09_001: [ If reader or json is NULL then JSONDecoder_Reader_Init shall return JSON_DECODER_INVALID_ARG. ] */
+TEST_FUNCTION(JSONDecoder_Reader_Init_With_NULL_reader_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    char jsonString[] = "{}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_Init(NULL, jsonString);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_001: [ If reader or json is NULL then JSONDecoder_Reader_Init shall return JSON_DECODER_INVALID_ARG. ] */
+TEST_FUNCTION(JSONDecoder_Reader_Init_With_NULL_json_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_Init(&reader, NULL);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_002: [ JSONDecoder_Reader_Init shall check that json is an object or an array followed only by white space, without modifying json and without allocating memory. ] */
+/* Tests_SRS_JSON_DECODER_09_003: [ If json is malformed then JSONDecoder_Reader_Init shall return JSON_DECODER_PARSE_ERROR. ] */
+TEST_FUNCTION(JSONDecoder_Reader_Init_With_Malformed_JSON_Fails_And_Leaves_The_JSON_Unchanged)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+    char jsonString[] = "{\"a\":\"b\",\"c\":[1,2}";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_Init(&reader, jsonString);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+    ASSERT_ARE_EQUAL(char_ptr, "{\"a\":\"b\",\"c\":[1,2}", jsonString);
+    mocks.AssertActualAndExpectedCalls();
+}
+
+/* Tests_SRS_JSON_DECODER_09_003: [ If json is malformed then JSONDecoder_Reader_Init shall return JSON_DECODER_PARSE_ERROR. ] */
+TEST_FUNCTION(JSONDecoder_Reader_Init_With_Trailing_Characters_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+    char jsonString[] = "{} x";
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_Init(&reader, jsonString);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_004: [ Otherwise JSONDecoder_Reader_Init shall position reader on the first value of json and return JSON_DECODER_OK. ] */
+/* Tests_SRS_JSON_DECODER_09_006: [ JSONDecoder_Reader_BeginObject shall enter the object at the position of reader and return JSON_DECODER_OK. ] */
+/* Tests_SRS_JSON_DECODER_09_009: [ JSONDecoder_Reader_NextMember shall return in name the name of the next member of the current object, terminated in place in json, position reader on the value of the member and return JSON_DECODER_OK. ] */
+/* Tests_SRS_JSON_DECODER_09_010: [ At the end of the current object JSONDecoder_Reader_NextMember shall set name to NULL, position reader after the object and return JSON_DECODER_OK. ] */
+/* Tests_SRS_JSON_DECODER_09_013: [ JSONDecoder_Reader_GetValue shall return in value the text of the string, number or literal name at the position of reader, terminated in place in json, position reader after it and return JSON_DECODER_OK. ] */
+/* Tests_SRS_JSON_DECODER_09_018: [ JSONDecoder_Reader_SkipValue shall position reader after the value at its position, objects and arrays included, without terminating anything in json, and return JSON_DECODER_OK. ] */
+TEST_FUNCTION(JSONDecoder_Reader_Walks_The_Members_Of_An_Object_Without_Building_A_MultiTree)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+    char jsonString[] = " { \"skipped\" : {\"x\":[1,{\"y\":null}]} , \"number\" : -1.5e3 , \"text\" : \"a b\" , \"inner\" : { \"flag\" : true } } ";
+    const char* name;
+    const char* value;
+
+    ///act
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_Init(&reader, jsonString));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_BeginObject(&reader));
+
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_ARE_EQUAL(char_ptr, "skipped", name);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_SkipValue(&reader));
+
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_ARE_EQUAL(char_ptr, "number", name);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_GetValue(&reader, &value));
+    ASSERT_ARE_EQUAL(char_ptr, "-1.5e3", value);
+
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_ARE_EQUAL(char_ptr, "text", name);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_GetValue(&reader, &value));
+    ASSERT_ARE_EQUAL(char_ptr, "\"a b\"", value);
+
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_ARE_EQUAL(char_ptr, "inner", name);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_BeginObject(&reader));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_ARE_EQUAL(char_ptr, "flag", name);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_GetValue(&reader, &value));
+    ASSERT_ARE_EQUAL(char_ptr, "true", value);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_IS_NULL(name);
+
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_NextMember(&reader, &name);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, result);
+    ASSERT_IS_NULL(name);
+    mocks.AssertActualAndExpectedCalls();
+}
+
+/* Tests_SRS_JSON_DECODER_09_014: [ If the value at the position of reader is an object or an array then JSONDecoder_Reader_GetValue shall return JSON_DECODER_PARSE_ERROR and leave reader where it is. ] */
+/* Tests_SRS_JSON_DECODER_09_016: [ Every reader function shall first put back the character that the previous call replaced with a terminator. ] */
+TEST_FUNCTION(JSONDecoder_Reader_GetValue_On_An_Object_Fails_And_The_Object_Can_Still_Be_Skipped)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+    char jsonString[] = "{\"a\":{\"b\":1}}";
+    const char* name;
+    const char* value;
+
+    (void)JSONDecoder_Reader_Init(&reader, jsonString);
+    (void)JSONDecoder_Reader_BeginObject(&reader);
+    (void)JSONDecoder_Reader_NextMember(&reader, &name);
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_GetValue(&reader, &value);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_SkipValue(&reader));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_OK, JSONDecoder_Reader_NextMember(&reader, &name));
+    ASSERT_IS_NULL(name);
+}
+
+/* Tests_SRS_JSON_DECODER_09_007: [ If the value at the position of reader is not an object then JSONDecoder_Reader_BeginObject shall return JSON_DECODER_PARSE_ERROR and leave reader where it is. ] */
+TEST_FUNCTION(JSONDecoder_Reader_BeginObject_On_An_Array_Fails)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+    char jsonString[] = "[1]";
+
+    (void)JSONDecoder_Reader_Init(&reader, jsonString);
+
+    ///act
+    JSON_DECODER_RESULT result = JSONDecoder_Reader_BeginObject(&reader);
+
+    ///assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_PARSE_ERROR, result);
+}
+
+/* Tests_SRS_JSON_DECODER_09_005: [ If reader is NULL then JSONDecoder_Reader_BeginObject shall return JSON_DECODER_INVALID_ARG. ] */
+/* Tests_SRS_JSON_DECODER_09_008: [ If reader or name is NULL then JSONDecoder_Reader_NextMember shall return JSON_DECODER_INVALID_ARG. ] */
+/* Tests_SRS_JSON_DECODER_09_012: [ If reader or value is NULL then JSONDecoder_Reader_GetValue shall return JSON_DECODER_INVALID_ARG. ] */
+/* Tests_SRS_JSON_DECODER_09_017: [ If reader is NULL then JSONDecoder_Reader_SkipValue shall return JSON_DECODER_INVALID_ARG. ] */
+TEST_FUNCTION(JSONDecoder_Reader_Functions_With_NULL_Arguments_Fail)
+{
+    ///arrange
+    CJSONDecoderMocks mocks;
+    JSON_DECODER_READER reader;
+    char jsonString[] = "{}";
+    const char* text;
+
+    (void)JSONDecoder_Reader_Init(&reader, jsonString);
+
+    ///act & assert
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, JSONDecoder_Reader_BeginObject(NULL));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, JSONDecoder_Reader_NextMember(NULL, &text));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, JSONDecoder_Reader_NextMember(&reader, NULL));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, JSONDecoder_Reader_GetValue(NULL, &text));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, JSONDecoder_Reader_GetValue(&reader, NULL));
+    ASSERT_ARE_EQUAL(JSON_DECODER_RESULT_TAG, JSON_DECODER_INVALID_ARG, JSONDecoder_Reader_SkipValue(NULL));
+}
+
 END_TEST_SUITE(JSONDecoder_ut)
@@ -563,6 +563,12 @@ public:
 
     MOCK_STATIC_METHOD_1(, const char*, STRING_c_str, STRING_HANDLE, s)
     MOCK_METHOD_END(const char*, BASEIMPLEMENTATION::STRING_c_str(s))
+
+    MOCK_STATIC_METHOD_1(, size_t, STRING_length, STRING_HANDLE, s)
+    MOCK_METHOD_END(size_t, BASEIMPLEMENTATION::STRING_length(s))
+
+    MOCK_STATIC_METHOD_1(, int, STRING_empty, STRING_HANDLE, s)
+    MOCK_METHOD_END(int, BASEIMPLEMENTATION::STRING_empty(s))
 };
 
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , MULTITREE_HANDLE, MultiTree_Create, MULTITREE_CLONE_FUNCTION, cloneFunction, MULTITREE_FREE_FUNCTION, freeFunction);
@@ -578,6 +584,8 @@ DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , void, STRING_delete, STRING_HANDLE, s
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , int, STRING_concat, STRING_HANDLE, s1, const char*, s2);
 DECLARE_GLOBAL_MOCK_METHOD_2(CJSONMocks, , int, STRING_concat_with_STRING, STRING_HANDLE, s1, STRING_HANDLE, s2);
 DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , const char*, STRING_c_str, STRING_HANDLE, s);
+DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , size_t, STRING_length, STRING_HANDLE, s);
+DECLARE_GLOBAL_MOCK_METHOD_1(CJSONMocks, , int, STRING_empty, STRING_HANDLE, s);
 
 /*all (applicable) tests in this file also test this: Tests_SRS_JSON_ENCODER_99_022:[ There is no hierarchy defined in the string. All strings are considered to be "root" level.]
  because they test that the objects created are of type "NUMBER" of "STRING" and not JSON_DATATYPE_OBJECT for example*/
@@ -6429,4 +6437,304 @@ BEGIN_TEST_SUITE(JSONEncoder_ut)
             ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
         }
 
+
+        /* JSONEncoder_EncodeProperties */
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [If properties, toStringFunc, destination or destinationSize is NULL, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_NULL_properties_fails)
+        {
+            ///arrange
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(NULL, 1, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [If properties, toStringFunc, destination or destinationSize is NULL, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_NULL_toStringFunc_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 1, NULL, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [If properties, toStringFunc, destination or destinationSize is NULL, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_NULL_destination_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" } };
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 1, TestFunc_NodesAreStrings, NULL, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_001: [If properties, toStringFunc, destination or destinationSize is NULL, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_NULL_destinationSize_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" } };
+            unsigned char* destination;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 1, TestFunc_NodesAreStrings, &destination, NULL);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_002: [If any property has a NULL path or a NULL value, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_NULL_path_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" }, { NULL, "\"value2\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 2, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_002: [If any property has a NULL path or a NULL value, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_NULL_value_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", NULL } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 1, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+            ASSERT_ARE_EQUAL(tchar_ptr, _T(""), mocks->CompareActualAndExpectedCalls().c_str());
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_009: [The output shall be formatted like the output of JSONEncoder_EncodeTree for the equivalent tree: "{", name:value pairs separated by ", ", "}".]*/
+        /*Tests_SRS_JSON_ENCODER_09_010: [On success, JSONEncoder_EncodeProperties shall hand the output buffer over to the caller in *destination (not NUL-terminated), its length in *destinationSize and return JSON_ENCODER_OK.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_no_properties_produces_an_empty_object)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[1];
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 0, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(size_t, 2, destinationSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp("{}", destination, destinationSize));
+
+            ///cleanup
+            free(destination);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_003: [JSONEncoder_EncodeProperties shall group the properties by name in one pass over their paths, then write the JSON object in one pass into a single output buffer that grows as needed, without building a MultiTree.]*/
+        /*Tests_SRS_JSON_ENCODER_09_007: [Each value shall be converted to text by calling toStringFunc with one scratch STRING_HANDLE that is reused for all the values.]*/
+        /*Tests_SRS_JSON_ENCODER_09_009: [The output shall be formatted like the output of JSONEncoder_EncodeTree for the equivalent tree: "{", name:value pairs separated by ", ", "}".]*/
+        /*Tests_SRS_JSON_ENCODER_09_010: [On success, JSONEncoder_EncodeProperties shall hand the output buffer over to the caller in *destination (not NUL-terminated), its length in *destinationSize and return JSON_ENCODER_OK.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_3_success)
+        {
+            ///arrange
+            const char expected[] = "{\"child1\":\"value1\", \"child2\":\"value2\", \"child3\":\"value3\"}";
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" }, { "child2", "\"value2\"" }, { "child3", "\"value3\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 3, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(size_t, sizeof(expected) - 1, destinationSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(expected, destination, destinationSize));
+            ASSERT_ARE_EQUAL(size_t, 1, nSTRING_new_calls);
+
+            ///cleanup
+            free(destination);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_004: [A path is a list of names separated by "/", with an optional leading "/"; properties whose paths share a first name shall be placed, in the order that name first appears, in a nested JSON object having that name.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_5_2_1_success)
+        {
+            ///arrange
+            const char expected[] = "{\"subtree\":{\"child4\":\"value4\", \"child5\":\"value5\"}, \"child1\":\"value1\"}";
+            JSON_ENCODER_PROPERTY properties[] = { { "/subtree/child4", "\"value4\"" }, { "child1", "\"value1\"" }, { "subtree/child5", "\"value5\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 3, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(size_t, sizeof(expected) - 1, destinationSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(expected, destination, destinationSize));
+
+            ///cleanup
+            free(destination);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_004: [A path is a list of names separated by "/", with an optional leading "/"; properties whose paths share a first name shall be placed, in the order that name first appears, in a nested JSON object having that name.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_does_not_mix_names_that_share_a_prefix)
+        {
+            ///arrange
+            const char expected[] = "{\"child\":\"value1\", \"child1\":{\"child4\":\"value4\"}, \"child12\":\"value2\"}";
+            JSON_ENCODER_PROPERTY properties[] = { { "child", "\"value1\"" }, { "child1/child4", "\"value4\"" }, { "child12", "\"value2\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 3, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(size_t, sizeof(expected) - 1, destinationSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(expected, destination, destinationSize));
+
+            ///cleanup
+            free(destination);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_004: [A path is a list of names separated by "/", with an optional leading "/"; properties whose paths share a first name shall be placed, in the order that name first appears, in a nested JSON object having that name.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_groups_names_at_every_depth_in_first_appearance_order)
+        {
+            ///arrange
+            const char expected[] = "{\"a\":{\"b\":{\"c\":\"value1\", \"d\":\"value3\"}, \"e\":\"value4\"}, \"x\":\"value2\"}";
+            JSON_ENCODER_PROPERTY properties[] = { { "a/b/c", "\"value1\"" }, { "x", "\"value2\"" }, { "/a/b/d", "\"value3\"" }, { "a/e", "\"value4\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 4, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_OK, result);
+            ASSERT_ARE_EQUAL(size_t, sizeof(expected) - 1, destinationSize);
+            ASSERT_ARE_EQUAL(int, 0, memcmp(expected, destination, destinationSize));
+
+            ///cleanup
+            free(destination);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_006: [If the same path is given twice, or a path names both a value and an object, JSONEncoder_EncodeProperties shall return JSON_ENCODER_ALREADY_EXISTS.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_a_value_path_nested_under_a_value_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "subtree", "\"value1\"" }, { "subtree/child4/child5", "\"value4\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 2, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ALREADY_EXISTS, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_005: [If a path contains an empty name, JSONEncoder_EncodeProperties shall return JSON_ENCODER_INVALID_ARG.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_an_empty_name_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" }, { "subtree//child4", "\"value4\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 2, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_INVALID_ARG, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_006: [If the same path is given twice, or a path names both a value and an object, JSONEncoder_EncodeProperties shall return JSON_ENCODER_ALREADY_EXISTS.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_the_same_path_twice_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" }, { "/child1", "\"value2\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 2, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ALREADY_EXISTS, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_006: [If the same path is given twice, or a path names both a value and an object, JSONEncoder_EncodeProperties shall return JSON_ENCODER_ALREADY_EXISTS.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_with_a_path_naming_a_value_and_an_object_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "subtree/child4", "\"value4\"" }, { "subtree", "\"value1\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 2, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ALREADY_EXISTS, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_008: [If toStringFunc fails, JSONEncoder_EncodeProperties shall return JSON_ENCODER_TOSTRING_FUNCTION_ERROR.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_fails_when_toStringFunc_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+
+            STRICT_EXPECTED_CALL((*mocks), TestFunc_NodesAreStrings(IGNORED_PTR_ARG, IGNORED_PTR_ARG))
+                .IgnoreAllArguments()
+                .SetReturn(JSON_ENCODER_TOSTRING_ERROR);
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 1, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_TOSTRING_FUNCTION_ERROR, result);
+        }
+
+        /*Tests_SRS_JSON_ENCODER_09_011: [If any other error occurs, JSONEncoder_EncodeProperties shall free the output buffer and return JSON_ENCODER_ERROR.]*/
+        TEST_FUNCTION(JSONEncoder_EncodeProperties_fails_when_STRING_new_fails)
+        {
+            ///arrange
+            JSON_ENCODER_PROPERTY properties[] = { { "child1", "\"value1\"" } };
+            unsigned char* destination;
+            size_t destinationSize;
+            whenShallSTRING_new_fail = 1;
+
+            ///act
+            auto result = JSONEncoder_EncodeProperties(properties, 1, TestFunc_NodesAreStrings, &destination, &destinationSize);
+
+            ///assert
+            ASSERT_ARE_EQUAL(JSON_ENCODER_RESULT, JSON_ENCODER_ERROR, result);
+        }
+
 END_TEST_SUITE(JSONEncoder_ut)
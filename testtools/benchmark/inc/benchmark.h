@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* creates whatever a benchmark needs before being timed; the result is passed to every run_once call */
+typedef int(*BENCHMARK_SETUP)(void** context);
+/* one measured operation; returns 0 on success */
+typedef int(*BENCHMARK_RUN_ONCE)(void* context);
+typedef void(*BENCHMARK_TEARDOWN)(void* context);
+
+typedef struct BENCHMARK_TAG
+{
+    const char* name;
+    BENCHMARK_SETUP setup;
+    BENCHMARK_RUN_ONCE run_once;
+    BENCHMARK_TEARDOWN teardown;
+    /* upper bound on the iterations of slow benchmarks; 0 means no bound */
+    size_t max_iterations;
+} BENCHMARK;
+
+/* returns the benchmarks of one group (usually one source file) and their count */
+typedef const BENCHMARK*(*BENCHMARK_GROUP_GET)(size_t* count);
+
+/* Runs `benchmark` for `iterations` operations (after a short warm up) and prints one JSON line with the results to stdout. */
+extern int benchmark_run(const BENCHMARK* benchmark, size_t iterations);
+
+/*
+ * The main of a benchmarks executable: parses "[iterations [name_filter]]" from the command line and runs every benchmark
+ * of `groups` whose name contains name_filter. Returns non-zero if any benchmark failed.
+ */
+extern int benchmark_main(int argc, char** argv, const BENCHMARK_GROUP_GET* groups, size_t group_count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BENCHMARK_H */
@@ -0,0 +1,197 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license. See LICENSE file in the project root for full license information.
+
+#ifndef _WIN32
+/*clock_gettime is not part of C99*/
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "azure_c_shared_utility/xlogging.h"
+#include "benchmark.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#define WARM_UP_DIVIDER 10
+#define DEFAULT_ITERATIONS 10000
+
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+/*the benchmarks executable is linked with --wrap for these, so every allocation made by the SDK and its static dependencies comes through here*/
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t nmemb, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+static size_t allocation_count;
+static size_t allocated_bytes;
+
+void* __wrap_malloc(size_t size)
+{
+    allocation_count++;
+    allocated_bytes += size;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t nmemb, size_t size)
+{
+    allocation_count++;
+    allocated_bytes += nmemb * size;
+    return __real_calloc(nmemb, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size)
+{
+    allocation_count++;
+    allocated_bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void* ptr)
+{
+    __real_free(ptr);
+}
+#endif
+
+static uint64_t get_time_ns(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    (void)QueryPerformanceFrequency(&frequency);
+    (void)QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1000000000.0 / (double)frequency.QuadPart);
+#else
+    struct timespec now;
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+#endif
+}
+
+static int run_iterations(const BENCHMARK* benchmark, void* context, size_t iterations)
+{
+    int result = 0;
+    size_t i;
+
+    for (i = 0; i < iterations; i++)
+    {
+        if (benchmark->run_once(context) != 0)
+        {
+            (void)fprintf(stderr, "benchmark %s failed on iteration %lu\r\n", benchmark->name, (unsigned long)i);
+            result = __LINE__;
+            break;
+        }
+    }
+
+    return result;
+}
+
+int benchmark_run(const BENCHMARK* benchmark, size_t iterations)
+{
+    int result;
+    void* context = NULL;
+
+    if (benchmark->max_iterations != 0 && iterations > benchmark->max_iterations)
+    {
+        iterations = benchmark->max_iterations;
+    }
+
+    if (benchmark->setup != NULL && benchmark->setup(&context) != 0)
+    {
+        (void)fprintf(stderr, "benchmark %s failed to set up\r\n", benchmark->name);
+        result = __LINE__;
+    }
+    else
+    {
+        /*the warm up fills the pools and caches so that the measured iterations show the steady state*/
+        if (run_iterations(benchmark, context, iterations / WARM_UP_DIVIDER + 1) != 0)
+        {
+            result = __LINE__;
+        }
+        else
+        {
+            uint64_t start_time;
+            uint64_t elapsed_ns;
+
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+            allocation_count = 0;
+            allocated_bytes = 0;
+#endif
+            start_time = get_time_ns();
+            result = run_iterations(benchmark, context, iterations);
+            elapsed_ns = get_time_ns() - start_time;
+
+            if (result == 0)
+            {
+                double ns_per_op = (double)elapsed_ns / (double)iterations;
+
+                (void)printf("{\"benchmark\":\"%s\",\"iterations\":%lu,\"ns_per_op\":%.1f,\"ops_per_sec\":%.1f,",
+                    benchmark->name, (unsigned long)iterations, ns_per_op, (ns_per_op > 0.0 ? 1000000000.0 / ns_per_op : 0.0));
+#ifdef BENCHMARK_COUNT_ALLOCATIONS
+                (void)printf("\"allocs_per_op\":%.2f,\"bytes_per_op\":%.1f}\n",
+                    (double)allocation_count / (double)iterations, (double)allocated_bytes / (double)iterations);
+#else
+                (void)printf("\"allocs_per_op\":null,\"bytes_per_op\":null}\n");
+#endif
+                (void)fflush(stdout);
+            }
+        }
+
+        if (benchmark->teardown != NULL)
+        {
+            benchmark->teardown(context);
+        }
+    }
+
+    return result;
+}
+
+int benchmark_main(int argc, char** argv, const BENCHMARK_GROUP_GET* groups, size_t group_count)
+{
+    int result = 0;
+    size_t iterations = DEFAULT_ITERATIONS;
+    const char* name_filter = NULL;
+    size_t i;
+
+    if (argc > 1 && (iterations = (size_t)strtoul(argv[1], NULL, 10)) == 0)
+    {
+        (void)fprintf(stderr, "usage: %s [iterations [name_filter]]\r\n", argv[0]);
+        result = __LINE__;
+    }
+    else
+    {
+        if (argc > 2)
+        {
+            name_filter = argv[2];
+        }
+
+#ifndef NO_LOGGING
+        /*SDK logging goes to stdout and would break the machine readable output*/
+        xlogging_set_log_function(NULL);
+#endif
+
+        for (i = 0; i < group_count; i++)
+        {
+            size_t count;
+            size_t j;
+            const BENCHMARK* benchmarks = groups[i](&count);
+
+            for (j = 0; j < count; j++)
+            {
+                if ((name_filter == NULL || strstr(benchmarks[j].name, name_filter) != NULL) &&
+                    benchmark_run(&benchmarks[j], iterations) != 0)
+                {
+                    result = __LINE__;
+                }
+            }
+        }
+    }
+
+    return result;
+}